@@ -0,0 +1,161 @@
+#!/usr/bin/env python3
+# Copyright (c) Meta Platforms, Inc. and affiliates.
+#
+# This source code is licensed under the MIT license found in the
+# LICENSE file in the root directory of this source tree.
+
+"""
+Coordinate a distributed analysis.
+
+Each round runs one worker per partition, in parallel. A worker is a regular
+run of the analysis with `--partition-count`, `--partition-index` and
+`--partition-directory`: it analyzes the methods of its partition using the
+models of other partitions written during the previous round, and writes the
+models of its partition back to the shared directory. Rounds are repeated
+until no partition changes, which is the global fixpoint.
+
+Workers run locally by default. To run them on other hosts, use a command
+template with a shared partition directory, for instance:
+  --worker-command "ssh worker{index} {command}"
+
+Usage:
+  distributed_analysis.py --partitions 4 --partition-directory shared \\
+    --output-directory output -- mariana-trench --apk-path app.apk ...
+"""
+
+import argparse
+import hashlib
+import shlex
+import shutil
+import subprocess
+import sys
+from pathlib import Path
+from typing import List, Optional
+
+
+def _partition_path(directory: Path, index: int) -> Path:
+    return directory / f"partition@{index}.bin"
+
+
+def _digest(path: Path) -> Optional[str]:
+    if not path.exists():
+        return None
+    digest = hashlib.sha256()
+    with open(path, "rb") as file:
+        for chunk in iter(lambda: file.read(1 << 20), b""):
+            digest.update(chunk)
+    return digest.hexdigest()
+
+
+def _worker_command(
+    arguments: argparse.Namespace, index: int, output_directory: Path
+) -> str:
+    command = arguments.command + [
+        "--partition-count",
+        str(arguments.partitions),
+        "--partition-index",
+        str(index),
+        "--partition-directory",
+        str(arguments.partition_directory.resolve()),
+        "--output-directory",
+        str(output_directory.resolve()),
+    ]
+    return arguments.worker_command.format(
+        index=index, command=" ".join(shlex.quote(part) for part in command)
+    )
+
+
+def _run_round(arguments: argparse.Namespace, iteration: int) -> None:
+    processes: List[subprocess.Popen[bytes]] = []
+    for index in range(arguments.partitions):
+        output_directory = arguments.output_directory / f"partition-{index}"
+        output_directory.mkdir(parents=True, exist_ok=True)
+        command = _worker_command(arguments, index, output_directory)
+        print(f"Round {iteration}, partition {index}: {command}", file=sys.stderr)
+        processes.append(subprocess.Popen(command, shell=True))
+    for index, process in enumerate(processes):
+        if process.wait() != 0:
+            raise RuntimeError(
+                f"Partition {index} failed in round {iteration} with code {process.returncode}."
+            )
+
+
+def _merge_outputs(arguments: argparse.Namespace) -> None:
+    for index in range(arguments.partitions):
+        partition_output = arguments.output_directory / f"partition-{index}"
+        for path in partition_output.glob("model@*"):
+            # Keep the `model@` prefix so that `filename_spec` still matches.
+            name = path.name.replace("model@", f"model@partition-{index}-", 1)
+            shutil.move(str(path), arguments.output_directory / name)
+    shutil.copy(
+        arguments.output_directory / "partition-0" / "metadata.json",
+        arguments.output_directory / "metadata.json",
+    )
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(
+        description="Run the analysis on several workers until the global fixpoint is reached.",
+        formatter_class=argparse.RawDescriptionHelpFormatter,
+        epilog=__doc__,
+    )
+    parser.add_argument(
+        "--partitions", type=int, required=True, help="Number of workers."
+    )
+    parser.add_argument(
+        "--partition-directory",
+        type=Path,
+        required=True,
+        help="Directory where workers exchange models, shared by all hosts.",
+    )
+    parser.add_argument(
+        "--output-directory",
+        type=Path,
+        required=True,
+        help="Directory of the merged output.",
+    )
+    parser.add_argument(
+        "--worker-command",
+        type=str,
+        default="{command}",
+        help="Template of the command running a worker, given `{index}` and `{command}`.",
+    )
+    parser.add_argument(
+        "--maximum-rounds",
+        type=int,
+        default=20,
+        help="Give up if the fixpoint is not reached after this many rounds.",
+    )
+    parser.add_argument(
+        "command",
+        nargs=argparse.REMAINDER,
+        help="The analysis command, without output and partition arguments.",
+    )
+    arguments: argparse.Namespace = parser.parse_args()
+    if arguments.command and arguments.command[0] == "--":
+        arguments.command = arguments.command[1:]
+    if not arguments.command:
+        parser.error("Missing the analysis command.")
+
+    shutil.rmtree(arguments.partition_directory, ignore_errors=True)
+    arguments.partition_directory.mkdir(parents=True)
+    arguments.output_directory.mkdir(parents=True, exist_ok=True)
+
+    digests: List[Optional[str]] = [None] * arguments.partitions
+    for iteration in range(1, arguments.maximum_rounds + 1):
+        _run_round(arguments, iteration)
+        new_digests = [
+            _digest(_partition_path(arguments.partition_directory, index))
+            for index in range(arguments.partitions)
+        ]
+        if new_digests == digests:
+            print(f"Reached the global fixpoint in {iteration} rounds.", file=sys.stderr)
+            _merge_outputs(arguments)
+            sys.exit(0)
+        digests = new_digests
+
+    print(
+        f"Did not reach the global fixpoint in {arguments.maximum_rounds} rounds.",
+        file=sys.stderr,
+    )
+    sys.exit(1)
@@ -8,6 +8,7 @@ import json
 import multiprocessing
 import os
 import re
+import struct
 import subprocess
 import sys
 from typing import Any, Union, Dict, Tuple, Iterable, NamedTuple, List
@@ -75,15 +76,37 @@ def _index_file(path: str) -> Tuple[Dict[str, FilePosition], Dict[str, FilePosit
     return (index, field_index)
 
 
+def _load_index(index_path: str) -> None:
+    global __index, __field_index
+    with open(index_path) as file:
+        index = json.load(file)
+
+    directory = os.path.dirname(index_path)
+    shards = [os.path.join(directory, shard) for shard in index["shards"]]
+    for name, (shard, offset, length) in index["methods"].items():
+        __index[name] = FilePosition(path=shards[shard], offset=offset, length=length)
+    for name, (shard, offset, length) in index["fields"].items():
+        __field_index[name] = FilePosition(
+            path=shards[shard], offset=offset, length=length
+        )
+
+
 def index(results_directory: str = ".") -> None:
     """Index all available method and field models in the given directory."""
     global __index, __field_index
     __index = {}
     __field_index = {}
 
+    # Use the index written by the analysis, if any.
+    index_path = os.path.join(results_directory, "models_index.json")
+    if os.path.exists(index_path):
+        _load_index(index_path)
+        print(f"Loaded {len(__index)} models from `{index_path}`")
+        return
+
     paths = []
     for path in os.listdir(results_directory):
-        if not path.startswith("model@"):
+        if not path.startswith("model@") or not path.endswith(".json"):
             continue
 
         paths.append(os.path.join(results_directory, path))
@@ -185,6 +208,82 @@ def dump_field_model(field: str, filename: str, indent: int = 2) -> None:
         f.write(json.dumps(get_field_model(field), indent=indent))
 
 
+class _BinaryReader:
+    """Reader for the binary model format, see `source/BinaryJson.h`."""
+
+    def __init__(self, data: bytes) -> None:
+        self.data = data
+        self.offset = 0
+        if data[:4] != b"MTBJ":
+            raise AssertionError("invalid binary model header")
+        self.offset = 4
+        version = self.read_byte()
+        if version != 1:
+            raise AssertionError(f"unsupported binary model version {version}")
+        self.strings = []
+        for _ in range(self.read_varint()):
+            size = self.read_varint()
+            self.strings.append(
+                self.data[self.offset : self.offset + size].decode("utf-8")
+            )
+            self.offset += size
+
+    def read_byte(self) -> int:
+        byte = self.data[self.offset]
+        self.offset += 1
+        return byte
+
+    def read_varint(self) -> int:
+        value = 0
+        shift = 0
+        while True:
+            byte = self.read_byte()
+            value |= (byte & 0x7F) << shift
+            if byte & 0x80 == 0:
+                return value
+            shift += 7
+
+    def decode(self) -> Any:
+        tag = self.read_byte()
+        if tag == 0:
+            return None
+        elif tag == 1:
+            return False
+        elif tag == 2:
+            return True
+        elif tag == 3:
+            value = self.read_varint()
+            return (value >> 1) ^ -(value & 1)
+        elif tag == 4:
+            return self.read_varint()
+        elif tag == 5:
+            (value,) = struct.unpack_from("<d", self.data, self.offset)
+            self.offset += 8
+            return value
+        elif tag == 6:
+            return self.strings[self.read_varint()]
+        elif tag == 7:
+            return [self.decode() for _ in range(self.read_varint())]
+        elif tag == 8:
+            result = {}
+            for _ in range(self.read_varint()):
+                key = self.strings[self.read_varint()]
+                result[key] = self.decode()
+            return result
+        raise AssertionError(f"invalid binary model tag {tag}")
+
+    def records(self) -> Iterable[Any]:
+        while self.offset < len(self.data):
+            self.read_varint()  # Record length.
+            yield self.decode()
+
+
+def load_binary_models(path: str) -> List[Model]:
+    """Load all models from the given binary shard (`model@*.bin`)."""
+    with open(path, "rb") as file:
+        return list(_BinaryReader(file.read()).records())
+
+
 def print_help() -> None:
     print("# Mariana Trench Model Explorer")
     print("Available commands:")
@@ -200,6 +299,7 @@ def print_help() -> None:
         (print_field_model, "print_field_model('Foo;.bar')"),
         (dump_model, "dump_model('Foo;.bar', 'bar.json', [indent=2])"),
         (dump_field_model, "dump_field_model('Foo;.bar', 'bar.json', [indent=2])"),
+        (load_binary_models, "load_binary_models('model@00000-of-00001.bin')"),
     ]
     max_width = max(len(command[1]) for command in commands)
     for command, example in commands:
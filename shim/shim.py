@@ -5,6 +5,7 @@
 # LICENSE file in the root directory of this source tree.
 
 import argparse
+import hashlib
 import json
 import logging
 import os
@@ -14,7 +15,7 @@ import sys
 import tempfile
 import traceback
 from pathlib import Path
-from typing import Optional, Any, List
+from typing import Any, Callable, List, Optional
 
 from pyre_extensions import none_throws, safe_json
 
@@ -198,47 +199,116 @@ def _get_analysis_binary(arguments: argparse.Namespace) -> Path:
     raise ClientError("Could not find the analyzer binary.")
 
 
-def _desugar_jar_file(jar_path: Path) -> Path:
-    LOG.info(f"Desugaring `{jar_path}`...")
+D8_PATH: str = "/opt/android/sdk_D23134735/build-tools/29.0.2/d8"
+D8_LIBRARY_PATH: str = "/opt/android/sdk_D23134735/platforms/android-29/android.jar"
+D8_MINIMUM_API: str = "25"  # mininum api 25 corresponds to dex 37
+
+
+def _file_hash(path: Path) -> str:
+    digest = hashlib.sha256()
+    with open(path, "rb") as file:
+        for chunk in iter(lambda: file.read(1 << 20), b""):
+            digest.update(chunk)
+    return digest.hexdigest()
+
+
+def _cache_key(input_path: Path, *versions: str) -> str:
+    digest = hashlib.sha256(_file_hash(input_path).encode())
+    for version in versions:
+        digest.update(b"\0")
+        digest.update(version.encode())
+    return digest.hexdigest()
+
+
+def _cached_artifact(
+    cache_directory: Optional[Path],
+    name: str,
+    key: Callable[[], str],
+    build: Callable[[Path], None],
+    output_path: Path,
+) -> Path:
+    """Build `output_path`, or reuse the artifact cached under the same key."""
+    if cache_directory is None:
+        build(output_path)
+        return output_path
+
+    cached_path = cache_directory / f"{name}-{key()}.jar"
+    if cached_path.is_file():
+        LOG.info(f"Using cached `{cached_path}`.")
+        return cached_path
+
+    build(output_path)
+    cache_directory.mkdir(parents=True, exist_ok=True)
+    # Concurrent runs never read a partial artifact.
+    temporary_path = cache_directory / f".{cached_path.name}.{os.getpid()}"
+    shutil.copyfile(output_path, temporary_path)
+    os.replace(temporary_path, cached_path)
+    LOG.info(f"Cached `{cached_path}`.")
+    return cached_path
+
+
+def _desugar_jar_file(jar_path: Path, cache_directory: Optional[Path]) -> Path:
     desugar_tool = _build_target(none_throws(configuration.DESUGAR_BUCK_TARGET))
-    desugared_jar_file = jar_path.parent / (jar_path.stem + "-desugared.jar")
-    output = subprocess.run(
-        [
-            "java",
-            "-jar",
-            desugar_tool,
-            os.fspath(jar_path),
-            os.fspath(desugared_jar_file),
-        ]
-    )
-    if output.returncode != 0:
-        raise ClientError("Error while desugaring jar file, aborting.")
 
+    def desugar(desugared_jar_file: Path) -> None:
+        LOG.info(f"Desugaring `{jar_path}`...")
+        output = subprocess.run(
+            [
+                "java",
+                "-jar",
+                desugar_tool,
+                os.fspath(jar_path),
+                os.fspath(desugared_jar_file),
+            ]
+        )
+        if output.returncode != 0:
+            raise ClientError("Error while desugaring jar file, aborting.")
+
+    desugared_jar_file = _cached_artifact(
+        cache_directory,
+        "desugared",
+        lambda: _cache_key(jar_path, _file_hash(desugar_tool)),
+        desugar,
+        jar_path.parent / (jar_path.stem + "-desugared.jar"),
+    )
     LOG.info(f"Desugared jar file: `{desugared_jar_file}`.")
     return desugared_jar_file
 
 
-def _build_apk_from_jar(jar_path: Path) -> Path:
-    _, dex_file = tempfile.mkstemp(suffix=".jar")
-
-    LOG.info(f"Running d8 on `{jar_path}`...")
+def _d8_version() -> str:
     output = subprocess.run(
-        [
-            "/opt/android/sdk_D23134735/build-tools/29.0.2/d8",
-            "-JXmx8G",
-            jar_path,
-            "--output",
-            dex_file,
-            "--lib",
-            "/opt/android/sdk_D23134735/platforms/android-29/android.jar",
-            "--min-api",
-            "25",  # mininum api 25 corresponds to dex 37
-        ]
+        [D8_PATH, "--version"], stdout=subprocess.PIPE, stderr=subprocess.STDOUT
     )
-    if output.returncode != 0:
-        raise ClientError("Error while running d8, aborting.")
+    return output.stdout.decode(errors="replace")
+
+
+def _build_apk_from_jar(jar_path: Path, cache_directory: Optional[Path]) -> Path:
+    def build(dex_file: Path) -> None:
+        LOG.info(f"Running d8 on `{jar_path}`...")
+        output = subprocess.run(
+            [
+                D8_PATH,
+                "-JXmx8G",
+                jar_path,
+                "--output",
+                dex_file,
+                "--lib",
+                D8_LIBRARY_PATH,
+                "--min-api",
+                D8_MINIMUM_API,
+            ]
+        )
+        if output.returncode != 0:
+            raise ClientError("Error while running d8, aborting.")
 
-    return Path(dex_file)
+    _, dex_file = tempfile.mkstemp(suffix=".jar")
+    return _cached_artifact(
+        cache_directory,
+        "dex",
+        lambda: _cache_key(jar_path, _d8_version(), D8_LIBRARY_PATH, D8_MINIMUM_API),
+        build,
+        Path(dex_file),
+    )
 
 
 class VersionAction(argparse.Action):
@@ -281,6 +351,11 @@ def main() -> None:
                 type=str,
                 help="The buck mode for building the java target.",
             )
+            target_arguments.add_argument(
+                "--jar-cache-directory",
+                type=str,
+                help="Cache the desugared jar and the dex files of the java target in this directory, keyed by the content of the jar and the versions of the tools. Unchanged jars are not converted again.",
+            )
 
         output_arguments = parser.add_argument_group("Output arguments")
         output_arguments.add_argument(
@@ -294,6 +369,16 @@ def main() -> None:
             type=_directory_exists,
             help="Save generated models to this directory.",
         )
+        output_arguments.add_argument(
+            "--compress-models",
+            action="store_true",
+            help="Write models compressed with gzip, in `model@*.json.gz` instead of `model@*.json`.",
+        )
+        output_arguments.add_argument(
+            "--skip-default-models",
+            action="store_true",
+            help="Do not write models that are identical to the default model of their method, e.g methods without taint.",
+        )
 
         binary_arguments = parser.add_argument_group("Analysis binary arguments")
         binary_arguments.add_argument(
@@ -322,6 +407,11 @@ def main() -> None:
             default=os.fspath(configuration.get_path("rules.json")),
             help="A `;`-separated list of rules files and directories containing rules files.",
         )
+        configuration_arguments.add_argument(
+            "--rule-packs",
+            type=str,
+            help="A `;`-separated list of named rule packs `name=paths`, checked in the same analysis. The issues of each pack are also written to `issues@<name>.json`.",
+        )
         configuration_arguments.add_argument(
             "--repository-root-directory",
             type=_directory_exists,
@@ -373,6 +463,24 @@ def main() -> None:
             ),
             help="A `;`-separated list of paths where we look up JSON model generators.",
         )
+        configuration_arguments.add_argument(
+            "--previous-output-directory",
+            type=_directory_exists,
+            default=None,
+            help="Output directory of a previous run. Models of methods that did not change are reused instead of being analyzed again.",
+        )
+        configuration_arguments.add_argument(
+            "--types-cache-path",
+            type=str,
+            default=None,
+            help="Path to a cache of inferred types. Types of methods whose code did not change are read from the cache, and the cache is updated after the analysis. With `--previous-output-directory`, the global type analysis only runs on classes around the changed code.",
+        )
+        configuration_arguments.add_argument(
+            "--source-index-cache-path",
+            type=str,
+            default=None,
+            help="Path to a cache of the source index. Files whose size and modification time did not change are not read again, and the cache is updated after indexing.",
+        )
         configuration_arguments.add_argument(
             "--maximum-source-sink-distance",
             type=int,
@@ -386,6 +494,17 @@ def main() -> None:
             action="store_true",
             help="Run the analysis sequentially, one a single thread.",
         )
+        analysis_arguments.add_argument(
+            "--jobs",
+            type=int,
+            help="Number of threads of each parallel phase of the analysis. Defaults to the number of cores.",
+        )
+        analysis_arguments.add_argument(
+            "--phase-jobs",
+            action="append",
+            metavar="PHASE=JOBS",
+            help="Number of threads of a given phase, overriding `--jobs`, e.g `positions=64`.",
+        )
         analysis_arguments.add_argument(
             "--skip-source-indexing",
             action="store_true",
@@ -406,6 +525,117 @@ def main() -> None:
             type=int,
             help="Specify number of seconds as a bound. If the analysis of a method takes longer than this then make the method obscure (default taint-in-taint-out).",
         )
+        analysis_arguments.add_argument(
+            "--worklist-fixpoint",
+            action="store_true",
+            help="Compute the global fixpoint with a continuous worklist instead of global iterations.",
+        )
+        analysis_arguments.add_argument(
+            "--scc-local-fixpoint",
+            action="store_true",
+            help="Iterate each strongly connected component of the dependency graph to a local fixpoint before releasing its callers.",
+        )
+        analysis_arguments.add_argument(
+            "--deduplicate-methods",
+            action="store_true",
+            help="Analyze methods with identical code and callees once per iteration, when their model does not depend on their positions.",
+        )
+        analysis_arguments.add_argument(
+            "--summarize-trivial-methods",
+            action="store_true",
+            help="Build the models of methods without calls, writes or branches, such as getters, directly instead of running the fixpoint.",
+        )
+        analysis_arguments.add_argument(
+            "--demand-driven-analysis",
+            action="store_true",
+            help="Only analyze methods that can contribute to an issue: methods that transitively call a source or a sink of a rule, and their callees.",
+        )
+        analysis_arguments.add_argument(
+            "--entry-point-reachability",
+            action="store_true",
+            help="Only analyze methods reachable from entry points: classes of the manifest, life-cycle wrappers, overrides of framework methods and static initializers.",
+        )
+        analysis_arguments.add_argument(
+            "--entry-point-pattern",
+            action="append",
+            metavar="PATTERN",
+            help="Regular expression matching the signature of additional entry points for `--entry-point-reachability`.",
+        )
+        analysis_arguments.add_argument(
+            "--spill-cold-models",
+            action="store_true",
+            help="During the global fixpoint, move the models of methods that will not be analyzed again to memory-mapped files, to reduce memory usage.",
+        )
+        analysis_arguments.add_argument(
+            "--release-converged-methods",
+            action="store_true",
+            help="During the global fixpoint, free the control flow graphs, inferred types and call graph entries of methods that will not be analyzed again, to reduce memory usage.",
+        )
+        analysis_arguments.add_argument(
+            "--numa-aware-scheduling",
+            action="store_true",
+            help="Pin analysis workers to NUMA nodes and schedule strongly connected components on the node of their callees.",
+        )
+        analysis_arguments.add_argument(
+            "--disable-issue-stream",
+            action="store_true",
+            help="Do not append issues to `issues_stream.json` in the output directory during the global fixpoint.",
+        )
+        analysis_arguments.add_argument(
+            "--callsite-model-cache-size",
+            type=int,
+            help="Maximum number of callee models instantiated at call sites to cache across methods and iterations (default: disabled).",
+        )
+        analysis_arguments.add_argument(
+            "--maximum-types-memory-in-mb",
+            type=int,
+            help="Maximum memory used to keep inferred types. Types of the least recently queried methods are evicted and inferred again when needed (default: unbounded).",
+        )
+        analysis_arguments.add_argument(
+            "--checkpoint-interval",
+            type=int,
+            help="Every given number of global iterations, write the models and the methods left to analyze to `checkpoint.bin` in the output directory (default: disabled).",
+        )
+        analysis_arguments.add_argument(
+            "--resume-from",
+            type=_path_exists,
+            help="Resume the global fixpoint from a checkpoint written with `--checkpoint-interval`.",
+        )
+        analysis_arguments.add_argument(
+            "--write-library-summary",
+            action="store_true",
+            help="Write the models of all methods to `library_summary.bin` in the output directory after the analysis.",
+        )
+        analysis_arguments.add_argument(
+            "--library-summary-paths",
+            type=str,
+            help="A `;` separated list of library summaries written with `--write-library-summary`. Summarized methods are not analyzed.",
+        )
+        analysis_arguments.add_argument(
+            "--write-configuration-bundle",
+            action="store_true",
+            help="Write the parsed rules, lifecycles, heuristics and model generators to `configuration_bundle.bin` in the output directory.",
+        )
+        analysis_arguments.add_argument(
+            "--configuration-bundle-path",
+            type=_path_exists,
+            help="Load the configuration files from a bundle written with `--write-configuration-bundle`.",
+        )
+        analysis_arguments.add_argument(
+            "--partition-count",
+            type=int,
+            help="Distributed analysis: split the methods in the given number of partitions and only analyze `--partition-index`. See `scripts/distributed_analysis.py`.",
+        )
+        analysis_arguments.add_argument(
+            "--partition-index",
+            type=int,
+            help="Index of the partition analyzed by this process.",
+        )
+        analysis_arguments.add_argument(
+            "--partition-directory",
+            type=_directory_exists,
+            help="Directory shared by all partitions, where the models of each partition are exchanged.",
+        )
 
         debug_arguments = parser.add_argument_group("Debugging arguments")
         debug_arguments.add_argument(
@@ -452,6 +682,31 @@ def main() -> None:
             action="store_true",
             help="Dump a list of the method signatures in `methods.json`.",
         )
+        debug_arguments.add_argument(
+            "--dump-binary-models",
+            action="store_true",
+            help="Also write models in a compact binary format, in `model@*.bin`.",
+        )
+        debug_arguments.add_argument(
+            "--profile-analysis",
+            action="store_true",
+            help="Profile the analysis of each method, per transfer function, and write a report in `profile.json`.",
+        )
+        debug_arguments.add_argument(
+            "--convergence-report",
+            action="store_true",
+            help="Record which parts of the models grew at each global iteration, and write a report in `convergence_report.json`.",
+        )
+        debug_arguments.add_argument(
+            "--trace-phases",
+            action="store_true",
+            help="Record nested spans of the phases of the analysis with their wall and CPU time, and write them in `trace.json`.",
+        )
+        debug_arguments.add_argument(
+            "--performance-counters",
+            action="store_true",
+            help="Record hardware performance counters of the phases and of the slowest method analyses in the metadata.",
+        )
 
         arguments: argparse.Namespace = parser.parse_args()
 
@@ -483,8 +738,15 @@ def main() -> None:
                 arguments.java_target,
                 build_directory,
             )
-            desugared_jar_file = _desugar_jar_file(jar_file)
-            arguments.apk_path = os.fspath(_build_apk_from_jar(desugared_jar_file))
+            jar_cache_directory = (
+                Path(arguments.jar_cache_directory)
+                if arguments.jar_cache_directory
+                else None
+            )
+            desugared_jar_file = _desugar_jar_file(jar_file, jar_cache_directory)
+            arguments.apk_path = os.fspath(
+                _build_apk_from_jar(desugared_jar_file, jar_cache_directory)
+            )
 
         # Build the mariana trench binary if necessary.
         binary = _get_analysis_binary(arguments)
@@ -532,16 +794,37 @@ def main() -> None:
             options.append("--lifecycles-paths")
             options.append(arguments.lifecycles_paths)
 
+        if arguments.rule_packs:
+            options.append("--rule-packs")
+            options.append(arguments.rule_packs)
+
         if arguments.source_exclude_directories:
             options.append("--source-exclude-directories")
             options.append(arguments.source_exclude_directories)
 
+        if arguments.previous_output_directory:
+            options.append("--previous-output-directory")
+            options.append(arguments.previous_output_directory)
+
+        if arguments.types_cache_path:
+            options.append("--types-cache-path")
+            options.append(arguments.types_cache_path)
+
+        if arguments.source_index_cache_path:
+            options.append("--source-index-cache-path")
+            options.append(arguments.source_index_cache_path)
+
         if arguments.generated_models_directory:
             options.append("--generated-models-directory")
             options.append(arguments.generated_models_directory)
 
         if arguments.sequential:
             options.append("--sequential")
+        if arguments.jobs is not None:
+            options.append("--jobs=%d" % arguments.jobs)
+        if arguments.phase_jobs:
+            for phase_jobs in arguments.phase_jobs:
+                options.append("--phase-jobs=%s" % phase_jobs)
         if arguments.skip_source_indexing:
             options.append("--skip-source-indexing")
         if arguments.skip_model_generation:
@@ -553,6 +836,60 @@ def main() -> None:
         if arguments.maximum_method_analysis_time is not None:
             options.append("--maximum-method-analysis-time")
             options.append(str(arguments.maximum_method_analysis_time))
+        if arguments.worklist_fixpoint:
+            options.append("--worklist-fixpoint")
+        if arguments.scc_local_fixpoint:
+            options.append("--scc-local-fixpoint")
+        if arguments.deduplicate_methods:
+            options.append("--deduplicate-methods")
+        if arguments.summarize_trivial_methods:
+            options.append("--summarize-trivial-methods")
+        if arguments.demand_driven_analysis:
+            options.append("--demand-driven-analysis")
+        if arguments.entry_point_reachability:
+            options.append("--entry-point-reachability")
+        if arguments.entry_point_pattern:
+            for pattern in arguments.entry_point_pattern:
+                options.append("--entry-point-pattern=%s" % pattern)
+        if arguments.spill_cold_models:
+            options.append("--spill-cold-models")
+        if arguments.release_converged_methods:
+            options.append("--release-converged-methods")
+        if arguments.numa_aware_scheduling:
+            options.append("--numa-aware-scheduling")
+        if arguments.disable_issue_stream:
+            options.append("--disable-issue-stream")
+        if arguments.callsite_model_cache_size is not None:
+            options.append("--callsite-model-cache-size")
+            options.append(str(arguments.callsite_model_cache_size))
+        if arguments.maximum_types_memory_in_mb is not None:
+            options.append("--maximum-types-memory-in-mb")
+            options.append(str(arguments.maximum_types_memory_in_mb))
+        if arguments.checkpoint_interval is not None:
+            options.append("--checkpoint-interval")
+            options.append(str(arguments.checkpoint_interval))
+        if arguments.resume_from is not None:
+            options.append("--resume-from")
+            options.append(str(arguments.resume_from))
+        if arguments.write_library_summary:
+            options.append("--write-library-summary")
+        if arguments.library_summary_paths is not None:
+            options.append("--library-summary-paths")
+            options.append(arguments.library_summary_paths)
+        if arguments.write_configuration_bundle:
+            options.append("--write-configuration-bundle")
+        if arguments.configuration_bundle_path is not None:
+            options.append("--configuration-bundle-path")
+            options.append(str(arguments.configuration_bundle_path))
+        if arguments.partition_count is not None:
+            options.append("--partition-count")
+            options.append(str(arguments.partition_count))
+        if arguments.partition_index is not None:
+            options.append("--partition-index")
+            options.append(str(arguments.partition_index))
+        if arguments.partition_directory is not None:
+            options.append("--partition-directory")
+            options.append(str(arguments.partition_directory))
 
         trace_settings = [f"MARIANA_TRENCH:{arguments.verbosity}"]
         if "TRACE" in os.environ:
@@ -572,6 +909,20 @@ def main() -> None:
             options.append("--dump-dependencies")
         if arguments.dump_methods:
             options.append("--dump-methods")
+        if arguments.dump_binary_models:
+            options.append("--dump-binary-models")
+        if arguments.compress_models:
+            options.append("--compress-models")
+        if arguments.skip_default_models:
+            options.append("--skip-default-models")
+        if arguments.profile_analysis:
+            options.append("--profile-analysis")
+        if arguments.convergence_report:
+            options.append("--convergence-report")
+        if arguments.trace_phases:
+            options.append("--trace-phases")
+        if arguments.performance_counters:
+            options.append("--performance-counters")
 
         command = [os.fspath(binary.resolve())] + options
         if arguments.gdb:
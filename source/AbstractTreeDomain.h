@@ -7,9 +7,13 @@
 
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
 #include <functional>
 #include <initializer_list>
 #include <iterator>
+#include <optional>
 #include <vector>
 
 #include <AbstractDomain.h>
@@ -114,6 +118,7 @@ class AbstractTreeDomain final
   void set_to_bottom() override {
     elements_.set_to_bottom();
     children_.clear();
+    shape_.invalidate();
   }
 
   void set_to_top() override {
@@ -211,6 +216,18 @@ class AbstractTreeDomain final
     mt_expensive_assert(previous.leq(*this) && other.leq(*this));
   }
 
+  /* Join with a temporary tree, which is moved rather than copied if possible.
+   */
+  void join_with(AbstractTreeDomain&& other) {
+    if (other.is_bottom()) {
+      return;
+    } else if (is_bottom()) {
+      *this = std::move(other);
+    } else {
+      join_with_internal(other, Elements::bottom());
+    }
+  }
+
  private:
   void join_with_internal(
       const AbstractTreeDomain& other,
@@ -228,7 +245,11 @@ class AbstractTreeDomain final
 
     const auto new_accumulator_tree =
         AbstractTreeDomain{accumulator.join(elements_)};
-    Map new_children;
+    // Start from the current children and only update the subtrees that
+    // changed. Assigning a structurally equal subtree reuses the existing
+    // node, and assigning bottom removes the binding, so unchanged children
+    // do not allocate new nodes.
+    Map new_children = children_;
 
     for (const auto& [path_element, subtree] : children_) {
       const auto& other_subtree = other.children_.at(path_element);
@@ -237,13 +258,11 @@ class AbstractTreeDomain final
         auto subtree_copy = subtree;
         subtree_copy.join_with_internal(
             other_subtree, new_accumulator_tree.elements_);
-
-        if (!subtree_copy.is_bottom()) {
-          new_children.insert_or_assign(path_element, std::move(subtree_copy));
-        }
+        new_children.insert_or_assign(path_element, std::move(subtree_copy));
       } else {
-        if (!subtree.leq(new_accumulator_tree)) {
-          new_children.insert_or_assign(path_element, subtree);
+        if (subtree.leq(new_accumulator_tree)) {
+          new_children.insert_or_assign(
+              path_element, AbstractTreeDomain::bottom());
         }
       }
     }
@@ -261,6 +280,7 @@ class AbstractTreeDomain final
     }
 
     children_ = new_children;
+    shape_.invalidate();
   }
 
  public:
@@ -307,7 +327,8 @@ class AbstractTreeDomain final
 
     const auto new_accumulator_tree =
         AbstractTreeDomain{accumulator.join(elements_)};
-    Map new_children;
+    // See `join_with_internal`.
+    Map new_children = children_;
 
     for (const auto& [path_element, subtree] : children_) {
       const auto& other_subtree = other.children_.at(path_element);
@@ -316,15 +337,15 @@ class AbstractTreeDomain final
         auto subtree_copy = subtree;
         subtree_copy.widen_with_internal(
             other_subtree, new_accumulator_tree.elements_, max_height - 1);
-
-        if (!subtree_copy.is_bottom()) {
-          new_children.insert_or_assign(path_element, std::move(subtree_copy));
-        }
+        new_children.insert_or_assign(path_element, std::move(subtree_copy));
       } else {
-        if (!subtree.leq(new_accumulator_tree)) {
+        if (subtree.leq(new_accumulator_tree)) {
+          new_children.insert_or_assign(
+              path_element, AbstractTreeDomain::bottom());
+        } else {
           auto subtree_copy = subtree;
           subtree_copy.collapse_deeper_than(max_height - 1);
-          new_children.insert_or_assign(path_element, subtree_copy);
+          new_children.insert_or_assign(path_element, std::move(subtree_copy));
         }
       }
     }
@@ -344,6 +365,7 @@ class AbstractTreeDomain final
     }
 
     children_ = new_children;
+    shape_.invalidate();
   }
 
  public:
@@ -370,6 +392,7 @@ class AbstractTreeDomain final
       subtree.collapse_into(elements_);
     }
     children_.clear();
+    shape_.invalidate();
   }
 
   /* Collapse the tree into the given set of elements. */
@@ -381,15 +404,18 @@ class AbstractTreeDomain final
   }
 
   /* Collapse the tree to the given maximum height. */
-  void collapse_deeper_than(std::size_t height) {
-    if (height == 0) {
+  void collapse_deeper_than(std::size_t max_height) {
+    if (height() <= max_height) {
+      return;
+    } else if (max_height == 0) {
       collapse_inplace();
     } else {
       children_.map([=](const AbstractTreeDomain& subtree) {
         auto copy = subtree;
-        copy.collapse_deeper_than(height - 1);
+        copy.collapse_deeper_than(max_height - 1);
         return copy;
       });
+      shape_.invalidate();
     }
   }
 
@@ -407,6 +433,7 @@ class AbstractTreeDomain final
       copy.prune(accumulator);
       return copy;
     });
+    shape_.invalidate();
   }
 
   /**
@@ -414,27 +441,49 @@ class AbstractTreeDomain final
    *
    * A path is invalid if `is_valid().first` is `false`. If valid, the
    * Accumulator contains information about visited paths so far.
+   *
+   * `is_valid` has the signature
+   * `std::pair<bool, Accumulator>(const Accumulator&, PathElement)`.
    */
-  template <typename Accumulator>
+  template <typename Accumulator, typename IsValid>
   void collapse_invalid_paths(
-      const std::function<
-          std::pair<bool, Accumulator>(const Accumulator&, PathElement)>&
-          is_valid,
+      const IsValid& is_valid,
       const Accumulator& accumulator) {
-    Map new_children;
+    // See `join_with_internal`.
+    Map new_children = children_;
     for (const auto& [path_element, subtree] : children_) {
       const auto& [valid, accumulator_for_subtree] =
           is_valid(accumulator, path_element);
       if (!valid) {
         // Invalid path, collapse subtree into current tree.
         elements_.join_with(subtree.collapse());
+        new_children.insert_or_assign(
+            path_element, AbstractTreeDomain::bottom());
       } else {
         auto subtree_copy = subtree;
-        subtree_copy.collapse_invalid_paths(is_valid, accumulator_for_subtree);
+        subtree_copy.template collapse_invalid_paths<Accumulator>(
+            is_valid, accumulator_for_subtree);
         new_children.insert_or_assign(path_element, std::move(subtree_copy));
       }
     }
     children_ = new_children;
+    shape_.invalidate();
+  }
+
+  /**
+   * Return the number of leaves of the tree, i.e nodes without children, not
+   * counting the root.
+   *
+   * This is cached on each node, hence only the nodes that changed since the
+   * last call are visited.
+   */
+  std::size_t leaves() const {
+    return compute_shape().leaves;
+  }
+
+  /* Return the length of the longest path from the root to a leaf. */
+  std::size_t height() const {
+    return compute_shape().height;
   }
 
   /* Collapse children that have more than `max_leaves` leaves. */
@@ -449,6 +498,10 @@ class AbstractTreeDomain final
   /* Return the depth at which the tree exceeds the given number of leaves. */
   std::optional<std::size_t> depth_exceeding_max_leaves(
       std::size_t max_leaves) const {
+    if (leaves() <= max_leaves) {
+      return std::nullopt;
+    }
+
     // Set of trees at the current depth.
     std::vector<const AbstractTreeDomain*> trees = {this};
     std::size_t depth = 0;
@@ -504,10 +557,15 @@ class AbstractTreeDomain final
         case UpdateKind::Strong: {
           elements_ = std::move(elements);
           children_.clear();
+          shape_.invalidate();
           break;
         }
         case UpdateKind::Weak: {
-          elements_.join_with(elements);
+          if (elements_.is_bottom()) {
+            elements_ = std::move(elements);
+          } else {
+            elements_.join_with(elements);
+          }
           accumulator.join_with(elements_);
           prune_children(accumulator);
           break;
@@ -533,6 +591,7 @@ class AbstractTreeDomain final
           return new_subtree;
         },
         path_head);
+    shape_.invalidate();
   }
 
  public:
@@ -557,7 +616,13 @@ class AbstractTreeDomain final
           break;
         }
         case UpdateKind::Weak: {
-          join_with_internal(tree, accumulator);
+          if (is_bottom() && accumulator.is_bottom()) {
+            // Avoid copying the given tree, which is common when writing to a
+            // new path.
+            *this = std::move(tree);
+          } else {
+            join_with_internal(tree, accumulator);
+          }
           break;
         }
       }
@@ -577,6 +642,7 @@ class AbstractTreeDomain final
           return new_subtree;
         },
         path_head);
+    shape_.invalidate();
   }
 
  public:
@@ -636,14 +702,15 @@ class AbstractTreeDomain final
   /**
    * Return the subtree at the given path.
    *
-   * Elements are NOT propagated down to children.
+   * Elements are NOT propagated down to children. The subtree is returned by
+   * reference, without copying.
    */
-  AbstractTreeDomain raw_read(const Path& path) const {
+  const AbstractTreeDomain& raw_read(const Path& path) const {
     return raw_read_internal(path.begin(), path.end());
   }
 
  private:
-  AbstractTreeDomain raw_read_internal(
+  const AbstractTreeDomain& raw_read_internal(
       Path::ConstIterator begin,
       Path::ConstIterator end) const {
     if (is_bottom() || begin == end) {
@@ -653,21 +720,82 @@ class AbstractTreeDomain final
     return children_.at(*begin).raw_read_internal(std::next(begin), end);
   }
 
+ public:
+  /**
+   * A subtree returned by `read_borrowed`. It is either a reference into the
+   * tree it was read from, which is only valid while that tree is neither
+   * modified nor destroyed, or a tree owned by the result.
+   */
+  class Borrowed final {
+   public:
+    explicit Borrowed(const AbstractTreeDomain& tree) : tree_(&tree) {}
+
+    explicit Borrowed(AbstractTreeDomain&& tree)
+        : owned_(std::move(tree)), tree_(&*owned_) {}
+
+    Borrowed(const Borrowed&) = delete;
+
+    Borrowed(Borrowed&& other) noexcept
+        : owned_(std::move(other.owned_)),
+          tree_(owned_.has_value() ? &*owned_ : other.tree_) {}
+
+    Borrowed& operator=(const Borrowed&) = delete;
+    Borrowed& operator=(Borrowed&&) = delete;
+    ~Borrowed() = default;
+
+    const AbstractTreeDomain& operator*() const {
+      return *tree_;
+    }
+
+    const AbstractTreeDomain* operator->() const {
+      return tree_;
+    }
+
+    /* Whether the subtree was built by the read rather than borrowed. */
+    bool owned() const {
+      return owned_.has_value();
+    }
+
+   private:
+    std::optional<AbstractTreeDomain> owned_;
+    const AbstractTreeDomain* tree_;
+  };
+
+  /**
+   * Return the subtree at the given path, with the same semantics as `read`.
+   *
+   * When no node on the path has elements, nothing is propagated down and the
+   * subtree is returned by reference, without copying. Otherwise, the
+   * subtree is built from the first node with elements.
+   */
+  template <typename Propagate>
+  Borrowed read_borrowed(const Path& path, const Propagate& propagate) const {
+    const AbstractTreeDomain* tree = this;
+    for (auto iterator = path.begin(), end = path.end(); iterator != end;
+         ++iterator) {
+      if (!tree->elements_.is_bottom()) {
+        return Borrowed(tree->read_internal(iterator, end, propagate));
+      }
+      tree = &tree->children_.at(*iterator);
+    }
+    return Borrowed(*tree);
+  }
+
  public:
   /**
    * Iterate on all non-empty elements in the tree.
    *
    * When visiting the tree, elements do not include their ancestors.
    */
-  void visit(std::function<void(const Path&, const Elements&)> visitor) const {
+  template <typename Visitor> // void(const Path&, const Elements&)
+  void visit(Visitor&& visitor) const {
     Path path;
     visit_internal(path, visitor);
   }
 
  private:
-  void visit_internal(
-      Path& path,
-      std::function<void(const Path&, const Elements&)>& visitor) const {
+  template <typename Visitor>
+  void visit_internal(Path& path, Visitor& visitor) const {
     if (!elements_.is_bottom()) {
       visitor(path, elements_);
     }
@@ -695,14 +823,14 @@ class AbstractTreeDomain final
   }
 
   /* Apply the given function on all elements. */
-  void map(const std::function<void(Elements&)>& f) {
+  template <typename Function> // void(Elements&)
+  void map(Function&& f) {
     map_internal(f, Elements::bottom());
   }
 
  private:
-  void map_internal(
-      const std::function<void(Elements&)>& f,
-      Elements accumulator) {
+  template <typename Function>
+  void map_internal(Function& f, Elements accumulator) {
     if (!elements_.is_bottom()) {
       f(elements_);
       elements_.difference_with(accumulator);
@@ -714,6 +842,7 @@ class AbstractTreeDomain final
       copy.map_internal(f, accumulator);
       return copy;
     });
+    shape_.invalidate();
   }
 
  public:
@@ -743,6 +872,84 @@ class AbstractTreeDomain final
     }
   }
 
+ private:
+  struct Shape {
+    std::uint32_t leaves;
+    std::uint32_t height;
+  };
+
+  /**
+   * Cache of the shape of a tree.
+   *
+   * Subtrees are shared between trees and threads, hence the cache is filled
+   * lazily using a relaxed atomic. Racing threads compute the same value.
+   */
+  class ShapeCache final {
+   private:
+    static constexpr std::uint64_t kUnknown = ~std::uint64_t(0);
+
+   public:
+    ShapeCache() : value_(kUnknown) {}
+    ShapeCache(const ShapeCache& other) : value_(other.load()) {}
+    // The children of a moved-from tree are unspecified.
+    ShapeCache(ShapeCache&& other) noexcept : value_(other.load()) {
+      other.invalidate();
+    }
+    ShapeCache& operator=(const ShapeCache& other) {
+      value_.store(other.load(), std::memory_order_relaxed);
+      return *this;
+    }
+    ShapeCache& operator=(ShapeCache&& other) noexcept {
+      value_.store(other.load(), std::memory_order_relaxed);
+      other.invalidate();
+      return *this;
+    }
+    ~ShapeCache() = default;
+
+    std::optional<Shape> get() const {
+      auto value = load();
+      if (value == kUnknown) {
+        return std::nullopt;
+      }
+      return Shape{
+          static_cast<std::uint32_t>(value >> 32),
+          static_cast<std::uint32_t>(value)};
+    }
+
+    void set(Shape shape) const {
+      value_.store(
+          (std::uint64_t(shape.leaves) << 32) | shape.height,
+          std::memory_order_relaxed);
+    }
+
+    void invalidate() {
+      value_.store(kUnknown, std::memory_order_relaxed);
+    }
+
+   private:
+    std::uint64_t load() const {
+      return value_.load(std::memory_order_relaxed);
+    }
+
+   private:
+    mutable std::atomic<std::uint64_t> value_;
+  };
+
+  Shape compute_shape() const {
+    if (auto shape = shape_.get()) {
+      return *shape;
+    }
+
+    auto shape = Shape{0, 0};
+    for (const auto& [path_element, subtree] : children_) {
+      auto subtree_shape = subtree.compute_shape();
+      shape.leaves += subtree.children_.empty() ? 1 : subtree_shape.leaves;
+      shape.height = std::max(shape.height, subtree_shape.height + 1);
+    }
+    shape_.set(shape);
+    return shape;
+  }
+
  private:
   // The abstract elements at this node.
   // In theory, this includes all the elements from the ancestors.
@@ -751,6 +958,9 @@ class AbstractTreeDomain final
 
   // The edges to the child nodes.
   Map children_;
+
+  // The shape of the tree, invalidated whenever `children_` changes.
+  ShapeCache shape_;
 };
 
 } // namespace marianatrench
@@ -44,52 +44,73 @@ std::optional<ParameterPosition> parse_parameter_position(
 }
 
 bool Path::operator==(const Path& other) const {
-  return elements_ == other.elements_;
+  return size_ == other.size_ && hash_ == other.hash_ &&
+      std::equal(begin(), end(), other.begin());
 }
 
 void Path::append(Element element) {
   mt_assert(element != nullptr);
-  elements_.push_back(element);
+  if (size_ < kInlineCapacity) {
+    inline_elements_[size_] = element;
+  } else {
+    if (size_ == kInlineCapacity) {
+      heap_elements_.assign(inline_elements_.begin(), inline_elements_.end());
+    }
+    heap_elements_.push_back(element);
+  }
+  size_++;
+  boost::hash_combine(hash_, element);
 }
 
 void Path::extend(const Path& path) {
-  elements_.insert(
-      elements_.end(), path.elements_.begin(), path.elements_.end());
+  for (auto element : path) {
+    append(element);
+  }
 }
 
 void Path::pop_back() {
-  mt_assert(!elements_.empty());
-  elements_.pop_back();
+  mt_assert(size_ > 0);
+  resize(size_ - 1);
 }
 
 void Path::truncate(std::size_t max_size) {
-  if (elements_.size() > max_size) {
-    elements_.resize(max_size);
+  if (size_ > max_size) {
+    resize(max_size);
   }
 }
 
 bool Path::is_prefix_of(const Path& other) const {
-  auto result = std::mismatch(
-      elements_.begin(),
-      elements_.end(),
-      other.elements_.begin(),
-      other.elements_.end());
-  return result.first == elements_.end();
+  auto result = std::mismatch(begin(), end(), other.begin(), other.end());
+  return result.first == end();
 }
 
 void Path::reduce_to_common_prefix(const Path& other) {
-  auto result = std::mismatch(
-      elements_.begin(),
-      elements_.end(),
-      other.elements_.begin(),
-      other.elements_.end());
-  elements_.erase(result.first, elements_.end());
+  auto result = std::mismatch(begin(), end(), other.begin(), other.end());
+  resize(static_cast<std::size_t>(result.first - begin()));
+}
+
+void Path::resize(std::size_t size) {
+  mt_assert(size <= size_);
+  if (size_ > kInlineCapacity && size <= kInlineCapacity) {
+    std::copy(
+        heap_elements_.begin(),
+        heap_elements_.begin() + size,
+        inline_elements_.begin());
+    heap_elements_.clear();
+  } else if (size > kInlineCapacity) {
+    heap_elements_.resize(size);
+  }
+  size_ = size;
+
+  hash_ = 0;
+  for (auto element : *this) {
+    boost::hash_combine(hash_, element);
+  }
 }
 
 std::ostream& operator<<(std::ostream& out, const Path& path) {
   out << "Path[";
-  for (auto iterator = path.elements_.begin(), end = path.elements_.end();
-       iterator != end;) {
+  for (auto iterator = path.begin(), end = path.end(); iterator != end;) {
     out << "`" << show(*iterator) << "`";
     ++iterator;
     if (iterator != end) {
@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include <array>
 #include <initializer_list>
 #include <limits>
 #include <optional>
@@ -40,11 +41,15 @@ std::optional<ParameterPosition> parse_parameter_position(
 
 /**
  * Represents the path of an access path, without the root, e.g. `x.y.z`
+ *
+ * Paths are almost always short (see `Heuristics`), hence up to
+ * `kInlineCapacity` elements are stored inline, without allocating. The hash
+ * is maintained on updates, which makes hashing and comparing paths cheap.
  */
 class Path final {
  public:
   using Element = const DexString*;
-  using ConstIterator = std::vector<Element>::const_iterator;
+  using ConstIterator = const Element*;
 
  public:
   // C++ container concept member types
@@ -56,11 +61,16 @@ class Path final {
   using const_reference = const Element&;
   using const_pointer = const Element*;
 
+  constexpr static std::size_t kInlineCapacity = 4;
+
  public:
   Path() = default;
 
-  explicit Path(std::initializer_list<Element> elements)
-      : elements_(elements) {}
+  explicit Path(std::initializer_list<Element> elements) {
+    for (auto element : elements) {
+      append(element);
+    }
+  }
 
   Path(const Path&) = default;
   Path(Path&&) = default;
@@ -79,19 +89,23 @@ class Path final {
   void truncate(std::size_t max_size);
 
   bool empty() const {
-    return elements_.empty();
+    return size_ == 0;
   }
 
   std::size_t size() const {
-    return elements_.size();
+    return size_;
   }
 
   ConstIterator begin() const {
-    return elements_.cbegin();
+    return data();
   }
 
   ConstIterator end() const {
-    return elements_.cend();
+    return data() + size_;
+  }
+
+  std::size_t hash() const {
+    return hash_;
   }
 
   bool is_prefix_of(const Path& other) const;
@@ -99,10 +113,21 @@ class Path final {
   void reduce_to_common_prefix(const Path& other);
 
  private:
+  const Element* data() const {
+    return size_ <= kInlineCapacity ? inline_elements_.data()
+                                    : heap_elements_.data();
+  }
+
+  void resize(std::size_t size);
+
   friend std::ostream& operator<<(std::ostream& out, const Path& path);
 
  private:
-  std::vector<Element> elements_;
+  std::size_t size_ = 0;
+  std::size_t hash_ = 0;
+  std::array<Element, kInlineCapacity> inline_elements_ = {};
+  // Holds all elements when the path is longer than `kInlineCapacity`.
+  std::vector<Element> heap_elements_;
 };
 
 } // namespace marianatrench
@@ -110,11 +135,7 @@ class Path final {
 template <>
 struct std::hash<marianatrench::Path> {
   std::size_t operator()(const marianatrench::Path& path) const {
-    std::size_t seed = 0;
-    for (auto* path_element : path) {
-      boost::hash_combine(seed, path_element);
-    }
-    return seed;
+    return path.hash();
   }
 };
 
@@ -0,0 +1,22 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <mariana-trench/AccessPathFactory.h>
+
+namespace marianatrench {
+
+const AccessPath* AccessPathFactory::get(const AccessPath& access_path) const {
+  return factory_.create(access_path);
+}
+
+const AccessPathFactory& AccessPathFactory::singleton() {
+  // Never destroyed: frames in static storage may outlive the factory.
+  static const auto* factory = new AccessPathFactory();
+  return *factory;
+}
+
+} // namespace marianatrench
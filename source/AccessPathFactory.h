@@ -0,0 +1,48 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <mariana-trench/Access.h>
+#include <mariana-trench/UniquePointerFactory.h>
+
+namespace marianatrench {
+
+/**
+ * Interns access paths.
+ *
+ * Frames are copied into many models, and most of them share a small number
+ * of callee ports. Storing a unique pointer instead of an access path avoids
+ * a heap allocation per copy and makes comparisons a pointer compare.
+ *
+ * Interned access paths live until the end of the program.
+ */
+class AccessPathFactory final {
+ public:
+  AccessPathFactory() = default;
+  AccessPathFactory(const AccessPathFactory&) = delete;
+  AccessPathFactory(AccessPathFactory&&) = delete;
+  AccessPathFactory& operator=(const AccessPathFactory&) = delete;
+  AccessPathFactory& operator=(AccessPathFactory&&) = delete;
+  ~AccessPathFactory() = default;
+
+  /* Return the unique pointer for the given access path. Thread-safe. */
+  const AccessPath* get(const AccessPath& access_path) const;
+
+  /* Return the unique pointer for the `Leaf` access path. */
+  const AccessPath* leaf() const {
+    return leaf_;
+  }
+
+  static const AccessPathFactory& singleton();
+
+ private:
+  UniquePointerFactory<AccessPath, AccessPath> factory_;
+  const AccessPath* leaf_ = get(AccessPath(Root(Root::Kind::Leaf)));
+};
+
+} // namespace marianatrench
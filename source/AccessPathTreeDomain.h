@@ -159,7 +159,7 @@ class AccessPathTreeDomain final
     return map_.get(access_path.root()).read(access_path.path());
   }
 
-  AbstractTreeDomainT raw_read(const AccessPath& access_path) const {
+  const AbstractTreeDomainT& raw_read(const AccessPath& access_path) const {
     return map_.get(access_path.root()).raw_read(access_path.path());
   }
 
@@ -168,8 +168,8 @@ class AccessPathTreeDomain final
    *
    * When visiting the tree, elements do not include their ancestors.
    */
-  void visit(
-      std::function<void(const AccessPath&, const Elements&)> visitor) const {
+  template <typename Visitor> // void(const AccessPath&, const Elements&)
+  void visit(Visitor&& visitor) const {
     mt_assert(!is_top());
 
     for (const auto& [root, tree] : map_) {
@@ -179,10 +179,11 @@ class AccessPathTreeDomain final
   }
 
  private:
+  template <typename Visitor>
   static void visit_internal(
       AccessPath& access_path,
       const AbstractTreeDomainT& tree,
-      std::function<void(const AccessPath&, const Elements&)>& visitor) {
+      Visitor& visitor) {
     if (!tree.root().is_bottom()) {
       visitor(access_path, tree.root());
     }
@@ -210,7 +211,8 @@ class AccessPathTreeDomain final
   }
 
   /* Apply the given function on all elements. */
-  void map(const std::function<void(Elements&)>& f) {
+  template <typename Function> // void(Elements&)
+  void map(Function&& f) {
     map_.map([&](const AbstractTreeDomainT& tree) {
       auto copy = tree;
       copy.map(f);
@@ -231,17 +233,20 @@ class AccessPathTreeDomain final
   /**
    * When a path is invalid, collapse its taint into its parent's.
    * See AbstractTreeDomain::collapse_invalid_paths.
+   *
+   * `initial_accumulator` has the signature `Accumulator(const Root&)`.
    */
-  template <typename Accumulator>
+  template <
+      typename Accumulator,
+      typename IsValid,
+      typename InitialAccumulator>
   void collapse_invalid_paths(
-      const std::function<
-          std::pair<bool, Accumulator>(const Accumulator&, Path::Element)>&
-          is_valid,
-      const std::function<Accumulator(const Root&)>& initial_accumulator) {
+      const IsValid& is_valid,
+      const InitialAccumulator& initial_accumulator) {
     Map new_map;
     for (const auto& [root, tree] : map_) {
       auto copy = tree;
-      copy.collapse_invalid_paths(
+      copy.template collapse_invalid_paths<Accumulator>(
           is_valid,
           /* accumulator */ initial_accumulator(root));
       new_map.set(root, std::move(copy));
@@ -259,6 +264,15 @@ class AccessPathTreeDomain final
     });
   }
 
+  /* Collapse the paths of all roots to the given maximum height. */
+  void collapse_deeper_than(std::size_t max_height) {
+    map_.map([=](const AbstractTreeDomainT& tree) {
+      auto copy = tree;
+      copy.collapse_deeper_than(max_height);
+      return copy;
+    });
+  }
+
   friend std::ostream& operator<<(
       std::ostream& out,
       const AccessPathTreeDomain& tree) {
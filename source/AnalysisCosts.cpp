@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <boost/algorithm/string.hpp>
+#include <boost/filesystem/fstream.hpp>
+#include <fmt/format.h>
+
+#include <ControlFlow.h>
+#include <IRCode.h>
+
+#include <mariana-trench/AnalysisCosts.h>
+#include <mariana-trench/MemoryAccounting.h>
+
+namespace marianatrench {
+
+namespace {
+
+constexpr std::string_view kHeader =
+    "method,analysis_seconds,analyses,model_bytes,instructions";
+
+std::size_t number_of_instructions(const Method* method) {
+  const auto* code = method->get_code();
+  if (code == nullptr) {
+    return 0;
+  }
+  return code->cfg_built() ? code->cfg().num_opcodes() : code->count_opcodes();
+}
+
+} // namespace
+
+void AnalysisCosts::write(
+    std::ostream& stream,
+    const Methods& methods,
+    const Statistics& statistics,
+    const Registry& registry) {
+  auto method_times = statistics.method_times();
+
+  std::unordered_map<const Method*, std::size_t> model_bytes;
+  for (const auto& [method, bytes] :
+       registry.memory_accounting().method_bytes()) {
+    model_bytes.emplace(method, bytes);
+  }
+
+  stream << kHeader << "\n";
+  // Follow the order of methods, for a deterministic output.
+  for (const auto* method : methods) {
+    auto found = method_times.find(method);
+    if (found == method_times.end()) {
+      continue;
+    }
+    const auto& time = found->second;
+    auto bytes = model_bytes.find(method);
+    stream << fmt::format(
+        "{},{:.6f},{},{},{}\n",
+        method->signature(),
+        time.total,
+        time.analyses,
+        bytes != model_bytes.end() ? bytes->second : 0,
+        number_of_instructions(method));
+  }
+}
+
+void AnalysisCosts::write(
+    const boost::filesystem::path& path,
+    const Methods& methods,
+    const Statistics& statistics,
+    const Registry& registry) {
+  boost::filesystem::ofstream file;
+  file.exceptions(std::ofstream::failbit | std::ofstream::badbit);
+  file.open(path, std::ios_base::binary);
+  write(file, methods, statistics, registry);
+  file.close();
+}
+
+std::unordered_map<const Method*, double> AnalysisCosts::read_cost_profile(
+    std::istream& stream,
+    const Methods& methods) {
+  std::string line;
+  if (!std::getline(stream, line) || line != kHeader) {
+    throw std::invalid_argument(
+        fmt::format("Expected analysis costs header `{}`", kHeader));
+  }
+
+  std::unordered_map<const Method*, double> cost_profile;
+  std::vector<std::string> columns;
+  while (std::getline(stream, line)) {
+    if (line.empty()) {
+      continue;
+    }
+
+    boost::split(columns, line, boost::is_any_of(","));
+    if (columns.size() != 5) {
+      throw std::invalid_argument(
+          fmt::format("Invalid analysis costs line: `{}`", line));
+    }
+
+    double seconds = 0.0;
+    std::size_t analyses = 0;
+    try {
+      seconds = std::stod(columns[1]);
+      analyses = std::stoul(columns[2]);
+    } catch (const std::logic_error&) {
+      throw std::invalid_argument(
+          fmt::format("Invalid analysis costs line: `{}`", line));
+    }
+
+    if (analyses == 0) {
+      continue;
+    }
+    const auto* method = methods.get(columns[0]);
+    if (method == nullptr) {
+      // The method was removed since the costs were written.
+      continue;
+    }
+    cost_profile.emplace(method, seconds / static_cast<double>(analyses));
+  }
+  return cost_profile;
+}
+
+std::unordered_map<const Method*, double> AnalysisCosts::read_cost_profile(
+    const boost::filesystem::path& path,
+    const Methods& methods) {
+  boost::filesystem::ifstream file(path);
+  if (!file) {
+    throw std::invalid_argument(
+        fmt::format("Could not open `{}`", path.native()));
+  }
+  return read_cost_profile(file, methods);
+}
+
+} // namespace marianatrench
@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <istream>
+#include <ostream>
+#include <unordered_map>
+
+#include <boost/filesystem.hpp>
+
+#include <mariana-trench/Method.h>
+#include <mariana-trench/Methods.h>
+#include <mariana-trench/Registry.h>
+#include <mariana-trench/Statistics.h>
+
+namespace marianatrench {
+
+/**
+ * Cost of the analysis of each analyzed method, persisted across runs.
+ *
+ * This is written as a csv file with the columns:
+ * ```
+ * method,analysis_seconds,analyses,model_bytes,instructions
+ * ```
+ * where `analysis_seconds` is the total time spent analyzing the method over
+ * all global iterations, `analyses` is the number of times it was analyzed
+ * and `model_bytes` is the approximate size of its final model (see
+ * `MemoryAccounting`). Method signatures never contain commas.
+ */
+class AnalysisCosts final {
+ public:
+  static void write(
+      std::ostream& stream,
+      const Methods& methods,
+      const Statistics& statistics,
+      const Registry& registry);
+  static void write(
+      const boost::filesystem::path& path,
+      const Methods& methods,
+      const Statistics& statistics,
+      const Registry& registry);
+
+  /**
+   * Read the average duration of an analysis of each method, in seconds, to
+   * be used as the cost profile of the `Scheduler`.
+   *
+   * Methods that do not exist in the current run are ignored.
+   */
+  static std::unordered_map<const Method*, double> read_cost_profile(
+      std::istream& stream,
+      const Methods& methods);
+  static std::unordered_map<const Method*, double> read_cost_profile(
+      const boost::filesystem::path& path,
+      const Methods& methods);
+};
+
+} // namespace marianatrench
@@ -7,6 +7,9 @@
 
 #include <mariana-trench/AnalysisEnvironment.h>
 
+#include <unordered_set>
+#include <vector>
+
 #include <Show.h>
 
 #include <mariana-trench/Assert.h>
@@ -211,6 +214,65 @@ TaintTree AnalysisEnvironment::read(Register register_id, const Path& path)
   return taint;
 }
 
+namespace {
+
+/* Return the only element of the given set, or null. */
+MemoryLocation* MT_NULLABLE
+singleton(const MemoryLocationsDomain& memory_locations) {
+  const auto& elements = memory_locations.elements();
+  auto iterator = elements.begin();
+  if (iterator == elements.end()) {
+    return nullptr;
+  }
+  auto* memory_location = *iterator;
+  return ++iterator == elements.end() ? memory_location : nullptr;
+}
+
+} // namespace
+
+TaintTree::Borrowed AnalysisEnvironment::read_borrowed(
+    MemoryLocation* memory_location) const {
+  return taint_.get(memory_location->root())
+      .read_borrowed(memory_location->path(), propagate_artificial_sources);
+}
+
+TaintTree::Borrowed AnalysisEnvironment::read_borrowed(
+    MemoryLocation* memory_location,
+    const Path& path) const {
+  Path full_path = memory_location->path();
+  full_path.extend(path);
+
+  return taint_.get(memory_location->root())
+      .read_borrowed(full_path, propagate_artificial_sources);
+}
+
+TaintTree::Borrowed AnalysisEnvironment::read_borrowed(
+    const MemoryLocationsDomain& memory_locations) const {
+  if (memory_locations.is_value()) {
+    if (auto* memory_location = singleton(memory_locations)) {
+      return read_borrowed(memory_location);
+    }
+  }
+  return TaintTree::Borrowed(read(memory_locations));
+}
+
+TaintTree::Borrowed AnalysisEnvironment::read_borrowed(
+    Register register_id) const {
+  return read_borrowed(memory_locations_.get(register_id));
+}
+
+TaintTree::Borrowed AnalysisEnvironment::read_borrowed(
+    Register register_id,
+    const Path& path) const {
+  const auto& memory_locations = memory_locations_.get(register_id);
+  if (memory_locations.is_value()) {
+    if (auto* memory_location = singleton(memory_locations)) {
+      return read_borrowed(memory_location, path);
+    }
+  }
+  return TaintTree::Borrowed(read(register_id, path));
+}
+
 void AnalysisEnvironment::write(
     MemoryLocation* memory_location,
     TaintTree taint,
@@ -337,6 +399,50 @@ void AnalysisEnvironment::increment_last_parameter_loaded() {
   }
 }
 
+std::size_t AnalysisEnvironment::size() const {
+  std::size_t size = 0;
+  if (!memory_locations_.is_top()) {
+    size += memory_locations_.bindings().size();
+  }
+  if (!taint_.is_top()) {
+    size += taint_.bindings().size();
+  }
+  return size;
+}
+
+void AnalysisEnvironment::prune_dead_registers(
+    const std::function<bool(Register)>& is_live) {
+  if (memory_locations_.is_top() || taint_.is_top()) {
+    return;
+  }
+
+  std::vector<Register> dead_registers;
+  std::unordered_set<const MemoryLocation*> live_roots;
+  for (const auto& [register_id, memory_locations] :
+       memory_locations_.bindings()) {
+    if (register_id != k_result_register && !is_live(register_id)) {
+      dead_registers.push_back(register_id);
+    } else if (memory_locations.is_value()) {
+      for (auto* memory_location : memory_locations.elements()) {
+        live_roots.insert(memory_location->root());
+      }
+    }
+  }
+  for (auto register_id : dead_registers) {
+    memory_locations_.set(register_id, MemoryLocationsDomain::bottom());
+  }
+
+  std::vector<MemoryLocation*> dead_roots;
+  for (const auto& [root, taint] : taint_.bindings()) {
+    if (!root->is<ParameterMemoryLocation>() && live_roots.count(root) == 0) {
+      dead_roots.push_back(root);
+    }
+  }
+  for (auto* root : dead_roots) {
+    taint_.set(root, TaintTree::bottom());
+  }
+}
+
 std::ostream& operator<<(
     std::ostream& out,
     const AnalysisEnvironment& environment) {
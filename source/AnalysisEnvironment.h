@@ -7,6 +7,9 @@
 
 #pragma once
 
+#include <functional>
+#include <limits>
+
 #include <AbstractDomain.h>
 #include <ConstantAbstractDomain.h>
 #include <PatriciaTreeMapAbstractPartition.h>
@@ -32,6 +35,9 @@ using TaintAbstractPartition =
 
 using DexPositionDomain = sparta::ConstantAbstractDomain<DexPosition*>;
 
+/* Pseudo-register holding the result of the previous instruction. */
+constexpr Register k_result_register = std::numeric_limits<Register>::max();
+
 using LastParameterLoadDomain =
     sparta::ConstantAbstractDomain<ParameterPosition>;
 
@@ -97,6 +103,26 @@ class AnalysisEnvironment final
 
   TaintTree read(Register register_id, const Path& path) const;
 
+  /**
+   * Same as `read`, for callers that only inspect the taint tree. The tree is
+   * borrowed from the environment, without copying, when it is read from a
+   * single memory location and no taint is propagated down the path. The
+   * result must not outlive a modification of the environment.
+   */
+  TaintTree::Borrowed read_borrowed(MemoryLocation* memory_location) const;
+
+  TaintTree::Borrowed read_borrowed(
+      MemoryLocation* memory_location,
+      const Path& path) const;
+
+  TaintTree::Borrowed read_borrowed(
+      const MemoryLocationsDomain& memory_locations) const;
+
+  TaintTree::Borrowed read_borrowed(Register register_id) const;
+
+  TaintTree::Borrowed read_borrowed(Register register_id, const Path& path)
+      const;
+
   void write(MemoryLocation* memory_location, TaintTree taint, UpdateKind kind);
 
   void write(
@@ -130,6 +156,16 @@ class AnalysisEnvironment final
 
   void increment_last_parameter_loaded();
 
+  /* Number of registers and memory locations bound in the environment. */
+  std::size_t size() const;
+
+  /**
+   * Remove the registers that are not live, and the taint of memory locations
+   * that cannot be read anymore, i.e whose root is neither a parameter nor
+   * pointed to by a live register. The result register is always kept.
+   */
+  void prune_dead_registers(const std::function<bool(Register)>& is_live);
+
   friend std::ostream& operator<<(
       std::ostream& out,
       const AnalysisEnvironment& environment);
@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <vector>
+
+#include <IRCode.h>
+
+#include <mariana-trench/AnalysisSlice.h>
+#include <mariana-trench/CallGraph.h>
+#include <mariana-trench/Dependencies.h>
+#include <mariana-trench/Log.h>
+#include <mariana-trench/Methods.h>
+
+namespace marianatrench {
+
+namespace {
+
+bool has_taint(const Model& model) {
+  return !model.generations().is_bottom() ||
+      !model.parameter_sources().is_bottom() || !model.sinks().is_bottom();
+}
+
+bool reads_modeled_field(
+    const Method* method,
+    const CallGraph& call_graph,
+    const Registry& registry) {
+  const auto* code = method->get_code();
+  if (code == nullptr || !code->cfg_built()) {
+    return false;
+  }
+  for (const auto* block : code->cfg().blocks()) {
+    for (const auto& entry : InstructionIterable(block)) {
+      const auto* field =
+          call_graph.resolved_field_access(method, entry.insn);
+      if (field == nullptr) {
+        continue;
+      }
+      const auto* field_model = registry.field_model(field);
+      if (field_model != nullptr && !field_model->empty()) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+} // namespace
+
+std::unordered_set<const Method*> AnalysisSlice::relevant_methods(
+    const Context& context,
+    const Registry& registry) {
+  const auto& call_graph = *context.call_graph;
+  bool has_field_models = registry.field_models_size() > 0;
+
+  // Methods that transitively call a method with sources or sinks.
+  std::unordered_set<const Method*> callers;
+  std::vector<const Method*> worklist;
+  for (const auto* method : *context.methods) {
+    if (has_taint(*registry.get_snapshot(method)) ||
+        (has_field_models &&
+         reads_modeled_field(method, call_graph, registry))) {
+      worklist.push_back(method);
+    }
+  }
+  while (!worklist.empty()) {
+    const auto* method = worklist.back();
+    worklist.pop_back();
+    if (!callers.insert(method).second) {
+      continue;
+    }
+    for (const auto* caller : context.dependencies->dependencies(method)) {
+      if (callers.count(caller) == 0) {
+        worklist.push_back(caller);
+      }
+    }
+  }
+
+  // Their transitive callees, including overrides and artificial callees.
+  std::unordered_set<const Method*> relevant_methods;
+  worklist.assign(callers.begin(), callers.end());
+  auto add_callee = [&](const Method* MT_NULLABLE callee) {
+    if (callee != nullptr && relevant_methods.count(callee) == 0) {
+      worklist.push_back(callee);
+    }
+  };
+  while (!worklist.empty()) {
+    const auto* method = worklist.back();
+    worklist.pop_back();
+    if (!relevant_methods.insert(method).second) {
+      continue;
+    }
+    for (const auto& call_target : call_graph.callees(method)) {
+      if (!call_target.resolved()) {
+        continue;
+      }
+      add_callee(call_target.resolved_base_callee());
+      if (call_target.is_virtual()) {
+        for (const auto* override : call_target.overrides()) {
+          add_callee(override);
+        }
+      }
+    }
+    for (const auto& [_, artificial_callees] :
+         call_graph.artificial_callees(method)) {
+      for (const auto& artificial_callee : artificial_callees) {
+        add_callee(artificial_callee.call_target.resolved_base_callee());
+      }
+    }
+  }
+
+  LOG(1,
+      "Demand-driven analysis: {} methods call sources or sinks, {} methods out of {} are relevant.",
+      callers.size(),
+      relevant_methods.size(),
+      context.methods->size());
+  return relevant_methods;
+}
+
+} // namespace marianatrench
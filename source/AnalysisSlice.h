@@ -0,0 +1,37 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <unordered_set>
+
+#include <mariana-trench/Context.h>
+#include <mariana-trench/Method.h>
+#include <mariana-trench/Registry.h>
+
+namespace marianatrench {
+
+/**
+ * Demand-driven analysis: restrict the global fixpoint to the methods that can
+ * contribute to an issue.
+ *
+ * An issue can only be found in a method that transitively calls a method with
+ * sources or sinks, has sources or sinks itself, or reads a field with a field
+ * model. Kinds that no rule uses are removed from models when the registry is
+ * created, hence those do not count. The slice contains these methods and
+ * their transitive callees, whose propagations are needed. Other methods keep
+ * their initial model.
+ */
+class AnalysisSlice final {
+ public:
+  /* This requires the call graph and the dependency graph. */
+  static std::unordered_set<const Method*> relevant_methods(
+      const Context& context,
+      const Registry& registry);
+};
+
+} // namespace marianatrench
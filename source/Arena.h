@@ -0,0 +1,149 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <mariana-trench/Assert.h>
+
+namespace marianatrench {
+
+/**
+ * A bump allocator for objects that share the same lifetime.
+ *
+ * Objects are allocated contiguously in large blocks and are all destroyed,
+ * in reverse order of creation, when the arena is destroyed. This avoids a
+ * call to the global allocator per object, which is contended when many
+ * threads allocate small objects at the same time.
+ *
+ * Note that this is NOT thread-safe.
+ */
+class Arena final {
+ public:
+  explicit Arena(std::size_t block_size = kDefaultBlockSize)
+      : block_size_(block_size),
+        current_(nullptr),
+        end_(nullptr),
+        reserved_bytes_(0) {}
+
+  Arena(const Arena&) = delete;
+  Arena(Arena&&) = delete;
+  Arena& operator=(const Arena&) = delete;
+  Arena& operator=(Arena&&) = delete;
+
+  ~Arena() {
+    destroy_objects();
+  }
+
+  /* Construct an object in the arena. */
+  template <typename T, typename... Args>
+  T* create(Args&&... args) {
+    void* memory = allocate(sizeof(T), alignof(T));
+    T* object = new (memory) T(std::forward<Args>(args)...);
+    if constexpr (!std::is_trivially_destructible_v<T>) {
+      destructors_.push_back(Destructor{
+          [](void* object) { static_cast<T*>(object)->~T(); }, object});
+    }
+    return object;
+  }
+
+  /**
+   * Destroy all objects, in reverse order of creation. Blocks of the default
+   * size are kept to allocate the next objects, hence an arena reused for
+   * objects of the same size stops calling the global allocator.
+   */
+  void reset() {
+    destroy_objects();
+    destructors_.clear();
+    for (auto& block : blocks_) {
+      if (block.size == block_size_) {
+        free_blocks_.push_back(std::move(block.memory));
+      } else {
+        reserved_bytes_ -= block.size;
+      }
+    }
+    blocks_.clear();
+    current_ = nullptr;
+    end_ = nullptr;
+  }
+
+  /* Number of bytes reserved from the global allocator. */
+  std::size_t reserved_bytes() const {
+    return reserved_bytes_;
+  }
+
+  static constexpr std::size_t kDefaultBlockSize = 16 * 1024;
+
+ private:
+  void* allocate(std::size_t size, std::size_t alignment) {
+    mt_assert(alignment <= alignof(std::max_align_t));
+
+    auto address = reinterpret_cast<std::uintptr_t>(current_);
+    auto aligned = (address + alignment - 1) & ~(alignment - 1);
+    if (current_ == nullptr ||
+        aligned + size > reinterpret_cast<std::uintptr_t>(end_)) {
+      // Objects larger than a block get their own block.
+      auto block_size = std::max(block_size_, size);
+      if (block_size == block_size_ && !free_blocks_.empty()) {
+        blocks_.push_back(Block{std::move(free_blocks_.back()), block_size});
+        free_blocks_.pop_back();
+      } else {
+        auto words = (block_size + sizeof(std::max_align_t) - 1) /
+            sizeof(std::max_align_t);
+        // Do not use `std::make_unique`, which would zero the block.
+        blocks_.push_back(Block{
+            std::unique_ptr<std::max_align_t[]>(new std::max_align_t[words]),
+            block_size});
+        reserved_bytes_ += block_size;
+      }
+      current_ = reinterpret_cast<char*>(blocks_.back().memory.get());
+      end_ = current_ + block_size;
+      aligned = reinterpret_cast<std::uintptr_t>(current_);
+    }
+
+    current_ = reinterpret_cast<char*>(aligned + size);
+    return reinterpret_cast<void*>(aligned);
+  }
+
+  void destroy_objects() {
+    for (auto iterator = destructors_.rbegin(), end = destructors_.rend();
+         iterator != end;
+         ++iterator) {
+      iterator->destroy(iterator->object);
+    }
+  }
+
+ private:
+  struct Destructor {
+    void (*destroy)(void*);
+    void* object;
+  };
+
+  struct Block {
+    std::unique_ptr<std::max_align_t[]> memory;
+    std::size_t size;
+  };
+
+  std::size_t block_size_;
+  char* current_;
+  char* end_;
+  std::size_t reserved_bytes_;
+  std::vector<Block> blocks_;
+  // Blocks of the default size released by `reset`.
+  std::vector<std::unique_ptr<std::max_align_t[]>> free_blocks_;
+  std::vector<Destructor> destructors_;
+};
+
+} // namespace marianatrench
@@ -0,0 +1,216 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+#include <sys/wait.h>
+
+#include <boost/algorithm/string/predicate.hpp>
+#include <boost/filesystem.hpp>
+#include <fmt/format.h>
+#include <json/json.h>
+
+#include <mariana-trench/ArtifactCache.h>
+#include <mariana-trench/JsonValidation.h>
+#include <mariana-trench/Log.h>
+
+namespace marianatrench {
+
+namespace {
+
+constexpr std::string_view kCommandPrefix = "command:";
+
+std::string manifest_name(const std::string& key) {
+  if (key.empty() || key.front() == '/' ||
+      key.find("..") != std::string::npos) {
+    throw std::invalid_argument(
+        fmt::format("Invalid artifact cache key `{}`.", key));
+  }
+  return fmt::format("keys/{}.json", key);
+}
+
+/* Quote an argument for the shell. */
+std::string quote(const std::string& argument) {
+  std::string result = "'";
+  for (char character : argument) {
+    if (character == '\'') {
+      result += "'\\''";
+    } else {
+      result += character;
+    }
+  }
+  result += "'";
+  return result;
+}
+
+bool run_command(const std::string& command) {
+  int status = std::system(command.c_str());
+  return status != -1 && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+} // namespace
+
+ArtifactCache::DirectoryBackend::DirectoryBackend(boost::filesystem::path root)
+    : root_(std::move(root)) {
+  boost::filesystem::create_directories(root_);
+}
+
+bool ArtifactCache::DirectoryBackend::fetch(
+    const std::string& name,
+    const boost::filesystem::path& path) const {
+  auto entry = root_ / name;
+  if (!boost::filesystem::exists(entry)) {
+    return false;
+  }
+  boost::filesystem::remove(path);
+  boost::filesystem::copy_file(entry, path);
+  return true;
+}
+
+void ArtifactCache::DirectoryBackend::store(
+    const std::string& name,
+    const boost::filesystem::path& path) const {
+  auto entry = root_ / name;
+  boost::filesystem::create_directories(entry.parent_path());
+  // Readers on other machines never see a partial entry.
+  auto temporary = entry.parent_path() /
+      boost::filesystem::unique_path(".%%%%-%%%%-%%%%-%%%%");
+  boost::filesystem::copy_file(path, temporary);
+  boost::filesystem::rename(temporary, entry);
+}
+
+bool ArtifactCache::DirectoryBackend::contains(const std::string& name) const {
+  return boost::filesystem::exists(root_ / name);
+}
+
+ArtifactCache::CommandBackend::CommandBackend(std::string program)
+    : program_(std::move(program)) {}
+
+bool ArtifactCache::CommandBackend::fetch(
+    const std::string& name,
+    const boost::filesystem::path& path) const {
+  return run_command(fmt::format(
+      "{} fetch {} {}", program_, quote(name), quote(path.native())));
+}
+
+void ArtifactCache::CommandBackend::store(
+    const std::string& name,
+    const boost::filesystem::path& path) const {
+  if (!run_command(fmt::format(
+          "{} store {} {}", program_, quote(name), quote(path.native())))) {
+    throw std::runtime_error(fmt::format(
+        "Artifact cache command `{}` could not store `{}`.", program_, name));
+  }
+}
+
+bool ArtifactCache::CommandBackend::contains(const std::string& name) const {
+  return run_command(fmt::format("{} contains {}", program_, quote(name)));
+}
+
+ArtifactCache::ArtifactCache(std::unique_ptr<Backend> backend)
+    : backend_(std::move(backend)) {}
+
+std::unique_ptr<ArtifactCache> ArtifactCache::from_location(
+    const std::string& location) {
+  if (boost::starts_with(location, kCommandPrefix)) {
+    return std::make_unique<ArtifactCache>(std::make_unique<CommandBackend>(
+        location.substr(kCommandPrefix.size())));
+  }
+  return std::make_unique<ArtifactCache>(
+      std::make_unique<DirectoryBackend>(location));
+}
+
+bool ArtifactCache::fetch(
+    const std::string& key,
+    const boost::filesystem::path& directory) const {
+  boost::filesystem::create_directories(directory);
+  auto manifest_path = directory / "manifest.json";
+  if (!backend_->fetch(manifest_name(key), manifest_path)) {
+    return false;
+  }
+
+  auto manifest = JsonValidation::parse_json_file(manifest_path);
+  JsonValidation::validate_object(manifest);
+  for (const auto& filename : manifest.getMemberNames()) {
+    auto object = JsonValidation::string(manifest, filename);
+    if (filename != boost::filesystem::path(filename).filename().string()) {
+      throw std::runtime_error(fmt::format(
+          "Invalid file name `{}` in the artifact cache manifest of `{}`.",
+          filename,
+          key));
+    }
+    if (!backend_->fetch(fmt::format("objects/{}", object),
+                         directory / filename)) {
+      throw std::runtime_error(fmt::format(
+          "Missing object `{}` for `{}` in the artifact cache.",
+          object,
+          filename));
+    }
+  }
+  LOG(1,
+      "Fetched {} files of `{}` from the artifact cache.",
+      manifest.size(),
+      key);
+  return true;
+}
+
+void ArtifactCache::store(
+    const std::string& key,
+    const std::map<std::string, boost::filesystem::path>& files) const {
+  auto manifest = Json::Value(Json::objectValue);
+  std::size_t stored_objects = 0;
+  for (const auto& [filename, path] : files) {
+    if (!boost::filesystem::is_regular_file(path)) {
+      continue;
+    }
+    auto object = object_name(path);
+    auto name = fmt::format("objects/{}", object);
+    if (!backend_->contains(name)) {
+      backend_->store(name, path);
+      stored_objects++;
+    }
+    manifest[filename] = Json::Value(object);
+  }
+
+  // The manifest is stored last, once all its objects exist.
+  auto manifest_path = boost::filesystem::temp_directory_path() /
+      boost::filesystem::unique_path("mariana-trench-manifest-%%%%-%%%%.json");
+  JsonValidation::write_json_file(manifest_path, manifest);
+  backend_->store(manifest_name(key), manifest_path);
+  boost::filesystem::remove(manifest_path);
+
+  LOG(1,
+      "Stored {} files of `{}` in the artifact cache, {} of them changed.",
+      manifest.size(),
+      key,
+      stored_objects);
+}
+
+std::string ArtifactCache::object_name(const boost::filesystem::path& path) {
+  // 64-bit FNV-1a.
+  std::uint64_t hash = 14695981039346656037ull;
+  std::ifstream file(path.native(), std::ios_base::binary);
+  std::vector<char> buffer(1 << 20);
+  std::uint64_t size = 0;
+  while (file) {
+    file.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    auto read = static_cast<std::size_t>(file.gcount());
+    for (std::size_t index = 0; index < read; index++) {
+      hash ^= static_cast<unsigned char>(buffer[index]);
+      hash *= 1099511628211ull;
+    }
+    size += read;
+  }
+  return fmt::format("{:016x}-{}", hash, size);
+}
+
+} // namespace marianatrench
@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <string>
+
+#include <boost/filesystem/path.hpp>
+
+namespace marianatrench {
+
+/**
+ * A content-addressed store of the state of a run (fingerprints, models,
+ * types cache, library summary), so that a run on any machine can start from
+ * the state of a previous run (see `--artifact-cache`).
+ *
+ * Files are stored as objects named `objects/<hash>-<size>` after their
+ * content, hence files that did not change between runs are only stored
+ * once. The files of a run are listed in a manifest `keys/<key>.json`,
+ * mapping file names to objects, where the key identifies the run (e.g the
+ * revision of the application).
+ *
+ * Hashes are not cryptographic: the store must only be writable by trusted
+ * runs.
+ */
+class ArtifactCache final {
+ public:
+  /* Where objects and manifests are stored. */
+  class Backend {
+   public:
+    Backend() = default;
+    Backend(const Backend&) = delete;
+    Backend(Backend&&) = delete;
+    Backend& operator=(const Backend&) = delete;
+    Backend& operator=(Backend&&) = delete;
+    virtual ~Backend() = default;
+
+    /**
+     * Copy the given entry into the file at `path`. Return false if there is
+     * no such entry.
+     */
+    virtual bool fetch(
+        const std::string& name,
+        const boost::filesystem::path& path) const = 0;
+
+    /* Store the file at `path` as the given entry, replacing it. */
+    virtual void store(
+        const std::string& name,
+        const boost::filesystem::path& path) const = 0;
+
+    /* Return true if the given entry exists, to skip storing it again. */
+    virtual bool contains(const std::string& name) const = 0;
+  };
+
+  /* Entries are files under a directory, e.g on a shared file system. */
+  class DirectoryBackend final : public Backend {
+   public:
+    explicit DirectoryBackend(boost::filesystem::path root);
+
+    bool fetch(const std::string& name, const boost::filesystem::path& path)
+        const override;
+    void store(const std::string& name, const boost::filesystem::path& path)
+        const override;
+    bool contains(const std::string& name) const override;
+
+   private:
+    boost::filesystem::path root_;
+  };
+
+  /**
+   * Entries are fetched and stored by an external program, e.g a script
+   * using `curl` or an object storage client. The program is called as
+   * `<program> fetch|store|contains <name> [<path>]` and must exit with 0 on
+   * success, and a non-zero status if the entry does not exist.
+   */
+  class CommandBackend final : public Backend {
+   public:
+    explicit CommandBackend(std::string program);
+
+    bool fetch(const std::string& name, const boost::filesystem::path& path)
+        const override;
+    void store(const std::string& name, const boost::filesystem::path& path)
+        const override;
+    bool contains(const std::string& name) const override;
+
+   private:
+    std::string program_;
+  };
+
+ public:
+  explicit ArtifactCache(std::unique_ptr<Backend> backend);
+  ArtifactCache(const ArtifactCache&) = delete;
+  ArtifactCache(ArtifactCache&&) = delete;
+  ArtifactCache& operator=(const ArtifactCache&) = delete;
+  ArtifactCache& operator=(ArtifactCache&&) = delete;
+  ~ArtifactCache() = default;
+
+  /**
+   * Create the cache at the given location: `command:<program>` for a
+   * `CommandBackend`, or a directory, which is created if it does not exist.
+   */
+  static std::unique_ptr<ArtifactCache> from_location(
+      const std::string& location);
+
+  /**
+   * Fetch the files stored under the given key into `directory`. Return false
+   * if there is no such key.
+   *
+   * Throws `std::runtime_error` if an object of the manifest is missing.
+   */
+  bool fetch(const std::string& key, const boost::filesystem::path& directory)
+      const;
+
+  /**
+   * Store the given files under the given key, as a map from file names in
+   * the fetched directory to paths, replacing the previous files of the key.
+   * Missing files are skipped.
+   */
+  void store(
+      const std::string& key,
+      const std::map<std::string, boost::filesystem::path>& files) const;
+
+  /* Return the object name of the file at the given path. */
+  static std::string object_name(const boost::filesystem::path& path);
+
+ private:
+  std::unique_ptr<Backend> backend_;
+};
+
+} // namespace marianatrench
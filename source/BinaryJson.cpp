@@ -0,0 +1,231 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <cstring>
+#include <stdexcept>
+
+#include <fmt/format.h>
+
+#include <mariana-trench/BinaryJson.h>
+
+namespace marianatrench {
+
+namespace {
+
+void write_varint(std::uint64_t value, std::string& output) {
+  while (value >= 0x80) {
+    output.push_back(static_cast<char>((value & 0x7f) | 0x80));
+    value >>= 7;
+  }
+  output.push_back(static_cast<char>(value));
+}
+
+void write_tag(BinaryJson::Tag tag, std::string& output) {
+  output.push_back(static_cast<char>(tag));
+}
+
+std::uint64_t zigzag_encode(std::int64_t value) {
+  return (static_cast<std::uint64_t>(value) << 1) ^
+      static_cast<std::uint64_t>(value >> 63);
+}
+
+std::int64_t zigzag_decode(std::uint64_t value) {
+  return static_cast<std::int64_t>(value >> 1) ^
+      -static_cast<std::int64_t>(value & 1);
+}
+
+} // namespace
+
+void BinaryJsonWriter::add(const Json::Value& value) {
+  std::string record;
+  encode(value, record);
+  write_varint(record.size(), records_);
+  records_.append(record);
+}
+
+void BinaryJsonWriter::write(std::ostream& stream) const {
+  std::string header(BinaryJson::kMagic);
+  header.push_back(static_cast<char>(BinaryJson::kVersion));
+  write_varint(strings_.size(), header);
+  for (const auto* string : strings_) {
+    write_varint(string->size(), header);
+    header.append(*string);
+  }
+  stream.write(header.data(), header.size());
+  stream.write(records_.data(), records_.size());
+}
+
+void BinaryJsonWriter::encode(const Json::Value& value, std::string& output) {
+  switch (value.type()) {
+    case Json::nullValue:
+      write_tag(BinaryJson::Tag::Null, output);
+      break;
+    case Json::booleanValue:
+      write_tag(
+          value.asBool() ? BinaryJson::Tag::True : BinaryJson::Tag::False,
+          output);
+      break;
+    case Json::intValue:
+      write_tag(BinaryJson::Tag::Int, output);
+      write_varint(zigzag_encode(value.asInt64()), output);
+      break;
+    case Json::uintValue:
+      write_tag(BinaryJson::Tag::UInt, output);
+      write_varint(value.asUInt64(), output);
+      break;
+    case Json::realValue: {
+      write_tag(BinaryJson::Tag::Double, output);
+      double number = value.asDouble();
+      std::uint64_t bits;
+      std::memcpy(&bits, &number, sizeof(bits));
+      for (int byte = 0; byte < 8; byte++) {
+        output.push_back(static_cast<char>((bits >> (8 * byte)) & 0xff));
+      }
+      break;
+    }
+    case Json::stringValue:
+      write_tag(BinaryJson::Tag::String, output);
+      write_varint(string_index(value.asString()), output);
+      break;
+    case Json::arrayValue:
+      write_tag(BinaryJson::Tag::Array, output);
+      write_varint(value.size(), output);
+      for (const auto& element : value) {
+        encode(element, output);
+      }
+      break;
+    case Json::objectValue:
+      write_tag(BinaryJson::Tag::Object, output);
+      write_varint(value.size(), output);
+      for (auto iterator = value.begin(); iterator != value.end(); ++iterator) {
+        write_varint(string_index(iterator.name()), output);
+        encode(*iterator, output);
+      }
+      break;
+  }
+}
+
+std::uint64_t BinaryJsonWriter::string_index(const std::string& string) {
+  auto [iterator, inserted] =
+      string_indices_.emplace(string, string_indices_.size());
+  if (inserted) {
+    strings_.push_back(&iterator->first);
+  }
+  return iterator->second;
+}
+
+BinaryJsonReader::BinaryJsonReader(std::string_view data)
+    : data_(data), offset_(0) {
+  if (data_.substr(0, BinaryJson::kMagic.size()) != BinaryJson::kMagic) {
+    throw std::runtime_error("Invalid binary json header.");
+  }
+  offset_ = BinaryJson::kMagic.size();
+  auto version = read_byte();
+  if (version != BinaryJson::kVersion) {
+    throw std::runtime_error(
+        fmt::format("Unsupported binary json version {}.", version));
+  }
+
+  auto number_of_strings = read_varint();
+  strings_.reserve(number_of_strings);
+  for (std::uint64_t i = 0; i < number_of_strings; i++) {
+    auto size = read_varint();
+    if (offset_ + size > data_.size()) {
+      throw std::runtime_error("Unexpected end of binary json.");
+    }
+    strings_.emplace_back(data_.substr(offset_, size));
+    offset_ += size;
+  }
+}
+
+std::optional<Json::Value> BinaryJsonReader::next() {
+  if (offset_ >= data_.size()) {
+    return std::nullopt;
+  }
+  auto size = read_varint();
+  auto end = offset_ + size;
+  auto value = decode();
+  if (offset_ != end) {
+    throw std::runtime_error("Invalid binary json record length.");
+  }
+  return value;
+}
+
+std::uint64_t BinaryJsonReader::read_varint() {
+  std::uint64_t value = 0;
+  for (int shift = 0; shift < 64; shift += 7) {
+    auto byte = read_byte();
+    value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0) {
+      return value;
+    }
+  }
+  throw std::runtime_error("Invalid varint in binary json.");
+}
+
+std::uint8_t BinaryJsonReader::read_byte() {
+  if (offset_ >= data_.size()) {
+    throw std::runtime_error("Unexpected end of binary json.");
+  }
+  return static_cast<std::uint8_t>(data_[offset_++]);
+}
+
+Json::Value BinaryJsonReader::decode() {
+  auto tag = static_cast<BinaryJson::Tag>(read_byte());
+  switch (tag) {
+    case BinaryJson::Tag::Null:
+      return Json::Value(Json::nullValue);
+    case BinaryJson::Tag::False:
+      return Json::Value(false);
+    case BinaryJson::Tag::True:
+      return Json::Value(true);
+    case BinaryJson::Tag::Int:
+      return Json::Value(
+          static_cast<Json::Int64>(zigzag_decode(read_varint())));
+    case BinaryJson::Tag::UInt:
+      return Json::Value(static_cast<Json::UInt64>(read_varint()));
+    case BinaryJson::Tag::Double: {
+      std::uint64_t bits = 0;
+      for (int byte = 0; byte < 8; byte++) {
+        bits |= static_cast<std::uint64_t>(read_byte()) << (8 * byte);
+      }
+      double number;
+      std::memcpy(&number, &bits, sizeof(number));
+      return Json::Value(number);
+    }
+    case BinaryJson::Tag::String:
+      return Json::Value(string(read_varint()));
+    case BinaryJson::Tag::Array: {
+      auto value = Json::Value(Json::arrayValue);
+      auto size = read_varint();
+      for (std::uint64_t i = 0; i < size; i++) {
+        value.append(decode());
+      }
+      return value;
+    }
+    case BinaryJson::Tag::Object: {
+      auto value = Json::Value(Json::objectValue);
+      auto size = read_varint();
+      for (std::uint64_t i = 0; i < size; i++) {
+        const auto& key = string(read_varint());
+        value[key] = decode();
+      }
+      return value;
+    }
+  }
+  throw std::runtime_error(fmt::format(
+      "Invalid binary json tag {}.", static_cast<unsigned>(tag)));
+}
+
+const std::string& BinaryJsonReader::string(std::uint64_t index) const {
+  if (index >= strings_.size()) {
+    throw std::runtime_error("Invalid string index in binary json.");
+  }
+  return strings_[index];
+}
+
+} // namespace marianatrench
@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <json/json.h>
+
+namespace marianatrench {
+
+/**
+ * A compact binary encoding for sequences of json values, used to output
+ * models.
+ *
+ * All strings (keys and values) are interned in a table at the beginning of
+ * the file, which makes method names, kinds, features and positions cheap to
+ * store. The layout is:
+ * ```
+ * "MTBJ" <version: u8>
+ * <number of strings: varint> (<length: varint> <utf-8 bytes>)*
+ * (<record length: varint> <value>)*
+ * ```
+ * A value is a tag byte (see `BinaryJson::Tag`) followed by its payload:
+ * varints for integers, string indices and sizes, 8 little-endian bytes for
+ * doubles. Records are length-prefixed so that readers can index and skip
+ * them without decoding.
+ *
+ * `scripts/explore_models.py` contains a reader for this format.
+ */
+class BinaryJson final {
+ public:
+  enum class Tag : std::uint8_t {
+    Null = 0,
+    False = 1,
+    True = 2,
+    Int = 3,
+    UInt = 4,
+    Double = 5,
+    String = 6,
+    Array = 7,
+    Object = 8,
+  };
+
+  constexpr static std::string_view kMagic = "MTBJ";
+  constexpr static std::uint8_t kVersion = 1;
+};
+
+/**
+ * Accumulate records in memory and write them all at once, once the string
+ * table is known.
+ */
+class BinaryJsonWriter final {
+ public:
+  BinaryJsonWriter() = default;
+  BinaryJsonWriter(const BinaryJsonWriter&) = delete;
+  BinaryJsonWriter(BinaryJsonWriter&&) = default;
+  BinaryJsonWriter& operator=(const BinaryJsonWriter&) = delete;
+  BinaryJsonWriter& operator=(BinaryJsonWriter&&) = default;
+  ~BinaryJsonWriter() = default;
+
+  void add(const Json::Value& value);
+
+  void write(std::ostream& stream) const;
+
+ private:
+  void encode(const Json::Value& value, std::string& output);
+  std::uint64_t string_index(const std::string& string);
+
+ private:
+  std::unordered_map<std::string, std::uint64_t> string_indices_;
+  std::vector<const std::string*> strings_;
+  std::string records_;
+};
+
+/**
+ * Decode the records of a binary json buffer, in order.
+ *
+ * Throws `std::runtime_error` if the buffer is malformed.
+ */
+class BinaryJsonReader final {
+ public:
+  explicit BinaryJsonReader(std::string_view data);
+  BinaryJsonReader(const BinaryJsonReader&) = delete;
+  BinaryJsonReader(BinaryJsonReader&&) = delete;
+  BinaryJsonReader& operator=(const BinaryJsonReader&) = delete;
+  BinaryJsonReader& operator=(BinaryJsonReader&&) = delete;
+  ~BinaryJsonReader() = default;
+
+  /* Return the next record, or `std::nullopt` at the end of the buffer. */
+  std::optional<Json::Value> next();
+
+ private:
+  std::uint64_t read_varint();
+  std::uint8_t read_byte();
+  Json::Value decode();
+  const std::string& string(std::uint64_t index) const;
+
+ private:
+  std::string_view data_;
+  std::size_t offset_;
+  std::vector<std::string> strings_;
+};
+
+} // namespace marianatrench
@@ -5,6 +5,11 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <algorithm>
+#include <iterator>
+#include <unordered_set>
+#include <vector>
+
 #include <re2/re2.h>
 
 #include <IRInstruction.h>
@@ -18,6 +23,7 @@
 #include <mariana-trench/JsonValidation.h>
 #include <mariana-trench/Log.h>
 #include <mariana-trench/Methods.h>
+#include <mariana-trench/Tracer.h>
 
 namespace marianatrench {
 
@@ -118,9 +124,9 @@ ParameterTypeOverrides anonymous_class_arguments(
     const DexMethod* callee) {
   mt_assert(callee != nullptr);
   ParameterTypeOverrides parameters;
-  const auto& environment = types.environment(caller, instruction);
-  auto sources = instruction->srcs_vec();
-  for (std::size_t source_position = 0; source_position < sources.size();
+  auto method_types = types.method_types(caller);
+  const auto& source_types = method_types->source_types(instruction);
+  for (std::size_t source_position = 0; source_position < source_types.size();
        source_position++) {
     auto parameter_position = source_position;
     if (!is_static(callee)) {
@@ -132,11 +138,7 @@ ParameterTypeOverrides anonymous_class_arguments(
         parameter_position--;
       }
     }
-    auto found = environment.find(sources[source_position]);
-    if (found == environment.end()) {
-      continue;
-    }
-    const auto* type = found->second;
+    const auto* type = source_types[source_position];
     if (type && is_anonymous_class(type)) {
       parameters.emplace(parameter_position, type);
     }
@@ -251,8 +253,6 @@ struct InstructionCallGraphInformation {
 InstructionCallGraphInformation process_instruction(
     const Method* caller,
     const IRInstruction* instruction,
-    ConcurrentSet<const Method*>& worklist,
-    ConcurrentSet<const Method*>& processed,
     const Options& options,
     Methods& method_factory,
     Fields& field_factory,
@@ -314,14 +314,23 @@ InstructionCallGraphInformation process_instruction(
       instruction_information.artificial_callees);
 
   instruction_information.callee = callee;
+  return instruction_information;
+}
 
-  if (callee->parameter_type_overrides().empty() ||
-      processed.count(callee) != 0) {
-    return instruction_information;
-  }
-  // This is a newly introduced method with parameter type
-  // overrides. We need to generate it's method overrides,
-  // and compute callees for them.
+/*
+ * Create the overrides of a newly introduced method with parameter type
+ * overrides, and add the methods that still need to be processed to the
+ * worklist.
+ *
+ * This mutates the method and override factories and must not run
+ * concurrently with itself.
+ */
+void add_parameter_type_overrides(
+    const Method* callee,
+    const std::unordered_set<const Method*>& processed,
+    Methods& method_factory,
+    Overrides& override_factory,
+    std::vector<const Method*>& worklist) {
   const Method* original_callee = method_factory.get(callee->dex_method());
   std::unordered_set<const Method*> original_methods =
       override_factory.get(original_callee);
@@ -343,25 +352,40 @@ InstructionCallGraphInformation process_instruction(
     }
 
     if (processed.count(method) == 0) {
-      worklist.insert(method);
+      worklist.push_back(method);
     }
   }
-  return instruction_information;
 }
 
+/* Call graph information found by a single worker thread. */
+struct PartialCallGraph {
+  std::vector<std::pair<
+      const Method*,
+      std::vector<InstructionMap<const Method*>::Entry>>>
+      resolved_base_callees;
+  std::vector<std::pair<
+      const Method*,
+      std::vector<InstructionMap<const Field*>::Entry>>>
+      resolved_fields;
+  std::vector<std::pair<
+      const Method*,
+      std::vector<InstructionMap<ArtificialCallees>::Entry>>>
+      artificial_callees;
+  // Callees with parameter type overrides that were not processed yet.
+  std::vector<const Method*> parameter_type_overrides_callees;
+};
+
 } // namespace
 
 CallTarget::CallTarget(
     const IRInstruction* instruction,
     const Method* MT_NULLABLE resolved_base_callee,
     const DexType* MT_NULLABLE receiver_type,
-    const std::unordered_set<const Method*>* MT_NULLABLE overrides,
-    const std::unordered_set<const DexType*>* MT_NULLABLE receiver_extends)
+    const std::vector<const Method*>* MT_NULLABLE overrides)
     : instruction_(instruction),
       resolved_base_callee_(resolved_base_callee),
       receiver_type_(receiver_type),
-      overrides_(overrides),
-      receiver_extends_(receiver_extends) {}
+      overrides_(overrides) {}
 
 CallTarget CallTarget::static_call(
     const IRInstruction* instruction,
@@ -370,8 +394,7 @@ CallTarget CallTarget::static_call(
       instruction,
       /* resolved_base_callee */ callee,
       /* receiver_type */ nullptr,
-      /* overrides */ nullptr,
-      /* receiver_extends */ nullptr);
+      /* overrides */ nullptr);
 }
 
 CallTarget CallTarget::virtual_call(
@@ -380,14 +403,6 @@ CallTarget CallTarget::virtual_call(
     const DexType* MT_NULLABLE receiver_type,
     const ClassHierarchies& class_hierarchies,
     const Overrides& override_factory) {
-  // All overrides are potential callees.
-  const std::unordered_set<const Method*>* overrides = nullptr;
-  if (resolved_base_callee != nullptr) {
-    overrides = &override_factory.get(resolved_base_callee);
-  } else {
-    overrides = &override_factory.empty_method_set();
-  }
-
   // If the receiver type does not define the method, `resolved_base_callee`
   // will reference a method on a parent class. Taking all overrides of
   // `resolved_base_callee` can be imprecise since it would include overrides
@@ -404,17 +419,22 @@ CallTarget CallTarget::virtual_call(
   // A virtual call to `B::f` has a resolved base callee of `A::f`. Overrides
   // of `A::f` includes `D::f`, but `D::f` cannot be called since `D` does not
   // extend `B`.
-  const std::unordered_set<const DexType*>* receiver_extends = nullptr;
+  //
+  // The filtered overrides are memoized per base callee and receiver type, so
+  // that resolving the same call repeatedly does not filter them again.
+  const ClassHierarchies::TypeSet* receiver_extends = nullptr;
   if (receiver_type != nullptr && receiver_type != type::java_lang_Object()) {
     receiver_extends = &class_hierarchies.extends(receiver_type);
   }
 
-  return CallTarget(
-      instruction,
-      resolved_base_callee,
-      receiver_type,
-      overrides,
-      receiver_extends);
+  const std::vector<const Method*>* overrides =
+      &override_factory.empty_method_list();
+  if (resolved_base_callee != nullptr) {
+    overrides =
+        &override_factory.get_filtered(resolved_base_callee, receiver_extends);
+  }
+
+  return CallTarget(instruction, resolved_base_callee, receiver_type, overrides);
 }
 
 CallTarget CallTarget::from_call_instruction(
@@ -438,27 +458,18 @@ CallTarget CallTarget::from_call_instruction(
   }
 }
 
-bool CallTarget::FilterOverrides::operator()(const Method* method) const {
-  return extends == nullptr || extends->count(method->get_class()) > 0;
-}
-
 CallTarget::OverridesRange CallTarget::overrides() const {
   mt_assert(resolved());
   mt_assert(is_virtual());
 
-  return boost::make_iterator_range(
-      boost::make_filter_iterator(
-          FilterOverrides{receiver_extends_}, overrides_->cbegin()),
-      boost::make_filter_iterator(
-          FilterOverrides{receiver_extends_}, overrides_->cend()));
+  return boost::make_iterator_range(overrides_->cbegin(), overrides_->cend());
 }
 
 bool CallTarget::operator==(const CallTarget& other) const {
   return instruction_ == other.instruction_ &&
       resolved_base_callee_ == other.resolved_base_callee_ &&
       receiver_type_ == other.receiver_type_ &&
-      overrides_ == other.overrides_ &&
-      receiver_extends_ == other.receiver_extends_;
+      overrides_ == other.overrides_;
 }
 
 std::ostream& operator<<(std::ostream& out, const CallTarget& call_target) {
@@ -502,18 +513,29 @@ CallGraph::CallGraph(
     : types_(types),
       class_hierarchies_(class_hierarchies),
       overrides_(override_factory) {
-  ConcurrentSet<const Method*> worklist;
-  ConcurrentSet<const Method*> processed;
+  // Methods are processed in rounds. Each round resolves the calls of the
+  // methods in the worklist in parallel, into per-thread partial call graphs.
+  // New methods with parameter type overrides are then created sequentially,
+  // and processed in the next round.
+  std::vector<const Method*> worklist;
+  std::unordered_set<const Method*> processed;
+  std::vector<std::pair<
+      const Method*,
+      std::vector<InstructionMap<const Method*>::Entry>>>
+      resolved_base_callees;
   for (const Method* method : method_factory) {
-    worklist.insert(method);
+    worklist.push_back(method);
   }
 
   std::atomic<std::size_t> method_iteration(0);
   std::size_t number_methods = 0;
 
-  while (worklist.size() > 0) {
+  auto threads = options.jobs(AnalysisPhase::CallGraph);
+  while (!worklist.empty()) {
+    std::vector<PartialCallGraph> partial_call_graphs(threads);
     auto queue = sparta::work_queue<const Method*>(
-        [&](const Method* caller) {
+        [&](sparta::SpartaWorkerState<const Method*>* worker_state,
+            const Method* caller) {
           method_iteration++;
           if (method_iteration % 10000 == 0) {
             LOG(1,
@@ -529,10 +551,12 @@ CallGraph::CallGraph(
 
           mt_assert(code->cfg_built());
 
-          std::unordered_map<const IRInstruction*, const Method*> callees;
-          std::unordered_map<const IRInstruction*, ArtificialCallees>
+          auto& partial_call_graph =
+              partial_call_graphs.at(worker_state->worker_id());
+          std::vector<InstructionMap<const Method*>::Entry> callees;
+          std::vector<InstructionMap<ArtificialCallees>::Entry>
               artificial_callees;
-          std::unordered_map<const IRInstruction*, const Field*> field_accesses;
+          std::vector<InstructionMap<const Field*>::Entry> field_accesses;
 
           for (const auto* block : code->cfg().blocks()) {
             for (const auto& entry : *block) {
@@ -544,8 +568,6 @@ CallGraph::CallGraph(
               auto instruction_information = process_instruction(
                   caller,
                   instruction,
-                  worklist,
-                  processed,
                   options,
                   method_factory,
                   field_factory,
@@ -553,41 +575,138 @@ CallGraph::CallGraph(
                   override_factory,
                   features);
               if (instruction_information.callee) {
-                callees.emplace(instruction, *(instruction_information.callee));
+                const auto* callee = *(instruction_information.callee);
+                callees.emplace_back(instruction, callee);
+                if (!callee->parameter_type_overrides().empty()) {
+                  partial_call_graph.parameter_type_overrides_callees.push_back(
+                      callee);
+                }
               }
               if (instruction_information.artificial_callees.size() > 0) {
-                artificial_callees.emplace(
-                    instruction, instruction_information.artificial_callees);
+                artificial_callees.emplace_back(
+                    instruction,
+                    std::move(instruction_information.artificial_callees));
               }
               if (instruction_information.field_access) {
-                field_accesses.emplace(
+                field_accesses.emplace_back(
                     instruction, *(instruction_information.field_access));
               }
             }
           }
 
           if (!callees.empty()) {
-            resolved_base_callees_.insert_or_assign(
-                std::make_pair(caller, std::move(callees)));
+            partial_call_graph.resolved_base_callees.emplace_back(
+                caller, std::move(callees));
           }
           if (!artificial_callees.empty()) {
-            artificial_callees_.insert_or_assign(
-                std::make_pair(caller, std::move(artificial_callees)));
+            partial_call_graph.artificial_callees.emplace_back(
+                caller, std::move(artificial_callees));
           }
           if (!field_accesses.empty()) {
-            resolved_fields_.insert_or_assign(
-                std::make_pair(caller, std::move(field_accesses)));
+            partial_call_graph.resolved_fields.emplace_back(
+                caller, std::move(field_accesses));
           }
         },
-        sparta::parallel::default_num_threads());
+        threads);
     for (const auto* method : worklist) {
       queue.add_item(method);
       processed.insert(method);
     }
     worklist.clear();
     number_methods = method_factory.size();
+    TraceSpan resolve_span("call_graph:resolve");
     queue.run_all();
+    resolve_span.end();
+
+    // Merge the partial call graphs. Each caller is processed exactly once,
+    // hence entries never conflict.
+    TraceSpan merge_span("call_graph:merge");
+    std::vector<const Method*> parameter_type_overrides_callees;
+    for (auto& partial_call_graph : partial_call_graphs) {
+      std::move(
+          partial_call_graph.resolved_base_callees.begin(),
+          partial_call_graph.resolved_base_callees.end(),
+          std::back_inserter(resolved_base_callees));
+      for (auto& [caller, field_accesses] :
+           partial_call_graph.resolved_fields) {
+        resolved_fields_.emplace(
+            caller, InstructionMap<const Field*>(std::move(field_accesses)));
+      }
+      for (auto& [caller, artificial_callees] :
+           partial_call_graph.artificial_callees) {
+        artificial_callees_.emplace(
+            caller,
+            InstructionMap<ArtificialCallees>(std::move(artificial_callees)));
+      }
+      parameter_type_overrides_callees.insert(
+          parameter_type_overrides_callees.end(),
+          partial_call_graph.parameter_type_overrides_callees.begin(),
+          partial_call_graph.parameter_type_overrides_callees.end());
+    }
+
+    // Creating methods and overrides is idempotent, hence the result does not
+    // depend on the order in which threads found these callees.
+    std::unordered_set<const Method*> visited_callees;
+    for (const auto* callee : parameter_type_overrides_callees) {
+      if (processed.count(callee) != 0 ||
+          !visited_callees.insert(callee).second) {
+        continue;
+      }
+      add_parameter_type_overrides(
+          callee, processed, method_factory, override_factory, worklist);
+    }
+
+    // Remove duplicates, since the same method can be reached from multiple
+    // callees.
+    std::unordered_set<const Method*> unique_methods;
+    worklist.erase(
+        std::remove_if(
+            worklist.begin(),
+            worklist.end(),
+            [&](const Method* method) {
+              return !unique_methods.insert(method).second;
+            }),
+        worklist.end());
+  }
+
+  // Call targets depend on the overrides, which are final once all methods
+  // with parameter type overrides are created. They are resolved once here
+  // rather than on each call to `callees`.
+  TraceSpan call_targets_span("call_graph:call_targets");
+  std::vector<std::vector<CallTarget>> call_targets(
+      resolved_base_callees.size());
+  auto call_targets_queue = sparta::work_queue<std::size_t>(
+      [&](std::size_t index) {
+        auto& [caller, callees] = resolved_base_callees[index];
+        std::sort(
+            callees.begin(),
+            callees.end(),
+            [](const auto& left, const auto& right) {
+              return left.first < right.first;
+            });
+        auto& targets = call_targets[index];
+        targets.reserve(callees.size());
+        for (auto [instruction, resolved_base_callee] : callees) {
+          targets.push_back(CallTarget::from_call_instruction(
+              caller,
+              instruction,
+              resolved_base_callee,
+              types,
+              class_hierarchies,
+              override_factory));
+        }
+      },
+      threads);
+  for (std::size_t index = 0; index < resolved_base_callees.size(); index++) {
+    call_targets_queue.add_item(index);
   }
+  call_targets_queue.run_all();
+  callees_.reserve(resolved_base_callees.size());
+  for (std::size_t index = 0; index < resolved_base_callees.size(); index++) {
+    callees_.emplace(
+        resolved_base_callees[index].first, std::move(call_targets[index]));
+  }
+  call_targets_span.end();
 
   if (options.dump_call_graph()) {
     auto call_graph_path = options.call_graph_output_path();
@@ -597,34 +716,42 @@ CallGraph::CallGraph(
   }
 }
 
-std::vector<CallTarget> CallGraph::callees(const Method* caller) const {
-  // Note that `find` is not thread-safe, but this is fine because
-  // `resolved_base_callees_` is read-only after the constructor completed.
-  auto callees = resolved_base_callees_.find(caller);
-  if (callees == resolved_base_callees_.end()) {
-    return {};
+const std::vector<CallTarget>& CallGraph::callees(
+    const Method* caller) const {
+  auto callees = callees_.find(caller);
+  if (callees == callees_.end()) {
+    return empty_callees_;
   }
+  return callees->second;
+}
 
-  std::vector<CallTarget> call_targets;
-  for (auto [instruction, resolved_base_callee] : callees->second) {
-    call_targets.push_back(CallTarget::from_call_instruction(
-        caller,
-        instruction,
-        resolved_base_callee,
-        types_,
-        class_hierarchies_,
-        overrides_));
+const CallTarget* MT_NULLABLE CallGraph::find_callee(
+    const Method* caller,
+    const IRInstruction* instruction) const {
+  const auto& callees = this->callees(caller);
+  auto found = std::lower_bound(
+      callees.begin(),
+      callees.end(),
+      instruction,
+      [](const CallTarget& call_target, const IRInstruction* instruction) {
+        return call_target.instruction() < instruction;
+      });
+  if (found == callees.end() || found->instruction() != instruction) {
+    return nullptr;
   }
-  return call_targets;
+  return &*found;
 }
 
 CallTarget CallGraph::callee(
     const Method* caller,
     const IRInstruction* instruction) const {
+  if (const auto* call_target = find_callee(caller, instruction)) {
+    return *call_target;
+  }
   return CallTarget::from_call_instruction(
       caller,
       instruction,
-      resolved_base_callee(caller, instruction),
+      /* resolved_base_callee */ nullptr,
       types_,
       class_hierarchies_,
       overrides_);
@@ -633,25 +760,15 @@ CallTarget CallGraph::callee(
 const Method* MT_NULLABLE CallGraph::resolved_base_callee(
     const Method* caller,
     const IRInstruction* instruction) const {
-  // Note that `find` is not thread-safe, but this is fine because
-  // `resolved_base_callees_` is read-only after the constructor completed.
-  auto callees = resolved_base_callees_.find(caller);
-  if (callees == resolved_base_callees_.end()) {
+  const auto* call_target = find_callee(caller, instruction);
+  if (call_target == nullptr) {
     return nullptr;
   }
-
-  auto callee = callees->second.find(instruction);
-  if (callee == callees->second.end()) {
-    return nullptr;
-  }
-
-  return callee->second;
+  return call_target->resolved_base_callee();
 }
 
-const std::unordered_map<const IRInstruction*, ArtificialCallees>&
-CallGraph::artificial_callees(const Method* caller) const {
-  // Note that `find` is not thread-safe, but this is fine because
-  // `artificial_callees_` is read-only after the constructor completed.
+const InstructionMap<ArtificialCallees>& CallGraph::artificial_callees(
+    const Method* caller) const {
   auto artificial_callees_map = artificial_callees_.find(caller);
   if (artificial_callees_map == artificial_callees_.end()) {
     return empty_artificial_callees_map_;
@@ -663,12 +780,12 @@ CallGraph::artificial_callees(const Method* caller) const {
 const ArtificialCallees& CallGraph::artificial_callees(
     const Method* caller,
     const IRInstruction* instruction) const {
-  const auto& artificial_callees_map = this->artificial_callees(caller);
-  auto artificial_callees = artificial_callees_map.find(instruction);
-  if (artificial_callees == artificial_callees_map.end()) {
+  const auto* artificial_callees =
+      this->artificial_callees(caller).find(instruction);
+  if (artificial_callees == nullptr) {
     return empty_artificial_callees_;
   } else {
-    return artificial_callees->second;
+    return *artificial_callees;
   }
 }
 
@@ -680,29 +797,28 @@ const Field* MT_NULLABLE CallGraph::resolved_field_access(
     return nullptr;
   }
 
-  auto field = fields->second.find(instruction);
-  if (field == fields->second.end()) {
+  const auto* field = fields->second.find(instruction);
+  if (field == nullptr) {
     return nullptr;
   }
 
-  return field->second;
+  return *field;
+}
+
+void CallGraph::release(const Method* method) {
+  callees_.erase(method);
+  resolved_fields_.erase(method);
+  artificial_callees_.erase(method);
 }
 
 Json::Value CallGraph::to_json(bool with_overrides) const {
   auto value = Json::Value(Json::objectValue);
-  for (const auto& [method, callees] : resolved_base_callees_) {
+  for (const auto& [method, callees] : callees_) {
     auto method_value = Json::Value(Json::objectValue);
 
     std::unordered_set<const Method*> static_callees;
     std::unordered_set<const Method*> virtual_callees;
-    for (const auto& [instruction, resolved_base_callee] : callees) {
-      auto call_target = CallTarget::from_call_instruction(
-          method,
-          instruction,
-          resolved_base_callee,
-          types_,
-          class_hierarchies_,
-          overrides_);
+    for (const auto& call_target : callees) {
       if (!call_target.resolved()) {
         continue;
       } else if (call_target.is_virtual()) {
@@ -720,7 +836,7 @@ Json::Value CallGraph::to_json(bool with_overrides) const {
     if (!static_callees.empty()) {
       auto static_callees_value = Json::Value(Json::arrayValue);
       for (const auto* callee : static_callees) {
-        static_callees_value.append(Json::Value(show(callee)));
+        static_callees_value.append(Json::Value(callee->show()));
       }
       method_value["static"] = static_callees_value;
     }
@@ -728,12 +844,12 @@ Json::Value CallGraph::to_json(bool with_overrides) const {
     if (!virtual_callees.empty()) {
       auto virtual_callees_value = Json::Value(Json::arrayValue);
       for (const auto* callee : virtual_callees) {
-        virtual_callees_value.append(Json::Value(show(callee)));
+        virtual_callees_value.append(Json::Value(callee->show()));
       }
       method_value["virtual"] = virtual_callees_value;
     }
 
-    value[show(method)] = method_value;
+    value[method->show()] = method_value;
   }
   for (const auto& [method, instruction_artificial_callees] :
        artificial_callees_) {
@@ -747,9 +863,9 @@ Json::Value CallGraph::to_json(bool with_overrides) const {
 
     auto callees_value = Json::Value(Json::arrayValue);
     for (const auto* callee : callees) {
-      callees_value.append(Json::Value(show(callee)));
+      callees_value.append(Json::Value(callee->show()));
     }
-    value[show(method)]["artificial"] = callees_value;
+    value[method->show()]["artificial"] = callees_value;
   }
   return value;
 }
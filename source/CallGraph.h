@@ -7,11 +7,11 @@
 
 #pragma once
 
+#include <algorithm>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
-#include <boost/iterator/filter_iterator.hpp>
 #include <boost/range/iterator_range.hpp>
 #include <json/json.h>
 
@@ -35,17 +35,9 @@ namespace marianatrench {
  * Represents information about a specific call.
  */
 class CallTarget final {
- private:
-  struct FilterOverrides {
-    bool operator()(const Method*) const;
-
-    const std::unordered_set<const DexType*>* MT_NULLABLE extends;
-  };
-
  public:
-  using OverridesRange = boost::iterator_range<boost::filter_iterator<
-      FilterOverrides,
-      std::unordered_set<const Method*>::const_iterator>>;
+  using OverridesRange =
+      boost::iterator_range<std::vector<const Method*>::const_iterator>;
 
  public:
   static CallTarget static_call(
@@ -133,15 +125,14 @@ class CallTarget final {
       const IRInstruction* instruction,
       const Method* MT_NULLABLE resolved_base_callee,
       const DexType* MT_NULLABLE receiver_type,
-      const std::unordered_set<const Method*>* MT_NULLABLE overrides,
-      const std::unordered_set<const DexType*>* MT_NULLABLE receiver_extends);
+      const std::vector<const Method*>* MT_NULLABLE overrides);
 
  private:
   const IRInstruction* instruction_;
   const Method* MT_NULLABLE resolved_base_callee_;
   const DexType* MT_NULLABLE receiver_type_;
-  const std::unordered_set<const Method*>* MT_NULLABLE overrides_;
-  const std::unordered_set<const DexType*>* MT_NULLABLE receiver_extends_;
+  // Overrides filtered by receiver type, owned by `Overrides`.
+  const std::vector<const Method*>* MT_NULLABLE overrides_;
 };
 
 } // namespace marianatrench
@@ -154,7 +145,6 @@ struct std::hash<marianatrench::CallTarget> {
     boost::hash_combine(seed, call_target.resolved_base_callee_);
     boost::hash_combine(seed, call_target.receiver_type_);
     boost::hash_combine(seed, call_target.overrides_);
-    boost::hash_combine(seed, call_target.receiver_extends_);
     return seed;
   }
 };
@@ -184,6 +174,82 @@ struct ArtificialCallee {
 
 using ArtificialCallees = std::vector<ArtificialCallee>;
 
+/**
+ * A read-only map from the instructions of a method to values.
+ *
+ * Entries are stored in a vector sorted by instruction, which is more compact
+ * than a hash map and has better locality for the few call sites of a method.
+ */
+template <typename Value>
+class InstructionMap final {
+ public:
+  using Entry = std::pair<const IRInstruction*, Value>;
+  using ConstIterator = typename std::vector<Entry>::const_iterator;
+
+ public:
+  // C++ container concept member types
+  using iterator = ConstIterator;
+  using const_iterator = ConstIterator;
+  using value_type = Entry;
+  using difference_type = std::ptrdiff_t;
+  using size_type = std::size_t;
+  using const_reference = const Entry&;
+  using const_pointer = const Entry*;
+
+ public:
+  InstructionMap() = default;
+
+  explicit InstructionMap(std::vector<Entry> entries)
+      : entries_(std::move(entries)) {
+    std::sort(
+        entries_.begin(),
+        entries_.end(),
+        [](const Entry& left, const Entry& right) {
+          return left.first < right.first;
+        });
+  }
+
+  InstructionMap(const InstructionMap&) = default;
+  InstructionMap(InstructionMap&&) = default;
+  InstructionMap& operator=(const InstructionMap&) = default;
+  InstructionMap& operator=(InstructionMap&&) = default;
+  ~InstructionMap() = default;
+
+  /* Return the value for the given instruction, or `nullptr`. */
+  const Value* MT_NULLABLE find(const IRInstruction* instruction) const {
+    auto found = std::lower_bound(
+        entries_.begin(),
+        entries_.end(),
+        instruction,
+        [](const Entry& entry, const IRInstruction* instruction) {
+          return entry.first < instruction;
+        });
+    if (found == entries_.end() || found->first != instruction) {
+      return nullptr;
+    }
+    return &found->second;
+  }
+
+  bool empty() const {
+    return entries_.empty();
+  }
+
+  std::size_t size() const {
+    return entries_.size();
+  }
+
+  ConstIterator begin() const {
+    return entries_.cbegin();
+  }
+
+  ConstIterator end() const {
+    return entries_.cend();
+  }
+
+ private:
+  std::vector<Entry> entries_;
+};
+
 class CallGraph final {
  public:
   explicit CallGraph(
@@ -201,8 +267,22 @@ class CallGraph final {
   CallGraph& operator=(CallGraph&&) = delete;
   ~CallGraph() = default;
 
-  /* Return all call targets for the given method. */
-  std::vector<CallTarget> callees(const Method* caller) const;
+  /**
+   * Return all call targets for the given method, sorted by instruction.
+   * Call targets are resolved once when building the call graph, hence this
+   * does not allocate.
+   */
+  const std::vector<CallTarget>& callees(const Method* caller) const;
+
+  /* Return true if the given method has any call target. */
+  bool has_callees(const Method* caller) const {
+    return callees_.count(caller) > 0;
+  }
+
+  /* Return the number of call targets of the given method. */
+  std::size_t callee_count(const Method* caller) const {
+    return callees(caller).size();
+  }
 
   /* Return the call target for the given method and instruction. */
   CallTarget callee(const Method* caller, const IRInstruction* instruction)
@@ -214,8 +294,8 @@ class CallGraph final {
       const IRInstruction* instruction) const;
 
   /* Return a mapping from invoke instruction to artificial callees. */
-  const std::unordered_map<const IRInstruction*, ArtificialCallees>&
-  artificial_callees(const Method* caller) const;
+  const InstructionMap<ArtificialCallees>& artificial_callees(
+      const Method* caller) const;
 
   /* Return the artificial callees for an invoke instruction. */
   const ArtificialCallees& artificial_callees(
@@ -229,25 +309,34 @@ class CallGraph final {
 
   Json::Value to_json(bool with_overrides = true) const;
 
+  /**
+   * Free the call targets, field accesses and artificial callees of the given
+   * method, once it will not be analyzed again.
+   *
+   * This is not thread-safe: it must not be called concurrently with lookups.
+   */
+  void release(const Method* method);
+
+ private:
+  /* Return the call target of the given instruction, or `nullptr`. */
+  const CallTarget* MT_NULLABLE
+  find_callee(const Method* caller, const IRInstruction* instruction) const;
+
  private:
   const Types& types_;
   const ClassHierarchies& class_hierarchies_;
   const Overrides& overrides_;
 
-  ConcurrentMap<
-      const Method*,
-      std::unordered_map<const IRInstruction*, const Method*>>
-      resolved_base_callees_;
-  ConcurrentMap<
-      const Method*,
-      std::unordered_map<const IRInstruction*, const Field*>>
+  // These are read-only after the constructor completed, except for `release`,
+  // hence lookups do not require any synchronization.
+  // Call targets of each method with calls, sorted by instruction.
+  std::unordered_map<const Method*, std::vector<CallTarget>> callees_;
+  std::vector<CallTarget> empty_callees_;
+  std::unordered_map<const Method*, InstructionMap<const Field*>>
       resolved_fields_;
-  ConcurrentMap<
-      const Method*,
-      std::unordered_map<const IRInstruction*, ArtificialCallees>>
+  std::unordered_map<const Method*, InstructionMap<ArtificialCallees>>
       artificial_callees_;
-  std::unordered_map<const IRInstruction*, ArtificialCallees>
-      empty_artificial_callees_map_;
+  InstructionMap<ArtificialCallees> empty_artificial_callees_map_;
   ArtificialCallees empty_artificial_callees_;
 };
 
@@ -51,7 +51,7 @@ void materialize_via_value_of_ports(
     const Method* callee,
     Context& context,
     const Frame& frame,
-    const std::vector<std::optional<std::string>>& source_constant_arguments,
+    const std::vector<const DexString * MT_NULLABLE>& source_constant_arguments,
     FeatureMayAlwaysSet& inferred_features) {
   if (!frame.via_value_of_ports().is_value() ||
       frame.via_value_of_ports().elements().empty()) {
@@ -211,7 +211,7 @@ CallPositionFrames CallPositionFrames::propagate(
     int maximum_source_sink_distance,
     Context& context,
     const std::vector<const DexType * MT_NULLABLE>& source_register_types,
-    const std::vector<std::optional<std::string>>& source_constant_arguments)
+    const std::vector<const DexString * MT_NULLABLE>& source_constant_arguments)
     const {
   if (is_bottom()) {
     return CallPositionFrames::bottom();
@@ -284,7 +284,7 @@ Frame CallPositionFrames::propagate_frames(
     int maximum_source_sink_distance,
     Context& context,
     const std::vector<const DexType * MT_NULLABLE>& source_register_types,
-    const std::vector<std::optional<std::string>>& source_constant_arguments,
+    const std::vector<const DexString * MT_NULLABLE>& source_constant_arguments,
     std::vector<std::reference_wrapper<const Frame>> frames,
     std::vector<const Feature*>& via_type_of_features_added) const {
   if (frames.size() == 0) {
@@ -165,7 +165,8 @@ class CallPositionFrames final
       int maximum_source_sink_distance,
       Context& context,
       const std::vector<const DexType * MT_NULLABLE>& source_register_types,
-      const std::vector<std::optional<std::string>>& source_constant_arguments)
+      const std::vector<const DexString * MT_NULLABLE>&
+          source_constant_arguments)
       const;
 
   template <class T>
@@ -180,7 +181,8 @@ class CallPositionFrames final
       int maximum_source_sink_distance,
       Context& context,
       const std::vector<const DexType * MT_NULLABLE>& source_register_types,
-      const std::vector<std::optional<std::string>>& source_constant_arguments,
+      const std::vector<const DexString * MT_NULLABLE>&
+          source_constant_arguments,
       std::vector<std::reference_wrapper<const Frame>> frames,
       std::vector<const Feature*>& via_type_of_features_added) const;
 
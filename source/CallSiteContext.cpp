@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <mariana-trench/CallSiteContext.h>
+#include <mariana-trench/Features.h>
+#include <mariana-trench/Log.h>
+
+namespace marianatrench {
+
+CallSiteContext::CallSiteContext(
+    const Method* caller,
+    const Method* callee,
+    const Position* call_position,
+    int maximum_source_sink_distance,
+    FeatureMayAlwaysSet extra_features,
+    Context& context,
+    const std::vector<const DexType * MT_NULLABLE>& source_register_types,
+    const std::vector<const DexString * MT_NULLABLE>& source_constant_arguments)
+    : caller_(caller),
+      callee_(callee),
+      call_position_(call_position),
+      maximum_source_sink_distance_(maximum_source_sink_distance),
+      extra_features_(std::move(extra_features)),
+      context_(context),
+      source_register_types_(source_register_types),
+      source_constant_arguments_(source_constant_arguments),
+      via_type_of_features_(source_register_types.size(), nullptr),
+      via_value_of_features_(source_constant_arguments.size(), nullptr) {}
+
+const Feature* MT_NULLABLE
+CallSiteContext::via_type_of_feature(Root port) const {
+  if (!port.is_argument() ||
+      port.parameter_position() >= source_register_types_.size()) {
+    ERROR(
+        1,
+        "Invalid port {} provided for via_type_of ports of method {}.{}",
+        port,
+        callee_->get_class()->str(),
+        callee_->get_name());
+    return nullptr;
+  }
+
+  auto& feature = via_type_of_features_[port.parameter_position()];
+  if (feature == nullptr) {
+    feature = context_.features->get_via_type_of_feature(
+        source_register_types_[port.parameter_position()]);
+  }
+  return feature;
+}
+
+const Feature* MT_NULLABLE
+CallSiteContext::via_value_of_feature(Root port) const {
+  if (!port.is_argument() ||
+      port.parameter_position() >= source_constant_arguments_.size()) {
+    ERROR(
+        1,
+        "Invalid port {} provided for via_value_of ports of method {}.{}",
+        port,
+        callee_->get_class()->str(),
+        callee_->get_name());
+    return nullptr;
+  }
+
+  auto& feature = via_value_of_features_[port.parameter_position()];
+  if (feature == nullptr) {
+    feature = context_.features->get_via_value_of_feature(
+        source_constant_arguments_[port.parameter_position()]);
+  }
+  return feature;
+}
+
+} // namespace marianatrench
@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include <DexClass.h>
+
+#include <mariana-trench/Access.h>
+#include <mariana-trench/Compiler.h>
+#include <mariana-trench/Context.h>
+#include <mariana-trench/Feature.h>
+#include <mariana-trench/FeatureMayAlwaysSet.h>
+#include <mariana-trench/Method.h>
+#include <mariana-trench/Position.h>
+
+namespace marianatrench {
+
+/**
+ * Information about a call site that is shared by all frames propagated from
+ * the callee to the caller.
+ *
+ * The via-type-of and via-value-of features are materialized lazily, at most
+ * once per parameter, instead of once per frame.
+ *
+ * This is not thread-safe.
+ */
+class CallSiteContext final {
+ public:
+  CallSiteContext(
+      const Method* caller,
+      const Method* callee,
+      const Position* call_position,
+      int maximum_source_sink_distance,
+      FeatureMayAlwaysSet extra_features,
+      Context& context,
+      const std::vector<const DexType * MT_NULLABLE>& source_register_types,
+      const std::vector<const DexString * MT_NULLABLE>&
+          source_constant_arguments);
+
+  CallSiteContext(const CallSiteContext&) = delete;
+  CallSiteContext(CallSiteContext&&) = delete;
+  CallSiteContext& operator=(const CallSiteContext&) = delete;
+  CallSiteContext& operator=(CallSiteContext&&) = delete;
+  ~CallSiteContext() = default;
+
+  const Method* caller() const {
+    return caller_;
+  }
+
+  const Method* callee() const {
+    return callee_;
+  }
+
+  const Position* call_position() const {
+    return call_position_;
+  }
+
+  int maximum_source_sink_distance() const {
+    return maximum_source_sink_distance_;
+  }
+
+  /* Features added to all propagated frames, see `ClassProperties`. */
+  const FeatureMayAlwaysSet& extra_features() const {
+    return extra_features_;
+  }
+
+  Context& context() const {
+    return context_;
+  }
+
+  const std::vector<const DexType * MT_NULLABLE>& source_register_types()
+      const {
+    return source_register_types_;
+  }
+
+  /**
+   * Return the via-type-of feature for the given port, or `nullptr` if the
+   * port is not a valid argument of the call.
+   */
+  const Feature* MT_NULLABLE via_type_of_feature(Root port) const;
+
+  /**
+   * Return the via-value-of feature for the given port, or `nullptr` if the
+   * port is not a valid argument of the call.
+   */
+  const Feature* MT_NULLABLE via_value_of_feature(Root port) const;
+
+ private:
+  const Method* caller_;
+  const Method* callee_;
+  const Position* call_position_;
+  int maximum_source_sink_distance_;
+  FeatureMayAlwaysSet extra_features_;
+  Context& context_;
+  const std::vector<const DexType * MT_NULLABLE>& source_register_types_;
+  const std::vector<const DexString * MT_NULLABLE>& source_constant_arguments_;
+  // Materialized features, indexed by parameter position.
+  mutable std::vector<const Feature * MT_NULLABLE> via_type_of_features_;
+  mutable std::vector<const Feature * MT_NULLABLE> via_value_of_features_;
+};
+
+} // namespace marianatrench
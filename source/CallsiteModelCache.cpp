@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <algorithm>
+
+#include <boost/functional/hash.hpp>
+
+#include <mariana-trench/Assert.h>
+#include <mariana-trench/CallsiteModelCache.h>
+
+namespace marianatrench {
+
+bool CallsiteModelCache::Key::operator==(const Key& other) const {
+  return callee == other.callee && virtual_call == other.virtual_call &&
+      receiver_type == other.receiver_type && caller == other.caller &&
+      position == other.position &&
+      source_register_types == other.source_register_types &&
+      source_constant_arguments == other.source_constant_arguments;
+}
+
+std::size_t CallsiteModelCache::KeyHash::operator()(const Key& key) const {
+  std::size_t seed = 0;
+  boost::hash_combine(seed, key.callee);
+  boost::hash_combine(seed, key.virtual_call);
+  boost::hash_combine(seed, key.receiver_type);
+  boost::hash_combine(seed, key.caller);
+  boost::hash_combine(seed, key.position);
+  for (const auto* type : key.source_register_types) {
+    boost::hash_combine(seed, type);
+  }
+  for (const auto* argument : key.source_constant_arguments) {
+    boost::hash_combine(seed, argument);
+  }
+  return seed;
+}
+
+CallsiteModelCache::CallsiteModelCache(std::size_t maximum_size)
+    : maximum_shard_size_(std::max<std::size_t>(1, maximum_size / kShards)),
+      hits_(0),
+      misses_(0),
+      invalidations_(0),
+      evictions_(0) {}
+
+Model CallsiteModelCache::get(
+    const std::shared_ptr<const Model>& callee_model,
+    const Method* caller,
+    const Position* MT_NULLABLE position,
+    const std::vector<const DexType * MT_NULLABLE>& source_register_types,
+    const std::vector<const DexString * MT_NULLABLE>& source_constant_arguments,
+    const std::function<Model()>& at_callsite) {
+  auto key = Key{
+      callee_model->method(),
+      /* virtual_call */ false,
+      /* receiver_type */ nullptr,
+      caller,
+      position,
+      source_register_types,
+      source_constant_arguments};
+  return get_or_compute(
+      std::move(key), &callee_model, /* callee_models_size */ 1, at_callsite);
+}
+
+Model CallsiteModelCache::get_virtual(
+    const std::vector<std::shared_ptr<const Model>>& callee_models,
+    const DexType* MT_NULLABLE receiver_type,
+    const Method* caller,
+    const Position* MT_NULLABLE position,
+    const std::vector<const DexType * MT_NULLABLE>& source_register_types,
+    const std::vector<const DexString * MT_NULLABLE>& source_constant_arguments,
+    const std::function<Model()>& join) {
+  mt_assert(!callee_models.empty());
+  auto key = Key{
+      callee_models.front()->method(),
+      /* virtual_call */ true,
+      receiver_type,
+      caller,
+      position,
+      source_register_types,
+      source_constant_arguments};
+  return get_or_compute(
+      std::move(key), callee_models.data(), callee_models.size(), join);
+}
+
+Model CallsiteModelCache::get_or_compute(
+    Key key,
+    const std::shared_ptr<const Model>* callee_models,
+    std::size_t callee_models_size,
+    const std::function<Model()>& compute) {
+  auto& shard = shards_[KeyHash()(key) % kShards];
+
+  {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto found = shard.entries.find(key);
+    if (found != shard.entries.end()) {
+      const auto& entry_models = found->second.callee_models;
+      if (std::equal(
+              entry_models.begin(),
+              entry_models.end(),
+              callee_models,
+              callee_models + callee_models_size)) {
+        hits_++;
+        return found->second.model;
+      }
+      invalidations_++;
+      shard.entries.erase(found);
+    }
+  }
+
+  // Compute outside of the lock. Concurrent misses on the same key both
+  // compute the same model.
+  misses_++;
+  auto model = compute();
+
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  if (shard.entries.size() >= maximum_shard_size_) {
+    evictions_ += shard.entries.size();
+    shard.entries.clear();
+  }
+  shard.entries.insert_or_assign(
+      std::move(key),
+      Entry{
+          std::vector<std::shared_ptr<const Model>>(
+              callee_models, callee_models + callee_models_size),
+          model});
+  return model;
+}
+
+double CallsiteModelCache::hit_rate() const {
+  auto hits = hits_.load();
+  auto total = hits + misses_.load();
+  return total == 0 ? 0.0 : static_cast<double>(hits) / total;
+}
+
+Json::Value CallsiteModelCache::statistics_to_json() const {
+  auto value = Json::Value(Json::objectValue);
+  value["hits"] = Json::Value(static_cast<Json::UInt64>(hits_.load()));
+  value["misses"] = Json::Value(static_cast<Json::UInt64>(misses_.load()));
+  value["invalidations"] =
+      Json::Value(static_cast<Json::UInt64>(invalidations_.load()));
+  value["evictions"] =
+      Json::Value(static_cast<Json::UInt64>(evictions_.load()));
+  value["hit_rate"] = Json::Value(hit_rate());
+  return value;
+}
+
+} // namespace marianatrench
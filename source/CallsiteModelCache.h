@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <json/json.h>
+
+#include <DexClass.h>
+
+#include <mariana-trench/Compiler.h>
+#include <mariana-trench/Method.h>
+#include <mariana-trench/Model.h>
+#include <mariana-trench/Position.h>
+
+namespace marianatrench {
+
+/**
+ * A process-wide cache of callee models instantiated at call sites (see
+ * `Model::at_callsite`), shared by all method analyses.
+ *
+ * Entries are keyed on the callee, the caller, the call position and the
+ * register types and constant arguments. Each entry remembers the registry
+ * snapshot of the callee model it was computed from (see
+ * `Registry::get_snapshot`): it is invalidated as soon as the callee model
+ * changes.
+ *
+ * Virtual calls cache the join of the models of the resolved base callee and
+ * its overrides at the call site, keyed on the receiver type that filters the
+ * overrides. These entries remember the snapshots of all joined models, and
+ * are invalidated as soon as any of them changes.
+ *
+ * The cache is split in shards, each protected by its own lock. A shard is
+ * cleared when it reaches its share of the maximum number of entries.
+ */
+class CallsiteModelCache final {
+ public:
+  explicit CallsiteModelCache(std::size_t maximum_size);
+  CallsiteModelCache(const CallsiteModelCache&) = delete;
+  CallsiteModelCache(CallsiteModelCache&&) = delete;
+  CallsiteModelCache& operator=(const CallsiteModelCache&) = delete;
+  CallsiteModelCache& operator=(CallsiteModelCache&&) = delete;
+  ~CallsiteModelCache() = default;
+
+  /**
+   * Return the cached model for the given call site, or compute it with
+   * `at_callsite` and store it. This is thread-safe.
+   */
+  Model get(
+      const std::shared_ptr<const Model>& callee_model,
+      const Method* caller,
+      const Position* MT_NULLABLE position,
+      const std::vector<const DexType * MT_NULLABLE>& source_register_types,
+      const std::vector<const DexString * MT_NULLABLE>&
+          source_constant_arguments,
+      const std::function<Model()>& at_callsite);
+
+  /**
+   * Return the cached join of the models of a virtual call site, or compute
+   * it with `join` and store it. `callee_models` are the current snapshots of
+   * the resolved base callee, followed by its overrides. This is thread-safe.
+   */
+  Model get_virtual(
+      const std::vector<std::shared_ptr<const Model>>& callee_models,
+      const DexType* MT_NULLABLE receiver_type,
+      const Method* caller,
+      const Position* MT_NULLABLE position,
+      const std::vector<const DexType * MT_NULLABLE>& source_register_types,
+      const std::vector<const DexString * MT_NULLABLE>&
+          source_constant_arguments,
+      const std::function<Model()>& join);
+
+  double hit_rate() const;
+
+  Json::Value statistics_to_json() const;
+
+  constexpr static std::size_t kShards = 64;
+
+ private:
+  struct Key {
+    const Method* callee;
+    // Set for the joined models of virtual calls.
+    bool virtual_call;
+    const DexType* MT_NULLABLE receiver_type;
+    const Method* caller;
+    const Position* MT_NULLABLE position;
+    std::vector<const DexType * MT_NULLABLE> source_register_types;
+    std::vector<const DexString * MT_NULLABLE> source_constant_arguments;
+
+    bool operator==(const Key& other) const;
+  };
+
+  struct KeyHash {
+    std::size_t operator()(const Key& key) const;
+  };
+
+  struct Entry {
+    // Snapshots the model was computed from, to detect updates.
+    std::vector<std::shared_ptr<const Model>> callee_models;
+    Model model;
+  };
+
+  struct Shard {
+    std::mutex mutex;
+    std::unordered_map<Key, Entry, KeyHash> entries;
+  };
+
+  Model get_or_compute(
+      Key key,
+      const std::shared_ptr<const Model>* callee_models,
+      std::size_t callee_models_size,
+      const std::function<Model()>& compute);
+
+ private:
+  std::size_t maximum_shard_size_;
+  std::array<Shard, kShards> shards_;
+  std::atomic<std::size_t> hits_;
+  std::atomic<std::size_t> misses_;
+  std::atomic<std::size_t> invalidations_;
+  std::atomic<std::size_t> evictions_;
+};
+
+} // namespace marianatrench
@@ -5,10 +5,17 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <memory>
+#include <optional>
+#include <string>
+
 #include <boost/algorithm/string/replace.hpp>
+#include <boost/functional/hash.hpp>
 #include <json/value.h>
 #include <re2/re2.h>
 
+#include <ConcurrentContainers.h>
+
 #include <mariana-trench/Assert.h>
 #include <mariana-trench/CanonicalName.h>
 #include <mariana-trench/JsonValidation.h>
@@ -28,6 +35,46 @@ void convert_to_lower_underscore(std::string& input) {
       });
 }
 
+/**
+ * Key of the instantiation cache. The instantiation only depends on the method
+ * signature and the feature name, which are used rather than pointers since
+ * the cache outlives the method and feature factories.
+ */
+struct InstantiationKey {
+  std::string template_value;
+  std::string method_signature;
+  std::optional<std::string> via_type_of;
+
+  bool operator==(const InstantiationKey& other) const {
+    return template_value == other.template_value &&
+        method_signature == other.method_signature &&
+        via_type_of == other.via_type_of;
+  }
+};
+
+struct InstantiationKeyHash {
+  std::size_t operator()(const InstantiationKey& key) const {
+    std::size_t seed = 0;
+    boost::hash_combine(seed, key.template_value);
+    boost::hash_combine(seed, key.method_signature);
+    if (key.via_type_of) {
+      boost::hash_combine(seed, *key.via_type_of);
+    }
+    return seed;
+  }
+};
+
+using InstantiationCache = ConcurrentMap<
+    InstantiationKey,
+    std::shared_ptr<const std::optional<CanonicalName>>,
+    InstantiationKeyHash>;
+
+InstantiationCache& instantiation_cache() {
+  // Never destroyed: frames in static storage may outlive the cache.
+  static auto* cache = new InstantiationCache();
+  return *cache;
+}
+
 } // namespace
 
 bool CanonicalName::is_via_type_of_template() const {
@@ -42,9 +89,36 @@ bool CanonicalName::is_via_type_of_template() const {
 std::optional<CanonicalName> CanonicalName::instantiate(
     const Method* method,
     const std::vector<const Feature*>& via_type_ofs) const {
-  auto value = template_value();
-  mt_assert(value);
-  auto canonical_name = *value;
+  mt_assert(std::holds_alternative<TemplateValue>(value_));
+  const auto& template_string = std::get<TemplateValue>(value_).value;
+
+  // Ambiguous via-type-of features are an error, do not cache them.
+  if (via_type_ofs.size() > 1) {
+    return instantiate_uncached(template_string, method, via_type_ofs);
+  }
+
+  auto key = InstantiationKey{
+      template_string,
+      method->signature(),
+      via_type_ofs.empty()
+          ? std::nullopt
+          : std::make_optional(via_type_ofs.front()->name())};
+  auto& cache = instantiation_cache();
+  if (auto cached = cache.get(key, nullptr)) {
+    return *cached;
+  }
+
+  auto result = std::make_shared<const std::optional<CanonicalName>>(
+      instantiate_uncached(template_string, method, via_type_ofs));
+  cache.emplace(std::move(key), result);
+  return *result;
+}
+
+std::optional<CanonicalName> CanonicalName::instantiate_uncached(
+    const std::string& template_string,
+    const Method* method,
+    const std::vector<const Feature*>& via_type_ofs) {
+  auto canonical_name = template_string;
 
   if (canonical_name.find(k_leaf_name_marker) != std::string::npos) {
     auto callee_name = method->signature();
@@ -77,13 +151,13 @@ std::optional<CanonicalName> CanonicalName::instantiate(
       WARNING(
           2,
           "Could not instantiate canonical name template '{}'. Via-type-of feature not available.",
-          *value);
+          template_string);
       return std::nullopt;
     } else if (via_type_ofs.size() > 1) {
       ERROR(
           1,
           "Could not instantiate canonical name template '{}'. Unable to disambiguate between {} via-type-of features.",
-          *value,
+          template_string,
           via_type_ofs.size());
       // Should have been verified when parsing models during model-generation.
       mt_assert(false);
@@ -116,6 +116,10 @@ class CanonicalName final {
    * model-generation rather than in `Frame::propagate`.
    *
    * Returns `std::nullopt` if unable to instantiate.
+   *
+   * Results are memoized on (template, method signature, via-type-of feature),
+   * since the same templates are instantiated on every propagation.
+   * Thread-safe.
    */
   std::optional<CanonicalName> instantiate(
       const Method* method,
@@ -127,6 +131,11 @@ class CanonicalName final {
  private:
   friend std::ostream& operator<<(std::ostream& out, const CanonicalName& root);
 
+  static std::optional<CanonicalName> instantiate_uncached(
+      const std::string& template_string,
+      const Method* method,
+      const std::vector<const Feature*>& via_type_ofs);
+
  private:
   std::variant<TemplateValue, InstantiatedValue> value_;
 };
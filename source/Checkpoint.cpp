@@ -0,0 +1,156 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <boost/filesystem/operations.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+#include <fmt/format.h>
+
+#include <mariana-trench/BinaryJson.h>
+#include <mariana-trench/Checkpoint.h>
+#include <mariana-trench/JsonValidation.h>
+#include <mariana-trench/Log.h>
+#include <mariana-trench/Timer.h>
+
+namespace marianatrench {
+
+Checkpoint::Checkpoint(boost::filesystem::path path) : path_(std::move(path)) {}
+
+Checkpoint::~Checkpoint() {
+  wait();
+}
+
+void Checkpoint::write(
+    Context& context,
+    const Registry& registry,
+    std::size_t iteration,
+    const MethodBitset& methods_to_analyze) {
+  wait();
+
+  std::vector<std::shared_ptr<const Model>> models;
+  models.reserve(context.methods->size());
+  for (const auto* method : *context.methods) {
+    models.push_back(registry.get_snapshot(method));
+  }
+  std::vector<const Method*> methods;
+  methods_to_analyze.visit(
+      [&](const Method* method) { methods.push_back(method); });
+
+  pending_ = std::async(
+      std::launch::async,
+      [path = path_,
+       iteration,
+       models = std::move(models),
+       methods = std::move(methods)]() {
+        try {
+          Timer timer;
+          BinaryJsonWriter writer;
+          auto header = Json::Value(Json::objectValue);
+          header["iteration"] = Json::UInt64(iteration);
+          auto methods_value = Json::Value(Json::arrayValue);
+          for (const auto* method : methods) {
+            methods_value.append(method->to_json());
+          }
+          header["methods_to_analyze"] = methods_value;
+          writer.add(header);
+          for (const auto& model : models) {
+            writer.add(model->to_json());
+          }
+
+          auto temporary_path = path;
+          temporary_path += ".tmp";
+          std::ofstream stream(
+              temporary_path.native(),
+              std::ios_base::out | std::ios_base::binary);
+          if (!stream.is_open()) {
+            throw std::runtime_error(fmt::format(
+                "Unable to write checkpoint to `{}`.",
+                temporary_path.native()));
+          }
+          writer.write(stream);
+          stream.close();
+          boost::filesystem::rename(temporary_path, path);
+
+          LOG(1,
+              "Wrote checkpoint of iteration {} to `{}` in {:.2f}s.",
+              iteration,
+              path.native(),
+              timer.duration_in_seconds());
+        } catch (const std::exception& exception) {
+          // A failed checkpoint should not stop the analysis.
+          ERROR(1, "Could not write checkpoint: {}", exception.what());
+        }
+      });
+}
+
+void Checkpoint::wait() {
+  if (pending_.valid()) {
+    pending_.get();
+  }
+}
+
+Checkpoint::State Checkpoint::load(
+    Context& context,
+    Registry& registry,
+    const boost::filesystem::path& path) {
+  Timer timer;
+  boost::iostreams::mapped_file_source file(path);
+  BinaryJsonReader reader(std::string_view(file.data(), file.size()));
+
+  auto header = reader.next();
+  if (!header || !header->isObject() || !header->isMember("iteration") ||
+      !header->isMember("methods_to_analyze")) {
+    throw std::runtime_error(
+        fmt::format("Invalid checkpoint `{}`.", path.native()));
+  }
+
+  std::size_t unknown_methods = 0;
+  auto state = State{(*header)["iteration"].asUInt64(), {}};
+  for (const auto& value : (*header)["methods_to_analyze"]) {
+    try {
+      state.methods_to_analyze.insert(Method::from_json(value, context));
+    } catch (const JsonValidationError&) {
+      unknown_methods++;
+    }
+  }
+
+  std::size_t loaded_models = 0;
+  while (auto value = reader.next()) {
+    const Method* method = nullptr;
+    try {
+      method = Method::from_json((*value)["method"], context);
+    } catch (const JsonValidationError&) {
+      unknown_methods++;
+      continue;
+    }
+    registry.join_with(Model::from_json(method, *value, context));
+    loaded_models++;
+  }
+
+  if (unknown_methods > 0) {
+    WARNING(
+        1,
+        "Ignored {} unknown methods in `{}`, checkpoints must be resumed on the same program.",
+        unknown_methods,
+        path.native());
+  }
+  LOG(1,
+      "Resuming from iteration {} with {} models and {} methods to analyze in {:.2f}s.",
+      state.iteration,
+      loaded_models,
+      state.methods_to_analyze.size(),
+      timer.duration_in_seconds());
+  return state;
+}
+
+} // namespace marianatrench
@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <future>
+#include <unordered_set>
+
+#include <boost/filesystem/path.hpp>
+
+#include <mariana-trench/Context.h>
+#include <mariana-trench/Method.h>
+#include <mariana-trench/MethodBitset.h>
+#include <mariana-trench/Registry.h>
+
+namespace marianatrench {
+
+/**
+ * Checkpoint of the global fixpoint, to resume a long analysis after it was
+ * interrupted (see `--checkpoint-interval` and `--resume-from`).
+ *
+ * A checkpoint holds the models of all methods and the methods left to
+ * analyze at the end of a global iteration, in the binary json format (see
+ * `BinaryJson`). The first value is a header with the `iteration` and the
+ * `methods_to_analyze`, followed by one value per model.
+ *
+ * Snapshots of the models are taken synchronously, which is cheap since
+ * models are immutable once stored in the registry. They are serialized and
+ * written in the background while the next iteration runs. A checkpoint is
+ * written to a temporary file first, hence the previous checkpoint remains
+ * valid until the new one is complete.
+ */
+class Checkpoint final {
+ public:
+  struct State {
+    std::size_t iteration;
+    std::unordered_set<const Method*> methods_to_analyze;
+  };
+
+ public:
+  explicit Checkpoint(boost::filesystem::path path);
+
+  Checkpoint(const Checkpoint&) = delete;
+  Checkpoint(Checkpoint&&) = delete;
+  Checkpoint& operator=(const Checkpoint&) = delete;
+  Checkpoint& operator=(Checkpoint&&) = delete;
+
+  /* Wait for the pending write, if any. */
+  ~Checkpoint();
+
+  /**
+   * Start writing a checkpoint of the registry, after the given global
+   * iteration. This waits for the previous write to complete first.
+   *
+   * This is not thread-safe with respect to updates of the registry.
+   */
+  void write(
+      Context& context,
+      const Registry& registry,
+      std::size_t iteration,
+      const MethodBitset& methods_to_analyze);
+
+  /* Wait for the pending write, if any. */
+  void wait();
+
+  /**
+   * Join the models of the checkpoint at the given path into the registry and
+   * return the state of the fixpoint. Throws `std::runtime_error` if the file
+   * is not a valid checkpoint.
+   */
+  static State load(
+      Context& context,
+      Registry& registry,
+      const boost::filesystem::path& path);
+
+ private:
+  boost::filesystem::path path_;
+  std::future<void> pending_;
+};
+
+} // namespace marianatrench
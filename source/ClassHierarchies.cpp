@@ -5,6 +5,11 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <algorithm>
+#include <unordered_set>
+#include <utility>
+
+#include <ConcurrentContainers.h>
 #include <Show.h>
 #include <Walkers.h>
 
@@ -19,43 +24,117 @@ namespace {
 
 class Graph {
  public:
-  void add_edge(const DexType* child, const DexType* parent) {
-    extends_.update(
-        parent,
-        [=](const DexType* /* parent */,
-            std::unordered_set<const DexType*>& children,
-            bool /* exists */) { children.insert(child); });
+  void add_super_edge(const DexType* child, const DexType* parent) {
+    add_edge(super_children_, child, parent);
+    has_super_.insert(child);
   }
 
-  std::unordered_set<const DexType*> extends(const DexType* parent) const {
-    std::unordered_set<const DexType*> result;
-    std::vector<const DexType*> worklist;
-    worklist.push_back(parent);
+  void add_interface_edge(const DexType* child, const DexType* parent) {
+    add_edge(interface_children_, child, parent);
+  }
 
-    while (!worklist.empty()) {
-      const DexType* klass = worklist.back();
-      worklist.pop_back();
+  void add_class(const DexType* klass) {
+    classes_.insert(klass);
+  }
 
-      auto children = extends_.find(klass);
-      if (children != extends_.end()) {
-        for (const auto* child : children->second) {
-          if (result.insert(child).second) {
-            worklist.push_back(child);
-          }
-        }
+  /* Return all types that appear in the graph. */
+  std::vector<const DexType*> types() const {
+    std::unordered_set<const DexType*> types;
+    for (const auto* children_map : {&super_children_, &interface_children_}) {
+      for (const auto& [parent, children] : *children_map) {
+        types.insert(parent);
+        types.insert(children.begin(), children.end());
       }
     }
+    return std::vector<const DexType*>(types.begin(), types.end());
+  }
+
+  const std::vector<const DexType*>& super_children(
+      const DexType* parent) const {
+    return children(super_children_, parent);
+  }
+
+  const std::vector<const DexType*>& interface_children(
+      const DexType* parent) const {
+    return children(interface_children_, parent);
+  }
+
+  bool has_super(const DexType* type) const {
+    return has_super_.count(type) > 0;
+  }
 
-    return result;
+  bool is_class(const DexType* type) const {
+    return classes_.count(type) > 0;
+  }
+
+ private:
+  using ChildrenMap =
+      ConcurrentMap<const DexType*, std::vector<const DexType*>>;
+
+  static void add_edge(
+      ChildrenMap& map,
+      const DexType* child,
+      const DexType* parent) {
+    map.update(
+        parent,
+        [=](const DexType* /* parent */,
+            std::vector<const DexType*>& children,
+            bool /* exists */) { children.push_back(child); });
+  }
+
+  const std::vector<const DexType*>& children(
+      const ChildrenMap& map,
+      const DexType* parent) const {
+    auto found = map.find(parent);
+    return found != map.end() ? found->second : no_children_;
   }
 
  private:
   // Map a class to all classes that *directly* extend it.
-  ConcurrentMap<const DexType*, std::unordered_set<const DexType*>> extends_;
+  ChildrenMap super_children_;
+  // Map an interface to all classes that *directly* implement it.
+  ChildrenMap interface_children_;
+  ConcurrentSet<const DexType*> has_super_;
+  ConcurrentSet<const DexType*> classes_;
+  std::vector<const DexType*> no_children_;
 };
 
 } // namespace
 
+bool ClassHierarchies::TypeSet::contains(const DexType* type) const {
+  if (intervals_.empty()) {
+    return false;
+  }
+
+  auto found = hierarchies_->identifiers_.find(type);
+  if (found == hierarchies_->identifiers_.end()) {
+    return false;
+  }
+  auto identifier = found->second;
+
+  // Find the last interval that starts before the identifier.
+  auto interval = std::upper_bound(
+      intervals_.begin(),
+      intervals_.end(),
+      identifier,
+      [](std::uint32_t identifier, const Interval& interval) {
+        return identifier < interval.begin;
+      });
+  if (interval == intervals_.begin()) {
+    return false;
+  }
+  --interval;
+  return identifier < interval->end;
+}
+
+std::size_t ClassHierarchies::TypeSet::size() const {
+  std::size_t size = 0;
+  for (const auto& interval : intervals_) {
+    size += interval.end - interval.begin;
+  }
+  return size;
+}
+
 ClassHierarchies::ClassHierarchies(
     const Options& options,
     const DexStoresVector& stores) {
@@ -64,28 +143,144 @@ ClassHierarchies::ClassHierarchies(
   // Compute the class hierarchy graph.
   for (const auto& scope : DexStoreClassesIterator(stores)) {
     walk::parallel::classes(scope, [&](const DexClass* klass) {
+      graph.add_class(klass->get_type());
       const DexType* super = klass->get_super_class();
       if (super != type::java_lang_Object()) {
-        graph.add_edge(/* child */ klass->get_type(), /* parent */ super);
+        graph.add_super_edge(/* child */ klass->get_type(), /* parent */ super);
       }
       for (DexType* interface : *klass->get_interfaces()) {
-        graph.add_edge(/* child */ klass->get_type(), /* parent */ interface);
+        graph.add_interface_edge(
+            /* child */ klass->get_type(), /* parent */ interface);
       }
     });
   }
 
-  // Record the results.
-  for (const auto& scope : DexStoreClassesIterator(stores)) {
-    walk::parallel::classes(scope, [&](const DexClass* klass) {
-      auto extends = graph.extends(klass->get_type());
+  // Number types in the pre-order of the superclass tree. `end[identifier]`
+  // is the identifier following the last subclass of a type.
+  auto types = graph.types();
+  types_.reserve(types.size());
+  identifiers_.reserve(types.size());
+  std::vector<std::uint32_t> end(types.size(), 0);
+  auto number_subtree = [&](const DexType* root) {
+    // Stack of (identifier, index of the next child to visit).
+    std::vector<std::pair<std::uint32_t, std::size_t>> stack;
+    auto visit = [&](const DexType* type) {
+      auto identifier = static_cast<std::uint32_t>(types_.size());
+      types_.push_back(type);
+      identifiers_.emplace(type, identifier);
+      stack.emplace_back(identifier, 0);
+    };
+    visit(root);
+    while (!stack.empty()) {
+      auto& [identifier, next_child] = stack.back();
+      const auto& children = graph.super_children(types_[identifier]);
+      if (next_child == children.size()) {
+        end[identifier] = static_cast<std::uint32_t>(types_.size());
+        stack.pop_back();
+        continue;
+      }
+      const auto* child = children[next_child++];
+      if (identifiers_.count(child) == 0) {
+        visit(child);
+      }
+    }
+  };
+  for (const auto* type : types) {
+    if (!graph.has_super(type)) {
+      number_subtree(type);
+    }
+  }
+  // Types in a (malformed) superclass cycle are not reachable from a root.
+  for (const auto* type : types) {
+    if (identifiers_.count(type) == 0) {
+      number_subtree(type);
+    }
+  }
+
+  // Compute the intervals of the classes extending each type, from the
+  // intervals of its children.
+  extends_.resize(types_.size());
+  enum class State { Unvisited, Visiting, Visited };
+  std::vector<State> states(types_.size(), State::Unvisited);
+  std::vector<std::uint32_t> worklist;
+  for (std::uint32_t root = 0; root < types_.size(); root++) {
+    if (states[root] != State::Unvisited) {
+      continue;
+    }
+    worklist.push_back(root);
+    while (!worklist.empty()) {
+      auto identifier = worklist.back();
+      const auto* type = types_[identifier];
+      const auto& super_children = graph.super_children(type);
+      const auto& interface_children = graph.interface_children(type);
 
-      if (!extends.empty()) {
-        extends_.emplace(
-            klass->get_type(),
-            std::make_unique<std::unordered_set<const DexType*>>(
-                std::move(extends)));
+      if (states[identifier] == State::Unvisited) {
+        states[identifier] = State::Visiting;
+        for (const auto* children : {&super_children, &interface_children}) {
+          for (const auto* child : *children) {
+            auto child_identifier = identifiers_.at(child);
+            if (states[child_identifier] == State::Unvisited) {
+              worklist.push_back(child_identifier);
+            }
+          }
+        }
+        continue;
       }
-    });
+
+      worklist.pop_back();
+      if (states[identifier] == State::Visited) {
+        continue;
+      }
+      states[identifier] = State::Visited;
+
+      auto& intervals = extends_[identifier].intervals_;
+      if (identifier + 1 < end[identifier]) {
+        intervals.push_back(TypeSet::Interval{identifier + 1, end[identifier]});
+      }
+      for (const auto* child : interface_children) {
+        auto child_identifier = identifiers_.at(child);
+        intervals.push_back(
+            TypeSet::Interval{child_identifier, end[child_identifier]});
+      }
+      for (const auto* children : {&super_children, &interface_children}) {
+        for (const auto* child : *children) {
+          // Children in a (malformed) cycle might be incomplete here.
+          const auto& child_intervals =
+              extends_[identifiers_.at(child)].intervals_;
+          intervals.insert(
+              intervals.end(), child_intervals.begin(), child_intervals.end());
+        }
+      }
+
+      // Merge overlapping and adjacent intervals.
+      std::sort(
+          intervals.begin(),
+          intervals.end(),
+          [](const TypeSet::Interval& left, const TypeSet::Interval& right) {
+            return left.begin < right.begin;
+          });
+      std::size_t merged = 0;
+      for (const auto& interval : intervals) {
+        if (merged > 0 && interval.begin <= intervals[merged - 1].end) {
+          intervals[merged - 1].end =
+              std::max(intervals[merged - 1].end, interval.end);
+        } else {
+          intervals[merged++] = interval;
+        }
+      }
+      intervals.resize(merged);
+    }
+  }
+
+  // Only classes defined in the stores have a hierarchy.
+  for (std::uint32_t identifier = 0; identifier < types_.size();
+       identifier++) {
+    auto& extends = extends_[identifier];
+    if (!graph.is_class(types_[identifier])) {
+      extends.intervals_.clear();
+    }
+    extends.intervals_.shrink_to_fit();
+    extends.hierarchies_ = this;
   }
 
   if (options.dump_class_hierarchies()) {
@@ -97,13 +292,13 @@ ClassHierarchies::ClassHierarchies(
   }
 }
 
-const std::unordered_set<const DexType*>& ClassHierarchies::extends(
+const ClassHierarchies::TypeSet& ClassHierarchies::extends(
     const DexType* klass) const {
   mt_assert(klass != type::java_lang_Object());
 
-  const auto* extends = extends_.get(klass, /* default */ nullptr);
-  if (extends != nullptr) {
-    return *extends;
+  auto found = identifiers_.find(klass);
+  if (found != identifiers_.end()) {
+    return extends_[found->second];
   } else {
     return empty_type_set_;
   }
@@ -111,12 +306,17 @@ const std::unordered_set<const DexType*>& ClassHierarchies::extends(
 
 Json::Value ClassHierarchies::to_json() const {
   auto extends_value = Json::Value(Json::objectValue);
-  for (auto [klass, extends] : extends_) {
+  for (std::uint32_t identifier = 0; identifier < types_.size();
+       identifier++) {
+    const auto& extends = extends_[identifier];
+    if (extends.empty()) {
+      continue;
+    }
     auto ClassHierarchies_value = Json::Value(Json::arrayValue);
-    for (const auto* extend : *extends) {
+    for (const auto* extend : extends) {
       ClassHierarchies_value.append(Json::Value(show(extend)));
     }
-    extends_value[show(klass)] = ClassHierarchies_value;
+    extends_value[show(types_[identifier])] = ClassHierarchies_value;
   }
   auto value = Json::Value(Json::objectValue);
   value["extends"] = extends_value;
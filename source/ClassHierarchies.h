@@ -7,18 +7,131 @@
 
 #pragma once
 
-#include <unordered_set>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <unordered_map>
+#include <vector>
 
 #include <json/json.h>
 
 #include <DexStore.h>
 
 #include <mariana-trench/Options.h>
-#include <mariana-trench/UniquePointerConcurrentMap.h>
 
 namespace marianatrench {
 
 class ClassHierarchies final {
+ public:
+  /**
+   * Set of classes that extend a given class.
+   *
+   * Classes are numbered in the pre-order of a depth-first traversal of the
+   * superclass tree, hence the subclasses of a class have contiguous
+   * identifiers. A set is stored as a sorted list of disjoint intervals of
+   * identifiers instead of being materialized: a single interval for a
+   * class, and about one interval per implementor for an interface.
+   */
+  class TypeSet final {
+   private:
+    struct Interval {
+      // Half-open interval of identifiers.
+      std::uint32_t begin;
+      std::uint32_t end;
+    };
+
+   public:
+    class Iterator final {
+     public:
+      using iterator_category = std::forward_iterator_tag;
+      using value_type = const DexType*;
+      using difference_type = std::ptrdiff_t;
+      using pointer = const DexType* const*;
+      using reference = const DexType* const&;
+
+      Iterator() = default;
+
+      reference operator*() const {
+        return set_->hierarchies_->types_[identifier_];
+      }
+
+      Iterator& operator++() {
+        identifier_++;
+        if (identifier_ == set_->intervals_[interval_].end) {
+          interval_++;
+          identifier_ = interval_ < set_->intervals_.size()
+              ? set_->intervals_[interval_].begin
+              : 0;
+        }
+        return *this;
+      }
+
+      Iterator operator++(int) {
+        auto result = *this;
+        ++(*this);
+        return result;
+      }
+
+      bool operator==(const Iterator& other) const {
+        return interval_ == other.interval_ &&
+            identifier_ == other.identifier_;
+      }
+
+      bool operator!=(const Iterator& other) const {
+        return !(*this == other);
+      }
+
+     private:
+      Iterator(const TypeSet* set, std::size_t interval)
+          : set_(set),
+            interval_(interval),
+            identifier_(
+                interval < set->intervals_.size()
+                    ? set->intervals_[interval].begin
+                    : 0) {}
+
+      friend class TypeSet;
+
+     private:
+      const TypeSet* set_ = nullptr;
+      std::size_t interval_ = 0;
+      std::uint32_t identifier_ = 0;
+    };
+
+    using value_type = const DexType*;
+    using iterator = Iterator;
+    using const_iterator = Iterator;
+
+    TypeSet() = default;
+    TypeSet(const TypeSet&) = default;
+    TypeSet(TypeSet&&) = default;
+    TypeSet& operator=(const TypeSet&) = default;
+    TypeSet& operator=(TypeSet&&) = default;
+    ~TypeSet() = default;
+
+    bool contains(const DexType* type) const;
+
+    bool empty() const {
+      return intervals_.empty();
+    }
+
+    std::size_t size() const;
+
+    Iterator begin() const {
+      return Iterator(this, 0);
+    }
+
+    Iterator end() const {
+      return Iterator(this, intervals_.size());
+    }
+
+   private:
+    friend class ClassHierarchies;
+
+    const ClassHierarchies* hierarchies_ = nullptr;
+    std::vector<Interval> intervals_;
+  };
+
  public:
   explicit ClassHierarchies(
       const Options& options,
@@ -31,14 +144,17 @@ class ClassHierarchies final {
   ~ClassHierarchies() = default;
 
   /* Return the set of classes that extend the given class. */
-  const std::unordered_set<const DexType*>& extends(const DexType* klass) const;
+  const TypeSet& extends(const DexType* klass) const;
 
   Json::Value to_json() const;
 
  private:
-  UniquePointerConcurrentMap<const DexType*, std::unordered_set<const DexType*>>
-      extends_;
-  std::unordered_set<const DexType*> empty_type_set_;
+  // Types of the class hierarchy graph, by identifier.
+  std::vector<const DexType*> types_;
+  std::unordered_map<const DexType*, std::uint32_t> identifiers_;
+  // Classes extending each type, by identifier.
+  std::vector<TypeSet> extends_;
+  TypeSet empty_type_set_;
 };
 
 } // namespace marianatrench
@@ -7,6 +7,9 @@
 
 #include <exception>
 #include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
 
 #include <InstructionAnalyzer.h>
 #include <RedexResources.h>
@@ -155,7 +158,21 @@ ClassProperties::ClassProperties(
     const Options& options,
     const DexStoresVector& stores,
     const Features& features)
-    : features_(features) {
+    : property_features_({
+          {Property::Exported, features.get("via-caller-exported")},
+          {Property::ChildExposed, features.get("via-child-exposed")},
+          {Property::Unexported, features.get("via-caller-unexported")},
+          {Property::DfaPublic, features.get("via-public-dfa-scheme")},
+          {Property::Permission, features.get("via-caller-permission")},
+          {Property::ProtectionLevel,
+           features.get("via-caller-protection-level")},
+      }),
+      features_(features) {
+  std::unordered_set<std::string> exported_classes;
+  std::unordered_set<std::string> unexported_classes;
+  std::unordered_set<std::string> parent_exposed_classes;
+  std::unordered_set<std::string> permission_classes;
+  std::unordered_set<std::string> protection_level_classes;
   try {
     auto android_resources = create_resource_reader(options.apk_directory());
     const auto manifest_class_info =
@@ -169,29 +186,29 @@ ClassProperties::ClassProperties(
 
       if (!tag_info.protection_level.empty() &&
           tag_info.protection_level != "normal") {
-        protection_level_classes_.emplace(tag_info.classname);
+        protection_level_classes.emplace(tag_info.classname);
         protection_level = true;
       }
       if (!tag_info.permission.empty()) {
-        permission_classes_.emplace(tag_info.classname);
+        permission_classes.emplace(tag_info.classname);
         permission = true;
       }
       if (tag_info.is_exported == BooleanXMLAttribute::True ||
           (tag_info.is_exported == BooleanXMLAttribute::Undefined &&
            tag_info.has_intent_filters)) {
-        exported_classes_.emplace(tag_info.classname);
+        exported_classes.emplace(tag_info.classname);
         if (!protection_level && !permission && dex_class) {
           if (tag_info.tag == ComponentTag::Activity) {
             const auto& exported_fragments = get_class_fragments(dex_class);
-            exported_classes_.insert(
+            exported_classes.insert(
                 exported_fragments.begin(), exported_fragments.end());
           }
           parent_classes = generator::get_custom_parents_from_class(dex_class);
-          parent_exposed_classes_.insert(
+          parent_exposed_classes.insert(
               parent_classes.begin(), parent_classes.end());
         }
       } else {
-        unexported_classes_.emplace(tag_info.classname);
+        unexported_classes.emplace(tag_info.classname);
       }
     }
   } catch (const std::exception& e) {
@@ -200,131 +217,128 @@ ClassProperties::ClassProperties(
   }
 
   std::mutex mutex;
+  std::unordered_set<std::string> dfa_public_scheme_classes;
+  std::unordered_map<const DexType*, const Feature*> class_privacy_decisions;
+  auto privacy_decision_feature = [&](const std::string& number) {
+    return features.get("pd-" + number);
+  };
   for (auto& scope : DexStoreClassesIterator(stores)) {
     walk::parallel::classes(scope, [&](DexClass* clazz) {
       if (is_class_exported_via_uri(clazz)) {
         std::lock_guard<std::mutex> lock(mutex);
-        dfa_public_scheme_classes_.emplace(clazz->str());
+        dfa_public_scheme_classes.emplace(clazz->str());
       }
 
-      std::optional<std::string> privacy_decision_number =
-          get_privacy_decision_number_from_class(clazz);
-      if (privacy_decision_number) {
+      if (auto privacy_decision_number =
+              get_privacy_decision_number_from_class(clazz)) {
+        const auto* feature =
+            privacy_decision_feature(*privacy_decision_number);
         std::lock_guard<std::mutex> lock(mutex);
-        privacy_decision_classes_.emplace(
-            clazz->str(), *privacy_decision_number);
+        class_privacy_decisions.emplace(clazz->get_type(), feature);
+      }
+
+      for (const auto* method : clazz->get_all_methods()) {
+        if (!method->get_anno_set()) {
+          continue;
+        }
+        if (auto privacy_decision_number =
+                get_privacy_decision_number_from_annotations(
+                    method->get_anno_set()->get_annotations())) {
+          const auto* feature =
+              privacy_decision_feature(*privacy_decision_number);
+          std::lock_guard<std::mutex> lock(mutex);
+          method_privacy_decisions_.emplace(method, feature);
+        }
       }
     });
   }
-}
-
-bool ClassProperties::is_class_exported(const std::string& class_name) const {
-  auto outer_class = strip_inner_class(class_name);
-  return exported_classes_.count(class_name) > 0 ||
-      exported_classes_.count(outer_class) > 0;
-}
-
-bool ClassProperties::is_child_exposed(const std::string& class_name) const {
-  auto outer_class = strip_inner_class(class_name);
-  return parent_exposed_classes_.count(class_name) > 0 ||
-      parent_exposed_classes_.count(outer_class) > 0;
-}
-
-bool ClassProperties::is_class_unexported(const std::string& class_name) const {
-  auto outer_class = strip_inner_class(class_name);
-  return unexported_classes_.count(class_name) > 0 ||
-      unexported_classes_.count(outer_class) > 0;
-}
 
-bool ClassProperties::is_dfa_public(const std::string& class_name) const {
-  auto outer_class = strip_inner_class(class_name);
-  return dfa_public_scheme_classes_.count(class_name) > 0 ||
-      dfa_public_scheme_classes_.count(outer_class) > 0;
-}
-
-bool ClassProperties::has_protection_level(
-    const std::string& class_name) const {
-  auto outer_class = strip_inner_class(class_name);
-  return protection_level_classes_.count(class_name) > 0 ||
-      protection_level_classes_.count(outer_class) > 0;
-}
+  // Compute the properties of each class of the stores, once.
+  for (auto& scope : DexStoreClassesIterator(stores)) {
+    walk::parallel::classes(scope, [&](DexClass* clazz) {
+      const auto& class_name = clazz->str();
+      auto outer_class = strip_inner_class(class_name);
+      auto contains = [&](const std::unordered_set<std::string>& classes) {
+        return classes.count(class_name) > 0 || classes.count(outer_class) > 0;
+      };
+
+      Properties properties;
+      if (contains(exported_classes)) {
+        properties |= Property::Exported;
+      }
+      if (contains(unexported_classes)) {
+        properties |= Property::Unexported;
+      }
+      if (contains(parent_exposed_classes)) {
+        properties |= Property::ChildExposed;
+      }
+      if (contains(dfa_public_scheme_classes)) {
+        properties |= Property::DfaPublic;
+      }
+      if (contains(permission_classes)) {
+        properties |= Property::Permission;
+      }
+      if (contains(protection_level_classes)) {
+        properties |= Property::ProtectionLevel;
+      }
 
-bool ClassProperties::has_permission(const std::string& class_name) const {
-  auto outer_class = strip_inner_class(class_name);
-  return permission_classes_.count(class_name) > 0 ||
-      permission_classes_.count(outer_class) > 0;
-  ;
-}
+      const Feature* privacy_decision = nullptr;
+      if (auto found = class_privacy_decisions.find(clazz->get_type());
+          found != class_privacy_decisions.end()) {
+        privacy_decision = found->second;
+      }
 
-std::optional<std::string>
-ClassProperties::get_privacy_decision_number_from_class_name(
-    const std::string& class_name) const {
-  auto it = privacy_decision_classes_.find(class_name);
-  if (it != privacy_decision_classes_.end()) {
-    return it->second;
-  } else {
-    return std::nullopt;
+      if (!properties.empty() || privacy_decision != nullptr) {
+        std::lock_guard<std::mutex> lock(mutex);
+        classes_.emplace(
+            clazz->get_type(), ClassInfo{properties, privacy_decision});
+      }
+    });
   }
 }
 
-std::optional<std::string>
-ClassProperties::get_privacy_decision_number_from_method(
-    const Method* method) const {
-  std::optional<std::string> privacy_decision_number = std::nullopt;
-  // add the annotation from the enclosing method by default
-  if (method->dex_method()->get_anno_set()) {
-    privacy_decision_number = get_privacy_decision_number_from_annotations(
-        method->dex_method()->get_anno_set()->get_annotations());
-  }
+ClassProperties::Properties ClassProperties::properties(
+    const DexType* type) const {
+  auto found = classes_.find(type);
+  return found != classes_.end() ? found->second.properties : Properties{};
+}
 
-  if (!privacy_decision_number) {
-    privacy_decision_number =
-        get_privacy_decision_number_from_class_name(method->get_class()->str());
+const Feature* MT_NULLABLE
+ClassProperties::privacy_decision_feature(const Method* method) const {
+  // The annotation of the enclosing method takes precedence.
+  if (!method_privacy_decisions_.empty()) {
+    auto found = method_privacy_decisions_.find(method->dex_method());
+    if (found != method_privacy_decisions_.end()) {
+      return found->second;
+    }
   }
 
-  return privacy_decision_number;
+  auto found = classes_.find(method->get_class());
+  return found != classes_.end() ? found->second.privacy_decision : nullptr;
 }
 
 FeatureMayAlwaysSet ClassProperties::propagate_features(
     const Method* caller,
     const Method* /*callee*/,
-    const Features& feature_factory) const {
+    const Features& /*features*/) const {
   FeatureSet features;
-
-  std::optional<std::string> privacy_decision_number =
-      get_privacy_decision_number_from_method(caller);
-
-  if (privacy_decision_number) {
-    features.add(feature_factory.get("pd-" + *privacy_decision_number));
+  if (const auto* feature = privacy_decision_feature(caller)) {
+    features.add(feature);
   }
-
   return FeatureMayAlwaysSet::make_always(features);
 }
 
 FeatureMayAlwaysSet ClassProperties::issue_features(
     const Method* method) const {
   FeatureSet features;
-  auto clazz = method->get_class()->str();
-
-  if (is_class_exported(clazz)) {
-    features.add(features_.get("via-caller-exported"));
-  }
-  if (is_child_exposed(clazz)) {
-    features.add(features_.get("via-child-exposed"));
-  }
-  if (is_class_unexported(clazz)) {
-    features.add(features_.get("via-caller-unexported"));
-  }
-  if (is_dfa_public(clazz)) {
-    features.add(features_.get("via-public-dfa-scheme"));
-  }
-  if (has_permission(clazz)) {
-    features.add(features_.get("via-caller-permission"));
-  }
-  if (has_protection_level(clazz)) {
-    features.add(features_.get("via-caller-protection-level"));
+  auto class_properties = properties(method->get_class());
+  if (!class_properties.empty()) {
+    for (const auto& [property, feature] : property_features_) {
+      if (class_properties.test(property)) {
+        features.add(feature);
+      }
+    }
   }
-
   return FeatureMayAlwaysSet::make_always(features);
 }
 
@@ -7,16 +7,44 @@
 
 #pragma once
 
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
 #include <DexStore.h>
 
+#include <mariana-trench/Compiler.h>
 #include <mariana-trench/Feature.h>
 #include <mariana-trench/FeatureMayAlwaysSet.h>
+#include <mariana-trench/Flags.h>
 #include <mariana-trench/Method.h>
 #include <mariana-trench/Options.h>
 
 namespace marianatrench {
 
+/**
+ * Properties of classes from the manifest and annotations.
+ *
+ * They are computed once per class of the stores, since they are queried
+ * for each call site and each issue. Inner classes have the properties of
+ * their outer class.
+ */
 class ClassProperties final {
+ public:
+  enum class Property : std::uint8_t {
+    Exported = 0x1,
+    Unexported = 0x2,
+    ChildExposed = 0x4,
+    DfaPublic = 0x8,
+    Permission = 0x10,
+    ProtectionLevel = 0x20,
+  };
+
+  using Properties = Flags<Property>;
+
  public:
   explicit ClassProperties(
       const Options& options,
@@ -28,19 +56,9 @@ class ClassProperties final {
   ClassProperties& operator=(ClassProperties&&) = delete;
   ~ClassProperties() = default;
 
- private:
-  bool is_class_unexported(const std::string& class_name) const;
-  bool is_class_exported(const std::string& class_name) const;
-  bool is_child_exposed(const std::string& class_name) const;
-  bool is_dfa_public(const std::string& class_name) const;
-  bool has_protection_level(const std::string& class_name) const;
-  bool has_permission(const std::string& class_name) const;
-  std::optional<std::string> get_privacy_decision_number_from_class_name(
-      const std::string& class_name) const;
-  std::optional<std::string> get_privacy_decision_number_from_method(
-      const Method* method) const;
+  /* Properties of the given class, empty for classes outside the stores. */
+  Properties properties(const DexType* type) const;
 
- public:
   /* A set of features to add to sources propagated from callee to caller. */
   FeatureMayAlwaysSet propagate_features(
       const Method* caller,
@@ -51,13 +69,28 @@ class ClassProperties final {
   FeatureMayAlwaysSet issue_features(const Method* method) const;
 
  private:
-  std::unordered_set<std::string> exported_classes_;
-  std::unordered_set<std::string> unexported_classes_;
-  std::unordered_set<std::string> parent_exposed_classes_;
-  std::unordered_set<std::string> dfa_public_scheme_classes_;
-  std::unordered_set<std::string> permission_classes_;
-  std::unordered_set<std::string> protection_level_classes_;
-  std::unordered_map<std::string, std::string> privacy_decision_classes_;
+  /**
+   * The `pd-<number>` feature of the privacy decision annotation of the
+   * method, or of its class otherwise.
+   */
+  const Feature* MT_NULLABLE privacy_decision_feature(
+      const Method* method) const;
+
+ private:
+  struct ClassInfo {
+    Properties properties;
+    const Feature* MT_NULLABLE privacy_decision;
+  };
+
+  // Only classes with properties or a privacy decision are stored.
+  std::unordered_map<const DexType*, ClassInfo> classes_;
+
+  // Methods with a privacy decision annotation.
+  std::unordered_map<const DexMethod*, const Feature*>
+      method_privacy_decisions_;
+
+  // Issue feature of each property, in the order of the bits.
+  std::vector<std::pair<Property, const Feature*>> property_features_;
 
   const Features& features_;
 };
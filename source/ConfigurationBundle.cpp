@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <ctime>
+#include <fstream>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+#include <boost/filesystem/operations.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+#include <fmt/format.h>
+
+#include <mariana-trench/BinaryJson.h>
+#include <mariana-trench/ConfigurationBundle.h>
+#include <mariana-trench/JsonFileCache.h>
+#include <mariana-trench/JsonValidation.h>
+#include <mariana-trench/Log.h>
+#include <mariana-trench/Timer.h>
+
+namespace marianatrench {
+
+namespace {
+
+Json::Value file_value(const boost::filesystem::path& path) {
+  auto value = Json::Value(Json::objectValue);
+  value["path"] = path.native();
+  value["last_write_time"] = Json::Int64(
+      static_cast<std::int64_t>(boost::filesystem::last_write_time(path)));
+  value["value"] = JsonValidation::parse_json_file(path);
+  return value;
+}
+
+} // namespace
+
+void ConfigurationBundle::write(
+    const Options& options,
+    const boost::filesystem::path& path) {
+  Timer timer;
+  BinaryJsonWriter writer;
+  auto header = Json::Value(Json::objectValue);
+  header["version"] = Json::UInt64(kVersion);
+  writer.add(header);
+
+  std::size_t files = 0;
+  for (const auto& directory : options.model_generator_search_paths()) {
+    auto paths = JsonFileCache::find_json_files(directory);
+    auto directory_value = Json::Value(Json::objectValue);
+    directory_value["directory"] = directory;
+    directory_value["files"] = Json::Value(Json::arrayValue);
+    for (const auto& generator_path : paths) {
+      directory_value["files"].append(generator_path.native());
+    }
+    writer.add(directory_value);
+
+    for (const auto& generator_path : paths) {
+      try {
+        writer.add(file_value(generator_path));
+        files++;
+      } catch (const JsonValidationError&) {
+        // Invalid generators are skipped when generating models.
+        LOG(3, "Unable to parse generator at `{}`", generator_path.native());
+      }
+    }
+  }
+
+  std::vector<std::string> paths = options.rules_paths();
+  paths.insert(
+      paths.end(),
+      options.lifecycles_paths().begin(),
+      options.lifecycles_paths().end());
+  for (const auto& [_, pack_paths] : options.rule_packs()) {
+    paths.insert(paths.end(), pack_paths.begin(), pack_paths.end());
+  }
+  if (const auto& heuristics_path = options.heuristics_path()) {
+    paths.push_back(*heuristics_path);
+  }
+  for (const auto& configuration_path : paths) {
+    writer.add(file_value(configuration_path));
+    files++;
+  }
+
+  std::ofstream stream(
+      path.native(), std::ios_base::out | std::ios_base::binary);
+  if (!stream.is_open()) {
+    throw std::runtime_error(fmt::format(
+        "Unable to write configuration bundle to `{}`.", path.native()));
+  }
+  writer.write(stream);
+
+  LOG(1,
+      "Wrote configuration bundle of {} files to `{}` in {:.2f}s.",
+      files,
+      path.native(),
+      timer.duration_in_seconds());
+}
+
+void ConfigurationBundle::load(const boost::filesystem::path& path) {
+  Timer timer;
+  boost::iostreams::mapped_file_source file(path);
+  BinaryJsonReader reader(std::string_view(file.data(), file.size()));
+
+  auto header = reader.next();
+  if (!header || !header->isObject() || !header->isMember("version")) {
+    throw std::runtime_error(
+        fmt::format("Invalid configuration bundle `{}`.", path.native()));
+  }
+  if ((*header)["version"].asUInt64() != kVersion) {
+    throw std::runtime_error(fmt::format(
+        "Configuration bundle `{}` has version {}, expected version {}.",
+        path.native(),
+        (*header)["version"].asUInt64(),
+        kVersion));
+  }
+
+  JsonFileCache::enable();
+  std::size_t files = 0;
+  while (auto value = reader.next()) {
+    if (value->isMember("directory")) {
+      std::vector<boost::filesystem::path> paths;
+      for (const auto& file_path : (*value)["files"]) {
+        paths.emplace_back(file_path.asString());
+      }
+      JsonFileCache::add_json_files(
+          (*value)["directory"].asString(), std::move(paths));
+    } else {
+      JsonFileCache::add_file(
+          (*value)["path"].asString(),
+          static_cast<std::time_t>((*value)["last_write_time"].asInt64()),
+          std::move((*value)["value"]));
+      files++;
+    }
+  }
+
+  LOG(1,
+      "Loaded {} configuration files from bundle `{}` in {:.2f}s.",
+      files,
+      path.native(),
+      timer.duration_in_seconds());
+}
+
+} // namespace marianatrench
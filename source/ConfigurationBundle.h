@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+#include <boost/filesystem/path.hpp>
+
+#include <mariana-trench/Options.h>
+
+namespace marianatrench {
+
+/**
+ * The parsed json configuration files of an analysis (see
+ * `--write-configuration-bundle` and `--configuration-bundle-path`): rules,
+ * lifecycles, heuristics and the model generators found in the model generator
+ * search paths.
+ *
+ * A bundle is written in the binary json format (see `BinaryJson`). The first
+ * value is a header with the `version` of the bundle format, followed by one
+ * value per search path with its `directory` and its `.json` `files`, and one
+ * value per file with its `path`, `last_write_time` and parsed `value`.
+ *
+ * Loading a bundle fills the `JsonFileCache`, hence files are not listed nor
+ * parsed again. Files that changed since the bundle was written are parsed
+ * again, but `.json` files added to a search path are not found. Models files
+ * are not bundled, they are streamed in parallel (see
+ * `JsonArrayFile`).
+ */
+class ConfigurationBundle final {
+ public:
+  /* Incremented when the content of the bundle changes. */
+  static constexpr std::uint64_t kVersion = 1;
+
+ public:
+  /**
+   * Parse the configuration files of the given options and write them to the
+   * given path. Throws `JsonValidationError` if a rules, lifecycles or
+   * heuristics file is not valid json.
+   */
+  static void write(
+      const Options& options,
+      const boost::filesystem::path& path);
+
+  /**
+   * Add the files of the bundle at the given path to the `JsonFileCache`.
+   * Throws `std::runtime_error` if the file is not a valid bundle.
+   */
+  static void load(const boost::filesystem::path& path);
+};
+
+} // namespace marianatrench
@@ -7,29 +7,47 @@
 
 #include <mariana-trench/ArtificialMethods.h>
 #include <mariana-trench/CallGraph.h>
+#include <mariana-trench/CallsiteModelCache.h>
 #include <mariana-trench/ClassHierarchies.h>
 #include <mariana-trench/ClassProperties.h>
 #include <mariana-trench/Context.h>
+#include <mariana-trench/ConvergenceReport.h>
 #include <mariana-trench/Dependencies.h>
+#include <mariana-trench/DuplicateMethods.h>
 #include <mariana-trench/Features.h>
 #include <mariana-trench/FieldCache.h>
 #include <mariana-trench/Fields.h>
+#include <mariana-trench/IssueStream.h>
+#include <mariana-trench/KindCosts.h>
 #include <mariana-trench/Kinds.h>
+#include <mariana-trench/MemoryBudget.h>
 #include <mariana-trench/Methods.h>
+#include <mariana-trench/NumaPlacement.h>
 #include <mariana-trench/Options.h>
 #include <mariana-trench/Overrides.h>
+#include <mariana-trench/Partitions.h>
+#include <mariana-trench/PerformanceCounters.h>
 #include <mariana-trench/Positions.h>
+#include <mariana-trench/Profiler.h>
+#include <mariana-trench/ReachableMethods.h>
 #include <mariana-trench/Rules.h>
+#include <mariana-trench/RuntimeHeuristics.h>
 #include <mariana-trench/Scheduler.h>
 #include <mariana-trench/Statistics.h>
+#include <mariana-trench/TrivialMethods.h>
 #include <mariana-trench/Types.h>
+#include <mariana-trench/WorkerPool.h>
+#include <mariana-trench/WorkerSampler.h>
+#include <mariana-trench/model-generator/ReturnsThisAnalyzer.h>
 
 namespace marianatrench {
 
 Context::Context()
     : kinds(std::make_unique<Kinds>()),
       features(std::make_unique<Features>()),
-      statistics(std::make_unique<Statistics>()) {}
+      statistics(std::make_unique<Statistics>()),
+      heuristics(std::make_unique<RuntimeHeuristics>()),
+      returns_this_cache(std::make_unique<ReturnsThisCache>()) {}
 
 Context::Context(Context&&) noexcept = default;
 
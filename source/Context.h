@@ -30,7 +30,23 @@ class Overrides;
 class CallGraph;
 class Rules;
 class Dependencies;
+class DuplicateMethods;
+class TrivialMethods;
 class Scheduler;
+class Profiler;
+class CallsiteModelCache;
+class MemoryBudget;
+class RuntimeHeuristics;
+class WorkerSampler;
+class ConvergenceReport;
+class KindCosts;
+class PerformanceCounters;
+class ReturnsThisCache;
+class ReachableMethods;
+class Partitions;
+class NumaPlacement;
+class IssueStream;
+class WorkerPool;
 
 /**
  * Mariana Trench global context.
@@ -47,6 +63,8 @@ class Context final {
   std::unique_ptr<Kinds> kinds;
   std::unique_ptr<Features> features;
   std::unique_ptr<Statistics> statistics;
+  std::unique_ptr<RuntimeHeuristics> heuristics;
+  std::unique_ptr<ReturnsThisCache> returns_this_cache;
   std::unique_ptr<Options> options;
   std::vector<DexStore> stores;
   std::unique_ptr<ArtificialMethods> artificial_methods;
@@ -59,9 +77,37 @@ class Context final {
   std::unique_ptr<FieldCache> field_cache;
   std::unique_ptr<Overrides> overrides;
   std::unique_ptr<CallGraph> call_graph;
+  // Only set when `--entry-point-reachability` is used.
+  std::unique_ptr<ReachableMethods> reachable_methods;
   std::unique_ptr<Rules> rules;
   std::unique_ptr<Dependencies> dependencies;
   std::unique_ptr<Scheduler> scheduler;
+  // Only set when `--deduplicate-methods` is used.
+  std::unique_ptr<DuplicateMethods> duplicate_methods;
+  // Only set when `--summarize-trivial-methods` is used.
+  std::unique_ptr<TrivialMethods> trivial_methods;
+  // Only set when `--numa-aware-scheduling` is used.
+  std::unique_ptr<NumaPlacement> numa_placement;
+  // Only set when `--partition-count` is used.
+  std::unique_ptr<Partitions> partitions;
+  // Only set when profiling the analysis.
+  std::unique_ptr<Profiler> profiler;
+  // Only set when `--callsite-model-cache-size` is used.
+  std::unique_ptr<CallsiteModelCache> callsite_model_cache;
+  // Only set when `--memory-budget-in-gb` is used.
+  std::unique_ptr<MemoryBudget> memory_budget;
+  // Only set when `--worker-timeline-interval-in-milliseconds` is used.
+  std::unique_ptr<WorkerSampler> worker_sampler;
+  // Only set when `--convergence-report` is used.
+  std::unique_ptr<ConvergenceReport> convergence_report;
+  // Only set when `--kind-costs` is used.
+  std::unique_ptr<KindCosts> kind_costs;
+  // Only set when `--performance-counters` is used. Counts all threads.
+  std::unique_ptr<PerformanceCounters> performance_counters;
+  // Not set when `--disable-issue-stream` is used.
+  std::unique_ptr<IssueStream> issue_stream;
+  // Not set in tests, where work queues start their own threads.
+  std::unique_ptr<WorkerPool> worker_pool;
 };
 
 } // namespace marianatrench
@@ -0,0 +1,181 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <algorithm>
+#include <iterator>
+
+#include <mariana-trench/Assert.h>
+#include <mariana-trench/ConvergenceReport.h>
+
+namespace marianatrench {
+
+namespace {
+
+template <typename Set>
+std::int64_t count(const Set& set) {
+  return static_cast<std::int64_t>(std::distance(set.begin(), set.end()));
+}
+
+void add_taint_sizes(
+    const TaintAccessPathTree& tree,
+    ConvergenceReport::Component ports,
+    ConvergenceReport::Component kinds,
+    ConvergenceReport::Sizes& sizes) {
+  using Component = ConvergenceReport::Component;
+  auto& features = sizes[static_cast<std::size_t>(Component::Features)];
+  auto& origins = sizes[static_cast<std::size_t>(Component::Origins)];
+
+  tree.visit([&](const AccessPath& /* port */, const Taint& taint) {
+    sizes[static_cast<std::size_t>(ports)]++;
+    for (const auto& frames : taint) {
+      sizes[static_cast<std::size_t>(kinds)]++;
+      for (const auto& frame : frames) {
+        features += count(frame.features().may());
+        const auto& frame_origins = frame.origins();
+        origins += frame_origins.is_top()
+            ? static_cast<std::int64_t>(frame_origins.truncated_size())
+            : count(frame_origins);
+      }
+    }
+  });
+}
+
+} // namespace
+
+ConvergenceReport::Sizes ConvergenceReport::sizes(const Model& model) {
+  Sizes sizes{};
+  add_taint_sizes(
+      model.generations(),
+      Component::GenerationPorts,
+      Component::GenerationKinds,
+      sizes);
+  add_taint_sizes(
+      model.parameter_sources(),
+      Component::ParameterSourcePorts,
+      Component::ParameterSourceKinds,
+      sizes);
+  add_taint_sizes(
+      model.sinks(), Component::SinkPorts, Component::SinkKinds, sizes);
+  model.propagations().visit(
+      [&](const AccessPath& /* output */, const PropagationSet& propagations) {
+        sizes[static_cast<std::size_t>(Component::Propagations)] +=
+            static_cast<std::int64_t>(propagations.size());
+      });
+  sizes[static_cast<std::size_t>(Component::Issues)] =
+      static_cast<std::int64_t>(model.issues().size());
+  return sizes;
+}
+
+const char* ConvergenceReport::component_name(Component component) {
+  switch (component) {
+    case Component::GenerationPorts:
+      return "generation_ports";
+    case Component::GenerationKinds:
+      return "generation_kinds";
+    case Component::ParameterSourcePorts:
+      return "parameter_source_ports";
+    case Component::ParameterSourceKinds:
+      return "parameter_source_kinds";
+    case Component::SinkPorts:
+      return "sink_ports";
+    case Component::SinkKinds:
+      return "sink_kinds";
+    case Component::Propagations:
+      return "propagations";
+    case Component::Features:
+      return "features";
+    case Component::Origins:
+      return "origins";
+    case Component::Issues:
+      return "issues";
+    case Component::Other:
+      return "other";
+  }
+  mt_unreachable();
+}
+
+void ConvergenceReport::set_iteration(std::size_t iteration) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  iteration_ = iteration;
+}
+
+void ConvergenceReport::record(
+    const Method* method,
+    const Model& previous,
+    const Model& model) {
+  auto previous_sizes = sizes(previous);
+  auto growth = sizes(model);
+  bool grew = false;
+  for (std::size_t index = 0; index < kComponents; index++) {
+    growth[index] -= previous_sizes[index];
+    grew |= growth[index] > 0;
+  }
+  if (!grew) {
+    growth[static_cast<std::size_t>(Component::Other)] = 1;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  iterations_[iteration_].push_back(Change{method, growth});
+}
+
+namespace {
+
+Json::Value sizes_to_json(const ConvergenceReport::Sizes& sizes) {
+  auto value = Json::Value(Json::objectValue);
+  for (std::size_t index = 0; index < ConvergenceReport::kComponents;
+       index++) {
+    if (sizes[index] != 0) {
+      value[ConvergenceReport::component_name(
+          static_cast<ConvergenceReport::Component>(index))] =
+          Json::Value(static_cast<Json::Int64>(sizes[index]));
+    }
+  }
+  return value;
+}
+
+} // namespace
+
+Json::Value ConvergenceReport::to_json() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  auto iterations_value = Json::Value(Json::arrayValue);
+  for (const auto& [iteration, changes] : iterations_) {
+    auto sorted_changes = changes;
+    std::sort(
+        sorted_changes.begin(),
+        sorted_changes.end(),
+        [](const Change& left, const Change& right) {
+          return left.method->show() < right.method->show();
+        });
+
+    Sizes total{};
+    auto methods_value = Json::Value(Json::arrayValue);
+    for (const auto& change : sorted_changes) {
+      for (std::size_t index = 0; index < kComponents; index++) {
+        total[index] += change.growth[index];
+      }
+      auto method_value = sizes_to_json(change.growth);
+      method_value["method"] = Json::Value(change.method->show());
+      methods_value.append(method_value);
+    }
+
+    auto iteration_value = Json::Value(Json::objectValue);
+    iteration_value["iteration"] =
+        Json::Value(static_cast<Json::UInt64>(iteration));
+    iteration_value["changed_methods"] =
+        Json::Value(static_cast<Json::UInt64>(changes.size()));
+    iteration_value["growth"] = sizes_to_json(total);
+    iteration_value["methods"] = methods_value;
+    iterations_value.append(iteration_value);
+  }
+
+  auto value = Json::Value(Json::objectValue);
+  value["iterations"] = iterations_value;
+  return value;
+}
+
+} // namespace marianatrench
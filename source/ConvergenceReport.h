@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <vector>
+
+#include <json/json.h>
+
+#include <mariana-trench/Method.h>
+#include <mariana-trench/Model.h>
+
+namespace marianatrench {
+
+/**
+ * Record which parts of the models keep changing during the global fixpoint,
+ * when `--convergence-report` is used.
+ *
+ * For each global iteration, this records the methods whose model changed and
+ * how much each component of the model grew, e.g the number of new generation
+ * kinds or sink ports. Components are measured by their size, hence a model
+ * that changed without growing any of them (e.g new positions or sanitizers)
+ * is reported as `other`. The worklist fixpoint has no global iterations,
+ * hence its changes are all reported in iteration 0.
+ */
+class ConvergenceReport final {
+ public:
+  enum class Component : std::uint8_t {
+    GenerationPorts,
+    GenerationKinds,
+    ParameterSourcePorts,
+    ParameterSourceKinds,
+    SinkPorts,
+    SinkKinds,
+    Propagations,
+    Features,
+    Origins,
+    Issues,
+    Other,
+  };
+
+  static constexpr std::size_t kComponents =
+      static_cast<std::size_t>(Component::Other) + 1;
+
+  using Sizes = std::array<std::int64_t, kComponents>;
+
+ public:
+  ConvergenceReport() = default;
+  ConvergenceReport(const ConvergenceReport&) = delete;
+  ConvergenceReport(ConvergenceReport&&) = delete;
+  ConvergenceReport& operator=(const ConvergenceReport&) = delete;
+  ConvergenceReport& operator=(ConvergenceReport&&) = delete;
+  ~ConvergenceReport() = default;
+
+  /* Return the size of each component of the given model. */
+  static Sizes sizes(const Model& model);
+
+  static const char* component_name(Component component);
+
+  /* Set the current global iteration. Thread-safe. */
+  void set_iteration(std::size_t iteration);
+
+  /* Record that the model of a method changed. Thread-safe. */
+  void record(const Method* method, const Model& previous, const Model& model);
+
+  Json::Value to_json() const;
+
+ private:
+  struct Change {
+    const Method* method;
+    // Difference between the sizes of the new and the previous model.
+    Sizes growth;
+  };
+
+ private:
+  mutable std::mutex mutex_;
+  std::size_t iteration_ = 0;
+  std::map<std::size_t, std::vector<Change>> iterations_;
+};
+
+} // namespace marianatrench
@@ -0,0 +1,184 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <unordered_map>
+
+#include <ControlFlow.h>
+#include <IRCode.h>
+
+#include <mariana-trench/CostEstimate.h>
+#include <mariana-trench/Dependencies.h>
+#include <mariana-trench/Methods.h>
+#include <mariana-trench/Options.h>
+#include <mariana-trench/Scheduler.h>
+
+namespace marianatrench {
+
+namespace {
+
+// Average number of analyses of a method that is not part of a recursive
+// component, since callers are analyzed again when their callees change.
+constexpr double kAnalysesPerMethod = 1.5;
+
+// Rough average sizes, in bytes, of the final model of a method without
+// taint, of a call edge (in the call graph, the dependencies and call site
+// caches), of a model with taint, and of the environment of an instruction
+// during the analysis of a method.
+constexpr double kBytesPerMethod = 2048.0;
+constexpr double kBytesPerCallEdge = 256.0;
+constexpr double kBytesPerModel = 8192.0;
+constexpr double kBytesPerInstruction = 512.0;
+
+constexpr double kBytesPerGigabyte = 1024.0 * 1024.0 * 1024.0;
+
+std::size_t size_bucket(std::size_t size) {
+  std::size_t bucket = 0;
+  while ((size >> (bucket + 1)) > 0 &&
+         bucket + 1 < CostEstimate::kComponentSizeBuckets) {
+    bucket++;
+  }
+  return bucket;
+}
+
+} // namespace
+
+CostEstimate::CostEstimate(
+    const Context& context,
+    const Registry& registry,
+    double resident_set_size_in_gb)
+    : jobs_(context.options->jobs(AnalysisPhase::Fixpoint)),
+      methods_(context.methods->size()),
+      models_(registry.models_size()),
+      profiled_methods_(context.scheduler->cost_profile_size()),
+      component_sizes_(kComponentSizeBuckets, 0),
+      resident_set_size_in_gb_(resident_set_size_in_gb) {
+  const auto& dependencies = *context.dependencies;
+  const auto& scheduler = *context.scheduler;
+
+  std::vector<std::size_t> method_instructions;
+  std::unordered_map<const Method*, std::size_t> fan_out;
+  for (const auto* method : *context.methods) {
+    const auto* code = method->get_code();
+    if (code != nullptr) {
+      methods_with_code_++;
+      if (code->cfg_built()) {
+        auto instructions = code->cfg().num_opcodes();
+        instructions_ += instructions;
+        method_instructions.push_back(instructions);
+      }
+    }
+
+    const auto& callers = dependencies.dependencies(method);
+    call_edges_ += callers.size();
+    maximum_fan_in_ = std::max(maximum_fan_in_, callers.size());
+    for (const auto* caller : callers) {
+      maximum_fan_out_ = std::max(maximum_fan_out_, ++fan_out[caller]);
+    }
+  }
+
+  // Components are in reverse topological order, hence a component starts
+  // at the latest end of the components it depends on.
+  const auto& strongly_connected_components =
+      scheduler.strongly_connected_components();
+  const auto& components = strongly_connected_components.components();
+  components_ = components.size();
+  std::vector<double> start(components.size(), 0.0);
+  for (std::size_t index = 0; index < components.size(); index++) {
+    const auto& component = components[index];
+    largest_component_ = std::max(largest_component_, component.size());
+    component_sizes_[size_bucket(component.size())]++;
+
+    auto analyses = kAnalysesPerMethod;
+    if (component.size() > 1) {
+      recursive_components_++;
+      analyses *= 1.0 + std::log2(static_cast<double>(component.size()));
+    }
+    double cost = 0.0;
+    for (const auto* method : component) {
+      cost += scheduler.estimated_cost(method) * analyses;
+    }
+    total_seconds_ += cost;
+
+    auto end = start[index] + cost;
+    critical_path_seconds_ = std::max(critical_path_seconds_, end);
+    for (auto dependent :
+         strongly_connected_components.dependent_components(index)) {
+      start[dependent] = std::max(start[dependent], end);
+    }
+  }
+  fixpoint_seconds_ = std::max(
+      total_seconds_ / static_cast<double>(std::max(jobs_, 1u)),
+      critical_path_seconds_);
+
+  // Each worker holds the environments of at most one method at a time.
+  auto workers = std::min<std::size_t>(jobs_, method_instructions.size());
+  std::partial_sort(
+      method_instructions.begin(),
+      method_instructions.begin() + workers,
+      method_instructions.end(),
+      std::greater<std::size_t>());
+  double environment_bytes = 0.0;
+  for (std::size_t worker = 0; worker < workers; worker++) {
+    environment_bytes +=
+        static_cast<double>(method_instructions[worker]) * kBytesPerInstruction;
+  }
+  auto bytes = static_cast<double>(methods_) * kBytesPerMethod +
+      static_cast<double>(call_edges_) * kBytesPerCallEdge +
+      static_cast<double>(models_) * kBytesPerModel + environment_bytes;
+  peak_resident_set_size_in_gb_ =
+      std::max(resident_set_size_in_gb_, 0.0) + bytes / kBytesPerGigabyte;
+}
+
+Json::Value CostEstimate::to_json() const {
+  auto value = Json::Value(Json::objectValue);
+  value["jobs"] = Json::Value(jobs_);
+  value["methods"] = Json::Value(static_cast<Json::UInt64>(methods_));
+  value["methods_with_code"] =
+      Json::Value(static_cast<Json::UInt64>(methods_with_code_));
+  value["instructions"] = Json::Value(static_cast<Json::UInt64>(instructions_));
+  value["models"] = Json::Value(static_cast<Json::UInt64>(models_));
+  value["profiled_methods"] =
+      Json::Value(static_cast<Json::UInt64>(profiled_methods_));
+
+  auto call_graph = Json::Value(Json::objectValue);
+  call_graph["edges"] = Json::Value(static_cast<Json::UInt64>(call_edges_));
+  call_graph["average_fan_out"] = Json::Value(
+      methods_ > 0
+          ? static_cast<double>(call_edges_) / static_cast<double>(methods_)
+          : 0.0);
+  call_graph["maximum_fan_out"] =
+      Json::Value(static_cast<Json::UInt64>(maximum_fan_out_));
+  call_graph["maximum_fan_in"] =
+      Json::Value(static_cast<Json::UInt64>(maximum_fan_in_));
+  value["call_graph"] = call_graph;
+
+  auto components = Json::Value(Json::objectValue);
+  components["count"] = Json::Value(static_cast<Json::UInt64>(components_));
+  components["recursive"] =
+      Json::Value(static_cast<Json::UInt64>(recursive_components_));
+  components["largest"] =
+      Json::Value(static_cast<Json::UInt64>(largest_component_));
+  auto sizes = Json::Value(Json::arrayValue);
+  for (auto count : component_sizes_) {
+    sizes.append(Json::Value(static_cast<Json::UInt64>(count)));
+  }
+  components["size_histogram"] = sizes;
+  value["components"] = components;
+
+  value["total_seconds"] = Json::Value(total_seconds_);
+  value["critical_path_seconds"] = Json::Value(critical_path_seconds_);
+  value["fixpoint_seconds"] = Json::Value(fixpoint_seconds_);
+  value["resident_set_size_in_gb"] = Json::Value(resident_set_size_in_gb_);
+  value["peak_resident_set_size_in_gb"] =
+      Json::Value(peak_resident_set_size_in_gb_);
+  return value;
+}
+
+} // namespace marianatrench
@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include <json/json.h>
+
+#include <mariana-trench/Context.h>
+#include <mariana-trench/Registry.h>
+
+namespace marianatrench {
+
+/**
+ * Prediction of the duration and memory of the global fixpoint, written by
+ * `--estimate-only` before the fixpoint would start, to pick a machine size.
+ *
+ * The duration of each component is the estimated cost of its methods (see
+ * `Scheduler::estimated_cost`, which uses the cost profile of a past run when
+ * given), times the expected number of analyses of a method, which grows
+ * with the size of recursive components. The fixpoint takes at least the
+ * total cost divided among the workers, and at least the most expensive
+ * chain of dependent components.
+ *
+ * Memory is the current resident set size plus a cost per method, call edge
+ * and model, and the environments of the largest methods analyzed at the same
+ * time. These costs are rough averages: the predictions are meant to
+ * rank runs and spot outliers, and should be checked against the statistics
+ * of the metadata of finished runs.
+ */
+class CostEstimate final {
+ public:
+  /* Requires the dependencies and the scheduler of the context. */
+  CostEstimate(
+      const Context& context,
+      const Registry& registry,
+      double resident_set_size_in_gb);
+
+  CostEstimate(const CostEstimate&) = default;
+  CostEstimate(CostEstimate&&) = default;
+  CostEstimate& operator=(const CostEstimate&) = default;
+  CostEstimate& operator=(CostEstimate&&) = default;
+  ~CostEstimate() = default;
+
+  double fixpoint_seconds() const {
+    return fixpoint_seconds_;
+  }
+
+  double peak_resident_set_size_in_gb() const {
+    return peak_resident_set_size_in_gb_;
+  }
+
+  Json::Value to_json() const;
+
+  /**
+   * Number of buckets of the histogram of component sizes. Bucket `i` holds
+   * components of size in [2^i, 2^(i+1)), the last bucket is unbounded.
+   */
+  constexpr static std::size_t kComponentSizeBuckets = 16;
+
+ private:
+  unsigned int jobs_ = 1;
+  std::size_t methods_ = 0;
+  std::size_t methods_with_code_ = 0;
+  std::size_t instructions_ = 0;
+  std::size_t models_ = 0;
+  std::size_t profiled_methods_ = 0;
+
+  std::size_t call_edges_ = 0;
+  std::size_t maximum_fan_out_ = 0;
+  std::size_t maximum_fan_in_ = 0;
+
+  std::size_t components_ = 0;
+  std::size_t recursive_components_ = 0;
+  std::size_t largest_component_ = 0;
+  std::vector<std::size_t> component_sizes_;
+
+  double total_seconds_ = 0.0;
+  double critical_path_seconds_ = 0.0;
+  double fixpoint_seconds_ = 0.0;
+  double resident_set_size_in_gb_ = 0.0;
+  double peak_resident_set_size_in_gb_ = 0.0;
+};
+
+} // namespace marianatrench
@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <IRCode.h>
+#include <IROpcode.h>
+
+#include <mariana-trench/DecodedInstructions.h>
+
+namespace marianatrench {
+
+namespace {
+
+const DecodedInstructions::Instruction k_empty_instruction;
+const std::vector<DecodedInstructions::Entry> k_empty_block;
+const ArtificialCallees k_empty_artificial_callees;
+
+} // namespace
+
+DecodedInstructions::DecodedInstructions(
+    const Method* MT_NULLABLE method,
+    const CallGraph& call_graph,
+    const Types& types) {
+  const auto* code = method != nullptr ? method->get_code() : nullptr;
+  if (code == nullptr || !code->cfg_built()) {
+    return;
+  }
+
+  const auto& artificial_callees = call_graph.artificial_callees(method);
+  for (auto* block : code->cfg().blocks()) {
+    auto& entries = blocks_[block];
+    for (auto& entry : *block) {
+      if (entry.type == MFLOW_POSITION) {
+        entries.push_back(Entry{nullptr, entry.pos.get()});
+        continue;
+      } else if (entry.type != MFLOW_OPCODE) {
+        continue;
+      }
+
+      const auto* instruction = entry.insn;
+      entries.push_back(Entry{instruction, nullptr});
+
+      Instruction decoded;
+      bool has_facts = false;
+      if (opcode::is_an_invoke(instruction->opcode())) {
+        if (method_types_ == nullptr) {
+          method_types_ = types.method_types(method);
+        }
+        decoded.call_target = call_graph.callee(method, instruction);
+        decoded.source_register_types =
+            &method_types_->source_types(instruction);
+        has_facts = true;
+      }
+      if (instruction->has_field()) {
+        decoded.field = call_graph.resolved_field_access(method, instruction);
+        has_facts = true;
+      }
+      if (const auto* callees = artificial_callees.find(instruction)) {
+        decoded.artificial_callees = callees;
+        has_facts = true;
+      }
+      if (has_facts) {
+        instructions_.emplace(instruction, std::move(decoded));
+      }
+    }
+  }
+}
+
+const DecodedInstructions::Instruction& DecodedInstructions::get(
+    const IRInstruction* instruction) const {
+  auto found = instructions_.find(instruction);
+  return found != instructions_.end() ? found->second : k_empty_instruction;
+}
+
+const std::vector<DecodedInstructions::Entry>& DecodedInstructions::block(
+    const cfg::Block* block) const {
+  auto found = blocks_.find(block);
+  return found != blocks_.end() ? found->second : k_empty_block;
+}
+
+const ArtificialCallees& DecodedInstructions::artificial_callees(
+    const IRInstruction* instruction) const {
+  const auto* callees = get(instruction).artificial_callees;
+  return callees != nullptr ? *callees : k_empty_artificial_callees;
+}
+
+} // namespace marianatrench
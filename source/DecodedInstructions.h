@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+#include <ControlFlow.h>
+#include <DexPosition.h>
+#include <IRInstruction.h>
+
+#include <mariana-trench/CallGraph.h>
+#include <mariana-trench/Compiler.h>
+#include <mariana-trench/Field.h>
+#include <mariana-trench/Method.h>
+#include <mariana-trench/Types.h>
+
+namespace marianatrench {
+
+/**
+ * Instructions of a method along with the facts the transfer functions need
+ * that do not depend on the abstract state, i.e resolved callees, resolved
+ * fields, artificial callees and source register types.
+ *
+ * These are decoded once per analysis of the method, before running the
+ * fixpoint, instead of looking them up in the call graph and the types at
+ * each visit of a block. Blocks are stored as arrays of instructions and
+ * positions, without the other entries of the control flow graph.
+ */
+class DecodedInstructions final {
+ public:
+  struct Instruction {
+    // Resolved call target of an invoke.
+    std::optional<CallTarget> call_target;
+    // Types of the sources of an invoke, owned by `method_types_`.
+    const MethodTypes::SourceTypes* MT_NULLABLE source_register_types =
+        nullptr;
+    // Resolved field of a field access.
+    const Field* MT_NULLABLE field = nullptr;
+    // Artificial callees of the instruction, owned by the call graph.
+    const ArtificialCallees* MT_NULLABLE artificial_callees = nullptr;
+  };
+
+  /* An instruction or a position of a block. */
+  struct Entry {
+    const IRInstruction* MT_NULLABLE instruction;
+    DexPosition* MT_NULLABLE position;
+  };
+
+ public:
+  /* Decode the control flow graph of the method, if it has one. */
+  DecodedInstructions(
+      const Method* MT_NULLABLE method,
+      const CallGraph& call_graph,
+      const Types& types);
+
+  DecodedInstructions(const DecodedInstructions&) = delete;
+  DecodedInstructions(DecodedInstructions&&) = delete;
+  DecodedInstructions& operator=(const DecodedInstructions&) = delete;
+  DecodedInstructions& operator=(DecodedInstructions&&) = delete;
+  ~DecodedInstructions() = default;
+
+  /**
+   * Return the decoded facts of the given instruction. Instructions without
+   * any fact (e.g moves) share an empty record.
+   */
+  const Instruction& get(const IRInstruction* instruction) const;
+
+  /* Return the instructions and positions of the given block, in order. */
+  const std::vector<Entry>& block(const cfg::Block* block) const;
+
+  /* Return the artificial callees of the given instruction. */
+  const ArtificialCallees& artificial_callees(
+      const IRInstruction* instruction) const;
+
+ private:
+  std::shared_ptr<const MethodTypes> method_types_;
+  std::unordered_map<const IRInstruction*, Instruction> instructions_;
+  std::unordered_map<const cfg::Block*, std::vector<Entry>> blocks_;
+};
+
+} // namespace marianatrench
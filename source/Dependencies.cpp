@@ -5,6 +5,10 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <algorithm>
+#include <utility>
+#include <vector>
+
 #include <fmt/format.h>
 
 #include <IRInstruction.h>
@@ -25,46 +29,67 @@ Dependencies::Dependencies(
     const Methods& methods,
     const Overrides& overrides,
     const CallGraph& call_graph,
-    const Registry& registry) {
+    const Registry& registry,
+    const ReachableMethods* MT_NULLABLE reachable_methods)
+    : methods_(methods) {
   ConcurrentSet<const Method*> warn_many_overrides;
 
+  // Edges (callee, caller) found by each worker thread.
+  using Edge = std::pair<const Method*, const Method*>;
+  auto threads = options.jobs(AnalysisPhase::Dependencies);
+  std::vector<std::vector<Edge>> partial_edges(threads);
+
+  // Read the modes of all models once. Looking up models for each call would
+  // contend on the reference counts of the snapshots of popular callees.
+  std::vector<Model::Modes> modes(methods.size());
+  {
+    auto modes_queue = sparta::work_queue<const Method*>(
+        [&](const Method* method) {
+          modes[method->id()] = registry.get_snapshot(method)->modes();
+        },
+        threads);
+    for (const auto* method : methods) {
+      modes_queue.add_item(method);
+    }
+    modes_queue.run_all();
+  }
+
   auto queue = sparta::work_queue<const Method*>(
-      [&](const Method* caller) {
-        auto add_caller_as_dependency =
-            [&](const Method* /* method */,
-                std::unordered_set<const Method*>& dependencies,
-                bool /* is_new */) {
-              auto* code = caller->get_code();
-              if (!code) {
-                return;
-              }
-
-              auto model = registry.get(caller);
-              if (model.skip_analysis()) {
-                return;
-              }
-
-              dependencies.insert(caller);
-            };
-
-        auto callees = call_graph.callees(caller);
+      [&](sparta::SpartaWorkerState<const Method*>* worker_state,
+          const Method* caller) {
+        auto* code = caller->get_code();
+        if (!code) {
+          return;
+        }
+
+        if (modes[caller->id()].test(Model::Mode::SkipAnalysis)) {
+          return;
+        }
+
+        // Unreachable methods are not analyzed, hence never depend on their
+        // callees. Callees of reachable methods are reachable.
+        if (reachable_methods != nullptr &&
+            !reachable_methods->contains(caller)) {
+          return;
+        }
+
+        auto& edges = partial_edges.at(worker_state->worker_id());
+        const auto& callees = call_graph.callees(caller);
 
         for (const auto& call_target : callees) {
           if (!call_target.resolved()) {
             continue;
           }
 
-          dependencies_.update(
-              call_target.resolved_base_callee(), add_caller_as_dependency);
+          edges.emplace_back(call_target.resolved_base_callee(), caller);
 
           if (!call_target.is_virtual()) {
             // We don't add a dependency for overrides of direct invocations.
             continue;
           }
 
-          auto model = registry.get(call_target.resolved_base_callee());
-
-          if (model.no_join_virtual_overrides()) {
+          if (modes[call_target.resolved_base_callee()->id()].test(
+                  Model::Mode::NoJoinVirtualOverrides)) {
             continue;
           }
 
@@ -75,7 +100,7 @@ Dependencies::Dependencies(
           }
 
           for (const auto* override : call_target.overrides()) {
-            dependencies_.update(override, add_caller_as_dependency);
+            edges.emplace_back(override, caller);
           }
         }
 
@@ -83,18 +108,45 @@ Dependencies::Dependencies(
 
         for (const auto& [instruction, callees] : artificial_callees) {
           for (const auto& artificial_callee : callees) {
-            dependencies_.update(
-                artificial_callee.call_target.resolved_base_callee(),
-                add_caller_as_dependency);
+            edges.emplace_back(
+                artificial_callee.call_target.resolved_base_callee(), caller);
           }
         }
       },
-      sparta::parallel::default_num_threads());
+      threads);
   for (const auto* method : methods) {
     queue.add_item(method);
   }
   queue.run_all();
 
+  // Build the compressed sparse rows.
+  std::vector<Edge> edges;
+  std::size_t number_edges = 0;
+  for (const auto& partial : partial_edges) {
+    number_edges += partial.size();
+  }
+  edges.reserve(number_edges);
+  for (auto& partial : partial_edges) {
+    edges.insert(edges.end(), partial.begin(), partial.end());
+    partial = {};
+  }
+  std::sort(
+      edges.begin(), edges.end(), [](const Edge& left, const Edge& right) {
+        return std::make_pair(left.first->id(), left.second->id()) <
+            std::make_pair(right.first->id(), right.second->id());
+      });
+  edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+  offsets_.assign(methods.size() + 1, 0);
+  callers_.reserve(edges.size());
+  for (const auto& [callee, caller] : edges) {
+    offsets_[callee->id() + 1]++;
+    callers_.push_back(caller);
+  }
+  for (std::size_t id = 0; id < methods.size(); id++) {
+    offsets_[id + 1] += offsets_[id];
+  }
+
   for (const auto* method : warn_many_overrides) {
     WARNING(
         1,
@@ -110,23 +162,26 @@ Dependencies::Dependencies(
   }
 }
 
-const std::unordered_set<const Method*>& Dependencies::dependencies(
-    const Method* method) const {
-  // Note that `find` is not thread-safe, but this is fine because
-  // `dependencies_` is read-only after the constructor completed.
-  auto found = dependencies_.find(method);
-  if (found != dependencies_.end()) {
-    return found->second;
-  } else {
-    return empty_method_set_;
+Span<const Method*> Dependencies::dependencies(const Method* method) const {
+  auto id = method->id();
+  if (id + 1 >= offsets_.size()) {
+    return Span<const Method*>();
   }
+
+  const auto* callers = callers_.data();
+  return Span<const Method*>(
+      callers + offsets_[id], callers + offsets_[id + 1]);
 }
 
 Json::Value Dependencies::to_json() const {
   auto value = Json::Value(Json::objectValue);
-  for (const auto& [method, dependencies] : dependencies_) {
+  for (const auto* method : methods_) {
+    auto callers = dependencies(method);
+    if (callers.empty()) {
+      continue;
+    }
     auto dependencies_value = Json::Value(Json::arrayValue);
-    for (const auto* dependency : dependencies) {
+    for (const auto* dependency : callers) {
       dependencies_value.append(Json::Value(show(dependency)));
     }
     value[method->show()] = dependencies_value;
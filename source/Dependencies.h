@@ -7,20 +7,29 @@
 
 #pragma once
 
-#include <unordered_set>
+#include <vector>
 
 #include <json/json.h>
 
-#include <ConcurrentContainers.h>
-
 #include <mariana-trench/CallGraph.h>
 #include <mariana-trench/Method.h>
+#include <mariana-trench/Methods.h>
 #include <mariana-trench/Options.h>
 #include <mariana-trench/Overrides.h>
+#include <mariana-trench/ReachableMethods.h>
 #include <mariana-trench/Registry.h>
+#include <mariana-trench/Span.h>
 
 namespace marianatrench {
 
+/**
+ * The reverse call graph, i.e the possible callers of each method.
+ *
+ * Dependencies are read-only after construction and stored in a compressed
+ * sparse row format: the callers of all methods are stored in a single array,
+ * and each method refers to a contiguous range of that array, indexed by its
+ * identifier (see `Method::id`).
+ */
 class Dependencies final {
  public:
   explicit Dependencies(
@@ -28,7 +37,8 @@ class Dependencies final {
       const Methods& methods,
       const Overrides& overrides,
       const CallGraph& call_graph,
-      const Registry& registry);
+      const Registry& registry,
+      const ReachableMethods* MT_NULLABLE reachable_methods = nullptr);
 
   Dependencies(const Dependencies&) = delete;
   Dependencies(Dependencies&&) = delete;
@@ -40,14 +50,16 @@ class Dependencies final {
    * Return the set of dependencies for the given method, i.e the set of
    * possible callers.
    */
-  const std::unordered_set<const Method*>& dependencies(
-      const Method* method) const;
+  Span<const Method*> dependencies(const Method* method) const;
 
   Json::Value to_json() const;
 
  private:
-  ConcurrentMap<const Method*, std::unordered_set<const Method*>> dependencies_;
-  std::unordered_set<const Method*> empty_method_set_;
+  const Methods& methods_;
+  // The callers of the method with identifier `i` are in
+  // `[callers_[offsets_[i]], callers_[offsets_[i + 1]])`.
+  std::vector<std::size_t> offsets_;
+  std::vector<const Method*> callers_;
 };
 
 } // namespace marianatrench
@@ -0,0 +1,173 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <cstdint>
+#include <functional>
+
+#include <ControlFlow.h>
+#include <IRCode.h>
+#include <IRInstruction.h>
+#include <Show.h>
+#include <SpartaWorkQueue.h>
+
+#include <mariana-trench/DuplicateMethods.h>
+
+namespace marianatrench {
+
+namespace {
+
+void append(std::string& fingerprint, const void* MT_NULLABLE pointer) {
+  fingerprint.append(
+      std::to_string(reinterpret_cast<std::uintptr_t>(pointer)));
+  fingerprint.push_back(' ');
+}
+
+} // namespace
+
+DuplicateMethods::DuplicateMethods(
+    const Methods& methods,
+    const CallGraph& call_graph,
+    const RuntimeHeuristics& heuristics) {
+  // Fingerprints are large, hence only their hashes are kept for all methods,
+  // and fingerprints are computed again for methods with equal hashes.
+  std::vector<std::optional<std::size_t>> hashes(methods.size());
+  auto queue = sparta::work_queue<const Method*>([&](const Method* method) {
+    if (auto fingerprint =
+            DuplicateMethods::fingerprint(method, call_graph, heuristics)) {
+      hashes[method->id()] = std::hash<std::string>()(*fingerprint);
+    }
+  });
+  for (const auto* method : methods) {
+    queue.add_item(method);
+  }
+  queue.run_all();
+
+  std::unordered_map<std::size_t, std::vector<const Method*>> candidates;
+  for (const auto* method : methods) {
+    if (const auto& hash = hashes[method->id()]) {
+      candidates[*hash].push_back(method);
+    }
+  }
+
+  for (const auto& [hash, candidate_methods] : candidates) {
+    if (candidate_methods.size() < 2) {
+      continue;
+    }
+    std::unordered_map<std::string, std::vector<const Method*>> fingerprints;
+    for (const auto* method : candidate_methods) {
+      fingerprints[*fingerprint(method, call_graph, heuristics)].push_back(
+          method);
+    }
+    for (const auto& [_, group_methods] : fingerprints) {
+      if (group_methods.size() < 2) {
+        continue;
+      }
+      auto* group =
+          group_storage_.emplace_back(std::make_unique<Group>()).get();
+      for (const auto* method : group_methods) {
+        groups_.emplace(method, group);
+      }
+    }
+  }
+}
+
+std::optional<std::string> DuplicateMethods::fingerprint(
+    const Method* method,
+    const CallGraph& call_graph,
+    const RuntimeHeuristics& heuristics) {
+  const auto* code = method->get_code();
+  if (code == nullptr || !code->cfg_built() ||
+      !call_graph.artificial_callees(method).empty()) {
+    return std::nullopt;
+  }
+  const auto& cfg = code->cfg();
+  if (cfg.num_opcodes() > kMaxInstructions) {
+    return std::nullopt;
+  }
+
+  std::string fingerprint;
+  fingerprint.append(method->is_static() ? "static " : "instance ");
+  append(fingerprint, method->get_proto());
+  for (const auto& [parameter, type] : method->parameter_type_overrides()) {
+    fingerprint.append(std::to_string(parameter));
+    fingerprint.push_back(':');
+    append(fingerprint, type);
+  }
+  // Heuristics are owned by `RuntimeHeuristics`, compare them by identity.
+  append(fingerprint, &heuristics.get(method));
+  fingerprint.push_back('\n');
+
+  for (const auto* block : cfg.blocks()) {
+    fingerprint.append(std::to_string(block->id()));
+    fingerprint.append(block == cfg.entry_block() ? " entry\n" : "\n");
+    for (const auto& entry : InstructionIterable(block)) {
+      const auto* instruction = entry.insn;
+      fingerprint.append(show(instruction));
+      fingerprint.push_back(' ');
+      if (opcode::is_an_invoke(instruction->opcode())) {
+        auto call_target = call_graph.callee(method, instruction);
+        append(fingerprint, call_target.resolved_base_callee());
+        append(fingerprint, call_target.receiver_type());
+        for (const auto* override : call_target.overrides()) {
+          append(fingerprint, override);
+        }
+      } else if (instruction->has_field()) {
+        append(
+            fingerprint, call_graph.resolved_field_access(method, instruction));
+      }
+      fingerprint.push_back('\n');
+    }
+    for (const auto* edge : block->succs()) {
+      fingerprint.append(std::to_string(edge->target()->id()));
+      fingerprint.push_back(':');
+      fingerprint.append(std::to_string(static_cast<int>(edge->type())));
+      if (edge->case_key()) {
+        fingerprint.push_back(':');
+        fingerprint.append(std::to_string(*edge->case_key()));
+      }
+      fingerprint.push_back(' ');
+    }
+    fingerprint.push_back('\n');
+  }
+  return fingerprint;
+}
+
+std::optional<DuplicateMethods::Entry> DuplicateMethods::find(
+    const Method* method) const {
+  auto found = groups_.find(method);
+  if (found == groups_.end()) {
+    return std::nullopt;
+  }
+  std::lock_guard<std::mutex> lock(found->second->mutex);
+  return found->second->entry;
+}
+
+void DuplicateMethods::record(
+    const Method* method,
+    const Model& previous_model,
+    const Model& model,
+    const MethodContext::CalleeModels& callee_models) {
+  auto found = groups_.find(method);
+  if (found == groups_.end()) {
+    return;
+  }
+  auto* group = found->second;
+  std::lock_guard<std::mutex> lock(group->mutex);
+  if (shareable(model)) {
+    group->entry = Entry{method, previous_model, model, callee_models};
+  } else {
+    group->entry = std::nullopt;
+  }
+}
+
+bool DuplicateMethods::shareable(const Model& model) {
+  return model.generations().is_bottom() &&
+      model.parameter_sources().is_bottom() && model.sinks().is_bottom() &&
+      model.issues().empty() && !model.skip_analysis();
+}
+
+} // namespace marianatrench
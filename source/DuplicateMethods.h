@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <mariana-trench/CallGraph.h>
+#include <mariana-trench/Compiler.h>
+#include <mariana-trench/Method.h>
+#include <mariana-trench/MethodContext.h>
+#include <mariana-trench/Methods.h>
+#include <mariana-trench/Model.h>
+#include <mariana-trench/RuntimeHeuristics.h>
+
+namespace marianatrench {
+
+/**
+ * Groups of methods with identical code, used to analyze them once per
+ * iteration when `--deduplicate-methods` is used.
+ *
+ * Two methods are duplicates when their fingerprints are equal. A fingerprint
+ * is a normalized representation of the control flow graph (opcodes,
+ * registers, literals and references of the instructions, and edges), the
+ * resolved callees and fields, the prototype, the parameter type overrides
+ * and the heuristics of the method. Debug positions are not part of it.
+ *
+ * The last model computed for a method of a group is recorded along with the
+ * callee models it read. Another method of the group can reuse it (see
+ * `Model::instantiate`) if it starts from an equal model and the callee models
+ * did not change since. Only models that do not depend on the positions of
+ * the analyzed method are recorded, i.e models without sources, sinks or
+ * issues. Propagations, sanitizers and modes do not refer to positions.
+ */
+class DuplicateMethods final {
+ public:
+  struct Entry {
+    const Method* method;
+    Model previous_model;
+    Model model;
+    MethodContext::CalleeModels callee_models;
+  };
+
+  /* Only methods with at most this many instructions are fingerprinted. */
+  static constexpr std::size_t kMaxInstructions = 200;
+
+ public:
+  explicit DuplicateMethods(
+      const Methods& methods,
+      const CallGraph& call_graph,
+      const RuntimeHeuristics& heuristics);
+
+  DuplicateMethods(const DuplicateMethods&) = delete;
+  DuplicateMethods(DuplicateMethods&&) = delete;
+  DuplicateMethods& operator=(const DuplicateMethods&) = delete;
+  DuplicateMethods& operator=(DuplicateMethods&&) = delete;
+  ~DuplicateMethods() = default;
+
+  /**
+   * Return the fingerprint of the method, or `std::nullopt` if it cannot be
+   * deduplicated (no code, too large or with artificial callees).
+   */
+  static std::optional<std::string> fingerprint(
+      const Method* method,
+      const CallGraph& call_graph,
+      const RuntimeHeuristics& heuristics);
+
+  /* Return true if the method has at least one duplicate. */
+  bool has_duplicates(const Method* method) const {
+    return groups_.find(method) != groups_.end();
+  }
+
+  /* Return the number of methods that have at least one duplicate. */
+  std::size_t size() const {
+    return groups_.size();
+  }
+
+  /**
+   * Return the last recorded model of the group of the method, if any. This
+   * is thread-safe.
+   */
+  std::optional<Entry> find(const Method* method) const;
+
+  /**
+   * Record the model computed for the method from the given previous model,
+   * or forget the model of its group if it depends on the positions of the
+   * method. This is thread-safe.
+   */
+  void record(
+      const Method* method,
+      const Model& previous_model,
+      const Model& model,
+      const MethodContext::CalleeModels& callee_models);
+
+  /* Record that a method reused the model of its group. */
+  void record_reuse() {
+    reuses_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  std::size_t reuses() const {
+    return reuses_.load(std::memory_order_relaxed);
+  }
+
+  /* Return true if the model does not depend on the positions of its method. */
+  static bool shareable(const Model& model);
+
+ private:
+  struct Group {
+    mutable std::mutex mutex;
+    std::optional<Entry> entry;
+  };
+
+  std::vector<std::unique_ptr<Group>> group_storage_;
+  std::unordered_map<const Method*, Group*> groups_;
+  std::atomic<std::size_t> reuses_{0};
+};
+
+} // namespace marianatrench
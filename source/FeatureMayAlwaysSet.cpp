@@ -5,20 +5,130 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <utility>
+
+#include <boost/functional/hash.hpp>
+
+#include <ConcurrentContainers.h>
+
 #include <mariana-trench/Assert.h>
 #include <mariana-trench/FeatureMayAlwaysSet.h>
 #include <mariana-trench/JsonValidation.h>
+#include <mariana-trench/UniquePointerFactory.h>
 
 namespace marianatrench {
 
+namespace {
+
+using OverUnderSet =
+    sparta::PatriciaTreeOverUnderSetAbstractDomain<const Feature*>;
+
+struct OverUnderSetHash {
+  std::size_t operator()(const OverUnderSet& set) const {
+    std::size_t seed = 0;
+    boost::hash_combine(seed, set.is_bottom());
+    boost::hash_combine(seed, set.is_top());
+    if (set.is_value()) {
+      for (const auto* feature : set.over()) {
+        boost::hash_combine(seed, feature);
+      }
+      // Separate the may-features from the always-features.
+      boost::hash_combine(seed, static_cast<const Feature*>(nullptr));
+      for (const auto* feature : set.under()) {
+        boost::hash_combine(seed, feature);
+      }
+    }
+    return seed;
+  }
+};
+
+/**
+ * Global table of canonical may-always pairs, with a cache of joins.
+ *
+ * Pairs are never freed, which is fine since the number of distinct
+ * combinations of features is small.
+ */
+class FeatureMayAlwaysSetTable final {
+ private:
+  using JoinKey = std::pair<const OverUnderSet*, const OverUnderSet*>;
+
+ public:
+  FeatureMayAlwaysSetTable() = default;
+  FeatureMayAlwaysSetTable(const FeatureMayAlwaysSetTable&) = delete;
+  FeatureMayAlwaysSetTable(FeatureMayAlwaysSetTable&&) = delete;
+  FeatureMayAlwaysSetTable& operator=(const FeatureMayAlwaysSetTable&) =
+      delete;
+  FeatureMayAlwaysSetTable& operator=(FeatureMayAlwaysSetTable&&) = delete;
+  ~FeatureMayAlwaysSetTable() = default;
+
+  /* Return the canonical pointer for the given pair. Thread-safe. */
+  const OverUnderSet* get(const OverUnderSet& set) const {
+    return sets_.create(set);
+  }
+
+  const OverUnderSet* empty() const {
+    return empty_;
+  }
+
+  /* Return the canonical join of the given pairs. Thread-safe. */
+  const OverUnderSet* join(
+      const OverUnderSet* left,
+      const OverUnderSet* right) const {
+    // The join is commutative.
+    auto key = std::less<const OverUnderSet*>()(left, right)
+        ? JoinKey(left, right)
+        : JoinKey(right, left);
+    if (const auto* cached = joins_.get(key, nullptr)) {
+      return cached;
+    }
+
+    auto set = *left;
+    set.join_with(*right);
+    const auto* result = get(set);
+    if (number_joins_.load(std::memory_order_relaxed) < kMaxCachedJoins &&
+        joins_.insert(std::make_pair(key, result))) {
+      number_joins_.fetch_add(1, std::memory_order_relaxed);
+    }
+    return result;
+  }
+
+  static const FeatureMayAlwaysSetTable& singleton() {
+    // Never destroyed: frames in static storage may outlive the table.
+    static const auto* table = new FeatureMayAlwaysSetTable();
+    return *table;
+  }
+
+ private:
+  /* Maximum number of memoized joins. */
+  constexpr static std::size_t kMaxCachedJoins = 1 << 16;
+
+  UniquePointerFactory<OverUnderSet, OverUnderSet, OverUnderSetHash> sets_;
+  mutable ConcurrentMap<JoinKey, const OverUnderSet*, boost::hash<JoinKey>>
+      joins_;
+  mutable std::atomic<std::size_t> number_joins_ = 0;
+  const OverUnderSet* empty_ = get(OverUnderSet());
+};
+
+} // namespace
+
+FeatureMayAlwaysSet::FeatureMayAlwaysSet(const OverUnderSet& set)
+    : set_(FeatureMayAlwaysSetTable::singleton().get(set)) {}
+
+FeatureMayAlwaysSet::FeatureMayAlwaysSet()
+    : set_(FeatureMayAlwaysSetTable::singleton().empty()) {}
+
 FeatureMayAlwaysSet::FeatureMayAlwaysSet(
     std::initializer_list<const Feature*> features)
-    : set_(features) {}
+    : FeatureMayAlwaysSet(OverUnderSet(features)) {}
 
 FeatureMayAlwaysSet::FeatureMayAlwaysSet(
     const FeatureSet& may,
     const FeatureSet& always)
-    : set_(/* over */ may.set_, /* under */ always.set_) {}
+    : FeatureMayAlwaysSet(
+          OverUnderSet(/* over */ may.set_, /* under */ always.set_)) {}
 
 FeatureMayAlwaysSet FeatureMayAlwaysSet::make_may(
     std::initializer_list<const Feature*> features) {
@@ -43,58 +153,74 @@ FeatureMayAlwaysSet FeatureMayAlwaysSet::make_always(
       OverUnderSet(/* over */ features.set_, /* under */ features.set_));
 }
 
+void FeatureMayAlwaysSet::set_to_bottom() {
+  *this = bottom();
+}
+
+void FeatureMayAlwaysSet::set_to_top() {
+  *this = top();
+}
+
 FeatureSet FeatureMayAlwaysSet::may() const {
-  mt_assert(set_.is_value());
-  return FeatureSet(set_.over());
+  mt_assert(set_->is_value());
+  return FeatureSet(set_->over());
 }
 
 FeatureSet FeatureMayAlwaysSet::always() const {
-  mt_assert(set_.is_value());
-  return FeatureSet(set_.under());
+  mt_assert(set_->is_value());
+  return FeatureSet(set_->under());
 }
 
 void FeatureMayAlwaysSet::add_may(const Feature* feature) {
-  set_.add_over(feature);
+  update([&](OverUnderSet& set) { set.add_over(feature); });
 }
 
 void FeatureMayAlwaysSet::add_may(const FeatureSet& features) {
-  set_.add_over(features.set_);
+  update([&](OverUnderSet& set) { set.add_over(features.set_); });
 }
 
 void FeatureMayAlwaysSet::add_always(const Feature* feature) {
-  set_.add_under(feature);
+  update([&](OverUnderSet& set) { set.add_under(feature); });
 }
 
 void FeatureMayAlwaysSet::add_always(const FeatureSet& features) {
-  set_.add_under(features.set_);
+  update([&](OverUnderSet& set) { set.add_under(features.set_); });
 }
 
 void FeatureMayAlwaysSet::add(const FeatureMayAlwaysSet& other) {
-  set_.add(other.set_);
+  update([&](OverUnderSet& set) { set.add(*other.set_); });
 }
 
 bool FeatureMayAlwaysSet::leq(const FeatureMayAlwaysSet& other) const {
-  return set_.leq(other.set_);
+  return set_ == other.set_ || set_->leq(*other.set_);
 }
 
 bool FeatureMayAlwaysSet::equals(const FeatureMayAlwaysSet& other) const {
-  return set_.equals(other.set_);
+  // Pairs are interned.
+  return set_ == other.set_;
 }
 
 void FeatureMayAlwaysSet::join_with(const FeatureMayAlwaysSet& other) {
-  set_.join_with(other.set_);
+  if (set_ == other.set_ || other.set_->is_bottom()) {
+    return;
+  }
+  if (set_->is_bottom()) {
+    set_ = other.set_;
+    return;
+  }
+  set_ = FeatureMayAlwaysSetTable::singleton().join(set_, other.set_);
 }
 
 void FeatureMayAlwaysSet::widen_with(const FeatureMayAlwaysSet& other) {
-  set_.widen_with(other.set_);
+  update([&](OverUnderSet& set) { set.widen_with(*other.set_); });
 }
 
 void FeatureMayAlwaysSet::meet_with(const FeatureMayAlwaysSet& other) {
-  set_.meet_with(other.set_);
+  update([&](OverUnderSet& set) { set.meet_with(*other.set_); });
 }
 
 void FeatureMayAlwaysSet::narrow_with(const FeatureMayAlwaysSet& other) {
-  set_.narrow_with(other.set_);
+  update([&](OverUnderSet& set) { set.narrow_with(*other.set_); });
 }
 
 FeatureMayAlwaysSet FeatureMayAlwaysSet::from_json(
@@ -126,7 +252,7 @@ FeatureMayAlwaysSet FeatureMayAlwaysSet::from_json(
 }
 
 Json::Value FeatureMayAlwaysSet::to_json() const {
-  mt_assert(set_.is_value());
+  mt_assert(set_->is_value());
 
   auto may_features = may();
   auto always_features = always();
@@ -25,6 +25,11 @@ namespace marianatrench {
  * Represents the sets of may and always features.
  * May-features are features that happen on at least one of the flows.
  * Always-features are features that happen on all flows.
+ *
+ * The same few combinations of features appear on most frames, hence the
+ * pairs of sets are interned in a global table and a feature set is a pointer
+ * to its canonical pair. Copies are cheap, equality is a pointer comparison
+ * and joins of frequent pairs are memoized.
  */
 class FeatureMayAlwaysSet final
     : public sparta::AbstractDomain<FeatureMayAlwaysSet> {
@@ -33,11 +38,11 @@ class FeatureMayAlwaysSet final
       sparta::PatriciaTreeOverUnderSetAbstractDomain<const Feature*>;
 
  private:
-  explicit FeatureMayAlwaysSet(OverUnderSet set) : set_(std::move(set)) {}
+  explicit FeatureMayAlwaysSet(const OverUnderSet& set);
 
  public:
   /* Create the empty may-always feature set. */
-  FeatureMayAlwaysSet() = default;
+  FeatureMayAlwaysSet();
 
   /* Create the may-always feature set with the given always-features. */
   explicit FeatureMayAlwaysSet(std::initializer_list<const Feature*> features);
@@ -68,29 +73,25 @@ class FeatureMayAlwaysSet final
   }
 
   bool is_bottom() const override {
-    return set_.is_bottom();
+    return set_->is_bottom();
   }
 
   bool is_top() const override {
-    return set_.is_top();
+    return set_->is_top();
   }
 
   /* Return true if this is neither top nor bottom. */
   bool is_value() const {
-    return set_.is_value();
+    return set_->is_value();
   }
 
   bool empty() const {
-    return set_.empty();
+    return set_->empty();
   }
 
-  void set_to_bottom() override {
-    set_.is_bottom();
-  }
+  void set_to_bottom() override;
 
-  void set_to_top() override {
-    set_.is_top();
-  }
+  void set_to_top() override;
 
   FeatureSet may() const;
 
@@ -128,7 +129,17 @@ class FeatureMayAlwaysSet final
       const FeatureMayAlwaysSet& features);
 
  private:
-  OverUnderSet set_;
+  /* Apply `f` on a copy of the canonical pair and intern the result. */
+  template <typename Function> // void(OverUnderSet&)
+  void update(Function&& f) {
+    auto set = *set_;
+    f(set);
+    *this = FeatureMayAlwaysSet(set);
+  }
+
+ private:
+  // Interned, see `FeatureMayAlwaysSet.cpp`.
+  const OverUnderSet* set_;
 };
 
 } // namespace marianatrench
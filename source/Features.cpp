@@ -9,26 +9,45 @@
 
 namespace marianatrench {
 
-const Feature* Features::get(const std::string& data) const {
+namespace {
+
+template <typename Key>
+const Feature* memoized_feature(
+    ConcurrentMap<const Key*, const Feature*>& features,
+    const InterningTable<Feature>& factory,
+    std::string_view prefix,
+    const Key* MT_NULLABLE key) {
+  if (const auto* feature = features.get(key, nullptr)) {
+    return feature;
+  }
+
+  // Interning is idempotent, hence concurrent insertions store the same
+  // feature.
+  const auto& key_string = key ? key->str() : "unknown";
+  const auto* feature = factory.create(std::string(prefix) + key_string);
+  features.emplace(key, feature);
+  return feature;
+}
+
+} // namespace
+
+const Feature* Features::get(std::string_view data) const {
   return factory_.create(data);
 }
 
 const Feature* Features::get_via_type_of_feature(
     const DexType* MT_NULLABLE type) const {
-  const auto& type_string = type ? type->str() : "unknown";
-  return factory_.create("via-type:" + type_string);
+  return memoized_feature(via_type_of_features_, factory_, "via-type:", type);
 }
 
 const Feature* Features::get_via_cast_feature(
     const DexType* MT_NULLABLE type) const {
-  const auto& type_string = type ? type->str() : "unknown";
-  return factory_.create("via-cast:" + type_string);
+  return memoized_feature(via_cast_features_, factory_, "via-cast:", type);
 }
 
 const Feature* Features::get_via_value_of_feature(
-    const std::optional<std::string>& value) const {
-  const auto& via_value = value.value_or("unknown");
-  return factory_.create("via-value:" + via_value);
+    const DexString* MT_NULLABLE value) const {
+  return memoized_feature(via_value_features_, factory_, "via-value:", value);
 }
 
 } // namespace marianatrench
@@ -8,9 +8,14 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 
+#include <ConcurrentContainers.h>
+#include <DexClass.h>
+
+#include <mariana-trench/Compiler.h>
 #include <mariana-trench/Feature.h>
-#include <mariana-trench/UniquePointerFactory.h>
+#include <mariana-trench/InterningTable.h>
 
 namespace marianatrench {
 
@@ -23,15 +28,22 @@ class Features final {
   Features& operator=(Features&&) = delete;
   ~Features() = default;
 
-  const Feature* get(const std::string& data) const;
+  const Feature* get(std::string_view data) const;
 
+  /**
+   * The via-type, via-cast and via-value features are memoized per type and
+   * value, since they are created for each call site with a via port.
+   */
   const Feature* get_via_type_of_feature(const DexType* MT_NULLABLE type) const;
   const Feature* get_via_cast_feature(const DexType* MT_NULLABLE type) const;
   const Feature* get_via_value_of_feature(
-      const std::optional<std::string>& value) const;
+      const DexString* MT_NULLABLE value) const;
 
  private:
-  UniquePointerFactory<std::string, Feature> factory_;
+  InterningTable<Feature> factory_;
+  mutable ConcurrentMap<const DexType*, const Feature*> via_type_of_features_;
+  mutable ConcurrentMap<const DexType*, const Feature*> via_cast_features_;
+  mutable ConcurrentMap<const DexString*, const Feature*> via_value_features_;
 };
 
 } // namespace marianatrench
@@ -33,6 +33,15 @@ class Field final {
     return field_;
   }
 
+  /**
+   * Return the dense identifier of the field, in `[0, fields.size())`.
+   *
+   * This is only meaningful for fields created by the `Fields` factory.
+   */
+  std::size_t id() const {
+    return id_;
+  }
+
   DexType* get_class() const;
   const std::string& get_name() const;
   const std::string& show() const;
@@ -41,10 +50,12 @@ class Field final {
   Json::Value to_json() const;
 
  private:
+  friend class Fields;
   friend struct std::hash<Field>;
   friend std::ostream& operator<<(std::ostream& out, const Field& field);
 
   const DexField* field_;
+  std::size_t id_ = 0;
   // Of the form <class_name>;.<field_name>:<field_type>;
   std::string show_cached_;
 };
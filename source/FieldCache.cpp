@@ -5,62 +5,21 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <utility>
+
 #include <Walkers.h>
 
 #include <mariana-trench/Assert.h>
 #include <mariana-trench/FieldCache.h>
 
-namespace {
-
-/**
- * Returns all known DexTypes in the hierarchy of `type` (ancestors and
- * descendents).
- */
-std::unordered_set<const DexType*> types_in_class_hierarchy(
-    const DexType* type,
-    const marianatrench::ClassHierarchies& class_hierarchies) {
-  mt_assert(type != type::java_lang_Object());
-
-  const auto* klass = type_class(type);
-  if (klass == nullptr) {
-    // Not an object type, or class does not exist in the APK (might be in
-    // the system jars). No class hierarchy.
-    return std::unordered_set<const DexType*>{};
-  }
-
-  // Include self + descendants.
-  auto types = class_hierarchies.extends(type);
-  types.insert(type);
-
-  // Include inherited types.
-  const auto* super_class_type = klass->get_super_class();
-  while (super_class_type) {
-    klass = type_class(super_class_type);
-    if (klass == nullptr) {
-      // This can happen if the class does not exist in the APK (e.g. exists in
-      // jar). Stop here. We do not have enough information about `klass`.
-      break;
-    }
-    types.insert(super_class_type);
-    super_class_type = klass->get_super_class();
-  }
-
-  return types;
-}
-
-} // namespace
-
 namespace marianatrench {
 
 FieldCache::FieldCache(
     const ClassHierarchies& class_hierarchies,
-    const DexStoresVector& stores) {
-  using FieldNameToTypeMap =
-      std::unordered_map<const DexString*, const DexType*>;
-
+    const DexStoresVector& stores)
+    : class_hierarchies_(class_hierarchies) {
   // Compute map class_type -> field -> type.
-  // Class hierarchy is ignored at this stage.
-  ConcurrentMap<const DexType*, FieldNameToTypeMap> fields_in_class;
+  // Class hierarchy is ignored at this stage, see `compute_field_types`.
   for (const auto& scope : DexStoreClassesIterator(stores)) {
     walk::parallel::classes(scope, [&](const DexClass* klass) {
       FieldNameToTypeMap field_to_type;
@@ -69,35 +28,8 @@ FieldCache::FieldCache(
       }
 
       if (!field_to_type.empty()) {
-        fields_in_class.emplace(klass->get_type(), std::move(field_to_type));
-      }
-    });
-  }
-
-  // Use class hierarchy to compute
-  // class_type -> derived/inherited fields -> type
-  for (const auto& scope : DexStoreClassesIterator(stores)) {
-    walk::parallel::classes(scope, [&](const DexClass* klass) {
-      const auto* type = klass->get_type();
-      if (type == type::java_lang_Object()) {
-        return;
+        fields_in_class_.emplace(klass->get_type(), std::move(field_to_type));
       }
-      auto class_types = types_in_class_hierarchy(type, class_hierarchies);
-      FieldTypeMap all_field_types;
-      for (const auto* class_type : class_types) {
-        auto field_types = fields_in_class.find(class_type);
-        if (field_types == fields_in_class.end()) {
-          // No fields in this class.
-          continue;
-        }
-        for (const auto& [field, field_type] : field_types->second) {
-          all_field_types[field].insert(field_type);
-        }
-      }
-
-      field_cache_.emplace(
-          klass->get_type(),
-          std::make_unique<FieldTypeMap>(std::move(all_field_types)));
     });
   }
 }
@@ -105,17 +37,100 @@ FieldCache::FieldCache(
 const FieldCache::Types& FieldCache::field_types(
     const DexType* klass,
     const DexString* field) const {
+  if (klass == type::java_lang_Object()) {
+    return empty_types_;
+  }
+
   const auto* field_name_to_type =
       field_cache_.get(klass, /* default */ nullptr);
+  if (field_name_to_type == nullptr) {
+    // Computing the same entry concurrently is harmless: the first insertion
+    // wins and the other result is discarded.
+    field_cache_.emplace(klass, compute_field_types(klass));
+    field_name_to_type = field_cache_.at(klass);
+  }
 
-  if (field_name_to_type != nullptr) {
-    auto result = field_name_to_type->find(field);
-    if (result != field_name_to_type->end()) {
-      return result->second;
-    }
+  auto result = field_name_to_type->find(field);
+  if (result != field_name_to_type->end()) {
+    return result->second;
   }
 
   return empty_types_;
 }
 
+const FieldCache::Types& FieldCache::field_types(
+    const Types& types,
+    const DexString* field) const {
+  auto key = PathKey(&types, field);
+  auto field_types = path_field_types_.get(key, /* default */ nullptr);
+  if (field_types != nullptr) {
+    return *field_types;
+  }
+
+  auto result = std::make_shared<Types>();
+  for (const auto* type : types) {
+    const auto& types_of_type = this->field_types(type, field);
+    result->insert(types_of_type.begin(), types_of_type.end());
+  }
+  // The first insertion wins, so that all threads use the same set as the
+  // key of the next fields of the path.
+  path_field_types_.emplace(key, std::move(result));
+  return *path_field_types_.at(key);
+}
+
+const FieldCache::Types& FieldCache::singleton_types(
+    const DexType* type) const {
+  auto types = singleton_types_.get(type, /* default */ nullptr);
+  if (types == nullptr) {
+    singleton_types_.emplace(type, std::make_shared<Types>(Types{type}));
+    types = singleton_types_.at(type);
+  }
+  return *types;
+}
+
+std::unique_ptr<FieldCache::FieldTypeMap> FieldCache::compute_field_types(
+    const DexType* type) const {
+  mt_assert(type != type::java_lang_Object());
+
+  auto all_field_types = std::make_unique<FieldTypeMap>();
+  const auto* klass = type_class(type);
+  if (klass == nullptr) {
+    // Not an object type, or class does not exist in the APK (might be in
+    // the system jars). No class hierarchy.
+    return all_field_types;
+  }
+
+  auto add_fields = [&](const DexType* class_type) {
+    auto field_types = fields_in_class_.find(class_type);
+    if (field_types == fields_in_class_.end()) {
+      // No fields in this class.
+      return;
+    }
+    for (const auto& [field, field_type] : field_types->second) {
+      (*all_field_types)[field].insert(field_type);
+    }
+  };
+
+  // Include self + descendants.
+  add_fields(type);
+  for (const auto* child : class_hierarchies_.extends(type)) {
+    add_fields(child);
+  }
+
+  // Include inherited types.
+  const auto* super_class_type = klass->get_super_class();
+  while (super_class_type) {
+    klass = type_class(super_class_type);
+    if (klass == nullptr) {
+      // This can happen if the class does not exist in the APK (e.g. exists in
+      // jar). Stop here. We do not have enough information about `klass`.
+      break;
+    }
+    add_fields(super_class_type);
+    super_class_type = klass->get_super_class();
+  }
+
+  return all_field_types;
+}
+
 } // namespace marianatrench
@@ -7,8 +7,14 @@
 
 #pragma once
 
+#include <memory>
 #include <unordered_map>
+#include <unordered_set>
+#include <utility>
 
+#include <boost/functional/hash.hpp>
+
+#include <ConcurrentContainers.h>
 #include <DexStore.h>
 
 #include <mariana-trench/ClassHierarchies.h>
@@ -23,6 +29,8 @@ class FieldCache final {
 
  private:
   using FieldTypeMap = std::unordered_map<const DexString*, Types>;
+  using FieldNameToTypeMap =
+      std::unordered_map<const DexString*, const DexType*>;
 
  public:
   explicit FieldCache(
@@ -39,11 +47,41 @@ class FieldCache final {
    * Returns the possible types of `field` in `klass`.
    * This includes fields that may be present in any class in the hierarchy of
    * `klass` (ancestors and descendents).
+   *
+   * The types of all fields of a class are computed on the first query for
+   * that class, and memoized. This is thread-safe.
    */
   const Types& field_types(const DexType* klass, const DexString* field) const;
 
+  /**
+   * Returns the possible types of `field` in any of the given types, e.g the
+   * possible types of a path of fields given the types of its prefix.
+   *
+   * `types` must be returned by `singleton_types` or `field_types`: results
+   * are memoized per set and field, hence the types of a path are only
+   * computed once. This is thread-safe.
+   */
+  const Types& field_types(const Types& types, const DexString* field) const;
+
+  /* Returns the set containing only the given type, memoized. */
+  const Types& singleton_types(const DexType* type) const;
+
+ private:
+  std::unique_ptr<FieldTypeMap> compute_field_types(const DexType* type) const;
+
  private:
-  UniquePointerConcurrentMap<const DexType*, FieldTypeMap> field_cache_;
+  const ClassHierarchies& class_hierarchies_;
+  // Fields declared in each class, ignoring the class hierarchy.
+  ConcurrentMap<const DexType*, FieldNameToTypeMap> fields_in_class_;
+  mutable UniquePointerConcurrentMap<const DexType*, FieldTypeMap> field_cache_;
+  mutable ConcurrentMap<const DexType*, std::shared_ptr<const Types>>
+      singleton_types_;
+  using PathKey = std::pair<const Types*, const DexString*>;
+  mutable ConcurrentMap<
+      PathKey,
+      std::shared_ptr<const Types>,
+      boost::hash<PathKey>>
+      path_field_types_;
   Types empty_types_;
 };
 
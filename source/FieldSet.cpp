@@ -5,6 +5,8 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <vector>
+
 #include <Show.h>
 
 #include <mariana-trench/FieldSet.h>
@@ -87,11 +89,11 @@ void FieldSet::difference_with(const FieldSet& other) {
 }
 
 FieldSet FieldSet::from_json(const Json::Value& value, Context& context) {
-  FieldSet fields;
+  std::vector<const Field*> fields;
   for (const auto& field_value : JsonValidation::null_or_array(value)) {
-    fields.add(Field::from_json(field_value, context));
+    fields.push_back(Field::from_json(field_value, context));
   }
-  return fields;
+  return FieldSet(Set(fields.begin(), fields.end()));
 }
 
 Json::Value FieldSet::to_json() const {
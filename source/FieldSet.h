@@ -13,16 +13,29 @@
 #include <json/json.h>
 
 #include <AbstractDomain.h>
-#include <PatriciaTreeSet.h>
 
 #include <mariana-trench/Assert.h>
 #include <mariana-trench/Field.h>
+#include <mariana-trench/IdSet.h>
 
 namespace marianatrench {
 
+/**
+ * A set of fields, e.g field origins of taint.
+ *
+ * Fields are stored by identifier (see `IdSet`), hence a set must only hold
+ * fields of a single `Fields` factory. Fields are iterated in the order of
+ * their identifiers.
+ */
 class FieldSet final : public sparta::AbstractDomain<FieldSet> {
  private:
-  using Set = sparta::PatriciaTreeSet<const Field*>;
+  struct FieldId {
+    std::size_t operator()(const Field* field) const {
+      return field->id();
+    }
+  };
+
+  using Set = IdSet<Field, FieldId>;
 
  public:
   // C++ container concept member types
@@ -5,11 +5,15 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <utility>
+#include <vector>
+
 #include <fmt/format.h>
 #include <fmt/ostream.h>
 
 #include <DexClass.h>
 #include <DexStore.h>
+#include <SpartaWorkQueue.h>
 #include <Walkers.h>
 
 #include <mariana-trench/Assert.h>
@@ -19,10 +23,23 @@ namespace marianatrench {
 
 Fields::Fields() = default;
 Fields::Fields(const DexStoresVector& stores) {
+  std::vector<DexField*> dex_fields;
   for (auto& scope : DexStoreClassesIterator(stores)) {
-    walk::parallel::fields(
-        scope, [&](DexField* field) { set_.insert(Field(field)); });
+    walk::fields(scope, [&](DexField* field) { dex_fields.push_back(field); });
+  }
+
+  fields_.resize(dex_fields.size(), nullptr);
+  auto queue = sparta::work_queue<std::size_t>(
+      [&](std::size_t index) {
+        auto field = Field(dex_fields[index]);
+        field.id_ = index;
+        fields_[index] = set_.insert(std::move(field)).first;
+      },
+      sparta::parallel::default_num_threads());
+  for (std::size_t index = 0; index < dex_fields.size(); index++) {
+    queue.add_item(index);
   }
+  queue.run_all();
 }
 
 const Field* Fields::get(const DexField* field) const {
@@ -36,15 +53,15 @@ const Field* Fields::get(const DexField* field) const {
 }
 
 Fields::Iterator Fields::begin() const {
-  return boost::make_transform_iterator(set_.cbegin(), GetPointer());
+  return fields_.cbegin();
 }
 
 Fields::Iterator Fields::end() const {
-  return boost::make_transform_iterator(set_.cend(), GetPointer());
+  return fields_.cend();
 }
 
 std::size_t Fields::size() const {
-  return set_.size();
+  return fields_.size();
 }
 
 } // namespace marianatrench
@@ -7,7 +7,7 @@
 
 #pragma once
 
-#include <boost/iterator/transform_iterator.hpp>
+#include <vector>
 
 #include <ConcurrentContainers.h>
 #include <DexClass.h>
@@ -19,20 +19,17 @@ namespace marianatrench {
 
 /**
  * The Field factory.
+ *
+ * Each field is assigned a dense identifier (see `Field::id`). Fields are
+ * iterated in dex order (by class, then field), which is also the order of
+ * their identifiers, hence it is deterministic.
  */
 class Fields final {
  private:
   using Set = InsertOnlyConcurrentSet<Field>;
 
-  struct GetPointer {
-    const Field* operator()(const Field& field) const {
-      return &field;
-    }
-  };
-
  public:
-  using Iterator =
-      boost::transform_iterator<GetPointer, typename Set::const_iterator>;
+  using Iterator = std::vector<const Field*>::const_iterator;
 
  public:
   Fields();
@@ -55,6 +52,7 @@ class Fields final {
 
  private:
   Set set_;
+  std::vector<const Field*> fields_;
 };
 
 } // namespace marianatrench
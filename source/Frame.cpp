@@ -16,12 +16,47 @@
 
 namespace marianatrench {
 
+std::shared_ptr<Frame::ColdFields> Frame::make_cold_fields(
+    MethodSet origins,
+    FieldSet field_origins,
+    FeatureSet user_features,
+    LocalPositionSet local_positions,
+    CanonicalNameSetAbstractDomain canonical_names) {
+  const auto& empty = empty_cold_fields();
+  if (origins == empty.origins && field_origins == empty.field_origins &&
+      user_features == empty.user_features &&
+      local_positions == empty.local_positions &&
+      canonical_names == empty.canonical_names) {
+    return nullptr;
+  }
+  return std::make_shared<ColdFields>(ColdFields{
+      std::move(origins),
+      std::move(field_origins),
+      std::move(user_features),
+      std::move(local_positions),
+      std::move(canonical_names)});
+}
+
+const Frame::ColdFields& Frame::empty_cold_fields() {
+  static const ColdFields empty;
+  return empty;
+}
+
+Frame::ColdFields& Frame::mutable_cold() {
+  if (cold_ == nullptr) {
+    cold_ = std::make_shared<ColdFields>();
+  } else if (cold_.use_count() > 1) {
+    cold_ = std::make_shared<ColdFields>(*cold_);
+  }
+  return *cold_;
+}
+
 void Frame::set_origins(const MethodSet& origins) {
-  origins_ = origins;
+  mutable_cold().origins = origins;
 }
 
 void Frame::set_field_origins(const FieldSet& field_origins) {
-  field_origins_ = field_origins;
+  mutable_cold().field_origins = field_origins;
 }
 
 void Frame::add_inferred_features(const FeatureMayAlwaysSet& features) {
@@ -33,21 +68,21 @@ FeatureMayAlwaysSet Frame::features() const {
   features.add(locally_inferred_features_);
 
   if (features.is_bottom()) {
-    return FeatureMayAlwaysSet::make_always(user_features_);
+    return FeatureMayAlwaysSet::make_always(user_features());
   }
 
-  features.add_always(user_features_);
+  features.add_always(user_features());
   mt_assert(!features.is_bottom());
   return features;
 }
 
 void Frame::add_local_position(const Position* position) {
-  local_positions_.add(position);
+  mutable_cold().local_positions.add(position);
 }
 
 void Frame::set_local_positions(LocalPositionSet positions) {
   mt_assert(!positions.is_bottom());
-  local_positions_ = std::move(positions);
+  mutable_cold().local_positions = std::move(positions);
 }
 
 bool Frame::leq(const Frame& other) const {
@@ -57,18 +92,20 @@ bool Frame::leq(const Frame& other) const {
     return false;
   } else {
     return kind_ == other.kind_ &&
-        (is_artificial_source() ? callee_port_.leq(other.callee_port_)
+        (is_artificial_source() ? callee_port_->leq(*other.callee_port_)
                                 : callee_port_ == other.callee_port_) &&
         callee_ == other.callee_ && call_position_ == other.call_position_ &&
-        distance_ >= other.distance_ && origins_.leq(other.origins_) &&
-        field_origins_.leq(other.field_origins_) &&
+        distance_ >= other.distance_ &&
         inferred_features_.leq(other.inferred_features_) &&
         locally_inferred_features_.leq(other.locally_inferred_features_) &&
-        user_features_.leq(other.user_features_) &&
         via_type_of_ports_.leq(other.via_type_of_ports_) &&
         via_value_of_ports_.leq(other.via_value_of_ports_) &&
-        local_positions_.leq(other.local_positions_) &&
-        canonical_names_.leq(other.canonical_names_);
+        (cold_ == other.cold_ ||
+         (origins().leq(other.origins()) &&
+          field_origins().leq(other.field_origins()) &&
+          user_features().leq(other.user_features()) &&
+          local_positions().leq(other.local_positions()) &&
+          canonical_names().leq(other.canonical_names())));
   }
 }
 
@@ -80,15 +117,17 @@ bool Frame::equals(const Frame& other) const {
   } else {
     return kind_ == other.kind_ && callee_port_ == other.callee_port_ &&
         callee_ == other.callee_ && call_position_ == other.call_position_ &&
-        distance_ == other.distance_ && origins_ == other.origins_ &&
-        field_origins_ == other.field_origins_ &&
+        distance_ == other.distance_ &&
         inferred_features_ == other.inferred_features_ &&
         locally_inferred_features_ == other.locally_inferred_features_ &&
-        user_features_ == other.user_features_ &&
         via_type_of_ports_ == other.via_type_of_ports_ &&
         via_value_of_ports_ == other.via_value_of_ports_ &&
-        local_positions_ == other.local_positions_ &&
-        canonical_names_ == other.canonical_names_;
+        (cold_ == other.cold_ ||
+         (origins() == other.origins() &&
+          field_origins() == other.field_origins() &&
+          user_features() == other.user_features() &&
+          local_positions() == other.local_positions() &&
+          canonical_names() == other.canonical_names()));
   }
 }
 
@@ -105,21 +144,37 @@ void Frame::join_with(const Frame& other) {
     mt_assert(call_position_ == other.call_position_);
 
     if (is_artificial_source()) {
-      callee_port_.join_with(other.callee_port_);
+      auto callee_port = *callee_port_;
+      callee_port.join_with(*other.callee_port_);
+      callee_port_ = AccessPathFactory::singleton().get(callee_port);
     } else {
       mt_assert(callee_port_ == other.callee_port_);
     }
 
     distance_ = std::min(distance_, other.distance_);
-    origins_.join_with(other.origins_);
-    field_origins_.join_with(other.field_origins_);
     inferred_features_.join_with(other.inferred_features_);
     locally_inferred_features_.join_with(other.locally_inferred_features_);
-    user_features_.join_with(other.user_features_);
     via_type_of_ports_.join_with(other.via_type_of_ports_);
     via_value_of_ports_.join_with(other.via_value_of_ports_);
-    local_positions_.join_with(other.local_positions_);
-    canonical_names_.join_with(other.canonical_names_);
+
+    // Cold fields are only copied when the join changes them.
+    if (cold_ != other.cold_ && other.cold_ != nullptr) {
+      if (cold_ == nullptr) {
+        cold_ = other.cold_;
+      } else if (
+          !other.origins().leq(origins()) ||
+          !other.field_origins().leq(field_origins()) ||
+          !other.user_features().leq(user_features()) ||
+          !other.local_positions().leq(local_positions()) ||
+          !other.canonical_names().leq(canonical_names())) {
+        auto& cold = mutable_cold();
+        cold.origins.join_with(other.origins());
+        cold.field_origins.join_with(other.field_origins());
+        cold.user_features.join_with(other.user_features());
+        cold.local_positions.join_with(other.local_positions());
+        cold.canonical_names.join_with(other.canonical_names());
+      }
+    }
   }
 
   mt_expensive_assert(previous.leq(*this) && other.leq(*this));
@@ -162,7 +217,9 @@ Frame Frame::artificial_source(AccessPath access_path) {
 }
 
 void Frame::callee_port_append(Path::Element path_element) {
-  callee_port_.append(path_element);
+  auto callee_port = *callee_port_;
+  callee_port.append(path_element);
+  callee_port_ = AccessPathFactory::singleton().get(callee_port);
 }
 
 Frame Frame::with_kind(const Kind* kind) const {
@@ -275,6 +332,10 @@ Frame Frame::from_json(const Json::Value& value, Context& context) {
 
   JsonValidation::null_or_array(value, /* field */ "origins");
   auto origins = MethodSet::from_json(value["origins"], context);
+  if (value.isMember("truncated_origins")) {
+    origins = MethodSet::truncated(static_cast<std::size_t>(
+        JsonValidation::integer(value, /* field */ "truncated_origins")));
+  }
 
   JsonValidation::null_or_array(value, /* field */ "field_origins");
   auto field_origins = FieldSet::from_json(value["field_origins"], context);
@@ -400,7 +461,7 @@ Json::Value Frame::to_json() const {
     value[member] = kind_json[member];
   }
 
-  value["callee_port"] = callee_port_.to_json();
+  value["callee_port"] = callee_port_->to_json();
 
   if (callee_ != nullptr) {
     value["callee"] = callee_->to_json();
@@ -416,12 +477,15 @@ Json::Value Frame::to_json() const {
     value["distance"] = Json::Value(distance_);
   }
 
-  if (!origins_.empty()) {
-    value["origins"] = origins_.to_json();
+  if (origins().is_top()) {
+    value["truncated_origins"] =
+        Json::Value(static_cast<Json::UInt64>(origins().truncated_size()));
+  } else if (!origins().empty()) {
+    value["origins"] = origins().to_json();
   }
 
-  if (!field_origins_.empty()) {
-    value["field_origins"] = field_origins_.to_json();
+  if (!field_origins().empty()) {
+    value["field_origins"] = field_origins().to_json();
   }
 
   JsonValidation::update_object(value, features().to_json());
@@ -448,16 +512,18 @@ Json::Value Frame::to_json() const {
     value["via_value_of"] = ports;
   }
 
-  if (local_positions_.is_value() && !local_positions_.empty()) {
-    value["local_positions"] = local_positions_.to_json();
+  const auto& local_positions = this->local_positions();
+  if (local_positions.is_value() && !local_positions.empty()) {
+    value["local_positions"] = local_positions.to_json();
   }
 
-  if (canonical_names_.is_value() && !canonical_names_.elements().empty()) {
-    auto canonical_names = Json::Value(Json::arrayValue);
-    for (const auto& canonical_name : canonical_names_.elements()) {
-      canonical_names.append(canonical_name.to_json());
+  const auto& canonical_names = this->canonical_names();
+  if (canonical_names.is_value() && !canonical_names.elements().empty()) {
+    auto canonical_names_value = Json::Value(Json::arrayValue);
+    for (const auto& canonical_name : canonical_names.elements()) {
+      canonical_names_value.append(canonical_name.to_json());
     }
-    value["canonical_names"] = canonical_names;
+    value["canonical_names"] = canonical_names_value;
   }
 
   return value;
@@ -468,7 +534,7 @@ bool Frame::GroupEqual::operator()(const Frame& left, const Frame& right)
   return left.kind() == right.kind() &&
       (left.is_artificial_source()
            ? left.callee_port().root() == right.callee_port().root()
-           : left.callee_port() == right.callee_port()) &&
+           : &left.callee_port() == &right.callee_port()) &&
       left.callee() == right.callee() &&
       left.call_position() == right.call_position();
 }
@@ -479,7 +545,7 @@ std::size_t Frame::GroupHash::operator()(const Frame& frame) const {
   if (frame.is_artificial_source()) {
     boost::hash_combine(seed, frame.callee_port().root().encode());
   } else {
-    boost::hash_combine(seed, std::hash<AccessPath>()(frame.callee_port()));
+    boost::hash_combine(seed, &frame.callee_port());
   }
   boost::hash_combine(seed, frame.callee());
   boost::hash_combine(seed, frame.call_position());
@@ -488,7 +554,7 @@ std::size_t Frame::GroupHash::operator()(const Frame& frame) const {
 
 std::ostream& operator<<(std::ostream& out, const Frame& frame) {
   out << "Frame(kind=`" << show(frame.kind_)
-      << "`, callee_port=" << frame.callee_port_;
+      << "`, callee_port=" << *frame.callee_port_;
   if (frame.callee_ != nullptr) {
     out << ", callee=`" << show(frame.callee_) << "`";
   } else if (frame.field_callee_ != nullptr) {
@@ -500,11 +566,11 @@ std::ostream& operator<<(std::ostream& out, const Frame& frame) {
   if (frame.distance_ != 0) {
     out << ", distance=" << frame.distance_;
   }
-  if (!frame.origins_.empty()) {
-    out << ", origins=" << frame.origins_;
+  if (!frame.origins().empty()) {
+    out << ", origins=" << frame.origins();
   }
-  if (!frame.field_origins_.empty()) {
-    out << ", field_origins=" << frame.field_origins_;
+  if (!frame.field_origins().empty()) {
+    out << ", field_origins=" << frame.field_origins();
   }
   if (!frame.inferred_features_.empty()) {
     out << ", inferred_features=" << frame.inferred_features_;
@@ -512,8 +578,8 @@ std::ostream& operator<<(std::ostream& out, const Frame& frame) {
   if (!frame.locally_inferred_features_.empty()) {
     out << ", locally_inferred_features=" << frame.locally_inferred_features_;
   }
-  if (!frame.user_features_.empty()) {
-    out << ", user_features=" << frame.user_features_;
+  if (!frame.user_features().empty()) {
+    out << ", user_features=" << frame.user_features();
   }
   if (frame.via_type_of_ports_.is_value() &&
       !frame.via_type_of_ports_.elements().empty()) {
@@ -523,12 +589,12 @@ std::ostream& operator<<(std::ostream& out, const Frame& frame) {
       !frame.via_value_of_ports_.elements().empty()) {
     out << ", via_value_of_ports=" << frame.via_value_of_ports_;
   }
-  if (!frame.local_positions_.empty()) {
-    out << ", local_positions=" << frame.local_positions_;
+  if (!frame.local_positions().empty()) {
+    out << ", local_positions=" << frame.local_positions();
   }
-  if (frame.canonical_names_.is_value() &&
-      !frame.canonical_names_.elements().empty()) {
-    out << ", canonical_names=" << frame.canonical_names_;
+  if (frame.canonical_names().is_value() &&
+      !frame.canonical_names().elements().empty()) {
+    out << ", canonical_names=" << frame.canonical_names();
   }
   return out << ")";
 }
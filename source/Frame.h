@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include <memory>
 #include <optional>
 #include <ostream>
 
@@ -16,6 +17,7 @@
 #include <HashedSetAbstractDomain.h>
 
 #include <mariana-trench/Access.h>
+#include <mariana-trench/AccessPathFactory.h>
 #include <mariana-trench/Assert.h>
 #include <mariana-trench/CanonicalName.h>
 #include <mariana-trench/Compiler.h>
@@ -96,7 +98,7 @@ class Frame final : public sparta::AbstractDomain<Frame> {
   /* Create the bottom frame. */
   explicit Frame()
       : kind_(nullptr),
-        callee_port_(Root(Root::Kind::Leaf)),
+        callee_port_(AccessPathFactory::singleton().leaf()),
         callee_(nullptr),
         call_position_(nullptr),
         distance_(0) {}
@@ -118,23 +120,24 @@ class Frame final : public sparta::AbstractDomain<Frame> {
       LocalPositionSet local_positions,
       CanonicalNameSetAbstractDomain canonical_names)
       : kind_(kind),
-        callee_port_(std::move(callee_port)),
+        callee_port_(AccessPathFactory::singleton().get(callee_port)),
         callee_(callee),
         field_callee_(field_callee),
         call_position_(call_position),
         distance_(distance),
-        origins_(std::move(origins)),
-        field_origins_(std::move(field_origins)),
         inferred_features_(std::move(inferred_features)),
         locally_inferred_features_(std::move(locally_inferred_features)),
-        user_features_(std::move(user_features)),
         via_type_of_ports_(std::move(via_type_of_ports)),
         via_value_of_ports_(std::move(via_value_of_ports)),
-        local_positions_(std::move(local_positions)),
-        canonical_names_(std::move(canonical_names)) {
+        cold_(make_cold_fields(
+            std::move(origins),
+            std::move(field_origins),
+            std::move(user_features),
+            std::move(local_positions),
+            std::move(canonical_names))) {
     mt_assert(kind_ != nullptr);
     mt_assert(distance_ >= 0);
-    mt_assert(!local_positions_.is_bottom());
+    mt_assert(!this->local_positions().is_bottom());
     mt_assert(!(callee && field_callee));
   }
 
@@ -205,8 +208,9 @@ class Frame final : public sparta::AbstractDomain<Frame> {
     return kind_;
   }
 
+  /* The returned reference is unique for a given access path. */
   const AccessPath& callee_port() const {
-    return callee_port_;
+    return *callee_port_;
   }
 
   /* Return the callee, or `nullptr` if this is a leaf frame. */
@@ -238,18 +242,18 @@ class Frame final : public sparta::AbstractDomain<Frame> {
   }
 
   const CanonicalNameSetAbstractDomain& canonical_names() const {
-    return canonical_names_;
+    return cold().canonical_names;
   }
 
   void set_origins(const MethodSet& origins);
   void set_field_origins(const FieldSet& field_origins);
 
   const MethodSet& origins() const {
-    return origins_;
+    return cold().origins;
   }
 
   const FieldSet& field_origins() const {
-    return field_origins_;
+    return cold().field_origins;
   }
 
   /**
@@ -267,7 +271,7 @@ class Frame final : public sparta::AbstractDomain<Frame> {
   }
 
   const FeatureSet& user_features() const {
-    return user_features_;
+    return cold().user_features;
   }
 
   FeatureMayAlwaysSet features() const;
@@ -277,7 +281,7 @@ class Frame final : public sparta::AbstractDomain<Frame> {
   void set_local_positions(LocalPositionSet positions);
 
   const LocalPositionSet& local_positions() const {
-    return local_positions_;
+    return cold().local_positions;
   }
 
   static Frame bottom() {
@@ -304,7 +308,7 @@ class Frame final : public sparta::AbstractDomain<Frame> {
     // If true, this frame corresponds to the crtex leaf frame declared by
     // the user (callee == nullptr). Also, the producer run declarations use the
     // `Anchor` port, while consumer runs use the `Producer` port.
-    return callee_ == nullptr && callee_port_.root().is_anchor();
+    return callee_ == nullptr && callee_port_->root().is_anchor();
   }
 
   void set_to_bottom() override {
@@ -363,22 +367,49 @@ class Frame final : public sparta::AbstractDomain<Frame> {
 
   friend std::ostream& operator<<(std::ostream& out, const Frame& frame);
 
+ private:
+  /**
+   * Fields that are rarely read during the fixpoint and mostly matter for the
+   * output. They are stored behind a shared pointer, hence copying a frame
+   * does not copy them, and they are copied on write when the pointer is
+   * shared. A null pointer stands for the default (empty) fields.
+   */
+  struct ColdFields {
+    MethodSet origins;
+    FieldSet field_origins;
+    FeatureSet user_features;
+    LocalPositionSet local_positions;
+    CanonicalNameSetAbstractDomain canonical_names;
+  };
+
+  static std::shared_ptr<ColdFields> make_cold_fields(
+      MethodSet origins,
+      FieldSet field_origins,
+      FeatureSet user_features,
+      LocalPositionSet local_positions,
+      CanonicalNameSetAbstractDomain canonical_names);
+
+  static const ColdFields& empty_cold_fields();
+
+  const ColdFields& cold() const {
+    return cold_ != nullptr ? *cold_ : empty_cold_fields();
+  }
+
+  ColdFields& mutable_cold();
+
  private:
   const Kind* MT_NULLABLE kind_;
-  AccessPath callee_port_;
+  // Interned, see `AccessPathFactory`.
+  const AccessPath* callee_port_;
   const Method* MT_NULLABLE callee_;
   const Field* MT_NULLABLE field_callee_;
   const Position* MT_NULLABLE call_position_;
   int distance_;
-  MethodSet origins_;
-  FieldSet field_origins_;
   FeatureMayAlwaysSet inferred_features_;
   FeatureMayAlwaysSet locally_inferred_features_;
-  FeatureSet user_features_;
   RootSetAbstractDomain via_type_of_ports_;
   RootSetAbstractDomain via_value_of_ports_;
-  LocalPositionSet local_positions_;
-  CanonicalNameSetAbstractDomain canonical_names_;
+  std::shared_ptr<ColdFields> cold_;
 };
 
 } // namespace marianatrench
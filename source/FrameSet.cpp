@@ -105,30 +105,6 @@ void FrameSet::difference_with(const FrameSet& other) {
       });
 }
 
-void FrameSet::map(const std::function<void(Frame&)>& f) {
-  map_.map([&](const CallPositionToSetMap& position_map) {
-    auto position_map_copy = position_map;
-    position_map_copy.map([&](const Set& set) {
-      auto set_copy = set;
-      set_copy.map(f);
-      return set_copy;
-    });
-    return position_map_copy;
-  });
-}
-
-void FrameSet::filter(const std::function<bool(const Frame&)>& predicate) {
-  map_.map([&](const CallPositionToSetMap& position_map) {
-    auto position_map_copy = position_map;
-    position_map_copy.map([&](const Set& set) {
-      auto set_copy = set;
-      set_copy.filter(predicate);
-      return set_copy;
-    });
-    return position_map_copy;
-  });
-}
-
 void FrameSet::add_inferred_features(const FeatureMayAlwaysSet& features) {
   if (features.empty()) {
     return;
@@ -175,15 +151,31 @@ void FrameSet::add_inferred_features_and_local_position(
 }
 
 FrameSet FrameSet::propagate(
-    const Method* /*caller*/,
+    const Method* caller,
     const Method* callee,
     const AccessPath& callee_port,
     const Position* call_position,
     int maximum_source_sink_distance,
     Context& context,
     const std::vector<const DexType * MT_NULLABLE>& source_register_types,
-    const std::vector<std::optional<std::string>>& source_constant_arguments)
+    const std::vector<const DexString * MT_NULLABLE>& source_constant_arguments)
     const {
+  return propagate(
+      callee_port,
+      CallSiteContext(
+          caller,
+          callee,
+          call_position,
+          maximum_source_sink_distance,
+          /* extra_features */ FeatureMayAlwaysSet::bottom(),
+          context,
+          source_register_types,
+          source_constant_arguments));
+}
+
+FrameSet FrameSet::propagate(
+    const AccessPath& callee_port,
+    const CallSiteContext& call_site) const {
   if (is_bottom()) {
     return FrameSet::bottom();
   }
@@ -191,25 +183,15 @@ FrameSet FrameSet::propagate(
   auto partitioned = partition_map<bool>(
       [](const Frame& frame) { return frame.is_crtex_producer_declaration(); });
 
-  auto frames = propagate_crtex_frames(
-      callee,
-      callee_port,
-      call_position,
-      maximum_source_sink_distance,
-      context,
-      source_register_types,
-      partitioned[true]);
+  auto frames =
+      propagate_crtex_frames(callee_port, call_site, partitioned[true]);
 
   // Non-CRTEX frames can be joined into the same callee
   std::vector<const Feature*> via_type_of_features_added;
   auto non_crtex_frame = propagate_frames(
-      callee,
       callee_port,
-      call_position,
-      maximum_source_sink_distance,
-      context,
-      source_register_types,
-      source_constant_arguments,
+      call_site,
+      /* materialize_via_value_of_ports */ true,
       partitioned[false],
       via_type_of_features_added);
   if (!non_crtex_frame.is_bottom()) {
@@ -330,10 +312,8 @@ std::ostream& operator<<(std::ostream& out, const FrameSet& frames) {
 namespace {
 
 void materialize_via_type_of_ports(
-    const Method* callee,
-    Context& context,
+    const CallSiteContext& call_site,
     const Frame& frame,
-    const std::vector<const DexType * MT_NULLABLE>& source_register_types,
     std::vector<const Feature*>& via_type_of_features_added,
     FeatureMayAlwaysSet& inferred_features) {
   if (!frame.via_type_of_ports().is_value() ||
@@ -344,28 +324,18 @@ void materialize_via_type_of_ports(
   // Materialize via_type_of_ports into features and add them to the inferred
   // features
   for (const auto& port : frame.via_type_of_ports().elements()) {
-    if (!port.is_argument() ||
-        port.parameter_position() >= source_register_types.size()) {
-      ERROR(
-          1,
-          "Invalid port {} provided for via_type_of ports of method {}.{}",
-          port,
-          callee->get_class()->str(),
-          callee->get_name());
+    const auto* feature = call_site.via_type_of_feature(port);
+    if (feature == nullptr) {
       continue;
     }
-    const auto* feature = context.features->get_via_type_of_feature(
-        source_register_types[port.parameter_position()]);
     via_type_of_features_added.push_back(feature);
     inferred_features.add_always(feature);
   }
 }
 
 void materialize_via_value_of_ports(
-    const Method* callee,
-    Context& context,
+    const CallSiteContext& call_site,
     const Frame& frame,
-    const std::vector<std::optional<std::string>>& source_constant_arguments,
     FeatureMayAlwaysSet& inferred_features) {
   if (!frame.via_value_of_ports().is_value() ||
       frame.via_value_of_ports().elements().empty()) {
@@ -375,18 +345,10 @@ void materialize_via_value_of_ports(
   // Materialize via_value_of_ports into features and add them to the inferred
   // features
   for (const auto& port : frame.via_value_of_ports().elements()) {
-    if (!port.is_argument() ||
-        port.parameter_position() >= source_constant_arguments.size()) {
-      ERROR(
-          1,
-          "Invalid port {} provided for via_value_of ports of method {}.{}",
-          port,
-          callee->get_class()->str(),
-          callee->get_name());
+    const auto* feature = call_site.via_value_of_feature(port);
+    if (feature == nullptr) {
       continue;
     }
-    const auto* feature = context.features->get_via_value_of_feature(
-        source_constant_arguments[port.parameter_position()]);
     inferred_features.add_always(feature);
   }
 }
@@ -394,14 +356,10 @@ void materialize_via_value_of_ports(
 } // namespace
 
 Frame FrameSet::propagate_frames(
-    const Method* callee,
     const AccessPath& callee_port,
-    const Position* call_position,
-    int maximum_source_sink_distance,
-    Context& context,
-    const std::vector<const DexType * MT_NULLABLE>& source_register_types,
-    const std::vector<std::optional<std::string>>& source_constant_arguments,
-    std::vector<std::reference_wrapper<const Frame>> frames,
+    const CallSiteContext& call_site,
+    bool materialize_via_value_of_ports,
+    const std::vector<std::reference_wrapper<const Frame>>& frames,
     std::vector<const Feature*>& via_type_of_features_added) const {
   int distance = std::numeric_limits<int>::max();
   auto origins = MethodSet::bottom();
@@ -409,7 +367,7 @@ Frame FrameSet::propagate_frames(
   auto inferred_features = FeatureMayAlwaysSet::bottom();
 
   for (const Frame& frame : frames) {
-    if (frame.distance() >= maximum_source_sink_distance) {
+    if (frame.distance() >= call_site.maximum_source_sink_distance()) {
       continue;
     }
 
@@ -421,15 +379,11 @@ Frame FrameSet::propagate_frames(
     inferred_features.join_with(frame.features());
 
     materialize_via_type_of_ports(
-        callee,
-        context,
-        frame,
-        source_register_types,
-        via_type_of_features_added,
-        inferred_features);
-
-    materialize_via_value_of_ports(
-        callee, context, frame, source_constant_arguments, inferred_features);
+        call_site, frame, via_type_of_features_added, inferred_features);
+
+    if (materialize_via_value_of_ports) {
+      materialize_via_value_of_ports(call_site, frame, inferred_features);
+    }
   }
 
   if (distance == std::numeric_limits<int>::max()) {
@@ -439,10 +393,10 @@ Frame FrameSet::propagate_frames(
   return Frame(
       kind_,
       callee_port,
-      callee,
+      call_site.callee(),
       /* field_callee */ nullptr, // Since propagate is only called at method
                                   // callsites and not field accesses
-      call_position,
+      call_site.call_position(),
       distance,
       std::move(origins),
       std::move(field_origins),
@@ -456,25 +410,18 @@ Frame FrameSet::propagate_frames(
 }
 
 FrameSet FrameSet::propagate_crtex_frames(
-    const Method* callee,
     const AccessPath& callee_port,
-    const Position* call_position,
-    int maximum_source_sink_distance,
-    Context& context,
-    const std::vector<const DexType * MT_NULLABLE>& source_register_types,
-    std::vector<std::reference_wrapper<const Frame>> frames) const {
+    const CallSiteContext& call_site,
+    const std::vector<std::reference_wrapper<const Frame>>& frames) const {
   FrameSet result;
 
   for (const Frame& frame : frames) {
     std::vector<const Feature*> via_type_of_features_added;
     auto propagated = propagate_frames(
-        callee,
         callee_port,
-        call_position,
-        maximum_source_sink_distance,
-        context,
-        source_register_types,
-        {}, // TODO: Support via-value-of for crtex frames
+        call_site,
+        // TODO: Support via-value-of for crtex frames
+        /* materialize_via_value_of_ports */ false,
         {std::cref(frame)},
         via_type_of_features_added);
 
@@ -15,6 +15,7 @@
 #include <AbstractDomain.h>
 #include <PatriciaTreeMapAbstractPartition.h>
 
+#include <mariana-trench/CallSiteContext.h>
 #include <mariana-trench/FlattenIterator.h>
 #include <mariana-trench/Frame.h>
 #include <mariana-trench/GroupHashedSetAbstractDomain.h>
@@ -147,9 +148,31 @@ class FrameSet final : public sparta::AbstractDomain<FrameSet> {
 
   void difference_with(const FrameSet& other);
 
-  void map(const std::function<void(Frame&)>& f);
+  template <typename Function> // void(Frame&)
+  void map(Function&& f) {
+    map_.map([&](const CallPositionToSetMap& position_map) {
+      auto position_map_copy = position_map;
+      position_map_copy.map([&](const Set& set) {
+        auto set_copy = set;
+        set_copy.map(f);
+        return set_copy;
+      });
+      return position_map_copy;
+    });
+  }
 
-  void filter(const std::function<bool(const Frame&)>& predicate);
+  template <typename Predicate> // bool(const Frame&)
+  void filter(Predicate&& predicate) {
+    map_.map([&](const CallPositionToSetMap& position_map) {
+      auto position_map_copy = position_map;
+      position_map_copy.map([&](const Set& set) {
+        auto set_copy = set;
+        set_copy.filter(predicate);
+        return set_copy;
+      });
+      return position_map_copy;
+    });
+  }
 
   ConstIterator begin() const {
     return ConstIterator(map_.bindings().begin(), map_.bindings().end());
@@ -184,9 +207,18 @@ class FrameSet final : public sparta::AbstractDomain<FrameSet> {
       int maximum_source_sink_distance,
       Context& context,
       const std::vector<const DexType * MT_NULLABLE>& source_register_types,
-      const std::vector<std::optional<std::string>>& source_constant_arguments)
+      const std::vector<const DexString * MT_NULLABLE>&
+          source_constant_arguments)
       const;
 
+  /**
+   * Propagate the taint from the callee to the caller, sharing the per-call
+   * site information between all frames.
+   */
+  FrameSet propagate(
+      const AccessPath& callee_port,
+      const CallSiteContext& call_site) const;
+
   /* Return the set of leaf frames with the given position. */
   FrameSet attach_position(const Position* position) const;
 
@@ -208,24 +240,16 @@ class FrameSet final : public sparta::AbstractDomain<FrameSet> {
 
  private:
   Frame propagate_frames(
-      const Method* callee,
       const AccessPath& callee_port,
-      const Position* call_position,
-      int maximum_source_sink_distance,
-      Context& context,
-      const std::vector<const DexType * MT_NULLABLE>& source_register_types,
-      const std::vector<std::optional<std::string>>& source_constant_arguments,
-      std::vector<std::reference_wrapper<const Frame>> frames,
+      const CallSiteContext& call_site,
+      bool materialize_via_value_of_ports,
+      const std::vector<std::reference_wrapper<const Frame>>& frames,
       std::vector<const Feature*>& via_type_of_features_added) const;
 
   FrameSet propagate_crtex_frames(
-      const Method* callee,
       const AccessPath& callee_port,
-      const Position* call_position,
-      int maximum_source_sink_distance,
-      Context& context,
-      const std::vector<const DexType * MT_NULLABLE>& source_register_types,
-      std::vector<std::reference_wrapper<const Frame>> frames) const;
+      const CallSiteContext& call_site,
+      const std::vector<std::reference_wrapper<const Frame>>& frames) const;
 
  private:
   const Kind* MT_NULLABLE kind_;
@@ -34,6 +34,14 @@ class FulfilledPartialKindState final {
       delete;
   FulfilledPartialKindState& operator=(FulfilledPartialKindState&&) = delete;
 
+  /**
+   * Return true if no partial kind was fulfilled. The state does not allocate
+   * until then.
+   */
+  bool empty() const {
+    return map_.empty();
+  }
+
   /**
    * Called when sink `kind` is fulfilled under `rule`, i.e. has a matching
    * source flow into the sink as defined by the rule.
@@ -7,12 +7,15 @@
 
 #pragma once
 
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <memory>
 #include <ostream>
 #include <type_traits>
 #include <unordered_set>
 #include <utility>
-
-#include <boost/iterator/transform_iterator.hpp>
+#include <vector>
 
 #include <AbstractDomain.h>
 
@@ -27,11 +30,15 @@ namespace detail {
  * reference on a constant instance. This is a type safe alternative to
  * `const_cast`, since mutating a reference produced by `const_cast` is
  * undefined behavior.
+ *
+ * The group hash of the value is computed once, on construction. The value
+ * must not be mutated in a way that changes its group.
  */
-template <typename Value>
+template <typename Value, typename Hash>
 class MutableValue {
  public:
-  explicit MutableValue(Value value) : value_(std::move(value)) {}
+  explicit MutableValue(Value value)
+      : value_(std::move(value)), hash_(Hash()(value_)) {}
   MutableValue(const MutableValue&) = default;
   MutableValue(MutableValue&&) = default;
   MutableValue& operator=(const MutableValue&) = default;
@@ -50,8 +57,13 @@ class MutableValue {
     return value_;
   }
 
+  std::size_t hash() const {
+    return hash_;
+  }
+
  private:
   mutable Value value_;
+  std::size_t hash_;
 };
 
 template <typename Element>
@@ -70,6 +82,15 @@ struct GroupDifference {
  *
  * `GroupHash` and `GroupEqual` describe how elements are grouped together.
  *
+ * Most sets only contain a few groups, hence groups are stored in a flat
+ * vector and looked up linearly until there are more than `kMaxFlatSize` of
+ * them. Past that threshold, the set switches to a hash table. This avoids a
+ * hash table allocation per set and makes small sets cache friendly.
+ *
+ * Each stored element carries its group hash, computed when it is inserted,
+ * hence rehashing, lookups in the flat vector and joins do not call
+ * `GroupHash` again on stored elements.
+ *
  * The implementation is mostly based on `sparta::HashedSetAbstractDomain`.
  */
 template <
@@ -98,33 +119,84 @@ class GroupHashedSetAbstractDomain final
                     std::declval<const Element>())),
                 void>);
 
+  /* Maximum number of groups stored in the flat representation. */
+  constexpr static std::size_t kMaxFlatSize = 4;
+
  private:
-  using MutableElement = detail::MutableValue<Element>;
+  using MutableElement = detail::MutableValue<Element, GroupHash>;
 
   struct MutableElementHash {
     std::size_t operator()(const MutableElement& element) const {
-      return GroupHash()(element.get());
+      return element.hash();
     }
   };
 
   struct MutableElementEqual {
     bool operator()(const MutableElement& left, const MutableElement& right)
         const {
-      return GroupEqual()(left.get(), right.get());
-    }
-  };
-
-  struct ExposeElement {
-    const Element& operator()(const MutableElement& element) const {
-      return element.get();
+      return left.hash() == right.hash() &&
+          GroupEqual()(left.get(), right.get());
     }
   };
 
+  using Vector = std::vector<MutableElement>;
   using Set = std::
       unordered_set<MutableElement, MutableElementHash, MutableElementEqual>;
 
-  using ConstIterator =
-      boost::transform_iterator<ExposeElement, typename Set::const_iterator>;
+  /* Iterator on either representation. */
+  class ConstIterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = Element;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const Element*;
+    using reference = const Element&;
+
+    ConstIterator() = default;
+
+    explicit ConstIterator(typename Vector::const_iterator iterator)
+        : flat_(true), vector_iterator_(iterator) {}
+
+    explicit ConstIterator(typename Set::const_iterator iterator)
+        : flat_(false), set_iterator_(iterator) {}
+
+    reference operator*() const {
+      return flat_ ? vector_iterator_->get() : set_iterator_->get();
+    }
+
+    pointer operator->() const {
+      return &**this;
+    }
+
+    ConstIterator& operator++() {
+      if (flat_) {
+        ++vector_iterator_;
+      } else {
+        ++set_iterator_;
+      }
+      return *this;
+    }
+
+    ConstIterator operator++(int) {
+      auto result = *this;
+      ++*this;
+      return result;
+    }
+
+    bool operator==(const ConstIterator& other) const {
+      return flat_ ? vector_iterator_ == other.vector_iterator_
+                   : set_iterator_ == other.set_iterator_;
+    }
+
+    bool operator!=(const ConstIterator& other) const {
+      return !(*this == other);
+    }
+
+   private:
+    bool flat_ = true;
+    typename Vector::const_iterator vector_iterator_;
+    typename Set::const_iterator set_iterator_;
+  };
 
  public:
   // C++ container concept member types
@@ -151,10 +223,21 @@ class GroupHashedSetAbstractDomain final
     }
   }
 
-  GroupHashedSetAbstractDomain(const GroupHashedSetAbstractDomain&) = default;
+  GroupHashedSetAbstractDomain(const GroupHashedSetAbstractDomain& other)
+      : vector_(other.vector_),
+        set_(other.set_ ? std::make_unique<Set>(*other.set_) : nullptr) {}
+
   GroupHashedSetAbstractDomain(GroupHashedSetAbstractDomain&&) = default;
-  GroupHashedSetAbstractDomain& operator=(const GroupHashedSetAbstractDomain&) =
-      default;
+
+  GroupHashedSetAbstractDomain& operator=(
+      const GroupHashedSetAbstractDomain& other) {
+    if (this != &other) {
+      vector_ = other.vector_;
+      set_ = other.set_ ? std::make_unique<Set>(*other.set_) : nullptr;
+    }
+    return *this;
+  }
+
   GroupHashedSetAbstractDomain& operator=(GroupHashedSetAbstractDomain&&) =
       default;
 
@@ -167,7 +250,7 @@ class GroupHashedSetAbstractDomain final
   }
 
   bool is_bottom() const override {
-    return set_.empty();
+    return empty();
   }
 
   bool is_top() const override {
@@ -175,7 +258,7 @@ class GroupHashedSetAbstractDomain final
   }
 
   void set_to_bottom() override {
-    set_.clear();
+    clear();
   }
 
   void set_to_top() override {
@@ -183,19 +266,20 @@ class GroupHashedSetAbstractDomain final
   }
 
   std::size_t size() const {
-    return set_.size();
+    return set_ ? set_->size() : vector_.size();
   }
 
   bool empty() const {
-    return set_.empty();
+    return size() == 0;
   }
 
   ConstIterator begin() const {
-    return boost::make_transform_iterator(set_.cbegin(), ExposeElement());
+    return set_ ? ConstIterator(set_->cbegin())
+                : ConstIterator(vector_.cbegin());
   }
 
   ConstIterator end() const {
-    return boost::make_transform_iterator(set_.cend(), ExposeElement());
+    return set_ ? ConstIterator(set_->cend()) : ConstIterator(vector_.cend());
   }
 
   bool contains(const Element& element) const {
@@ -203,8 +287,8 @@ class GroupHashedSetAbstractDomain final
       return true;
     }
 
-    auto found = set_.find(MutableElement(element));
-    return found != set_.end() && element.leq(found->get());
+    const auto* found = find(element);
+    return found != nullptr && element.leq(found->get());
   }
 
   void add(const Element& element) {
@@ -212,11 +296,7 @@ class GroupHashedSetAbstractDomain final
       return;
     }
 
-    auto result = set_.emplace(element);
-    if (!result.second) {
-      // This is safe as long as `join_with` does not change the grouping
-      result.first->get_unsafe().join_with(element);
-    }
+    insert_or_join(MutableElement(element));
   }
 
   void remove(const Element& element) {
@@ -224,52 +304,46 @@ class GroupHashedSetAbstractDomain final
       return;
     }
 
-    auto found = set_.find(MutableElement(element));
-    if (found != set_.end() && found->get().leq(element)) {
-      set_.erase(found);
+    const auto* found = find(element);
+    if (found != nullptr && found->get().leq(element)) {
+      erase(found);
     }
   }
 
   void clear() {
-    set_.clear();
+    vector_.clear();
+    set_ = nullptr;
   }
 
   bool leq(const GroupHashedSetAbstractDomain& other) const override {
-    if (set_.size() > other.set_.size()) {
+    if (size() > other.size()) {
       return false;
     }
-    for (const MutableElement& mutable_element : set_) {
-      const Element& element = mutable_element.get();
-      auto found = other.set_.find(mutable_element);
-      if (found == other.set_.end() || !element.leq(found->get())) {
-        return false;
-      }
-    }
-    return true;
+    return all_of_stored([&](const MutableElement& element) {
+      const auto* found = other.find(element);
+      return found != nullptr && element.get().leq(found->get());
+    });
   }
 
   bool equals(const GroupHashedSetAbstractDomain& other) const override {
-    if (set_.size() != other.set_.size()) {
+    if (size() != other.size()) {
       return false;
     }
-    for (const MutableElement& mutable_element : set_) {
-      const Element& element = mutable_element.get();
-      auto found = other.set_.find(mutable_element);
-      if (found == other.set_.end() || !(element == found->get())) {
-        return false;
-      }
-    }
-    return true;
+    return all_of_stored([&](const MutableElement& element) {
+      const auto* found = other.find(element);
+      return found != nullptr && element.get() == found->get();
+    });
   }
 
   void join_with(const GroupHashedSetAbstractDomain& other) override {
-    for (const MutableElement& mutable_element : other.set_) {
-      auto result = set_.insert(mutable_element);
-      if (!result.second) {
-        // This is safe as long as `join_with` does not change the grouping.
-        result.first->get_unsafe().join_with(mutable_element.get());
-      }
+    if (empty()) {
+      *this = other;
+      return;
     }
+    other.all_of_stored([&](const MutableElement& element) {
+      insert_or_join(element);
+      return true;
+    });
   }
 
   void widen_with(const GroupHashedSetAbstractDomain& other) override {
@@ -286,59 +360,47 @@ class GroupHashedSetAbstractDomain final
 
   void difference_with(const GroupHashedSetAbstractDomain& other) {
     // For performance, we iterate on the smallest set.
-    if (set_.size() <= other.set_.size()) {
-      for (auto iterator = set_.begin(), end = set_.end(); iterator != end;) {
-        auto found = other.set_.find(*iterator);
-        if (found != other.set_.end()) {
-          GroupDifference()(iterator->get_unsafe(), found->get());
-          if (iterator->get().is_bottom()) {
-            iterator = set_.erase(iterator);
-          } else {
-            ++iterator;
-          }
-        } else {
-          ++iterator;
+    if (size() <= other.size()) {
+      all_of_stored([&](const MutableElement& element) {
+        const auto* found = other.find(element);
+        if (found != nullptr) {
+          GroupDifference()(element.get_unsafe(), found->get());
         }
-      }
+        return true;
+      });
     } else {
-      for (const MutableElement& element : other.set_) {
-        auto found = set_.find(element);
-        if (found != set_.end()) {
+      other.all_of_stored([&](const MutableElement& element) {
+        const auto* found = find(element);
+        if (found != nullptr) {
           GroupDifference()(found->get_unsafe(), element.get());
-          if (found->get().is_bottom()) {
-            set_.erase(found);
-          }
         }
-      }
+        return true;
+      });
     }
+    erase_bottom();
   }
 
   /* Update all elements without affecting the grouping. */
-  void map(const std::function<void(Element&)>& f) {
-    for (auto iterator = set_.begin(), end = set_.end(); iterator != end;) {
+  template <typename Function> // void(Element&)
+  void map(Function&& f) {
+    all_of_stored([&](const MutableElement& mutable_element) {
       // This is safe as long as `f` does not change the grouping.
-      const MutableElement& mutable_element = *iterator;
-      auto previous_hash = MutableElementHash()(mutable_element);
-      f(mutable_element.get_unsafe());
-      if (mutable_element.get().is_bottom()) {
-        iterator = set_.erase(iterator);
-      } else {
-        auto current_hash = MutableElementHash()(mutable_element);
-        mt_assert_log(current_hash == previous_hash, "group hash has changed");
-        ++iterator;
+      auto& element = mutable_element.get_unsafe();
+      f(element);
+      if (!element.is_bottom()) {
+        mt_assert_log(
+            GroupHash()(element) == mutable_element.hash(),
+            "group hash has changed");
       }
-    }
+      return true;
+    });
+    erase_bottom();
   }
 
   /* Remove all elements that do not match the given predicate. */
-  void filter(const std::function<bool(const Element&)>& predicate) {
-    for (auto iterator = set_.begin(), end = set_.end(); iterator != end;) {
-      if (!predicate(iterator->get())) {
-        iterator = set_.erase(iterator);
-      } else {
-        iterator++;
-      }
-    }
+  template <typename Predicate> // bool(const Element&)
+  void filter(Predicate&& predicate) {
+    erase_if([&](const Element& element) { return !predicate(element); });
   }
 
   friend std::ostream& operator<<(
@@ -355,7 +417,107 @@ class GroupHashedSetAbstractDomain final
   }
 
  private:
-  Set set_;
+  /* Return the element in the same group, or nullptr. */
+  const MutableElement* find(const Element& element) const {
+    if (set_) {
+      return find(MutableElement(element));
+    }
+    return find_flat(element, GroupHash()(element));
+  }
+
+  const MutableElement* find(const MutableElement& element) const {
+    if (set_) {
+      auto found = set_->find(element);
+      return found != set_->end() ? &*found : nullptr;
+    }
+    return find_flat(element.get(), element.hash());
+  }
+
+  const MutableElement* find_flat(const Element& element, std::size_t hash)
+      const {
+    for (const auto& mutable_element : vector_) {
+      if (mutable_element.hash() == hash &&
+          GroupEqual()(mutable_element.get(), element)) {
+        return &mutable_element;
+      }
+    }
+    return nullptr;
+  }
+
+  void insert_or_join(const MutableElement& element) {
+    if (const auto* found = find(element)) {
+      // This is safe as long as `join_with` does not change the grouping.
+      found->get_unsafe().join_with(element.get());
+      return;
+    }
+
+    if (set_) {
+      set_->emplace(element);
+    } else if (vector_.size() < kMaxFlatSize) {
+      vector_.emplace_back(element);
+    } else {
+      set_ = std::make_unique<Set>(
+          std::make_move_iterator(vector_.begin()),
+          std::make_move_iterator(vector_.end()));
+      Vector().swap(vector_);
+      set_->emplace(element);
+    }
+  }
+
+  void erase(const MutableElement* element) {
+    if (set_) {
+      set_->erase(*element);
+    } else {
+      auto iterator = vector_.begin() + (element - vector_.data());
+      if (iterator != vector_.end() - 1) {
+        *iterator = std::move(vector_.back());
+      }
+      vector_.pop_back();
+    }
+  }
+
+  /**
+   * Return whether `predicate` holds on all stored elements, stopping at the
+   * first element where it does not.
+   */
+  template <typename Predicate> // bool(const MutableElement&)
+  bool all_of_stored(Predicate&& predicate) const {
+    if (set_) {
+      return std::all_of(set_->begin(), set_->end(), predicate);
+    } else {
+      return std::all_of(vector_.begin(), vector_.end(), predicate);
+    }
+  }
+
+  template <typename Predicate>
+  void erase_if(Predicate&& predicate) {
+    if (set_) {
+      for (auto iterator = set_->begin(); iterator != set_->end();) {
+        if (predicate(iterator->get())) {
+          iterator = set_->erase(iterator);
+        } else {
+          ++iterator;
+        }
+      }
+    } else {
+      vector_.erase(
+          std::remove_if(
+              vector_.begin(),
+              vector_.end(),
+              [&](const MutableElement& mutable_element) {
+                return predicate(mutable_element.get());
+              }),
+          vector_.end());
+    }
+  }
+
+  void erase_bottom() {
+    erase_if([](const Element& element) { return element.is_bottom(); });
+  }
+
+ private:
+  Vector vector_;
+  std::unique_ptr<Set> set_;
 };
 
 } // namespace marianatrench
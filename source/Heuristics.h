@@ -67,6 +67,18 @@ class Heuristics {
    */
   constexpr static std::size_t kMaxNumberIterations = 150;
 
+  /**
+   * Number of times the model of a method can change during the global
+   * fixpoint before new models are widened into it rather than joined.
+   */
+  constexpr static std::size_t kModelWideningUpdates = 10;
+
+  /**
+   * Maximum height of the trees of a model after it was widened by the global
+   * fixpoint.
+   */
+  constexpr static std::size_t kModelWideningHeight = 1;
+
   /**
    * Maximum number of local positions per frame.
    */
@@ -5,10 +5,17 @@
  * LICENSE file in the root directory of this source tree.
  */
 
-#include <fstream>
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+#include <boost/functional/hash.hpp>
 
 #include <DexUtil.h>
-#include <SpartaWorkQueue.h>
 
 #include <mariana-trench/Highlights.h>
 #include <mariana-trench/Log.h>
@@ -16,6 +23,8 @@
 #include <mariana-trench/Options.h>
 #include <mariana-trench/Positions.h>
 #include <mariana-trench/Registry.h>
+#include <mariana-trench/SourceScanner.h>
+#include <mariana-trench/WorkerPool.h>
 
 namespace marianatrench {
 
@@ -24,6 +33,32 @@ using Bounds = Highlights::Bounds;
 using FileLines = Highlights::FileLines;
 enum class FrameType { Source, Sink };
 
+using CallPosition = std::pair<const Method*, const Position*>;
+using CallPositions =
+    std::unordered_set<CallPosition, boost::hash<CallPosition>>;
+
+/**
+ * Callees and call positions of the non-leaf frames of each method that are
+ * part of issue traces (see `--scope-highlights-to-issues`).
+ */
+using TraceCallPositions = ConcurrentMap<const Method*, CallPositions>;
+
+void add_trace_frame(
+    TraceCallPositions* MT_NULLABLE trace_call_positions,
+    const Method* method,
+    const Frame& frame) {
+  if (trace_call_positions == nullptr) {
+    return;
+  }
+  trace_call_positions->update(
+      method,
+      [&](const Method* /* method */,
+          CallPositions& call_positions,
+          bool /* exists */) {
+        call_positions.emplace(frame.callee(), frame.call_position());
+      });
+}
+
 /*
  * Given a line and column that is assumed not to be a whitespace's position,
  * returns a Bounds object describing the location of the next non-whitespace
@@ -51,7 +86,7 @@ std::optional<Bounds> get_next_non_whitespace_position(
   return std::nullopt;
 }
 
-Bounds remove_surrounding_whitespace(Bounds bounds, const std::string& line) {
+Bounds remove_surrounding_whitespace(Bounds bounds, std::string_view line) {
   auto new_start = bounds.start;
   auto new_end = bounds.end;
   while (new_start < bounds.end && std::isspace(line[new_start])) {
@@ -134,7 +169,7 @@ Bounds get_argument_bounds(
 }
 
 Bounds get_callee_this_parameter_bounds(
-    const std::string& line,
+    std::string_view line,
     const Bounds& callee_name_bounds) {
   auto callee_start = callee_name_bounds.start;
   if (callee_start - 1 < 0 || line[callee_start - 1] != '.') {
@@ -172,7 +207,7 @@ Bounds get_iput_local_position_bounds(
     int line_number) {
   auto line = lines.line(line_number);
   auto field_start = line.find(field_name);
-  if (field_start == std::string::npos) {
+  if (field_start == std::string_view::npos) {
     return {line_number, 0, 0};
   }
   Bounds field_name_bounds = {
@@ -208,7 +243,7 @@ LocalPositionSet augment_local_positions(
     return local_positions;
   }
   auto new_local_positions = LocalPositionSet();
-  for (const auto* local_position : local_positions.elements()) {
+  for (const auto* local_position : local_positions) {
     if (!local_position->path() || !local_position->instruction() ||
         local_position->port() == std::nullopt) {
       new_local_positions.add(local_position);
@@ -236,10 +271,23 @@ const Position* augment_frame_position(
       position, bounds.line, bounds.start, bounds.end);
 }
 
+/**
+ * Augment the positions of the non-leaf frames of the taint. If
+ * `call_positions` is set, only frames with one of the given callees and call
+ * positions are augmented.
+ */
 Taint augment_taint_positions(
     Taint taint,
     const FileLines& lines,
-    const Context& context) {
+    const Context& context,
+    const CallPositions* MT_NULLABLE call_positions = nullptr) {
+  std::function<bool(const Method*, const Position*)> filter = nullptr;
+  if (call_positions != nullptr) {
+    filter = [call_positions](
+                 const Method* callee, const Position* position) {
+      return call_positions->count(CallPosition(callee, position)) > 0;
+    };
+  }
   taint.update_non_leaf_positions(
       [&](const Method* callee,
           const AccessPath& callee_port,
@@ -249,16 +297,19 @@ Taint augment_taint_positions(
       },
       [&](const LocalPositionSet& local_positions) {
         return augment_local_positions(local_positions, lines, context);
-      });
+      },
+      filter);
   return taint;
 }
 
 TaintAccessPathTree augment_taint_tree_positions(
     TaintAccessPathTree taint_tree,
     const FileLines& lines,
-    const Context& context) {
+    const Context& context,
+    const CallPositions* MT_NULLABLE call_positions = nullptr) {
   taint_tree.map([&](Taint& taint) {
-    auto new_taint = augment_taint_positions(taint, lines, context);
+    auto new_taint =
+        augment_taint_positions(taint, lines, context, call_positions);
     taint = std::move(new_taint);
   });
   return taint_tree;
@@ -290,43 +341,51 @@ void get_frames_files_to_methods(
     const ConcurrentSet<const Frame*>& frames,
     const Context& context,
     const Registry& registry,
-    FrameType frame_type) {
+    FrameType frame_type,
+    TraceCallPositions* MT_NULLABLE trace_call_positions) {
   auto frames_to_check = std::make_unique<ConcurrentSet<const Frame*>>(frames);
   auto seen_frames = std::make_unique<ConcurrentSet<const Frame*>>(frames);
 
   while (frames_to_check->size() != 0) {
     auto new_frames_to_check = std::make_unique<ConcurrentSet<const Frame*>>();
-    auto queue = sparta::work_queue<const Frame*>([&](const Frame* frame) {
-      const auto* callee = frame->callee();
-      if (!callee) {
-        return;
-      }
-      auto callee_model = registry.get(callee);
-      const auto& callee_port = frame->callee_port();
-      const auto* method_position = context.positions->get(callee);
-      if (method_position && method_position->path()) {
-        issue_files_to_methods.update(
-            method_position->path(),
-            [&](const std::string* /*filepath*/,
-                std::unordered_set<const Method*>& methods,
-                bool) { methods.emplace(callee); });
-      }
+    auto queue = WorkQueue<const Frame*>(
+        context.worker_pool.get(),
+        [&](const Frame* frame) {
+          const auto* callee = frame->callee();
+          if (!callee) {
+            return;
+          }
+          auto callee_model = registry.get(callee);
+          const auto& callee_port = frame->callee_port();
+          const auto* method_position = context.positions->get(callee);
+          if (method_position && method_position->path()) {
+            issue_files_to_methods.update(
+                method_position->path(),
+                [&](const std::string* /*filepath*/,
+                    std::unordered_set<const Method*>& methods,
+                    bool) { methods.emplace(callee); });
+          }
 
-      Taint taint;
-      if (frame_type == FrameType::Source) {
-        taint = callee_model.generations().raw_read(callee_port).root();
-      } else if (frame_type == FrameType::Sink) {
-        taint = callee_model.sinks().raw_read(callee_port).root();
-      }
-      for (const auto& frame_set : taint) {
-        for (const auto& callee_frame : frame_set) {
-          if (callee_frame.is_leaf() || !seen_frames->emplace(&callee_frame)) {
-            continue;
+          Taint taint;
+          if (frame_type == FrameType::Source) {
+            taint = callee_model.generations().raw_read(callee_port).root();
+          } else if (frame_type == FrameType::Sink) {
+            taint = callee_model.sinks().raw_read(callee_port).root();
           }
-          new_frames_to_check->emplace(&callee_frame);
-        }
-      }
-    });
+          for (const auto& frame_set : taint) {
+            for (const auto& callee_frame : frame_set) {
+              if (callee_frame.is_leaf()) {
+                continue;
+              }
+              add_trace_frame(trace_call_positions, callee, callee_frame);
+              if (!seen_frames->emplace(&callee_frame)) {
+                continue;
+              }
+              new_frames_to_check->emplace(&callee_frame);
+            }
+          }
+        },
+        context.options->jobs(AnalysisPhase::Highlights));
     for (const auto& frame : *frames_to_check) {
       queue.add_item(frame);
     }
@@ -340,78 +399,114 @@ void get_frames_files_to_methods(
  * defined in that file that are involved in issues. This way, when finding
  * highlights, we can open each file only once and only consider the
  * relevant methods in that file.
+ *
+ * If `trace_call_positions` is set, this also collects the frames of each
+ * method that are part of issue traces.
  */
 ConcurrentMap<const std::string*, std::unordered_set<const Method*>>
-get_issue_files_to_methods(const Context& context, const Registry& registry) {
+get_issue_files_to_methods(
+    const Context& context,
+    const Registry& registry,
+    TraceCallPositions* MT_NULLABLE trace_call_positions) {
   ConcurrentMap<const std::string*, std::unordered_set<const Method*>>
       issue_files_to_methods;
   ConcurrentSet<const Frame*> sources;
   ConcurrentSet<const Frame*> sinks;
 
-  auto queue = sparta::work_queue<const Method*>([&](const Method* method) {
-    auto model = registry.get(method);
-    if (model.issues().size() == 0) {
-      return;
-    }
-    for (const auto& issue : model.issues()) {
-      for (const auto& sink_frame_set : issue.sinks()) {
-        for (const auto& sink : sink_frame_set) {
-          if (!sink.is_leaf()) {
-            sinks.emplace(&sink);
-          }
+  auto queue = WorkQueue<const Method*>(
+      context.worker_pool.get(),
+      [&](const Method* method) {
+        auto model = registry.get(method);
+        if (model.issues().size() == 0) {
+          return;
         }
-      }
+        for (const auto& issue : model.issues()) {
+          for (const auto& sink_frame_set : issue.sinks()) {
+            for (const auto& sink : sink_frame_set) {
+              if (!sink.is_leaf()) {
+                add_trace_frame(trace_call_positions, method, sink);
+                sinks.emplace(&sink);
+              }
+            }
+          }
 
-      for (const auto& source_frame_set : issue.sources()) {
-        for (const auto& source : source_frame_set) {
-          if (!source.is_leaf()) {
-            sources.emplace(&source);
+          for (const auto& source_frame_set : issue.sources()) {
+            for (const auto& source : source_frame_set) {
+              if (!source.is_leaf()) {
+                add_trace_frame(trace_call_positions, method, source);
+                sources.emplace(&source);
+              }
+            }
           }
         }
-      }
-    }
-    auto* method_position = context.positions->get(method);
-    if (!method_position || !method_position->path()) {
-      return;
-    }
-    issue_files_to_methods.update(
-        method_position->path(),
-        [&](const std::string* /*filepath*/,
-            std::unordered_set<const Method*>& methods,
-            bool) { methods.emplace(method); });
-  });
+        auto* method_position = context.positions->get(method);
+        if (!method_position || !method_position->path()) {
+          return;
+        }
+        issue_files_to_methods.update(
+            method_position->path(),
+            [&](const std::string* /*filepath*/,
+                std::unordered_set<const Method*>& methods,
+                bool) { methods.emplace(method); });
+      },
+      context.options->jobs(AnalysisPhase::Highlights));
   for (const auto* method : *context.methods) {
     queue.add_item(method);
   }
   queue.run_all();
 
   get_frames_files_to_methods(
-      issue_files_to_methods, sources, context, registry, FrameType::Source);
+      issue_files_to_methods,
+      sources,
+      context,
+      registry,
+      FrameType::Source,
+      trace_call_positions);
   get_frames_files_to_methods(
-      issue_files_to_methods, sinks, context, registry, FrameType::Sink);
+      issue_files_to_methods,
+      sinks,
+      context,
+      registry,
+      FrameType::Sink,
+      trace_call_positions);
   return issue_files_to_methods;
 }
 
 } // namespace
 
-FileLines::FileLines(std::ifstream& stream) {
-  std::string line;
-  while (std::getline(stream, line)) {
-    lines_.push_back(line);
+FileLines::FileLines(const std::vector<std::string>& lines) {
+  for (const auto& line : lines) {
+    content_.append(line);
+    content_.push_back('\n');
+  }
+  index_lines(content_);
+}
+
+FileLines::FileLines(const boost::filesystem::path& path) {
+  // Mapping an empty file fails.
+  if (boost::filesystem::file_size(path) == 0) {
+    return;
   }
+  file_.open(path);
+  index_lines(std::string_view(file_.data(), file_.size()));
+}
+
+void FileLines::index_lines(std::string_view content) {
+  content_view_ = content;
+  offsets_ = source_scanner::line_offsets(content);
 }
 
 bool FileLines::has_line_number(std::size_t index) const {
-  return index >= 1 && index <= lines_.size();
+  return index >= 1 && index <= size();
 }
 
-const std::string& FileLines::line(std::size_t index) const {
+std::string_view FileLines::line(std::size_t index) const {
   mt_assert(has_line_number(index));
-  return lines_[index - 1];
+  return source_scanner::line(content_view_, offsets_, index - 1);
 }
 
 std::size_t FileLines::size() const {
-  return lines_.size();
+  return offsets_.empty() ? 0 : offsets_.size() - 1;
 }
 
 Bounds Highlights::get_local_position_bounds(
@@ -471,7 +566,7 @@ Bounds Highlights::get_callee_highlight_bounds(
     callee_name = "new " + *class_name;
   }
   auto callee_start = line.find(callee_name + "(");
-  if (callee_start == std::string::npos) {
+  if (callee_start == std::string_view::npos) {
     return {callee_line_number, 0, 0};
   }
   std::size_t callee_end =
@@ -500,35 +595,71 @@ void Highlights::augment_positions(Registry& registry, const Context& context) {
   auto current_path = boost::filesystem::current_path();
   boost::filesystem::current_path(context.options->source_root_directory());
 
-  auto issue_files_to_methods = get_issue_files_to_methods(context, registry);
-  auto file_queue =
-      sparta::work_queue<const std::string*>([&](const std::string* filepath) {
-        std::ifstream stream(*filepath);
-        if (stream.bad()) {
-          WARNING(1, "File {} was not found.", *filepath);
+  // Frames that are not part of issue traces are not exported, hence they can
+  // be left as is.
+  std::unique_ptr<TraceCallPositions> trace_call_positions;
+  if (context.options->scope_highlights_to_issues()) {
+    trace_call_positions = std::make_unique<TraceCallPositions>();
+  }
+  auto issue_files_to_methods = get_issue_files_to_methods(
+      context, registry, trace_call_positions.get());
+
+  // Each file is processed by a single worker, which maps it and releases it
+  // when done. The number of workers bounds the number of mapped files.
+  auto threads = std::min<std::size_t>(
+      context.options->jobs(AnalysisPhase::Highlights), kMaxOpenFiles);
+  std::vector<std::vector<Model>> new_models(threads);
+  auto file_queue = WorkQueue<const std::string*>(
+      context.worker_pool.get(),
+      [&](WorkQueue<const std::string*>::WorkerState* worker_state,
+          const std::string* filepath) {
+        std::unique_ptr<FileLines> file_lines;
+        try {
+          file_lines =
+              std::make_unique<FileLines>(boost::filesystem::path(*filepath));
+        } catch (const std::exception& exception) {
+          WARNING(
+              1, "File {} could not be read: {}", *filepath, exception.what());
           return;
         }
-        auto lines = FileLines(stream);
+
+        const auto& lines = *file_lines;
+        auto& worker_models = new_models.at(worker_state->worker_id());
         for (const auto* method : issue_files_to_methods.get(filepath, {})) {
+          CallPositions method_call_positions;
+          const CallPositions* call_positions = nullptr;
+          if (trace_call_positions != nullptr) {
+            method_call_positions = trace_call_positions->get(method, {});
+            call_positions = &method_call_positions;
+          }
+
           const auto old_model = registry.get(method);
           auto new_model = old_model;
           new_model.set_issues(
               augment_issue_positions(old_model.issues(), lines, context));
-          new_model.set_sinks(
-              augment_taint_tree_positions(old_model.sinks(), lines, context));
+          new_model.set_sinks(augment_taint_tree_positions(
+              old_model.sinks(), lines, context, call_positions));
           new_model.set_generations(augment_taint_tree_positions(
-              old_model.generations(), lines, context));
+              old_model.generations(), lines, context, call_positions));
           new_model.set_parameter_sources(augment_taint_tree_positions(
-              old_model.parameter_sources(), lines, context));
-          registry.set(new_model);
+              old_model.parameter_sources(), lines, context, call_positions));
+          worker_models.push_back(std::move(new_model));
         }
-      });
+      },
+      threads);
 
   for (const auto& [filepath, _] : issue_files_to_methods) {
     file_queue.add_item(filepath);
   }
   file_queue.run_all();
 
+  for (auto& worker_models : new_models) {
+    for (const auto& model : worker_models) {
+      registry.set(model);
+    }
+    worker_models = {};
+  }
+
   boost::filesystem::current_path(current_path);
 }
 
@@ -536,7 +667,7 @@ LocalPositionSet Highlights::filter_overlapping_highlights(
     const LocalPositionSet& local_positions) {
   mt_assert(local_positions.is_value());
   std::unordered_map<int, std::vector<const Position*>> grouped_by_line;
-  for (const auto* local_position : local_positions.elements()) {
+  for (const auto* local_position : local_positions) {
     auto line = local_position->line();
     auto& same_line_positions = grouped_by_line[line];
     if (same_line_positions.empty()) {
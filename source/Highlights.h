@@ -7,6 +7,14 @@
 
 #pragma once
 
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <boost/filesystem/path.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+
 #include <mariana-trench/Registry.h>
 
 namespace marianatrench {
@@ -16,9 +24,16 @@ class Highlights {
   /*
    * Add a start and end column to the positions involved in issues so that they
    * can be highlighted in the Zoncolan UI
+   *
+   * Methods with issues are grouped by source file, and files are processed in
+   * parallel so that each file is read exactly once and at most
+   * `kMaxOpenFiles` files are mapped at the same time. Updated models are
+   * written back into the registry once all files are processed.
    */
   static void augment_positions(Registry&, const Context& context);
 
+  static constexpr std::size_t kMaxOpenFiles = 64;
+
   /*
    * The following have been included here only for testing
    * purposes
@@ -36,20 +51,39 @@ class Highlights {
   /*
    * Representation of the lines in a file. Used to prevent off-by-1 errors as
    * lines in files are 1-indexed while cpp vectors are 0-indexed
+   *
+   * Files are memory-mapped and lines are views into the mapping, hence
+   * reading a file does not allocate per line.
    */
   class FileLines {
    public:
-    explicit FileLines(const std::vector<std::string>& lines) : lines_(lines) {}
-    explicit FileLines(std::ifstream& stream);
+    explicit FileLines(const std::vector<std::string>& lines);
+
+    /* Map the given file. Throws `std::exception` if it cannot be read. */
+    explicit FileLines(const boost::filesystem::path& path);
+
+    FileLines(const FileLines&) = delete;
+    FileLines(FileLines&&) = delete;
+    FileLines& operator=(const FileLines&) = delete;
+    FileLines& operator=(FileLines&&) = delete;
+    ~FileLines() = default;
 
     bool has_line_number(std::size_t index) const;
 
-    const std::string& line(std::size_t index) const;
+    std::string_view line(std::size_t index) const;
 
     std::size_t size() const;
 
    private:
-    std::vector<std::string> lines_;
+    void index_lines(std::string_view content);
+
+   private:
+    boost::iostreams::mapped_file_source file_;
+    std::string content_;
+    // View of `file_` or `content_`.
+    std::string_view content_view_;
+    // See `source_scanner::line_offsets`.
+    std::vector<std::size_t> offsets_;
   };
 
   static Bounds get_callee_highlight_bounds(
@@ -0,0 +1,413 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+namespace marianatrench {
+
+/**
+ * A set of elements with dense identifiers (e.g `Method::id`), with value
+ * semantics.
+ *
+ * Sets of at most `k_inline_size` elements are stored inline, sorted by
+ * identifier. Larger sets point to a shared immutable representation, copied
+ * on write, holding the sorted elements and a Roaring-style index of their
+ * identifiers: identifiers are split in chunks of 2^16, each stored either as
+ * a sorted array of the low bits, or as a bitmap when it holds more than
+ * `k_maximum_array_size` identifiers. Inclusion checks run on the index,
+ * comparing bitmaps a word at a time, and unions only merge the elements when
+ * they add new ones. Copies are constant time.
+ *
+ * Inserting into or removing from a large set copies it. Sets should rather
+ * be built from a range, or by union.
+ *
+ * `IdOf` returns the identifier of an element. Elements with the same
+ * identifier are the same element, hence a set must only hold elements
+ * created by a single factory.
+ */
+template <typename Element, typename IdOf>
+class IdSet final {
+ public:
+  static constexpr std::size_t k_inline_size = 4;
+  static constexpr std::size_t k_maximum_array_size = 4096;
+
+  using iterator = const Element* const*;
+
+ private:
+  static constexpr std::uint32_t k_large = ~std::uint32_t(0);
+  static constexpr std::size_t k_chunk_bits = 16;
+  static constexpr std::size_t k_bitmap_words = (1 << k_chunk_bits) / 64;
+
+  struct Container {
+    // High bits of the identifiers.
+    std::size_t key;
+    // Sorted low bits of the identifiers, unless the chunk is a bitmap.
+    std::vector<std::uint16_t> array;
+    // `k_bitmap_words` words if the chunk is dense.
+    std::vector<std::uint64_t> bitmap;
+
+    bool contains(std::uint16_t low) const {
+      if (!bitmap.empty()) {
+        return (bitmap[low >> 6] >> (low & 63)) & 1;
+      }
+      return std::binary_search(array.begin(), array.end(), low);
+    }
+
+    bool is_subset_of(const Container& other) const {
+      if (!bitmap.empty()) {
+        // Arrays hold less identifiers than bitmaps.
+        if (other.bitmap.empty()) {
+          return false;
+        }
+        std::uint64_t missing = 0;
+        for (std::size_t word = 0; word < k_bitmap_words; word++) {
+          missing |= bitmap[word] & ~other.bitmap[word];
+        }
+        return missing == 0;
+      } else if (!other.bitmap.empty()) {
+        return std::all_of(array.begin(), array.end(), [&](std::uint16_t low) {
+          return other.contains(low);
+        });
+      }
+      return std::includes(
+          other.array.begin(), other.array.end(), array.begin(), array.end());
+    }
+  };
+
+  struct Large {
+    mutable std::atomic<std::size_t> references{1};
+    std::vector<const Element*> elements;
+    std::vector<Container> containers;
+  };
+
+ public:
+  IdSet() = default;
+
+  IdSet(std::initializer_list<const Element*> elements)
+      : IdSet(elements.begin(), elements.end()) {}
+
+  template <typename Iterator>
+  IdSet(Iterator begin, Iterator end) {
+    assign(std::vector<const Element*>(begin, end), /* sorted */ false);
+  }
+
+  IdSet(const IdSet& other) : size_(other.size_) {
+    copy_representation(other);
+    if (is_large()) {
+      large_->references.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  IdSet(IdSet&& other) noexcept : size_(other.size_) {
+    copy_representation(other);
+    other.size_ = 0;
+  }
+
+  IdSet& operator=(const IdSet& other) {
+    if (this != &other) {
+      auto copy = IdSet(other);
+      *this = std::move(copy);
+    }
+    return *this;
+  }
+
+  IdSet& operator=(IdSet&& other) noexcept {
+    if (this != &other) {
+      release();
+      size_ = other.size_;
+      copy_representation(other);
+      other.size_ = 0;
+    }
+    return *this;
+  }
+
+  ~IdSet() {
+    release();
+  }
+
+  std::size_t size() const {
+    return is_large() ? large_->elements.size() : size_;
+  }
+
+  bool empty() const {
+    return size_ == 0;
+  }
+
+  /* Iterate on the elements in the order of their identifiers. */
+  iterator begin() const {
+    return is_large() ? large_->elements.data() : inline_.data();
+  }
+
+  iterator end() const {
+    return begin() + size();
+  }
+
+  void clear() {
+    release();
+    size_ = 0;
+  }
+
+  bool contains(const Element* element) const {
+    auto element_id = id(element);
+    if (!is_large()) {
+      return std::any_of(begin(), end(), [&](const Element* other) {
+        return id(other) == element_id;
+      });
+    }
+    const auto* container = find_container(element_id >> k_chunk_bits);
+    return container != nullptr &&
+        container->contains(static_cast<std::uint16_t>(element_id));
+  }
+
+  void insert(const Element* element) {
+    if (contains(element)) {
+      return;
+    }
+    if (!is_large() && size_ < k_inline_size) {
+      auto position = std::upper_bound(
+          inline_.begin(), inline_.begin() + size_, element, less);
+      std::move_backward(
+          position, inline_.begin() + size_, inline_.begin() + size_ + 1);
+      *position = element;
+      size_++;
+      return;
+    }
+    std::vector<const Element*> elements;
+    elements.reserve(size() + 1);
+    auto position = std::upper_bound(begin(), end(), element, less);
+    elements.insert(elements.end(), begin(), position);
+    elements.push_back(element);
+    elements.insert(elements.end(), position, end());
+    assign(std::move(elements), /* sorted */ true);
+  }
+
+  void remove(const Element* element) {
+    if (!contains(element)) {
+      return;
+    }
+    auto element_id = id(element);
+    std::vector<const Element*> elements;
+    elements.reserve(size() - 1);
+    std::copy_if(
+        begin(),
+        end(),
+        std::back_inserter(elements),
+        [&](const Element* other) { return id(other) != element_id; });
+    assign(std::move(elements), /* sorted */ true);
+  }
+
+  bool is_subset_of(const IdSet& other) const {
+    if (size() > other.size()) {
+      return false;
+    } else if (!is_large() || !other.is_large()) {
+      return std::all_of(begin(), end(), [&](const Element* element) {
+        return other.contains(element);
+      });
+    } else if (large_ == other.large_) {
+      return true;
+    }
+
+    auto other_container = other.large_->containers.begin();
+    auto other_end = other.large_->containers.end();
+    for (const auto& container : large_->containers) {
+      while (other_container != other_end &&
+             other_container->key < container.key) {
+        ++other_container;
+      }
+      if (other_container == other_end ||
+          other_container->key != container.key ||
+          !container.is_subset_of(*other_container)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  bool equals(const IdSet& other) const {
+    return size() == other.size() && is_subset_of(other);
+  }
+
+  void union_with(const IdSet& other) {
+    if (is_subset_of_or_same(other, *this)) {
+      return;
+    } else if (is_subset_of(other)) {
+      *this = other;
+      return;
+    }
+    std::vector<const Element*> elements;
+    elements.reserve(size() + other.size());
+    std::set_union(
+        begin(),
+        end(),
+        other.begin(),
+        other.end(),
+        std::back_inserter(elements),
+        less);
+    assign(std::move(elements), /* sorted */ true);
+  }
+
+  void intersection_with(const IdSet& other) {
+    if (is_subset_of_or_same(*this, other)) {
+      return;
+    } else if (other.is_subset_of(*this)) {
+      *this = other;
+      return;
+    }
+    std::vector<const Element*> elements;
+    std::set_intersection(
+        begin(),
+        end(),
+        other.begin(),
+        other.end(),
+        std::back_inserter(elements),
+        less);
+    assign(std::move(elements), /* sorted */ true);
+  }
+
+  void difference_with(const IdSet& other) {
+    if (empty() || other.empty()) {
+      return;
+    } else if (is_subset_of(other)) {
+      clear();
+      return;
+    }
+    std::vector<const Element*> elements;
+    std::set_difference(
+        begin(),
+        end(),
+        other.begin(),
+        other.end(),
+        std::back_inserter(elements),
+        less);
+    if (elements.size() != size()) {
+      assign(std::move(elements), /* sorted */ true);
+    }
+  }
+
+ private:
+  static std::size_t id(const Element* element) {
+    return IdOf()(element);
+  }
+
+  static bool less(const Element* left, const Element* right) {
+    return id(left) < id(right);
+  }
+
+  static bool is_subset_of_or_same(const IdSet& left, const IdSet& right) {
+    return &left == &right || left.is_subset_of(right);
+  }
+
+  bool is_large() const {
+    return size_ == k_large;
+  }
+
+  void copy_representation(const IdSet& other) {
+    if (other.is_large()) {
+      large_ = other.large_;
+    } else {
+      inline_ = other.inline_;
+    }
+  }
+
+  void release() {
+    if (is_large() &&
+        large_->references.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      delete large_;
+    }
+  }
+
+  const Container* find_container(std::size_t key) const {
+    const auto& containers = large_->containers;
+    auto found = std::lower_bound(
+        containers.begin(),
+        containers.end(),
+        key,
+        [](const Container& container, std::size_t key) {
+          return container.key < key;
+        });
+    return found != containers.end() && found->key == key ? &*found : nullptr;
+  }
+
+  /* Replace the content of the set by the given elements. */
+  void assign(std::vector<const Element*> elements, bool sorted) {
+    if (!sorted) {
+      std::sort(elements.begin(), elements.end(), less);
+      elements.erase(
+          std::unique(
+              elements.begin(),
+              elements.end(),
+              [](const Element* left, const Element* right) {
+                return id(left) == id(right);
+              }),
+          elements.end());
+    }
+
+    release();
+    if (elements.size() <= k_inline_size) {
+      std::copy(elements.begin(), elements.end(), inline_.begin());
+      size_ = static_cast<std::uint32_t>(elements.size());
+      return;
+    }
+
+    auto* large = new Large();
+    large->containers = build_index(elements);
+    large->elements = std::move(elements);
+    large_ = large;
+    size_ = k_large;
+  }
+
+  static std::vector<Container> build_index(
+      const std::vector<const Element*>& elements) {
+    std::vector<Container> containers;
+    auto chunk = elements.begin();
+    while (chunk != elements.end()) {
+      auto key = id(*chunk) >> k_chunk_bits;
+      auto chunk_end =
+          std::find_if(chunk, elements.end(), [&](const Element* element) {
+            return (id(element) >> k_chunk_bits) != key;
+          });
+
+      auto container = Container{key, {}, {}};
+      auto count = static_cast<std::size_t>(std::distance(chunk, chunk_end));
+      if (count > k_maximum_array_size) {
+        container.bitmap.resize(k_bitmap_words, 0);
+        for (auto element = chunk; element != chunk_end; ++element) {
+          auto low = static_cast<std::uint16_t>(id(*element));
+          container.bitmap[low >> 6] |= std::uint64_t(1) << (low & 63);
+        }
+      } else {
+        container.array.reserve(count);
+        for (auto element = chunk; element != chunk_end; ++element) {
+          container.array.push_back(static_cast<std::uint16_t>(id(*element)));
+        }
+      }
+      containers.push_back(std::move(container));
+      chunk = chunk_end;
+    }
+    return containers;
+  }
+
+ private:
+  union {
+    std::array<const Element*, k_inline_size> inline_{};
+    const Large* large_;
+  };
+  // Number of inline elements, or `k_large`.
+  std::uint32_t size_ = 0;
+};
+
+} // namespace marianatrench
@@ -0,0 +1,195 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <fstream>
+#include <string>
+
+#include <boost/algorithm/string/predicate.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/functional/hash.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+
+#include <SpartaWorkQueue.h>
+
+#include <mariana-trench/Dependencies.h>
+#include <mariana-trench/IncrementalAnalysis.h>
+#include <mariana-trench/JsonValidation.h>
+#include <mariana-trench/Log.h>
+#include <mariana-trench/Methods.h>
+#include <mariana-trench/Options.h>
+#include <mariana-trench/Redex.h>
+
+namespace marianatrench {
+
+namespace {
+
+std::size_t code_fingerprint(const Method* method) {
+  const auto* code = method->get_code();
+  return code != nullptr ? redex::code_hash(*code) : 0;
+}
+
+std::unordered_map<std::string, std::size_t> parse_previous_fingerprints(
+    const boost::filesystem::path& path) {
+  std::unordered_map<std::string, std::size_t> result;
+  if (!boost::filesystem::exists(path)) {
+    WARNING(1, "Could not find previous fingerprints `{}`.", path.native());
+    return result;
+  }
+
+  auto value = JsonValidation::parse_json_file(path);
+  JsonValidation::validate_object(value);
+  for (const auto& method : value.getMemberNames()) {
+    result.emplace(
+        method,
+        static_cast<std::size_t>(
+            std::stoull(JsonValidation::string(value, method))));
+  }
+  return result;
+}
+
+} // namespace
+
+IncrementalAnalysis::Fingerprints IncrementalAnalysis::fingerprints(
+    const Context& context,
+    const Registry& registry) {
+  ConcurrentMap<const Method*, std::size_t> fingerprints;
+  auto queue = sparta::work_queue<const Method*>(
+      [&](const Method* method) {
+        auto writer = JsonValidation::compact_writer();
+        std::stringstream model;
+        writer->write(registry.get(method).to_json(), &model);
+
+        std::size_t seed = code_fingerprint(method);
+        boost::hash_combine(seed, model.str());
+        fingerprints.insert(std::make_pair(method, seed));
+      },
+      context.options->jobs(AnalysisPhase::Models));
+  for (const auto* method : *context.methods) {
+    queue.add_item(method);
+  }
+  queue.run_all();
+
+  return Fingerprints(fingerprints.begin(), fingerprints.end());
+}
+
+Json::Value IncrementalAnalysis::fingerprints_to_json(
+    const Fingerprints& fingerprints) {
+  auto value = Json::Value(Json::objectValue);
+  for (const auto& [method, fingerprint] : fingerprints) {
+    // Fingerprints are stored as strings since they might not fit in a
+    // signed integer.
+    value[method->show()] = Json::Value(std::to_string(fingerprint));
+  }
+  return value;
+}
+
+std::unordered_set<const Method*> IncrementalAnalysis::load_previous_models(
+    Context& context,
+    Registry& registry,
+    const Fingerprints& fingerprints,
+    const boost::filesystem::path& previous_output_directory) {
+  auto previous_fingerprints = parse_previous_fingerprints(
+      previous_output_directory /
+      context.options->fingerprints_output_path().filename());
+
+  // Methods with a new or different fingerprint.
+  std::unordered_set<const Method*> changed_methods;
+  for (const auto& [method, fingerprint] : fingerprints) {
+    auto found = previous_fingerprints.find(method->show());
+    if (found == previous_fingerprints.end() || found->second != fingerprint) {
+      changed_methods.insert(method);
+    }
+  }
+
+  // Parse the previous models. We cannot parse issues, so methods with issues
+  // are analyzed again, which recomputes them.
+  std::unordered_map<const Method*, Json::Value> previous_models;
+  for (const auto& file :
+       boost::filesystem::directory_iterator(previous_output_directory)) {
+    const auto& file_path = file.path();
+    const auto filename = file_path.filename().string();
+    if (!boost::filesystem::is_regular_file(file_path) ||
+        !boost::starts_with(filename, "model@")) {
+      continue;
+    }
+    bool compressed = boost::ends_with(filename, ".json.gz");
+    if (!compressed && !boost::ends_with(filename, ".json")) {
+      // Binary shards duplicate the json shards.
+      continue;
+    }
+
+    std::ifstream file_stream(
+        file_path.native(), std::ios_base::in | std::ios_base::binary);
+    boost::iostreams::filtering_istream stream;
+    if (compressed) {
+      stream.push(boost::iostreams::gzip_decompressor());
+    }
+    stream.push(file_stream);
+    std::string line;
+    while (std::getline(stream, line)) {
+      if (line.empty() || boost::starts_with(line, "//")) {
+        continue;
+      }
+      auto value = JsonValidation::parse_json(line);
+      if (!value.isMember("method")) {
+        // Field models are never inferred, they are all recreated.
+        continue;
+      }
+
+      const Method* method = nullptr;
+      try {
+        method = Method::from_json(value["method"], context);
+      } catch (const JsonValidationError&) {
+        // The method was removed.
+        continue;
+      }
+      if (value.isMember("issues")) {
+        changed_methods.insert(method);
+        continue;
+      }
+      value.removeMember("position");
+      previous_models.emplace(method, std::move(value));
+    }
+  }
+
+  // Methods that transitively call a changed method need to be analyzed.
+  std::unordered_set<const Method*> methods_to_analyze;
+  std::vector<const Method*> worklist(
+      changed_methods.begin(), changed_methods.end());
+  while (!worklist.empty()) {
+    const auto* method = worklist.back();
+    worklist.pop_back();
+    if (!methods_to_analyze.insert(method).second) {
+      continue;
+    }
+    for (const auto* caller : context.dependencies->dependencies(method)) {
+      if (methods_to_analyze.count(caller) == 0) {
+        worklist.push_back(caller);
+      }
+    }
+  }
+
+  std::size_t reused_models = 0;
+  for (const auto& [method, value] : previous_models) {
+    if (methods_to_analyze.count(method) > 0) {
+      continue;
+    }
+    registry.join_with(Model::from_json(method, value, context));
+    reused_models++;
+  }
+
+  LOG(1,
+      "Reused {} models from the previous run, {} methods changed, {} methods need to be analyzed.",
+      reused_models,
+      changed_methods.size(),
+      methods_to_analyze.size());
+
+  return methods_to_analyze;
+}
+
+} // namespace marianatrench
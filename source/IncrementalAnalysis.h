@@ -0,0 +1,54 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <unordered_map>
+#include <unordered_set>
+
+#include <boost/filesystem/path.hpp>
+#include <json/json.h>
+
+#include <mariana-trench/Context.h>
+#include <mariana-trench/Method.h>
+#include <mariana-trench/Registry.h>
+
+namespace marianatrench {
+
+/**
+ * Support for reusing the models of a previous run.
+ *
+ * Each method has a fingerprint that combines its code and its initial model
+ * (i.e, generated and user-provided models). Methods whose fingerprint did not
+ * change since the previous run, and that do not transitively call a changed
+ * method, reuse their previous model instead of being analyzed again.
+ */
+class IncrementalAnalysis final {
+ public:
+  using Fingerprints = std::unordered_map<const Method*, std::size_t>;
+
+  /* Compute the fingerprints of all methods, before the analysis. */
+  static Fingerprints fingerprints(
+      const Context& context,
+      const Registry& registry);
+
+  static Json::Value fingerprints_to_json(const Fingerprints& fingerprints);
+
+  /**
+   * Load the models of the previous run found in the given directory into the
+   * registry and return the set of methods that need to be analyzed.
+   *
+   * This requires the dependency graph.
+   */
+  static std::unordered_set<const Method*> load_previous_models(
+      Context& context,
+      Registry& registry,
+      const Fingerprints& fingerprints,
+      const boost::filesystem::path& previous_output_directory);
+};
+
+} // namespace marianatrench
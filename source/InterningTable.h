@@ -0,0 +1,173 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <mariana-trench/Compiler.h>
+
+namespace marianatrench {
+
+/**
+ * A thread-safe factory that returns a unique pointer for a given string, for
+ * values that are created once and looked up many times (e.g kinds and
+ * features).
+ *
+ * Lookups of existing keys are lock-free and take a `std::string_view`, hence
+ * they never allocate. Each shard is an open-addressing hash table of
+ * pointers to immutable entries, which is only modified under the lock of the
+ * shard. When a shard grows, the new table is published atomically and the
+ * previous one is kept alive until the factory is destroyed, since readers
+ * may still be probing it. Tables are at most half full, hence this wastes
+ * at most the size of the current table.
+ *
+ * `Value` must be constructible from a `std::string`.
+ */
+template <typename Value>
+class InterningTable final {
+ private:
+  static constexpr std::size_t kShards = 16;
+  static constexpr std::size_t kInitialCapacity = 64;
+
+  struct Entry {
+    std::string key;
+    std::size_t hash;
+    std::unique_ptr<const Value> value;
+  };
+
+  struct Table {
+    explicit Table(std::size_t capacity) : slots(capacity) {}
+
+    /* Returns the entry for the given key, or `nullptr`. */
+    const Entry* MT_NULLABLE
+    find(std::string_view key, std::size_t hash) const {
+      auto mask = slots.size() - 1;
+      for (auto slot = hash & mask;; slot = (slot + 1) & mask) {
+        const auto* entry = slots[slot].load(std::memory_order_acquire);
+        if (entry == nullptr) {
+          return nullptr;
+        }
+        if (entry->hash == hash && entry->key == key) {
+          return entry;
+        }
+      }
+    }
+
+    void insert(const Entry* entry) {
+      auto mask = slots.size() - 1;
+      auto slot = entry->hash & mask;
+      while (slots[slot].load(std::memory_order_relaxed) != nullptr) {
+        slot = (slot + 1) & mask;
+      }
+      slots[slot].store(entry, std::memory_order_release);
+    }
+
+    std::vector<std::atomic<const Entry*>> slots;
+  };
+
+  struct Shard {
+    Shard() {
+      tables.push_back(std::make_unique<Table>(kInitialCapacity));
+      table.store(tables.back().get(), std::memory_order_release);
+    }
+
+    std::atomic<const Table*> table;
+    std::mutex mutex;
+    // The current table and the previous ones, protected by `mutex`.
+    std::vector<std::unique_ptr<Table>> tables;
+    // The entries, in insertion order, protected by `mutex`.
+    std::vector<std::unique_ptr<Entry>> entries;
+  };
+
+ public:
+  InterningTable() = default;
+  InterningTable(const InterningTable&) = delete;
+  InterningTable(InterningTable&&) = delete;
+  InterningTable& operator=(const InterningTable&) = delete;
+  InterningTable& operator=(InterningTable&&) = delete;
+  ~InterningTable() = default;
+
+  /* Get or create a unique pointer for the given key. */
+  const Value* create(std::string_view key) const {
+    auto hash = std::hash<std::string_view>()(key);
+    auto& shard = shards_[hash % kShards];
+    if (const auto* entry = find(shard, key, hash)) {
+      return entry->value.get();
+    }
+
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto* table = shard.tables.back().get();
+    if (const auto* entry = table->find(key, hash / kShards)) {
+      return entry->value.get();
+    }
+
+    auto key_string = std::string(key);
+    auto value = std::make_unique<const Value>(key_string);
+    shard.entries.push_back(std::make_unique<Entry>(
+        Entry{std::move(key_string), hash / kShards, std::move(value)}));
+    const auto* entry = shard.entries.back().get();
+
+    if (shard.entries.size() * 2 > table->slots.size()) {
+      // Build the larger table before publishing it.
+      auto new_table = std::make_unique<Table>(table->slots.size() * 2);
+      for (const auto& existing : shard.entries) {
+        new_table->insert(existing.get());
+      }
+      shard.table.store(new_table.get(), std::memory_order_release);
+      shard.tables.push_back(std::move(new_table));
+    } else {
+      table->insert(entry);
+    }
+    return entry->value.get();
+  }
+
+  /**
+   * Get the unique pointer for the given key.
+   *
+   * Returns `nullptr` if the key does not exist in the factory.
+   */
+  const Value* MT_NULLABLE get(std::string_view key) const {
+    auto hash = std::hash<std::string_view>()(key);
+    const auto* entry = find(shards_[hash % kShards], key, hash);
+    return entry == nullptr ? nullptr : entry->value.get();
+  }
+
+  /**
+   * Call `visitor(const Value*)` on all values.
+   *
+   * This is unsafe while calling `create` concurrently.
+   */
+  template <typename Visitor>
+  void visit(Visitor&& visitor) const {
+    for (const auto& shard : shards_) {
+      for (const auto& entry : shard.entries) {
+        visitor(entry->value.get());
+      }
+    }
+  }
+
+ private:
+  static const Entry* MT_NULLABLE
+  find(const Shard& shard, std::string_view key, std::size_t hash) {
+    return shard.table.load(std::memory_order_acquire)
+        ->find(key, hash / kShards);
+  }
+
+ private:
+  mutable std::array<Shard, kShards> shards_;
+};
+
+} // namespace marianatrench
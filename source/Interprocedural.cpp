@@ -5,30 +5,61 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
 #include <fmt/format.h>
 
 #include <AbstractDomain.h>
+#include <ConcurrentContainers.h>
 #include <ControlFlow.h>
 #include <InstructionAnalyzer.h>
+#include <Liveness.h>
 #include <MonotonicFixpointIterator.h>
 #include <Show.h>
-#include <SpartaWorkQueue.h>
 #include <TypeInference.h>
 #include <Walkers.h>
 
 #include <mariana-trench/AnalysisEnvironment.h>
+#include <mariana-trench/Checkpoint.h>
 #include <mariana-trench/ClassProperties.h>
 #include <mariana-trench/Context.h>
+#include <mariana-trench/ConvergenceReport.h>
 #include <mariana-trench/Dependencies.h>
+#include <mariana-trench/DuplicateMethods.h>
+#include <mariana-trench/Heuristics.h>
 #include <mariana-trench/Interprocedural.h>
+#include <mariana-trench/IssueStream.h>
 #include <mariana-trench/Log.h>
+#include <mariana-trench/MemoryBudget.h>
+#include <mariana-trench/MethodBitset.h>
+#include <mariana-trench/MethodContext.h>
 #include <mariana-trench/Methods.h>
+#include <mariana-trench/NumaPlacement.h>
 #include <mariana-trench/OperatingSystem.h>
 #include <mariana-trench/Overrides.h>
+#include <mariana-trench/PerformanceCounters.h>
+#include <mariana-trench/Profiler.h>
+#include <mariana-trench/RuntimeHeuristics.h>
 #include <mariana-trench/Scheduler.h>
+#include <mariana-trench/SnapshotArray.h>
 #include <mariana-trench/Statistics.h>
+#include <mariana-trench/ThinnedControlFlowGraph.h>
 #include <mariana-trench/Timer.h>
+#include <mariana-trench/Tracer.h>
 #include <mariana-trench/Transfer.h>
+#include <mariana-trench/TrivialMethods.h>
+#include <mariana-trench/Types.h>
+#include <mariana-trench/WorkerPool.h>
+#include <mariana-trench/WorkerSampler.h>
 
 namespace marianatrench {
 
@@ -37,41 +68,116 @@ namespace {
 using CombinedTransfer = InstructionAnalyzerCombiner<Transfer>;
 
 class FixpointIterator final
-    : public sparta::
-          MonotonicFixpointIterator<cfg::GraphInterface, AnalysisEnvironment> {
+    : public sparta::MonotonicFixpointIterator<
+          ThinnedGraphInterface,
+          AnalysisEnvironment> {
  public:
+  /* Dead registers are pruned at the end of blocks if `liveness` is set. */
   FixpointIterator(
-      const cfg::ControlFlowGraph& cfg,
-      InstructionAnalyzer<AnalysisEnvironment> instruction_analyzer)
-      : MonotonicFixpointIterator(cfg),
-        instruction_analyzer_(instruction_analyzer) {}
+      const ThinnedControlFlowGraph& graph,
+      const MethodContext* context,
+      InstructionAnalyzer<AnalysisEnvironment> instruction_analyzer,
+      const LivenessFixpointIterator* MT_NULLABLE liveness)
+      : MonotonicFixpointIterator(graph),
+        context_(context),
+        instruction_analyzer_(instruction_analyzer),
+        liveness_(liveness),
+        widening_delay_(context->options.widening_delay()) {
+    statistics_.removed_exception_edges = graph.removed_edges();
+  }
   virtual ~FixpointIterator() {}
 
   void analyze_node(const NodeId& block, AnalysisEnvironment* taint)
       const override {
+    context_->check_timeout();
+
+    // The transfer functions only depend on the entry state of the block,
+    // hence a block whose entry state did not change since its last visit has
+    // the same exit state. This is common for blocks of loops that do not
+    // depend on the loop head. Environments are persistent maps, hence
+    // comparing states that share their representation is cheap.
+    auto last_visit = last_visits_.find(block);
+    if (last_visit != last_visits_.end() &&
+        last_visit->second.entry_state.equals(*taint)) {
+      statistics_.skipped_block_visits++;
+      *taint = last_visit->second.exit_state;
+      return;
+    }
+    auto entry_state = *taint;
+
+    statistics_.block_visits++;
     LOG(4, "Analyzing block {}\n{}", block->id(), *taint);
-    for (auto& instruction : *block) {
-      switch (instruction.type) {
-        case MFLOW_OPCODE:
-          instruction_analyzer_(instruction.insn, taint);
-          break;
-        case MFLOW_POSITION:
-          taint->set_last_position(instruction.pos.get());
-          break;
-        default:
-          break;
+    for (const auto& entry : context_->instructions.block(block)) {
+      if (entry.instruction != nullptr) {
+        instruction_analyzer_(entry.instruction, taint);
+      } else {
+        taint->set_last_position(entry.position);
       }
     }
+
+    if (liveness_ != nullptr) {
+      // Smaller environments make joins and comparisons at the entry of
+      // successor blocks cheaper.
+      auto live_registers = liveness_->get_live_out_vars_at(block);
+      taint->prune_dead_registers([&](Register register_id) {
+        return live_registers.contains(register_id);
+      });
+    }
+
+    statistics_.maximum_environment_size =
+        std::max(statistics_.maximum_environment_size, taint->size());
+
+    last_visits_.insert_or_assign(
+        block, BlockVisit{std::move(entry_state), *taint});
   }
 
   AnalysisEnvironment analyze_edge(
       const EdgeId& /*edge*/,
       const AnalysisEnvironment& taint) const override {
+    // Edges are the identity. The result is joined into the entry state of
+    // the target block. Copying an environment only copies the roots of its
+    // persistent maps, and joining shares the subtrees that are identical,
+    // hence exception edges from a block that did not change are cheap.
+    statistics_.joins++;
     return taint;
   }
 
+  /**
+   * Called on the head of a loop at each local iteration. Join for the first
+   * `--widening-delay` iterations, then widen.
+   */
+  void extrapolate(
+      const Context& context,
+      const NodeId& node,
+      AnalysisEnvironment* current_state,
+      const AnalysisEnvironment& new_state) override {
+    if (context.get_local_iterations_for(node) < widening_delay_) {
+      statistics_.joins++;
+      current_state->join_with(new_state);
+    } else {
+      statistics_.widenings++;
+      current_state->widen_with(new_state);
+    }
+  }
+
+  const FixpointStatistics& statistics() const {
+    return statistics_;
+  }
+
+ private:
+  struct BlockVisit {
+    AnalysisEnvironment entry_state;
+    AnalysisEnvironment exit_state;
+  };
+
  private:
+  const MethodContext* context_;
   InstructionAnalyzer<AnalysisEnvironment> instruction_analyzer_;
+  const LivenessFixpointIterator* MT_NULLABLE liveness_;
+  std::size_t widening_delay_;
+  mutable FixpointStatistics statistics_;
+  // States of the last visit of each block.
+  mutable std::unordered_map<NodeId, BlockVisit> last_visits_;
 };
 
 std::string show_control_flow_graph(const cfg::ControlFlowGraph& cfg) {
@@ -104,11 +210,84 @@ std::string show_control_flow_graph(const cfg::ControlFlowGraph& cfg) {
   return string;
 }
 
+/**
+ * Snapshots of the callee models read by the last analysis of each method.
+ *
+ * The analysis of a method only depends on its previous model and on the
+ * models of its callees. A method whose callee models did not change since
+ * its last analysis would compute the same model again, hence it does not
+ * need to be analyzed, even if it was scheduled because of a dependency.
+ *
+ * This also counts how many times the model of each method changed, to widen
+ * the models that keep changing (see `Model::widen_with_change`).
+ */
+class AnalysisInputs final {
+ private:
+  using CalleeModels =
+      std::vector<std::pair<const Method*, std::shared_ptr<const Model>>>;
+
+ public:
+  explicit AnalysisInputs(std::size_t methods)
+      : updates_(std::make_unique<std::atomic<std::size_t>[]>(methods)) {}
+  AnalysisInputs(const AnalysisInputs&) = delete;
+  AnalysisInputs(AnalysisInputs&&) = delete;
+  AnalysisInputs& operator=(const AnalysisInputs&) = delete;
+  AnalysisInputs& operator=(AnalysisInputs&&) = delete;
+  ~AnalysisInputs() = default;
+
+  /* This is thread-safe. */
+  void record(
+      const Method* method,
+      const MethodContext::CalleeModels& callee_models) {
+    inputs_.set(
+        method->id(),
+        std::make_shared<const CalleeModels>(
+            callee_models.begin(), callee_models.end()));
+  }
+
+  /**
+   * Returns true if the method was analyzed before and none of the callee
+   * models it read changed since. This is thread-safe.
+   */
+  bool unchanged(const Method* method, const Registry& registry) const {
+    auto callee_models = inputs_.get(method->id());
+    if (callee_models == nullptr) {
+      return false;
+    }
+    for (const auto& [callee, callee_model] : *callee_models) {
+      if (registry.get_snapshot(callee) != callee_model) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /* Record that the model of the method changed. This is thread-safe. */
+  void record_update(const Method* method) {
+    updates_[method->id()].fetch_add(1, std::memory_order_relaxed);
+  }
+
+  /* Return the number of times the model of the method changed. */
+  std::size_t updates(const Method* method) const {
+    return updates_[method->id()].load(std::memory_order_relaxed);
+  }
+
+ private:
+  SnapshotArray<CalleeModels> inputs_;
+  // Indexed by method identifier.
+  std::unique_ptr<std::atomic<std::size_t>[]> updates_;
+};
+
 Model analyze(
     Context& global_context,
     const Registry& registry,
-    const Model& old_model) {
+    const Model& old_model,
+    AnalysisInputs& inputs) {
   Timer timer;
+  std::optional<PerformanceCounters::Values> counters_start;
+  if (global_context.performance_counters != nullptr) {
+    counters_start = PerformanceCounters::thread().read();
+  }
 
   Model model = old_model;
 
@@ -117,8 +296,12 @@ Model analyze(
     return model;
   }
 
-  auto method_context =
-      std::make_unique<MethodContext>(global_context, registry, model);
+  LogMethodScope log_scope(method);
+  // Analyses of a worker reuse the memory of the previous analysis.
+  thread_local MethodContext::Scratch scratch;
+  auto method_context_storage =
+      MethodContext(global_context, registry, model, scratch);
+  auto* method_context = &method_context_storage;
 
   LOG_OR_DUMP(
       method_context, 3, "Analyzing `\033[33m{}\033[0m`...", method->show());
@@ -137,23 +320,65 @@ Model analyze(
         method_context, 4, "Code:\n{}", show_control_flow_graph(code->cfg()));
   }
 
-  auto fixpoint =
-      FixpointIterator(code->cfg(), CombinedTransfer(method_context.get()));
-  fixpoint.run(AnalysisEnvironment::initial());
-  model.collapse_invalid_paths(global_context);
-  model.approximate();
+  bool timed_out = false;
+  {
+    ProfileScope profile_scope(
+        method_context->profile(), Profiler::kAnalyzeMethod);
+    const auto& options = *global_context.options;
+    std::unique_ptr<LivenessFixpointIterator> liveness;
+    if (options.prune_dead_registers() || options.thin_exception_edges()) {
+      liveness = std::make_unique<LivenessFixpointIterator>(code->cfg());
+      liveness->run(LivenessDomain());
+    }
+    auto graph = ThinnedControlFlowGraph(
+        code->cfg(),
+        options.thin_exception_edges() ? liveness.get() : nullptr);
+    auto fixpoint = FixpointIterator(
+        graph,
+        method_context,
+        CombinedTransfer(method_context),
+        options.prune_dead_registers() ? liveness.get() : nullptr);
+    try {
+      fixpoint.run(AnalysisEnvironment::initial());
+    } catch (const MethodAnalysisTimeout&) {
+      // Keep the partial model, it is made obscure below.
+      timed_out = true;
+    }
+    global_context.statistics->log_fixpoint(method, fixpoint.statistics());
+    model.collapse_invalid_paths(global_context);
+
+    ProfileScope approximate_scope(method_context->profile(), "approximate");
+    auto model_tree_max_leaves =
+        global_context.heuristics->get(method).model_tree_max_leaves;
+    if (global_context.memory_budget != nullptr) {
+      global_context.memory_budget->approximate(model, model_tree_max_leaves);
+    } else {
+      model.approximate(model_tree_max_leaves);
+    }
+  }
+  if (auto* profile = method_context->profile()) {
+    global_context.profiler->record(method, *profile);
+  }
+  if (!timed_out) {
+    inputs.record(method, method_context->callee_models());
+  }
 
   LOG_OR_DUMP(
       method_context, 4, "Computed model for `{}`: {}", method->show(), model);
 
   global_context.statistics->log_time(method, timer);
   auto duration = timer.duration_in_seconds();
+  if (counters_start &&
+      duration >= Statistics::kPerformanceCountersMinimumSeconds) {
+    global_context.statistics->log_performance_counters(
+        method, PerformanceCounters::thread().read() - *counters_start);
+  }
   if (duration > 10.0) {
     WARNING(1, "Analyzing `{}` took {:.2f}s!", method->show(), duration);
   }
   auto slow_method_bound =
       global_context.options->maximum_method_analysis_time();
-  if (slow_method_bound && *slow_method_bound <= duration) {
+  if (timed_out || (slow_method_bound && *slow_method_bound <= duration)) {
     LOG(1,
         "Analyzing `{}` took {:.2f}s, setting default taint-in-taint-out.",
         method->show(),
@@ -164,107 +389,849 @@ Model analyze(
     model.add_mode(Model::Mode::TaintInTaintOut, global_context);
     model.add_mode(Model::Mode::TaintInTaintThis, global_context);
   }
+  if (global_context.duplicate_methods != nullptr && !timed_out) {
+    global_context.duplicate_methods->record(
+        method, old_model, model, method_context->callee_models());
+  }
 
   return model;
 }
 
-} // namespace
+/**
+ * Return the model computed for a duplicate of the method (see
+ * `DuplicateMethods`), if it was computed from an equal previous model and
+ * the callee models did not change since.
+ */
+std::optional<Model> duplicate_model(
+    Context& context,
+    const Registry& registry,
+    AnalysisInputs& inputs,
+    const Model& old_model) {
+  const auto* method = old_model.method();
+  if (context.duplicate_methods == nullptr || method == nullptr) {
+    return std::nullopt;
+  }
+  auto entry = context.duplicate_methods->find(method);
+  if (!entry || entry->method == method || entry->previous_model != old_model) {
+    return std::nullopt;
+  }
+  for (const auto& [callee, callee_model] : entry->callee_models) {
+    if (registry.get_snapshot(callee) != callee_model) {
+      return std::nullopt;
+    }
+  }
 
-void Interprocedural::run_analysis(Context& context, Registry& registry) {
-  LOG(1, "Computing global fixpoint...");
-  auto methods_to_analyze = std::make_unique<ConcurrentSet<const Method*>>();
+  LOG(3,
+      "Reusing the model of `{}` for `{}`...",
+      entry->method->show(),
+      method->show());
+  inputs.record(method, entry->callee_models);
+  context.duplicate_methods->record_reuse();
+  return entry->model.instantiate(method, context);
+}
+
+/**
+ * Return the model of a trivial method (see `TrivialMethods`), built without
+ * running the fixpoint.
+ */
+std::optional<Model> trivial_model(
+    Context& context,
+    const Registry& registry,
+    AnalysisInputs& inputs,
+    const Model& old_model) {
+  if (context.trivial_methods == nullptr) {
+    return std::nullopt;
+  }
+  auto model = context.trivial_methods->model(context, registry, old_model);
+  if (!model) {
+    return std::nullopt;
+  }
+  const auto* method = old_model.method();
+  LOG(3, "Summarizing trivial method `{}`...", method->show());
+  // No callee model is read, the method is never analyzed again.
+  inputs.record(method, {});
+  return model;
+}
+
+/**
+ * Analyze the given method and store its new model in the registry.
+ *
+ * Returns true if the model changed in a way that is visible to callers, i.e
+ * when callers need to be analyzed again. New issues alone do not count.
+ */
+bool analyze_and_update(
+    Context& context,
+    Registry& registry,
+    AnalysisInputs& inputs,
+    const Method* method) {
+  const auto old_model = registry.get_snapshot(method);
+  if (old_model->skip_analysis()) {
+    LOG(3, "Skipping `{}`...", method->show());
+    return false;
+  }
+  if (inputs.unchanged(method, registry)) {
+    LOG(3,
+        "Skipping `{}`, its callee models did not change...",
+        method->show());
+    return false;
+  }
+
+  auto new_model = duplicate_model(context, registry, inputs, *old_model);
+  if (!new_model) {
+    new_model = trivial_model(context, registry, inputs, *old_model);
+  }
+  if (!new_model) {
+    new_model = analyze(context, registry, *old_model, inputs);
+  }
+  // Join into a copy of the previous model: parts that did not change keep
+  // sharing their nodes with it, and each part is only compared once.
+  auto model = *old_model;
+  // Widen models that keep changing, typically in large recursive components,
+  // rather than letting their trees grow a little at each global iteration.
+  bool widen = inputs.updates(method) >= Heuristics::kModelWideningUpdates;
+  auto change = widen ? model.widen_with_change(*new_model)
+                      : model.join_with_change(*new_model);
+  if (change == Model::Change::None) {
+    // Keep the previous snapshot, so that callers that read it are still
+    // considered up to date (see `AnalysisInputs`).
+    return false;
+  }
+  if (widen) {
+    context.statistics->log_model_widening(method);
+  }
+  if (context.convergence_report != nullptr) {
+    context.convergence_report->record(method, *old_model, model);
+  }
+  inputs.record_update(method);
+  registry.set(std::move(model));
+  return change == Model::Change::CallerVisible;
+}
+
+bool has_callees(const Context& context, const Method* method) {
+  return context.call_graph->has_callees(method) ||
+      !context.call_graph->artificial_callees(method).empty();
+}
+
+/**
+ * Return the methods that the rest of the global fixpoint can analyze,
+ * indexed by method identifier.
+ *
+ * Only the methods to analyze and their transitive callers can be analyzed
+ * again. Since the methods of a strongly connected component are callers of
+ * each other, a component is either entirely live or has converged.
+ */
+std::vector<bool> live_methods(
+    const Context& context,
+    const MethodBitset& methods_to_analyze) {
+  std::vector<bool> live(context.methods->size(), false);
+  std::vector<const Method*> worklist;
+  methods_to_analyze.visit(
+      [&](const Method* method) { worklist.push_back(method); });
+  while (!worklist.empty()) {
+    const auto* method = worklist.back();
+    worklist.pop_back();
+    if (live[method->id()]) {
+      continue;
+    }
+    live[method->id()] = true;
+    for (const auto* dependency : context.dependencies->dependencies(method)) {
+      if (!live[dependency->id()]) {
+        worklist.push_back(dependency);
+      }
+    }
+  }
+  return live;
+}
+
+/**
+ * Spill the models that the rest of the global fixpoint will not read (see
+ * `--spill-cold-models`).
+ *
+ * Only the models of live methods and their callees are read.
+ */
+void spill_cold_models(
+    const Context& context,
+    Registry& registry,
+    const std::vector<bool>& live) {
+  Timer timer;
+  const auto& call_graph = *context.call_graph;
+
+  std::vector<bool> read = live;
+  for (const auto* method : *context.methods) {
+    if (!live[method->id()]) {
+      continue;
+    }
+    for (const auto& call_target : call_graph.callees(method)) {
+      if (!call_target.resolved()) {
+        continue;
+      }
+      read[call_target.resolved_base_callee()->id()] = true;
+      if (call_target.is_virtual()) {
+        for (const auto* override : call_target.overrides()) {
+          read[override->id()] = true;
+        }
+      }
+    }
+    for (const auto& [_, artificial_callees] :
+         call_graph.artificial_callees(method)) {
+      for (const auto& artificial_callee : artificial_callees) {
+        if (const auto* callee =
+                artificial_callee.call_target.resolved_base_callee()) {
+          read[callee->id()] = true;
+        }
+      }
+    }
+  }
+
+  std::vector<const Method*> cold_methods;
   for (const auto* method : *context.methods) {
-    methods_to_analyze->insert(method);
+    if (!read[method->id()]) {
+      cold_methods.push_back(method);
+    }
   }
+  registry.spill_models(
+      cold_methods, context.options->spilled_models_path());
+  LOG(2,
+      "Spilled models of {} cold methods in {:.2f}s.",
+      cold_methods.size(),
+      timer.duration_in_seconds());
+}
+
+/**
+ * Free the control flow graphs, inferred types and call graph entries of
+ * converged methods (see `--release-converged-methods`).
+ *
+ * Instructions are kept, since positions and highlights refer to them.
+ * `released` records the methods released in previous iterations, since the
+ * set of live methods only shrinks.
+ */
+void release_converged_methods(
+    Context& context,
+    const std::vector<bool>& live,
+    std::vector<bool>& released) {
+  Timer timer;
+  std::vector<const Method*> converged_methods;
+  for (const auto* method : *context.methods) {
+    if (!live[method->id()] && !released[method->id()]) {
+      released[method->id()] = true;
+      converged_methods.push_back(method);
+    }
+  }
+  if (converged_methods.empty()) {
+    return;
+  }
+
+  auto queue = WorkQueue<const Method*>(
+      context.worker_pool.get(),
+      [&](const Method* method) {
+        context.types->release(method);
+        auto* code = method->get_code();
+        if (code != nullptr && code->cfg_built()) {
+          code->clear_cfg();
+        }
+      },
+      context.options->jobs(AnalysisPhase::Fixpoint));
+  for (const auto* method : converged_methods) {
+    queue.add_item(method);
+  }
+  queue.run_all();
+  for (const auto* method : converged_methods) {
+    context.call_graph->release(method);
+  }
+
+  LOG(2,
+      "Released {} converged methods in {:.2f}s.",
+      converged_methods.size(),
+      timer.duration_in_seconds());
+}
+
+unsigned int number_of_threads(const Context& context) {
+  if (context.options->sequential()) {
+    WARNING(1, "Running sequentially!");
+  }
+  return context.options->jobs(AnalysisPhase::Fixpoint);
+}
+
+/**
+ * Wall-clock deadline of the global fixpoint (see
+ * `--fixpoint-deadline-in-seconds`).
+ *
+ * Once it expires, analyses in flight complete but no other method is
+ * analyzed. Skipped methods are recorded as imprecise: their models, and
+ * transitively the models of their callers, might not have reached the
+ * fixpoint.
+ */
+class FixpointDeadline final {
+ public:
+  explicit FixpointDeadline(const Options& options)
+      : seconds_(options.fixpoint_deadline_in_seconds()), expired_(false) {}
+
+  FixpointDeadline(const FixpointDeadline&) = delete;
+  FixpointDeadline(FixpointDeadline&&) = delete;
+  FixpointDeadline& operator=(const FixpointDeadline&) = delete;
+  FixpointDeadline& operator=(FixpointDeadline&&) = delete;
+  ~FixpointDeadline() = default;
+
+  /* This is thread-safe. */
+  bool expired() const {
+    if (!seconds_) {
+      return false;
+    }
+    if (expired_.load(std::memory_order_relaxed)) {
+      return true;
+    }
+    if (timer_.duration_in_seconds() < *seconds_) {
+      return false;
+    }
+    expired_.store(true, std::memory_order_relaxed);
+    return true;
+  }
+
+  /* Record a method that was not analyzed. This is thread-safe. */
+  void skip(const Method* method) {
+    imprecise_methods_.insert(method);
+  }
+
+  void log(Statistics& statistics) const {
+    if (imprecise_methods_.empty()) {
+      return;
+    }
+    WARNING(
+        1,
+        "Global fixpoint stopped after {}s, {} methods have imprecise models.",
+        *seconds_,
+        imprecise_methods_.size());
+    statistics.log_imprecise_methods(std::vector<const Method*>(
+        imprecise_methods_.begin(), imprecise_methods_.end()));
+  }
+
+ private:
+  Timer timer_;
+  std::optional<int> seconds_;
+  mutable std::atomic<bool> expired_;
+  ConcurrentSet<const Method*> imprecise_methods_;
+};
+
+/**
+ * Iterate the methods of a strongly connected component to a local fixpoint.
+ *
+ * Dependencies within the component are re-analyzed immediately, while
+ * callers outside of the component are only scheduled for the next global
+ * iteration, once the component is stable.
+ *
+ * The next method is always the first pending one in the weak topological
+ * order of the component. When a method changes, its callers that come later
+ * are analyzed after it, and a caller that is the head of an enclosing cycle
+ * is analyzed before the rest of the component. This is the recursive
+ * iteration strategy of Bourdoncle, which stabilizes inner cycles first.
+ */
+void analyze_component(
+    Context& context,
+    Registry& registry,
+    const std::vector<const Method*>& component,
+    const MethodBitset& methods_to_analyze,
+    MethodBitset& new_methods_to_analyze,
+    AnalysisInputs& inputs,
+    std::size_t worker_id) {
+  // Positions of the members in the weak topological order.
+  std::unordered_map<const Method*, std::size_t> positions;
+  std::set<std::size_t> worklist;
+  for (std::size_t position = 0; position < component.size(); position++) {
+    positions.emplace(component[position], position);
+    if (methods_to_analyze.contains(component[position])) {
+      worklist.insert(position);
+    }
+  }
+
+  std::unordered_map<const Method*, std::size_t> analyses;
+  while (!worklist.empty()) {
+    const auto* method = component[*worklist.begin()];
+    worklist.erase(worklist.begin());
+
+    if (++analyses[method] >
+        context.heuristics->get(method).max_number_iterations) {
+      ERROR(1, "Too many local iterations");
+      LOG(1, "Unstable method is:\n`{}`", method->show());
+      throw std::runtime_error("Too many iterations, exiting.");
+    }
+
+    if (context.numa_placement != nullptr) {
+      context.numa_placement->enter(worker_id, method);
+    }
+    WorkerSampleScope sample_scope(
+        context.worker_sampler.get(), worker_id, method);
+    if (!analyze_and_update(context, registry, inputs, method)) {
+      continue;
+    }
+
+    // Unlike the default schedule, we do not re-analyze the method in the next
+    // global iteration: callees within the component are stable at this point
+    // and callees outside of it schedule their dependencies when they change.
+    for (const auto* dependency : context.dependencies->dependencies(method)) {
+      auto position = positions.find(dependency);
+      if (position == positions.end()) {
+        new_methods_to_analyze.insert(dependency);
+      } else {
+        worklist.insert(position->second);
+      }
+    }
+  }
+}
+
+void run_global_iterations(
+    Context& context,
+    Registry& registry,
+    const std::unordered_set<const Method*>& initial_methods,
+    std::size_t initial_iteration,
+    FixpointDeadline& deadline,
+    AnalysisInputs& inputs) {
+  // Both worklists are allocated once and swapped between iterations.
+  MethodBitset methods_to_analyze(*context.methods);
+  MethodBitset new_methods_to_analyze(*context.methods);
+  for (const auto* method : initial_methods) {
+    methods_to_analyze.insert(method);
+  }
+
+  // Methods whose control flow graph was released, see
+  // `release_converged_methods`.
+  std::vector<bool> released_methods;
+  if (context.options->release_converged_methods()) {
+    released_methods.resize(context.methods->size(), false);
+  }
+
+  auto checkpoint_interval = context.options->checkpoint_interval();
+  std::unique_ptr<Checkpoint> checkpoint;
+  if (checkpoint_interval) {
+    checkpoint =
+        std::make_unique<Checkpoint>(context.options->checkpoint_output_path());
+  }
+
+  std::size_t iteration = initial_iteration;
+  while (!methods_to_analyze.empty()) {
+    if (deadline.expired()) {
+      methods_to_analyze.visit(
+          [&](const Method* method) { deadline.skip(method); });
+      break;
+    }
 
-  std::size_t iteration = 0;
-  while (methods_to_analyze->size() > 0) {
     Timer iteration_timer;
     iteration++;
+    TraceSpan iteration_span(fmt::format("global_iteration:{}", iteration));
+    Logger::set_iteration(iteration);
+    if (context.worker_sampler != nullptr) {
+      context.worker_sampler->set_iteration(iteration);
+    }
+    if (context.convergence_report != nullptr) {
+      context.convergence_report->set_iteration(iteration);
+    }
 
     auto resident_set_size = resident_set_size_in_gb();
     context.statistics->log_resident_set_size(resident_set_size);
+    if (context.memory_budget != nullptr) {
+      context.memory_budget->update(resident_set_size);
+    }
     LOG(1,
         "Global iteration {}. Analyzing {} methods... (Memory used, RSS: {:.2f}GB)",
         iteration,
-        methods_to_analyze->size(),
+        methods_to_analyze.size(),
         resident_set_size);
+    if (Logger::enabled(2)) {
+      LOG(2,
+          "Approximate memory used by models: {:.2f}GB",
+          static_cast<double>(registry.memory_accounting().total_bytes()) /
+              (1024.0 * 1024.0 * 1024.0));
+    }
 
-    if (iteration > Heuristics::kMaxNumberIterations) {
+    if (iteration > context.heuristics->defaults().max_number_iterations) {
       ERROR(1, "Too many iterations");
       std::string message = "Unstable methods are:";
-      for (const auto* method : *methods_to_analyze) {
+      methods_to_analyze.visit([&](const Method* method) {
         message.append(fmt::format("\n`{}`", method->show()));
-      }
+      });
       LOG(1, message);
       throw std::runtime_error("Too many iterations, exiting.");
     }
 
-    auto new_methods_to_analyze =
-        std::make_unique<ConcurrentSet<const Method*>>();
-
-    unsigned int threads = sparta::parallel::default_num_threads();
-    if (context.options->sequential()) {
-      WARNING(1, "Running sequentially!");
-      threads = 1u;
-    }
-
-    std::atomic<std::size_t> method_iteration(0);
-    auto queue = sparta::work_queue<const Method*>(
-        [&](const Method* method) {
-          method_iteration++;
-          if (method_iteration % 10000 == 0) {
-            LOG(1,
-                "Processed {}/{} methods.",
-                method_iteration.load(),
-                methods_to_analyze->size());
-          } else if (method_iteration % 100 == 0) {
-            LOG(4,
-                "Processed {}/{} methods.",
-                method_iteration.load(),
-                methods_to_analyze->size());
-          }
+    new_methods_to_analyze.clear();
 
-          const auto old_model = registry.get(method);
-          if (old_model.skip_analysis()) {
-            LOG(3, "Skipping `{}`...", method->show());
-            return;
-          }
+    unsigned int threads = number_of_threads(context);
 
-          auto new_model = analyze(context, registry, old_model);
+    if (context.options->scc_local_fixpoint()) {
+      using Component = const std::vector<const Method*>*;
+      auto queue = WorkQueue<Component>(
+          context.worker_pool.get(),
+          [&](WorkQueue<Component>::WorkerState* worker_state,
+              Component component) {
+            if (deadline.expired()) {
+              for (const auto* method : *component) {
+                if (methods_to_analyze.contains(method)) {
+                  deadline.skip(method);
+                }
+              }
+              return;
+            }
+            analyze_component(
+                context,
+                registry,
+                *component,
+                methods_to_analyze,
+                new_methods_to_analyze,
+                inputs,
+                worker_state->worker_id());
+          },
+          threads);
+      context.scheduler->schedule_components(
+          methods_to_analyze,
+          [&](const std::vector<const Method*>* component,
+              std::size_t worker_id) { queue.add_item(component, worker_id); },
+          threads);
+      queue.run_all();
+    } else {
+      std::atomic<std::size_t> method_iteration(0);
+      auto queue = WorkQueue<const Method*>(
+          context.worker_pool.get(),
+          [&](WorkQueue<const Method*>::WorkerState* worker_state,
+              const Method* method) {
+            if (deadline.expired()) {
+              deadline.skip(method);
+              return;
+            }
 
-          new_model.join_with(old_model);
+            method_iteration++;
+            if (method_iteration % 10000 == 0) {
+              LOG(1,
+                  "Processed {}/{} methods.",
+                  method_iteration.load(),
+                  methods_to_analyze.size());
+            } else if (method_iteration % 100 == 0) {
+              LOG(4,
+                  "Processed {}/{} methods.",
+                  method_iteration.load(),
+                  methods_to_analyze.size());
+            }
 
-          if (!new_model.leq(old_model)) {
-            if (!context.call_graph->callees(method).empty() ||
-                !context.call_graph->artificial_callees(method).empty()) {
-              new_methods_to_analyze->insert(method);
+            if (context.numa_placement != nullptr) {
+              context.numa_placement->enter(
+                  worker_state->worker_id(), method);
             }
-            for (const auto* dependency :
-                 context.dependencies->dependencies(method)) {
-              new_methods_to_analyze->insert(dependency);
+            WorkerSampleScope sample_scope(
+                context.worker_sampler.get(),
+                worker_state->worker_id(),
+                method);
+            if (analyze_and_update(context, registry, inputs, method)) {
+              if (has_callees(context, method)) {
+                new_methods_to_analyze.insert(method);
+              }
+              for (const auto* dependency :
+                   context.dependencies->dependencies(method)) {
+                new_methods_to_analyze.insert(dependency);
+              }
             }
-          }
-
-          registry.set(new_model);
-        },
-        threads);
-    context.scheduler->schedule(
-        *methods_to_analyze,
-        [&](const Method* method, std::size_t worker_id) {
-          queue.add_item(method, worker_id);
-        },
-        threads);
-    queue.run_all();
+          },
+          threads);
+      context.scheduler->schedule(
+          methods_to_analyze,
+          [&](const Method* method, std::size_t worker_id) {
+            queue.add_item(method, worker_id);
+          },
+          threads);
+      queue.run_all();
+    }
+    context.statistics->merge();
 
     LOG(2,
         "Global fixpoint iteration completed in {:.2f}s.",
         iteration_timer.duration_in_seconds());
 
-    methods_to_analyze = std::move(new_methods_to_analyze);
+    if (context.issue_stream != nullptr) {
+      auto written = context.issue_stream->write(registry, methods_to_analyze);
+      LOG(2, "Streamed issues of {} methods.", written);
+    }
+
+    bool spill = context.options->spill_cold_models();
+    bool release = context.options->release_converged_methods();
+    if ((spill || release) && !new_methods_to_analyze.empty()) {
+      auto live = live_methods(context, new_methods_to_analyze);
+      if (spill) {
+        spill_cold_models(context, registry, live);
+      }
+      if (release) {
+        release_converged_methods(context, live, released_methods);
+      }
+    }
+
+    methods_to_analyze.swap(new_methods_to_analyze);
+
+    if (checkpoint != nullptr && iteration % *checkpoint_interval == 0 &&
+        !methods_to_analyze.empty()) {
+      checkpoint->write(context, registry, iteration, methods_to_analyze);
+    }
   }
 
   context.statistics->log_number_iterations(iteration);
+}
+
+/**
+ * Scheduling state of the methods in the continuous worklist.
+ *
+ * A method is `Pending` when it is in the work queue and `Running` while a
+ * worker analyzes it. A method that is invalidated while running becomes
+ * `RunningAndPending` and is pushed back in the queue when its analysis
+ * finishes, which guarantees that a method is never analyzed by two workers
+ * at the same time.
+ */
+class WorklistState final {
+ private:
+  enum class Status {
+    Idle,
+    Pending,
+    Deferred,
+    Running,
+    RunningAndPending,
+  };
+
+  struct MethodState {
+    Status status = Status::Idle;
+    std::size_t analyses = 0;
+  };
+
+ public:
+  /* Returns true if the method needs to be pushed in the work queue. */
+  bool enqueue(const Method* method) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& state = states_[method];
+    switch (state.status) {
+      case Status::Idle:
+        state.status = Status::Pending;
+        return true;
+      case Status::Running:
+        state.status = Status::RunningAndPending;
+        return false;
+      default:
+        return false;
+    }
+  }
+
+  /**
+   * Returns true if the analysis of the method should be delayed because one
+   * of its callees is still pending. A method is only delayed once per
+   * enqueue, to guarantee progress within cycles.
+   */
+  bool defer(
+      const Method* method,
+      const std::vector<const Method*>& callees) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& state = states_[method];
+    if (state.status != Status::Pending) {
+      return false;
+    }
+    for (const auto* callee : callees) {
+      auto found = states_.find(callee);
+      if (callee != method && found != states_.end() &&
+          (found->second.status == Status::Pending ||
+           found->second.status == Status::Deferred)) {
+        state.status = Status::Deferred;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /* Mark the method as running and return how many times it was analyzed. */
+  std::size_t start(const Method* method) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& state = states_[method];
+    state.status = Status::Running;
+    return ++state.analyses;
+  }
+
+  /* Returns true if the method needs to be pushed back in the work queue. */
+  bool finish(const Method* method) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& state = states_[method];
+    if (state.status == Status::RunningAndPending) {
+      state.status = Status::Pending;
+      return true;
+    }
+    state.status = Status::Idle;
+    return false;
+  }
+
+  std::size_t maximum_analyses() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::size_t result = 0;
+    for (const auto& [method, state] : states_) {
+      result = std::max(result, state.analyses);
+    }
+    return result;
+  }
+
+ private:
+  mutable std::mutex mutex_;
+  std::unordered_map<const Method*, MethodState> states_;
+};
+
+/**
+ * Compute the global fixpoint with a single continuous work queue.
+ *
+ * Instead of waiting for the end of a global iteration, a method whose model
+ * changed immediately pushes its dependencies in the queue of the current
+ * worker. A caller that is popped while one of its callees is still pending
+ * is pushed back once, so that the callee is analyzed first.
+ */
+void run_worklist(
+    Context& context,
+    Registry& registry,
+    const std::unordered_set<const Method*>& initial_methods,
+    FixpointDeadline& deadline,
+    AnalysisInputs& inputs) {
+  WorklistState state;
+  unsigned int threads = number_of_threads(context);
+
+  LOG(1,
+      "Computing global fixpoint with a continuous worklist... (Memory used, RSS: {:.2f}GB)",
+      resident_set_size_in_gb());
+
+  std::atomic<std::size_t> method_iteration(0);
+  auto queue = WorkQueue<const Method*>(
+      context.worker_pool.get(),
+      [&](WorkQueue<const Method*>::WorkerState* worker_state,
+          const Method* method) {
+        std::vector<const Method*> callees;
+        for (const auto& call_target : context.call_graph->callees(method)) {
+          if (call_target.resolved()) {
+            callees.push_back(call_target.resolved_base_callee());
+          }
+        }
+        if (deadline.expired()) {
+          deadline.skip(method);
+          return;
+        }
+        if (state.defer(method, callees)) {
+          worker_state->push_task(method);
+          return;
+        }
+
+        auto analyses = state.start(method);
+        if (analyses > context.heuristics->get(method).max_number_iterations) {
+          ERROR(1, "Too many iterations");
+          LOG(1, "Unstable method is:\n`{}`", method->show());
+          throw std::runtime_error("Too many iterations, exiting.");
+        }
+
+        method_iteration++;
+        if (method_iteration % 10000 == 0) {
+          auto resident_set_size = resident_set_size_in_gb();
+          context.statistics->log_resident_set_size(resident_set_size);
+          if (context.memory_budget != nullptr) {
+            context.memory_budget->update(resident_set_size);
+          }
+          if (context.issue_stream != nullptr) {
+            context.issue_stream->write(registry);
+          }
+          LOG(1,
+              "Processed {} methods. (Memory used, RSS: {:.2f}GB)",
+              method_iteration.load(),
+              resident_set_size);
+        }
+
+        if (context.numa_placement != nullptr) {
+          context.numa_placement->enter(worker_state->worker_id(), method);
+        }
+        WorkerSampleScope sample_scope(
+            context.worker_sampler.get(), worker_state->worker_id(), method);
+        if (analyze_and_update(context, registry, inputs, method)) {
+          if (!callees.empty() ||
+              !context.call_graph->artificial_callees(method).empty()) {
+            state.enqueue(method);
+          }
+          for (const auto* dependency :
+               context.dependencies->dependencies(method)) {
+            if (state.enqueue(dependency)) {
+              worker_state->push_task(dependency);
+            }
+          }
+        }
+
+        if (state.finish(method)) {
+          worker_state->push_task(method);
+        }
+      },
+      threads);
+
+  MethodBitset methods_to_analyze(*context.methods);
+  for (const auto* method : initial_methods) {
+    methods_to_analyze.insert(method);
+  }
+  context.scheduler->schedule(
+      methods_to_analyze,
+      [&](const Method* method, std::size_t worker_id) {
+        if (state.enqueue(method)) {
+          queue.add_item(method, worker_id);
+        }
+      },
+      threads);
+  queue.run_all();
+
+  if (context.issue_stream != nullptr) {
+    context.issue_stream->write(registry);
+  }
+  context.statistics->log_resident_set_size(resident_set_size_in_gb());
+  context.statistics->log_number_iterations(state.maximum_analyses());
+  LOG(1, "Analyzed {} methods.", method_iteration.load());
+}
+
+} // namespace
+
+void Interprocedural::run_analysis(Context& context, Registry& registry) {
+  std::unordered_set<const Method*> methods_to_analyze(
+      context.methods->begin(), context.methods->end());
+  run_analysis(context, registry, methods_to_analyze);
+}
+
+void Interprocedural::run_analysis(
+    Context& context,
+    Registry& registry,
+    const std::unordered_set<const Method*>& methods_to_analyze) {
+  LOG(1, "Computing global fixpoint...");
+
+  FixpointDeadline deadline(*context.options);
+  AnalysisInputs inputs(context.methods->size());
+  if (context.worker_sampler != nullptr) {
+    context.worker_sampler->start();
+  }
+  // When resuming, the worklist of the checkpoint replaces the given methods.
+  std::optional<Checkpoint::State> resumed_state;
+  if (const auto& resume_from = context.options->resume_from()) {
+    resumed_state = Checkpoint::load(context, registry, *resume_from);
+  }
+  const auto& initial_methods = resumed_state
+      ? resumed_state->methods_to_analyze
+      : methods_to_analyze;
+  std::size_t initial_iteration = resumed_state ? resumed_state->iteration : 0;
+
+  if (context.options->worklist_fixpoint()) {
+    run_worklist(context, registry, initial_methods, deadline, inputs);
+  } else {
+    run_global_iterations(
+        context, registry, initial_methods, initial_iteration, deadline, inputs);
+  }
+  if (context.worker_sampler != nullptr) {
+    context.worker_sampler->stop();
+  }
+  deadline.log(*context.statistics);
+  if (context.duplicate_methods != nullptr) {
+    LOG(1,
+        "Reused the models of duplicate methods {} times.",
+        context.duplicate_methods->reuses());
+  }
+  if (context.trivial_methods != nullptr) {
+    LOG(1,
+        "Built the models of {} trivial methods without running the fixpoint.",
+        context.trivial_methods->models_built());
+  }
+  registry.restore_spilled_models();
+
   LOG(2, "Global fixpoint reached.");
 }
 
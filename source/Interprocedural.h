@@ -7,6 +7,8 @@
 
 #pragma once
 
+#include <unordered_set>
+
 #include <mariana-trench/Context.h>
 #include <mariana-trench/Registry.h>
 
@@ -15,6 +17,15 @@ namespace marianatrench {
 class Interprocedural final {
  public:
   static void run_analysis(Context& context, Registry& registry);
+
+  /**
+   * Compute the global fixpoint, starting from the given set of methods, or
+   * from the checkpoint given by `--resume-from`.
+   */
+  static void run_analysis(
+      Context& context,
+      Registry& registry,
+      const std::unordered_set<const Method*>& methods_to_analyze);
 };
 
 } // namespace marianatrench
@@ -5,6 +5,11 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <vector>
+
 #include <boost/functional/hash.hpp>
 
 #include <Show.h>
@@ -14,11 +19,38 @@
 
 namespace marianatrench {
 
+namespace {
+
+std::vector<Frame> flatten(const Taint& taint) {
+  std::vector<Frame> frames;
+  for (const auto& frame_set : taint) {
+    for (const auto& frame : frame_set) {
+      frames.push_back(frame);
+    }
+  }
+  frames.shrink_to_fit();
+  return frames;
+}
+
+std::size_t taint_frames(const Taint& taint) {
+  std::size_t frames = 0;
+  for (const auto& frame_set : taint) {
+    frames += static_cast<std::size_t>(
+        std::distance(frame_set.begin(), frame_set.end()));
+  }
+  return frames;
+}
+
+} // namespace
+
 bool Issue::leq(const Issue& other) const {
   if (is_bottom()) {
     return true;
   } else if (other.is_bottom()) {
     return false;
+  } else if (compact_ != nullptr || other.compact_ != nullptr) {
+    // Compact issues are final, hence they are only compared for equality.
+    return equals(other);
   } else {
     return rule_ == other.rule_ && position_ == other.position_ &&
         sources_.leq(other.sources_) && sinks_.leq(other.sinks_);
@@ -30,9 +62,17 @@ bool Issue::equals(const Issue& other) const {
     return other.is_bottom();
   } else if (other.is_bottom()) {
     return false;
+  } else if (rule_ != other.rule_ || position_ != other.position_) {
+    return false;
+  } else if (compact_ != nullptr || other.compact_ != nullptr) {
+    if (compact_ == other.compact_) {
+      return true;
+    }
+    return compact_ != nullptr && other.compact_ != nullptr &&
+        compact_->sources == other.compact_->sources &&
+        compact_->sinks == other.compact_->sinks;
   } else {
-    return rule_ == other.rule_ && position_ == other.position_ &&
-        sources_ == other.sources_ && sinks_ == other.sinks_;
+    return sources_ == other.sources_ && sinks_ == other.sinks_;
   }
 }
 
@@ -46,6 +86,7 @@ void Issue::join_with(const Issue& other) {
   } else {
     mt_assert(rule_ == other.rule_);
     mt_assert(position_ == other.position_);
+    mt_assert(compact_ == nullptr && other.compact_ == nullptr);
 
     sources_.join_with(other.sources_);
     sinks_.join_with(other.sinks_);
@@ -64,6 +105,7 @@ void Issue::widen_with(const Issue& other) {
   } else {
     mt_assert(rule_ == other.rule_);
     mt_assert(position_ == other.position_);
+    mt_assert(compact_ == nullptr && other.compact_ == nullptr);
 
     sources_.widen_with(other.sources_);
     sinks_.widen_with(other.sinks_);
@@ -80,6 +122,7 @@ void Issue::meet_with(const Issue& other) {
   } else {
     mt_assert(rule_ == other.rule_);
     mt_assert(position_ == other.position_);
+    mt_assert(compact_ == nullptr && other.compact_ == nullptr);
 
     sources_.meet_with(other.sources_);
     sinks_.meet_with(other.sinks_);
@@ -94,6 +137,7 @@ void Issue::narrow_with(const Issue& other) {
   } else {
     mt_assert(rule_ == other.rule_);
     mt_assert(position_ == other.position_);
+    mt_assert(compact_ == nullptr && other.compact_ == nullptr);
 
     sources_.narrow_with(other.sources_);
     sinks_.narrow_with(other.sinks_);
@@ -116,6 +160,7 @@ void Issue::filter_sources(
     const std::function<
         bool(const Method* MT_NULLABLE, const AccessPath&, const Kind*)>&
         predicate) {
+  mt_assert(compact_ == nullptr);
   sources_.filter_invalid_frames(predicate);
 }
 
@@ -123,22 +168,76 @@ void Issue::filter_sinks(
     const std::function<
         bool(const Method* MT_NULLABLE, const AccessPath&, const Kind*)>&
         predicate) {
+  mt_assert(compact_ == nullptr);
   sinks_.filter_invalid_frames(predicate);
 }
 
 FeatureMayAlwaysSet Issue::features() const {
+  if (compact_ != nullptr) {
+    return compact_->features;
+  }
   auto source_features = sources_.features_joined();
   auto sink_features = sinks_.features_joined();
   source_features.add(sink_features);
   return source_features;
 }
 
+void Issue::compact() {
+  if (compact_ != nullptr || is_bottom()) {
+    return;
+  }
+  compact_ = std::make_shared<const Compact>(
+      Compact{flatten(sources_), flatten(sinks_), features()});
+  sources_.set_to_bottom();
+  sinks_.set_to_bottom();
+}
+
+std::size_t Issue::frames_size() const {
+  if (compact_ != nullptr) {
+    return compact_->sources.size() + compact_->sinks.size();
+  }
+  return taint_frames(sources_) + taint_frames(sinks_);
+}
+
+std::vector<const Kind*> Issue::kinds() const {
+  std::vector<const Kind*> kinds;
+  if (compact_ != nullptr) {
+    for (const auto* frames : {&compact_->sources, &compact_->sinks}) {
+      for (const auto& frame : *frames) {
+        kinds.push_back(frame.kind());
+      }
+    }
+  } else {
+    for (const auto* taint : {&sources_, &sinks_}) {
+      for (const auto& frames : *taint) {
+        kinds.push_back(frames.kind());
+      }
+    }
+  }
+  std::sort(kinds.begin(), kinds.end());
+  kinds.erase(std::unique(kinds.begin(), kinds.end()), kinds.end());
+  return kinds;
+}
+
 Json::Value Issue::to_json() const {
   mt_assert(!is_bottom());
 
   auto value = Json::Value(Json::objectValue);
-  value["sources"] = sources_.to_json();
-  value["sinks"] = sinks_.to_json();
+  if (compact_ != nullptr) {
+    // Same as `Taint::to_json`, which writes frames in iteration order.
+    auto frames_to_json = [](const std::vector<Frame>& frames) {
+      auto value = Json::Value(Json::arrayValue);
+      for (const auto& frame : frames) {
+        value.append(frame.to_json());
+      }
+      return value;
+    };
+    value["sources"] = frames_to_json(compact_->sources);
+    value["sinks"] = frames_to_json(compact_->sinks);
+  } else {
+    value["sources"] = sources_.to_json();
+    value["sinks"] = sinks_.to_json();
+  }
   value["rule"] = Json::Value(rule_->code());
   value["position"] = position_->to_json();
   JsonValidation::update_object(value, features().to_json());
@@ -147,8 +246,13 @@ Json::Value Issue::to_json() const {
 }
 
 std::ostream& operator<<(std::ostream& out, const Issue& issue) {
-  out << "Issue(sources=" << issue.sources_ << ", sinks=" << issue.sinks_
-      << ", rule=";
+  out << "Issue(";
+  if (issue.compact_ != nullptr) {
+    out << "frames=" << issue.frames_size();
+  } else {
+    out << "sources=" << issue.sources_ << ", sinks=" << issue.sinks_;
+  }
+  out << ", rule=";
   if (issue.rule_ != nullptr) {
     out << issue.rule_->code();
   } else {
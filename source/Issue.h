@@ -7,6 +7,9 @@
 
 #pragma once
 
+#include <memory>
+#include <vector>
+
 #include <json/json.h>
 
 #include <AbstractDomain.h>
@@ -67,8 +70,9 @@ class Issue final : public sparta::AbstractDomain<Issue> {
   }
 
   bool is_bottom() const override {
-    return sources_.is_bottom() || sinks_.is_bottom() || rule_ == nullptr ||
-        position_ == nullptr;
+    return (compact_ == nullptr &&
+            (sources_.is_bottom() || sinks_.is_bottom())) ||
+        rule_ == nullptr || position_ == nullptr;
   }
 
   bool is_top() const override {
@@ -80,6 +84,7 @@ class Issue final : public sparta::AbstractDomain<Issue> {
     sinks_.set_to_bottom();
     rule_ = nullptr;
     position_ = nullptr;
+    compact_ = nullptr;
   }
 
   void set_to_top() override {
@@ -110,6 +115,28 @@ class Issue final : public sparta::AbstractDomain<Issue> {
 
   FeatureMayAlwaysSet features() const;
 
+  /**
+   * Replace the sources and sinks by flat vectors of their frames, along with
+   * their joined features.
+   *
+   * Issues are never joined once the fixpoint and the post-processing of
+   * traces are done, hence the maps grouping frames by kind, callee and call
+   * position only cost memory at that point. The json representation and the
+   * features of the issue are unchanged, but `sources()` and `sinks()` are
+   * bottom and the issue cannot be joined or filtered anymore.
+   */
+  void compact();
+
+  bool is_compact() const {
+    return compact_ != nullptr;
+  }
+
+  /* Return the number of source and sink frames. */
+  std::size_t frames_size() const;
+
+  /* Return the distinct kinds of the source and sink frames. */
+  std::vector<const Kind*> kinds() const;
+
   Json::Value to_json() const;
 
   // Describe how to join issues together in `IssueSet`.
@@ -129,6 +156,14 @@ class Issue final : public sparta::AbstractDomain<Issue> {
   Taint sinks_;
   const Rule* MT_NULLABLE rule_;
   const Position* MT_NULLABLE position_;
+
+  struct Compact {
+    std::vector<Frame> sources;
+    std::vector<Frame> sinks;
+    FeatureMayAlwaysSet features;
+  };
+  // Shared between copies, null unless `compact` was called.
+  std::shared_ptr<const Compact> compact_;
 };
 
 } // namespace marianatrench
@@ -0,0 +1,173 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <algorithm>
+#include <functional>
+#include <utility>
+
+#include <mariana-trench/IssueSet.h>
+
+namespace marianatrench {
+
+namespace {
+
+/* Order issues by group, i.e by rule and position. */
+bool group_less(const Issue& left, const Issue& right) {
+  if (left.rule() != right.rule()) {
+    return std::less<const Rule*>()(left.rule(), right.rule());
+  }
+  return std::less<const Position*>()(left.position(), right.position());
+}
+
+} // namespace
+
+IssueSet::IssueSet(const Issue& issue) {
+  add(issue);
+}
+
+IssueSet::IssueSet(std::initializer_list<Issue> issues) {
+  for (const auto& issue : issues) {
+    add(issue);
+  }
+}
+
+void IssueSet::add(const Issue& issue) {
+  if (issue.is_bottom()) {
+    return;
+  }
+
+  auto found =
+      std::lower_bound(issues_.begin(), issues_.end(), issue, group_less);
+  if (found != issues_.end() && !group_less(issue, *found)) {
+    found->join_with(issue);
+  } else {
+    issues_.insert(found, issue);
+  }
+}
+
+bool IssueSet::leq(const IssueSet& other) const {
+  if (size() > other.size()) {
+    return false;
+  }
+
+  auto right = other.issues_.begin();
+  auto right_end = other.issues_.end();
+  for (const auto& issue : issues_) {
+    while (right != right_end && group_less(*right, issue)) {
+      ++right;
+    }
+    if (right == right_end || group_less(issue, *right) ||
+        !issue.leq(*right)) {
+      return false;
+    }
+    ++right;
+  }
+  return true;
+}
+
+bool IssueSet::equals(const IssueSet& other) const {
+  if (size() != other.size()) {
+    return false;
+  }
+
+  for (std::size_t index = 0; index < issues_.size(); index++) {
+    const auto& left = issues_[index];
+    const auto& right = other.issues_[index];
+    if (group_less(left, right) || group_less(right, left) ||
+        !(left == right)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void IssueSet::join_with(const IssueSet& other) {
+  if (other.empty()) {
+    return;
+  }
+  if (empty()) {
+    issues_ = other.issues_;
+    return;
+  }
+
+  // Common case: all groups of `other` already exist, join in place.
+  bool has_new_groups = false;
+  {
+    auto left = issues_.begin();
+    auto left_end = issues_.end();
+    for (const auto& issue : other.issues_) {
+      while (left != left_end && group_less(*left, issue)) {
+        ++left;
+      }
+      if (left == left_end || group_less(issue, *left)) {
+        has_new_groups = true;
+        break;
+      }
+      left->join_with(issue);
+      ++left;
+    }
+  }
+  if (!has_new_groups) {
+    return;
+  }
+
+  // Merge both sorted vectors. Joining an issue twice with the same issue is
+  // harmless, hence the partial join above does not need to be undone.
+  Vector result;
+  result.reserve(issues_.size() + other.issues_.size());
+  auto left = std::make_move_iterator(issues_.begin());
+  auto left_end = std::make_move_iterator(issues_.end());
+  auto right = other.issues_.begin();
+  auto right_end = other.issues_.end();
+  while (left != left_end && right != right_end) {
+    if (group_less(*left.base(), *right)) {
+      result.push_back(*left++);
+    } else if (group_less(*right, *left.base())) {
+      result.push_back(*right++);
+    } else {
+      left.base()->join_with(*right++);
+      result.push_back(*left++);
+    }
+  }
+  result.insert(result.end(), left, left_end);
+  result.insert(result.end(), right, right_end);
+  issues_ = std::move(result);
+}
+
+void IssueSet::widen_with(const IssueSet& other) {
+  join_with(other);
+}
+
+void IssueSet::meet_with(const IssueSet& /* other */) {
+  mt_unreachable(); // Not implemented.
+}
+
+void IssueSet::narrow_with(const IssueSet& other) {
+  meet_with(other);
+}
+
+void IssueSet::erase_bottom() {
+  issues_.erase(
+      std::remove_if(
+          issues_.begin(),
+          issues_.end(),
+          [](const Issue& issue) { return issue.is_bottom(); }),
+      issues_.end());
+}
+
+std::ostream& operator<<(std::ostream& out, const IssueSet& issues) {
+  out << "{";
+  for (auto iterator = issues.begin(); iterator != issues.end();) {
+    out << *iterator++;
+    if (iterator != issues.end()) {
+      out << ", ";
+    }
+  }
+  return out << "}";
+}
+
+} // namespace marianatrench
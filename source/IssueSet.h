@@ -7,15 +7,141 @@
 
 #pragma once
 
-#include <mariana-trench/GroupHashedSetAbstractDomain.h>
+#include <algorithm>
+#include <cstddef>
+#include <initializer_list>
+#include <ostream>
+#include <vector>
+
+#include <AbstractDomain.h>
+
+#include <mariana-trench/Assert.h>
 #include <mariana-trench/Issue.h>
 
 namespace marianatrench {
 
 /**
  * Represents an abstract set of issues.
+ *
+ * Issues are grouped by rule and position. Groups are stored in a vector
+ * sorted by (rule, position), hence joins and comparisons are linear merges
+ * of the two vectors, and the taint of two issues is only compared or joined
+ * when they belong to the same group.
  */
-using IssueSet =
-    GroupHashedSetAbstractDomain<Issue, Issue::GroupHash, Issue::GroupEqual>;
+class IssueSet final : public sparta::AbstractDomain<IssueSet> {
+ private:
+  using Vector = std::vector<Issue>;
+
+ public:
+  // C++ container concept member types
+  using iterator = Vector::const_iterator;
+  using const_iterator = iterator;
+  using value_type = Issue;
+  using difference_type = std::ptrdiff_t;
+  using size_type = std::size_t;
+  using const_reference = const Issue&;
+  using const_pointer = const Issue*;
+
+ public:
+  /* Create the bottom (i.e, empty) issue set. */
+  IssueSet() = default;
+
+  explicit IssueSet(const Issue& issue);
+
+  explicit IssueSet(std::initializer_list<Issue> issues);
+
+  IssueSet(const IssueSet&) = default;
+  IssueSet(IssueSet&&) = default;
+  IssueSet& operator=(const IssueSet&) = default;
+  IssueSet& operator=(IssueSet&&) = default;
+
+  static IssueSet bottom() {
+    return IssueSet();
+  }
+
+  static IssueSet top() {
+    mt_unreachable(); // Not implemented.
+  }
+
+  bool is_bottom() const override {
+    return issues_.empty();
+  }
+
+  bool is_top() const override {
+    return false;
+  }
+
+  void set_to_bottom() override {
+    issues_.clear();
+  }
+
+  void set_to_top() override {
+    mt_unreachable(); // Not implemented.
+  }
+
+  std::size_t size() const {
+    return issues_.size();
+  }
+
+  bool empty() const {
+    return issues_.empty();
+  }
+
+  iterator begin() const {
+    return issues_.cbegin();
+  }
+
+  iterator end() const {
+    return issues_.cend();
+  }
+
+  void add(const Issue& issue);
+
+  bool leq(const IssueSet& other) const override;
+
+  bool equals(const IssueSet& other) const override;
+
+  void join_with(const IssueSet& other) override;
+
+  void widen_with(const IssueSet& other) override;
+
+  void meet_with(const IssueSet& other) override;
+
+  void narrow_with(const IssueSet& other) override;
+
+  /* Update all issues without changing their rule or position. */
+  template <typename Function> // void(Issue&)
+  void map(Function&& f) {
+    for (auto& issue : issues_) {
+      mt_if_expensive_assert(const auto* rule = issue.rule());
+      mt_if_expensive_assert(const auto* position = issue.position());
+      f(issue);
+      mt_expensive_assert(
+          issue.is_bottom() ||
+          (issue.rule() == rule && issue.position() == position));
+    }
+    erase_bottom();
+  }
+
+  /* Remove all issues that do not match the given predicate. */
+  template <typename Predicate> // bool(const Issue&)
+  void filter(Predicate&& predicate) {
+    issues_.erase(
+        std::remove_if(
+            issues_.begin(),
+            issues_.end(),
+            [&](const Issue& issue) { return !predicate(issue); }),
+        issues_.end());
+  }
+
+  friend std::ostream& operator<<(std::ostream& out, const IssueSet& issues);
+
+ private:
+  void erase_bottom();
+
+ private:
+  // Sorted by `(rule, position)`, without bottom issues.
+  Vector issues_;
+};
 
 } // namespace marianatrench
@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <functional>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
+#include <fmt/format.h>
+
+#include <mariana-trench/IssueStream.h>
+#include <mariana-trench/JsonValidation.h>
+#include <mariana-trench/Log.h>
+
+namespace marianatrench {
+
+IssueStream::IssueStream(
+    const boost::filesystem::path& path,
+    const Methods& methods,
+    std::optional<std::unordered_set<int>> rule_codes)
+    : methods_(methods),
+      rule_codes_(std::move(rule_codes)),
+      stream_(path.native(), std::ios_base::out | std::ios_base::trunc),
+      writer_(JsonValidation::compact_writer()),
+      size_(0),
+      hashes_(methods.size(), 0) {
+  if (!stream_.is_open()) {
+    throw std::runtime_error(
+        fmt::format("Unable to write issues to `{}`.", path.native()));
+  }
+}
+
+std::size_t IssueStream::write(
+    const Registry& registry,
+    const MethodBitset& methods) {
+  std::unique_lock<std::mutex> lock(mutex_, std::try_to_lock);
+  if (!lock.owns_lock()) {
+    return 0;
+  }
+
+  std::size_t written = 0;
+  methods.visit([&](const Method* method) {
+    if (write_method(registry, method)) {
+      written++;
+    }
+  });
+  stream_.flush();
+  return written;
+}
+
+std::size_t IssueStream::write(const Registry& registry) {
+  std::unique_lock<std::mutex> lock(mutex_, std::try_to_lock);
+  if (!lock.owns_lock()) {
+    return 0;
+  }
+
+  std::size_t written = 0;
+  for (const auto* method : methods_) {
+    if (write_method(registry, method)) {
+      written++;
+    }
+  }
+  stream_.flush();
+  return written;
+}
+
+std::size_t IssueStream::size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return size_;
+}
+
+bool IssueStream::write_method(const Registry& registry, const Method* method) {
+  if (method->id() >= hashes_.size()) {
+    return false;
+  }
+
+  auto model = registry.get_snapshot(method);
+  if (model->issues().is_bottom()) {
+    return false;
+  }
+
+  auto issues = Json::Value(Json::arrayValue);
+  for (const auto& issue : model->issues()) {
+    if (rule_codes_ && rule_codes_->count(issue.rule()->code()) == 0) {
+      continue;
+    }
+    issues.append(issue.to_json());
+  }
+  if (issues.empty()) {
+    return false;
+  }
+  std::stringstream issues_string;
+  writer_->write(issues, &issues_string);
+
+  // Zero is reserved for methods without issues.
+  auto hash = std::hash<std::string>()(issues_string.str()) | 1;
+  auto& previous_hash = hashes_[method->id()];
+  if (hash == previous_hash) {
+    return false;
+  }
+  previous_hash = hash;
+
+  auto value = Json::Value(Json::objectValue);
+  value["method"] = method->to_json();
+  value["issues"] = issues;
+  writer_->write(value, &stream_);
+  stream_ << "\n";
+  size_++;
+  return true;
+}
+
+} // namespace marianatrench
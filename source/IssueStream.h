@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_set>
+#include <vector>
+
+#include <boost/filesystem/path.hpp>
+#include <json/json.h>
+
+#include <mariana-trench/Method.h>
+#include <mariana-trench/MethodBitset.h>
+#include <mariana-trench/Methods.h>
+#include <mariana-trench/Registry.h>
+
+namespace marianatrench {
+
+/**
+ * Stream of the issues found during the global fixpoint, to start triaging
+ * before the end of the analysis, or after it crashed.
+ *
+ * Each line of the file is a compact json object with a `method` and its
+ * `issues`, appended whenever the issues of the method changed since they
+ * were last written. Issues of a method only grow during the fixpoint, hence
+ * readers should only keep the last line of each method. Positions are
+ * provisional: they are refined by `Highlights` in the final models.
+ *
+ * The stream only keeps a hash of the last issues written for each method.
+ * A stream can be restricted to the issues of some rules, e.g the rules of a
+ * rule pack (see `--rule-packs`).
+ */
+class IssueStream final {
+ public:
+  explicit IssueStream(
+      const boost::filesystem::path& path,
+      const Methods& methods,
+      std::optional<std::unordered_set<int>> rule_codes = std::nullopt);
+
+  IssueStream(const IssueStream&) = delete;
+  IssueStream(IssueStream&&) = delete;
+  IssueStream& operator=(const IssueStream&) = delete;
+  IssueStream& operator=(IssueStream&&) = delete;
+  ~IssueStream() = default;
+
+  /**
+   * Append the issues of the given methods that changed since they were last
+   * written, and flush the file. Returns the number of methods written.
+   *
+   * This is thread-safe: if another thread is already writing, this returns
+   * 0 immediately.
+   */
+  std::size_t write(const Registry& registry, const MethodBitset& methods);
+
+  /* Same as above, for all methods. */
+  std::size_t write(const Registry& registry);
+
+  /* Total number of lines appended to the stream. */
+  std::size_t size() const;
+
+ private:
+  bool write_method(const Registry& registry, const Method* method);
+
+ private:
+  const Methods& methods_;
+  // Codes of the rules of the issues to write, all issues if not set.
+  std::optional<std::unordered_set<int>> rule_codes_;
+  mutable std::mutex mutex_;
+  std::ofstream stream_;
+  std::unique_ptr<Json::StreamWriter> writer_;
+  std::size_t size_;
+
+  // Hash of the issues last written, indexed by method identifier (see
+  // `Method::id`). Zero means that no issues were written.
+  std::vector<std::size_t> hashes_;
+};
+
+} // namespace marianatrench
@@ -0,0 +1,190 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <cctype>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+
+#include <boost/filesystem/operations.hpp>
+#include <fmt/format.h>
+
+#include <mariana-trench/JsonArrayFile.h>
+#include <mariana-trench/Log.h>
+
+namespace marianatrench {
+
+namespace {
+
+std::size_t skip_whitespace(std::string_view content, std::size_t offset) {
+  while (offset < content.size() &&
+         std::isspace(static_cast<unsigned char>(content[offset]))) {
+    offset++;
+  }
+  return offset;
+}
+
+std::string_view trim_trailing_whitespace(std::string_view element) {
+  while (!element.empty() &&
+         std::isspace(static_cast<unsigned char>(element.back()))) {
+    element.remove_suffix(1);
+  }
+  return element;
+}
+
+/**
+ * Return the offset of the quote closing the string that contains `offset`.
+ *
+ * Quotes are found with `memchr`, which the C library vectorizes, and a quote
+ * is escaped if it follows an odd number of backslashes. Returns the size of
+ * the content if the string is not terminated.
+ */
+std::size_t find_string_end(std::string_view content, std::size_t offset) {
+  const char* data = content.data();
+  while (offset < content.size()) {
+    const auto* quote = static_cast<const char*>(
+        std::memchr(data + offset, '"', content.size() - offset));
+    if (quote == nullptr) {
+      return content.size();
+    }
+    auto end = static_cast<std::size_t>(quote - data);
+    std::size_t backslashes = 0;
+    while (backslashes < end - offset &&
+           data[end - backslashes - 1] == '\\') {
+      backslashes++;
+    }
+    if (backslashes % 2 == 0) {
+      return end;
+    }
+    offset = end + 1;
+  }
+  return content.size();
+}
+
+} // namespace
+
+JsonArrayFile::JsonArrayFile(const boost::filesystem::path& path)
+    : path_(path) {
+  if (!boost::filesystem::exists(path)) {
+    ERROR(1, "Could not open json file: `{}`.", path.string());
+    throw std::invalid_argument(
+        fmt::format("File `{}` does not exist.", path.string()));
+  }
+  // Mapping an empty file fails, let `split` report the error.
+  if (boost::filesystem::file_size(path) == 0) {
+    elements_ = split(std::string_view());
+    return;
+  }
+
+  file_.open(path);
+  try {
+    elements_ = split(std::string_view(file_.data(), file_.size()));
+  } catch (const std::invalid_argument& exception) {
+    throw std::invalid_argument(fmt::format(
+        "File `{}` is not valid json: {}", path.string(), exception.what()));
+  }
+}
+
+Json::Value JsonArrayFile::parse(std::size_t index) const {
+  static const auto builder = Json::CharReaderBuilder();
+  thread_local std::unique_ptr<Json::CharReader> reader(
+      builder.newCharReader());
+
+  const auto& element = elements_.at(index);
+  std::string errors;
+  Json::Value json;
+  if (!reader->parse(
+          element.data(), element.data() + element.size(), &json, &errors)) {
+    throw std::invalid_argument(fmt::format(
+        "File `{}` is not valid json: element {}: {}",
+        path_.string(),
+        index,
+        errors));
+  }
+  return json;
+}
+
+void JsonArrayFile::for_each(
+    const boost::filesystem::path& path,
+    const std::function<void(const Json::Value&)>& callback) {
+  JsonArrayFile file(path);
+  for (std::size_t index = 0; index < file.size(); index++) {
+    callback(file.parse(index));
+  }
+}
+
+std::vector<std::string_view> JsonArrayFile::split(std::string_view content) {
+  std::vector<std::string_view> elements;
+
+  auto offset = skip_whitespace(content, 0);
+  if (content.substr(offset, 4) == "null" &&
+      skip_whitespace(content, offset + 4) == content.size()) {
+    return elements;
+  }
+  if (offset >= content.size() || content[offset] != '[') {
+    throw std::invalid_argument("Expected a json array.");
+  }
+  offset = skip_whitespace(content, offset + 1);
+  if (offset < content.size() && content[offset] == ']') {
+    offset++;
+  } else {
+    auto start = offset;
+    int depth = 0;
+    bool closed = false;
+    for (; offset < content.size() && !closed; offset++) {
+      switch (content[offset]) {
+        case '"':
+          // Strings are most of the bytes of model files, skip them at once.
+          offset = find_string_end(content, offset + 1);
+          break;
+        case '[':
+        case '{':
+          depth++;
+          break;
+        case '}':
+          depth--;
+          break;
+        case ']':
+          if (depth == 0) {
+            elements.push_back(trim_trailing_whitespace(
+                content.substr(start, offset - start)));
+            closed = true;
+          } else {
+            depth--;
+          }
+          break;
+        case ',':
+          if (depth == 0) {
+            elements.push_back(trim_trailing_whitespace(
+                content.substr(start, offset - start)));
+            start = skip_whitespace(content, offset + 1);
+          }
+          break;
+        default:
+          break;
+      }
+      if (depth < 0) {
+        throw std::invalid_argument("Unbalanced json array.");
+      }
+    }
+    if (!closed) {
+      throw std::invalid_argument("Unterminated json array.");
+    }
+  }
+
+  if (skip_whitespace(content, offset) != content.size()) {
+    throw std::invalid_argument("Unexpected content after the json array.");
+  }
+  for (const auto& element : elements) {
+    if (element.empty()) {
+      throw std::invalid_argument("Empty element in json array.");
+    }
+  }
+  return elements;
+}
+
+} // namespace marianatrench
@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <functional>
+#include <string_view>
+#include <vector>
+
+#include <boost/filesystem/path.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+#include <json/json.h>
+
+namespace marianatrench {
+
+/**
+ * A memory-mapped file containing a json array (or `null`).
+ *
+ * Elements are delimited without being parsed, and each element is only
+ * parsed on request. This avoids holding the whole json tree in memory when
+ * reading large model or configuration files.
+ */
+class JsonArrayFile final {
+ public:
+  /* Throws `std::invalid_argument` if the file does not contain an array. */
+  explicit JsonArrayFile(const boost::filesystem::path& path);
+
+  JsonArrayFile(const JsonArrayFile&) = delete;
+  JsonArrayFile(JsonArrayFile&&) = delete;
+  JsonArrayFile& operator=(const JsonArrayFile&) = delete;
+  JsonArrayFile& operator=(JsonArrayFile&&) = delete;
+  ~JsonArrayFile() = default;
+
+  std::size_t size() const {
+    return elements_.size();
+  }
+
+  /**
+   * Parse the element at the given index.
+   *
+   * This is thread-safe. Throws `std::invalid_argument` if the element is not
+   * valid json.
+   */
+  Json::Value parse(std::size_t index) const;
+
+  /* Parse elements one at a time and call `callback` on each of them. */
+  static void for_each(
+      const boost::filesystem::path& path,
+      const std::function<void(const Json::Value&)>& callback);
+
+  /**
+   * Delimit the elements of the given json array, without parsing them.
+   *
+   * Throws `std::invalid_argument` if the content is not an array.
+   */
+  static std::vector<std::string_view> split(std::string_view content);
+
+ private:
+  boost::filesystem::path path_;
+  boost::iostreams::mapped_file_source file_;
+  std::vector<std::string_view> elements_;
+};
+
+} // namespace marianatrench
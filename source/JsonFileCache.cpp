@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <atomic>
+#include <ctime>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+#include <boost/filesystem/operations.hpp>
+
+#include <mariana-trench/JsonFileCache.h>
+#include <mariana-trench/JsonValidation.h>
+
+namespace marianatrench {
+
+namespace {
+
+struct CachedFile {
+  std::time_t last_write_time;
+  Json::Value value;
+};
+
+std::atomic<bool> enabled_(false);
+std::mutex mutex_;
+std::unordered_map<std::string, CachedFile> files_;
+std::unordered_map<std::string, std::vector<boost::filesystem::path>>
+    directories_;
+
+} // namespace
+
+void JsonFileCache::enable() {
+  enabled_ = true;
+}
+
+bool JsonFileCache::enabled() {
+  return enabled_;
+}
+
+Json::Value JsonFileCache::parse(const boost::filesystem::path& path) {
+  if (!enabled_) {
+    return JsonValidation::parse_json_file(path);
+  }
+
+  auto last_write_time = boost::filesystem::last_write_time(path);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto found = files_.find(path.native());
+    if (found != files_.end() &&
+        found->second.last_write_time == last_write_time) {
+      return found->second.value;
+    }
+  }
+
+  // Parse outside of the lock, files are large.
+  auto value = JsonValidation::parse_json_file(path);
+  std::lock_guard<std::mutex> lock(mutex_);
+  files_.insert_or_assign(path.native(), CachedFile{last_write_time, value});
+  return value;
+}
+
+std::vector<boost::filesystem::path> JsonFileCache::find_json_files(
+    const std::string& directory) {
+  if (enabled_) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto found = directories_.find(directory);
+    if (found != directories_.end()) {
+      return found->second;
+    }
+  }
+
+  std::vector<boost::filesystem::path> paths;
+  for (const auto& entry :
+       boost::filesystem::recursive_directory_iterator(directory)) {
+    if (entry.path().extension() == ".json") {
+      paths.push_back(entry.path());
+    }
+  }
+
+  if (enabled_) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    directories_.insert_or_assign(directory, paths);
+  }
+  return paths;
+}
+
+void JsonFileCache::add_file(
+    const boost::filesystem::path& path,
+    std::time_t last_write_time,
+    Json::Value value) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  files_.insert_or_assign(
+      path.native(), CachedFile{last_write_time, std::move(value)});
+}
+
+void JsonFileCache::add_json_files(
+    const std::string& directory,
+    std::vector<boost::filesystem::path> paths) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  directories_.insert_or_assign(directory, std::move(paths));
+}
+
+} // namespace marianatrench
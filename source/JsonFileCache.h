@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <ctime>
+#include <string>
+#include <vector>
+
+#include <boost/filesystem/path.hpp>
+#include <json/json.h>
+
+namespace marianatrench {
+
+/**
+ * Process-wide cache of the json configuration files (models, model
+ * generators, rules, lifecycles), used when analyzing several applications in
+ * the same process (see `--batch-path`).
+ *
+ * Like the `Logger`, the cache is global. When it is not enabled, files are
+ * read again on each call. Cached files are parsed again if their last write
+ * time changed.
+ */
+class JsonFileCache final {
+ public:
+  /* Start caching files. */
+  static void enable();
+
+  static bool enabled();
+
+  /* Parse the json file at the given path. Thread-safe. */
+  static Json::Value parse(const boost::filesystem::path& path);
+
+  /**
+   * Return the `.json` files found recursively in the given directory, in
+   * the order of the directory traversal. Thread-safe.
+   */
+  static std::vector<boost::filesystem::path> find_json_files(
+      const std::string& directory);
+
+  /**
+   * Add a parsed file, e.g from a configuration bundle. It is parsed again
+   * on use if its last write time is not the given one.
+   */
+  static void add_file(
+      const boost::filesystem::path& path,
+      std::time_t last_write_time,
+      Json::Value value);
+
+  /* Add the `.json` files of a directory, e.g from a configuration bundle. */
+  static void add_json_files(
+      const std::string& directory,
+      std::vector<boost::filesystem::path> paths);
+};
+
+} // namespace marianatrench
@@ -5,10 +5,13 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <memory>
 #include <sstream>
 
 #include <boost/algorithm/string/trim.hpp>
 #include <boost/filesystem/fstream.hpp>
+#include <boost/filesystem/operations.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
 #include <fmt/format.h>
 
 #include <mariana-trench/Assert.h>
@@ -228,12 +231,26 @@ Json::Value JsonValidation::parse_json_file(
     ERROR(1, "Could not open json file: `{}`.", path.string());
     throw;
   }
+  file.close();
 
-  static const auto reader = Json::CharReaderBuilder();
+  // Parse the mapped file directly, instead of copying it into a string
+  // through a stream. Mapping an empty file fails.
+  boost::iostreams::mapped_file_source mapped;
+  const char* begin = "";
+  const char* end = begin;
+  if (boost::filesystem::file_size(path) > 0) {
+    mapped.open(path);
+    begin = mapped.data();
+    end = begin + mapped.size();
+  }
+
+  static const auto builder = Json::CharReaderBuilder();
+  thread_local std::unique_ptr<Json::CharReader> reader(
+      builder.newCharReader());
   std::string errors;
   Json::Value json;
 
-  if (!Json::parseFromStream(reader, file, &json, &errors)) {
+  if (!reader->parse(begin, end, &json, &errors)) {
     throw std::invalid_argument(
         fmt::format("File `{}` is not valid json: {}", path.string(), errors));
   }
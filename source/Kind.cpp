@@ -11,6 +11,8 @@
 
 namespace marianatrench {
 
+std::atomic<std::size_t> Kind::next_id_(0);
+
 Json::Value Kind::to_json() const {
   auto value = Json::Value(Json::objectValue);
   value["kind"] = to_trace_string();
@@ -7,6 +7,8 @@
 
 #pragma once
 
+#include <atomic>
+#include <cstddef>
 #include <ostream>
 #include <string>
 
@@ -22,7 +24,7 @@ namespace marianatrench {
  */
 class Kind {
  public:
-  Kind() = default;
+  Kind() : id_(next_id_.fetch_add(1, std::memory_order_relaxed)) {}
   Kind(const Kind&) = delete;
   Kind(Kind&&) = delete;
   Kind& operator=(const Kind&) = delete;
@@ -56,8 +58,21 @@ class Kind {
    */
   virtual std::string to_trace_string() const = 0;
 
+  /**
+   * Dense identifier of the kind, assigned on construction. This is used to
+   * index tables by kind (see `Rules`).
+   */
+  std::size_t id() const {
+    return id_;
+  }
+
  private:
   friend std::ostream& operator<<(std::ostream& out, const Kind& kind);
+
+ private:
+  static std::atomic<std::size_t> next_id_;
+
+  std::size_t id_;
 };
 
 } // namespace marianatrench
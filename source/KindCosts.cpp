@@ -0,0 +1,169 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <utility>
+
+#include <mariana-trench/KindCosts.h>
+
+namespace marianatrench {
+
+namespace {
+
+constexpr std::uint64_t kNoIdentifier = 0;
+
+std::atomic<std::uint64_t> next_identifier{kNoIdentifier + 1};
+
+struct Counts {
+  std::size_t frames = 0;
+  std::size_t frame_bytes = 0;
+  std::size_t issues = 0;
+};
+
+void count_frames(
+    std::unordered_map<const Kind*, Counts>& counts,
+    const TaintAccessPathTree& tree) {
+  tree.visit([&](const AccessPath& /* access_path */, const Taint& taint) {
+    for (const auto& frame_set : taint) {
+      auto frames = static_cast<std::size_t>(
+          std::distance(frame_set.begin(), frame_set.end()));
+      auto& kind_counts = counts[frame_set.kind()];
+      kind_counts.frames += frames;
+      kind_counts.frame_bytes += sizeof(FrameSet) + frames * sizeof(Frame);
+    }
+  });
+}
+
+} // namespace
+
+KindCosts::KindCosts() : id_(next_identifier.fetch_add(1)) {}
+
+void KindCosts::log(const Kind* kind, Cost cost, double seconds) {
+  auto& buffer = this->buffer();
+  std::lock_guard<std::mutex> lock(buffer.mutex);
+  auto& times = buffer.times[kind];
+  switch (cost) {
+    case Cost::CheckFlows:
+      times.check_flows_seconds += seconds;
+      break;
+    case Cost::Propagate:
+      times.propagate_seconds += seconds;
+      times.propagations++;
+      break;
+  }
+}
+
+KindCosts::Buffer& KindCosts::buffer() {
+  // Same as `Statistics::buffer`.
+  thread_local std::uint64_t cached_id = kNoIdentifier;
+  thread_local Buffer* cached_buffer = nullptr;
+  if (cached_id != id_) {
+    std::lock_guard<std::mutex> lock(buffers_mutex_);
+    buffers_.push_back(std::make_unique<Buffer>());
+    cached_buffer = buffers_.back().get();
+    cached_id = id_;
+  }
+  return *cached_buffer;
+}
+
+Json::Value KindCosts::to_json(
+    const std::vector<std::shared_ptr<const Model>>& models) const {
+  KindTimes times;
+  {
+    std::lock_guard<std::mutex> buffers_lock(buffers_mutex_);
+    for (const auto& buffer : buffers_) {
+      std::lock_guard<std::mutex> lock(buffer->mutex);
+      for (const auto& [kind, buffer_times] : buffer->times) {
+        auto& kind_times = times[kind];
+        kind_times.check_flows_seconds += buffer_times.check_flows_seconds;
+        kind_times.propagate_seconds += buffer_times.propagate_seconds;
+        kind_times.propagations += buffer_times.propagations;
+      }
+    }
+  }
+
+  std::unordered_map<const Kind*, Counts> counts;
+  for (const auto& model : models) {
+    count_frames(counts, model->generations());
+    count_frames(counts, model->parameter_sources());
+    count_frames(counts, model->sinks());
+    for (const auto& issue : model->issues()) {
+      for (const auto* kind : issue.kinds()) {
+        counts[kind].issues++;
+      }
+    }
+  }
+
+  std::vector<const Kind*> kinds;
+  kinds.reserve(counts.size() + times.size());
+  for (const auto& [kind, _] : counts) {
+    kinds.push_back(kind);
+  }
+  for (const auto& [kind, _] : times) {
+    if (counts.count(kind) == 0) {
+      kinds.push_back(kind);
+    }
+  }
+  auto frames = [&](const Kind* kind) {
+    auto found = counts.find(kind);
+    return found != counts.end() ? found->second.frames : 0;
+  };
+  std::sort(
+      kinds.begin(), kinds.end(), [&](const Kind* left, const Kind* right) {
+        auto left_frames = frames(left);
+        auto right_frames = frames(right);
+        if (left_frames != right_frames) {
+          return left_frames > right_frames;
+        }
+        return left->to_trace_string() < right->to_trace_string();
+      });
+
+  auto value = Json::Value(Json::arrayValue);
+  for (const auto* kind : kinds) {
+    auto kind_counts = counts[kind];
+    auto kind_times = times[kind];
+    auto kind_value = Json::Value(Json::objectValue);
+    kind_value["kind"] = Json::Value(kind->to_trace_string());
+    kind_value["frames"] =
+        Json::Value(static_cast<Json::UInt64>(kind_counts.frames));
+    kind_value["frame_bytes"] =
+        Json::Value(static_cast<Json::UInt64>(kind_counts.frame_bytes));
+    kind_value["issues"] =
+        Json::Value(static_cast<Json::UInt64>(kind_counts.issues));
+    kind_value["check_flows_seconds"] =
+        Json::Value(kind_times.check_flows_seconds);
+    kind_value["propagate_seconds"] =
+        Json::Value(kind_times.propagate_seconds);
+    kind_value["propagations"] =
+        Json::Value(static_cast<Json::UInt64>(kind_times.propagations));
+    value.append(kind_value);
+  }
+  return value;
+}
+
+KindCostScope::KindCostScope(
+    KindCosts* MT_NULLABLE costs,
+    const Kind* kind,
+    KindCosts::Cost cost)
+    : costs_(costs), kind_(kind), cost_(cost) {
+  if (costs_ != nullptr) {
+    start_ = std::chrono::steady_clock::now();
+  }
+}
+
+KindCostScope::~KindCostScope() {
+  if (costs_ == nullptr) {
+    return;
+  }
+  std::chrono::duration<double> duration =
+      std::chrono::steady_clock::now() - start_;
+  costs_->log(kind_, cost_, duration.count());
+}
+
+} // namespace marianatrench
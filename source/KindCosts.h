@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include <json/json.h>
+
+#include <mariana-trench/Compiler.h>
+#include <mariana-trench/Kind.h>
+#include <mariana-trench/Model.h>
+
+namespace marianatrench {
+
+/**
+ * Cost of each taint kind, when `--kind-costs` is used, to find the kinds of
+ * noisy rules that blow up the analysis.
+ *
+ * Times are recorded during the analysis by `KindCostScope`, into a buffer
+ * owned by each thread. Frames and issues are counted on the final models.
+ * Frame sizes are estimated as in `MemoryAccounting`.
+ */
+class KindCosts final {
+ public:
+  enum class Cost : std::uint8_t {
+    // Checking flows of sources into sinks, including creating issues. The
+    // time spent on a pair of kinds counts for both kinds.
+    CheckFlows,
+    // Propagating taint from a callee model to a call site.
+    Propagate,
+  };
+
+  KindCosts();
+  KindCosts(const KindCosts&) = delete;
+  KindCosts(KindCosts&&) = delete;
+  KindCosts& operator=(const KindCosts&) = delete;
+  KindCosts& operator=(KindCosts&&) = delete;
+  ~KindCosts() = default;
+
+  /* Record time spent on the given kind. This is thread-safe. */
+  void log(const Kind* kind, Cost cost, double seconds);
+
+  /**
+   * Return the costs of all kinds, sorted by decreasing number of frames in
+   * the given models. This is not thread-safe with `log`.
+   */
+  Json::Value to_json(
+      const std::vector<std::shared_ptr<const Model>>& models) const;
+
+ private:
+  struct Times {
+    double check_flows_seconds = 0.0;
+    double propagate_seconds = 0.0;
+    std::size_t propagations = 0;
+  };
+
+  using KindTimes = std::unordered_map<const Kind*, Times>;
+
+  /* Records of a thread. */
+  struct Buffer {
+    std::mutex mutex;
+    KindTimes times;
+  };
+
+  /* Return the buffer of the current thread. */
+  Buffer& buffer();
+
+ private:
+  // Identifies this instance in the buffer cache of threads.
+  const std::uint64_t id_;
+
+  // Buffers of all threads that logged into this instance, never removed.
+  mutable std::mutex buffers_mutex_;
+  std::vector<std::unique_ptr<Buffer>> buffers_;
+};
+
+/**
+ * Record the time spent in the current scope on the given kind, if costs are
+ * recorded. Scopes can be nested, in which case times are inclusive.
+ */
+class KindCostScope final {
+ public:
+  KindCostScope(
+      KindCosts* MT_NULLABLE costs,
+      const Kind* kind,
+      KindCosts::Cost cost);
+  KindCostScope(const KindCostScope&) = delete;
+  KindCostScope(KindCostScope&&) = delete;
+  KindCostScope& operator=(const KindCostScope&) = delete;
+  KindCostScope& operator=(KindCostScope&&) = delete;
+  ~KindCostScope();
+
+ private:
+  KindCosts* MT_NULLABLE costs_;
+  const Kind* kind_;
+  KindCosts::Cost cost_;
+  std::chrono::time_point<std::chrono::steady_clock> start_;
+};
+
+} // namespace marianatrench
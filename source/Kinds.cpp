@@ -13,7 +13,7 @@
 
 namespace marianatrench {
 
-const NamedKind* Kinds::get(const std::string& name) const {
+const NamedKind* Kinds::get(std::string_view name) const {
   return named_.create(name);
 }
 
@@ -32,9 +32,7 @@ const TriggeredPartialKind* Kinds::get_triggered(
 
 std::vector<const Kind*> Kinds::kinds() const {
   std::vector<const Kind*> result;
-  for (const auto& [_key, kind] : named_) {
-    result.push_back(kind);
-  }
+  named_.visit([&](const NamedKind* kind) { result.push_back(kind); });
   for (const auto& [_key, kind] : partial_) {
     result.push_back(kind);
   }
@@ -8,9 +8,11 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 
 #include <boost/iterator/transform_iterator.hpp>
 
+#include <mariana-trench/InterningTable.h>
 #include <mariana-trench/Kind.h>
 #include <mariana-trench/MultiSourceMultiSinkRule.h>
 #include <mariana-trench/NamedKind.h>
@@ -43,7 +45,7 @@ class Kinds final {
   Kinds& operator=(Kinds&&) = delete;
   ~Kinds() = default;
 
-  const NamedKind* get(const std::string& name) const;
+  const NamedKind* get(std::string_view name) const;
 
   const PartialKind* get_partial(
       const std::string& name,
@@ -58,7 +60,7 @@ class Kinds final {
   static const Kind* artificial_source();
 
  private:
-  UniquePointerFactory<std::string, NamedKind> named_;
+  InterningTable<NamedKind> named_;
   UniquePointerFactory<
       std::pair<std::string, std::string>,
       PartialKind,
@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <fstream>
+#include <stdexcept>
+#include <string_view>
+
+#include <boost/iostreams/device/mapped_file.hpp>
+#include <fmt/format.h>
+
+#include <mariana-trench/BinaryJson.h>
+#include <mariana-trench/JsonValidation.h>
+#include <mariana-trench/LibrarySummary.h>
+#include <mariana-trench/Log.h>
+#include <mariana-trench/Methods.h>
+#include <mariana-trench/Redex.h>
+#include <mariana-trench/Timer.h>
+
+namespace marianatrench {
+
+void LibrarySummary::write(
+    Context& context,
+    const Registry& registry,
+    const boost::filesystem::path& path) {
+  Timer timer;
+  BinaryJsonWriter writer;
+  auto header = Json::Value(Json::objectValue);
+  header["version"] = Json::UInt64(kVersion);
+  writer.add(header);
+
+  std::size_t models = 0;
+  for (const auto* method : *context.methods) {
+    const auto* code = method->get_code();
+    if (code == nullptr) {
+      continue;
+    }
+    auto model = registry.get_snapshot(method)->to_json();
+    // Issues are reported when analyzing the libraries, not in each
+    // application using them.
+    model.removeMember("issues");
+
+    auto value = Json::Value(Json::objectValue);
+    value["method"] = method->to_json();
+    value["code_hash"] = Json::UInt64(redex::code_hash(*code));
+    value["model"] = model;
+    writer.add(value);
+    models++;
+  }
+
+  std::ofstream stream(
+      path.native(), std::ios_base::out | std::ios_base::binary);
+  if (!stream.is_open()) {
+    throw std::runtime_error(fmt::format(
+        "Unable to write library summary to `{}`.", path.native()));
+  }
+  writer.write(stream);
+
+  LOG(1,
+      "Wrote library summary of {} methods to `{}` in {:.2f}s.",
+      models,
+      path.native(),
+      timer.duration_in_seconds());
+}
+
+std::unordered_set<const Method*> LibrarySummary::load(
+    Context& context,
+    Registry& registry,
+    const boost::filesystem::path& path) {
+  Timer timer;
+  boost::iostreams::mapped_file_source file(path);
+  BinaryJsonReader reader(std::string_view(file.data(), file.size()));
+
+  auto header = reader.next();
+  if (!header || !header->isObject() || !header->isMember("version")) {
+    throw std::runtime_error(
+        fmt::format("Invalid library summary `{}`.", path.native()));
+  }
+  if ((*header)["version"].asUInt64() != kVersion) {
+    throw std::runtime_error(fmt::format(
+        "Library summary `{}` has version {}, expected version {}.",
+        path.native(),
+        (*header)["version"].asUInt64(),
+        kVersion));
+  }
+
+  std::unordered_set<const Method*> methods;
+  std::size_t unknown_methods = 0;
+  std::size_t changed_methods = 0;
+  while (auto value = reader.next()) {
+    const Method* method = nullptr;
+    try {
+      method = Method::from_json((*value)["method"], context);
+    } catch (const JsonValidationError&) {
+      unknown_methods++;
+      continue;
+    }
+    const auto* code = method->get_code();
+    if (code == nullptr ||
+        redex::code_hash(*code) != (*value)["code_hash"].asUInt64()) {
+      changed_methods++;
+      continue;
+    }
+
+    auto model = Model::from_json(method, (*value)["model"], context);
+    model.add_mode(Model::Mode::SkipAnalysis, context);
+    registry.join_with(model);
+    methods.insert(method);
+  }
+
+  LOG(1,
+      "Loaded {} models from library summary `{}` in {:.2f}s. Ignored {} unknown and {} changed methods.",
+      methods.size(),
+      path.native(),
+      timer.duration_in_seconds(),
+      unknown_methods,
+      changed_methods);
+  return methods;
+}
+
+} // namespace marianatrench
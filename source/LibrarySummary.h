@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <unordered_set>
+
+#include <boost/filesystem/path.hpp>
+
+#include <mariana-trench/Context.h>
+#include <mariana-trench/Method.h>
+#include <mariana-trench/Registry.h>
+
+namespace marianatrench {
+
+/**
+ * Converged models of libraries shared by many applications (see
+ * `--write-library-summary` and `--library-summary-paths`).
+ *
+ * A summary is written at the end of the analysis of the libraries, in the
+ * binary json format (see `BinaryJson`). The first value is a header with the
+ * `version` of the summary format, followed by one value per method with its
+ * `method`, the `code_hash` of its code (see `redex::code_hash`) and its
+ * `model`, without issues.
+ *
+ * When analyzing an application, the models of the methods whose code hash did
+ * not change are joined into the registry with the `SkipAnalysis` mode, and
+ * these methods are not analyzed. Overrides and class hierarchies are not
+ * summarized: the libraries are part of the application, hence they are
+ * computed again, including the overrides defined by the application. These
+ * overrides are not reflected in the summarized models.
+ */
+class LibrarySummary final {
+ public:
+  /* Incremented when the content of the summary changes. */
+  static constexpr std::uint64_t kVersion = 1;
+
+ public:
+  /* Write the models of all methods with code to the given path. */
+  static void write(
+      Context& context,
+      const Registry& registry,
+      const boost::filesystem::path& path);
+
+  /**
+   * Join the models of the summary at the given path into the registry and
+   * return the methods that should not be analyzed. Throws
+   * `std::runtime_error` if the file is not a valid summary.
+   */
+  static std::unordered_set<const Method*> load(
+      Context& context,
+      Registry& registry,
+      const boost::filesystem::path& path);
+};
+
+} // namespace marianatrench
@@ -5,6 +5,9 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <algorithm>
+#include <vector>
+
 #include <Creators.h>
 #include <SpartaWorkQueue.h>
 
@@ -30,6 +33,18 @@ LifecycleMethodCall LifecycleMethodCall::from_json(const Json::Value& value) {
 
 DexMethodRef* MT_NULLABLE
 LifecycleMethodCall::get_dex_method(DexType* klass) const {
+  auto* proto = get_proto();
+  if (proto == nullptr) {
+    return nullptr;
+  }
+
+  return DexMethod::get_method(
+      /* type */ klass,
+      /* name */ DexString::make_string(method_name_),
+      /* proto */ proto);
+}
+
+DexProto* MT_NULLABLE LifecycleMethodCall::get_proto() const {
   const auto* return_type =
       DexType::get_type(DexString::make_string(return_type_));
   if (return_type == nullptr) {
@@ -42,11 +57,7 @@ LifecycleMethodCall::get_dex_method(DexType* klass) const {
     return nullptr;
   }
 
-  return DexMethod::get_method(
-      /* type */ klass,
-      /* name */ DexString::make_string(method_name_),
-      /* proto */
-      DexProto::make_proto(return_type, argument_types));
+  return DexProto::make_proto(return_type, argument_types);
 }
 
 const DexTypeList* MT_NULLABLE LifecycleMethodCall::get_argument_types() const {
@@ -80,9 +91,10 @@ LifecycleMethod LifecycleMethod::from_json(const Json::Value& value) {
   return LifecycleMethod(base_class_name, method_name, callees);
 }
 
-void LifecycleMethod::create_methods(
+std::vector<const Method*> LifecycleMethod::create_methods(
     const ClassHierarchies& class_hierarchies,
-    Methods& methods) const {
+    Methods& methods,
+    unsigned int threads) const {
   // All DexMethods created by `LifecycleMethod` have the same signature:
   //   void <method_name_>(<arguments>)
   // The arguments are determined by the callees' arguments. This creates the
@@ -102,47 +114,76 @@ void LifecycleMethod::create_methods(
     }
   }
 
+  // Names and prototypes are the same for all classes, resolve them once.
+  auto* proto =
+      DexProto::make_proto(type::_void(), get_argument_types(type_index_map));
+  std::vector<ResolvedCallee> resolved_callees;
+  for (const auto& callee : callees_) {
+    if (auto* callee_proto = callee.get_proto()) {
+      resolved_callees.push_back(ResolvedCallee{
+          DexString::make_string(callee.method_name()), callee_proto});
+    }
+  }
+
   auto* MT_NULLABLE base_class_type = DexType::get_type(base_class_name_);
   if (!base_class_type) {
     WARNING(
         1,
         "Could not find type for base class name `{}`. Will skip creating life-cycle methods.",
         base_class_name_);
-    return;
+    return {};
   }
 
-  std::atomic<int> methods_created_count = 0;
-
   const auto& children = class_hierarchies.extends(base_class_type);
-  std::unordered_set<const DexType*> final_children;
+  std::vector<const DexType*> final_children;
   for (const auto* child : children) {
     const auto& grandchildren = class_hierarchies.extends(child);
     if (grandchildren.empty()) {
-      final_children.insert(child);
+      final_children.push_back(child);
     }
   }
+  // Sort the children so that methods are registered in a deterministic order.
+  std::sort(
+      final_children.begin(),
+      final_children.end(),
+      [](const DexType* left, const DexType* right) {
+        return compare_dextypes(left, right);
+      });
   LOG(3,
       "Found {} child(ren) for type `{}`. Creating life-cycle methods for {} leaf child(ren)",
       children.size(),
       base_class_name_,
       final_children.size());
 
-  auto queue = sparta::work_queue<DexType*>([&](DexType* child) {
-    const auto* method = create_dex_method(child, type_index_map);
-    if (method != nullptr) {
-      ++methods_created_count;
-      methods.create(method);
-    }
-  });
-  for (const auto* final_child : final_children) {
-    queue.add_item(const_cast<DexType*>(final_child));
+  // Dex methods are created in parallel, each in its own class, but they are
+  // only added to `methods` afterwards, in order.
+  std::vector<const DexMethod*> dex_methods(final_children.size(), nullptr);
+  auto queue = sparta::work_queue<std::size_t>(
+      [&](std::size_t index) {
+        dex_methods[index] = create_dex_method(
+            const_cast<DexType*>(final_children[index]),
+            proto,
+            resolved_callees,
+            type_index_map);
+      },
+      threads);
+  for (std::size_t index = 0; index < final_children.size(); index++) {
+    queue.add_item(index);
   }
   queue.run_all();
 
+  std::vector<const Method*> created_methods;
+  for (const auto* dex_method : dex_methods) {
+    if (dex_method != nullptr) {
+      created_methods.push_back(methods.create(dex_method));
+    }
+  }
+
   LOG(1,
       "Created {} life-cycle methods for classes inheriting from `{}`",
-      methods_created_count,
+      created_methods.size(),
       base_class_name_);
+  return created_methods;
 }
 
 bool LifecycleMethod::operator==(const LifecycleMethod& other) const {
@@ -152,12 +193,13 @@ bool LifecycleMethod::operator==(const LifecycleMethod& other) const {
 
 const DexMethod* MT_NULLABLE LifecycleMethod::create_dex_method(
     DexType* klass,
+    DexProto* proto,
+    const std::vector<ResolvedCallee>& callees,
     const TypeIndexMap& type_index_map) const {
   auto method = MethodCreator(
       /* class */ klass,
       /* name */ DexString::make_string(method_name_),
-      /* proto */
-      DexProto::make_proto(type::_void(), get_argument_types(type_index_map)),
+      /* proto */ proto,
       /* access */ DexAccessFlags::ACC_PRIVATE);
 
   auto this_location = method.get_local(0);
@@ -165,8 +207,8 @@ const DexMethod* MT_NULLABLE LifecycleMethod::create_dex_method(
   mt_assert(main_block != nullptr);
 
   int callee_count = 0;
-  for (const auto& callee : callees_) {
-    auto* dex_method = callee.get_dex_method(klass);
+  for (const auto& callee : callees) {
+    auto* dex_method = DexMethod::get_method(klass, callee.name, callee.proto);
     if (!dex_method) {
       // This can be null if `klass` does not override the method, in which
       // case, it will not be invoked.
@@ -176,10 +218,7 @@ const DexMethod* MT_NULLABLE LifecycleMethod::create_dex_method(
     ++callee_count;
 
     std::vector<Location> invoke_with_registers{this_location};
-    auto* type_list = callee.get_argument_types();
-    // This should have been verified at the start of `create_methods`
-    mt_assert(type_list != nullptr);
-    for (auto* type : *type_list) {
+    for (auto* type : *callee.proto->get_args()) {
       auto argument_register = method.get_local(type_index_map.at(type));
       invoke_with_registers.push_back(argument_register);
     }
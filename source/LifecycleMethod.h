@@ -7,10 +7,13 @@
 
 #pragma once
 
+#include <vector>
+
 #include <fmt/format.h>
 #include <json/json.h>
 
 #include <mariana-trench/Context.h>
+#include <mariana-trench/Method.h>
 #include <mariana-trench/Redex.h>
 
 namespace marianatrench {
@@ -47,6 +50,13 @@ class LifecycleMethodCall {
 
   const DexTypeList* MT_NULLABLE get_argument_types() const;
 
+  /* Returns `nullptr` if the return or argument types are unrecognized. */
+  DexProto* MT_NULLABLE get_proto() const;
+
+  const std::string& method_name() const {
+    return method_name_;
+  }
+
   std::string to_string() const {
     return fmt::format(
         "{}({}){}", method_name_, fmt::join(argument_types_, ""), return_type_);
@@ -89,6 +99,12 @@ class LifecycleMethod {
  private:
   using TypeIndexMap = std::unordered_map<DexType*, int>;
 
+  /* A callee with its name and prototype, which do not depend on the class. */
+  struct ResolvedCallee {
+    const DexString* name;
+    DexProto* proto;
+  };
+
  public:
   explicit LifecycleMethod(
       std::string base_class_name,
@@ -111,17 +127,22 @@ class LifecycleMethod {
   static LifecycleMethod from_json(const Json::Value& value);
 
   /**
-   * Creates the relevant dex methods. These methods are added to `methods`.
+   * Creates the relevant dex methods, using the given number of threads.
+   * These methods are added to `methods` and returned.
    */
-  void create_methods(
+  std::vector<const Method*> create_methods(
       const ClassHierarchies& class_hierarchies,
-      Methods& methods) const;
+      Methods& methods,
+      unsigned int threads) const;
 
   bool operator==(const LifecycleMethod& other) const;
 
  private:
-  const DexMethod* MT_NULLABLE
-  create_dex_method(DexType* klass, const TypeIndexMap& type_index_map) const;
+  const DexMethod* MT_NULLABLE create_dex_method(
+      DexType* klass,
+      DexProto* proto,
+      const std::vector<ResolvedCallee>& callees,
+      const TypeIndexMap& type_index_map) const;
 
   const DexTypeList* get_argument_types(const TypeIndexMap&) const;
 
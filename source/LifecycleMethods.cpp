@@ -5,25 +5,50 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <algorithm>
+#include <vector>
+
+#include <mariana-trench/JsonFileCache.h>
 #include <mariana-trench/JsonValidation.h>
 #include <mariana-trench/LifecycleMethods.h>
 #include <mariana-trench/Options.h>
 
 namespace marianatrench {
 
-void LifecycleMethods::run(
+std::vector<const Method*> LifecycleMethods::run(
     const Options& options,
     const ClassHierarchies& class_hierarchies,
     Methods& methods) {
   LifecycleMethods lifecycle_methods;
   for (const auto& path : options.lifecycles_paths()) {
-    lifecycle_methods.add_methods_from_json(
-        JsonValidation::parse_json_file(path));
+    lifecycle_methods.add_methods_from_json(JsonFileCache::parse(path));
   }
 
-  for (auto& [_, lifecycle_method] : lifecycle_methods.methods()) {
-    lifecycle_method.create_methods(class_hierarchies, methods);
+  // Each definition creates its methods in parallel. Definitions are handled
+  // in order of method names, to keep method identifiers deterministic.
+  std::vector<const LifecycleMethod*> sorted_methods;
+  for (const auto& [_, lifecycle_method] : lifecycle_methods.methods()) {
+    sorted_methods.push_back(&lifecycle_method);
+  }
+  std::sort(
+      sorted_methods.begin(),
+      sorted_methods.end(),
+      [](const LifecycleMethod* left, const LifecycleMethod* right) {
+        return left->method_name() < right->method_name();
+      });
+  std::vector<const Method*> created_methods;
+  for (const auto* lifecycle_method : sorted_methods) {
+    auto definition_methods =
+        lifecycle_method->create_methods(
+            class_hierarchies,
+            methods,
+            options.jobs(AnalysisPhase::CallGraph));
+    created_methods.insert(
+        created_methods.end(),
+        definition_methods.begin(),
+        definition_methods.end());
   }
+  return created_methods;
 }
 
 void LifecycleMethods::add_methods_from_json(
@@ -7,6 +7,8 @@
 
 #pragma once
 
+#include <vector>
+
 #include <mariana-trench/ClassHierarchies.h>
 #include <mariana-trench/LifecycleMethod.h>
 #include <mariana-trench/Methods.h>
@@ -20,7 +22,8 @@ namespace marianatrench {
  */
 class LifecycleMethods final {
  public:
-  static void run(
+  /* Create the life-cycle wrapper methods and return them. */
+  static std::vector<const Method*> run(
       const Options& options,
       const ClassHierarchies& class_hierarchies,
       Methods& methods);
@@ -5,6 +5,11 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <algorithm>
+#include <array>
+#include <iterator>
+#include <limits>
+
 #include <mariana-trench/Assert.h>
 #include <mariana-trench/JsonValidation.h>
 #include <mariana-trench/LocalPositionSet.h>
@@ -12,36 +17,204 @@
 
 namespace marianatrench {
 
+static_assert(
+    Heuristics::kMaxNumberLocalPositions <=
+        std::numeric_limits<std::uint8_t>::max(),
+    "The size of a local position set must fit in 8 bits");
+static_assert(
+    LocalPositionSet::kInlinePositions < Heuristics::kMaxNumberLocalPositions);
+
+namespace {
+
+// Buffer for the result of a union or an intersection, before it is assigned.
+using Buffer =
+    std::array<const Position*, 2 * Heuristics::kMaxNumberLocalPositions>;
+
+} // namespace
+
 LocalPositionSet::LocalPositionSet(
-    std::initializer_list<const Position*> positions)
-    : set_(positions) {}
+    std::initializer_list<const Position*> positions) {
+  for (const auto* position : positions) {
+    add(position);
+  }
+}
+
+LocalPositionSet::LocalPositionSet(const LocalPositionSet& other) {
+  assign(other.kind_, other.data(), other.size_);
+}
+
+LocalPositionSet::LocalPositionSet(LocalPositionSet&& other) noexcept
+    : kind_(other.kind_), size_(other.size_) {
+  if (is_inline()) {
+    std::copy_n(other.inline_positions_, size_, inline_positions_);
+  } else {
+    spilled_positions_ = other.spilled_positions_;
+    other.size_ = 0;
+  }
+}
+
+LocalPositionSet& LocalPositionSet::operator=(const LocalPositionSet& other) {
+  if (this != &other) {
+    assign(other.kind_, other.data(), other.size_);
+  }
+  return *this;
+}
+
+LocalPositionSet& LocalPositionSet::operator=(
+    LocalPositionSet&& other) noexcept {
+  if (this == &other) {
+    return *this;
+  }
+  if (other.is_inline()) {
+    assign(other.kind_, other.data(), other.size_);
+  } else {
+    if (!is_inline()) {
+      delete[] spilled_positions_;
+    }
+    kind_ = other.kind_;
+    size_ = other.size_;
+    spilled_positions_ = other.spilled_positions_;
+    other.size_ = 0;
+  }
+  return *this;
+}
+
+LocalPositionSet::~LocalPositionSet() {
+  if (!is_inline()) {
+    delete[] spilled_positions_;
+  }
+}
+
+void LocalPositionSet::assign(
+    Kind kind,
+    const Position* const* positions,
+    std::size_t size) {
+  mt_assert(size <= Heuristics::kMaxNumberLocalPositions);
+  kind_ = kind;
+  if (size <= kInlinePositions) {
+    // Copy first, `positions` might point to the spilled array.
+    const Position* copy[kInlinePositions];
+    std::copy_n(positions, size, copy);
+    if (!is_inline()) {
+      delete[] spilled_positions_;
+    }
+    std::copy_n(copy, size, inline_positions_);
+  } else {
+    if (is_inline()) {
+      spilled_positions_ =
+          new const Position*[Heuristics::kMaxNumberLocalPositions];
+    }
+    std::copy_n(positions, size, spilled_positions_);
+  }
+  size_ = static_cast<std::uint8_t>(size);
+}
 
 void LocalPositionSet::add(const Position* position) {
-  set_.add(position);
+  if (!is_value()) {
+    return;
+  }
+
+  auto* begin = const_cast<const Position**>(data());
+  auto* end = begin + size_;
+  auto* found = std::lower_bound(begin, end, position);
+  if (found != end && *found == position) {
+    return;
+  }
+  if (size_ == Heuristics::kMaxNumberLocalPositions) {
+    set_to_top();
+    return;
+  }
+
+  if (size_ < kInlinePositions || !is_inline()) {
+    // There is room in the current array.
+    std::copy_backward(found, end, end + 1);
+    *found = position;
+    size_++;
+    return;
+  }
+
+  // Move the inline positions to a spilled array.
+  auto* spilled = new const Position*[Heuristics::kMaxNumberLocalPositions];
+  auto* output = std::copy(begin, found, spilled);
+  *output++ = position;
+  std::copy(found, end, output);
+  spilled_positions_ = spilled;
+  size_++;
 }
 
 bool LocalPositionSet::leq(const LocalPositionSet& other) const {
-  return set_.leq(other.set_);
+  if (is_bottom() || other.is_top()) {
+    return true;
+  }
+  if (other.is_bottom() || is_top()) {
+    return false;
+  }
+  return size_ <= other.size_ &&
+      std::includes(other.begin(), other.end(), begin(), end());
 }
 
 bool LocalPositionSet::equals(const LocalPositionSet& other) const {
-  return set_.equals(other.set_);
+  return kind_ == other.kind_ &&
+      std::equal(begin(), end(), other.begin(), other.end());
 }
 
 void LocalPositionSet::join_with(const LocalPositionSet& other) {
-  set_.join_with(other.set_);
+  if (is_top() || other.is_bottom()) {
+    return;
+  }
+  if (other.is_top() || is_bottom()) {
+    *this = other;
+    return;
+  }
+
+  // Fast paths for the common cases of small sets.
+  if (other.size_ == 0) {
+    return;
+  }
+  if (size_ == 0) {
+    *this = other;
+    return;
+  }
+  if (other.size_ == 1) {
+    add(*other.begin());
+    return;
+  }
+
+  Buffer buffer;
+  auto* end = std::set_union(
+      begin(), this->end(), other.begin(), other.end(), buffer.data());
+  auto size = static_cast<std::size_t>(std::distance(buffer.data(), end));
+  if (size > Heuristics::kMaxNumberLocalPositions) {
+    set_to_top();
+  } else if (size != size_) {
+    assign(Kind::Value, buffer.data(), size);
+  }
 }
 
 void LocalPositionSet::widen_with(const LocalPositionSet& other) {
-  set_.widen_with(other.set_);
+  join_with(other);
 }
 
 void LocalPositionSet::meet_with(const LocalPositionSet& other) {
-  set_.meet_with(other.set_);
+  if (is_bottom() || other.is_top()) {
+    return;
+  }
+  if (other.is_bottom() || is_top()) {
+    *this = other;
+    return;
+  }
+
+  Buffer buffer;
+  auto* end = std::set_intersection(
+      begin(), this->end(), other.begin(), other.end(), buffer.data());
+  auto size = static_cast<std::size_t>(std::distance(buffer.data(), end));
+  if (size != size_) {
+    assign(Kind::Value, buffer.data(), size);
+  }
 }
 
 void LocalPositionSet::narrow_with(const LocalPositionSet& other) {
-  set_.narrowing(other.set_);
+  meet_with(other);
 }
 
 LocalPositionSet LocalPositionSet::from_json(
@@ -57,16 +230,28 @@ LocalPositionSet LocalPositionSet::from_json(
 Json::Value LocalPositionSet::to_json() const {
   mt_assert(!is_bottom());
   auto lines = Json::Value(Json::arrayValue);
-  if (set_.is_value()) {
-    for (const auto* position : set_.elements()) {
-      lines.append(position->to_json(/* with_path */ false));
-    }
+  for (const auto* position : *this) {
+    lines.append(position->to_json(/* with_path */ false));
   }
   return lines;
 }
 
 std::ostream& operator<<(std::ostream& out, const LocalPositionSet& positions) {
-  return out << positions.set_;
+  if (positions.is_bottom()) {
+    return out << "_|_";
+  } else if (positions.is_top()) {
+    return out << "T";
+  }
+  out << "{";
+  for (auto iterator = positions.begin(), end = positions.end();
+       iterator != end;) {
+    out << **iterator;
+    ++iterator;
+    if (iterator != end) {
+      out << ", ";
+    }
+  }
+  return out << "}";
 }
 
 } // namespace marianatrench
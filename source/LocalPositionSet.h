@@ -7,13 +7,13 @@
 
 #pragma once
 
+#include <cstdint>
 #include <initializer_list>
 #include <ostream>
 
 #include <json/json.h>
 
 #include <AbstractDomain.h>
-#include <SmallSortedSetAbstractDomain.h>
 
 #include <mariana-trench/Context.h>
 #include <mariana-trench/Heuristics.h>
@@ -24,15 +24,23 @@ namespace marianatrench {
 /**
  * Represents the source code positions that taint flows through for a given
  * method.
+ *
+ * Positions are sorted by address. Most sets have one or two positions, hence
+ * up to `kInlinePositions` positions are stored inline, and larger sets use
+ * an array of `Heuristics::kMaxNumberLocalPositions` positions. Sets become
+ * top when they exceed that size.
  */
 class LocalPositionSet final : public sparta::AbstractDomain<LocalPositionSet> {
- private:
-  using Set = sparta::SmallSortedSetAbstractDomain<
-      const Position*,
-      Heuristics::kMaxNumberLocalPositions>;
+ public:
+  using iterator = const Position* const*;
+  using const_iterator = iterator;
+
+  static constexpr std::size_t kInlinePositions = 2;
 
  private:
-  explicit LocalPositionSet(Set set) : set_(std::move(set)) {}
+  enum class Kind : std::uint8_t { Bottom, Value, Top };
+
+  explicit LocalPositionSet(Kind kind) : kind_(kind) {}
 
  public:
   /* Create the empty position set. */
@@ -40,46 +48,56 @@ class LocalPositionSet final : public sparta::AbstractDomain<LocalPositionSet> {
 
   explicit LocalPositionSet(std::initializer_list<const Position*> positions);
 
-  LocalPositionSet(const LocalPositionSet&) = default;
-  LocalPositionSet(LocalPositionSet&&) = default;
-  LocalPositionSet& operator=(const LocalPositionSet&) = default;
-  LocalPositionSet& operator=(LocalPositionSet&&) = default;
+  LocalPositionSet(const LocalPositionSet& other);
+  LocalPositionSet(LocalPositionSet&& other) noexcept;
+  LocalPositionSet& operator=(const LocalPositionSet& other);
+  LocalPositionSet& operator=(LocalPositionSet&& other) noexcept;
+  ~LocalPositionSet();
 
   static LocalPositionSet bottom() {
-    return LocalPositionSet(Set::bottom());
+    return LocalPositionSet(Kind::Bottom);
   }
 
   static LocalPositionSet top() {
-    return LocalPositionSet(Set::top());
+    return LocalPositionSet(Kind::Top);
   }
 
   bool is_bottom() const override {
-    return set_.is_bottom();
+    return kind_ == Kind::Bottom;
   }
 
   bool is_top() const override {
-    return set_.is_top();
+    return kind_ == Kind::Top;
   }
 
   /* Return true if this is neither top nor bottom. */
   bool is_value() const {
-    return set_.is_value();
+    return kind_ == Kind::Value;
   }
 
+  /* Return true if the set has no positions, i.e it is empty, top or bottom. */
   bool empty() const {
-    return set_.empty();
+    return size_ == 0;
+  }
+
+  std::size_t size() const {
+    return size_;
   }
 
   void set_to_bottom() override {
-    set_.is_bottom();
+    assign(Kind::Bottom, nullptr, 0);
   }
 
   void set_to_top() override {
-    set_.is_top();
+    assign(Kind::Top, nullptr, 0);
   }
 
-  const sparta::FlatSet<const Position*>& elements() const {
-    return set_.elements();
+  iterator begin() const {
+    return data();
+  }
+
+  iterator end() const {
+    return data() + size_;
   }
 
   void add(const Position* position);
@@ -104,7 +122,26 @@ class LocalPositionSet final : public sparta::AbstractDomain<LocalPositionSet> {
       const LocalPositionSet& positions);
 
  private:
-  Set set_;
+  bool is_inline() const {
+    return size_ <= kInlinePositions;
+  }
+
+  const Position* const* data() const {
+    return is_inline() ? inline_positions_ : spilled_positions_;
+  }
+
+  /* Replace the set by the given kind and sorted positions. */
+  void assign(Kind kind, const Position* const* positions, std::size_t size);
+
+ private:
+  Kind kind_ = Kind::Value;
+  std::uint8_t size_ = 0;
+  union {
+    const Position* inline_positions_[kInlinePositions] = {};
+    // Array of `Heuristics::kMaxNumberLocalPositions` positions, used when
+    // there are more than `kInlinePositions` positions.
+    const Position** spilled_positions_;
+  };
 };
 
 } // namespace marianatrench
@@ -5,17 +5,74 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <cstdio>
 #include <cstdlib>
+#include <memory>
 #include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
 
 #include <mariana-trench/Log.h>
+#include <mariana-trench/Method.h>
 
 namespace {
 
+// Interval at which the background thread writes buffered messages.
+constexpr auto kFlushInterval = std::chrono::milliseconds(100);
+
+// Above this size, a thread writes its own buffer immediately.
+constexpr std::size_t kMaximumBufferSize = 1 << 20;
+
+// Method whose analysis is running on the current thread, if any.
+thread_local const marianatrench::Method* current_method = nullptr;
+
+struct ThreadBuffer {
+  // Only contended when the background thread takes the messages.
+  std::mutex mutex;
+  std::string text;
+  std::string structured;
+};
+
+void append_json_string(std::string& output, std::string_view string) {
+  output.push_back('"');
+  for (char character : string) {
+    switch (character) {
+      case '"':
+        output.append("\\\"");
+        break;
+      case '\\':
+        output.append("\\\\");
+        break;
+      case '\n':
+        output.append("\\n");
+        break;
+      case '\t':
+        output.append("\\t");
+        break;
+      default:
+        if (static_cast<unsigned char>(character) < 0x20) {
+          output.append(fmt::format(
+              "\\u{:04x}", static_cast<unsigned char>(character)));
+        } else {
+          output.push_back(character);
+        }
+    }
+  }
+  output.push_back('"');
+}
+
 struct LoggerImplementation {
  public:
-  LoggerImplementation() : level_(0), file_(stderr) {
+  LoggerImplementation()
+      : level_(0),
+        file_(stderr),
+        structured_file_(nullptr),
+        iteration_(0),
+        stopping_(false) {
     const char* env = std::getenv("TRACE");
     if (env) {
       parse_environment(env);
@@ -26,7 +83,20 @@ struct LoggerImplementation {
   LoggerImplementation(LoggerImplementation&&) = delete;
   LoggerImplementation& operator=(const LoggerImplementation&) = delete;
   LoggerImplementation& operator=(LoggerImplementation&&) = delete;
-  ~LoggerImplementation() = default;
+  ~LoggerImplementation() {
+    {
+      std::lock_guard<std::mutex> lock(flusher_mutex_);
+      stopping_ = true;
+    }
+    flusher_condition_.notify_all();
+    if (flusher_.joinable()) {
+      flusher_.join();
+    }
+    flush();
+    if (auto* structured_file = structured_file_.load()) {
+      fclose(structured_file);
+    }
+  }
 
   void set_level(int level) {
     level_ = level;
@@ -46,10 +116,79 @@ struct LoggerImplementation {
     }
 
     std::string line = fmt::format("{} {}\n", section, message);
+    std::string record;
+    if (structured_file_.load(std::memory_order_relaxed) != nullptr) {
+      record = structured_record(section, level, message);
+    }
 
-    std::lock_guard<std::mutex> guard(mutex_);
-    fwrite(line.c_str(), line.size(), 1, file_);
-    fflush(file_);
+    if (current_method != nullptr && section != "ERROR") {
+      auto& buffer = thread_buffer();
+      std::lock_guard<std::mutex> lock(buffer.mutex);
+      buffer.text.append(line);
+      buffer.structured.append(record);
+      if (buffer.text.size() + buffer.structured.size() < kMaximumBufferSize) {
+        start_flusher();
+        return;
+      }
+      write(buffer.text, buffer.structured);
+      buffer.text.clear();
+      buffer.structured.clear();
+      return;
+    }
+
+    if (section == "ERROR") {
+      // Errors usually precede a crash, write everything that is buffered.
+      flush();
+    }
+
+    // Preserve the order of the messages of the current thread.
+    std::string text;
+    std::string structured;
+    if (auto* buffer = thread_buffer_.get()) {
+      std::lock_guard<std::mutex> lock(buffer->mutex);
+      text.swap(buffer->text);
+      structured.swap(buffer->structured);
+    }
+    text.append(line);
+    structured.append(record);
+    write(text, structured);
+  }
+
+  void set_iteration(std::size_t iteration) {
+    iteration_.store(iteration, std::memory_order_relaxed);
+  }
+
+  void set_structured_output(const std::string& path) {
+    auto* file = fopen(path.c_str(), "w");
+    if (file == nullptr) {
+      throw std::invalid_argument(
+          fmt::format("Unable to open `{}` for writing.", path));
+    }
+    flush();
+    if (auto* previous = structured_file_.exchange(file)) {
+      std::lock_guard<std::mutex> guard(mutex_);
+      fclose(previous);
+    }
+  }
+
+  void flush() {
+    std::lock_guard<std::mutex> lock(buffers_mutex_);
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+    for (auto& buffer : buffers_) {
+      std::string text;
+      std::string structured;
+      {
+        std::lock_guard<std::mutex> buffer_lock(buffer->mutex);
+        text.swap(buffer->text);
+        structured.swap(buffer->structured);
+      }
+      write(text, structured);
+      // Buffers of threads that exited are only referenced here.
+      if (buffer.use_count() > 1) {
+        buffers.push_back(std::move(buffer));
+      }
+    }
+    buffers_ = std::move(buffers);
   }
 
  private:
@@ -77,12 +216,85 @@ struct LoggerImplementation {
     }
   }
 
+  std::string structured_record(
+      std::string_view section,
+      int level,
+      std::string_view message) const {
+    std::string record = "{\"section\":";
+    append_json_string(record, section);
+    record.append(fmt::format(
+        ",\"level\":{},\"iteration\":{},\"method\":",
+        level,
+        iteration_.load(std::memory_order_relaxed)));
+    if (current_method != nullptr) {
+      append_json_string(record, current_method->show());
+    } else {
+      record.append("null");
+    }
+    record.append(",\"message\":");
+    append_json_string(record, message);
+    record.append("}\n");
+    return record;
+  }
+
+  ThreadBuffer& thread_buffer() {
+    if (thread_buffer_ == nullptr) {
+      thread_buffer_ = std::make_shared<ThreadBuffer>();
+      std::lock_guard<std::mutex> lock(buffers_mutex_);
+      buffers_.push_back(thread_buffer_);
+    }
+    return *thread_buffer_;
+  }
+
+  void start_flusher() {
+    std::call_once(flusher_started_, [this]() {
+      flusher_ = std::thread([this]() {
+        std::unique_lock<std::mutex> lock(flusher_mutex_);
+        while (!flusher_condition_.wait_for(
+            lock, kFlushInterval, [this]() { return stopping_; })) {
+          flush();
+        }
+      });
+    });
+  }
+
+  void write(const std::string& text, const std::string& structured) {
+    if (text.empty() && structured.empty()) {
+      return;
+    }
+
+    std::lock_guard<std::mutex> guard(mutex_);
+    fwrite(text.c_str(), text.size(), 1, file_);
+    fflush(file_);
+    if (auto* structured_file = structured_file_.load()) {
+      fwrite(structured.c_str(), structured.size(), 1, structured_file);
+      fflush(structured_file);
+    }
+  }
+
  private:
   int level_;
   FILE* file_;
+  std::atomic<FILE*> structured_file_;
+  std::atomic<std::size_t> iteration_;
+  // Protects writes to the files.
   std::mutex mutex_;
+
+  // Buffers of all threads that logged during the analysis of a method.
+  std::mutex buffers_mutex_;
+  std::vector<std::shared_ptr<ThreadBuffer>> buffers_;
+  static thread_local std::shared_ptr<ThreadBuffer> thread_buffer_;
+
+  std::once_flag flusher_started_;
+  std::mutex flusher_mutex_;
+  std::condition_variable flusher_condition_;
+  bool stopping_;
+  std::thread flusher_;
 };
 
+thread_local std::shared_ptr<ThreadBuffer>
+    LoggerImplementation::thread_buffer_ = nullptr;
+
 static LoggerImplementation logger;
 
 } // namespace
@@ -108,4 +320,25 @@ void Logger::log(
   logger.log(section, level, message);
 }
 
+void Logger::set_iteration(std::size_t iteration) {
+  logger.set_iteration(iteration);
+}
+
+void Logger::set_structured_output(const std::string& path) {
+  logger.set_structured_output(path);
+}
+
+void Logger::flush() {
+  logger.flush();
+}
+
+LogMethodScope::LogMethodScope(const Method* method)
+    : previous_(current_method) {
+  current_method = method;
+}
+
+LogMethodScope::~LogMethodScope() {
+  current_method = previous_;
+}
+
 } // namespace marianatrench
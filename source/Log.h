@@ -7,14 +7,36 @@
 
 #pragma once
 
+#include <cstddef>
 #include <string>
 #include <string_view>
 
 #include <fmt/format.h>
 #include <fmt/ostream.h>
 
+/**
+ * Maximum level of log messages compiled in, set with the `MAX_LOG_LEVEL`
+ * cmake option. Calls to the logging macros above this level are removed
+ * at compile time, along with the evaluation of their arguments.
+ */
+#ifndef MT_MAX_LOG_LEVEL
+#define MT_MAX_LOG_LEVEL 100
+#endif
+
 namespace marianatrench {
 
+class Method;
+
+/**
+ * Messages logged outside of a `LogMethodScope` are written immediately.
+ *
+ * Messages logged during the analysis of a method (e.g `LOG_OR_DUMP` with
+ * `--log-method`) are appended to a buffer owned by the current thread and
+ * written periodically by a background thread, so that workers do not
+ * serialize on the output stream. Lines of different threads are therefore
+ * interleaved by chunks. Errors are always written immediately, after the
+ * buffer of the current thread.
+ */
 class Logger {
  public:
   static void set_level(int level);
@@ -32,13 +54,43 @@ class Logger {
 
   static void
   log(std::string_view section, int level, std::string_view message);
+
+  /* Set the current global iteration, recorded in structured logs. */
+  static void set_iteration(std::size_t iteration);
+
+  /**
+   * Also write every message as a json line with its section, level, method
+   * and global iteration in the given file.
+   */
+  static void set_structured_output(const std::string& path);
+
+  /* Write all buffered messages. */
+  static void flush();
+};
+
+/**
+ * Attribute the messages logged by the current thread in this scope to the
+ * given method, and buffer them (see `Logger`).
+ */
+class LogMethodScope final {
+ public:
+  explicit LogMethodScope(const Method* method);
+  LogMethodScope(const LogMethodScope&) = delete;
+  LogMethodScope(LogMethodScope&&) = delete;
+  LogMethodScope& operator=(const LogMethodScope&) = delete;
+  LogMethodScope& operator=(LogMethodScope&&) = delete;
+  ~LogMethodScope();
+
+ private:
+  const Method* previous_;
 };
 
 } // namespace marianatrench
 
 #define SECTION(section, level, format, ...)                             \
   do {                                                                   \
-    if (marianatrench::Logger::enabled(level)) {                         \
+    if ((level) <= MT_MAX_LOG_LEVEL &&                                   \
+        marianatrench::Logger::enabled(level)) {                         \
       marianatrench::Logger::log(section, level, format, ##__VA_ARGS__); \
     }                                                                    \
   } while (0)
@@ -49,11 +101,15 @@ class Logger {
   } while (0)
 
 #define CONTEXT_LEVEL(context, level) \
-  (context != nullptr && context->dump()) ? 1 : level
-
-#define LOG_OR_DUMP(context, level, format, ...)               \
-  do {                                                         \
-    LOG(CONTEXT_LEVEL(context, level), format, ##__VA_ARGS__); \
+  ((context != nullptr && context->dump()) ? 1 : (level))
+
+// The level is checked before `dump()`, so that messages above the maximum
+// compiled level are removed even for methods that are dumped.
+#define LOG_OR_DUMP(context, level, format, ...)                 \
+  do {                                                           \
+    if ((level) <= MT_MAX_LOG_LEVEL) {                           \
+      LOG(CONTEXT_LEVEL(context, level), format, ##__VA_ARGS__); \
+    }                                                            \
   } while (0)
 
 #define WARNING(level, format, ...)                   \
@@ -61,9 +117,11 @@ class Logger {
     SECTION("WARNING", level, format, ##__VA_ARGS__); \
   } while (0)
 
-#define WARNING_OR_DUMP(context, level, format, ...)               \
-  do {                                                             \
-    WARNING(CONTEXT_LEVEL(context, level), format, ##__VA_ARGS__); \
+#define WARNING_OR_DUMP(context, level, format, ...)                 \
+  do {                                                               \
+    if ((level) <= MT_MAX_LOG_LEVEL) {                               \
+      WARNING(CONTEXT_LEVEL(context, level), format, ##__VA_ARGS__); \
+    }                                                                \
   } while (0)
 
 #define ERROR(level, format, ...)                   \
@@ -71,7 +129,9 @@ class Logger {
     SECTION("ERROR", level, format, ##__VA_ARGS__); \
   } while (0)
 
-#define ERROR_OR_DUMP(context, level, format, ...)                 \
-  do {                                                             \
-    WARNING(CONTEXT_LEVEL(context, level), format, ##__VA_ARGS__); \
+#define ERROR_OR_DUMP(context, level, format, ...)                   \
+  do {                                                               \
+    if ((level) <= MT_MAX_LOG_LEVEL) {                               \
+      WARNING(CONTEXT_LEVEL(context, level), format, ##__VA_ARGS__); \
+    }                                                                \
   } while (0)
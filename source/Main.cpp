@@ -17,6 +17,7 @@
 #include <Debug.h>
 #include <RedexContext.h>
 
+#include <mariana-trench/Log.h>
 #include <mariana-trench/MarianaTrench.h>
 #include <mariana-trench/SanitizersOptions.h>
 
@@ -51,6 +52,7 @@ int main(int argc, char* argv[]) {
     tool.run(variables);
     delete g_redex;
   } catch (const aggregate_exception& aggregate_exception) {
+    marianatrench::Logger::flush();
     std::cerr << "Caught multiple exceptions:" << std::endl;
     for (const auto& exception : aggregate_exception.m_exceptions) {
       try {
@@ -61,6 +63,7 @@ int main(int argc, char* argv[]) {
     }
     return 1;
   } catch (const std::exception& exception) {
+    marianatrench::Logger::flush();
     std::cerr << "error: " << exception.what() << std::endl;
     return 1;
   }
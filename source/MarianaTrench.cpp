@@ -5,42 +5,77 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <map>
 #include <memory>
 #include <stdexcept>
+#include <unordered_map>
+#include <utility>
 
 #include <boost/algorithm/string.hpp>
 #include <boost/filesystem/operations.hpp>
 #include <boost/program_options.hpp>
 
 #include <RedexContext.h>
+#include <SpartaWorkQueue.h>
 
+#include <mariana-trench/AnalysisCosts.h>
+#include <mariana-trench/AnalysisSlice.h>
+#include <mariana-trench/ArtifactCache.h>
 #include <mariana-trench/ArtificialMethods.h>
+#include <mariana-trench/CallsiteModelCache.h>
 #include <mariana-trench/ClassHierarchies.h>
 #include <mariana-trench/ClassProperties.h>
+#include <mariana-trench/ConfigurationBundle.h>
 #include <mariana-trench/Context.h>
+#include <mariana-trench/ConvergenceReport.h>
+#include <mariana-trench/CostEstimate.h>
 #include <mariana-trench/Dependencies.h>
+#include <mariana-trench/DuplicateMethods.h>
 #include <mariana-trench/FieldCache.h>
 #include <mariana-trench/Fields.h>
 #include <mariana-trench/Highlights.h>
+#include <mariana-trench/IncrementalAnalysis.h>
 #include <mariana-trench/Interprocedural.h>
+#include <mariana-trench/IssueStream.h>
+#include <mariana-trench/JsonFileCache.h>
 #include <mariana-trench/JsonValidation.h>
 #include <mariana-trench/Kind.h>
+#include <mariana-trench/KindCosts.h>
+#include <mariana-trench/LibrarySummary.h>
 #include <mariana-trench/LifecycleMethods.h>
 #include <mariana-trench/Log.h>
 #include <mariana-trench/MarianaTrench.h>
+#include <mariana-trench/MemoryBudget.h>
+#include <mariana-trench/MethodSet.h>
 #include <mariana-trench/Methods.h>
 #include <mariana-trench/ModelGeneration.h>
+#include <mariana-trench/NumaPlacement.h>
+#include <mariana-trench/OperatingSystem.h>
 #include <mariana-trench/Options.h>
 #include <mariana-trench/Overrides.h>
+#include <mariana-trench/Partitions.h>
+#include <mariana-trench/PerformanceCounters.h>
 #include <mariana-trench/Positions.h>
 #include <mariana-trench/PostprocessTraces.h>
+#include <mariana-trench/Profiler.h>
+#include <mariana-trench/ReachableMethods.h>
 #include <mariana-trench/Redex.h>
 #include <mariana-trench/Rules.h>
+#include <mariana-trench/RuntimeHeuristics.h>
 #include <mariana-trench/Scheduler.h>
+#include <mariana-trench/SinkReachability.h>
 #include <mariana-trench/Statistics.h>
+#include <mariana-trench/TaskGraph.h>
 #include <mariana-trench/Timer.h>
+#include <mariana-trench/Tracer.h>
+#include <mariana-trench/TrivialMethods.h>
 #include <mariana-trench/Types.h>
 #include <mariana-trench/UnusedKinds.h>
+#include <mariana-trench/WorkerPool.h>
+#include <mariana-trench/WorkerSampler.h>
 
 namespace marianatrench {
 
@@ -52,91 +87,193 @@ MarianaTrench::MarianaTrench()
 
 namespace program_options = boost::program_options;
 
+namespace {
+
+/**
+ * Return the memory of structures freed at the end of a phase to the
+ * operating system, and record the resident set size before and after.
+ */
+void release_memory(Context& context, const std::string& structures) {
+  auto resident_set_size = resident_set_size_in_gb();
+  if (!release_free_memory()) {
+    return;
+  }
+  auto released_resident_set_size = resident_set_size_in_gb();
+  context.statistics->log_phase_resident_set_size(
+      fmt::format("release:{}", structures),
+      resident_set_size,
+      released_resident_set_size);
+  LOG(2,
+      "Released {}, resident set size went from {:.2f}GB to {:.2f}GB.",
+      structures,
+      resident_set_size,
+      released_resident_set_size);
+}
+
+} // namespace
+
 void MarianaTrench::add_options(
     program_options::options_description& options) const {
   Options::add_options(options);
 }
 
 Registry MarianaTrench::analyze(Context& context) {
+  build_program(context);
+  return analyze_program(context);
+}
+
+void MarianaTrench::build_program(Context& context) {
+  if (const auto& heuristics_path = context.options->heuristics_path()) {
+    context.heuristics =
+        std::make_unique<RuntimeHeuristics>(RuntimeHeuristics::from_json(
+            JsonFileCache::parse(*heuristics_path)));
+  }
+
   context.artificial_methods =
       std::make_unique<ArtificialMethods>(*context.kinds, context.stores);
-  Timer methods_timer;
-  LOG(1, "Storing methods...");
-  context.methods = std::make_unique<Methods>(context.stores);
-  if (context.options->dump_methods()) {
-    auto method_list = Json::Value(Json::arrayValue);
-    for (const auto* method : *context.methods) {
-      method_list.append(method->signature());
+
+  // Independent phases run concurrently. Phases only read the classes, except
+  // for the following constraints:
+  // - `Positions` must run before `Types`, because building the control flow
+  //   graph destroys the positions of methods;
+  // - `Positions` changes the working directory, hence it must not run
+  //   concurrently with phases that read files with relative paths.
+  TaskGraph phases;
+
+  phases.add("methods", [&]() {
+    Timer methods_timer;
+    TraceSpan methods_span("methods");
+    LOG(1, "Storing methods...");
+    context.methods = std::make_unique<Methods>(
+        context.stores, context.options->log_methods());
+    if (context.options->dump_methods()) {
+      auto method_list = Json::Value(Json::arrayValue);
+      for (const auto* method : *context.methods) {
+        method_list.append(method->signature());
+      }
+      auto methods_path = context.options->methods_output_path();
+      LOG(1, "Writing methods to `{}`.", methods_path.native());
+      JsonValidation::write_json_file(methods_path, method_list);
     }
-    auto methods_path = context.options->methods_output_path();
-    LOG(1, "Writing methods to `{}`.", methods_path.native());
-    JsonValidation::write_json_file(methods_path, method_list);
-  }
-  LOG(1, "Stored all methods in {:.2f}s", methods_timer.duration_in_seconds());
-
-  Timer fields_timer;
-  LOG(1, "Storing fields...");
-  context.fields = std::make_unique<Fields>(context.stores);
-  LOG(1, "Stored all fields in {:.2f}s", fields_timer.duration_in_seconds());
-
-  Timer index_timer;
-  LOG(1, "Building source index...");
-  context.positions =
-      std::make_unique<Positions>(*context.options, context.stores);
-  context.statistics->log_time("source_index", index_timer);
-  LOG(1, "Built source index in {:.2f}s.", index_timer.duration_in_seconds());
-
-  Timer types_timer;
-  LOG(1, "Inferring types...");
-  context.types = std::make_unique<Types>(*context.options, context.stores);
-  context.statistics->log_time("types", types_timer);
-  LOG(1, "Inferred types in {:.2f}s.", types_timer.duration_in_seconds());
-
-  Timer class_properties_timer;
-  context.class_properties = std::make_unique<ClassProperties>(
-      *context.options, context.stores, *context.features);
-  context.statistics->log_time("class_properties", class_properties_timer);
-  LOG(1,
-      "Created class properties in {:.2f}s.",
-      class_properties_timer.duration_in_seconds());
-
-  Timer class_hierarchies_timer;
-  LOG(1, "Building class hierarchies...");
-  context.class_hierarchies =
-      std::make_unique<ClassHierarchies>(*context.options, context.stores);
-  context.statistics->log_time("class_hierarchies", class_hierarchies_timer);
-  LOG(1,
-      "Built class hierarchies in {:.2f}s.",
-      class_hierarchies_timer.duration_in_seconds());
-
-  Timer field_cache_timer;
-  LOG(1, "Building fields cache...");
-  context.field_cache =
-      std::make_unique<FieldCache>(*context.class_hierarchies, context.stores);
-  context.statistics->log_time("fields", field_cache_timer);
-  LOG(1,
-      "Built fields cache in {:.2f}s.",
-      field_cache_timer.duration_in_seconds());
+    LOG(1,
+        "Stored all methods in {:.2f}s",
+        methods_timer.duration_in_seconds());
+  });
+
+  phases.add("fields", [&]() {
+    Timer fields_timer;
+    TraceSpan fields_span("fields");
+    LOG(1, "Storing fields...");
+    context.fields = std::make_unique<Fields>(context.stores);
+    LOG(1, "Stored all fields in {:.2f}s", fields_timer.duration_in_seconds());
+  });
+
+  auto positions = phases.add("source_index", [&]() {
+    Timer index_timer;
+    TraceSpan index_span("source_index");
+    LOG(1, "Building source index...");
+    context.positions =
+        std::make_unique<Positions>(*context.options, context.stores);
+    index_span.end();
+    context.statistics->log_time("source_index", index_timer);
+    LOG(1, "Built source index in {:.2f}s.", index_timer.duration_in_seconds());
+  });
+
+  phases.add(
+      "types",
+      [&]() {
+        Timer types_timer;
+        TraceSpan types_span("types");
+        LOG(1, "Inferring types...");
+        context.types =
+            std::make_unique<Types>(*context.options, context.stores);
+        types_span.end();
+        context.statistics->log_time("types", types_timer);
+        LOG(1, "Inferred types in {:.2f}s.", types_timer.duration_in_seconds());
+      },
+      /* dependencies */ {positions});
+
+  phases.add(
+      "class_properties",
+      [&]() {
+        Timer class_properties_timer;
+        TraceSpan class_properties_span("class_properties");
+        context.class_properties = std::make_unique<ClassProperties>(
+            *context.options, context.stores, *context.features);
+        class_properties_span.end();
+        context.statistics->log_time(
+            "class_properties", class_properties_timer);
+        LOG(1,
+            "Created class properties in {:.2f}s.",
+            class_properties_timer.duration_in_seconds());
+      },
+      /* dependencies */ {positions});
+
+  auto class_hierarchies = phases.add("class_hierarchies", [&]() {
+    Timer class_hierarchies_timer;
+    TraceSpan class_hierarchies_span("class_hierarchies");
+    LOG(1, "Building class hierarchies...");
+    context.class_hierarchies =
+        std::make_unique<ClassHierarchies>(*context.options, context.stores);
+    class_hierarchies_span.end();
+    context.statistics->log_time("class_hierarchies", class_hierarchies_timer);
+    LOG(1,
+        "Built class hierarchies in {:.2f}s.",
+        class_hierarchies_timer.duration_in_seconds());
+  });
+
+  phases.add(
+      "fields_cache",
+      [&]() {
+        Timer field_cache_timer;
+        TraceSpan field_cache_span("fields");
+        LOG(1, "Building fields cache...");
+        context.field_cache = std::make_unique<FieldCache>(
+            *context.class_hierarchies, context.stores);
+        field_cache_span.end();
+        context.statistics->log_time("fields", field_cache_timer);
+        LOG(1,
+            "Built fields cache in {:.2f}s.",
+            field_cache_timer.duration_in_seconds());
+      },
+      /* dependencies */ {class_hierarchies});
+
+  phases.run();
 
   Timer lifecycle_methods_timer;
+  TraceSpan lifecycle_methods_span("lifecycle_methods");
+  PhaseCounters lifecycle_methods_counters(
+      context.performance_counters.get(),
+      *context.statistics,
+      "lifecycle_methods");
   LOG(1, "Creating life-cycle wrapper methods...");
-  LifecycleMethods::run(
+  auto lifecycle_methods = LifecycleMethods::run(
       *context.options, *context.class_hierarchies, *context.methods);
+  lifecycle_methods_span.end();
+  lifecycle_methods_counters.end();
   context.statistics->log_time("lifecycle_methods", lifecycle_methods_timer);
   LOG(1,
       "Created lifecycle methods in {:.2f}s.",
       lifecycle_methods_timer.duration_in_seconds());
 
   Timer overrides_timer;
+  TraceSpan overrides_span("overrides");
+  PhaseCounters overrides_counters(
+      context.performance_counters.get(), *context.statistics, "overrides");
   LOG(1, "Building override graph...");
   context.overrides = std::make_unique<Overrides>(
       *context.options, *context.methods, context.stores);
+  overrides_span.end();
+  overrides_counters.end();
   context.statistics->log_time("overrides", overrides_timer);
   LOG(1,
       "Built override graph in {:.2f}s.",
       overrides_timer.duration_in_seconds());
 
   Timer call_graph_timer;
+  TraceSpan call_graph_span("call_graph");
+  PhaseCounters call_graph_counters(
+      context.performance_counters.get(), *context.statistics, "call_graph");
   LOG(1, "Building call graph...");
   context.call_graph = std::make_unique<CallGraph>(
       *context.options,
@@ -146,28 +283,122 @@ Registry MarianaTrench::analyze(Context& context) {
       *context.class_hierarchies,
       *context.overrides,
       *context.features);
+  call_graph_span.end();
+  call_graph_counters.end();
   context.statistics->log_time("call_graph", call_graph_timer);
   LOG(1,
       "Built call graph in {:.2f}s.",
       call_graph_timer.duration_in_seconds());
 
+  if (context.options->entry_point_reachability()) {
+    Timer reachable_methods_timer;
+    TraceSpan reachable_methods_span("reachable_methods");
+    PhaseCounters reachable_methods_counters(
+        context.performance_counters.get(),
+        *context.statistics,
+        "reachable_methods");
+    LOG(1, "Computing methods reachable from entry points...");
+    context.reachable_methods = std::make_unique<ReachableMethods>(
+        *context.options,
+        *context.methods,
+        *context.class_properties,
+        *context.call_graph,
+        lifecycle_methods);
+    reachable_methods_span.end();
+    reachable_methods_counters.end();
+    context.statistics->log_time(
+        "reachable_methods", reachable_methods_timer);
+    LOG(1,
+        "Computed reachable methods in {:.2f}s.",
+        reachable_methods_timer.duration_in_seconds());
+  }
+
+  context.heuristics->index(*context.methods);
+
+  Timer positions_timer;
+  TraceSpan positions_span("method_positions");
+  PhaseCounters positions_counters(
+      context.performance_counters.get(),
+      *context.statistics,
+      "method_positions");
+  LOG(1, "Indexing method positions...");
+  context.positions->index_methods(*context.methods);
+  positions_span.end();
+  positions_counters.end();
+  context.statistics->log_time("method_positions", positions_timer);
+  LOG(1,
+      "Indexed method positions in {:.2f}s.",
+      positions_timer.duration_in_seconds());
+
+  if (const auto& types_cache_path = context.options->types_cache_path()) {
+    // All types needed by the analysis are inferred when building the call
+    // graph.
+    Timer types_cache_timer;
+    TraceSpan types_cache_span("types_cache");
+    LOG(1, "Writing types cache to `{}`...", *types_cache_path);
+    context.types->dump_cache(*types_cache_path);
+    types_cache_span.end();
+    context.statistics->log_time("types_cache", types_cache_timer);
+    LOG(1,
+        "Wrote types cache in {:.2f}s.",
+        types_cache_timer.duration_in_seconds());
+  }
+
+  // The types of all methods were inferred when building the call graph.
+  if (context.types->release_global_type_analysis()) {
+    release_memory(context, "global_type_analysis");
+  }
+}
+
+Registry MarianaTrench::analyze_program(Context& context) {
+  MethodSet::set_maximum_size(context.options->maximum_origins());
+
+  // Rules do not depend on generated models, hence they are parsed while
+  // model generators run.
+  TaskGraph phases;
+
   std::vector<Model> generated_models;
   std::vector<FieldModel> generated_field_models;
-  if (!context.options->skip_model_generation()) {
-    Timer generation_timer;
-    LOG(1, "Generating models...");
-    auto model_generator_result = ModelGeneration::run(context);
-    generated_models = model_generator_result.method_models;
-    generated_field_models = model_generator_result.field_models;
-    context.statistics->log_time("models_generation", generation_timer);
+  phases.add("models_generation", [&]() {
+    if (!context.options->skip_model_generation()) {
+      Timer generation_timer;
+      TraceSpan generation_span("models_generation");
+      PhaseCounters generation_counters(
+          context.performance_counters.get(),
+          *context.statistics,
+          "models_generation");
+      LOG(1, "Generating models...");
+      auto model_generator_result = ModelGeneration::run(context);
+      generated_models = std::move(model_generator_result.method_models);
+      generated_field_models = std::move(model_generator_result.field_models);
+      generation_span.end();
+      generation_counters.end();
+      context.statistics->log_time("models_generation", generation_timer);
+      LOG(1,
+          "Generated {} models and {} field models in {:.2f}s.",
+          generated_models.size(),
+          generated_field_models.size(),
+          generation_timer.duration_in_seconds());
+    } else {
+      LOG(1, "Skipped model generation.");
+    }
+  });
+
+  phases.add("rules_init", [&]() {
+    Timer rules_timer;
+    TraceSpan rules_span("rules_init");
+    LOG(1, "Initializing rules...");
+    context.rules =
+        std::make_unique<Rules>(Rules::load(context, *context.options));
+    rules_span.end();
+    context.statistics->log_time("rules_init", rules_timer);
     LOG(1,
-        "Generated {} models and {} field models in {:.2f}s.",
-        generated_models.size(),
-        generated_field_models.size(),
-        generation_timer.duration_in_seconds());
-  } else {
-    LOG(1, "Skipped model generation.");
-  }
+        "Initialized {} rules in {:.2f}s.",
+        context.rules->size(),
+        rules_timer.duration_in_seconds());
+  });
+
+  phases.run();
 
   // Add models for artificial methods.
   {
@@ -176,10 +407,33 @@ Registry MarianaTrench::analyze(Context& context) {
         generated_models.end(), models.begin(), models.end());
   }
 
+  Timer kind_pruning_timer;
+  TraceSpan kind_pruning_span("prune_kinds");
+  PhaseCounters kind_pruning_counters(
+      context.performance_counters.get(), *context.statistics, "prune_kinds");
+  LOG(1, "Collecting unused kinds...");
+  auto unused_kinds = UnusedKinds(*context.rules, *context.kinds);
+  kind_pruning_span.end();
+  kind_pruning_counters.end();
+  context.statistics->log_time("prune_kinds", kind_pruning_timer);
+  LOG(1,
+      "Found {} unused kinds in {:.2f}s.",
+      unused_kinds.kinds().size(),
+      kind_pruning_timer.duration_in_seconds());
+
   Timer registry_timer;
+  TraceSpan registry_span("registry_init");
+  PhaseCounters registry_counters(
+      context.performance_counters.get(), *context.statistics, "registry_init");
   LOG(1, "Initializing models...");
   auto registry = Registry::load(
-      context, *context.options, generated_models, generated_field_models);
+      context,
+      *context.options,
+      generated_models,
+      generated_field_models,
+      unused_kinds);
+  registry_span.end();
+  registry_counters.end();
   context.statistics->log_time("registry_init", registry_timer);
   LOG(1,
       "Initialized {} models and {} field models in {:.2f}s.",
@@ -187,60 +441,266 @@ Registry MarianaTrench::analyze(Context& context) {
       registry.field_models_size(),
       registry_timer.duration_in_seconds());
 
-  Timer rules_timer;
-  LOG(1, "Initializing rules...");
-  context.rules =
-      std::make_unique<Rules>(Rules::load(context, *context.options));
-  context.statistics->log_time("rules_init", rules_timer);
-  LOG(1,
-      "Initialized {} rules in {:.2f}s.",
-      context.rules->size(),
-      rules_timer.duration_in_seconds());
+  // Generated models are joined into the registry. Model generators and their
+  // mappings were freed at the end of `ModelGeneration::run`.
+  generated_models = std::vector<Model>();
+  generated_field_models = std::vector<FieldModel>();
+  release_memory(context, "generated_models");
 
-  Timer kind_pruning_timer;
-  LOG(1, "Removing unused Kinds");
-  int num_removed = UnusedKinds::remove_unused_kinds(context, registry).size();
-  context.statistics->log_time("prune_kinds", rules_timer);
-  LOG(1,
-      "Removed {} kinds in {:.2f}s.",
-      num_removed,
-      kind_pruning_timer.duration_in_seconds());
+  // Summarized methods are frozen before building the dependency graph, so
+  // that they do not depend on their callees.
+  std::unordered_set<const Method*> summarized_methods;
+  if (!context.options->library_summary_paths().empty()) {
+    Timer library_summaries_timer;
+    TraceSpan library_summaries_span("library_summaries");
+    LOG(1, "Loading library summaries...");
+    for (const auto& path : context.options->library_summary_paths()) {
+      auto methods = LibrarySummary::load(context, registry, path);
+      summarized_methods.insert(methods.begin(), methods.end());
+    }
+    library_summaries_span.end();
+    context.statistics->log_time("library_summaries", library_summaries_timer);
+    LOG(1,
+        "Loaded summaries of {} methods in {:.2f}s.",
+        summarized_methods.size(),
+        library_summaries_timer.duration_in_seconds());
+  }
 
   Timer dependencies_timer;
+  TraceSpan dependencies_span("dependencies");
+  PhaseCounters dependencies_counters(
+      context.performance_counters.get(), *context.statistics, "dependencies");
   LOG(1, "Building dependency graph...");
   context.dependencies = std::make_unique<Dependencies>(
       *context.options,
       *context.methods,
       *context.overrides,
       *context.call_graph,
-      registry);
+      registry,
+      context.reachable_methods.get());
+  dependencies_span.end();
+  dependencies_counters.end();
   context.statistics->log_time("dependencies", dependencies_timer);
   LOG(1,
       "Built dependency graph in {:.2f}s.",
       dependencies_timer.duration_in_seconds());
 
+  if (context.options->prune_unreachable_sources()) {
+    Timer source_pruning_timer;
+    TraceSpan source_pruning_span("prune_sources");
+    LOG(1, "Removing sources that cannot reach sinks...");
+    auto sink_reachability = SinkReachability(context, registry);
+    auto pruned_models = sink_reachability.prune(registry);
+    source_pruning_span.end();
+    context.statistics->log_time("prune_sources", source_pruning_timer);
+    LOG(1,
+        "Removed sources of {} models, given {} sink kinds, in {:.2f}s.",
+        pruned_models,
+        sink_reachability.sink_kinds(),
+        source_pruning_timer.duration_in_seconds());
+  }
+
   Timer scheduler_timer;
+  TraceSpan scheduler_span("scheduler");
+  PhaseCounters scheduler_counters(
+      context.performance_counters.get(), *context.statistics, "scheduler");
   LOG(1, "Building the analysis schedule...");
-  context.scheduler =
-      std::make_unique<Scheduler>(*context.methods, *context.dependencies);
+  std::unordered_map<const Method*, double> cost_profile;
+  if (const auto& cost_profile_path = context.options->cost_profile_path()) {
+    cost_profile = AnalysisCosts::read_cost_profile(
+        *cost_profile_path, *context.methods);
+  }
+  context.scheduler = std::make_unique<Scheduler>(
+      *context.methods,
+      *context.dependencies,
+      *context.statistics,
+      std::move(cost_profile));
+  if (context.options->numa_aware_scheduling()) {
+    context.numa_placement = std::make_unique<NumaPlacement>(
+        *context.scheduler,
+        context.options->jobs(AnalysisPhase::Fixpoint));
+    context.scheduler->set_numa_placement(context.numa_placement.get());
+  }
+  scheduler_span.end();
+  scheduler_counters.end();
   context.statistics->log_time("scheduler", scheduler_timer);
   LOG(1,
       "Built the analysis schedule in {:.2f}s.",
       scheduler_timer.duration_in_seconds());
 
+  if (context.options->estimate_only()) {
+    auto estimate = CostEstimate(context, registry, resident_set_size_in_gb());
+    auto estimate_path = context.options->cost_estimate_output_path();
+    LOG(1,
+        "Estimated a fixpoint of {:.0f}s with a peak resident set size of {:.2f}GB, writing the estimate to `{}`.",
+        estimate.fixpoint_seconds(),
+        estimate.peak_resident_set_size_in_gb(),
+        estimate_path.native());
+    JsonValidation::write_json_file(estimate_path, estimate.to_json());
+    return registry;
+  }
+
+  Timer fingerprints_timer;
+  TraceSpan fingerprints_span("fingerprints");
+  LOG(1, "Computing method fingerprints...");
+  auto fingerprints = IncrementalAnalysis::fingerprints(context, registry);
+  JsonValidation::write_json_file(
+      context.options->fingerprints_output_path(),
+      IncrementalAnalysis::fingerprints_to_json(fingerprints));
+  std::unordered_set<const Method*> methods_to_analyze;
+  if (const auto& previous_output_directory =
+          context.options->previous_output_directory()) {
+    methods_to_analyze = IncrementalAnalysis::load_previous_models(
+        context, registry, fingerprints, *previous_output_directory);
+  } else {
+    methods_to_analyze.insert(
+        context.methods->begin(), context.methods->end());
+  }
+  for (const auto* method : summarized_methods) {
+    methods_to_analyze.erase(method);
+  }
+  fingerprints_span.end();
+  context.statistics->log_time("fingerprints", fingerprints_timer);
+  LOG(1,
+      "Computed method fingerprints in {:.2f}s.",
+      fingerprints_timer.duration_in_seconds());
+
+  if (context.reachable_methods != nullptr) {
+    std::size_t methods_skipped = 0;
+    for (auto iterator = methods_to_analyze.begin();
+         iterator != methods_to_analyze.end();) {
+      if (!context.reachable_methods->contains(*iterator)) {
+        iterator = methods_to_analyze.erase(iterator);
+        methods_skipped++;
+      } else {
+        ++iterator;
+      }
+    }
+    LOG(1,
+        "Skipping {} methods unreachable from entry points.",
+        methods_skipped);
+  }
+
+  if (context.options->demand_driven_analysis()) {
+    Timer slice_timer;
+    TraceSpan slice_span("analysis_slice");
+    LOG(1, "Computing the analysis slice...");
+    auto relevant_methods =
+        AnalysisSlice::relevant_methods(context, registry);
+    std::size_t methods_skipped = 0;
+    for (auto iterator = methods_to_analyze.begin();
+         iterator != methods_to_analyze.end();) {
+      if (relevant_methods.count(*iterator) == 0) {
+        iterator = methods_to_analyze.erase(iterator);
+        methods_skipped++;
+      } else {
+        ++iterator;
+      }
+    }
+    slice_span.end();
+    context.statistics->log_time("analysis_slice", slice_timer);
+    LOG(1,
+        "Computed the analysis slice in {:.2f}s. Skipping {} methods.",
+        slice_timer.duration_in_seconds(),
+        methods_skipped);
+  }
+
+  if (auto count = context.options->partition_count()) {
+    Timer partitions_timer;
+    TraceSpan partitions_span("partitions");
+    LOG(1, "Partitioning methods...");
+    context.partitions = std::make_unique<Partitions>(
+        *context.methods,
+        *context.scheduler,
+        *count,
+        context.options->partition_index());
+    context.partitions->load_models(
+        context, registry, *context.options->partition_directory());
+    for (auto iterator = methods_to_analyze.begin();
+         iterator != methods_to_analyze.end();) {
+      if (!context.partitions->is_local(*iterator)) {
+        iterator = methods_to_analyze.erase(iterator);
+      } else {
+        ++iterator;
+      }
+    }
+    partitions_span.end();
+    context.statistics->log_time("partitions", partitions_timer);
+    LOG(1,
+        "Partitioned methods in {:.2f}s. Analyzing {} methods.",
+        partitions_timer.duration_in_seconds(),
+        methods_to_analyze.size());
+  }
+
+  if (auto size = context.options->callsite_model_cache_size(); size > 0) {
+    context.callsite_model_cache = std::make_unique<CallsiteModelCache>(size);
+  }
+  if (auto limit = context.options->memory_budget_in_gb()) {
+    context.memory_budget = std::make_unique<MemoryBudget>(*limit);
+  }
+  if (!context.options->disable_issue_stream()) {
+    context.issue_stream = std::make_unique<IssueStream>(
+        context.options->issues_stream_output_path(), *context.methods);
+  }
+  if (context.options->deduplicate_methods()) {
+    Timer duplicate_methods_timer;
+    LOG(1, "Finding methods with identical code...");
+    context.duplicate_methods = std::make_unique<DuplicateMethods>(
+        *context.methods, *context.call_graph, *context.heuristics);
+    context.statistics->log_time("duplicate_methods", duplicate_methods_timer);
+    LOG(1,
+        "Found {} methods with identical code in {:.2f}s.",
+        context.duplicate_methods->size(),
+        duplicate_methods_timer.duration_in_seconds());
+  }
+  if (context.options->summarize_trivial_methods()) {
+    Timer trivial_methods_timer;
+    LOG(1, "Finding trivial methods...");
+    context.trivial_methods =
+        std::make_unique<TrivialMethods>(*context.methods, *context.call_graph);
+    context.statistics->log_time("trivial_methods", trivial_methods_timer);
+    LOG(1,
+        "Found {} trivial methods in {:.2f}s.",
+        context.trivial_methods->size(),
+        trivial_methods_timer.duration_in_seconds());
+  }
+
   Timer analysis_timer;
+  TraceSpan analysis_span("fixpoint");
+  PhaseCounters analysis_counters(
+      context.performance_counters.get(), *context.statistics, "fixpoint");
   LOG(1, "Analyzing...");
-  Interprocedural::run_analysis(context, registry);
+  Interprocedural::run_analysis(context, registry, methods_to_analyze);
+  analysis_span.end();
+  analysis_counters.end();
   context.statistics->log_time("fixpoint", analysis_timer);
+  context.statistics->log_truncated_origins(MethodSet::number_truncations());
   LOG(1,
       "Analyzed {} models in {:.2f}s. Found {} issues!",
       registry.models_size(),
       analysis_timer.duration_in_seconds(),
       registry.issues_size());
+  if (context.callsite_model_cache != nullptr) {
+    LOG(1,
+        "Call site model cache hit rate: {:.2f}%.",
+        context.callsite_model_cache->hit_rate() * 100.0);
+  }
+
+  if (context.partitions != nullptr) {
+    context.partitions->write_models(
+        context, registry, *context.options->partition_directory());
+  }
 
   Timer remove_collapsed_traces_timer;
+  TraceSpan remove_collapsed_traces_span("remove_collapsed_traces");
+  PhaseCounters remove_collapsed_traces_counters(
+      context.performance_counters.get(),
+      *context.statistics,
+      "remove_collapsed_traces");
   LOG(2, "Removing invalid traces due to collapsing...");
   PostprocessTraces::remove_collapsed_traces(registry, context);
+  remove_collapsed_traces_span.end();
+  remove_collapsed_traces_counters.end();
   context.statistics->log_time(
       "remove_collapsed_traces", remove_collapsed_traces_timer);
   LOG(2,
@@ -249,8 +709,15 @@ Registry MarianaTrench::analyze(Context& context) {
 
   if (!context.options->skip_source_indexing()) {
     Timer augment_positions_timer;
+    TraceSpan augment_positions_span("augment_positions");
+    PhaseCounters augment_positions_counters(
+        context.performance_counters.get(),
+        *context.statistics,
+        "augment_positions");
     LOG(1, "Augmenting positions...");
     Highlights::augment_positions(registry, context);
+    augment_positions_span.end();
+    augment_positions_counters.end();
     context.statistics->log_time("augment_positions", augment_positions_timer);
     LOG(1,
         "Augmented positions in {:.2f}s.",
@@ -259,6 +726,20 @@ Registry MarianaTrench::analyze(Context& context) {
     LOG(2, "Skipped augmenting positions.");
   }
 
+  Timer compact_issues_timer;
+  LOG(1, "Compacting issues...");
+  auto compact_issues = registry.compact_issues();
+  context.statistics->log_time("compact_issues", compact_issues_timer);
+  LOG(1,
+      "Compacted {} issues in {:.2f}s.",
+      compact_issues,
+      compact_issues_timer.duration_in_seconds());
+
+  if (context.options->write_library_summary()) {
+    LibrarySummary::write(
+        context, registry, context.options->library_summary_output_path());
+  }
+
   return registry;
 }
 
@@ -279,17 +760,152 @@ std::vector<std::string> filter_existing_jars(
   return results;
 }
 
+/* Fetch the state of a previous run from `--artifact-cache`, if any. */
+void fetch_previous_state(Options& options) {
+  const auto& key = options.artifact_cache_fetch_key();
+  if (!key) {
+    return;
+  }
+  auto cache = ArtifactCache::from_location(*options.artifact_cache());
+  auto directory = options.previous_state_directory();
+  boost::filesystem::remove_all(directory);
+  if (cache->fetch(*key, directory)) {
+    options.use_previous_state(directory);
+  } else {
+    WARNING(
+        1,
+        "Could not find `{}` in the artifact cache, the analysis starts from scratch.",
+        *key);
+  }
+}
+
+/* Store the state of this run in `--artifact-cache`, if requested. */
+void store_state(const Options& options) {
+  const auto& key = options.artifact_cache_store_key();
+  if (!key || options.estimate_only()) {
+    return;
+  }
+  // Files read by `IncrementalAnalysis` and `Options::use_previous_state`.
+  std::map<std::string, boost::filesystem::path> files;
+  auto fingerprints_path = options.fingerprints_output_path();
+  files.emplace(fingerprints_path.filename().string(), fingerprints_path);
+  for (const auto& entry :
+       boost::filesystem::directory_iterator(options.models_output_path())) {
+    auto filename = entry.path().filename().string();
+    if (boost::starts_with(filename, "model@") &&
+        (boost::ends_with(filename, ".json") ||
+         boost::ends_with(filename, ".json.gz"))) {
+      files.emplace(filename, entry.path());
+    }
+  }
+  if (const auto& types_cache_path = options.types_cache_path()) {
+    files.emplace("types_cache.json", *types_cache_path);
+  }
+  if (options.write_library_summary()) {
+    auto summary_path = options.library_summary_output_path();
+    files.emplace(summary_path.filename().string(), summary_path);
+  }
+
+  auto cache = ArtifactCache::from_location(*options.artifact_cache());
+  cache->store(*key, files);
+}
+
 } // namespace
 
 void MarianaTrench::run(const program_options::variables_map& variables) {
+  auto options = std::make_unique<Options>(variables);
+  if (const auto& structured_log_path = options->structured_log_path()) {
+    Logger::set_structured_output(*structured_log_path);
+  }
+  if (options->trace_phases()) {
+    Tracer::enable();
+  }
+  auto batch_path = options->batch_path();
+  if (batch_path) {
+    JsonFileCache::enable();
+  }
+  if (const auto& bundle_path = options->configuration_bundle_path()) {
+    ConfigurationBundle::load(*bundle_path);
+  }
+  if (options->write_configuration_bundle()) {
+    ConfigurationBundle::write(
+        *options, options->configuration_bundle_output_path());
+  }
+  fetch_previous_state(*options);
+
+  options = run_application(std::move(options));
+  store_state(*options);
+  if (!batch_path) {
+    return;
+  }
+
+  std::ifstream batch(*batch_path);
+  std::string line;
+  std::size_t applications = 1;
+  while (std::getline(batch, line)) {
+    if (line.empty()) {
+      continue;
+    }
+
+    Timer application_timer;
+    options->update_from_batch_entry(JsonValidation::parse_json(line));
+    LOG(1, "Analyzing application `{}`...", options->apk_directory());
+    // Redex interns classes, methods and types in its global context, hence
+    // each application needs a new one.
+    delete g_redex;
+    g_redex = new RedexContext(/* allow_class_duplicates */ true);
+    options = run_application(std::move(options));
+    applications++;
+    LOG(1,
+        "Analyzed application `{}` in {:.2f}s.",
+        options->apk_directory(),
+        application_timer.duration_in_seconds());
+  }
+  LOG(1, "Analyzed {} applications.", applications);
+}
+
+std::unique_ptr<Options> MarianaTrench::run_application(
+    std::unique_ptr<Options> application_options) {
   Context context;
 
-  context.options = std::make_unique<Options>(variables);
+  context.options = std::move(application_options);
   const auto& options = *context.options;
+  if (options.profile_analysis()) {
+    context.profiler = std::make_unique<Profiler>();
+  }
+  if (auto interval = options.worker_timeline_interval_in_milliseconds()) {
+    context.worker_sampler = std::make_unique<WorkerSampler>(
+        options.jobs(AnalysisPhase::Fixpoint),
+        std::chrono::milliseconds(*interval));
+  }
+  if (options.convergence_report()) {
+    context.convergence_report = std::make_unique<ConvergenceReport>();
+  }
+  if (options.kind_costs()) {
+    context.kind_costs = std::make_unique<KindCosts>();
+  }
+  if (options.performance_counters()) {
+    // Counters only count threads created after them, hence they are opened
+    // before any phase starts a thread.
+    context.performance_counters = std::make_unique<PerformanceCounters>(
+        PerformanceCounters::Scope::Process);
+    if (!context.performance_counters->available()) {
+      WARNING(
+          1,
+          "Unable to open hardware performance counters, check `perf_event_paranoid`.");
+      context.performance_counters = nullptr;
+    }
+  }
+  // Threads are started by the first phase that needs them, and reused by
+  // all later phases and global iterations.
+  context.worker_pool = std::make_unique<WorkerPool>();
 
   auto system_jar_paths = filter_existing_jars(options.system_jar_paths());
 
   Timer initialization_timer;
+  TraceSpan initialization_span("redex_init");
+  PhaseCounters initialization_counters(
+      context.performance_counters.get(), *context.statistics, "redex_init");
   LOG(1, "Initializing Redex...");
   context.stores = init(
       boost::join(system_jar_paths, ","),
@@ -308,23 +924,133 @@ void MarianaTrench::run(const program_options::variables_map& variables) {
   external_store.add_classes(g_redex->external_classes());
   context.stores.push_back(external_store);
 
+  initialization_span.end();
+  initialization_counters.end();
   context.statistics->log_time("redex_init", initialization_timer);
   LOG(1,
       "Redex initialized in {:.2f}s.",
       initialization_timer.duration_in_seconds());
 
+  TraceSpan analysis_span("analysis");
+  PhaseCounters analysis_counters(
+      context.performance_counters.get(), *context.statistics, "analysis");
   auto registry = analyze(context);
+  analysis_span.end();
+  analysis_counters.end();
+  if (!options.estimate_only()) {
+    write_outputs(context, registry);
+  }
+
+  if (options.server()) {
+    serve(context);
+  }
+
+  return std::move(context.options);
+}
+
+void MarianaTrench::serve(Context& context) {
+  auto writer = JsonValidation::compact_writer();
+  std::string line;
+
+  LOG(1, "Waiting for analysis requests on the standard input...");
+  while (std::getline(std::cin, line)) {
+    if (line.empty()) {
+      continue;
+    }
+
+    auto response = Json::Value(Json::objectValue);
+    try {
+      Timer request_timer;
+      TraceSpan request_span("request");
+      context.options->update_from_request(JsonValidation::parse_json(line));
+      auto registry = analyze_program(context);
+      if (!context.options->estimate_only()) {
+        write_outputs(context, registry);
+      }
+      response["status"] = "ok";
+      response["models_path"] = context.options->models_output_path().native();
+      response["models"] =
+          Json::Value(static_cast<Json::UInt64>(registry.models_size()));
+      response["issues"] =
+          Json::Value(static_cast<Json::UInt64>(registry.issues_size()));
+      response["seconds"] = request_timer.duration_in_seconds();
+    } catch (const std::exception& exception) {
+      ERROR(1, "Analysis request failed: {}", exception.what());
+      response["status"] = "error";
+      response["message"] = exception.what();
+    }
+    Logger::flush();
+
+    writer->write(response, &std::cout);
+    std::cout << std::endl;
+  }
+}
+
+void MarianaTrench::write_outputs(Context& context, Registry& registry) {
+  const auto& options = *context.options;
 
   Timer output_timer;
+  TraceSpan output_span("dump_models");
+  PhaseCounters output_counters(
+      context.performance_counters.get(), *context.statistics, "dump_models");
   auto models_path = options.models_output_path();
   LOG(1, "Writing models to `{}`.", models_path.native());
-  registry.dump_models(models_path);
+  if (options.compress_models()) {
+    registry.dump_compressed_models(models_path);
+  } else {
+    registry.dump_models(models_path);
+  }
+  if (options.dump_binary_models()) {
+    registry.dump_binary_models(models_path);
+  }
+  output_span.end();
+  output_counters.end();
   context.statistics->log_time("dump_models", output_timer);
   LOG(1, "Wrote models in {:.2f}s.", output_timer.duration_in_seconds());
 
   auto metadata_path = options.metadata_output_path();
   LOG(1, "Writing metadata to `{}`.", metadata_path.native());
   registry.dump_metadata(/* path */ metadata_path);
+
+  for (const auto& [pack, codes] : context.rules->packs()) {
+    auto pack_issues_path = options.rule_pack_issues_output_path(pack);
+    LOG(1,
+        "Writing issues of rule pack `{}` to `{}`.",
+        pack,
+        pack_issues_path.native());
+    IssueStream(pack_issues_path, *context.methods, codes).write(registry);
+  }
+
+  auto analysis_costs_path = options.analysis_costs_output_path();
+  LOG(1, "Writing analysis costs to `{}`.", analysis_costs_path.native());
+  AnalysisCosts::write(
+      analysis_costs_path, *context.methods, *context.statistics, registry);
+
+  if (context.profiler != nullptr) {
+    auto profile_path = options.profile_output_path();
+    LOG(1, "Writing analysis profile to `{}`.", profile_path.native());
+    JsonValidation::write_json_file(profile_path, context.profiler->to_json());
+  }
+
+  if (context.worker_sampler != nullptr) {
+    auto timeline_path = options.worker_timeline_output_path();
+    LOG(1, "Writing worker timeline to `{}`.", timeline_path.native());
+    JsonValidation::write_json_file(
+        timeline_path, context.worker_sampler->to_json());
+  }
+
+  if (context.convergence_report != nullptr) {
+    auto report_path = options.convergence_report_output_path();
+    LOG(1, "Writing convergence report to `{}`.", report_path.native());
+    JsonValidation::write_json_file(
+        report_path, context.convergence_report->to_json());
+  }
+
+  if (Tracer::enabled()) {
+    auto trace_path = options.trace_output_path();
+    LOG(1, "Writing phase trace to `{}`.", trace_path.native());
+    JsonValidation::write_json_file(trace_path, Tracer::to_json());
+  }
 }
 
 } // namespace marianatrench
@@ -7,6 +7,8 @@
 
 #pragma once
 
+#include <memory>
+
 #include <boost/program_options.hpp>
 
 #include <gtest/gtest_prod.h>
@@ -18,6 +20,10 @@
 
 namespace marianatrench {
 
+namespace benchmarks {
+class ScalingBenchmark;
+} // namespace benchmarks
+
 class MarianaTrench : public Tool {
  public:
   MarianaTrench();
@@ -27,8 +33,33 @@ class MarianaTrench : public Tool {
   void run(const boost::program_options::variables_map& variables) override;
 
  private:
+  /**
+   * Load, analyze and write the outputs of the application of the given
+   * options. Return the options, to analyze the next application of a batch.
+   */
+  std::unique_ptr<Options> run_application(
+      std::unique_ptr<Options> application_options);
+
   FRIEND_TEST(IntegrationTest, CompareFlows);
+  friend class benchmarks::ScalingBenchmark;
   Registry analyze(Context& context);
+
+  /**
+   * Build everything that only depends on the application: methods, types,
+   * class hierarchies, overrides and the call graph.
+   */
+  void build_program(Context& context);
+
+  /**
+   * Generate models, load rules and models and run the global fixpoint on a
+   * program built by `build_program`. This can be called multiple times.
+   */
+  Registry analyze_program(Context& context);
+
+  /* Answer analysis requests from the standard input (see `--server`). */
+  void serve(Context& context);
+
+  void write_outputs(Context& context, Registry& registry);
 };
 
 } // namespace marianatrench
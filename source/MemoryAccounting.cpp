@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <algorithm>
+#include <iterator>
+
+#include <fmt/format.h>
+
+#include <Show.h>
+
+#include <mariana-trench/MemoryAccounting.h>
+
+namespace marianatrench {
+
+void MemoryAccounting::add(const Model& model) {
+  auto generations = taint_tree_bytes(model.generations());
+  auto parameter_sources = taint_tree_bytes(model.parameter_sources());
+  auto sinks = taint_tree_bytes(model.sinks());
+  auto propagations = propagation_tree_bytes(model.propagations());
+  auto issues = issues_bytes(model.issues());
+
+  generations_ += generations;
+  parameter_sources_ += parameter_sources;
+  sinks_ += sinks;
+  propagations_ += propagations;
+  issues_ += issues;
+
+  if (const auto* method = model.method()) {
+    methods_.emplace_back(
+        method,
+        sizeof(Model) + generations + parameter_sources + sinks +
+            propagations + issues);
+  }
+}
+
+std::size_t MemoryAccounting::total_bytes() const {
+  return generations_ + parameter_sources_ + sinks_ + propagations_ + issues_;
+}
+
+namespace {
+
+Json::Value bytes_to_json(std::size_t bytes) {
+  return Json::Value(static_cast<Json::UInt64>(bytes));
+}
+
+} // namespace
+
+Json::Value MemoryAccounting::to_json() const {
+  auto value = Json::Value(Json::objectValue);
+  value["generations"] = bytes_to_json(generations_);
+  value["parameter_sources"] = bytes_to_json(parameter_sources_);
+  value["sinks"] = bytes_to_json(sinks_);
+  value["propagations"] = bytes_to_json(propagations_);
+  value["issues"] = bytes_to_json(issues_);
+  value["total"] = bytes_to_json(total_bytes());
+
+  auto methods = methods_;
+  auto size = std::min(methods.size(), kRecordLargestMethods);
+  std::partial_sort(
+      methods.begin(),
+      methods.begin() + size,
+      methods.end(),
+      [](const auto& left, const auto& right) {
+        return left.second > right.second;
+      });
+  auto largest_methods = Json::Value(Json::arrayValue);
+  for (std::size_t i = 0; i < size; i++) {
+    auto method_value = Json::Value(Json::arrayValue);
+    method_value.append(Json::Value(show(methods[i].first)));
+    method_value.append(bytes_to_json(methods[i].second));
+    largest_methods.append(method_value);
+  }
+  value["largest_methods"] = largest_methods;
+
+  auto frames_per_frame_set = Json::Value(Json::objectValue);
+  for (std::size_t i = 0; i < frames_per_frame_set_.size(); i++) {
+    auto lower = std::size_t(1) << i;
+    auto upper = (std::size_t(1) << (i + 1)) - 1;
+    auto bucket = lower == upper ? std::to_string(lower)
+                                 : fmt::format("{}-{}", lower, upper);
+    frames_per_frame_set[bucket] = bytes_to_json(frames_per_frame_set_[i]);
+  }
+  value["frames_per_frame_set"] = frames_per_frame_set;
+
+  return value;
+}
+
+std::size_t MemoryAccounting::taint_bytes(const Taint& taint) {
+  std::size_t bytes = sizeof(Taint);
+  for (const auto& frame_set : taint) {
+    auto frames = static_cast<std::size_t>(
+        std::distance(frame_set.begin(), frame_set.end()));
+    bytes += sizeof(FrameSet) + frames * sizeof(Frame);
+
+    if (frames > 0) {
+      std::size_t bucket = 0;
+      while ((frames >> (bucket + 1)) > 0) {
+        bucket++;
+      }
+      if (frames_per_frame_set_.size() <= bucket) {
+        frames_per_frame_set_.resize(bucket + 1, 0);
+      }
+      frames_per_frame_set_[bucket]++;
+    }
+  }
+  return bytes;
+}
+
+std::size_t MemoryAccounting::taint_tree_bytes(
+    const TaintAccessPathTree& tree) {
+  std::size_t bytes = 0;
+  tree.visit([&](const AccessPath& /* access_path */, const Taint& taint) {
+    bytes += sizeof(TaintTree) + taint_bytes(taint);
+  });
+  return bytes;
+}
+
+std::size_t MemoryAccounting::propagation_tree_bytes(
+    const PropagationAccessPathTree& tree) {
+  std::size_t bytes = 0;
+  tree.visit([&](const AccessPath& /* access_path */,
+                 const PropagationSet& propagations) {
+    bytes +=
+        sizeof(PropagationTree) + propagations.size() * sizeof(Propagation);
+  });
+  return bytes;
+}
+
+std::size_t MemoryAccounting::issues_bytes(const IssueSet& issues) {
+  std::size_t bytes = 0;
+  for (const auto& issue : issues) {
+    if (issue.is_compact()) {
+      bytes += sizeof(Issue) + issue.frames_size() * sizeof(Frame);
+    } else {
+      bytes += sizeof(Issue) + taint_bytes(issue.sources()) +
+          taint_bytes(issue.sinks());
+    }
+  }
+  return bytes;
+}
+
+} // namespace marianatrench
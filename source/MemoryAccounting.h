@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <utility>
+#include <vector>
+
+#include <json/json.h>
+
+#include <mariana-trench/Method.h>
+#include <mariana-trench/Model.h>
+
+namespace marianatrench {
+
+/**
+ * Approximate memory used by models, to find the models blowing up memory.
+ *
+ * Sizes are estimated from the number of elements of each abstract domain
+ * and the size of their C++ representation. They ignore sharing between
+ * patricia trees, the content of small sets within frames (origins,
+ * features, positions) and allocator overhead.
+ */
+class MemoryAccounting final {
+ public:
+  MemoryAccounting() = default;
+  MemoryAccounting(const MemoryAccounting&) = delete;
+  MemoryAccounting(MemoryAccounting&&) = default;
+  MemoryAccounting& operator=(const MemoryAccounting&) = delete;
+  MemoryAccounting& operator=(MemoryAccounting&&) = default;
+  ~MemoryAccounting() = default;
+
+  /* Account for the given model. This is not thread-safe. */
+  void add(const Model& model);
+
+  /* Approximate number of bytes held by all models. */
+  std::size_t total_bytes() const;
+
+  /* Approximate number of bytes held by the model of each method. */
+  const std::vector<std::pair<const Method*, std::size_t>>& method_bytes()
+      const {
+    return methods_;
+  }
+
+  Json::Value to_json() const;
+
+  /* Maximum number of largest methods to report. */
+  constexpr static std::size_t kRecordLargestMethods = 20;
+
+ private:
+  std::size_t taint_bytes(const Taint& taint);
+  std::size_t taint_tree_bytes(const TaintAccessPathTree& tree);
+  std::size_t propagation_tree_bytes(const PropagationAccessPathTree& tree);
+  std::size_t issues_bytes(const IssueSet& issues);
+
+ private:
+  std::size_t generations_ = 0;
+  std::size_t parameter_sources_ = 0;
+  std::size_t sinks_ = 0;
+  std::size_t propagations_ = 0;
+  std::size_t issues_ = 0;
+
+  std::vector<std::pair<const Method*, std::size_t>> methods_;
+
+  // Number of frame sets with `[2^i, 2^(i+1))` frames, at index `i`.
+  std::vector<std::size_t> frames_per_frame_set_;
+};
+
+} // namespace marianatrench
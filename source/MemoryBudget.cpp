@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <algorithm>
+
+#include <mariana-trench/Heuristics.h>
+#include <mariana-trench/Log.h>
+#include <mariana-trench/MemoryBudget.h>
+
+namespace marianatrench {
+
+MemoryBudget::MemoryBudget(double limit_in_gb)
+    : limit_in_gb_(limit_in_gb), level_(0), degraded_models_(0) {}
+
+void MemoryBudget::update(double resident_set_size_in_gb) {
+  if (resident_set_size_in_gb < limit_in_gb_ * kPressureThreshold) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto level = level_.load();
+  if (level >= kMaxLevel) {
+    return;
+  }
+
+  // Raise the level by one step at a time, and only if memory usage kept
+  // growing since the last step.
+  if (!degradations_.empty() &&
+      resident_set_size_in_gb <= degradations_.back().second) {
+    return;
+  }
+  level_.store(level + 1);
+  degradations_.emplace_back(level + 1, resident_set_size_in_gb);
+  WARNING(
+      1,
+      "Memory usage ({:.2f}GB) is close to the budget ({:.2f}GB), approximating models with at most {} leaves.",
+      resident_set_size_in_gb,
+      limit_in_gb_,
+      model_tree_max_leaves(Heuristics::kModelTreeMaxLeaves));
+}
+
+void MemoryBudget::approximate(
+    Model& model,
+    std::size_t model_tree_max_leaves) const {
+  if (level() == 0) {
+    model.approximate(model_tree_max_leaves);
+    return;
+  }
+
+  model.approximate(this->model_tree_max_leaves(model_tree_max_leaves));
+  degraded_models_.fetch_add(1, std::memory_order_relaxed);
+}
+
+std::size_t MemoryBudget::model_tree_max_leaves(
+    std::size_t default_model_tree_max_leaves) const {
+  return std::max<std::size_t>(1, default_model_tree_max_leaves >> level());
+}
+
+Json::Value MemoryBudget::to_json() const {
+  auto value = Json::Value(Json::objectValue);
+  value["limit"] = Json::Value(limit_in_gb_);
+  value["level"] = Json::Value(static_cast<Json::UInt64>(level()));
+  value["degraded_models"] =
+      Json::Value(static_cast<Json::UInt64>(degraded_models_.load()));
+
+  auto degradations = Json::Value(Json::arrayValue);
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (const auto& [level, resident_set_size] : degradations_) {
+    auto degradation = Json::Value(Json::objectValue);
+    degradation["level"] = Json::Value(static_cast<Json::UInt64>(level));
+    degradation["rss"] = Json::Value(resident_set_size);
+    degradations.append(degradation);
+  }
+  value["degradations"] = degradations;
+  return value;
+}
+
+} // namespace marianatrench
@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include <json/json.h>
+
+#include <mariana-trench/Model.h>
+
+namespace marianatrench {
+
+/**
+ * A memory budget for the global fixpoint.
+ *
+ * The fixpoint periodically reports the resident set size (see `update`).
+ * When it gets close to the limit, the budget raises its degradation level,
+ * which tightens the approximation of models computed afterwards. This trades
+ * precision for memory instead of getting killed by the operating system.
+ *
+ * Lower limits only affect trees with many leaves, i.e the largest models.
+ */
+class MemoryBudget final {
+ public:
+  explicit MemoryBudget(double limit_in_gb);
+
+  MemoryBudget(const MemoryBudget&) = delete;
+  MemoryBudget(MemoryBudget&&) = delete;
+  MemoryBudget& operator=(const MemoryBudget&) = delete;
+  MemoryBudget& operator=(MemoryBudget&&) = delete;
+  ~MemoryBudget() = default;
+
+  /**
+   * Update the degradation level given the current memory usage, in GB.
+   * This is thread-safe.
+   */
+  void update(double resident_set_size_in_gb);
+
+  /**
+   * Approximate the model with the limits of the current level, starting from
+   * the given maximum number of leaves.
+   */
+  void approximate(Model& model, std::size_t model_tree_max_leaves) const;
+
+  std::size_t level() const {
+    return level_.load(std::memory_order_relaxed);
+  }
+
+  /* Maximum number of leaves in a model tree at the current level. */
+  std::size_t model_tree_max_leaves(
+      std::size_t default_model_tree_max_leaves) const;
+
+  Json::Value to_json() const;
+
+  /* Fraction of the limit above which we raise the degradation level. */
+  constexpr static double kPressureThreshold = 0.8;
+
+  /* Each level halves the maximum number of leaves in model trees. */
+  constexpr static std::size_t kMaxLevel = 4;
+
+ private:
+  double limit_in_gb_;
+  std::atomic<std::size_t> level_;
+  mutable std::atomic<std::size_t> degraded_models_;
+
+  // Resident set size at which each level was reached.
+  mutable std::mutex mutex_;
+  std::vector<std::pair<std::size_t, double>> degradations_;
+};
+
+} // namespace marianatrench
@@ -19,7 +19,7 @@ FieldMemoryLocation* MemoryLocation::make_field(const DexString* field) {
 
   auto found = fields_.find(field);
   if (found != fields_.end()) {
-    return found->second.get();
+    return found->second;
   }
 
   // To avoid non-convergence, we need to break infinite chains.
@@ -36,10 +36,18 @@ FieldMemoryLocation* MemoryLocation::make_field(const DexString* field) {
     }
   }
 
-  auto result = fields_.emplace(
-      field, std::make_unique<FieldMemoryLocation>(this, field));
+  FieldMemoryLocation* field_memory_location = nullptr;
+  if (arena_ != nullptr) {
+    field_memory_location = arena_->create<FieldMemoryLocation>(this, field);
+    field_memory_location->arena_ = arena_;
+  } else {
+    owned_fields_.push_back(std::make_unique<FieldMemoryLocation>(this, field));
+    field_memory_location = owned_fields_.back().get();
+  }
+
+  auto result = fields_.emplace(field, field_memory_location);
   mt_assert(result.second);
-  return result.first->second.get();
+  return field_memory_location;
 }
 
 MemoryLocation* MemoryLocation::root() {
@@ -118,25 +126,36 @@ std::string InstructionMemoryLocation::str() const {
   return fmt::format("InstructionMemoryLocation(`{}`)", show(instruction_));
 }
 
-std::optional<std::string> InstructionMemoryLocation::get_constant() const {
+const DexString* MT_NULLABLE InstructionMemoryLocation::get_constant() const {
   if (instruction_->has_literal()) {
-    return std::to_string(instruction_->get_literal());
+    return DexString::make_string(std::to_string(instruction_->get_literal()));
   } else if (instruction_->has_string()) {
-    return instruction_->get_string()->str();
+    return instruction_->get_string();
   }
 
-  return std::nullopt;
+  return nullptr;
 }
 
 MemoryFactory::MemoryFactory(const Method* method) {
+  reset(method);
+}
+
+MemoryFactory::MemoryFactory() = default;
+
+void MemoryFactory::reset(const Method* method) {
   mt_assert(method != nullptr);
 
+  // Locations point into the arena, forget them before releasing it.
+  parameters_.clear();
+  instructions_.clear();
+  arena_.reset();
+
   // Create parameter locations
   for (ParameterPosition i = 0; i < method->number_of_parameters(); i++) {
     if (i == 0 && !method->is_static()) {
-      parameters_.push_back(std::make_unique<ThisParameterMemoryLocation>());
+      parameters_.push_back(create<ThisParameterMemoryLocation>());
     } else {
-      parameters_.push_back(std::make_unique<ParameterMemoryLocation>(i));
+      parameters_.push_back(create<ParameterMemoryLocation>(i));
     }
   }
 }
@@ -149,7 +168,7 @@ ParameterMemoryLocation* MemoryFactory::make_parameter(
         "Accessing out of bounds parameter in memory factory.");
   }
 
-  return parameters_[parameter_position].get();
+  return parameters_[parameter_position];
 }
 
 InstructionMemoryLocation* MemoryFactory::make_location(
@@ -158,13 +177,13 @@ InstructionMemoryLocation* MemoryFactory::make_location(
 
   auto found = instructions_.find(instruction);
   if (found != instructions_.end()) {
-    return found->second.get();
+    return found->second;
   }
 
-  auto result = instructions_.emplace(
-      instruction, std::make_unique<InstructionMemoryLocation>(instruction));
+  auto* memory_location = create<InstructionMemoryLocation>(instruction);
+  auto result = instructions_.emplace(instruction, memory_location);
   mt_assert(result.second);
-  return result.first->second.get();
+  return memory_location;
 }
 
 } // namespace marianatrench
@@ -13,10 +13,12 @@
 #include <string>
 #include <type_traits>
 #include <unordered_map>
+#include <vector>
 
 #include <DexClass.h>
 
 #include <mariana-trench/Access.h>
+#include <mariana-trench/Arena.h>
 #include <mariana-trench/Compiler.h>
 #include <mariana-trench/Method.h>
 
@@ -26,7 +28,7 @@ class FieldMemoryLocation;
 
 class MemoryLocation {
  protected:
-  MemoryLocation() = default;
+  MemoryLocation() : arena_(nullptr) {}
 
  public:
   MemoryLocation(const MemoryLocation&) = delete;
@@ -49,7 +51,12 @@ class MemoryLocation {
     return dynamic_cast<T*>(this);
   }
 
-  /* Return the memory location for the given field of this memory location. */
+  /**
+   * Return the memory location for the given field of this memory location.
+   *
+   * Fields of memory locations created by a `MemoryFactory` are allocated in
+   * the arena of the factory. Other memory locations own their fields.
+   */
   FieldMemoryLocation* make_field(const DexString* field);
 
   /**
@@ -80,8 +87,11 @@ class MemoryLocation {
       const MemoryLocation& memory_location);
 
  private:
-  std::unordered_map<const DexString*, std::unique_ptr<FieldMemoryLocation>>
-      fields_;
+  friend class MemoryFactory;
+
+  Arena* MT_NULLABLE arena_;
+  std::unordered_map<const DexString*, FieldMemoryLocation*> fields_;
+  std::vector<std::unique_ptr<FieldMemoryLocation>> owned_fields_;
 };
 
 class ParameterMemoryLocation : public MemoryLocation {
@@ -143,7 +153,8 @@ class InstructionMemoryLocation final : public MemoryLocation {
     return instruction_;
   }
 
-  std::optional<std::string> get_constant() const;
+  /* Return the interned literal or string of the instruction, if any. */
+  const DexString* MT_NULLABLE get_constant() const;
 
  private:
   const IRInstruction* instruction_;
@@ -152,12 +163,18 @@ class InstructionMemoryLocation final : public MemoryLocation {
 /**
  * A memory factory to create unique memory location pointers.
  *
+ * All memory locations, including fields, are allocated in an arena and
+ * released at once when the factory is destroyed or reset.
+ *
  * Note that this is NOT thread-safe.
  */
 class MemoryFactory final {
  public:
   explicit MemoryFactory(const Method* method);
 
+  /* Create a factory with no method, to be `reset` before use. */
+  MemoryFactory();
+
   MemoryFactory(const MemoryFactory&) = delete;
   MemoryFactory(MemoryFactory&&) = delete;
   MemoryFactory& operator=(const MemoryFactory&) = delete;
@@ -168,11 +185,26 @@ class MemoryFactory final {
 
   InstructionMemoryLocation* make_location(const IRInstruction* instruction);
 
+  /**
+   * Release all memory locations and create the parameters of the given
+   * method. The arena blocks and the table of instructions are kept, to
+   * reuse the factory across methods without calling the allocator.
+   */
+  void reset(const Method* method);
+
+ private:
+  template <typename T, typename... Args>
+  T* create(Args&&... args) {
+    auto* memory_location = arena_.create<T>(std::forward<Args>(args)...);
+    memory_location->arena_ = &arena_;
+    return memory_location;
+  }
+
  private:
-  std::vector<std::unique_ptr<ParameterMemoryLocation>> parameters_;
-  std::unordered_map<
-      const IRInstruction*,
-      std::unique_ptr<InstructionMemoryLocation>>
+  // Declared first, to be destroyed last.
+  Arena arena_;
+  std::vector<ParameterMemoryLocation*> parameters_;
+  std::unordered_map<const IRInstruction*, InstructionMemoryLocation*>
       instructions_;
 };
 
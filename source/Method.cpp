@@ -23,7 +23,9 @@ Method::Method(
     : method_(method),
       parameter_type_overrides_(std::move(parameter_type_overrides)),
       signature_(::show(method)),
-      show_cached_(::show(this)) {
+      show_cached_(::show(this)),
+      id_(0),
+      logged_(false) {
   mt_assert(method != nullptr);
 }
 
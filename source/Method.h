@@ -51,6 +51,16 @@ class Method final {
     return parameter_type_overrides_;
   }
 
+  /**
+   * Return the dense identifier of the method, in `[0, methods.size())`.
+   *
+   * This is only meaningful for methods created by the `Methods` factory. It
+   * can be used to index arrays and bitsets instead of hashing the method.
+   */
+  std::size_t id() const {
+    return id_;
+  }
+
   const IRCode* MT_NULLABLE get_code() const;
   DexType* get_class() const;
   DexProto* get_proto() const;
@@ -68,6 +78,15 @@ class Method final {
   const std::string& signature() const;
   const std::string& show() const;
 
+  /**
+   * Return true if the analysis of the method is logged (see
+   * `--log-method`). This is computed once by `Methods` when the method is
+   * created.
+   */
+  bool logged() const {
+    return logged_;
+  }
+
   /**
    * Return the number of parameters, including the implicit `this` parameter.
    */
@@ -92,6 +111,7 @@ class Method final {
   Json::Value to_json() const;
 
  private:
+  friend class Methods;
   friend struct std::hash<Method>;
   friend std::ostream& operator<<(std::ostream& out, const Method& method);
 
@@ -99,6 +119,8 @@ class Method final {
   ParameterTypeOverrides parameter_type_overrides_;
   std::string signature_;
   std::string show_cached_;
+  std::size_t id_;
+  bool logged_;
 };
 
 } // namespace marianatrench
@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <mariana-trench/Assert.h>
+#include <mariana-trench/MethodBitset.h>
+
+namespace marianatrench {
+
+MethodBitset::MethodBitset(const Methods& methods)
+    : methods_(methods),
+      words_((methods.size() + kBitsPerWord - 1) / kBitsPerWord),
+      size_(0) {}
+
+bool MethodBitset::insert(const Method* method) {
+  auto id = method->id();
+  mt_assert(id < words_.size() * kBitsPerWord);
+  auto mask = std::uint64_t(1) << (id % kBitsPerWord);
+  auto previous = words_[id / kBitsPerWord].fetch_or(mask);
+  if ((previous & mask) != 0) {
+    return false;
+  }
+  size_.fetch_add(1, std::memory_order_relaxed);
+  return true;
+}
+
+bool MethodBitset::contains(const Method* method) const {
+  auto id = method->id();
+  if (id >= words_.size() * kBitsPerWord) {
+    return false;
+  }
+  auto mask = std::uint64_t(1) << (id % kBitsPerWord);
+  return (words_[id / kBitsPerWord].load(std::memory_order_relaxed) & mask) !=
+      0;
+}
+
+void MethodBitset::clear() {
+  if (size_.load(std::memory_order_relaxed) == 0) {
+    return;
+  }
+  for (auto& word : words_) {
+    word.store(0, std::memory_order_relaxed);
+  }
+  size_.store(0, std::memory_order_relaxed);
+}
+
+void MethodBitset::swap(MethodBitset& other) {
+  mt_assert(&methods_ == &other.methods_);
+  words_.swap(other.words_);
+  size_.store(other.size_.exchange(size_.load()));
+}
+
+} // namespace marianatrench
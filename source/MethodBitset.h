@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include <mariana-trench/Method.h>
+#include <mariana-trench/Methods.h>
+
+namespace marianatrench {
+
+/**
+ * A concurrent set of methods, represented as an atomic bitset indexed by the
+ * method identifiers (see `Method::id`).
+ *
+ * The bitset is sized on construction, hence it can only contain methods that
+ * existed at that time. Inserting is thread-safe and lock-free.
+ */
+class MethodBitset final {
+ public:
+  explicit MethodBitset(const Methods& methods);
+
+  MethodBitset(const MethodBitset&) = delete;
+  MethodBitset(MethodBitset&&) = delete;
+  MethodBitset& operator=(const MethodBitset&) = delete;
+  MethodBitset& operator=(MethodBitset&&) = delete;
+  ~MethodBitset() = default;
+
+  /* Returns true if the method was not in the set already. */
+  bool insert(const Method* method);
+
+  bool contains(const Method* method) const;
+
+  std::size_t size() const {
+    return size_.load(std::memory_order_relaxed);
+  }
+
+  bool empty() const {
+    return size() == 0;
+  }
+
+  /* Remove all methods. Calling this while calling `insert` is unsafe. */
+  void clear();
+
+  /**
+   * Exchange the content of both sets, which must be built from the same
+   * `Methods`. Calling this while calling `insert` is unsafe.
+   */
+  void swap(MethodBitset& other);
+
+  /**
+   * Call `visitor` on all methods of the set, in the order of their
+   * identifiers. Calling this while calling `insert` concurrently is unsafe.
+   */
+  template <typename Visitor> // void(const Method*)
+  void visit(Visitor&& visitor) const {
+    for (std::size_t word = 0; word < words_.size(); word++) {
+      auto bits = words_[word].load(std::memory_order_relaxed);
+      while (bits != 0) {
+        auto bit = static_cast<std::size_t>(__builtin_ctzll(bits));
+        visitor(methods_.get(word * kBitsPerWord + bit));
+        bits &= bits - 1;
+      }
+    }
+  }
+
+ private:
+  static constexpr std::size_t kBitsPerWord = 64;
+
+  const Methods& methods_;
+  std::vector<std::atomic<std::uint64_t>> words_;
+  std::atomic<std::size_t> size_;
+};
+
+} // namespace marianatrench
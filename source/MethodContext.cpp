@@ -7,18 +7,53 @@
 
 #include <mariana-trench/MethodContext.h>
 
+#include <fmt/format.h>
+
 #include <Show.h>
 
+#include <mariana-trench/CallsiteModelCache.h>
 #include <mariana-trench/Log.h>
 #include <mariana-trench/Overrides.h>
 
 namespace marianatrench {
 
+MethodAnalysisTimeout::MethodAnalysisTimeout(const Method* method)
+    : std::runtime_error(fmt::format(
+          "Analysis of `{}` exceeded the maximum method analysis time",
+          method->show())) {}
+
 MethodContext::MethodContext(
     Context& context,
     const Registry& registry,
     Model& model)
-    : options(*context.options),
+    : MethodContext(
+          context,
+          registry,
+          model,
+          std::make_unique<Scratch>(),
+          /* scratch */ nullptr) {}
+
+MethodContext::MethodContext(
+    Context& context,
+    const Registry& registry,
+    Model& model,
+    Scratch& scratch)
+    : MethodContext(
+          context,
+          registry,
+          model,
+          /* owned_scratch */ nullptr,
+          &scratch) {}
+
+MethodContext::MethodContext(
+    Context& context,
+    const Registry& registry,
+    Model& model,
+    std::unique_ptr<Scratch> owned_scratch,
+    Scratch* MT_NULLABLE scratch)
+    : owned_scratch_(std::move(owned_scratch)),
+      scratch_(scratch != nullptr ? *scratch : *owned_scratch_),
+      options(*context.options),
       artificial_methods(*context.artificial_methods),
       methods(*context.methods),
       fields(*context.fields),
@@ -33,25 +68,40 @@ MethodContext::MethodContext(
       kinds(*context.kinds),
       features(*context.features),
       registry(registry),
-      memory_factory(model.method()),
+      memory_factory(scratch_.memory_factory_),
       model(model),
-      context_(context) {
-  std::string method_name = show(model.method());
-  const auto& log_methods = options.log_methods();
-  dump_ = std::any_of(
-      log_methods.begin(), log_methods.end(), [&](const auto& pattern) {
-        return method_name.find(pattern) != std::string::npos;
-      });
+      instructions(model.method(), call_graph, types),
+      context_(context),
+      maximum_analysis_time_(options.maximum_method_analysis_time()),
+      callsite_model_cache_(scratch_.callsite_model_cache_),
+      callee_models_(scratch_.callee_models_),
+      instantiations_(scratch_.instantiations_) {
+  memory_factory.reset(model.method());
+  scratch_.clear();
+  dump_ = model.method()->logged();
+  if (context.profiler != nullptr) {
+    profile_ = std::make_unique<MethodProfile>();
+  }
+}
+
+MethodContext::~MethodContext() {
+  // Callee models must not outlive the analysis in a scratch of a worker.
+  scratch_.clear();
+}
+
+void MethodContext::Scratch::clear() {
+  callsite_model_cache_.clear();
+  callee_models_.clear();
+  instantiations_.clear();
 }
 
 Model MethodContext::model_at_callsite(
     const CallTarget& call_target,
     const Position* position,
     const std::vector<const DexType * MT_NULLABLE>& source_register_types,
-    const std::vector<std::optional<std::string>>& source_constant_arguments)
+    const std::vector<const DexString * MT_NULLABLE>& source_constant_arguments)
     const {
-  auto* caller = method();
-
+  ProfileScope profile_scope(profile(), "model_at_callsite");
   LOG_OR_DUMP(
       this,
       5,
@@ -67,25 +117,81 @@ Model MethodContext::model_at_callsite(
             Model::Mode::TaintInTaintOut);
   }
 
-  if (call_target.is_virtual()) {
-    auto cached = callsite_model_cache_.find(CacheKey{call_target, position});
-    if (cached != callsite_model_cache_.end()) {
-      return cached->second;
-    }
+  if (!call_target.is_virtual()) {
+    return callee_model_at_callsite(
+        call_target.resolved_base_callee(),
+        position,
+        source_register_types,
+        source_constant_arguments);
   }
 
-  auto model = registry.get(call_target.resolved_base_callee())
-                   .at_callsite(
-                       caller,
-                       position,
-                       context_,
-                       source_register_types,
-                       source_constant_arguments);
+  auto cached = callsite_model_cache_.find(CacheKey{call_target, position});
+  if (cached != callsite_model_cache_.end()) {
+    return cached->second;
+  }
 
-  if (!call_target.is_virtual()) {
+  if (context_.callsite_model_cache == nullptr) {
+    auto model = join_virtual_callee_models_at_callsite(
+        call_target,
+        position,
+        source_register_types,
+        source_constant_arguments);
+    if (!model.no_join_virtual_overrides()) {
+      callsite_model_cache_.emplace(CacheKey{call_target, position}, model);
+    }
     return model;
   }
 
+  // The joined model is shared by all callers, versioned by the snapshots of
+  // the models of the base callee and all its overrides.
+  std::vector<std::shared_ptr<const Model>> callee_models;
+  auto base_callee_model =
+      registry.get_snapshot(call_target.resolved_base_callee());
+  callee_models_.emplace(call_target.resolved_base_callee(), base_callee_model);
+  if (base_callee_model->no_join_virtual_overrides()) {
+    return join_virtual_callee_models_at_callsite(
+        call_target,
+        position,
+        source_register_types,
+        source_constant_arguments);
+  }
+  callee_models.push_back(std::move(base_callee_model));
+  for (const auto* override : call_target.overrides()) {
+    auto override_model = registry.get_snapshot(override);
+    callee_models_.emplace(override, override_model);
+    callee_models.push_back(std::move(override_model));
+  }
+
+  auto model = context_.callsite_model_cache->get_virtual(
+      callee_models,
+      call_target.receiver_type(),
+      method(),
+      position,
+      source_register_types,
+      source_constant_arguments,
+      [&]() {
+        return join_virtual_callee_models_at_callsite(
+            call_target,
+            position,
+            source_register_types,
+            source_constant_arguments);
+      });
+  callsite_model_cache_.emplace(CacheKey{call_target, position}, model);
+  return model;
+}
+
+Model MethodContext::join_virtual_callee_models_at_callsite(
+    const CallTarget& call_target,
+    const Position* position,
+    const std::vector<const DexType * MT_NULLABLE>& source_register_types,
+    const std::vector<const DexString * MT_NULLABLE>& source_constant_arguments)
+    const {
+  auto model = callee_model_at_callsite(
+      call_target.resolved_base_callee(),
+      position,
+      source_register_types,
+      source_constant_arguments);
+
   if (model.no_join_virtual_overrides()) {
     LOG_OR_DUMP(
         this,
@@ -103,12 +209,8 @@ Model MethodContext::model_at_callsite(
       model);
 
   for (const auto* override : call_target.overrides()) {
-    auto override_model = registry.get(override).at_callsite(
-        caller,
-        position,
-        context_,
-        source_register_types,
-        source_constant_arguments);
+    auto override_model = callee_model_at_callsite(
+        override, position, source_register_types, source_constant_arguments);
     LOG_OR_DUMP(
         this,
         5,
@@ -118,7 +220,55 @@ Model MethodContext::model_at_callsite(
     model.join_with(override_model);
   }
 
-  callsite_model_cache_.emplace(CacheKey{call_target, position}, model);
+  return model;
+}
+
+Model MethodContext::callee_model_at_callsite(
+    const Method* callee,
+    const Position* position,
+    const std::vector<const DexType * MT_NULLABLE>& source_register_types,
+    const std::vector<const DexString * MT_NULLABLE>& source_constant_arguments)
+    const {
+  auto callee_model = registry.get_snapshot(callee);
+  callee_models_.emplace(callee, callee_model);
+  auto at_callsite = [&]() {
+    return callee_model->at_callsite(
+        method(),
+        position,
+        context_,
+        source_register_types,
+        source_constant_arguments);
+  };
+
+  // Models that do not depend on the call site are cheaper to copy than to
+  // look up in the caches.
+  if (callee_model->shape() != Model::Shape::General) {
+    return at_callsite();
+  }
+
+  auto key = InstantiationKey{
+      callee, source_register_types, source_constant_arguments};
+  auto found = instantiations_.find(key);
+  if (found != instantiations_.end() &&
+      found->second.callee_model == callee_model) {
+    auto model = found->second.model;
+    if (found->second.position != position) {
+      model.set_call_position(position);
+    }
+    return model;
+  }
+
+  auto model = context_.callsite_model_cache == nullptr
+      ? at_callsite()
+      : context_.callsite_model_cache->get(
+            callee_model,
+            method(),
+            position,
+            source_register_types,
+            source_constant_arguments,
+            at_callsite);
+  instantiations_.insert_or_assign(
+      std::move(key), Instantiation{callee_model, position, model});
   return model;
 }
 
@@ -7,30 +7,63 @@
 
 #pragma once
 
+#include <memory>
+#include <optional>
+#include <stdexcept>
 #include <unordered_map>
+#include <vector>
 
 #include <mariana-trench/CallGraph.h>
 #include <mariana-trench/Compiler.h>
 #include <mariana-trench/Context.h>
+#include <mariana-trench/DecodedInstructions.h>
 #include <mariana-trench/MemoryLocation.h>
 #include <mariana-trench/Method.h>
 #include <mariana-trench/Model.h>
 #include <mariana-trench/Position.h>
+#include <mariana-trench/Profiler.h>
 #include <mariana-trench/Registry.h>
+#include <mariana-trench/Timer.h>
 
 namespace marianatrench {
 
+/**
+ * Thrown when the analysis of a method exceeds the maximum method analysis
+ * time (see `MethodContext::check_timeout`).
+ */
+class MethodAnalysisTimeout final : public std::runtime_error {
+ public:
+  explicit MethodAnalysisTimeout(const Method* method);
+};
+
 /**
  * Context for the analysis of a single method.
  */
 class MethodContext final {
+ public:
+  class Scratch;
+
+ private:
+  // Declared first, so that the public members below can refer to them.
+  std::unique_ptr<Scratch> owned_scratch_;
+  Scratch& scratch_;
+
  public:
   MethodContext(Context& context, const Registry& registry, Model& model);
+  /**
+   * Use the given scratch state, e.g the scratch of the current worker, which
+   * is cleared but not released when the analysis finishes.
+   */
+  MethodContext(
+      Context& context,
+      const Registry& registry,
+      Model& model,
+      Scratch& scratch);
   MethodContext(const MethodContext&) = delete;
   MethodContext(MethodContext&&) = delete;
   MethodContext& operator=(const MethodContext&) = delete;
   MethodContext& operator=(MethodContext&&) = delete;
-  ~MethodContext() = default;
+  ~MethodContext();
 
   const Method* method() const {
     return model.method();
@@ -40,11 +73,43 @@ class MethodContext final {
     return dump_;
   }
 
+  /* Return the profile of this analysis, or `nullptr` if not profiling. */
+  MethodProfile* MT_NULLABLE profile() const {
+    return profile_.get();
+  }
+
+  /* Return the costs of kinds, or `nullptr` if not recorded. */
+  KindCosts* MT_NULLABLE kind_costs() const {
+    return context_.kind_costs.get();
+  }
+
+  /**
+   * Throw `MethodAnalysisTimeout` if the analysis of this method has been
+   * running for longer than `--maximum-method-analysis-time`. This is called
+   * for each basic block and each call, so that slow methods are interrupted
+   * instead of finishing their analysis first.
+   */
+  void check_timeout() const {
+    if (maximum_analysis_time_ &&
+        timer_.duration_in_seconds() >= *maximum_analysis_time_) {
+      throw MethodAnalysisTimeout(method());
+    }
+  }
+
+  /* Snapshots of the callee models read during the analysis. */
+  using CalleeModels =
+      std::unordered_map<const Method*, std::shared_ptr<const Model>>;
+
+  const CalleeModels& callee_models() const {
+    return callee_models_;
+  }
+
   Model model_at_callsite(
       const CallTarget& call_target,
       const Position* position,
       const std::vector<const DexType * MT_NULLABLE>& source_register_types,
-      const std::vector<std::optional<std::string>>& source_constant_arguments)
+      const std::vector<const DexString * MT_NULLABLE>&
+          source_constant_arguments)
       const;
 
   const Options& options;
@@ -62,8 +127,34 @@ class MethodContext final {
   const Kinds& kinds;
   const Features& features;
   const Registry& registry;
-  MemoryFactory memory_factory;
+  MemoryFactory& memory_factory;
   Model& model;
+  // Decoded once per analysis, see `DecodedInstructions`.
+  const DecodedInstructions instructions;
+
+ private:
+  MethodContext(
+      Context& context,
+      const Registry& registry,
+      Model& model,
+      std::unique_ptr<Scratch> owned_scratch,
+      Scratch* MT_NULLABLE scratch);
+
+  /* Join the models of the base callee and its overrides at the call site. */
+  Model join_virtual_callee_models_at_callsite(
+      const CallTarget& call_target,
+      const Position* position,
+      const std::vector<const DexType * MT_NULLABLE>& source_register_types,
+      const std::vector<const DexString * MT_NULLABLE>&
+          source_constant_arguments) const;
+
+  Model callee_model_at_callsite(
+      const Method* callee,
+      const Position* position,
+      const std::vector<const DexType * MT_NULLABLE>& source_register_types,
+      const std::vector<const DexString * MT_NULLABLE>&
+          source_constant_arguments)
+      const;
 
  private:
   struct CacheKey {
@@ -84,11 +175,90 @@ class MethodContext final {
     }
   };
 
+  /**
+   * Callee models are instantiated once per callee and arguments, then moved
+   * to other positions of the same call (see `Model::set_call_position`),
+   * which is cheaper than propagating the taint again.
+   */
+  struct InstantiationKey {
+    const Method* callee;
+    std::vector<const DexType * MT_NULLABLE> source_register_types;
+    std::vector<const DexString * MT_NULLABLE> source_constant_arguments;
+
+    bool operator==(const InstantiationKey& other) const {
+      return callee == other.callee &&
+          source_register_types == other.source_register_types &&
+          source_constant_arguments == other.source_constant_arguments;
+    }
+  };
+
+  struct InstantiationKeyHash {
+    std::size_t operator()(const InstantiationKey& key) const {
+      std::size_t seed = 0;
+      boost::hash_combine(seed, key.callee);
+      boost::hash_range(
+          seed,
+          key.source_register_types.begin(),
+          key.source_register_types.end());
+      boost::hash_range(
+          seed,
+          key.source_constant_arguments.begin(),
+          key.source_constant_arguments.end());
+      return seed;
+    }
+  };
+
+  struct Instantiation {
+    // The snapshot the model was instantiated from, to detect updates.
+    std::shared_ptr<const Model> callee_model;
+    const Position* position;
+    Model model;
+  };
+
+  using CallsiteModelCache = std::unordered_map<CacheKey, Model, CacheKeyHash>;
+  using Instantiations =
+      std::unordered_map<InstantiationKey, Instantiation, InstantiationKeyHash>;
+
+ public:
+  /**
+   * State of the analysis of a method that is reused by the next analyses of
+   * the same worker: memory locations are allocated in the blocks of the
+   * previous method, and caches keep the capacity of their hash tables.
+   *
+   * A scratch is used by a single `MethodContext` at a time.
+   */
+  class Scratch final {
+   public:
+    Scratch() = default;
+    Scratch(const Scratch&) = delete;
+    Scratch(Scratch&&) = delete;
+    Scratch& operator=(const Scratch&) = delete;
+    Scratch& operator=(Scratch&&) = delete;
+    ~Scratch() = default;
+
+   private:
+    friend class MethodContext;
+
+    /* Release the models held by the caches, keeping their capacity. */
+    void clear();
+
+   private:
+    MemoryFactory memory_factory_;
+    CallsiteModelCache callsite_model_cache_;
+    CalleeModels callee_models_;
+    Instantiations instantiations_;
+  };
+
  private:
   Context& context_;
   bool dump_;
-  mutable std::unordered_map<CacheKey, Model, CacheKeyHash>
-      callsite_model_cache_;
+  Timer timer_;
+  std::optional<int> maximum_analysis_time_;
+  std::unique_ptr<MethodProfile> profile_;
+  // Owned by the scratch, hence these are mutable in const methods.
+  CallsiteModelCache& callsite_model_cache_;
+  CalleeModels& callee_models_;
+  Instantiations& instantiations_;
 };
 
 } // namespace marianatrench
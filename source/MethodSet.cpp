@@ -5,6 +5,9 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <algorithm>
+#include <vector>
+
 #include <Show.h>
 
 #include <mariana-trench/JsonValidation.h>
@@ -13,6 +16,9 @@
 
 namespace marianatrench {
 
+std::optional<std::size_t> MethodSet::maximum_size_ = std::nullopt;
+std::atomic<std::size_t> MethodSet::number_truncations_ = 0;
+
 MethodSet::MethodSet(std::initializer_list<const Method*> methods)
     : set_(methods) {}
 
@@ -49,13 +55,16 @@ bool MethodSet::equals(const MethodSet& other) const {
 
 void MethodSet::join_with(const MethodSet& other) {
   if (is_top_) {
+    truncated_size_ = std::max(truncated_size_, other.truncated_size_);
     return;
   }
   if (other.is_top_) {
     set_to_top();
+    truncated_size_ = other.truncated_size_;
     return;
   }
   set_.union_with(other.set_);
+  truncate_if_needed();
 }
 
 void MethodSet::widen_with(const MethodSet& other) {
@@ -88,12 +97,34 @@ void MethodSet::difference_with(const MethodSet& other) {
   set_.difference_with(other.set_);
 }
 
+void MethodSet::set_maximum_size(std::optional<std::size_t> maximum_size) {
+  maximum_size_ = maximum_size;
+}
+
+std::size_t MethodSet::number_truncations() {
+  return number_truncations_.load(std::memory_order_relaxed);
+}
+
+void MethodSet::truncate_if_needed() {
+  if (!maximum_size_) {
+    return;
+  }
+  auto size = set_.size();
+  if (size <= *maximum_size_) {
+    return;
+  }
+
+  truncated_size_ = size;
+  set_to_top();
+  number_truncations_.fetch_add(1, std::memory_order_relaxed);
+}
+
 MethodSet MethodSet::from_json(const Json::Value& value, Context& context) {
-  MethodSet methods;
+  std::vector<const Method*> methods;
   for (const auto& method_value : JsonValidation::null_or_array(value)) {
-    methods.add(Method::from_json(method_value, context));
+    methods.push_back(Method::from_json(method_value, context));
   }
-  return methods;
+  return MethodSet(Set(methods.begin(), methods.end()));
 }
 
 Json::Value MethodSet::to_json() const {
@@ -106,7 +137,11 @@ Json::Value MethodSet::to_json() const {
 
 std::ostream& operator<<(std::ostream& out, const MethodSet& methods) {
   if (methods.is_top_) {
-    return out << "T";
+    out << "T";
+    if (methods.truncated_size_ > 0) {
+      out << "(" << methods.truncated_size_ << " methods)";
+    }
+    return out;
   }
   out << "{";
   for (auto iterator = methods.begin(), end = methods.end(); iterator != end;) {
@@ -7,22 +7,38 @@
 
 #pragma once
 
+#include <atomic>
+#include <cstddef>
 #include <initializer_list>
+#include <optional>
 #include <ostream>
 
 #include <json/json.h>
 
 #include <AbstractDomain.h>
-#include <PatriciaTreeSet.h>
 
 #include <mariana-trench/Assert.h>
+#include <mariana-trench/IdSet.h>
 #include <mariana-trench/Method.h>
 
 namespace marianatrench {
 
+/**
+ * A set of methods, e.g origins of taint.
+ *
+ * Methods are stored by identifier (see `IdSet`), hence a set must only hold
+ * methods of a single `Methods` factory. Methods are iterated in the order of
+ * their identifiers.
+ */
 class MethodSet final : public sparta::AbstractDomain<MethodSet> {
  private:
-  using Set = sparta::PatriciaTreeSet<const Method*>;
+  struct MethodId {
+    std::size_t operator()(const Method* method) const {
+      return method->id();
+    }
+  };
+
+  using Set = IdSet<Method, MethodId>;
 
  public:
   // C++ container concept member types
@@ -59,6 +75,13 @@ class MethodSet final : public sparta::AbstractDomain<MethodSet> {
     return method_set;
   }
 
+  /* Create a summarized set that held the given number of methods. */
+  static MethodSet truncated(std::size_t size) {
+    auto method_set = MethodSet::top();
+    method_set.truncated_size_ = size;
+    return method_set;
+  }
+
   bool is_bottom() const override {
     return !is_top_ && set_.empty();
   }
@@ -69,6 +92,7 @@ class MethodSet final : public sparta::AbstractDomain<MethodSet> {
 
   void set_to_bottom() override {
     is_top_ = false;
+    truncated_size_ = 0;
     set_.clear();
   }
 
@@ -77,6 +101,15 @@ class MethodSet final : public sparta::AbstractDomain<MethodSet> {
     is_top_ = true;
   }
 
+  /**
+   * Number of methods the set held when it was summarized into top, or 0 if
+   * it was not summarized. This is only informative and is ignored by the
+   * lattice operations.
+   */
+  std::size_t truncated_size() const {
+    return truncated_size_;
+  }
+
   bool empty() const {
     return is_bottom();
   }
@@ -114,9 +147,27 @@ class MethodSet final : public sparta::AbstractDomain<MethodSet> {
 
   friend std::ostream& operator<<(std::ostream& out, const MethodSet& methods);
 
+  /**
+   * Bound the number of methods in a set. Past this limit, joins summarize the
+   * set into top and only remember its size (see `--maximum-origins`).
+   *
+   * This is a global setting that must not change during the analysis.
+   */
+  static void set_maximum_size(std::optional<std::size_t> maximum_size);
+
+  /* Number of sets summarized because of the maximum size. */
+  static std::size_t number_truncations();
+
+ private:
+  void truncate_if_needed();
+
  private:
   Set set_;
   bool is_top_ = false;
+  std::size_t truncated_size_ = 0;
+
+  static std::optional<std::size_t> maximum_size_;
+  static std::atomic<std::size_t> number_truncations_;
 };
 
 } // namespace marianatrench
@@ -5,11 +5,14 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <algorithm>
 #include <stdexcept>
+#include <vector>
 
 #include <fmt/format.h>
 #include <fmt/ostream.h>
 
+#include <SpartaWorkQueue.h>
 #include <Walkers.h>
 
 #include <mariana-trench/Assert.h>
@@ -20,20 +23,57 @@ namespace marianatrench {
 
 Methods::Methods() = default;
 
-Methods::Methods(const DexStoresVector& stores) {
-  // Create all methods with no type overrides.
+Methods::Methods(
+    const DexStoresVector& stores,
+    std::vector<std::string> log_methods)
+    : log_methods_(std::move(log_methods)) {
+  // Identifiers follow the dex order (by class, then method), hence
+  // iterating on methods is deterministic across runs.
+  std::vector<DexMethod*> dex_methods;
   for (auto& scope : DexStoreClassesIterator(stores)) {
-    walk::parallel::methods(scope, [&](DexMethod* method) {
-      set_.insert(Method(method, /* parameter_type_overrides */ {}));
-    });
+    walk::methods(
+        scope, [&](DexMethod* method) { dex_methods.push_back(method); });
   }
+
+  // Create all methods with no type overrides, in parallel.
+  methods_by_id_.resize(dex_methods.size(), nullptr);
+  auto queue = sparta::work_queue<std::size_t>(
+      [&](std::size_t id) {
+        auto new_method =
+            Method(dex_methods[id], /* parameter_type_overrides */ {});
+        new_method.id_ = id;
+        new_method.logged_ = is_logged(new_method);
+        auto [pointer, inserted] = set_.insert(std::move(new_method));
+        mt_assert(inserted);
+        methods_by_id_[id] = pointer;
+      },
+      sparta::parallel::default_num_threads());
+  for (std::size_t id = 0; id < dex_methods.size(); id++) {
+    queue.add_item(id);
+  }
+  queue.run_all();
 }
 
 const Method* Methods::create(
     const DexMethod* method,
     ParameterTypeOverrides parameter_type_overrides) {
   mt_assert(method != nullptr);
-  return set_.insert(Method(method, parameter_type_overrides)).first;
+  auto new_method = Method(method, std::move(parameter_type_overrides));
+  if (const auto* pointer = set_.get(new_method)) {
+    return pointer;
+  }
+
+  // Creating a method is rare after the initial construction. The lock
+  // guarantees that identifiers stay dense under concurrent creations.
+  std::lock_guard<std::mutex> lock(create_mutex_);
+  if (const auto* pointer = set_.get(new_method)) {
+    return pointer;
+  }
+  new_method.id_ = methods_by_id_.size();
+  new_method.logged_ = is_logged(new_method);
+  const auto* pointer = set_.insert(std::move(new_method)).first;
+  methods_by_id_.push_back(pointer);
+  return pointer;
 }
 
 const Method* Methods::get(
@@ -57,16 +97,28 @@ const Method* MT_NULLABLE Methods::get(const std::string& name) const {
   return set_.get(Method(method, /* parameter_type_overrides */ {}));
 }
 
+const Method* Methods::get(std::size_t id) const {
+  mt_assert(id < methods_by_id_.size());
+  return methods_by_id_[id];
+}
+
 Methods::Iterator Methods::begin() const {
-  return boost::make_transform_iterator(set_.cbegin(), GetPointer());
+  return methods_by_id_.cbegin();
 }
 
 Methods::Iterator Methods::end() const {
-  return boost::make_transform_iterator(set_.cend(), GetPointer());
+  return methods_by_id_.cend();
 }
 
 std::size_t Methods::size() const {
-  return set_.size();
+  return methods_by_id_.size();
+}
+
+bool Methods::is_logged(const Method& method) const {
+  return std::any_of(
+      log_methods_.begin(), log_methods_.end(), [&](const auto& pattern) {
+        return method.show().find(pattern) != std::string::npos;
+      });
 }
 
 } // namespace marianatrench
@@ -7,7 +7,10 @@
 
 #pragma once
 
-#include <boost/iterator/transform_iterator.hpp>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
 
 #include <ConcurrentContainers.h>
 #include <DexClass.h>
@@ -19,25 +22,29 @@ namespace marianatrench {
 
 /**
  * The method factory.
+ *
+ * Each method is assigned a dense identifier when it is created (see
+ * `Method::id`), including methods created after the initial construction.
+ * Methods are iterated in the order of their identifiers, which follows the
+ * dex order of the initial methods, hence it is deterministic.
  */
 class Methods final {
  private:
   using Set = InsertOnlyConcurrentSet<Method>;
 
-  struct GetPointer {
-    const Method* operator()(const Method& method) const {
-      return &method;
-    }
-  };
-
  public:
-  using Iterator =
-      boost::transform_iterator<GetPointer, typename Set::const_iterator>;
+  using Iterator = std::vector<const Method*>::const_iterator;
 
  public:
   Methods();
 
-  explicit Methods(const DexStoresVector& stores);
+  /**
+   * Create all methods of the given stores. Methods whose name contains one
+   * of `log_methods` are logged (see `Method::logged`).
+   */
+  explicit Methods(
+      const DexStoresVector& stores,
+      std::vector<std::string> log_methods = {});
 
   Methods(const Methods&) = delete;
   Methods(Methods&&) = delete;
@@ -66,6 +73,13 @@ class Methods final {
    */
   const Method* MT_NULLABLE get(const std::string& name) const;
 
+  /**
+   * Get the method with the given identifier.
+   *
+   * Calling this while calling `create` concurrently is unsafe.
+   */
+  const Method* get(std::size_t id) const;
+
   /**
    * Iterating on the container while calling `create` concurrently is unsafe.
    */
@@ -73,10 +87,17 @@ class Methods final {
 
   Iterator end() const;
 
+  /* Return the number of methods, i.e the exclusive upper bound of ids. */
   std::size_t size() const;
 
  private:
+  bool is_logged(const Method& method) const;
+
+ private:
+  std::vector<std::string> log_methods_;
   Set set_;
+  std::vector<const Method*> methods_by_id_;
+  std::mutex create_mutex_;
 };
 
 } // namespace marianatrench
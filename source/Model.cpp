@@ -5,12 +5,16 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <algorithm>
+#include <vector>
+
 #include <fmt/format.h>
 
 #include <Show.h>
 #include <TypeUtil.h>
 
 #include <mariana-trench/Assert.h>
+#include <mariana-trench/CallSiteContext.h>
 #include <mariana-trench/ClassHierarchies.h>
 #include <mariana-trench/ClassProperties.h>
 #include <mariana-trench/Compiler.h>
@@ -22,6 +26,7 @@
 #include <mariana-trench/Model.h>
 #include <mariana-trench/Overrides.h>
 #include <mariana-trench/Positions.h>
+#include <mariana-trench/RuntimeHeuristics.h>
 
 namespace marianatrench {
 
@@ -115,7 +120,8 @@ Model::Model(
 
     // Do not join models at call sites for methods with too many overrides.
     const auto& overrides = context.overrides->get(method_);
-    if (overrides.size() >= Heuristics::kJoinOverrideThreshold) {
+    if (overrides.size() >=
+        context.heuristics->get(method_).join_override_threshold) {
       modes_ |= Model::Mode::NoJoinVirtualOverrides;
     }
   }
@@ -259,12 +265,26 @@ Model Model::at_callsite(
     const Position* call_position,
     Context& context,
     const std::vector<const DexType * MT_NULLABLE>& source_register_types,
-    const std::vector<std::optional<std::string>>& source_constant_arguments)
+    const std::vector<const DexString * MT_NULLABLE>& source_constant_arguments)
     const {
   const auto* callee = method_;
 
   Model model;
   model.modes_ = modes_;
+  model.propagations_ = propagations_;
+  model.add_features_to_arguments_ = add_features_to_arguments_;
+
+  model.inline_as_ = inline_as_;
+  if (inline_as_.is_bottom()) {
+    // This is bottom when the method was never analyzed.
+    // Set it to top to be sound when joining models.
+    model.inline_as_.set_to_top();
+  }
+
+  if (shape() != Shape::General) {
+    // Nothing depends on the call site.
+    return model;
+  }
 
   auto maximum_source_sink_distance =
       context.options->maximum_source_sink_distance();
@@ -274,104 +294,81 @@ Model Model::at_callsite(
   auto extra_features = context.class_properties->propagate_features(
       caller, callee, *context.features);
 
+  const CallSiteContext call_site(
+      caller,
+      callee,
+      call_position,
+      maximum_source_sink_distance,
+      std::move(extra_features),
+      context,
+      source_register_types,
+      source_constant_arguments);
+
   generations_.visit(
-      [&model,
-       caller,
-       callee,
-       call_position,
-       maximum_source_sink_distance,
-       &extra_features,
-       &context,
-       &source_register_types,
-       &source_constant_arguments](
+      [&model, &call_site](
           const AccessPath& callee_port, const Taint& generations) {
         model.generations_.write(
             callee_port,
-            generations.propagate(
-                caller,
-                callee,
-                callee_port,
-                call_position,
-                maximum_source_sink_distance,
-                extra_features,
-                context,
-                source_register_types,
-                source_constant_arguments),
+            generations.propagate(callee_port, call_site),
             UpdateKind::Weak);
       });
 
-  sinks_.visit([&model,
-                caller,
-                callee,
-                call_position,
-                maximum_source_sink_distance,
-                &extra_features,
-                &context,
-                &source_register_types,
-                &source_constant_arguments](
-                   const AccessPath& callee_port, const Taint& sinks) {
-    model.sinks_.write(
-        callee_port,
-        sinks.propagate(
-            caller,
-            callee,
+  sinks_.visit(
+      [&model, &call_site](const AccessPath& callee_port, const Taint& sinks) {
+        model.sinks_.write(
             callee_port,
-            call_position,
-            maximum_source_sink_distance,
-            extra_features,
-            context,
-            source_register_types,
-            source_constant_arguments),
-        UpdateKind::Weak);
-  });
-
-  model.propagations_ = propagations_;
-  model.add_features_to_arguments_ = add_features_to_arguments_;
-
-  model.inline_as_ = inline_as_;
-  if (inline_as_.is_bottom()) {
-    // This is bottom when the method was never analyzed.
-    // Set it to top to be sound when joining models.
-    model.inline_as_.set_to_top();
-  }
+            sinks.propagate(callee_port, call_site),
+            UpdateKind::Weak);
+      });
 
   return model;
 }
 
+void Model::set_call_position(const Position* call_position) {
+  // Frames instantiated at a call site are never leaves.
+  auto update = [call_position](Taint& taint) {
+    taint.update_non_leaf_positions(
+        [call_position](const Method*, const AccessPath&, const Position*) {
+          return call_position;
+        },
+        [](const LocalPositionSet& local_positions) {
+          return local_positions;
+        });
+  };
+  generations_.map(update);
+  sinks_.map(update);
+}
+
 void Model::collapse_invalid_paths(Context& context) {
   if (!method_) {
     return;
   }
 
-  using FieldTypesAccumulator = std::unordered_set<const DexType*>;
+  // Sets of types are memoized by the field cache, hence the types of a
+  // path are only computed on its first visit across all models.
+  using FieldTypesAccumulator = const FieldCache::Types*;
+  static const FieldCache::Types no_types;
 
   auto is_valid = [this, &context](
-                      const FieldTypesAccumulator& previous_field_types,
+                      FieldTypesAccumulator previous_field_types,
                       Path::Element field) {
-    FieldTypesAccumulator current_field_types;
-    for (const auto* previous_field_type : previous_field_types) {
-      if (previous_field_type == type::java_lang_Object()) {
-        // Object is too generic to determine the set of possible field names.
-        continue;
-      }
-
-      const auto& cached_types =
-          context.field_cache->field_types(previous_field_type, field);
-      current_field_types.insert(cached_types.begin(), cached_types.end());
-    }
+    // Object is too generic to determine the set of possible field names, the
+    // field cache returns no types for it.
+    const auto& current_field_types =
+        context.field_cache->field_types(*previous_field_types, field);
 
     if (current_field_types.empty()) {
       LOG(5,
           "Model for method `{}` has invalid path element `{}`",
           show(method_),
           show(field));
-      return std::make_pair(false, current_field_types);
+      return std::make_pair(false, &current_field_types);
     }
 
-    return std::make_pair(true, current_field_types);
+    return std::make_pair(true, &current_field_types);
   };
 
-  auto initial_accumulator = [this](const Root& root) {
+  auto initial_accumulator = [this, &context](const Root& root) {
     // Leaf ports appear in callee ports. This only applies to caller ports.
     mt_assert(!root.is_leaf_port());
 
@@ -391,10 +388,10 @@ void Model::collapse_invalid_paths(Context& context) {
           "Could not find root type for method `{}`, root: `{}`",
           show(method_),
           show(root));
-      return FieldTypesAccumulator{};
+      return &no_types;
     }
 
-    return FieldTypesAccumulator{root_type};
+    return &context.field_cache->singleton_types(root_type);
   };
 
   generations_.collapse_invalid_paths<FieldTypesAccumulator>(
@@ -408,10 +405,14 @@ void Model::collapse_invalid_paths(Context& context) {
 }
 
 void Model::approximate() {
-  generations_.limit_leaves(Heuristics::kModelTreeMaxLeaves);
-  parameter_sources_.limit_leaves(Heuristics::kModelTreeMaxLeaves);
-  sinks_.limit_leaves(Heuristics::kModelTreeMaxLeaves);
-  propagations_.limit_leaves(Heuristics::kModelTreeMaxLeaves);
+  approximate(Heuristics::kModelTreeMaxLeaves);
+}
+
+void Model::approximate(std::size_t model_tree_max_leaves) {
+  generations_.limit_leaves(model_tree_max_leaves);
+  parameter_sources_.limit_leaves(model_tree_max_leaves);
+  sinks_.limit_leaves(model_tree_max_leaves);
+  propagations_.limit_leaves(model_tree_max_leaves);
 }
 
 bool Model::empty() const {
@@ -424,6 +425,20 @@ bool Model::empty() const {
       issues_.is_bottom();
 }
 
+Model::Shape Model::shape() const {
+  if (!generations_.is_bottom() || !sinks_.is_bottom()) {
+    return Shape::General;
+  } else if (inline_as_.get_constant()) {
+    return Shape::InlineAs;
+  } else if (
+      !propagations_.is_bottom() || add_via_obscure_feature() ||
+      has_add_features_to_arguments()) {
+    return Shape::Propagations;
+  } else {
+    return Shape::Empty;
+  }
+}
+
 bool Model::check_root_consistency(Root root) const {
   switch (root.kind()) {
     case Root::Kind::Return: {
@@ -734,24 +749,35 @@ Taint Model::apply_source_sink_sanitizers(
     Taint taint,
     Root root) {
   mt_assert(kind != SanitizerKind::Propagations);
-  for (const auto& sanitizer_set :
-       {global_sanitizers_, port_sanitizers_.get(root)}) {
-    for (const auto& sanitizer : sanitizer_set) {
+  if (global_sanitizers_.is_bottom() && port_sanitizers_.is_bottom()) {
+    return taint;
+  }
+
+  // Collect the applicable sanitizers, then filter the taint in one pass.
+  auto port_sanitizers = port_sanitizers_.get(root);
+  std::vector<const Sanitizer*> sanitizers;
+  for (const auto* sanitizer_set : {&global_sanitizers_, &port_sanitizers}) {
+    for (const auto& sanitizer : *sanitizer_set) {
       if (sanitizer.sanitizer_kind() == kind) {
         if (sanitizer.kinds().is_top()) {
           return Taint::bottom();
         }
-        taint = taint.transform_kind_with_features(
-            [&sanitizer](const Kind* kind) -> std::vector<const Kind*> {
-              if (sanitizer.kinds().contains(kind)) {
-                return {};
-              }
-              return {kind};
-            },
-            /* add_features, never called */ nullptr);
+        sanitizers.push_back(&sanitizer);
       }
     }
   }
+  if (sanitizers.empty()) {
+    return taint;
+  }
+
+  taint.filter([&sanitizers](const FrameSet& frames) {
+    return std::none_of(
+        sanitizers.begin(),
+        sanitizers.end(),
+        [&frames](const Sanitizer* sanitizer) {
+          return sanitizer->sanitizes(frames.kind());
+        });
+  });
   return taint;
 }
 
@@ -835,6 +861,10 @@ void Model::add_issue(Issue trace) {
   issues_.add(std::move(trace));
 }
 
+void Model::compact_issues() {
+  issues_.map([](Issue& issue) { issue.compact(); });
+}
+
 bool Model::override_default() const {
   return modes_.test(Model::Mode::OverrideDefault);
 }
@@ -868,6 +898,10 @@ bool Model::alias_memory_location_on_invoke() const {
 }
 
 bool Model::leq(const Model& other) const {
+  return caller_visible_leq(other) && issues_.leq(other.issues_);
+}
+
+bool Model::caller_visible_leq(const Model& other) const {
   return modes_.is_subset_of(other.modes_) &&
       generations_.leq(other.generations_) &&
       parameter_sources_.leq(other.parameter_sources_) &&
@@ -878,7 +912,7 @@ bool Model::leq(const Model& other) const {
       attach_to_sinks_.leq(other.attach_to_sinks_) &&
       attach_to_propagations_.leq(other.attach_to_propagations_) &&
       add_features_to_arguments_.leq(other.add_features_to_arguments_) &&
-      inline_as_.leq(other.inline_as_) && issues_.leq(other.issues_);
+      inline_as_.leq(other.inline_as_);
 }
 
 void Model::join_with(const Model& other) {
@@ -905,6 +939,67 @@ void Model::join_with(const Model& other) {
   mt_expensive_assert(previous.leq(*this) && other.leq(*this));
 }
 
+namespace {
+
+/* Join `other` into `domain` unless it is already included. */
+template <typename Domain>
+bool join_if_not_leq(Domain& domain, const Domain& other) {
+  if (other.leq(domain)) {
+    return false;
+  }
+  domain.join_with(other);
+  return true;
+}
+
+} // namespace
+
+Model::Change Model::join_with_change(const Model& other) {
+  if (this == &other) {
+    return Change::None;
+  }
+
+  mt_if_expensive_assert(auto previous = *this);
+
+  bool changed = false;
+  if (!other.modes_.is_subset_of(modes_)) {
+    modes_ |= other.modes_;
+    changed = true;
+  }
+  changed |= join_if_not_leq(generations_, other.generations_);
+  changed |= join_if_not_leq(parameter_sources_, other.parameter_sources_);
+  changed |= join_if_not_leq(sinks_, other.sinks_);
+  changed |= join_if_not_leq(propagations_, other.propagations_);
+  changed |= join_if_not_leq(global_sanitizers_, other.global_sanitizers_);
+  changed |= join_if_not_leq(port_sanitizers_, other.port_sanitizers_);
+  changed |= join_if_not_leq(attach_to_sources_, other.attach_to_sources_);
+  changed |= join_if_not_leq(attach_to_sinks_, other.attach_to_sinks_);
+  changed |=
+      join_if_not_leq(attach_to_propagations_, other.attach_to_propagations_);
+  changed |= join_if_not_leq(
+      add_features_to_arguments_, other.add_features_to_arguments_);
+  changed |= join_if_not_leq(inline_as_, other.inline_as_);
+  // Issues are not visible to callers.
+  bool issues_changed = join_if_not_leq(issues_, other.issues_);
+
+  mt_expensive_assert(previous.leq(*this) && other.leq(*this));
+  mt_expensive_assert(changed == !other.caller_visible_leq(previous));
+  if (changed) {
+    return Change::CallerVisible;
+  }
+  return issues_changed ? Change::Issues : Change::None;
+}
+
+Model::Change Model::widen_with_change(const Model& other) {
+  auto change = join_with_change(other);
+  if (change == Change::CallerVisible) {
+    generations_.collapse_deeper_than(Heuristics::kModelWideningHeight);
+    parameter_sources_.collapse_deeper_than(Heuristics::kModelWideningHeight);
+    sinks_.collapse_deeper_than(Heuristics::kModelWideningHeight);
+    propagations_.collapse_deeper_than(Heuristics::kModelWideningHeight);
+  }
+  return change;
+}
+
 Model Model::from_json(
     const Method* method,
     const Json::Value& value,
@@ -1325,9 +1420,16 @@ std::ostream& operator<<(std::ostream& out, const Model& model) {
 }
 
 void Model::remove_kinds(const std::unordered_set<const Kind*>& to_remove) {
+  remove_kinds_if([&to_remove](const Kind* kind) {
+    return to_remove.find(kind) != to_remove.end();
+  });
+}
+
+void Model::remove_kinds_if(
+    const std::function<bool(const Kind*)>& is_removed) {
   auto drop_special_kinds =
-      [&to_remove](const Kind* kind) -> std::vector<const Kind*> {
-    if (to_remove.find(kind) != to_remove.end()) {
+      [&is_removed](const Kind* kind) -> std::vector<const Kind*> {
+    if (is_removed(kind)) {
       return std::vector<const Kind*>();
     }
     return std::vector<const Kind*>{kind};
@@ -7,6 +7,8 @@
 
 #pragma once
 
+#include <cstdint>
+#include <functional>
 #include <optional>
 #include <ostream>
 #include <string>
@@ -25,7 +27,7 @@
 #include <mariana-trench/Propagation.h>
 #include <mariana-trench/PropagationSet.h>
 #include <mariana-trench/PropagationTree.h>
-#include <mariana-trench/RootPatriciaTreeAbstractPartition.h>
+#include <mariana-trench/SmallRootAbstractPartition.h>
 #include <mariana-trench/Sanitizer.h>
 #include <mariana-trench/Taint.h>
 #include <mariana-trench/TaintTree.h>
@@ -118,6 +120,27 @@ class Model final {
 
   using Modes = Flags<Mode>;
 
+  /**
+   * What call sites need to apply from a model, see `Model::shape`.
+   *
+   * Models without generations and sinks do not depend on the call site, they
+   * are the vast majority of callees (e.g, taint-in-taint-out and getters).
+   */
+  enum class Shape : std::uint8_t {
+    // Nothing to apply at call sites.
+    Empty,
+
+    // Only propagations and features added to arguments.
+    Propagations,
+
+    // Propagations of a method inlined as an argument access path, e.g a
+    // getter. This is only a candidate, see `try_inline_invoke`.
+    InlineAs,
+
+    // Generations or sinks, which are instantiated at each call site.
+    General,
+  };
+
  public:
   /* Create an empty model. */
   explicit Model();
@@ -170,15 +193,28 @@ class Model final {
       const Position* position,
       Context& context,
       const std::vector<const DexType * MT_NULLABLE>& source_register_types,
-      const std::vector<std::optional<std::string>>& source_constant_arguments)
+      const std::vector<const DexString * MT_NULLABLE>&
+          source_constant_arguments)
       const;
 
+  /**
+   * Move a model instantiated at a call site (see `at_callsite`) to another
+   * position of the same call. This replaces the call position of all frames.
+   */
+  void set_call_position(const Position* call_position);
+
   void collapse_invalid_paths(Context& context);
 
   void approximate();
 
+  /* Approximate with the given maximum number of leaves per tree. */
+  void approximate(std::size_t model_tree_max_leaves);
+
   bool empty() const;
 
+  /* This is cheap to compute, it only looks at which parts are bottom. */
+  Shape shape() const;
+
   bool check_root_consistency(Root root) const;
   bool check_port_consistency(const AccessPath& access_path) const;
   bool check_parameter_source_port_consistency(
@@ -262,9 +298,14 @@ class Model final {
   void set_issues(IssueSet issues) {
     issues_ = std::move(issues);
   }
+  /* Compact all issues, see `Issue::compact`. */
+  void compact_issues();
 
   void remove_kinds(const std::unordered_set<const Kind*>& to_remove);
 
+  /* Remove all taint with a kind matching the given predicate. */
+  void remove_kinds_if(const std::function<bool(const Kind*)>& is_removed);
+
   bool override_default() const;
   bool skip_analysis() const;
   bool add_via_obscure_feature() const;
@@ -278,8 +319,46 @@ class Model final {
   }
 
   bool leq(const Model& other) const;
+
+  /**
+   * Same as `leq`, ignoring the parts of the model that are never read at
+   * call sites (i.e, issues). Callers only need to be re-analyzed when this
+   * does not hold.
+   */
+  bool caller_visible_leq(const Model& other) const;
+
   void join_with(const Model& other);
 
+  /* How a model changed after a join (see `join_with_change`). */
+  enum class Change : std::uint8_t {
+    // The model already included the other model.
+    None,
+    // Only the issues grew, which is not visible to callers.
+    Issues,
+    // The model grew in a way that is visible to callers, i.e
+    // `other.caller_visible_leq(*this)` did not hold before the join.
+    CallerVisible,
+  };
+
+  /**
+   * Join with the given model and return how this model changed.
+   *
+   * Each part of the model is compared once: parts that already include the
+   * other model are left untouched, other parts are joined. This is cheaper
+   * than `join_with` followed by `leq`, which traverses every part twice.
+   * When this returns `Change::None`, the model is unchanged.
+   */
+  Change join_with_change(const Model& other);
+
+  /**
+   * Same as `join_with_change`, but when the model grows, widen it by
+   * collapsing the ports of its taint and propagation trees to
+   * `Heuristics::kModelWideningHeight`.
+   *
+   * This is used by the global fixpoint for models that keep changing.
+   */
+  Change widen_with_change(const Model& other);
+
   static Model from_json(
       const Method* MT_NULLABLE method,
       const Json::Value& value,
@@ -299,11 +378,11 @@ class Model final {
   TaintAccessPathTree sinks_;
   PropagationAccessPathTree propagations_;
   SanitizerSet global_sanitizers_;
-  RootPatriciaTreeAbstractPartition<SanitizerSet> port_sanitizers_;
-  RootPatriciaTreeAbstractPartition<FeatureSet> attach_to_sources_;
-  RootPatriciaTreeAbstractPartition<FeatureSet> attach_to_sinks_;
-  RootPatriciaTreeAbstractPartition<FeatureSet> attach_to_propagations_;
-  RootPatriciaTreeAbstractPartition<FeatureSet> add_features_to_arguments_;
+  SmallRootAbstractPartition<SanitizerSet> port_sanitizers_;
+  SmallRootAbstractPartition<FeatureSet> attach_to_sources_;
+  SmallRootAbstractPartition<FeatureSet> attach_to_sinks_;
+  SmallRootAbstractPartition<FeatureSet> attach_to_propagations_;
+  SmallRootAbstractPartition<FeatureSet> add_features_to_arguments_;
   AccessPathConstantDomain inline_as_;
   IssueSet issues_;
 };
@@ -5,20 +5,29 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <algorithm>
+#include <atomic>
 #include <memory>
+#include <unordered_map>
 #include <vector>
 
 #include <boost/algorithm/string.hpp>
+#include <fmt/format.h>
 #include <json/json.h>
 
+#include <SpartaWorkQueue.h>
+
 #include <mariana-trench/Assert.h>
 #include <mariana-trench/Context.h>
 #include <mariana-trench/Dependencies.h>
+#include <mariana-trench/JsonFileCache.h>
 #include <mariana-trench/JsonValidation.h>
 #include <mariana-trench/Log.h>
 #include <mariana-trench/ModelGeneration.h>
 #include <mariana-trench/Options.h>
+#include <mariana-trench/Statistics.h>
 #include <mariana-trench/Timer.h>
+#include <mariana-trench/Tracer.h>
 #include <mariana-trench/model-generator/ContentProviderGenerator.h>
 #include <mariana-trench/model-generator/JsonModelGenerator.h>
 #include <mariana-trench/model-generator/ModelGeneratorConfiguration.h>
@@ -37,21 +46,20 @@ std::map<std::string, std::unique_ptr<ModelGenerator>> make_model_generators(
   // Find JSON model generators in search path.
   for (const auto& path : context.options->model_generator_search_paths()) {
     LOG(3, "Searching for model generators in `{}`...", path);
-    for (auto& entry : boost::filesystem::recursive_directory_iterator(path)) {
-      if (entry.path().extension() != ".json") {
-        continue;
-      }
-
-      auto path_copy = entry.path();
+    for (const auto& generator_path : JsonFileCache::find_json_files(path)) {
+      auto path_copy = generator_path;
       auto name = path_copy.replace_extension("").filename().string();
 
       try {
         auto [_, inserted] = generators.emplace(
             name,
-            std::make_unique<JsonModelGenerator>(name, context, entry.path()));
+            std::make_unique<JsonModelGenerator>(
+                name, context, generator_path));
         if (!inserted) {
           auto error = fmt::format(
-              "Duplicate model generator {} defined at {}", name, entry.path());
+              "Duplicate model generator {} defined at {}",
+              name,
+              generator_path);
           throw std::invalid_argument(error);
         }
         LOG(3, "Found model generator `{}`", name);
@@ -64,6 +72,51 @@ std::map<std::string, std::unique_ptr<ModelGenerator>> make_model_generators(
   return generators;
 }
 
+/**
+ * Join the models of each shard per method, in parallel. Models of a given
+ * method must all be in the same shard.
+ */
+std::vector<Model> join_shards(
+    std::vector<std::vector<Model>> shards,
+    unsigned int threads) {
+  auto queue = sparta::work_queue<std::size_t>(
+      [&](std::size_t index) {
+        auto& shard = shards[index];
+        std::vector<Model> joined;
+        std::unordered_map<const Method*, std::size_t> positions;
+        for (auto& model : shard) {
+          auto [iterator, inserted] =
+              positions.emplace(model.method(), joined.size());
+          if (inserted) {
+            joined.push_back(std::move(model));
+          } else {
+            joined[iterator->second].join_with(model);
+          }
+        }
+        shard = std::move(joined);
+      },
+      threads);
+  for (std::size_t index = 0; index < shards.size(); index++) {
+    queue.add_item(index);
+  }
+  queue.run_all();
+
+  std::size_t size = 0;
+  for (const auto& shard : shards) {
+    size += shard.size();
+  }
+  std::vector<Model> models;
+  models.reserve(size);
+  for (auto& shard : shards) {
+    models.insert(
+        models.end(),
+        std::make_move_iterator(shard.begin()),
+        std::make_move_iterator(shard.end()));
+    shard = std::vector<Model>();
+  }
+  return models;
+}
+
 } // namespace
 
 #ifndef MARIANA_TRENCH_FACEBOOK_BUILD
@@ -137,30 +190,112 @@ ModelGeneratorResult ModelGeneration::run(Context& context) {
         boost::algorithm::join(nonexistent_model_generators, ", ")));
   }
 
-  std::vector<Model> generated_models;
   std::vector<FieldModel> generated_field_models;
-  std::size_t iteration = 0;
+  std::atomic<std::size_t> iteration(0);
 
   LOG(1,
       "Building method mappings for model generation over {} methods",
       context.methods->size());
   Timer method_mapping_timer;
+  TraceSpan method_mapping_span("models_generation:method_mappings");
   std::unique_ptr<MethodMappings> method_mappings =
       std::make_unique<MethodMappings>(*context.methods);
+  method_mapping_span.end();
   LOG(1,
       "Generated method mappings in {:.2f}s",
       method_mapping_timer.duration_in_seconds());
 
+  LOG(1,
+      "Building field mappings for model generation over {} fields",
+      context.fields->size());
+  Timer field_mapping_timer;
+  std::unique_ptr<FieldMappings> field_mappings =
+      std::make_unique<FieldMappings>(*context.fields);
+  LOG(1,
+      "Generated field mappings in {:.2f}s",
+      field_mapping_timer.duration_in_seconds());
+
+  // Match the regular expressions of all generators at once.
+  Timer patterns_timer;
+  TraceSpan patterns_span("models_generation:patterns");
+  MethodPatterns patterns;
   for (const auto& model_generator : model_generators) {
-    Timer generator_timer;
-    LOG(1,
-        "Running model generator `{}` ({}/{})",
-        model_generator->name(),
-        ++iteration,
-        model_generators.size());
+    model_generator->add_patterns(patterns);
+  }
+  method_mappings->index_patterns(patterns);
+  patterns_span.end();
+  LOG(1,
+      "Indexed {} name and {} class patterns in {:.2f}s",
+      method_mappings->name_pattern_to_methods.size(),
+      method_mappings->class_pattern_to_methods.size(),
+      patterns_timer.duration_in_seconds());
 
-    auto [models, field_models] = model_generator->run_optimized(
-        *context.methods, *method_mappings, *context.fields);
+  // Run generators concurrently, so that small generators overlap. Each
+  // generator visits methods with a share of the threads that depends on the
+  // number of generators running when it starts.
+  Timer generators_timer;
+  TraceSpan generators_span("models_generation:generators");
+  auto threads = context.options->jobs(AnalysisPhase::ModelGeneration);
+  std::atomic<unsigned int> running_generators(0);
+  std::vector<ModelGeneratorResult> results(model_generators.size());
+  std::vector<double> durations(model_generators.size(), 0.0);
+  auto generators_queue = sparta::work_queue<std::size_t>(
+      [&](std::size_t index) {
+        const auto& model_generator = model_generators[index];
+        Timer generator_timer;
+        TraceSpan generator_span(
+            fmt::format("model_generator:{}", model_generator->name()));
+        auto running = ++running_generators;
+        LOG(1,
+            "Running model generator `{}` ({}/{})",
+            model_generator->name(),
+            ++iteration,
+            model_generators.size());
+
+        ModelGenerator::set_visitor_threads(std::max(1u, threads / running));
+        results[index] = model_generator->run_optimized(
+            *context.methods,
+            *method_mappings,
+            *context.fields,
+            *field_mappings);
+        ModelGenerator::set_visitor_threads(0);
+
+        --running_generators;
+        generator_span.end();
+        durations[index] = generator_timer.duration_in_seconds();
+        context.statistics->log_time(
+            fmt::format("model_generator:{}", model_generator->name()),
+            generator_timer);
+      },
+      threads);
+  for (std::size_t index = 0; index < model_generators.size(); index++) {
+    generators_queue.add_item(index);
+  }
+  generators_queue.run_all();
+  generators_span.end();
+  LOG(1,
+      "Ran {} model generators in {:.2f}s",
+      model_generators.size(),
+      generators_timer.duration_in_seconds());
+
+  // Mappings and generators are not needed anymore, free them before joining
+  // the generated models.
+  std::vector<std::string> generator_names;
+  generator_names.reserve(model_generators.size());
+  for (const auto& model_generator : model_generators) {
+    generator_names.push_back(model_generator->name());
+  }
+  method_mappings = nullptr;
+  field_mappings = nullptr;
+  model_generators.clear();
+  builtin_generators.clear();
+
+  // Models are sharded per method, so that the models of a method can be
+  // joined before building the registry.
+  std::vector<std::vector<Model>> generated_model_shards(threads);
+  for (std::size_t index = 0; index < generator_names.size(); index++) {
+    const auto& generator_name = generator_names[index];
+    auto& [models, field_models] = results[index];
 
     // Remove models for the `null` method
     models.erase(
@@ -176,15 +311,11 @@ ModelGeneratorResult ModelGeneration::run(Context& context) {
             [](const FieldModel& field_model) { return !field_model.field(); }),
         field_models.end());
 
-    generated_models.insert(
-        generated_models.end(), models.begin(), models.end());
-    generated_field_models.insert(
-        generated_field_models.end(), field_models.begin(), field_models.end());
-
     LOG(2,
-        "Generated {} models in {:.2f}s.",
+        "Model generator `{}` generated {} models in {:.2f}s.",
+        generator_name,
         models.size(),
-        generator_timer.duration_in_seconds());
+        durations[index]);
 
     if (generated_models_directory) {
       // Persist models to file.
@@ -196,7 +327,7 @@ ModelGeneratorResult ModelGeneration::run(Context& context) {
       // Merge models
       auto registry = Registry(context, models, field_models);
       JsonValidation::write_json_file(
-          *generated_models_directory + "/" + model_generator->name() + ".json",
+          *generated_models_directory + "/" + generator_name + ".json",
           registry.models_to_json());
 
       LOG(2,
@@ -205,11 +336,31 @@ ModelGeneratorResult ModelGeneration::run(Context& context) {
           *generated_models_directory,
           generator_output_timer.duration_in_seconds());
     }
+
+    for (auto& model : models) {
+      generated_model_shards[model.method()->id() % threads].push_back(
+          std::move(model));
+    }
+    generated_field_models.insert(
+        generated_field_models.end(),
+        std::make_move_iterator(field_models.begin()),
+        std::make_move_iterator(field_models.end()));
+    results[index] = ModelGeneratorResult();
   }
 
+  Timer join_timer;
+  TraceSpan join_span("models_generation:join");
+  auto generated_models =
+      join_shards(std::move(generated_model_shards), threads);
+  join_span.end();
+  LOG(1,
+      "Joined generated models into {} models in {:.2f}s",
+      generated_models.size(),
+      join_timer.duration_in_seconds());
+
   return {
-      /* method_models */ generated_models,
-      /* field_models */ generated_field_models};
+      /* method_models */ std::move(generated_models),
+      /* field_models */ std::move(generated_field_models)};
 }
 
 } // namespace marianatrench
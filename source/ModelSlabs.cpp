@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <atomic>
+#include <new>
+
+#include <mariana-trench/ModelSlabs.h>
+
+namespace marianatrench {
+
+namespace {
+
+constexpr std::size_t k_alignment = alignof(std::max_align_t);
+
+constexpr std::size_t align(std::size_t size) {
+  return (size + k_alignment - 1) & ~(k_alignment - 1);
+}
+
+std::atomic<std::size_t> live_slabs_count = 0;
+
+/**
+ * A slab is referenced by each of its allocations and by its thread while it
+ * is the current slab of the thread.
+ */
+struct Slab {
+  std::atomic<std::size_t> references{1};
+  std::size_t used = 0;
+
+  static Slab* create() {
+    auto* memory = ::operator new(ModelSlabs::k_slab_size);
+    live_slabs_count.fetch_add(1, std::memory_order_relaxed);
+    return new (memory) Slab();
+  }
+
+  char* data() {
+    return reinterpret_cast<char*>(this) + align(sizeof(Slab));
+  }
+
+  std::size_t capacity() const {
+    return ModelSlabs::k_slab_size - align(sizeof(Slab));
+  }
+
+  void release() {
+    if (references.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      this->~Slab();
+      ::operator delete(this);
+      live_slabs_count.fetch_sub(1, std::memory_order_relaxed);
+    }
+  }
+};
+
+/* Each allocation is preceded by its slab, or null for heap allocations. */
+struct Header {
+  Slab* slab;
+};
+
+constexpr std::size_t k_header_size = align(sizeof(Header));
+
+class ThreadSlab final {
+ public:
+  ThreadSlab() = default;
+  ThreadSlab(const ThreadSlab&) = delete;
+  ThreadSlab(ThreadSlab&&) = delete;
+  ThreadSlab& operator=(const ThreadSlab&) = delete;
+  ThreadSlab& operator=(ThreadSlab&&) = delete;
+
+  ~ThreadSlab() {
+    if (slab_ != nullptr) {
+      slab_->release();
+    }
+  }
+
+  Slab* reserve(std::size_t size) {
+    if (slab_ == nullptr || slab_->used + size > slab_->capacity()) {
+      if (slab_ != nullptr) {
+        slab_->release();
+      }
+      slab_ = Slab::create();
+    }
+    return slab_;
+  }
+
+ private:
+  Slab* slab_ = nullptr;
+};
+
+} // namespace
+
+void* ModelSlabs::allocate(std::size_t size) {
+  size = k_header_size + align(size);
+
+  char* memory = nullptr;
+  Slab* slab = nullptr;
+  if (size > k_slab_size / 4) {
+    memory = static_cast<char*>(::operator new(size));
+  } else {
+    thread_local ThreadSlab thread_slab;
+    slab = thread_slab.reserve(size);
+    memory = slab->data() + slab->used;
+    slab->used += size;
+    slab->references.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  new (memory) Header{slab};
+  return memory + k_header_size;
+}
+
+void ModelSlabs::deallocate(void* pointer) noexcept {
+  if (pointer == nullptr) {
+    return;
+  }
+  auto* memory = static_cast<char*>(pointer) - k_header_size;
+  auto* slab = reinterpret_cast<Header*>(memory)->slab;
+  if (slab == nullptr) {
+    ::operator delete(memory);
+  } else {
+    slab->release();
+  }
+}
+
+std::size_t ModelSlabs::live_slabs() {
+  return live_slabs_count.load(std::memory_order_relaxed);
+}
+
+} // namespace marianatrench
@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+namespace marianatrench {
+
+/**
+ * Slabs holding the model snapshots of the registry (see
+ * `--slab-allocate-models`).
+ *
+ * Each thread bumps allocations in its own slab. Since a worker analyzes one
+ * strongly connected component at a time, the snapshots of a component and
+ * their control blocks end up contiguous in memory instead of scattered in
+ * the heap, and on the NUMA node of the worker (first touch, see
+ * `NumaPlacement`).
+ *
+ * Memory is only reclaimed per slab: a slab is freed once it is full (or its
+ * thread exits) and all its allocations are freed. This is thread-safe, an
+ * allocation can be freed from any thread.
+ */
+class ModelSlabs final {
+ public:
+  /* Size of a slab. Larger allocations use the heap. */
+  static constexpr std::size_t k_slab_size = 1 << 20;
+
+  static void* allocate(std::size_t size);
+  static void deallocate(void* pointer) noexcept;
+
+  /* Number of slabs allocated and not yet freed, for all threads. */
+  static std::size_t live_slabs();
+
+  /* Standard allocator, e.g for `std::allocate_shared`. */
+  template <typename T>
+  class Allocator final {
+   public:
+    using value_type = T;
+
+    Allocator() = default;
+
+    template <typename U>
+    Allocator(const Allocator<U>&) {} // NOLINT: rebinding is implicit
+
+    T* allocate(std::size_t n) {
+      static_assert(alignof(T) <= alignof(std::max_align_t));
+      return static_cast<T*>(ModelSlabs::allocate(n * sizeof(T)));
+    }
+
+    void deallocate(T* pointer, std::size_t /* n */) noexcept {
+      ModelSlabs::deallocate(pointer);
+    }
+
+    template <typename U>
+    bool operator==(const Allocator<U>&) const {
+      return true;
+    }
+
+    template <typename U>
+    bool operator!=(const Allocator<U>&) const {
+      return false;
+    }
+  };
+
+  template <typename T, typename... Arguments>
+  static std::shared_ptr<const T> make_shared(Arguments&&... arguments) {
+    return std::allocate_shared<const T>(
+        Allocator<T>(), std::forward<Arguments>(arguments)...);
+  }
+};
+
+} // namespace marianatrench
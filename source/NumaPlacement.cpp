@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <algorithm>
+#include <utility>
+
+#include <mariana-trench/Log.h>
+#include <mariana-trench/NumaPlacement.h>
+#include <mariana-trench/OperatingSystem.h>
+#include <mariana-trench/Partitions.h>
+
+namespace marianatrench {
+
+NumaPlacement::NumaPlacement(const Scheduler& scheduler, unsigned int threads)
+    : NumaPlacement(scheduler, threads, numa_node_processors()) {}
+
+NumaPlacement::NumaPlacement(
+    const Scheduler& scheduler,
+    unsigned int threads,
+    std::vector<std::vector<int>> node_processors)
+    : strongly_connected_components_(
+          scheduler.strongly_connected_components()),
+      threads_(std::max(1u, threads)),
+      nodes_(std::max<std::size_t>(
+          1, std::min<std::size_t>(node_processors.size(), threads_))),
+      node_processors_(std::move(node_processors)),
+      components_per_node_(nodes_, 0),
+      dependencies_(0),
+      remote_dependencies_(0),
+      analyses_(std::make_unique<std::atomic<std::size_t>[]>(nodes_)),
+      remote_analyses_(std::make_unique<std::atomic<std::size_t>[]>(nodes_)),
+      pinned_threads_(0) {
+  for (std::size_t node = 0; node < nodes_; node++) {
+    analyses_[node] = 0;
+    remote_analyses_[node] = 0;
+  }
+
+  component_nodes_ = Partitions::assign_components(scheduler, nodes_);
+  for (std::size_t component = 0; component < component_nodes_.size();
+       component++) {
+    auto node = component_nodes_[component];
+    components_per_node_[node]++;
+    for (auto dependent :
+         strongly_connected_components_.dependent_components(component)) {
+      dependencies_++;
+      if (component_nodes_[dependent] != node) {
+        remote_dependencies_++;
+      }
+    }
+  }
+
+  LOG(1,
+      "Placing {} workers on {} NUMA nodes ({} nodes found). {} out of {} dependencies between components cross nodes.",
+      threads_,
+      nodes_,
+      node_processors_.size(),
+      remote_dependencies_,
+      dependencies_);
+}
+
+std::size_t NumaPlacement::method_node(const Method* method) const {
+  return component_nodes_[strongly_connected_components_.component_index(
+      method)];
+}
+
+void NumaPlacement::enter(std::size_t worker, const Method* method) const {
+  auto node = worker_node(worker);
+
+  // Worker threads are created for each global iteration, hence this pins
+  // each new thread once.
+  thread_local const NumaPlacement* pinned_by = nullptr;
+  thread_local std::size_t pinned_node = 0;
+  if (pinned_by != this || pinned_node != node) {
+    pinned_by = this;
+    pinned_node = node;
+    if (node < node_processors_.size() &&
+        set_current_thread_affinity(node_processors_[node])) {
+      pinned_threads_.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  analyses_[node].fetch_add(1, std::memory_order_relaxed);
+  if (method_node(method) != node) {
+    remote_analyses_[node].fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+Json::Value NumaPlacement::to_json() const {
+  auto value = Json::Value(Json::objectValue);
+  value["nodes"] = Json::Value(static_cast<Json::UInt64>(nodes_));
+  value["pinned_threads"] =
+      Json::Value(static_cast<Json::UInt64>(pinned_threads_.load()));
+  value["dependencies"] = Json::Value(static_cast<Json::UInt64>(dependencies_));
+  value["remote_dependencies"] =
+      Json::Value(static_cast<Json::UInt64>(remote_dependencies_));
+
+  auto nodes = Json::Value(Json::arrayValue);
+  for (std::size_t node = 0; node < nodes_; node++) {
+    auto node_value = Json::Value(Json::objectValue);
+    node_value["processors"] = Json::Value(static_cast<Json::UInt64>(
+        node < node_processors_.size() ? node_processors_[node].size() : 0));
+    node_value["components"] =
+        Json::Value(static_cast<Json::UInt64>(components_per_node_[node]));
+    node_value["analyses"] =
+        Json::Value(static_cast<Json::UInt64>(analyses_[node].load()));
+    node_value["remote_analyses"] =
+        Json::Value(static_cast<Json::UInt64>(remote_analyses_[node].load()));
+    nodes.append(node_value);
+  }
+  value["per_node"] = nodes;
+  return value;
+}
+
+} // namespace marianatrench
@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include <json/json.h>
+
+#include <mariana-trench/Method.h>
+#include <mariana-trench/Scheduler.h>
+
+namespace marianatrench {
+
+/**
+ * Placement of the analysis workers on NUMA nodes (see
+ * `--numa-aware-scheduling`).
+ *
+ * Workers are split in contiguous ranges, one per node, and pin themselves
+ * to the processors of their node before their first analysis. Strongly
+ * connected components are assigned to nodes like partitions of the
+ * distributed analysis (see `Partitions::assign_components`), so that a
+ * component is mostly analyzed on the node of its callees. The scheduler
+ * then enqueues each component on a worker of its node. Since allocators
+ * serve memory from the node of the calling thread, models end up allocated
+ * on the node that reads them most of the time.
+ *
+ * Idle workers still steal work from other nodes: such analyses are counted
+ * as remote, along with dependency edges between components of different
+ * nodes, as proxies of remote memory accesses.
+ */
+class NumaPlacement final {
+ public:
+  /* Use the topology of the machine (see `numa_node_processors`). */
+  explicit NumaPlacement(const Scheduler& scheduler, unsigned int threads);
+
+  /* Use the given processors of each node. */
+  explicit NumaPlacement(
+      const Scheduler& scheduler,
+      unsigned int threads,
+      std::vector<std::vector<int>> node_processors);
+
+  NumaPlacement(const NumaPlacement&) = delete;
+  NumaPlacement(NumaPlacement&&) = delete;
+  NumaPlacement& operator=(const NumaPlacement&) = delete;
+  NumaPlacement& operator=(NumaPlacement&&) = delete;
+  ~NumaPlacement() = default;
+
+  /* Number of nodes in use, at most the number of threads. */
+  std::size_t nodes() const {
+    return nodes_;
+  }
+
+  std::size_t worker_node(std::size_t worker) const {
+    return worker * nodes_ / threads_;
+  }
+
+  std::size_t component_node(std::size_t component) const {
+    return component_nodes_[component];
+  }
+
+  std::size_t method_node(const Method* method) const;
+
+  /**
+   * Called by a worker before analyzing the given method. This pins the
+   * calling thread to the node of the worker, the first time only, and
+   * updates the occupancy of the node. This is thread-safe.
+   */
+  void enter(std::size_t worker, const Method* method) const;
+
+  Json::Value to_json() const;
+
+ private:
+  const StronglyConnectedComponents& strongly_connected_components_;
+  unsigned int threads_;
+  std::size_t nodes_;
+  std::vector<std::vector<int>> node_processors_;
+
+  // Indexed by component index.
+  std::vector<std::size_t> component_nodes_;
+
+  std::vector<std::size_t> components_per_node_;
+  std::size_t dependencies_;
+  std::size_t remote_dependencies_;
+
+  // Indexed by node.
+  std::unique_ptr<std::atomic<std::size_t>[]> analyses_;
+  std::unique_ptr<std::atomic<std::size_t>[]> remote_analyses_;
+  mutable std::atomic<std::size_t> pinned_threads_;
+};
+
+} // namespace marianatrench
@@ -6,8 +6,14 @@
  */
 
 #include <fstream>
+#include <map>
+#include <regex>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include <boost/algorithm/string.hpp>
+#include <boost/filesystem.hpp>
 
 #include <mariana-trench/Log.h>
 #include <mariana-trench/OperatingSystem.h>
@@ -16,6 +22,14 @@
 #include <mach/mach.h>
 #include <mach/mach_init.h>
 #include <mach/mach_types.h>
+#include <time.h>
+#elif __linux__
+#include <sched.h>
+#include <time.h>
+#endif
+
+#if __GLIBC__
+#include <malloc.h>
 #endif
 
 namespace marianatrench {
@@ -49,4 +63,117 @@ double resident_set_size_in_gb() {
   return -1.0;
 }
 
+#if __APPLE__ || __linux__
+namespace {
+
+double cpu_time_in_seconds(clockid_t clock) {
+  struct timespec time;
+  if (clock_gettime(clock, &time) != 0) {
+    return -1.0;
+  }
+  return static_cast<double>(time.tv_sec) +
+      static_cast<double>(time.tv_nsec) / 1e9;
+}
+
+} // namespace
+#endif
+
+double thread_cpu_time_in_seconds() {
+#if __APPLE__ || __linux__
+  return cpu_time_in_seconds(CLOCK_THREAD_CPUTIME_ID);
+#else
+  return -1.0;
+#endif
+}
+
+double process_cpu_time_in_seconds() {
+#if __APPLE__ || __linux__
+  return cpu_time_in_seconds(CLOCK_PROCESS_CPUTIME_ID);
+#else
+  return -1.0;
+#endif
+}
+
+std::vector<std::vector<int>> numa_node_processors() {
+  std::vector<std::vector<int>> nodes;
+#if __linux__
+  try {
+    boost::filesystem::path root("/sys/devices/system/node");
+    if (!boost::filesystem::is_directory(root)) {
+      return nodes;
+    }
+
+    // Node identifiers may not be contiguous.
+    std::map<int, std::vector<int>> processors;
+    std::regex node_pattern("node([0-9]+)");
+    for (const auto& entry : boost::filesystem::directory_iterator(root)) {
+      std::smatch match;
+      auto name = entry.path().filename().string();
+      if (!std::regex_match(name, match, node_pattern)) {
+        continue;
+      }
+
+      // The list of processors looks like `0-3,8-11`.
+      std::ifstream infile((entry.path() / "cpulist").native());
+      std::string line;
+      std::getline(infile, line);
+      boost::trim(line);
+      std::vector<std::string> ranges;
+      boost::split(ranges, line, boost::is_any_of(","));
+      auto& node_processors = processors[std::stoi(match[1].str())];
+      for (const auto& range : ranges) {
+        if (range.empty()) {
+          continue;
+        }
+        auto separator = range.find('-');
+        int first = std::stoi(range.substr(0, separator));
+        int last = separator == std::string::npos
+            ? first
+            : std::stoi(range.substr(separator + 1));
+        for (int processor = first; processor <= last; processor++) {
+          node_processors.push_back(processor);
+        }
+      }
+    }
+
+    for (auto& [node, node_processors] : processors) {
+      if (!node_processors.empty()) {
+        nodes.push_back(std::move(node_processors));
+      }
+    }
+  } catch (const std::exception& error) {
+    ERROR(1, "Failed to read the NUMA topology: {}", error.what());
+    nodes.clear();
+  }
+#endif
+  return nodes;
+}
+
+bool set_current_thread_affinity(const std::vector<int>& processors) {
+#if __linux__
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (auto processor : processors) {
+    if (processor >= 0 && processor < CPU_SETSIZE) {
+      CPU_SET(processor, &set);
+    }
+  }
+  // A process identifier of 0 means the calling thread.
+  return sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+  (void)processors;
+  return false;
+#endif
+}
+
+bool release_free_memory() {
+#if __GLIBC__
+  // Free memory at the top of the heap and unused pages of all arenas.
+  malloc_trim(0);
+  return true;
+#else
+  return false;
+#endif
+}
+
 } // namespace marianatrench
@@ -5,9 +5,42 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <vector>
+
 namespace marianatrench {
 
 /* Returns -1 for unsupported operating systems. */
 double resident_set_size_in_gb();
 
+/**
+ * Return the CPU time consumed by the calling thread, in seconds. Returns -1
+ * for unsupported operating systems.
+ */
+double thread_cpu_time_in_seconds();
+
+/**
+ * Return the CPU time consumed by all threads of the process, in seconds.
+ * Returns -1 for unsupported operating systems.
+ */
+double process_cpu_time_in_seconds();
+
+/**
+ * Return the identifiers of the processors of each NUMA node, indexed by
+ * node. Returns an empty vector for unsupported operating systems.
+ */
+std::vector<std::vector<int>> numa_node_processors();
+
+/**
+ * Restrict the current thread to the given processors. Returns false for
+ * unsupported operating systems or if the call failed.
+ */
+bool set_current_thread_affinity(const std::vector<int>& processors);
+
+/**
+ * Return the memory freed by the allocator to the operating system, e.g once
+ * large structures are destroyed between phases. Returns false for
+ * unsupported allocators.
+ */
+bool release_free_memory();
+
 } // namespace marianatrench
@@ -5,11 +5,19 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <algorithm>
+#include <map>
 #include <optional>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include <boost/algorithm/string.hpp>
 #include <fmt/format.h>
 
+#include <SpartaWorkQueue.h>
+
+#include <mariana-trench/JsonArrayFile.h>
 #include <mariana-trench/JsonValidation.h>
 #include <mariana-trench/Log.h>
 #include <mariana-trench/Options.h>
@@ -18,6 +26,48 @@ namespace marianatrench {
 
 namespace {
 
+const std::vector<std::pair<std::string, AnalysisPhase>> k_analysis_phases = {
+    {"call-graph", AnalysisPhase::CallGraph},
+    {"dependencies", AnalysisPhase::Dependencies},
+    {"model-generation", AnalysisPhase::ModelGeneration},
+    {"fixpoint", AnalysisPhase::Fixpoint},
+    {"positions", AnalysisPhase::Positions},
+    {"postprocess-traces", AnalysisPhase::PostprocessTraces},
+    {"models", AnalysisPhase::Models},
+    {"highlights", AnalysisPhase::Highlights},
+};
+
+/* Parse a `--phase-jobs` value, e.g `positions=64`. */
+std::pair<AnalysisPhase, unsigned int> parse_phase_jobs(
+    const std::string& value) {
+  auto separator = value.find('=');
+  if (separator != std::string::npos) {
+    auto name = value.substr(0, separator);
+    auto phase = std::find_if(
+        k_analysis_phases.begin(),
+        k_analysis_phases.end(),
+        [&](const auto& entry) { return entry.first == name; });
+    unsigned long jobs = 0;
+    try {
+      jobs = std::stoul(value.substr(separator + 1));
+    } catch (const std::exception&) {
+      jobs = 0;
+    }
+    if (phase != k_analysis_phases.end() && jobs > 0) {
+      return {phase->second, static_cast<unsigned int>(jobs)};
+    }
+  }
+
+  std::vector<std::string> names;
+  for (const auto& [name, _] : k_analysis_phases) {
+    names.push_back(name);
+  }
+  throw std::invalid_argument(fmt::format(
+      "Invalid `--phase-jobs` value `{}`, expected `<phase>=<jobs>` where <jobs> is strictly positive and <phase> is one of: {}.",
+      value,
+      boost::algorithm::join(names, ", ")));
+}
+
 std::string check_path_exists(const std::string& path) {
   if (!boost::filesystem::exists(path)) {
     throw std::invalid_argument(fmt::format("File `{}` does not exist.", path));
@@ -63,6 +113,29 @@ std::vector<std::string> parse_paths_list(
   return paths;
 }
 
+std::map<std::string, std::vector<std::string>> parse_rule_packs(
+    const std::string& input) {
+  std::vector<std::string> inputs;
+  boost::split(inputs, input, boost::is_any_of(";"));
+
+  std::map<std::string, std::vector<std::string>> packs;
+  for (const auto& pack : inputs) {
+    auto separator = pack.find('=');
+    if (separator == std::string::npos || separator == 0) {
+      throw std::invalid_argument(fmt::format(
+          "Invalid rule pack `{}`, expected `name=paths`.", pack));
+    }
+    auto name = pack.substr(0, separator);
+    auto paths = parse_paths_list(
+        pack.substr(separator + 1), /* extension */ ".json");
+    if (!packs.emplace(name, std::move(paths)).second) {
+      throw std::invalid_argument(
+          fmt::format("Duplicate rule pack `{}`.", name));
+    }
+  }
+  return packs;
+}
+
 std::vector<std::string> parse_search_paths(const std::string& input) {
   std::vector<std::string> paths;
   boost::split(paths, input, boost::is_any_of(",;"));
@@ -80,10 +153,9 @@ std::vector<ModelGeneratorConfiguration> parse_json_configuration_files(
     const std::vector<std::string>& paths) {
   std::vector<ModelGeneratorConfiguration> result;
   for (const auto& path : paths) {
-    Json::Value json = JsonValidation::parse_json_file(path);
-    for (const auto& value : JsonValidation::null_or_array(json)) {
+    JsonArrayFile::for_each(path, [&](const Json::Value& value) {
       result.push_back(ModelGeneratorConfiguration::from_json(value));
-    }
+    });
   }
   return result;
 }
@@ -105,7 +177,8 @@ Options::Options(
         model_generators_configuration,
     const std::vector<std::string>& model_generator_search_paths,
     bool remove_unreachable_code,
-    const std::string& source_root_directory)
+    const std::string& source_root_directory,
+    std::optional<unsigned int> jobs)
     : models_paths_(models_paths),
       field_models_paths_(field_models_paths),
       rules_paths_(rules_paths),
@@ -115,17 +188,61 @@ Options::Options(
       model_generator_search_paths_(model_generator_search_paths),
       source_root_directory_(source_root_directory),
       sequential_(sequential),
+      jobs_(jobs),
       skip_source_indexing_(skip_source_indexing),
       skip_model_generation_(skip_model_generation),
       remove_unreachable_code_(remove_unreachable_code),
       disable_parameter_type_overrides_(false),
       maximum_method_analysis_time_(std::nullopt),
+      worklist_fixpoint_(false),
+      scc_local_fixpoint_(false),
+      deduplicate_methods_(false),
+      summarize_trivial_methods_(false),
+      demand_driven_analysis_(false),
+      entry_point_reachability_(false),
+      spill_cold_models_(false),
+      release_converged_methods_(false),
+      numa_aware_scheduling_(false),
+      disable_issue_stream_(false),
+      partition_count_(std::nullopt),
+      partition_index_(0),
+      partition_directory_(std::nullopt),
+      callsite_model_cache_size_(0),
+      memory_budget_in_gb_(std::nullopt),
+      maximum_types_memory_in_mb_(std::nullopt),
+      fixpoint_deadline_in_seconds_(std::nullopt),
+      checkpoint_interval_(std::nullopt),
+      resume_from_(std::nullopt),
+      write_library_summary_(false),
+      write_configuration_bundle_(false),
+      configuration_bundle_path_(std::nullopt),
+      prune_dead_registers_(false),
+      thin_exception_edges_(false),
+      slab_allocate_models_(false),
+      scope_highlights_to_issues_(false),
+      prune_unreachable_sources_(false),
+      widening_delay_(1),
       maximum_source_sink_distance_(10),
+      maximum_origins_(std::nullopt),
       dump_class_hierarchies_(false),
       dump_overrides_(false),
       dump_call_graph_(false),
       dump_dependencies_(false),
-      dump_methods_(false) {}
+      dump_methods_(false),
+      dump_binary_models_(false),
+      compress_models_(false),
+      model_output_threads_(2),
+      sync_models_(false),
+      skip_default_models_(false),
+      profile_analysis_(false),
+      worker_timeline_interval_in_milliseconds_(std::nullopt),
+      convergence_report_(false),
+      kind_costs_(false),
+      estimate_only_(false),
+      trace_phases_(false),
+      performance_counters_(false),
+      server_(false),
+      batch_path_(std::nullopt) {}
 
 Options::Options(const boost::program_options::variables_map& variables) {
   system_jar_paths_ = parse_paths_list(
@@ -144,6 +261,9 @@ Options::Options(const boost::program_options::variables_map& variables) {
   }
   rules_paths_ = parse_paths_list(
       variables["rules-paths"].as<std::string>(), /* extension */ ".json");
+  if (!variables["rule-packs"].empty()) {
+    rule_packs_ = parse_rule_packs(variables["rule-packs"].as<std::string>());
+  }
 
   if (!variables["lifecycles-paths"].empty()) {
     lifecycles_paths_ = parse_paths_list(
@@ -185,10 +305,64 @@ Options::Options(const boost::program_options::variables_map& variables) {
   }
 
   apk_path_ = check_path_exists(variables["apk-path"].as<std::string>());
-  output_directory_ = boost::filesystem::path(
+  // Outputs can be written while the source index changes the working
+  // directory, hence the output directory must be absolute.
+  output_directory_ = boost::filesystem::absolute(
       check_directory_exists(variables["output-directory"].as<std::string>()));
+  if (!variables["previous-output-directory"].empty()) {
+    previous_output_directory_ = check_directory_exists(
+        variables["previous-output-directory"].as<std::string>());
+  }
+  if (!variables["types-cache-path"].empty()) {
+    types_cache_path_ = variables["types-cache-path"].as<std::string>();
+  }
+  if (!variables["source-index-cache-path"].empty()) {
+    source_index_cache_path_ =
+        variables["source-index-cache-path"].as<std::string>();
+  }
+  if (!variables["reachability-cache-path"].empty()) {
+    reachability_cache_path_ =
+        variables["reachability-cache-path"].as<std::string>();
+  }
+  if (!variables["artifact-cache"].empty()) {
+    artifact_cache_ = variables["artifact-cache"].as<std::string>();
+  }
+  if (!variables["artifact-cache-fetch-key"].empty()) {
+    artifact_cache_fetch_key_ =
+        variables["artifact-cache-fetch-key"].as<std::string>();
+  }
+  if (!variables["artifact-cache-store-key"].empty()) {
+    artifact_cache_store_key_ =
+        variables["artifact-cache-store-key"].as<std::string>();
+  }
+  if ((artifact_cache_fetch_key_ || artifact_cache_store_key_) &&
+      !artifact_cache_) {
+    throw std::invalid_argument(
+        "`--artifact-cache-fetch-key` and `--artifact-cache-store-key` require `--artifact-cache`.");
+  }
+  if (!variables["heuristics-path"].empty()) {
+    heuristics_path_ =
+        check_path_exists(variables["heuristics-path"].as<std::string>());
+  }
+  if (!variables["cost-profile-path"].empty()) {
+    cost_profile_path_ =
+        check_path_exists(variables["cost-profile-path"].as<std::string>());
+  }
 
   sequential_ = variables.count("sequential") > 0;
+  if (!variables["jobs"].empty()) {
+    jobs_ = variables["jobs"].as<unsigned int>();
+    if (*jobs_ == 0) {
+      throw std::invalid_argument("`--jobs` must be strictly positive.");
+    }
+  }
+  if (!variables["phase-jobs"].empty()) {
+    for (const auto& value :
+         variables["phase-jobs"].as<std::vector<std::string>>()) {
+      auto [phase, jobs] = parse_phase_jobs(value);
+      phase_jobs_[phase] = jobs;
+    }
+  }
   skip_source_indexing_ = variables.count("skip-source-indexing") > 0;
   skip_model_generation_ = variables.count("skip-model-generation") > 0;
   disable_parameter_type_overrides_ =
@@ -200,17 +374,196 @@ Options::Options(const boost::program_options::variables_map& variables) {
       ? std::nullopt
       : static_cast<std::optional<int>>(
             variables["maximum-method-analysis-time"].as<int>());
+  worklist_fixpoint_ = variables.count("worklist-fixpoint") > 0;
+  scc_local_fixpoint_ = variables.count("scc-local-fixpoint") > 0;
+  deduplicate_methods_ = variables.count("deduplicate-methods") > 0;
+  summarize_trivial_methods_ =
+      variables.count("summarize-trivial-methods") > 0;
+  demand_driven_analysis_ = variables.count("demand-driven-analysis") > 0;
+  entry_point_reachability_ = variables.count("entry-point-reachability") > 0;
+  spill_cold_models_ = variables.count("spill-cold-models") > 0;
+  release_converged_methods_ =
+      variables.count("release-converged-methods") > 0;
+  numa_aware_scheduling_ = variables.count("numa-aware-scheduling") > 0;
+  disable_issue_stream_ = variables.count("disable-issue-stream") > 0;
+  if (!variables["partition-count"].empty()) {
+    partition_count_ = variables["partition-count"].as<std::size_t>();
+    if (*partition_count_ == 0) {
+      throw std::invalid_argument(
+          "`--partition-count` must be strictly positive.");
+    }
+    if (variables["partition-directory"].empty()) {
+      throw std::invalid_argument(
+          "`--partition-count` requires `--partition-directory`.");
+    }
+    partition_directory_ = check_directory_exists(
+        variables["partition-directory"].as<std::string>());
+  }
+  if (!variables["partition-index"].empty()) {
+    partition_index_ = variables["partition-index"].as<std::size_t>();
+    if (partition_index_ >= partition_count_.value_or(1)) {
+      throw std::invalid_argument(
+          "`--partition-index` must be smaller than `--partition-count`.");
+    }
+  }
+  if (!variables["entry-point-pattern"].empty()) {
+    entry_point_patterns_ =
+        variables["entry-point-pattern"].as<std::vector<std::string>>();
+  }
+  callsite_model_cache_size_ =
+      variables.count("callsite-model-cache-size") == 0
+      ? 0
+      : variables["callsite-model-cache-size"].as<std::size_t>();
+  if (!variables["memory-budget-in-gb"].empty()) {
+    memory_budget_in_gb_ = variables["memory-budget-in-gb"].as<double>();
+  }
+  if (!variables["maximum-types-memory-in-mb"].empty()) {
+    maximum_types_memory_in_mb_ =
+        variables["maximum-types-memory-in-mb"].as<std::size_t>();
+  }
+  if (!variables["fixpoint-deadline-in-seconds"].empty()) {
+    fixpoint_deadline_in_seconds_ =
+        variables["fixpoint-deadline-in-seconds"].as<int>();
+  }
+  if (!variables["checkpoint-interval"].empty()) {
+    checkpoint_interval_ = variables["checkpoint-interval"].as<std::size_t>();
+    if (*checkpoint_interval_ == 0) {
+      throw std::invalid_argument(
+          "`--checkpoint-interval` must be strictly positive.");
+    }
+  }
+  if (!variables["resume-from"].empty()) {
+    resume_from_ =
+        check_path_exists(variables["resume-from"].as<std::string>());
+  }
+  write_library_summary_ = variables.count("write-library-summary") > 0;
+  if (release_converged_methods_ && write_library_summary_) {
+    // Library summaries hash the control flow graphs of all methods.
+    throw std::invalid_argument(
+        "`--release-converged-methods` cannot be used with `--write-library-summary`.");
+  }
+  if (!variables["library-summary-paths"].empty()) {
+    library_summary_paths_ = parse_paths_list(
+        variables["library-summary-paths"].as<std::string>(),
+        /* extension */ ".bin");
+  }
+  write_configuration_bundle_ =
+      variables.count("write-configuration-bundle") > 0;
+  if (!variables["configuration-bundle-path"].empty()) {
+    configuration_bundle_path_ = check_path_exists(
+        variables["configuration-bundle-path"].as<std::string>());
+  }
+  prune_dead_registers_ = variables.count("prune-dead-registers") > 0;
+  thin_exception_edges_ = variables.count("thin-exception-edges") > 0;
+  slab_allocate_models_ = variables.count("slab-allocate-models") > 0;
+  scope_highlights_to_issues_ =
+      variables.count("scope-highlights-to-issues") > 0;
+  prune_unreachable_sources_ =
+      variables.count("prune-unreachable-sources") > 0;
+  widening_delay_ = variables.count("widening-delay") == 0
+      ? 1
+      : variables["widening-delay"].as<std::size_t>();
   maximum_source_sink_distance_ =
       variables["maximum-source-sink-distance"].as<int>();
+  if (!variables["maximum-origins"].empty()) {
+    maximum_origins_ = variables["maximum-origins"].as<std::size_t>();
+  }
 
   if (!variables["log-method"].empty()) {
     log_methods_ = variables["log-method"].as<std::vector<std::string>>();
   }
+  if (!variables["structured-log-path"].empty()) {
+    structured_log_path_ = variables["structured-log-path"].as<std::string>();
+  }
   dump_class_hierarchies_ = variables.count("dump-class-hierarchies") > 0;
   dump_overrides_ = variables.count("dump-overrides") > 0;
   dump_call_graph_ = variables.count("dump-call-graph") > 0;
   dump_dependencies_ = variables.count("dump-dependencies") > 0;
   dump_methods_ = variables.count("dump-methods") > 0;
+  dump_binary_models_ = variables.count("dump-binary-models") > 0;
+  compress_models_ = variables.count("compress-models") > 0;
+  model_output_threads_ = variables.count("model-output-threads") == 0
+      ? 2
+      : variables["model-output-threads"].as<unsigned int>();
+  if (model_output_threads_ == 0) {
+    throw std::invalid_argument(
+        "`--model-output-threads` must be strictly positive.");
+  }
+  sync_models_ = variables.count("sync-models") > 0;
+  skip_default_models_ = variables.count("skip-default-models") > 0;
+  profile_analysis_ = variables.count("profile-analysis") > 0;
+  if (!variables["worker-timeline-interval-in-milliseconds"].empty()) {
+    worker_timeline_interval_in_milliseconds_ =
+        variables["worker-timeline-interval-in-milliseconds"].as<int>();
+  }
+  convergence_report_ = variables.count("convergence-report") > 0;
+  kind_costs_ = variables.count("kind-costs") > 0;
+  estimate_only_ = variables.count("estimate-only") > 0;
+  trace_phases_ = variables.count("trace-phases") > 0;
+  performance_counters_ = variables.count("performance-counters") > 0;
+  server_ = variables.count("server") > 0;
+  if (!variables["batch-path"].empty()) {
+    batch_path_ = check_path_exists(variables["batch-path"].as<std::string>());
+    if (server_) {
+      throw std::invalid_argument(
+          "`--batch-path` cannot be used with `--server`.");
+    }
+    if (artifact_cache_) {
+      throw std::invalid_argument(
+          "`--batch-path` cannot be used with `--artifact-cache`.");
+    }
+  }
+}
+
+void Options::update_from_request(const Json::Value& request) {
+  auto paths = [&](const std::string& field) {
+    std::vector<std::string> paths;
+    for (const auto& path : JsonValidation::null_or_array(request, field)) {
+      paths.push_back(JsonValidation::string(path));
+    }
+    return parse_paths_list(
+        boost::join(paths, ","), /* extension */ ".json");
+  };
+
+  if (request.isMember("models_paths")) {
+    models_paths_ = paths("models_paths");
+  }
+  if (request.isMember("rules_paths")) {
+    rules_paths_ = paths("rules_paths");
+  }
+  if (request.isMember("model_generator_configuration_paths")) {
+    generator_configuration_paths_ =
+        paths("model_generator_configuration_paths");
+    model_generators_configuration_ =
+        parse_json_configuration_files(generator_configuration_paths_);
+  }
+  if (request.isMember("output_directory")) {
+    output_directory_ = boost::filesystem::absolute(check_directory_exists(
+        JsonValidation::string(request, /* field */ "output_directory")));
+  }
+}
+
+void Options::update_from_batch_entry(const Json::Value& entry) {
+  JsonValidation::validate_object(entry);
+  apk_path_ =
+      check_path_exists(JsonValidation::string(entry, /* field */ "apk_path"));
+  apk_directory_ = check_directory_exists(
+      JsonValidation::string(entry, /* field */ "apk_directory"));
+  dex_directory_ = check_directory_exists(
+      JsonValidation::string(entry, /* field */ "dex_directory"));
+  // Each application must be written in its own directory.
+  JsonValidation::string(entry, /* field */ "output_directory");
+  update_from_request(entry);
+}
+
+void Options::use_previous_state(const boost::filesystem::path& directory) {
+  if (!previous_output_directory_) {
+    previous_output_directory_ = directory.native();
+  }
+  auto types_cache = directory / "types_cache.json";
+  if (!types_cache_path_ && boost::filesystem::exists(types_cache)) {
+    types_cache_path_ = types_cache.native();
+  }
 }
 
 void Options::add_options(
@@ -236,6 +589,10 @@ void Options::add_options(
       "rules-paths",
       program_options::value<std::string>()->required(),
       "A `;` separated list of rules files and directories containing rules files.");
+  options.add_options()(
+      "rule-packs",
+      program_options::value<std::string>(),
+      "A `;` separated list of named rule packs `name=paths`, where `paths` is a `,` separated list of rules files and directories containing rules files. Rules of all packs are checked in the same analysis, and the issues of each pack are also written to `issues@<name>.json` in the output directory.");
   options.add_options()(
       "proguard-configuration-paths",
       program_options::value<std::string>(),
@@ -278,9 +635,53 @@ void Options::add_options(
       "output-directory",
       program_options::value<std::string>()->required(),
       "Directory to write results in.");
+  options.add_options()(
+      "previous-output-directory",
+      program_options::value<std::string>(),
+      "Output directory of a previous run. Models of methods that did not change are reused instead of being analyzed again.");
+  options.add_options()(
+      "types-cache-path",
+      program_options::value<std::string>(),
+      "Path to a cache of inferred types. Types of methods whose code did not change are read from the cache, and the cache is updated after the analysis. With `--previous-output-directory`, the global type analysis only runs on classes around the changed code.");
+  options.add_options()(
+      "source-index-cache-path",
+      program_options::value<std::string>(),
+      "Path to a cache of the source index. Files whose size and modification time did not change are not read again, and the cache is updated after indexing.");
+  options.add_options()(
+      "reachability-cache-path",
+      program_options::value<std::string>(),
+      "Path to a cache of the symbols removed by `--remove-unreachable-code`. If the apk, proguard configurations and system jars did not change, the symbols are removed without computing reachability again, and the cache is updated otherwise.");
+  options.add_options()(
+      "artifact-cache",
+      program_options::value<std::string>(),
+      "Location of a content-addressed cache of the state of runs (fingerprints, models, types cache, library summary), shared between machines: a directory, or `command:<program>` to fetch and store entries with an external program (e.g for HTTP or object storage), called as `<program> fetch|store|contains <name> [<path>]`.");
+  options.add_options()(
+      "artifact-cache-fetch-key",
+      program_options::value<std::string>(),
+      "Key of a previous run in `--artifact-cache` (e.g the base revision of the application). Its state is fetched before the analysis and used as `--previous-output-directory` and `--types-cache-path`, unless given. The analysis starts from scratch if the key is missing.");
+  options.add_options()(
+      "artifact-cache-store-key",
+      program_options::value<std::string>(),
+      "Key to store the state of this run under in `--artifact-cache`, after the analysis.");
+  options.add_options()(
+      "heuristics-path",
+      program_options::value<std::string>(),
+      "Path to a json file overriding analysis heuristics (e.g the maximum number of leaves of model trees), globally or for specific methods and classes.");
+  options.add_options()(
+      "cost-profile-path",
+      program_options::value<std::string>(),
+      "Path to the `analysis_costs.csv` of a previous run. The analysis of methods that were slow in that run is started first.");
 
   options.add_options()(
       "sequential", "Run the global fixpoint without parallelization.");
+  options.add_options()(
+      "jobs",
+      program_options::value<unsigned int>(),
+      "Number of threads of each parallel phase of the analysis. Defaults to the number of cores.");
+  options.add_options()(
+      "phase-jobs",
+      program_options::value<std::vector<std::string>>()->multitoken(),
+      "Number of threads of a given phase, overriding `--jobs`, e.g `positions=64`. Phases are `call-graph` (including life-cycle methods), `dependencies`, `model-generation`, `fixpoint`, `positions`, `postprocess-traces`, `models` (loading, spilling and writing models) and `highlights`. I/O bound phases may benefit from more threads than cores.");
   options.add_options()(
       "skip-source-indexing", "Skip indexing java source files.");
   options.add_options()(
@@ -294,17 +695,128 @@ void Options::add_options(
   options.add_options()(
       "maximum-method-analysis-time",
       program_options::value<int>(),
-      "Specify number of seconds as a bound. If the analysis of a method takes longer than this then make the method obscure (default taint-in-taint-out).");
+      "Specify number of seconds as a bound. If the analysis of a method takes longer than this then interrupt it and make the method obscure (default taint-in-taint-out).");
+  options.add_options()(
+      "worklist-fixpoint",
+      "Compute the global fixpoint with a continuous worklist instead of global iterations.");
+  options.add_options()(
+      "scc-local-fixpoint",
+      "Iterate each strongly connected component of the dependency graph to a local fixpoint before releasing its callers.");
+  options.add_options()(
+      "deduplicate-methods",
+      "Analyze methods with identical code and callees once per iteration, when their model does not depend on their positions, and reuse the model for the other methods.");
+  options.add_options()(
+      "summarize-trivial-methods",
+      "Build the models of methods without calls, writes or branches, such as getters and methods returning a constant, directly instead of running the fixpoint.");
+  options.add_options()(
+      "demand-driven-analysis",
+      "Only analyze methods that can contribute to an issue: methods that transitively call a source or a sink of a rule, and their callees. Other methods keep their initial model.");
+  options.add_options()(
+      "entry-point-reachability",
+      "Only analyze methods reachable from entry points: classes of the manifest, life-cycle wrappers, overrides of framework methods, static initializers and methods matching `--entry-point-pattern`.");
+  options.add_options()(
+      "entry-point-pattern",
+      program_options::value<std::vector<std::string>>()->multitoken(),
+      "Regular expression matching the signature of additional entry points for `--entry-point-reachability`, e.g methods called through reflection.");
+  options.add_options()(
+      "partition-count",
+      program_options::value<std::size_t>(),
+      "Distributed analysis: split the methods in the given number of partitions, and only analyze the partition `--partition-index`. Models of other partitions are read from and written to `--partition-directory`, see `scripts/distributed_analysis.py`.");
+  options.add_options()(
+      "partition-index",
+      program_options::value<std::size_t>(),
+      "Index of the partition analyzed by this process, see `--partition-count`.");
+  options.add_options()(
+      "partition-directory",
+      program_options::value<std::string>(),
+      "Directory shared by all partitions, where the models of each partition are exchanged.");
+  options.add_options()(
+      "spill-cold-models",
+      "During the global fixpoint, move the models of methods that will not be analyzed again to memory-mapped files in the output directory, to reduce memory usage. This has no effect with `--worklist-fixpoint`.");
+  options.add_options()(
+      "release-converged-methods",
+      "During the global fixpoint, free the control flow graphs, inferred types and call graph entries of methods that will not be analyzed again, to reduce memory usage. This has no effect with `--worklist-fixpoint`.");
+  options.add_options()(
+      "numa-aware-scheduling",
+      "Pin analysis workers to NUMA nodes and schedule strongly connected components on the node of their callees, so that models are mostly allocated and read on the same node. This has no effect on machines with a single node, or outside of Linux.");
+  options.add_options()(
+      "disable-issue-stream",
+      "Do not append issues to `issues_stream.json` in the output directory during the global fixpoint. Each line of the stream holds the issues of a method, with provisional positions, whenever they change.");
+  options.add_options()(
+      "callsite-model-cache-size",
+      program_options::value<std::size_t>(),
+      "Maximum number of callee models instantiated at call sites, and of joined models of virtual call sites, to cache across methods and iterations (default: disabled).");
+  options.add_options()(
+      "memory-budget-in-gb",
+      program_options::value<double>(),
+      "Approximate models more aggressively when the memory used by the analysis gets close to this limit, instead of running out of memory (default: disabled).");
+  options.add_options()(
+      "maximum-types-memory-in-mb",
+      program_options::value<std::size_t>(),
+      "Maximum memory used to keep inferred types. Types of the least recently queried methods are evicted and inferred again when needed (default: unbounded).");
+  options.add_options()(
+      "fixpoint-deadline-in-seconds",
+      program_options::value<int>(),
+      "Stop the global fixpoint after this number of seconds. Methods that were not analyzed are listed as imprecise in the metadata and the results are still exported (default: disabled).");
+  options.add_options()(
+      "checkpoint-interval",
+      program_options::value<std::size_t>(),
+      "Every given number of global iterations, write the models and the methods left to analyze to `checkpoint.bin` in the output directory, in the background (default: disabled).");
+  options.add_options()(
+      "resume-from",
+      program_options::value<std::string>(),
+      "Resume the global fixpoint from a checkpoint written with `--checkpoint-interval`, on the same program and with the same options.");
+  options.add_options()(
+      "write-library-summary",
+      "After the analysis, write the models of all methods with code to `library_summary.bin` in the output directory, to be loaded with `--library-summary-paths` when analyzing applications that contain the same libraries.");
+  options.add_options()(
+      "library-summary-paths",
+      program_options::value<std::string>(),
+      "A `;` separated list of library summaries written with `--write-library-summary`, and directories containing them. Methods of the summaries whose code did not change use the summarized model and are not analyzed.");
+  options.add_options()(
+      "write-configuration-bundle",
+      "Before the analysis, write the parsed rules, lifecycles, heuristics and model generators to `configuration_bundle.bin` in the output directory, to be loaded with `--configuration-bundle-path`.");
+  options.add_options()(
+      "configuration-bundle-path",
+      program_options::value<std::string>(),
+      "A configuration bundle written with `--write-configuration-bundle`. Bundled files that did not change are not parsed again, and model generator search paths are not listed again.");
+  options.add_options()(
+      "prune-dead-registers",
+      "Remove dead registers and unreachable memory locations from the environment at the end of each basic block, using a liveness analysis.");
+  options.add_options()(
+      "thin-exception-edges",
+      "Remove the exception edges of a block to a handler when the next block only has this block as predecessor, throws to the same handler and cannot remove taint that is live in the handler. This reduces joins in methods with large try blocks, at the cost of some precision.");
+  options.add_options()(
+      "slab-allocate-models",
+      "Allocate the models of the registry in per-thread slabs, so that the models of a strongly connected component are contiguous in memory and on the NUMA node of the worker that analyzed it. Memory of a slab is only reclaimed once all its models are replaced.");
+  options.add_options()(
+      "scope-highlights-to-issues",
+      "When adding highlights to positions, only augment the frames that are part of issue traces, found by following frames of issues through callee models. Other frames keep their positions without highlights.");
+  options.add_options()(
+      "prune-unreachable-sources",
+      "Before the analysis, remove the generations and parameter sources that cannot reach a sink of a matching rule within `--maximum-source-sink-distance` calls, using the dependency graph and the sinks of the models. This is conservative and does not remove issues, but sources that are removed are not exported in models.");
+  options.add_options()(
+      "widening-delay",
+      program_options::value<std::size_t>(),
+      "Number of iterations on the head of a loop that join environments before widening them (default: 1). Lower values converge faster on methods with many loops, at the cost of precision.");
 
   options.add_options()(
       "maximum-source-sink-distance",
       program_options::value<int>(),
       "Limits the distance of sources and sinks from a trace entry point.");
+  options.add_options()(
+      "maximum-origins",
+      program_options::value<std::size_t>(),
+      "Maximum number of origins per frame. Past this limit, the origins are summarized as a count and reported as `truncated_origins` in the output. By default, origins are not bounded.");
 
   options.add_options()(
       "log-method",
       program_options::value<std::vector<std::string>>()->multitoken(),
       "Enable logging for the given methods.");
+  options.add_options()(
+      "structured-log-path",
+      program_options::value<std::string>(),
+      "Also write log messages as json lines with their level, method and global iteration in the given file.");
   options.add_options()(
       "dump-class-hierarchies",
       "Dump the class hierarchies in `class_hierarchies.json`.");
@@ -316,6 +828,51 @@ void Options::add_options(
       "dump-dependencies", "Dump the dependency graph in `dependencies.json`.");
   options.add_options()(
       "dump-methods", "Dump the list of method signatures in `methods.json`.");
+  options.add_options()(
+      "dump-binary-models",
+      "Also write models in a compact binary format, in `model@*.bin`.");
+  options.add_options()(
+      "compress-models",
+      "Write models compressed with gzip, in `model@*.json.gz` instead of `model@*.json`.");
+  options.add_options()(
+      "model-output-threads",
+      program_options::value<unsigned int>(),
+      "Number of threads writing json model shards (default: 2). Models are serialized by the analysis threads into a bounded pool of buffers, which these threads write to disk in parallel with the serialization.");
+  options.add_options()(
+      "sync-models",
+      "Call `fsync` on each json model shard once written, so that models are on disk when the analysis exits.");
+  options.add_options()(
+      "skip-default-models",
+      "Do not write models that are identical to the default model of their method, e.g methods without taint.");
+  options.add_options()(
+      "profile-analysis",
+      "Profile the analysis of each method, per transfer function, and write a report in `profile.json`.");
+  options.add_options()(
+      "worker-timeline-interval-in-milliseconds",
+      program_options::value<int>(),
+      "Sample the method analyzed by each worker of the global fixpoint at this interval and write a timeline in `worker_timeline.json`, in the Chrome trace event format (e.g 100, default: disabled).");
+  options.add_options()(
+      "convergence-report",
+      "Record the methods whose model changed at each global iteration and which parts of their models grew (e.g generation kinds, sink ports, features, origins), and write a report in `convergence_report.json`.");
+  options.add_options()(
+      "kind-costs",
+      "Record, for each taint kind, the number and size of its frames in the final models, the time spent checking and propagating its taint, and the number of issues involving it, in the statistics of the metadata.");
+  options.add_options()(
+      "estimate-only",
+      "Stop before the global fixpoint, once the call graph, the dependencies and the analysis schedule are built, and write the predicted duration of the fixpoint and peak resident set size in `cost_estimate.json`, along with the method, component and call graph counts they are based on. Predicted durations use `--cost-profile-path` when given. No other output is written.");
+  options.add_options()(
+      "trace-phases",
+      "Record nested spans of the phases of the analysis with their wall time, thread and process CPU time and resident set size, and write them in `trace.json`, in the Chrome trace event format.");
+  options.add_options()(
+      "performance-counters",
+      "Record hardware performance counters (cycles, instructions, last level cache misses, data TLB misses) of the phases of the analysis and of the slowest method analyses, in the statistics of the metadata. This requires `perf_event_open` (Linux) and a permissive `perf_event_paranoid`.");
+  options.add_options()(
+      "server",
+      "Keep the application loaded after the analysis and read analysis requests from the standard input, one JSON object per line (see `Options::update_from_request`). Each request reloads the models, model generators and rules, analyzes the application again and writes a JSON response line on the standard output.");
+  options.add_options()(
+      "batch-path",
+      program_options::value<std::string>(),
+      "After the application given on the command line, analyze the applications of the given file, one JSON object per line with the keys `apk_path`, `apk_directory`, `dex_directory`, `output_directory` and the optional keys of `Options::update_from_batch_entry`. Parsed json configuration files (models, model generators, rules, lifecycles) are shared between the applications.");
 }
 
 const std::vector<std::string>& Options::models_paths() const {
@@ -335,6 +892,11 @@ const std::vector<std::string>& Options::rules_paths() const {
   return rules_paths_;
 }
 
+const std::map<std::string, std::vector<std::string>>& Options::rule_packs()
+    const {
+  return rule_packs_;
+}
+
 const std::vector<std::string>& Options::lifecycles_paths() const {
   return lifecycles_paths_;
 }
@@ -415,10 +977,118 @@ const boost::filesystem::path Options::dependencies_output_path() const {
   return output_directory_ / "dependencies.json";
 }
 
+const boost::filesystem::path Options::fingerprints_output_path() const {
+  return output_directory_ / "fingerprints.json";
+}
+
+const boost::filesystem::path Options::issues_stream_output_path() const {
+  return output_directory_ / "issues_stream.json";
+}
+
+const boost::filesystem::path Options::rule_pack_issues_output_path(
+    const std::string& pack) const {
+  return output_directory_ / fmt::format("issues@{}.json", pack);
+}
+
+const boost::filesystem::path Options::checkpoint_output_path() const {
+  return output_directory_ / "checkpoint.bin";
+}
+
+const boost::filesystem::path Options::library_summary_output_path() const {
+  return output_directory_ / "library_summary.bin";
+}
+
+const boost::filesystem::path Options::configuration_bundle_output_path()
+    const {
+  return output_directory_ / "configuration_bundle.bin";
+}
+
+const boost::filesystem::path Options::spilled_models_path() const {
+  return output_directory_ / "spilled_models";
+}
+
+const boost::filesystem::path Options::profile_output_path() const {
+  return output_directory_ / "profile.json";
+}
+
+const boost::filesystem::path Options::worker_timeline_output_path() const {
+  return output_directory_ / "worker_timeline.json";
+}
+
+const boost::filesystem::path Options::convergence_report_output_path() const {
+  return output_directory_ / "convergence_report.json";
+}
+
+const boost::filesystem::path Options::trace_output_path() const {
+  return output_directory_ / "trace.json";
+}
+
+const boost::filesystem::path Options::analysis_costs_output_path() const {
+  return output_directory_ / "analysis_costs.csv";
+}
+
+const boost::filesystem::path Options::cost_estimate_output_path() const {
+  return output_directory_ / "cost_estimate.json";
+}
+
+const boost::filesystem::path Options::previous_state_directory() const {
+  return output_directory_ / "previous_state";
+}
+
+const std::optional<std::string>& Options::previous_output_directory() const {
+  return previous_output_directory_;
+}
+
+const std::optional<std::string>& Options::types_cache_path() const {
+  return types_cache_path_;
+}
+
+const std::optional<std::string>& Options::source_index_cache_path() const {
+  return source_index_cache_path_;
+}
+
+const std::optional<std::string>& Options::reachability_cache_path() const {
+  return reachability_cache_path_;
+}
+
+const std::optional<std::string>& Options::artifact_cache() const {
+  return artifact_cache_;
+}
+
+const std::optional<std::string>& Options::artifact_cache_fetch_key() const {
+  return artifact_cache_fetch_key_;
+}
+
+const std::optional<std::string>& Options::artifact_cache_store_key() const {
+  return artifact_cache_store_key_;
+}
+
+const std::optional<std::string>& Options::heuristics_path() const {
+  return heuristics_path_;
+}
+
+const std::optional<std::string>& Options::cost_profile_path() const {
+  return cost_profile_path_;
+}
+
 bool Options::sequential() const {
   return sequential_;
 }
 
+std::optional<unsigned int> Options::jobs() const {
+  return jobs_;
+}
+
+unsigned int Options::jobs(AnalysisPhase phase) const {
+  if (phase == AnalysisPhase::Fixpoint && sequential_) {
+    return 1u;
+  }
+  if (auto found = phase_jobs_.find(phase); found != phase_jobs_.end()) {
+    return found->second;
+  }
+  return jobs_.value_or(sparta::parallel::default_num_threads());
+}
+
 bool Options::skip_source_indexing() const {
   return skip_source_indexing_;
 }
@@ -439,14 +1109,142 @@ std::optional<int> Options::maximum_method_analysis_time() const {
   return maximum_method_analysis_time_;
 }
 
+bool Options::worklist_fixpoint() const {
+  return worklist_fixpoint_;
+}
+
+bool Options::scc_local_fixpoint() const {
+  return scc_local_fixpoint_;
+}
+
+bool Options::deduplicate_methods() const {
+  return deduplicate_methods_;
+}
+
+bool Options::summarize_trivial_methods() const {
+  return summarize_trivial_methods_;
+}
+
+bool Options::demand_driven_analysis() const {
+  return demand_driven_analysis_;
+}
+
+bool Options::entry_point_reachability() const {
+  return entry_point_reachability_;
+}
+
+bool Options::spill_cold_models() const {
+  return spill_cold_models_;
+}
+
+bool Options::release_converged_methods() const {
+  return release_converged_methods_;
+}
+
+bool Options::numa_aware_scheduling() const {
+  return numa_aware_scheduling_;
+}
+
+bool Options::disable_issue_stream() const {
+  return disable_issue_stream_;
+}
+
+std::optional<std::size_t> Options::partition_count() const {
+  return partition_count_;
+}
+
+std::size_t Options::partition_index() const {
+  return partition_index_;
+}
+
+const std::optional<std::string>& Options::partition_directory() const {
+  return partition_directory_;
+}
+
+const std::vector<std::string>& Options::entry_point_patterns() const {
+  return entry_point_patterns_;
+}
+
+std::size_t Options::callsite_model_cache_size() const {
+  return callsite_model_cache_size_;
+}
+
+std::optional<double> Options::memory_budget_in_gb() const {
+  return memory_budget_in_gb_;
+}
+
+std::optional<std::size_t> Options::maximum_types_memory_in_mb() const {
+  return maximum_types_memory_in_mb_;
+}
+
+std::optional<int> Options::fixpoint_deadline_in_seconds() const {
+  return fixpoint_deadline_in_seconds_;
+}
+
+std::optional<std::size_t> Options::checkpoint_interval() const {
+  return checkpoint_interval_;
+}
+
+const std::optional<std::string>& Options::resume_from() const {
+  return resume_from_;
+}
+
+bool Options::write_library_summary() const {
+  return write_library_summary_;
+}
+
+const std::vector<std::string>& Options::library_summary_paths() const {
+  return library_summary_paths_;
+}
+
+bool Options::write_configuration_bundle() const {
+  return write_configuration_bundle_;
+}
+
+const std::optional<std::string>& Options::configuration_bundle_path() const {
+  return configuration_bundle_path_;
+}
+
+bool Options::prune_dead_registers() const {
+  return prune_dead_registers_;
+}
+
+bool Options::thin_exception_edges() const {
+  return thin_exception_edges_;
+}
+
+bool Options::slab_allocate_models() const {
+  return slab_allocate_models_;
+}
+
+bool Options::scope_highlights_to_issues() const {
+  return scope_highlights_to_issues_;
+}
+
+bool Options::prune_unreachable_sources() const {
+  return prune_unreachable_sources_;
+}
+
+std::size_t Options::widening_delay() const {
+  return widening_delay_;
+}
+
 int Options::maximum_source_sink_distance() const {
   return maximum_source_sink_distance_;
 }
 
+std::optional<std::size_t> Options::maximum_origins() const {
+  return maximum_origins_;
+}
+
 const std::vector<std::string>& Options::log_methods() const {
   return log_methods_;
 }
 
+const std::optional<std::string>& Options::structured_log_path() const {
+  return structured_log_path_;
+}
+
 bool Options::dump_class_hierarchies() const {
   return dump_class_hierarchies_;
 }
@@ -467,4 +1265,60 @@ bool Options::dump_methods() const {
   return dump_methods_;
 }
 
+bool Options::dump_binary_models() const {
+  return dump_binary_models_;
+}
+
+bool Options::compress_models() const {
+  return compress_models_;
+}
+
+unsigned int Options::model_output_threads() const {
+  return model_output_threads_;
+}
+
+bool Options::sync_models() const {
+  return sync_models_;
+}
+
+bool Options::skip_default_models() const {
+  return skip_default_models_;
+}
+
+bool Options::profile_analysis() const {
+  return profile_analysis_;
+}
+
+std::optional<int> Options::worker_timeline_interval_in_milliseconds() const {
+  return worker_timeline_interval_in_milliseconds_;
+}
+
+bool Options::convergence_report() const {
+  return convergence_report_;
+}
+
+bool Options::kind_costs() const {
+  return kind_costs_;
+}
+
+bool Options::estimate_only() const {
+  return estimate_only_;
+}
+
+bool Options::trace_phases() const {
+  return trace_phases_;
+}
+
+bool Options::performance_counters() const {
+  return performance_counters_;
+}
+
+bool Options::server() const {
+  return server_;
+}
+
+const std::optional<std::string>& Options::batch_path() const {
+  return batch_path_;
+}
+
 } // namespace marianatrench
@@ -7,8 +7,10 @@
 
 #pragma once
 
+#include <map>
 #include <optional>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include <boost/filesystem.hpp>
@@ -19,6 +21,21 @@
 
 namespace marianatrench {
 
+/**
+ * Phases of the analysis that can run with a different number of threads
+ * than `--jobs` (see `--phase-jobs`).
+ */
+enum class AnalysisPhase {
+  CallGraph,
+  Dependencies,
+  ModelGeneration,
+  Fixpoint,
+  Positions,
+  PostprocessTraces,
+  Models,
+  Highlights,
+};
+
 class Options final {
  public:
   explicit Options(
@@ -34,7 +51,8 @@ class Options final {
           model_generators_configuration,
       const std::vector<std::string>& model_generator_search_paths,
       bool remove_unreachable_code,
-      const std::string& source_root_directory = ".");
+      const std::string& source_root_directory = ".",
+      std::optional<unsigned int> jobs = std::nullopt);
   explicit Options(const boost::program_options::variables_map& variables);
   Options(const Options&) = delete;
   Options(Options&&) = delete;
@@ -44,11 +62,38 @@ class Options final {
 
   static void add_options(boost::program_options::options_description& options);
 
+  /**
+   * Update the options of an analysis request in server mode.
+   *
+   * The request is a JSON object with the optional keys `models_paths`,
+   * `rules_paths`, `model_generator_configuration_paths` (lists of paths) and
+   * `output_directory`. Options that are not in the request are unchanged.
+   */
+  void update_from_request(const Json::Value& request);
+
+  /**
+   * Update the options to analyze the next application of a batch (see
+   * `--batch-path`).
+   *
+   * The entry is a JSON object with the keys `apk_path`, `apk_directory`,
+   * `dex_directory` and `output_directory`, and the optional keys of
+   * `update_from_request`.
+   */
+  void update_from_batch_entry(const Json::Value& entry);
+
+  /**
+   * Use the state of a previous run fetched from the artifact cache into the
+   * given directory, as `--previous-output-directory` and as the types cache,
+   * unless they are given explicitly.
+   */
+  void use_previous_state(const boost::filesystem::path& directory);
+
   const std::vector<std::string>& models_paths() const;
   const std::vector<std::string>& field_models_paths() const;
   const std::vector<ModelGeneratorConfiguration>&
   model_generators_configuration() const;
   const std::vector<std::string>& rules_paths() const;
+  const std::map<std::string, std::vector<std::string>>& rule_packs() const;
   const std::vector<std::string>& lifecycles_paths() const;
   const std::vector<std::string>& proguard_configuration_paths() const;
   const std::optional<std::string>& generated_models_directory() const;
@@ -75,27 +120,107 @@ class Options final {
   const boost::filesystem::path class_hierarchies_output_path() const;
   const boost::filesystem::path overrides_output_path() const;
   const boost::filesystem::path dependencies_output_path() const;
+  const boost::filesystem::path fingerprints_output_path() const;
+  const boost::filesystem::path spilled_models_path() const;
+  const boost::filesystem::path issues_stream_output_path() const;
+  const boost::filesystem::path rule_pack_issues_output_path(
+      const std::string& pack) const;
+  const boost::filesystem::path checkpoint_output_path() const;
+  const boost::filesystem::path library_summary_output_path() const;
+  const boost::filesystem::path configuration_bundle_output_path() const;
+  const boost::filesystem::path profile_output_path() const;
+  const boost::filesystem::path worker_timeline_output_path() const;
+  const boost::filesystem::path convergence_report_output_path() const;
+  const boost::filesystem::path trace_output_path() const;
+  const boost::filesystem::path analysis_costs_output_path() const;
+  const boost::filesystem::path cost_estimate_output_path() const;
+  /* Directory to fetch the state of a previous run into. */
+  const boost::filesystem::path previous_state_directory() const;
+  const std::optional<std::string>& previous_output_directory() const;
+  const std::optional<std::string>& types_cache_path() const;
+  const std::optional<std::string>& source_index_cache_path() const;
+  const std::optional<std::string>& reachability_cache_path() const;
+  const std::optional<std::string>& artifact_cache() const;
+  const std::optional<std::string>& artifact_cache_fetch_key() const;
+  const std::optional<std::string>& artifact_cache_store_key() const;
+  const std::optional<std::string>& heuristics_path() const;
+  const std::optional<std::string>& cost_profile_path() const;
 
   bool sequential() const;
+  std::optional<unsigned int> jobs() const;
+
+  /**
+   * Number of threads of the given phase: its `--phase-jobs` if any, `--jobs`
+   * otherwise, defaulting to the number of cores. The global fixpoint always
+   * runs on a single thread with `--sequential`.
+   */
+  unsigned int jobs(AnalysisPhase phase) const;
   bool skip_source_indexing() const;
   bool skip_model_generation() const;
   bool disable_parameter_type_overrides() const;
   bool remove_unreachable_code() const;
   std::optional<int> maximum_method_analysis_time() const;
+  bool worklist_fixpoint() const;
+  bool scc_local_fixpoint() const;
+  bool deduplicate_methods() const;
+  bool summarize_trivial_methods() const;
+  bool demand_driven_analysis() const;
+  bool entry_point_reachability() const;
+  bool spill_cold_models() const;
+  bool release_converged_methods() const;
+  bool numa_aware_scheduling() const;
+  bool disable_issue_stream() const;
+  std::optional<std::size_t> partition_count() const;
+  std::size_t partition_index() const;
+  const std::optional<std::string>& partition_directory() const;
+  const std::vector<std::string>& entry_point_patterns() const;
+  std::size_t callsite_model_cache_size() const;
+  std::optional<double> memory_budget_in_gb() const;
+  std::optional<std::size_t> maximum_types_memory_in_mb() const;
+  std::optional<int> fixpoint_deadline_in_seconds() const;
+  std::optional<std::size_t> checkpoint_interval() const;
+  const std::optional<std::string>& resume_from() const;
+  bool write_library_summary() const;
+  const std::vector<std::string>& library_summary_paths() const;
+  bool write_configuration_bundle() const;
+  const std::optional<std::string>& configuration_bundle_path() const;
+  bool prune_dead_registers() const;
+  bool thin_exception_edges() const;
+  bool slab_allocate_models() const;
+  bool scope_highlights_to_issues() const;
+  bool prune_unreachable_sources() const;
+  std::size_t widening_delay() const;
 
   int maximum_source_sink_distance() const;
+  std::optional<std::size_t> maximum_origins() const;
 
   const std::vector<std::string>& log_methods() const;
+  const std::optional<std::string>& structured_log_path() const;
   bool dump_class_hierarchies() const;
   bool dump_overrides() const;
   bool dump_call_graph() const;
   bool dump_dependencies() const;
   bool dump_methods() const;
+  bool dump_binary_models() const;
+  bool compress_models() const;
+  unsigned int model_output_threads() const;
+  bool sync_models() const;
+  bool skip_default_models() const;
+  bool profile_analysis() const;
+  std::optional<int> worker_timeline_interval_in_milliseconds() const;
+  bool convergence_report() const;
+  bool kind_costs() const;
+  bool estimate_only() const;
+  bool trace_phases() const;
+  bool performance_counters() const;
+  bool server() const;
+  const std::optional<std::string>& batch_path() const;
 
  private:
   std::vector<std::string> models_paths_;
   std::vector<std::string> field_models_paths_;
   std::vector<std::string> rules_paths_;
+  std::map<std::string, std::vector<std::string>> rule_packs_;
   std::vector<std::string> lifecycles_paths_;
   std::vector<std::string> proguard_configuration_paths_;
 
@@ -115,22 +240,79 @@ class Options final {
 
   std::string apk_path_;
   boost::filesystem::path output_directory_;
+  std::optional<std::string> previous_output_directory_;
+  std::optional<std::string> types_cache_path_;
+  std::optional<std::string> source_index_cache_path_;
+  std::optional<std::string> reachability_cache_path_;
+  std::optional<std::string> artifact_cache_;
+  std::optional<std::string> artifact_cache_fetch_key_;
+  std::optional<std::string> artifact_cache_store_key_;
+  std::optional<std::string> heuristics_path_;
+  std::optional<std::string> cost_profile_path_;
 
   bool sequential_;
+  std::optional<unsigned int> jobs_;
+  std::unordered_map<AnalysisPhase, unsigned int> phase_jobs_;
   bool skip_source_indexing_;
   bool skip_model_generation_;
   bool remove_unreachable_code_;
   bool disable_parameter_type_overrides_;
   std::optional<int> maximum_method_analysis_time_;
+  bool worklist_fixpoint_;
+  bool scc_local_fixpoint_;
+  bool deduplicate_methods_;
+  bool summarize_trivial_methods_;
+  bool demand_driven_analysis_;
+  bool entry_point_reachability_;
+  bool spill_cold_models_;
+  bool release_converged_methods_;
+  bool numa_aware_scheduling_;
+  bool disable_issue_stream_;
+  std::optional<std::size_t> partition_count_;
+  std::size_t partition_index_;
+  std::optional<std::string> partition_directory_;
+  std::vector<std::string> entry_point_patterns_;
+  std::size_t callsite_model_cache_size_;
+  std::optional<double> memory_budget_in_gb_;
+  std::optional<std::size_t> maximum_types_memory_in_mb_;
+  std::optional<int> fixpoint_deadline_in_seconds_;
+  std::optional<std::size_t> checkpoint_interval_;
+  std::optional<std::string> resume_from_;
+  bool write_library_summary_;
+  std::vector<std::string> library_summary_paths_;
+  bool write_configuration_bundle_;
+  std::optional<std::string> configuration_bundle_path_;
+  bool prune_dead_registers_;
+  bool thin_exception_edges_;
+  bool slab_allocate_models_;
+  bool scope_highlights_to_issues_;
+  bool prune_unreachable_sources_;
+  std::size_t widening_delay_;
 
   int maximum_source_sink_distance_;
+  std::optional<std::size_t> maximum_origins_;
 
   std::vector<std::string> log_methods_;
+  std::optional<std::string> structured_log_path_;
   bool dump_class_hierarchies_;
   bool dump_overrides_;
   bool dump_call_graph_;
   bool dump_dependencies_;
   bool dump_methods_;
+  bool dump_binary_models_;
+  bool compress_models_;
+  unsigned int model_output_threads_;
+  bool sync_models_;
+  bool skip_default_models_;
+  bool profile_analysis_;
+  std::optional<int> worker_timeline_interval_in_milliseconds_;
+  bool convergence_report_;
+  bool kind_costs_;
+  bool estimate_only_;
+  bool trace_phases_;
+  bool performance_counters_;
+  bool server_;
+  std::optional<std::string> batch_path_;
 };
 
 } // namespace marianatrench
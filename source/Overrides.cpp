@@ -5,9 +5,12 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <algorithm>
+#include <map>
 #include <memory>
 #include <vector>
 
+#include <DexUtil.h>
 #include <MethodOverrideGraph.h>
 #include <Show.h>
 #include <Walkers.h>
@@ -23,28 +26,59 @@ namespace marianatrench {
 Overrides::Overrides(
     const Options& options,
     const Methods& method_factory,
-    const DexStoresVector& stores) {
-  // Compute overrides.
-  std::vector<std::unique_ptr<const method_override_graph::Graph>>
-      method_override_graphs;
-  for (const auto& scope : DexStoreClassesIterator(stores)) {
-    method_override_graphs.push_back(method_override_graph::build_graph(scope));
-  }
+    const DexStoresVector& stores)
+    : methods_(method_factory) {
+  // Compute overrides on a single graph merged across all stores.
+  Scope scope = build_class_scope(stores);
+  auto graph = method_override_graph::build_graph(scope);
+
+  // Overrides of each method, sorted by identifier. Each method is visited
+  // once, hence threads never write the same entry.
+  std::vector<std::vector<const Method*>> method_overrides(
+      method_factory.size());
+  walk::parallel::methods(scope, [&](const DexMethod* dex_method) {
+    auto overrides = method_override_graph::get_overriding_methods(
+        *graph, dex_method, /* include_interfaces */ true);
+    if (overrides.empty()) {
+      return;
+    }
+
+    const auto* method = method_factory.get(dex_method);
+    auto& sorted_overrides = method_overrides.at(method->id());
+    sorted_overrides.reserve(overrides.size());
+    for (const auto* override : overrides) {
+      sorted_overrides.push_back(method_factory.get(override));
+    }
+    std::sort(
+        sorted_overrides.begin(),
+        sorted_overrides.end(),
+        [](const Method* left, const Method* right) {
+          return left->id() < right->id();
+        });
+    sorted_overrides.erase(
+        std::unique(sorted_overrides.begin(), sorted_overrides.end()),
+        sorted_overrides.end());
+  });
+  graph = nullptr;
 
-  // Record overrides.
-  for (const auto& scope : DexStoreClassesIterator(stores)) {
-    walk::parallel::methods(scope, [&](const DexMethod* dex_method) {
-      std::unordered_set<const Method*> method_overrides;
-      for (const auto& graph : method_override_graphs) {
-        auto overrides_in_scope = method_override_graph::get_overriding_methods(
-            *graph, dex_method, /* include_interfaces */ true);
-        for (const auto* override : overrides_in_scope) {
-          method_overrides.insert(method_factory.get(override));
-        }
-      }
-
-      set(method_factory.get(dex_method), std::move(method_overrides));
-    });
+  // Record overrides, sharing identical sets.
+  std::map<
+      std::vector<const Method*>,
+      std::shared_ptr<const std::unordered_set<const Method*>>>
+      shared_overrides;
+  for (std::size_t id = 0; id < method_overrides.size(); id++) {
+    auto& overrides = method_overrides[id];
+    if (overrides.empty()) {
+      continue;
+    }
+
+    auto [iterator, inserted] =
+        shared_overrides.try_emplace(std::move(overrides), nullptr);
+    if (inserted) {
+      iterator->second = std::make_shared<std::unordered_set<const Method*>>(
+          iterator->first.begin(), iterator->first.end());
+    }
+    overrides_.set(id, iterator->second);
   }
 
   if (options.dump_overrides()) {
@@ -56,7 +90,8 @@ Overrides::Overrides(
 
 const std::unordered_set<const Method*>& Overrides::get(
     const Method* method) const {
-  auto* overrides = overrides_.get(method, /* default */ nullptr);
+  // The set is owned by `overrides_` until it is replaced by `set`.
+  auto overrides = overrides_.get(method->id());
   if (overrides != nullptr) {
     return *overrides;
   } else {
@@ -68,25 +103,56 @@ void Overrides::set(
     const Method* method,
     std::unordered_set<const Method*> overrides) {
   if (overrides.empty()) {
-    mt_assert(overrides_.get(method, /* default */ nullptr) == nullptr);
+    mt_assert(overrides_.get(method->id()) == nullptr);
     return;
   }
 
-  overrides_.emplace(
-      method,
-      std::make_unique<std::unordered_set<const Method*>>(
+  overrides_.set(
+      method->id(),
+      std::make_shared<std::unordered_set<const Method*>>(
           std::move(overrides)));
+  // Filtered overrides of the given method are out of date.
+  filtered_overrides_.clear();
+}
+
+const std::vector<const Method*>& Overrides::get_filtered(
+    const Method* method,
+    const ClassHierarchies::TypeSet* MT_NULLABLE receiver_extends) const {
+  auto key = FilteredKey(method, receiver_extends);
+  if (auto filtered = filtered_overrides_.get(key, nullptr)) {
+    return *filtered;
+  }
+
+  auto filtered = std::make_shared<std::vector<const Method*>>();
+  for (const auto* override : get(method)) {
+    if (receiver_extends == nullptr ||
+        receiver_extends->contains(override->get_class())) {
+      filtered->push_back(override);
+    }
+  }
+  // Another thread might have inserted the same result concurrently, use the
+  // one that is stored.
+  filtered_overrides_.emplace(key, std::move(filtered));
+  return *filtered_overrides_.get(key, nullptr);
 }
 
 const std::unordered_set<const Method*>& Overrides::empty_method_set() const {
   return empty_method_set_;
 }
 
+const std::vector<const Method*>& Overrides::empty_method_list() const {
+  return empty_method_list_;
+}
+
 Json::Value Overrides::to_json() const {
   auto value = Json::Value(Json::objectValue);
-  for (auto [method, overrides] : overrides_) {
+  for (const auto* method : methods_) {
+    const auto& overrides = get(method);
+    if (overrides.empty()) {
+      continue;
+    }
     auto overrides_value = Json::Value(Json::arrayValue);
-    for (const auto* override : *overrides) {
+    for (const auto* override : overrides) {
       overrides_value.append(Json::Value(show(override)));
     }
     value[method->show()] = overrides_value;
@@ -7,18 +7,32 @@
 
 #pragma once
 
+#include <memory>
 #include <unordered_set>
+#include <utility>
+#include <vector>
 
+#include <boost/functional/hash.hpp>
 #include <json/json.h>
 
+#include <ConcurrentContainers.h>
 #include <DexStore.h>
 
+#include <mariana-trench/ClassHierarchies.h>
 #include <mariana-trench/Method.h>
 #include <mariana-trench/Options.h>
-#include <mariana-trench/UniquePointerConcurrentMap.h>
+#include <mariana-trench/SnapshotArray.h>
 
 namespace marianatrench {
 
+/**
+ * Mapping from a method to the set of methods overriding it.
+ *
+ * Override sets are stored in an array indexed by `Method::id`, and only
+ * methods with overrides have an entry. Methods with identical override sets
+ * (for instance, a method and the interface methods it implements) share the
+ * same set.
+ */
 class Overrides final {
  public:
   explicit Overrides(
@@ -41,18 +55,39 @@ class Overrides final {
    * Set the override set of the given method.
    *
    * This is thread-safe if no other thread holds a reference on the override
-   * set of the given method.
+   * set of the given method, or on filtered overrides (see `get_filtered`).
    */
   void set(const Method* method, std::unordered_set<const Method*> overrides);
 
   const std::unordered_set<const Method*>& empty_method_set() const;
 
+  const std::vector<const Method*>& empty_method_list() const;
+
+  /**
+   * Return the methods overriding the given method that are defined in a class
+   * of `receiver_extends`, or all overriding methods if `receiver_extends` is
+   * null. Results are memoized, hence this is cheap for call sites that are
+   * resolved repeatedly. This is thread-safe.
+   */
+  const std::vector<const Method*>& get_filtered(
+      const Method* method,
+      const ClassHierarchies::TypeSet* MT_NULLABLE receiver_extends) const;
+
   Json::Value to_json() const;
 
  private:
-  UniquePointerConcurrentMap<const Method*, std::unordered_set<const Method*>>
-      overrides_;
+  const Methods& methods_;
+  SnapshotArray<std::unordered_set<const Method*>> overrides_;
   std::unordered_set<const Method*> empty_method_set_;
+  std::vector<const Method*> empty_method_list_;
+
+  using FilteredKey =
+      std::pair<const Method*, const ClassHierarchies::TypeSet*>;
+  mutable ConcurrentMap<
+      FilteredKey,
+      std::shared_ptr<const std::vector<const Method*>>,
+      boost::hash<FilteredKey>>
+      filtered_overrides_;
 };
 
 } // namespace marianatrench
@@ -0,0 +1,194 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <stdexcept>
+#include <string_view>
+
+#include <boost/filesystem/operations.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+#include <fmt/format.h>
+
+#include <mariana-trench/BinaryJson.h>
+#include <mariana-trench/JsonValidation.h>
+#include <mariana-trench/Log.h>
+#include <mariana-trench/Partitions.h>
+
+namespace marianatrench {
+
+namespace {
+
+/**
+ * A partition may exceed its share of the total cost by this factor to keep
+ * a component next to its callees.
+ */
+constexpr double k_balance_slack = 1.1;
+
+} // namespace
+
+Partitions::Partitions(
+    const Methods& methods,
+    const Scheduler& scheduler,
+    std::size_t count,
+    std::size_t index)
+    : count_(count), index_(index), partitions_(methods.size(), 0) {
+  if (count_ == 0 || index_ >= count_) {
+    throw std::invalid_argument(fmt::format(
+        "Invalid partition {} out of {} partitions.", index_, count_));
+  }
+
+  const auto& components =
+      scheduler.strongly_connected_components().components();
+  auto component_partitions = assign_components(scheduler, count_);
+  double local_cost = 0.0;
+  double total_cost = 0.0;
+  for (std::size_t component = 0; component < components.size();
+       component++) {
+    for (const auto* method : components[component]) {
+      partitions_[method->id()] = component_partitions[component];
+      auto cost = scheduler.estimated_cost(method);
+      total_cost += cost;
+      if (component_partitions[component] == index_) {
+        local_cost += cost;
+      }
+    }
+  }
+
+  LOG(1,
+      "Partition {} out of {} has an estimated cost of {:.2f}s out of {:.2f}s.",
+      index_,
+      count_,
+      local_cost,
+      total_cost);
+}
+
+std::vector<std::size_t> Partitions::assign_components(
+    const Scheduler& scheduler,
+    std::size_t count) {
+  const auto& strongly_connected_components =
+      scheduler.strongly_connected_components();
+  const auto& components = strongly_connected_components.components();
+  std::vector<double> component_costs(components.size(), 0.0);
+  double total_cost = 0.0;
+  for (std::size_t component = 0; component < components.size();
+       component++) {
+    for (const auto* method : components[component]) {
+      component_costs[component] += scheduler.estimated_cost(method);
+    }
+    total_cost += component_costs[component];
+  }
+  auto capacity = total_cost / static_cast<double>(count) * k_balance_slack;
+
+  // Number of edges from each component to callees in each group.
+  std::vector<std::uint32_t> affinity(components.size() * count, 0);
+  std::vector<double> loads(count, 0.0);
+  std::vector<std::size_t> groups(components.size(), 0);
+  for (std::size_t component = 0; component < components.size();
+       component++) {
+    const auto* component_affinity = affinity.data() + component * count;
+    auto least_loaded = static_cast<std::size_t>(
+        std::min_element(loads.begin(), loads.end()) - loads.begin());
+    auto closest = static_cast<std::size_t>(
+        std::max_element(component_affinity, component_affinity + count) -
+        component_affinity);
+    auto group = least_loaded;
+    if (component_affinity[closest] > 0 &&
+        loads[closest] + component_costs[component] <= capacity) {
+      group = closest;
+    }
+
+    loads[group] += component_costs[component];
+    groups[component] = group;
+    for (auto dependent :
+         strongly_connected_components.dependent_components(component)) {
+      affinity[dependent * count + group]++;
+    }
+  }
+  return groups;
+}
+
+std::size_t Partitions::load_models(
+    Context& context,
+    Registry& registry,
+    const boost::filesystem::path& directory) const {
+  std::size_t loaded_models = 0;
+  for (std::size_t partition = 0; partition < count_; partition++) {
+    auto partition_path = path(directory, partition);
+    if (partition == index_ || !boost::filesystem::exists(partition_path) ||
+        boost::filesystem::file_size(partition_path) == 0) {
+      continue;
+    }
+
+    boost::iostreams::mapped_file_source file(partition_path);
+    BinaryJsonReader reader(std::string_view(file.data(), file.size()));
+    while (auto value = reader.next()) {
+      const Method* method = nullptr;
+      try {
+        method = Method::from_json((*value)["method"], context);
+      } catch (const JsonValidationError&) {
+        WARNING(
+            1,
+            "Unknown method in `{}`, partitions must be built from the same program.",
+            partition_path.native());
+        continue;
+      }
+      if (is_local(method)) {
+        continue;
+      }
+      registry.join_with(Model::from_json(method, *value, context));
+      loaded_models++;
+    }
+  }
+
+  LOG(1, "Loaded {} models of other partitions.", loaded_models);
+  return loaded_models;
+}
+
+void Partitions::write_models(
+    Context& context,
+    const Registry& registry,
+    const boost::filesystem::path& directory) const {
+  BinaryJsonWriter writer;
+  std::size_t written_models = 0;
+  for (const auto* method : *context.methods) {
+    if (is_local(method)) {
+      writer.add(registry.get_snapshot(method)->to_json(context));
+      written_models++;
+    }
+  }
+
+  // Write to a temporary file first, so that other workers never read a
+  // partial file.
+  auto partition_path = path(directory, index_);
+  auto temporary_path = partition_path;
+  temporary_path += ".tmp";
+  std::ofstream stream(
+      temporary_path.native(), std::ios_base::out | std::ios_base::binary);
+  if (!stream.is_open()) {
+    throw std::runtime_error(fmt::format(
+        "Unable to write partition models to `{}`.", temporary_path.native()));
+  }
+  writer.write(stream);
+  stream.close();
+  boost::filesystem::rename(temporary_path, partition_path);
+
+  LOG(1,
+      "Wrote {} models of partition {} to `{}`.",
+      written_models,
+      index_,
+      partition_path.native());
+}
+
+boost::filesystem::path Partitions::path(
+    const boost::filesystem::path& directory,
+    std::size_t partition) {
+  return directory / fmt::format("partition@{}.bin", partition);
+}
+
+} // namespace marianatrench
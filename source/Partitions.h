@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include <boost/filesystem/path.hpp>
+
+#include <mariana-trench/Context.h>
+#include <mariana-trench/Method.h>
+#include <mariana-trench/Methods.h>
+#include <mariana-trench/Registry.h>
+#include <mariana-trench/Scheduler.h>
+
+namespace marianatrench {
+
+/**
+ * A partition of the methods, for the distributed analysis (see
+ * `--partition-count`).
+ *
+ * Each worker process analyzes the methods of its partition, using the
+ * models of other partitions written by other workers in a shared directory
+ * during the previous round. A coordinator (see
+ * `scripts/distributed_analysis.py`) runs rounds until no partition changes.
+ *
+ * Strongly connected components are never split. They are assigned in
+ * reverse topological order to the partition containing most of their
+ * callees, unless it is full, in which case they go to the least loaded
+ * partition. Partitions are balanced on the estimated cost of their methods
+ * (see `Scheduler::estimated_cost`). Workers compute the same partition as
+ * long as they analyze the same program with the same options.
+ */
+class Partitions final {
+ public:
+  explicit Partitions(
+      const Methods& methods,
+      const Scheduler& scheduler,
+      std::size_t count,
+      std::size_t index);
+
+  Partitions(const Partitions&) = delete;
+  Partitions(Partitions&&) = delete;
+  Partitions& operator=(const Partitions&) = delete;
+  Partitions& operator=(Partitions&&) = delete;
+  ~Partitions() = default;
+
+  /**
+   * Return the partition of the given method. Methods created after the
+   * partition was computed belong to the first partition.
+   */
+  std::size_t partition(const Method* method) const {
+    return method->id() < partitions_.size() ? partitions_[method->id()] : 0;
+  }
+
+  /* Whether the method belongs to the partition of this worker. */
+  bool is_local(const Method* method) const {
+    return partition(method) == index_;
+  }
+
+  std::size_t count() const {
+    return count_;
+  }
+
+  std::size_t index() const {
+    return index_;
+  }
+
+  /**
+   * Assign each strongly connected component of the scheduler to one of
+   * `count` groups, with the strategy described above. Returns the group of
+   * each component, indexed like `StronglyConnectedComponents::components`.
+   */
+  static std::vector<std::size_t> assign_components(
+      const Scheduler& scheduler,
+      std::size_t count);
+
+  /**
+   * Join the models of other partitions found in the given directory into
+   * the registry. Returns the number of models loaded.
+   */
+  std::size_t load_models(
+      Context& context,
+      Registry& registry,
+      const boost::filesystem::path& directory) const;
+
+  /* Write the models of the local partition in the given directory. */
+  void write_models(
+      Context& context,
+      const Registry& registry,
+      const boost::filesystem::path& directory) const;
+
+ private:
+  static boost::filesystem::path path(
+      const boost::filesystem::path& directory,
+      std::size_t partition);
+
+ private:
+  std::size_t count_;
+  std::size_t index_;
+
+  // Indexed by method identifier (see `Method::id`).
+  std::vector<std::size_t> partitions_;
+};
+
+} // namespace marianatrench
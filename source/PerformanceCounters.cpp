@@ -0,0 +1,221 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <cstring>
+#include <utility>
+
+#if __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <mariana-trench/Assert.h>
+#include <mariana-trench/OperatingSystem.h>
+#include <mariana-trench/PerformanceCounters.h>
+#include <mariana-trench/Statistics.h>
+
+namespace marianatrench {
+
+namespace {
+
+constexpr int kNoDescriptor = -1;
+
+#if __linux__
+
+struct EventConfiguration {
+  std::uint32_t type;
+  std::uint64_t config;
+};
+
+EventConfiguration event_configuration(PerformanceCounters::Event event) {
+  switch (event) {
+    case PerformanceCounters::Event::Cycles:
+      return {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES};
+    case PerformanceCounters::Event::Instructions:
+      return {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS};
+    case PerformanceCounters::Event::LastLevelCacheMisses:
+      return {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES};
+    case PerformanceCounters::Event::DataTlbMisses:
+      return {
+          PERF_TYPE_HW_CACHE,
+          PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+              (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)};
+  }
+  mt_unreachable();
+}
+
+int open_counter(
+    PerformanceCounters::Event event,
+    PerformanceCounters::Scope scope) {
+  auto configuration = event_configuration(event);
+
+  struct perf_event_attr attributes;
+  std::memset(&attributes, 0, sizeof(attributes));
+  attributes.size = sizeof(attributes);
+  attributes.type = configuration.type;
+  attributes.config = configuration.config;
+  attributes.read_format =
+      PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+  attributes.inherit = scope == PerformanceCounters::Scope::Process ? 1 : 0;
+  attributes.exclude_kernel = 1;
+  attributes.exclude_hv = 1;
+
+  return static_cast<int>(syscall(
+      SYS_perf_event_open,
+      &attributes,
+      /* pid */ 0,
+      /* cpu */ -1,
+      /* group_fd */ -1,
+      /* flags */ 0));
+}
+
+#endif
+
+} // namespace
+
+PerformanceCounters::Values PerformanceCounters::Values::operator-(
+    const Values& other) const {
+  Values result;
+  for (std::size_t index = 0; index < kEvents; index++) {
+    result.counts[index] = counts[index] >= other.counts[index]
+        ? counts[index] - other.counts[index]
+        : 0;
+  }
+  return result;
+}
+
+PerformanceCounters::Values& PerformanceCounters::Values::operator+=(
+    const Values& other) {
+  for (std::size_t index = 0; index < kEvents; index++) {
+    counts[index] += other.counts[index];
+  }
+  return *this;
+}
+
+Json::Value PerformanceCounters::Values::to_json() const {
+  auto value = Json::Value(Json::objectValue);
+  for (std::size_t index = 0; index < kEvents; index++) {
+    value[event_name(static_cast<Event>(index))] =
+        Json::Value(static_cast<Json::UInt64>(counts[index]));
+  }
+  auto cycles = static_cast<double>((*this)[Event::Cycles]);
+  if (cycles > 0.0) {
+    value["instructions_per_cycle"] =
+        static_cast<double>((*this)[Event::Instructions]) / cycles;
+  }
+  return value;
+}
+
+PerformanceCounters::PerformanceCounters(Scope scope) {
+  descriptors_.fill(kNoDescriptor);
+#if __linux__
+  for (std::size_t index = 0; index < kEvents; index++) {
+    descriptors_[index] = open_counter(static_cast<Event>(index), scope);
+  }
+#else
+  (void)scope;
+#endif
+}
+
+PerformanceCounters::~PerformanceCounters() {
+#if __linux__
+  for (int descriptor : descriptors_) {
+    if (descriptor != kNoDescriptor) {
+      close(descriptor);
+    }
+  }
+#endif
+}
+
+const PerformanceCounters& PerformanceCounters::thread() {
+  thread_local PerformanceCounters counters(Scope::Thread);
+  return counters;
+}
+
+const char* PerformanceCounters::event_name(Event event) {
+  switch (event) {
+    case Event::Cycles:
+      return "cycles";
+    case Event::Instructions:
+      return "instructions";
+    case Event::LastLevelCacheMisses:
+      return "llc_misses";
+    case Event::DataTlbMisses:
+      return "dtlb_misses";
+  }
+  mt_unreachable();
+}
+
+bool PerformanceCounters::available() const {
+  for (int descriptor : descriptors_) {
+    if (descriptor != kNoDescriptor) {
+      return true;
+    }
+  }
+  return false;
+}
+
+PerformanceCounters::Values PerformanceCounters::read() const {
+  Values values;
+#if __linux__
+  for (std::size_t index = 0; index < kEvents; index++) {
+    if (descriptors_[index] == kNoDescriptor) {
+      continue;
+    }
+    // Value, time enabled and time running (see `read_format`).
+    std::uint64_t buffer[3];
+    if (::read(descriptors_[index], buffer, sizeof(buffer)) !=
+        static_cast<ssize_t>(sizeof(buffer))) {
+      continue;
+    }
+    auto count = buffer[0];
+    auto enabled = buffer[1];
+    auto running = buffer[2];
+    if (running > 0 && running < enabled) {
+      // The counter was multiplexed, extrapolate it.
+      count = static_cast<std::uint64_t>(
+          static_cast<double>(count) * static_cast<double>(enabled) /
+          static_cast<double>(running));
+    }
+    values.counts[index] = count;
+  }
+#endif
+  return values;
+}
+
+PhaseCounters::PhaseCounters(
+    const PerformanceCounters* counters,
+    Statistics& statistics,
+    std::string phase)
+    : counters_(counters),
+      statistics_(statistics),
+      phase_(std::move(phase)),
+      start_resident_set_size_(resident_set_size_in_gb()),
+      ended_(false) {
+  if (counters_ != nullptr) {
+    start_ = counters_->read();
+  }
+}
+
+PhaseCounters::~PhaseCounters() {
+  end();
+}
+
+void PhaseCounters::end() {
+  if (ended_) {
+    return;
+  }
+  ended_ = true;
+  if (counters_ != nullptr) {
+    statistics_.log_performance_counters(phase_, counters_->read() - start_);
+  }
+  statistics_.log_phase_resident_set_size(
+      phase_, start_resident_set_size_, resident_set_size_in_gb());
+}
+
+} // namespace marianatrench
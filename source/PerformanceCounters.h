@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+#include <json/json.h>
+
+namespace marianatrench {
+
+class Statistics;
+
+/**
+ * Hardware performance counters, read with `perf_event_open`, when
+ * `--performance-counters` is used.
+ *
+ * Counters either count the calling thread only, or the calling thread and
+ * all threads it creates afterwards. Counters that cannot be opened (e.g on
+ * unsupported operating systems, or when `perf_event_paranoid` forbids it)
+ * always read 0. Counters are scaled when the kernel multiplexes them.
+ */
+class PerformanceCounters final {
+ public:
+  enum class Event : std::uint8_t {
+    Cycles,
+    Instructions,
+    LastLevelCacheMisses,
+    DataTlbMisses,
+  };
+
+  static constexpr std::size_t kEvents =
+      static_cast<std::size_t>(Event::DataTlbMisses) + 1;
+
+  enum class Scope : std::uint8_t {
+    Thread,
+    // The calling thread and threads it creates after the construction.
+    Process,
+  };
+
+  struct Values {
+    std::array<std::uint64_t, kEvents> counts{};
+
+    std::uint64_t operator[](Event event) const {
+      return counts[static_cast<std::size_t>(event)];
+    }
+
+    Values operator-(const Values& other) const;
+    Values& operator+=(const Values& other);
+
+    Json::Value to_json() const;
+  };
+
+ public:
+  explicit PerformanceCounters(Scope scope);
+  PerformanceCounters(const PerformanceCounters&) = delete;
+  PerformanceCounters(PerformanceCounters&&) = delete;
+  PerformanceCounters& operator=(const PerformanceCounters&) = delete;
+  PerformanceCounters& operator=(PerformanceCounters&&) = delete;
+  ~PerformanceCounters();
+
+  /* Return the counters of the calling thread, opened on first use. */
+  static const PerformanceCounters& thread();
+
+  static const char* event_name(Event event);
+
+  /* Whether at least one counter could be opened. */
+  bool available() const;
+
+  Values read() const;
+
+ private:
+  std::array<int, kEvents> descriptors_;
+};
+
+/**
+ * Record the process counters of a phase into the statistics, from
+ * construction until `end` or destruction. Hardware counters are only
+ * recorded when `counters` is not null, and the resident set size before and
+ * after the phase is always recorded.
+ *
+ * Phases that run concurrently are counted in each other.
+ */
+class PhaseCounters final {
+ public:
+  PhaseCounters(
+      const PerformanceCounters* counters,
+      Statistics& statistics,
+      std::string phase);
+  PhaseCounters(const PhaseCounters&) = delete;
+  PhaseCounters(PhaseCounters&&) = delete;
+  PhaseCounters& operator=(const PhaseCounters&) = delete;
+  PhaseCounters& operator=(PhaseCounters&&) = delete;
+  ~PhaseCounters();
+
+  void end();
+
+ private:
+  const PerformanceCounters* counters_;
+  Statistics& statistics_;
+  std::string phase_;
+  PerformanceCounters::Values start_;
+  double start_resident_set_size_;
+  bool ended_;
+};
+
+} // namespace marianatrench
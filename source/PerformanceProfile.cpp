@@ -0,0 +1,168 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+
+#include <fmt/format.h>
+
+#include <mariana-trench/JsonValidation.h>
+#include <mariana-trench/PerformanceProfile.h>
+
+namespace marianatrench {
+
+namespace {
+
+const std::unordered_map<std::string, PerformanceProfile::Tolerance>
+    kDefaultTolerances = {
+        {"iterations", {/* relative */ 0.0, /* absolute */ 0.0}},
+        {"maximum_method_analyses", {0.0, 0.0}},
+        {"analyses", {0.05, 0.0}},
+        {"analyses_per_method", {0.05, 0.0}},
+        {"rss", {0.25, 0.05}},
+        {"times", {1.0, 0.5}},
+};
+
+const std::vector<std::string> kScalarMetrics = {
+    "iterations",
+    "maximum_method_analyses",
+    "analyses",
+    "analyses_per_method",
+    "rss",
+};
+
+double number(const Json::Value& value, const std::string& field) {
+  const auto& member = value[field];
+  if (!member.isNumeric()) {
+    throw JsonValidationError(value, field, "number");
+  }
+  return member.asDouble();
+}
+
+double round(double x, int digits) {
+  double y = std::pow(10.0, digits);
+  return std::round(x * y) / y;
+}
+
+std::optional<std::string> regression(
+    const std::string& metric,
+    double baseline,
+    double actual,
+    const PerformanceProfile::Tolerance& tolerance) {
+  auto limit = baseline * (1.0 + tolerance.relative) + tolerance.absolute;
+  if (actual <= limit) {
+    return std::nullopt;
+  }
+  return fmt::format(
+      "`{}` regressed from {} to {} (limit: {})",
+      metric,
+      baseline,
+      actual,
+      round(limit, 3));
+}
+
+} // namespace
+
+Json::Value PerformanceProfile::from_statistics(const Statistics& statistics) {
+  auto statistics_value = statistics.to_json();
+
+  std::uint64_t analyses = 0;
+  std::uint64_t maximum_method_analyses = 0;
+  auto method_times = statistics.method_times();
+  for (const auto& [method, time] : method_times) {
+    analyses += time.analyses;
+    maximum_method_analyses =
+        std::max(maximum_method_analyses, std::uint64_t(time.analyses));
+  }
+
+  // The fixpoint only samples the resident set size, phases record it too.
+  double rss = statistics_value["rss"].asDouble();
+  for (const auto& phase : statistics_value["phase_rss"]) {
+    rss = std::max(
+        {rss, phase["before"].asDouble(), phase["after"].asDouble()});
+  }
+
+  auto value = Json::Value(Json::objectValue);
+  value["iterations"] = statistics_value["iterations"];
+  value["analyses"] = Json::Value(static_cast<Json::UInt64>(analyses));
+  value["maximum_method_analyses"] =
+      Json::Value(static_cast<Json::UInt64>(maximum_method_analyses));
+  value["analyses_per_method"] = Json::Value(
+      method_times.empty()
+          ? 0.0
+          : round(static_cast<double>(analyses) / method_times.size(), 3));
+  value["rss"] = Json::Value(round(rss, 3));
+  value["times"] = statistics_value["times"];
+  return value;
+}
+
+PerformanceProfile::Tolerance PerformanceProfile::tolerance(
+    const Json::Value& baseline,
+    const std::string& metric) {
+  auto tolerance = kDefaultTolerances.at(metric);
+  if (!baseline.isMember("tolerances")) {
+    return tolerance;
+  }
+  const auto& tolerances = JsonValidation::object(baseline, "tolerances");
+  if (!tolerances.isMember(metric)) {
+    return tolerance;
+  }
+  const auto& value = JsonValidation::object(tolerances, metric);
+  if (value.isMember("relative")) {
+    tolerance.relative = number(value, "relative");
+  }
+  if (value.isMember("absolute")) {
+    tolerance.absolute = number(value, "absolute");
+  }
+  return tolerance;
+}
+
+std::vector<std::string> PerformanceProfile::regressions(
+    const Json::Value& baseline,
+    const Json::Value& profile) {
+  JsonValidation::validate_object(baseline);
+  JsonValidation::validate_object(profile);
+
+  std::vector<std::string> regressions;
+  for (const auto& metric : kScalarMetrics) {
+    if (!baseline.isMember(metric)) {
+      continue;
+    }
+    if (auto description = regression(
+            metric,
+            number(baseline, metric),
+            number(profile, metric),
+            tolerance(baseline, metric))) {
+      regressions.push_back(std::move(*description));
+    }
+  }
+
+  if (baseline.isMember("times")) {
+    const auto& baseline_times = JsonValidation::object(baseline, "times");
+    const auto& times = JsonValidation::object(profile, "times");
+    auto times_tolerance = tolerance(baseline, "times");
+    for (const auto& phase : baseline_times.getMemberNames()) {
+      if (!times.isMember(phase)) {
+        continue;
+      }
+      if (auto description = regression(
+              fmt::format("times.{}", phase),
+              number(baseline_times, phase),
+              number(times, phase),
+              times_tolerance)) {
+        regressions.push_back(std::move(*description));
+      }
+    }
+  }
+
+  return regressions;
+}
+
+} // namespace marianatrench
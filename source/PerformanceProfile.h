@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <json/json.h>
+
+#include <mariana-trench/Statistics.h>
+
+namespace marianatrench {
+
+/**
+ * A summary of the cost of an analysis, to catch performance regressions by
+ * comparing it against a checked-in baseline (e.g the integration tests with
+ * `MARIANA_TRENCH_PERFORMANCE_TESTS` set).
+ *
+ * A profile is a json object with the number of global iterations, the total
+ * and maximum number of analyses of a method, the average number of analyses
+ * per analyzed method, the peak resident set size in GB and the duration of
+ * each phase in seconds.
+ */
+class PerformanceProfile final {
+ public:
+  /**
+   * A metric regresses when its value exceeds
+   * `baseline * (1 + relative) + absolute`.
+   */
+  struct Tolerance {
+    double relative;
+    double absolute;
+  };
+
+  static Json::Value from_statistics(const Statistics& statistics);
+
+  /**
+   * Return the tolerance of the given metric of the baseline: its
+   * `tolerances` member if any, or the default tolerance. Counters of the
+   * global fixpoint are compared strictly, since extra iterations are
+   * algorithmic regressions, while durations and memory only fail on large
+   * regressions, to be robust to noisy machines.
+   */
+  static Tolerance tolerance(
+      const Json::Value& baseline,
+      const std::string& metric);
+
+  /**
+   * Return a description of each metric of the profile that regressed
+   * compared to the baseline. Metrics and phases missing from the baseline
+   * are ignored.
+   *
+   * Throws `JsonValidationError` if the baseline is malformed.
+   */
+  static std::vector<std::string> regressions(
+      const Json::Value& baseline,
+      const Json::Value& profile);
+};
+
+} // namespace marianatrench
@@ -5,11 +5,17 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <algorithm>
+#include <atomic>
 #include <cstdio>
+#include <ctime>
 #include <fstream>
+#include <string_view>
+#include <unordered_map>
 
 #include <boost/algorithm/string.hpp>
 #include <boost/filesystem.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
 #include <fmt/format.h>
 #include <re2/re2.h>
 
@@ -24,7 +30,9 @@
 #include <mariana-trench/JsonValidation.h>
 #include <mariana-trench/Log.h>
 #include <mariana-trench/Positions.h>
+#include <mariana-trench/SourceScanner.h>
 #include <mariana-trench/Timer.h>
+#include <mariana-trench/Tracer.h>
 
 namespace marianatrench {
 
@@ -32,20 +40,217 @@ namespace {
 
 constexpr int k_unknown_line = -1;
 
-// Performance optimization to avoid calling more expensive regex matches on
-// every line.
-bool maybe_class(const std::string& line) {
-  return line.find("class") != std::string::npos ||
-      line.find("interface") != std::string::npos ||
-      line.find("object") != std::string::npos ||
-      line.find("enum") != std::string::npos;
+bool is_source_file(const std::string& filename) {
+  return boost::iends_with(filename, ".java") ||
+      boost::iends_with(filename, ".kt") ||
+      boost::iends_with(filename, ".mustache");
+}
+
+/**
+ * Find all source files under the current directory, in parallel.
+ *
+ * Hidden directories (e.g `.hg`, `.git`, `.ovrsource-rest`) and the given
+ * excluded directories (relative, with a trailing `/`) are not visited.
+ * Returned paths are relative to the current directory.
+ */
+std::vector<std::string> find_source_files(
+    const std::vector<std::string>& exclude_directories,
+    unsigned int threads) {
+  ConcurrentSet<std::string> files;
+
+  auto queue = sparta::work_queue<std::string>(
+      [&](sparta::SpartaWorkerState<std::string>* state,
+          const std::string& directory) {
+        boost::system::error_code error;
+        auto iterator = boost::filesystem::directory_iterator(
+            directory.empty() ? "." : directory, error);
+        if (error) {
+          WARNING(3, "Unable to list `{}`: {}", directory, error.message());
+          return;
+        }
+
+        for (const auto& entry : iterator) {
+          auto filename = entry.path().filename().string();
+          auto path = directory.empty() ? filename : directory + "/" + filename;
+          auto status = entry.symlink_status(error);
+          if (error) {
+            continue;
+          }
+
+          if (boost::filesystem::is_directory(status)) {
+            if (boost::starts_with(filename, ".")) {
+              continue;
+            }
+            auto prefix = path + "/";
+            if (std::any_of(
+                    exclude_directories.begin(),
+                    exclude_directories.end(),
+                    [&](const auto& exclude_directory) {
+                      return boost::starts_with(prefix, exclude_directory);
+                    })) {
+              continue;
+            }
+            state->push_task(path);
+          } else if (
+              boost::filesystem::is_regular_file(status) &&
+              is_source_file(filename)) {
+            files.insert(path);
+          }
+        }
+      },
+      threads,
+      /* push_tasks_while_running */ true);
+  queue.add_item("");
+  queue.run_all();
+
+  return std::vector<std::string>(files.begin(), files.end());
+}
+
+/* Top-level classes declared in a source file, keyed on its size and time. */
+struct IndexedFile {
+  std::time_t modification_time;
+  std::uintmax_t size;
+  std::vector<std::string> classes;
+};
+
+using SourceIndex = std::unordered_map<std::string, IndexedFile>;
+
+constexpr int k_source_index_version = 1;
+
+SourceIndex read_source_index(const std::string& path) {
+  SourceIndex index;
+  if (!boost::filesystem::exists(path)) {
+    return index;
+  }
+
+  try {
+    auto value = JsonValidation::parse_json_file(path);
+    if (JsonValidation::integer(value, /* field */ "version") !=
+        k_source_index_version) {
+      WARNING(1, "Ignoring source index `{}` with a different version.", path);
+      return index;
+    }
+    const auto& files = JsonValidation::object(value, /* field */ "files");
+    for (auto iterator = files.begin(); iterator != files.end(); ++iterator) {
+      const auto& file = *iterator;
+      JsonValidation::validate_object(file);
+      IndexedFile indexed_file{
+          static_cast<std::time_t>(file["mtime"].asInt64()),
+          static_cast<std::uintmax_t>(file["size"].asUInt64()),
+          {}};
+      for (const auto& class_name :
+           JsonValidation::null_or_array(file, /* field */ "classes")) {
+        indexed_file.classes.push_back(JsonValidation::string(class_name));
+      }
+      index.emplace(iterator.name(), std::move(indexed_file));
+    }
+  } catch (const std::exception& exception) {
+    WARNING(
+        1, "Ignoring invalid source index `{}`: {}", path, exception.what());
+    index.clear();
+  }
+  return index;
+}
+
+void write_source_index(
+    const std::string& path,
+    const ConcurrentMap<std::string, IndexedFile>& index) {
+  auto files = Json::Value(Json::objectValue);
+  for (const auto& [file_path, indexed_file] : index) {
+    auto file = Json::Value(Json::objectValue);
+    file["mtime"] =
+        Json::Value(static_cast<Json::Int64>(indexed_file.modification_time));
+    file["size"] = Json::Value(static_cast<Json::UInt64>(indexed_file.size));
+    auto classes = Json::Value(Json::arrayValue);
+    for (const auto& class_name : indexed_file.classes) {
+      classes.append(Json::Value(class_name));
+    }
+    file["classes"] = classes;
+    files[file_path] = file;
+  }
+
+  auto value = Json::Value(Json::objectValue);
+  value["version"] = Json::Value(k_source_index_version);
+  value["files"] = files;
+  JsonValidation::write_json_file(path, value);
+}
+
+/* Return the top-level classes declared in the given source file. */
+std::vector<std::string> index_file(
+    const std::string& path,
+    std::uintmax_t size,
+    const re2::RE2& package_regex,
+    const re2::RE2& class_regex) {
+  static const std::vector<std::string> skipped_package_prefixes = {
+      "android/",
+  };
+
+  std::vector<std::string> classes;
+  if (size == 0) {
+    return classes;
+  }
+
+  boost::iostreams::mapped_file_source file;
+  try {
+    file.open(path);
+  } catch (const std::exception& exception) {
+    WARNING(3, "Unable to map `{}`: {}", path, exception.what());
+    return classes;
+  }
+  auto content = std::string_view(file.data(), file.size());
+
+  // Regex matches are much slower than the scanner, which filters the lines
+  // that may match first.
+  std::optional<std::string> package = std::nullopt;
+  auto offsets = source_scanner::line_offsets(content);
+  for (std::size_t index = 0; index + 1 < offsets.size(); index++) {
+    auto line = source_scanner::line(content, offsets, index);
+    auto line_piece = re2::StringPiece(line.data(), line.size());
+
+    re2::StringPiece package_match;
+    // Using capturing groups with `re2` is very slow, so we only
+    // capture if we know the regex matches. This gives a huge
+    // performance boost.
+    if (!package && source_scanner::may_declare_package(line) &&
+        re2::RE2::PartialMatch(line_piece, package_regex) &&
+        re2::RE2::PartialMatch(line_piece, package_regex, &package_match)) {
+      package = package_match.as_string();
+      boost::replace_all(*package, ".", "/");
+      if (std::any_of(
+              skipped_package_prefixes.begin(),
+              skipped_package_prefixes.end(),
+              [&](const auto& skipped_prefix) {
+                return boost::starts_with(*package, skipped_prefix);
+              })) {
+        LOG(3, "Skipping module `{}` at `{}`...", *package, path);
+        return {};
+      }
+      if (boost::ends_with(path, ".kt")) {
+        auto pos = path.find_last_of("/");
+        if (pos != std::string::npos) {
+          auto filename = path.substr(pos + 1, path.size() - pos - 4);
+          classes.push_back(fmt::format("L{}/{}Kt;", *package, filename));
+        }
+      }
+    }
+
+    re2::StringPiece class_match;
+    if (package && source_scanner::may_declare_class(line) &&
+        re2::RE2::PartialMatch(line_piece, class_regex) &&
+        re2::RE2::PartialMatch(line_piece, class_regex, &class_match)) {
+      classes.push_back(fmt::format("L{}/{};", *package, class_match));
+    }
+  }
+
+  return classes;
 }
 
 } // namespace
 
-Positions::Positions() {}
+Positions::Positions() : threads_(sparta::parallel::default_num_threads()) {}
 
-Positions::Positions(const Options& options, const DexStoresVector& stores) {
+Positions::Positions(const Options& options, const DexStoresVector& stores)
+    : threads_(options.jobs(AnalysisPhase::Positions)) {
   if (options.skip_source_indexing()) {
     // Create a dummy path for all methods.
     for (auto& scope : DexStoreClassesIterator(stores)) {
@@ -61,137 +266,111 @@ Positions::Positions(const Options& options, const DexStoresVector& stores) {
       });
     }
   } else {
-    // Find all Java/Kotlin files in the source root directory.
-    Timer paths_timer;
-    LOG(2,
-        "Finding files to index in `{}`...",
-        options.source_root_directory());
-
     auto current_path = boost::filesystem::current_path();
     boost::filesystem::current_path(options.source_root_directory());
 
-    std::string hg_command =
-        "hg files --include=**.java --include=**.kt --include=**.mustache --exclude=.ovrsource-rest";
-    std::string find_command =
-        "find . -type f \\( -iname \\*.java -o -iname \\*.kt -iname \\*.mustache \\) -not -path ./.ovrsource-rest/\\*";
-
-    int return_code = -1;
-    std::string output;
-    output = execute_and_catch_output(hg_command, return_code);
-
-    if (return_code != EXIT_SUCCESS) {
-      WARNING(
-          1,
-          "Source directory is not a mercurial repository. Trying `find` to discover files.");
-      output = execute_and_catch_output(find_command, return_code);
-      if (return_code != EXIT_SUCCESS) {
-        ERROR(1, "`find` failed, no source file will be indexed.");
+    auto exclude_directories = options.source_exclude_directories();
+    for (auto& exclude_directory : exclude_directories) {
+      if (boost::starts_with(exclude_directory, "./")) {
+        exclude_directory.erase(0, 2);
+      }
+      if (!boost::ends_with(exclude_directory, "/")) {
+        exclude_directory.push_back('/');
       }
     }
 
-    std::vector<std::string> paths;
-    boost::split(paths, output, boost::is_any_of("\n"));
-
+    // Find all Java/Kotlin files in the source root directory.
+    Timer paths_timer;
+    TraceSpan paths_span("source_index:find_files");
+    LOG(2,
+        "Finding files to index in `{}`...",
+        options.source_root_directory());
+    auto paths = find_source_files(exclude_directories, threads_);
+    paths_span.end();
     LOG(2,
         "Found {} files in {:.2f}s.",
         paths.size(),
         paths_timer.duration_in_seconds());
 
+    // Reuse the index of files that did not change since the previous run.
+    SourceIndex previous_index;
+    const auto& index_cache_path = options.source_index_cache_path();
+    if (index_cache_path) {
+      previous_index = read_source_index(*index_cache_path);
+    }
+
     // Find top-level classes in files.
     Timer index_timer;
+    TraceSpan index_span("source_index:classes");
     LOG(2, "Indexing classes...");
 
     std::atomic<std::size_t> iteration(0);
-    ConcurrentMap<std::string, std::string> class_to_path;
+    std::atomic<std::size_t> reused(0);
+    ConcurrentMap<std::string, IndexedFile> index;
     re2::RE2 package_regex("^package\\s+([^;]+)(?:;|$)");
     re2::RE2 class_regex(
         "^\\s*(?:/\\*.*\\*/)?\\s*(?:public|internal|private)?\\s*(?:abstract|final|open)?\\s*(?:class|enum|interface|object)\\s+([A-z0-9]+)");
-    std::unordered_set<std::string> skipped_package_prefixes = {
-        "android/",
-    };
-
-    auto exclude_directories = options.source_exclude_directories();
-    for (auto& exclude_directory : exclude_directories) {
-      if (!boost::ends_with(exclude_directory, "/")) {
-        exclude_directory.push_back('/');
-      }
-    }
 
-    auto queue = sparta::work_queue<std::string*>(
-        [&](std::string* path) {
+    auto queue = sparta::work_queue<const std::string*>(
+        [&](const std::string* path) {
           iteration++;
           if (iteration % 10000 == 0) {
             LOG(2, "Indexed {} of {} files.", iteration.load(), paths.size());
           }
 
-          if (boost::starts_with(*path, "./")) {
-            // Remove the `./` prefix added by `find`.
-            path->erase(0, 2);
-          }
-          if (path->empty()) {
+          boost::system::error_code error;
+          auto size = boost::filesystem::file_size(*path, error);
+          auto modification_time =
+              boost::filesystem::last_write_time(*path, error);
+          if (error) {
+            WARNING(3, "Unable to read `{}`: {}", *path, error.message());
             return;
           }
-          for (const auto& exclude_directory : exclude_directories) {
-            if (boost::starts_with(*path, exclude_directory)) {
-              return;
-            }
-          }
 
-          std::optional<std::string> package = std::nullopt;
-
-          std::ifstream stream(*path);
-          std::string line;
-          while (std::getline(stream, line)) {
-            re2::StringPiece package_match;
-            // Using capturing groups with `re2` is very slow, so we only
-            // capture if we know the regex matches. This gives a huge
-            // performance boost.
-            if (!package && re2::RE2::PartialMatch(line, package_regex) &&
-                re2::RE2::PartialMatch(line, package_regex, &package_match)) {
-              package = package_match.as_string();
-              boost::replace_all(*package, ".", "/");
-              if (std::any_of(
-                      skipped_package_prefixes.begin(),
-                      skipped_package_prefixes.end(),
-                      [&](const auto& skipped_prefix) {
-                        return boost::starts_with(*package, skipped_prefix);
-                      })) {
-                LOG(3, "Skipping module `{}` at `{}`...", *package, *path);
-                return;
-              }
-              if (boost::ends_with(*path, ".kt")) {
-                auto pos = path->find_last_of("/");
-                if (pos != std::string::npos) {
-                  auto filename = path->substr(pos + 1, path->size() - pos - 4);
-                  class_to_path.emplace(
-                      fmt::format("L{}/{}Kt;", *package, filename), *path);
-                }
-              }
-            }
-
-            re2::StringPiece class_match;
-            if (package && maybe_class(line) &&
-                re2::RE2::PartialMatch(line, class_regex) &&
-                re2::RE2::PartialMatch(line, class_regex, &class_match)) {
-              class_to_path.emplace(
-                  fmt::format("L{}/{};", *package, class_match), *path);
-            }
+          auto found = previous_index.find(*path);
+          if (found != previous_index.end() &&
+              found->second.size == size &&
+              found->second.modification_time == modification_time) {
+            reused++;
+            index.insert(std::make_pair(*path, found->second));
+            return;
           }
+
+          index.insert(std::make_pair(
+              *path,
+              IndexedFile{
+                  modification_time,
+                  size,
+                  index_file(*path, size, package_regex, class_regex)}));
         },
-        sparta::parallel::default_num_threads());
-    for (auto& path : paths) {
+        threads_);
+    for (const auto& path : paths) {
       queue.add_item(&path);
     }
     queue.run_all();
 
+    ConcurrentMap<std::string, std::string> class_to_path;
+    for (const auto& [path, indexed_file] : index) {
+      for (const auto& class_name : indexed_file.classes) {
+        class_to_path.emplace(class_name, path);
+      }
+    }
+
+    if (index_cache_path) {
+      write_source_index(*index_cache_path, index);
+    }
+
     boost::filesystem::current_path(current_path);
+    index_span.end();
 
     LOG(2,
-        "Indexed {} top-level classes in {:.2f}s.",
+        "Indexed {} top-level classes in {:.2f}s ({} unchanged files).",
         class_to_path.size(),
-        index_timer.duration_in_seconds());
+        index_timer.duration_in_seconds(),
+        reused.load());
 
     Timer method_paths_timer;
+    TraceSpan method_paths_span("source_index:method_paths");
     LOG(2, "Indexing method paths...");
 
     for (auto& scope : DexStoreClassesIterator(stores)) {
@@ -214,6 +393,7 @@ Positions::Positions(const Options& options, const DexStoresVector& stores) {
   }
 
   Timer method_lines_timer;
+  TraceSpan method_lines_span("source_index:method_lines");
   LOG(2, "Indexing method lines...");
 
   // Index first lines of methods because building the control flow graph will
@@ -295,6 +475,27 @@ const Position* Positions::get(
     const DexPosition* position,
     std::optional<Root> port,
     const IRInstruction* instruction) const {
+  if (!port && instruction == nullptr &&
+      method->id() < method_positions_.size()) {
+    const auto& method_positions = method_positions_[method->id()];
+    if (position == nullptr) {
+      if (method_positions.method_position != nullptr) {
+        return method_positions.method_position;
+      }
+    } else {
+      auto found = std::lower_bound(
+          method_positions.positions.begin(),
+          method_positions.positions.end(),
+          position,
+          [](const auto& entry, const DexPosition* position) {
+            return entry.first < position;
+          });
+      if (found != method_positions.positions.end() &&
+          found->first == position) {
+        return found->second;
+      }
+    }
+  }
   return get(method->dex_method(), position, port, instruction);
 }
 
@@ -360,4 +561,41 @@ const Position* Positions::unknown() const {
   return positions_.insert(Position(nullptr, k_unknown_line)).first;
 }
 
+void Positions::index_methods(const Methods& methods) {
+  std::vector<MethodPositions> method_positions(methods.size());
+
+  auto queue = sparta::work_queue<const Method*>(
+      [&](const Method* method) {
+        const auto* dex_method = method->dex_method();
+        auto& entry = method_positions[method->id()];
+        entry.method_position = get(dex_method);
+
+        const auto* code = method->get_code();
+        if (code == nullptr || !code->cfg_built()) {
+          return;
+        }
+        for (const auto* block : code->cfg().blocks()) {
+          for (const auto& instruction : *block) {
+            if (instruction.type == MFLOW_POSITION &&
+                instruction.pos != nullptr) {
+              entry.positions.emplace_back(
+                  instruction.pos.get(),
+                  get(dex_method, instruction.pos.get()));
+            }
+          }
+        }
+        std::sort(entry.positions.begin(), entry.positions.end());
+        entry.positions.erase(
+            std::unique(entry.positions.begin(), entry.positions.end()),
+            entry.positions.end());
+      },
+      threads_);
+  for (const auto* method : methods) {
+    queue.add_item(method);
+  }
+  queue.run_all();
+
+  method_positions_ = std::move(method_positions);
+}
+
 } // namespace marianatrench
@@ -9,6 +9,8 @@
 
 #include <optional>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include <DexPosition.h>
 #include <DexStore.h>
@@ -16,6 +18,7 @@
 #include <ConcurrentContainers.h>
 
 #include <mariana-trench/Method.h>
+#include <mariana-trench/Methods.h>
 #include <mariana-trench/Options.h>
 #include <mariana-trench/Position.h>
 
@@ -74,6 +77,16 @@ class Positions final {
 
   const Position* unknown() const;
 
+  /**
+   * Precompute the positions of all `DexPosition`s in the control flow graph
+   * of the given methods, so that `get(method, position)` does not go
+   * through the global set of positions during the analysis.
+   *
+   * This must be called once control flow graphs are built, and must not be
+   * called concurrently with `get`.
+   */
+  void index_methods(const Methods& methods);
+
   static std::string execute_and_catch_output(
       const std::string& command,
       int& return_code);
@@ -83,6 +96,19 @@ class Positions final {
   mutable InsertOnlyConcurrentSet<Position> positions_;
   ConcurrentMap<const DexMethod*, const std::string*> method_to_path_;
   ConcurrentMap<const DexMethod*, int> method_to_line_;
+
+  struct MethodPositions {
+    /* Position of the method itself, i.e `get(method, nullptr)`. */
+    const Position* method_position = nullptr;
+    /* Sorted by `DexPosition` address. */
+    std::vector<std::pair<const DexPosition*, const Position*>> positions;
+  };
+
+  /* Indexed by `Method::id`. */
+  std::vector<MethodPositions> method_positions_;
+
+  /* Number of threads used to index sources and methods. */
+  unsigned int threads_;
 };
 
 } // namespace marianatrench
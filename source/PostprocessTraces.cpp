@@ -5,22 +5,27 @@
  * LICENSE file in the root directory of this source tree.
  */
 
-#include <SpartaWorkQueue.h>
+#include <cstdint>
+#include <functional>
+#include <tuple>
+
+#include <boost/functional/hash.hpp>
+
+#include <ConcurrentContainers.h>
 
 #include <mariana-trench/Dependencies.h>
+#include <mariana-trench/MethodBitset.h>
 #include <mariana-trench/Methods.h>
+#include <mariana-trench/Options.h>
 #include <mariana-trench/PostprocessTraces.h>
 #include <mariana-trench/Registry.h>
+#include <mariana-trench/WorkerPool.h>
 
 namespace marianatrench {
 
 namespace {
 
-bool is_valid_generation(
-    const Method* MT_NULLABLE callee,
-    const AccessPath& callee_port,
-    const Kind* kind,
-    const Registry& registry) {
+bool is_leaf(const Method* MT_NULLABLE callee, const AccessPath& callee_port) {
   if (callee == nullptr) {
     // Leaf frame
     return true;
@@ -31,29 +36,26 @@ bool is_valid_generation(
     // itself is not a leaf (has a callee).
     return true;
   }
-  auto model = registry.get(callee);
-  auto sources = model.generations().raw_read(callee_port).root();
+  return false;
+}
+
+bool is_valid_generation(
+    const Method* callee,
+    const AccessPath& callee_port,
+    const Kind* kind,
+    const Registry& registry) {
+  auto model = registry.get_snapshot(callee);
+  const auto& sources = model->generations().raw_read(callee_port).root();
   return sources.contains_kind(kind);
 }
 
 bool is_valid_sink(
-    const Method* MT_NULLABLE callee,
+    const Method* callee,
     const AccessPath& callee_port,
     const Kind* kind,
     const Registry& registry) {
-  if (callee == nullptr) {
-    // Leaf frame
-    return true;
-  } else if (callee_port.root().is_anchor()) {
-    // Crtex frames which have canonical names instantiated during
-    // `Frame::propagate` will have callee_ports `Anchor`. These are considered
-    // leaves when it comes to traces (no next hop), even though the `Frame`
-    // itself is not a leaf (has a callee).
-    return true;
-  }
-
-  auto model = registry.get(callee);
-  auto sinks = model.sinks().raw_read(callee_port).root();
+  auto model = registry.get_snapshot(callee);
+  const auto& sinks = model->sinks().raw_read(callee_port).root();
 
   if (sinks.contains_kind(kind)) {
     return true;
@@ -71,14 +73,96 @@ bool is_valid_sink(
   return sinks.contains_kind(sink_triggered_kind->partial_kind());
 }
 
+/**
+ * Memoized validity of the frames of a round of the fixpoint, per callee,
+ * callee port and kind. Frames with the same callee port are common across
+ * the models of the callers of a method, hence this reads each callee port
+ * of a model once per round instead of once per frame.
+ *
+ * Models updated during the round might be read before or after the update,
+ * as without the memo. Their dependencies are analyzed again in the next
+ * round, with a new memo.
+ */
+class ValidFrames final {
+ private:
+  using Key = std::tuple<const Method*, AccessPath, const Kind*>;
+
+  struct KeyHash {
+    std::size_t operator()(const Key& key) const {
+      std::size_t seed = 0;
+      boost::hash_combine(seed, std::get<0>(key));
+      boost::hash_combine(seed, std::hash<AccessPath>()(std::get<1>(key)));
+      boost::hash_combine(seed, std::get<2>(key));
+      return seed;
+    }
+  };
+
+  enum class Validity : std::uint8_t { Unknown, Invalid, Valid };
+
+  using Memo = ConcurrentMap<Key, Validity, KeyHash>;
+
+ public:
+  explicit ValidFrames(const Registry& registry) : registry_(registry) {}
+
+  ValidFrames(const ValidFrames&) = delete;
+  ValidFrames(ValidFrames&&) = delete;
+  ValidFrames& operator=(const ValidFrames&) = delete;
+  ValidFrames& operator=(ValidFrames&&) = delete;
+  ~ValidFrames() = default;
+
+  bool generation(
+      const Method* MT_NULLABLE callee,
+      const AccessPath& callee_port,
+      const Kind* kind) const {
+    if (is_leaf(callee, callee_port)) {
+      return true;
+    }
+    return get(generations_, callee, callee_port, kind, is_valid_generation);
+  }
+
+  bool sink(
+      const Method* MT_NULLABLE callee,
+      const AccessPath& callee_port,
+      const Kind* kind) const {
+    if (is_leaf(callee, callee_port)) {
+      return true;
+    }
+    return get(sinks_, callee, callee_port, kind, is_valid_sink);
+  }
+
+ private:
+  template <typename IsValid>
+  bool get(
+      Memo& memo,
+      const Method* callee,
+      const AccessPath& callee_port,
+      const Kind* kind,
+      IsValid&& is_valid) const {
+    auto key = Key(callee, callee_port, kind);
+    auto validity = memo.get(key, Validity::Unknown);
+    if (validity == Validity::Unknown) {
+      validity = is_valid(callee, callee_port, kind, registry_)
+          ? Validity::Valid
+          : Validity::Invalid;
+      memo.emplace(std::move(key), validity);
+    }
+    return validity == Validity::Valid;
+  }
+
+ private:
+  const Registry& registry_;
+  mutable Memo generations_;
+  mutable Memo sinks_;
+};
+
 TaintAccessPathTree cull_collapsed_generations(
     TaintAccessPathTree generation_tree,
-    const Registry& registry) {
+    const ValidFrames& valid_frames) {
   generation_tree.map([&](Taint& generation_taint) {
     generation_taint.filter_invalid_frames([&](const Method* MT_NULLABLE callee,
                                                const AccessPath& callee_port,
                                                const Kind* kind) {
-      return is_valid_generation(callee, callee_port, kind, registry);
+      return valid_frames.generation(callee, callee_port, kind);
     });
   });
   return generation_tree;
@@ -86,33 +170,76 @@ TaintAccessPathTree cull_collapsed_generations(
 
 TaintAccessPathTree cull_collapsed_sinks(
     TaintAccessPathTree sink_tree,
-    const Registry& registry) {
+    const ValidFrames& valid_frames) {
   sink_tree.map([&](Taint& sink_taint) {
     sink_taint.filter_invalid_frames([&](const Method* MT_NULLABLE callee,
                                          const AccessPath& callee_port,
                                          const Kind* kind) {
-      return is_valid_sink(callee, callee_port, kind, registry);
+      return valid_frames.sink(callee, callee_port, kind);
     });
   });
   return sink_tree;
 }
 
-IssueSet cull_collapsed_issues(IssueSet issues, const Registry& registry) {
+IssueSet cull_collapsed_issues(
+    IssueSet issues,
+    const ValidFrames& valid_frames) {
   issues.map([&](Issue& issue) {
     issue.filter_sources([&](const Method* MT_NULLABLE callee,
                              const AccessPath& callee_port,
                              const Kind* kind) {
-      return is_valid_generation(callee, callee_port, kind, registry);
+      return valid_frames.generation(callee, callee_port, kind);
     });
     issue.filter_sinks([&](const Method* MT_NULLABLE callee,
                            const AccessPath& callee_port,
                            const Kind* kind) {
-      return is_valid_sink(callee, callee_port, kind, registry);
+      return valid_frames.sink(callee, callee_port, kind);
     });
   });
   return issues;
 }
 
+bool has_collapsed_traces(
+    const TaintAccessPathTree& tree,
+    const std::function<
+        bool(const Method* MT_NULLABLE, const AccessPath&, const Kind*)>&
+        is_valid) {
+  bool result = false;
+  tree.visit([&](const AccessPath& /* access_path */, const Taint& taint) {
+    result = result || taint.has_invalid_frames(is_valid);
+  });
+  return result;
+}
+
+/* Returns true if culling collapsed traces would change the model. */
+bool has_collapsed_traces(
+    const Model& model,
+    const ValidFrames& valid_frames) {
+  auto is_valid_source = [&](const Method* MT_NULLABLE callee,
+                             const AccessPath& callee_port,
+                             const Kind* kind) {
+    return valid_frames.generation(callee, callee_port, kind);
+  };
+  auto is_valid_sink_frame = [&](const Method* MT_NULLABLE callee,
+                                 const AccessPath& callee_port,
+                                 const Kind* kind) {
+    return valid_frames.sink(callee, callee_port, kind);
+  };
+
+  if (has_collapsed_traces(model.generations(), is_valid_source) ||
+      has_collapsed_traces(model.sinks(), is_valid_sink_frame)) {
+    return true;
+  }
+
+  for (const auto& issue : model.issues()) {
+    if (issue.sources().has_invalid_frames(is_valid_source) ||
+        issue.sinks().has_invalid_frames(is_valid_sink_frame)) {
+      return true;
+    }
+  }
+  return false;
+}
+
 } // namespace
 
 void PostprocessTraces::remove_collapsed_traces(
@@ -120,40 +247,61 @@ void PostprocessTraces::remove_collapsed_traces(
     const Context& context) {
   // We need to compute a decreasing fixpoint since we might remove empty
   // generations or sinks that are referenced in other models.
+  //
+  // Most models have no collapsed traces, hence we start from the methods
+  // that do and only propagate to the dependencies of models that changed.
 
-  auto methods = std::make_unique<ConcurrentSet<const Method*>>();
+  MethodBitset methods(*context.methods);
+  MethodBitset new_methods(*context.methods);
+
+  auto scan_valid_frames = ValidFrames(registry);
+  auto scan = WorkQueue<const Method*>(
+      context.worker_pool.get(),
+      [&](const Method* method) {
+        if (has_collapsed_traces(
+                *registry.get_snapshot(method), scan_valid_frames)) {
+          methods.insert(method);
+        }
+      },
+      context.options->jobs(AnalysisPhase::PostprocessTraces));
   for (const auto* method : *context.methods) {
-    methods->insert(method);
+    scan.add_item(method);
   }
+  scan.run_all();
 
-  while (methods->size() > 0) {
-    auto new_methods = std::make_unique<ConcurrentSet<const Method*>>();
+  while (!methods.empty()) {
+    new_methods.clear();
 
-    auto queue = sparta::work_queue<const Method*>(
+    auto valid_frames = ValidFrames(registry);
+    auto queue = WorkQueue<const Method*>(
+        context.worker_pool.get(),
         [&](const Method* method) {
-          const auto old_model = registry.get(method);
+          auto snapshot = registry.get_snapshot(method);
+          if (!has_collapsed_traces(*snapshot, valid_frames)) {
+            return;
+          }
 
+          const auto& old_model = *snapshot;
           auto model = old_model;
           model.set_generations(
-              cull_collapsed_generations(model.generations(), registry));
-          model.set_sinks(cull_collapsed_sinks(model.sinks(), registry));
-          model.set_issues(cull_collapsed_issues(model.issues(), registry));
+              cull_collapsed_generations(model.generations(), valid_frames));
+          model.set_sinks(cull_collapsed_sinks(model.sinks(), valid_frames));
+          model.set_issues(
+              cull_collapsed_issues(model.issues(), valid_frames));
 
           if (!old_model.leq(model)) {
             for (const auto* dependency :
                  context.dependencies->dependencies(method)) {
-              new_methods->insert(dependency);
+              new_methods.insert(dependency);
             }
           }
 
           registry.set(model);
         },
-        sparta::parallel::default_num_threads());
-    for (const auto* method : *methods) {
-      queue.add_item(method);
-    }
+        context.options->jobs(AnalysisPhase::PostprocessTraces));
+    methods.visit([&](const Method* method) { queue.add_item(method); });
     queue.run_all();
-    methods = std::move(new_methods);
+    methods.swap(new_methods);
   }
 }
 
@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <Show.h>
+
+#include <mariana-trench/Profiler.h>
+
+namespace marianatrench {
+
+void MethodProfile::Entry::join_with(const Entry& other) {
+  calls += other.calls;
+  seconds += other.seconds;
+  taint_size += other.taint_size;
+  maximum_taint_size = std::max(maximum_taint_size, other.maximum_taint_size);
+}
+
+Json::Value MethodProfile::Entry::to_json() const {
+  auto value = Json::Value(Json::objectValue);
+  value["calls"] = Json::Value(static_cast<Json::UInt64>(calls));
+  value["seconds"] = Json::Value(seconds);
+  value["taint_size"] = Json::Value(static_cast<Json::UInt64>(taint_size));
+  value["maximum_taint_size"] =
+      Json::Value(static_cast<Json::UInt64>(maximum_taint_size));
+  return value;
+}
+
+void MethodProfile::record(
+    std::string_view name,
+    double seconds,
+    std::size_t taint_size) {
+  auto& entry = entries_[name];
+  entry.calls++;
+  entry.seconds += seconds;
+  entry.taint_size += taint_size;
+  entry.maximum_taint_size = std::max(entry.maximum_taint_size, taint_size);
+}
+
+void MethodProfile::join_with(const MethodProfile& other) {
+  for (const auto& [name, entry] : other.entries_) {
+    entries_[name].join_with(entry);
+  }
+}
+
+double MethodProfile::seconds(std::string_view name) const {
+  auto found = entries_.find(name);
+  return found != entries_.end() ? found->second.seconds : 0.0;
+}
+
+Json::Value MethodProfile::to_json() const {
+  auto value = Json::Value(Json::objectValue);
+  for (const auto& [name, entry] : entries_) {
+    value[std::string(name)] = entry.to_json();
+  }
+  return value;
+}
+
+ProfileScope::ProfileScope(
+    MethodProfile* MT_NULLABLE profile,
+    std::string_view name,
+    std::size_t taint_size)
+    : profile_(profile), name_(name), taint_size_(taint_size) {
+  if (profile_ != nullptr) {
+    start_ = std::chrono::steady_clock::now();
+  }
+}
+
+ProfileScope::~ProfileScope() {
+  if (profile_ == nullptr) {
+    return;
+  }
+  std::chrono::duration<double> duration =
+      std::chrono::steady_clock::now() - start_;
+  profile_->record(name_, duration.count(), taint_size_);
+}
+
+void Profiler::record(const Method* method, const MethodProfile& profile) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  total_.join_with(profile);
+  methods_[method].join_with(profile);
+}
+
+Json::Value Profiler::to_json() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  std::vector<std::pair<const Method*, const MethodProfile*>> methods;
+  methods.reserve(methods_.size());
+  for (const auto& [method, profile] : methods_) {
+    methods.emplace_back(method, &profile);
+  }
+  auto size = std::min(methods.size(), kRecordMethods);
+  std::partial_sort(
+      methods.begin(),
+      methods.begin() + size,
+      methods.end(),
+      [](const auto& left, const auto& right) {
+        return left.second->seconds(kAnalyzeMethod) >
+            right.second->seconds(kAnalyzeMethod);
+      });
+
+  auto methods_value = Json::Value(Json::arrayValue);
+  for (std::size_t i = 0; i < size; i++) {
+    auto method_value = Json::Value(Json::objectValue);
+    method_value["method"] = Json::Value(show(methods[i].first));
+    method_value["profile"] = methods[i].second->to_json();
+    methods_value.append(method_value);
+  }
+
+  auto value = Json::Value(Json::objectValue);
+  value["total"] = total_.to_json();
+  value["methods"] = methods_value;
+  return value;
+}
+
+} // namespace marianatrench
@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
+
+#include <json/json.h>
+
+#include <mariana-trench/Compiler.h>
+#include <mariana-trench/Method.h>
+
+namespace marianatrench {
+
+/**
+ * Profile of a single analysis of a method, per transfer function.
+ *
+ * This is not thread-safe: each method analysis owns its profile.
+ */
+class MethodProfile final {
+ public:
+  struct Entry {
+    std::size_t calls = 0;
+    double seconds = 0.0;
+    // Sum and maximum of the sizes of the input taint trees.
+    std::size_t taint_size = 0;
+    std::size_t maximum_taint_size = 0;
+
+    void join_with(const Entry& other);
+    Json::Value to_json() const;
+  };
+
+  MethodProfile() = default;
+  MethodProfile(const MethodProfile&) = default;
+  MethodProfile(MethodProfile&&) = default;
+  MethodProfile& operator=(const MethodProfile&) = default;
+  MethodProfile& operator=(MethodProfile&&) = default;
+  ~MethodProfile() = default;
+
+  /* `name` must outlive the profile, e.g a string literal. */
+  void record(std::string_view name, double seconds, std::size_t taint_size);
+
+  void join_with(const MethodProfile& other);
+
+  /* Total time of the given scope. */
+  double seconds(std::string_view name) const;
+
+  Json::Value to_json() const;
+
+ private:
+  std::unordered_map<std::string_view, Entry> entries_;
+};
+
+/**
+ * Record the time spent in the current scope into the given profile, if any.
+ *
+ * Scopes can be nested, in which case times are inclusive.
+ */
+class ProfileScope final {
+ public:
+  ProfileScope(
+      MethodProfile* MT_NULLABLE profile,
+      std::string_view name,
+      std::size_t taint_size = 0);
+  ProfileScope(const ProfileScope&) = delete;
+  ProfileScope(ProfileScope&&) = delete;
+  ProfileScope& operator=(const ProfileScope&) = delete;
+  ProfileScope& operator=(ProfileScope&&) = delete;
+  ~ProfileScope();
+
+ private:
+  MethodProfile* MT_NULLABLE profile_;
+  std::string_view name_;
+  std::size_t taint_size_;
+  std::chrono::time_point<std::chrono::steady_clock> start_;
+};
+
+/**
+ * Collect the profiles of all method analyses, when `--profile-analysis` is
+ * used.
+ */
+class Profiler final {
+ public:
+  Profiler() = default;
+  Profiler(const Profiler&) = delete;
+  Profiler(Profiler&&) = delete;
+  Profiler& operator=(const Profiler&) = delete;
+  Profiler& operator=(Profiler&&) = delete;
+  ~Profiler() = default;
+
+  /* Record the profile of an analysis of the given method. Thread-safe. */
+  void record(const Method* method, const MethodProfile& profile);
+
+  /**
+   * Return the totals per transfer function, over all analyses, and the
+   * profiles of the `kRecordMethods` methods that took the most time.
+   */
+  Json::Value to_json() const;
+
+  /* Maximum number of method profiles to report. */
+  constexpr static std::size_t kRecordMethods = 100;
+
+  /* Name of the scope covering the whole analysis of a method. */
+  constexpr static std::string_view kAnalyzeMethod = "analyze_method";
+
+ private:
+  mutable std::mutex mutex_;
+  MethodProfile total_;
+  // Joined profiles of all analyses, per method.
+  std::unordered_map<const Method*, MethodProfile> methods_;
+};
+
+} // namespace marianatrench
@@ -17,7 +17,7 @@ bool Propagation::leq(const Propagation& other) const {
   } else if (other.is_bottom()) {
     return false;
   } else {
-    return input_.leq(other.input_) &&
+    return input_->leq(*other.input_) &&
         inferred_features_.leq(other.inferred_features_) &&
         user_features_.leq(other.user_features_);
   }
@@ -41,12 +41,24 @@ void Propagation::join_with(const Propagation& other) {
   } else if (other.is_bottom()) {
     return;
   } else {
-    input_.join_with(other.input_);
+    if (input_ != other.input_) {
+      auto input = *input_;
+      input.join_with(*other.input_);
+      input_ = AccessPathFactory::singleton().get(input);
+    }
     inferred_features_.join_with(other.inferred_features_);
     user_features_.join_with(other.user_features_);
   }
 }
 
+void Propagation::truncate(std::size_t size) {
+  if (input_->path().size() > size) {
+    auto input = *input_;
+    input.truncate(size);
+    input_ = AccessPathFactory::singleton().get(input);
+  }
+}
+
 void Propagation::widen_with(const Propagation& other) {
   join_with(other);
 }
@@ -89,7 +101,7 @@ Propagation Propagation::from_json(const Json::Value& value, Context& context) {
 
 Json::Value Propagation::to_json() const {
   auto value = Json::Value(Json::objectValue);
-  value["input"] = input_.to_json();
+  value["input"] = input_->to_json();
   JsonValidation::update_object(value, features().to_json());
   return value;
 }
@@ -97,16 +109,16 @@ Json::Value Propagation::to_json() const {
 bool Propagation::GroupEqual::operator()(
     const Propagation& left,
     const Propagation& right) const {
-  return left.input_.root() == right.input_.root();
+  return left.input_->root() == right.input_->root();
 }
 
 std::size_t Propagation::GroupHash::operator()(
     const Propagation& propagation) const {
-  return propagation.input_.root().encode();
+  return propagation.input_->root().encode();
 }
 
 std::ostream& operator<<(std::ostream& out, const Propagation& propagation) {
-  return out << "Propagation(input=" << propagation.input_
+  return out << "Propagation(input=" << *propagation.input_
              << ", inferred_features=" << propagation.inferred_features_
              << ", user_features=" << propagation.user_features_ << ")";
 }
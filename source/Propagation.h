@@ -12,6 +12,7 @@
 #include <AbstractDomain.h>
 
 #include <mariana-trench/Access.h>
+#include <mariana-trench/AccessPathFactory.h>
 #include <mariana-trench/Assert.h>
 #include <mariana-trench/Context.h>
 #include <mariana-trench/Feature.h>
@@ -36,7 +37,7 @@ class Propagation final : public sparta::AbstractDomain<Propagation> {
  public:
   /* Create the bottom (i.e, invalid) propagation. */
   explicit Propagation()
-      : input_(Root(Root::Kind::Leaf)),
+      : input_(AccessPathFactory::singleton().leaf()),
         inferred_features_(FeatureMayAlwaysSet::bottom()),
         user_features_(FeatureSet::bottom()) {}
 
@@ -44,7 +45,7 @@ class Propagation final : public sparta::AbstractDomain<Propagation> {
       AccessPath input,
       FeatureMayAlwaysSet inferred_features,
       FeatureSet user_features)
-      : input_(std::move(input)),
+      : input_(AccessPathFactory::singleton().get(input)),
         inferred_features_(std::move(inferred_features)),
         user_features_(std::move(user_features)) {}
 
@@ -63,7 +64,7 @@ class Propagation final : public sparta::AbstractDomain<Propagation> {
   }
 
   bool is_bottom() const override {
-    return input_.root().is_leaf();
+    return input_->root().is_leaf();
   }
 
   bool is_top() const override {
@@ -71,7 +72,7 @@ class Propagation final : public sparta::AbstractDomain<Propagation> {
   }
 
   void set_to_bottom() override {
-    input_ = AccessPath(Root(Root::Kind::Leaf));
+    input_ = AccessPathFactory::singleton().leaf();
   }
 
   void set_to_top() override {
@@ -91,7 +92,7 @@ class Propagation final : public sparta::AbstractDomain<Propagation> {
   void narrow_with(const Propagation& other) override;
 
   const AccessPath& input() const {
-    return input_;
+    return *input_;
   }
 
   const FeatureMayAlwaysSet& inferred_features() const {
@@ -104,9 +105,7 @@ class Propagation final : public sparta::AbstractDomain<Propagation> {
 
   FeatureMayAlwaysSet features() const;
 
-  void truncate(std::size_t size) {
-    input_.truncate(size);
-  }
+  void truncate(std::size_t size);
 
   static Propagation from_json(const Json::Value& value, Context& context);
   Json::Value to_json() const;
@@ -126,7 +125,8 @@ class Propagation final : public sparta::AbstractDomain<Propagation> {
       std::ostream& out,
       const Propagation& propagation);
 
-  AccessPath input_;
+  // Interned, see `AccessPathFactory`.
+  const AccessPath* input_;
   FeatureMayAlwaysSet inferred_features_;
   FeatureSet user_features_;
 };
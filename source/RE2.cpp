@@ -62,4 +62,43 @@ std::optional<std::string> as_string_literal(
   return result;
 }
 
+std::optional<std::string> as_string_literal_prefix(
+    const re2::RE2& regular_expression) {
+  if (!regular_expression.ok()) {
+    return std::nullopt;
+  }
+
+  const auto& pattern = regular_expression.pattern();
+  if (pattern.find('|') != std::string::npos) {
+    return std::nullopt;
+  }
+
+  std::string result;
+  std::size_t previous_size = 0;
+  for (std::size_t index = 0; index < pattern.size(); index++) {
+    if (is_literal(pattern[index])) {
+      previous_size = result.size();
+      result.push_back(pattern[index]);
+    } else if (
+        pattern[index] == '\\' && index + 1 < pattern.size() &&
+        is_escapable(pattern[index + 1])) {
+      previous_size = result.size();
+      index++;
+      result.push_back(pattern[index]);
+    } else {
+      // These quantifiers make the last literal optional.
+      if (pattern[index] == '*' || pattern[index] == '?' ||
+          pattern[index] == '{') {
+        result.resize(previous_size);
+      }
+      break;
+    }
+  }
+
+  if (result.empty()) {
+    return std::nullopt;
+  }
+  return result;
+}
+
 } // namespace marianatrench
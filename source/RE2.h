@@ -28,4 +28,21 @@ namespace marianatrench {
  */
 std::optional<std::string> as_string_literal(const re2::RE2& pattern);
 
+/**
+ * Return a non-empty string literal that all full matches of the regular
+ * expression start with, or std::nullopt if there is none.
+ *
+ * This is conservative: patterns containing an alternation never have a
+ * prefix. For instance:
+ * ```
+ * >>> as_string_literal_prefix(re2::RE2("Foo.*"))
+ * <<< std::optional<std::string>("Foo")
+ * >>> as_string_literal_prefix(re2::RE2("Foo?"))
+ * <<< std::optional<std::string>("Fo")
+ * >>> as_string_literal_prefix(re2::RE2("Foo|Bar"))
+ * <<< std::nullopt
+ * ```
+ */
+std::optional<std::string> as_string_literal_prefix(const re2::RE2& pattern);
+
 } // namespace marianatrench
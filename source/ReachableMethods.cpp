@@ -0,0 +1,166 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <memory>
+#include <stdexcept>
+#include <unordered_set>
+#include <vector>
+
+#include <fmt/format.h>
+#include <re2/re2.h>
+
+#include <DexClass.h>
+#include <TypeUtil.h>
+
+#include <mariana-trench/Log.h>
+#include <mariana-trench/ReachableMethods.h>
+
+namespace marianatrench {
+
+namespace {
+
+bool is_manifest_class(
+    const ClassProperties& class_properties,
+    const Method* method) {
+  using Property = ClassProperties::Property;
+  auto properties = class_properties.properties(method->get_class());
+  return properties.test(Property::Exported) ||
+      properties.test(Property::Unexported) ||
+      properties.test(Property::ChildExposed) ||
+      properties.test(Property::DfaPublic);
+}
+
+/**
+ * Return true if the given method overrides a method of a class that is not
+ * part of the application. Unknown super types are assumed to be external,
+ * except `java.lang.Object` to avoid treating all virtual methods as entry
+ * points when system jars are missing.
+ */
+bool overrides_external_method(const Method* method) {
+  const auto* dex_method = method->dex_method();
+  if (!dex_method->is_virtual() || method->is_constructor()) {
+    return false;
+  }
+
+  const auto* name = dex_method->get_name();
+  const auto* proto = dex_method->get_proto();
+  std::vector<const DexType*> worklist = {method->get_class()};
+  std::unordered_set<const DexType*> visited;
+  while (!worklist.empty()) {
+    const auto* type = worklist.back();
+    worklist.pop_back();
+    if (!visited.insert(type).second) {
+      continue;
+    }
+
+    const auto* klass = type_class(type);
+    if (klass == nullptr) {
+      if (type == type::java_lang_Object()) {
+        continue;
+      }
+      return true;
+    }
+    if (klass->is_external() &&
+        DexMethod::get_method(type, name, proto) != nullptr) {
+      return true;
+    }
+
+    if (const auto* super_class = klass->get_super_class()) {
+      worklist.push_back(super_class);
+    }
+    for (const auto* interface : *klass->get_interfaces()) {
+      worklist.push_back(interface);
+    }
+  }
+  return false;
+}
+
+} // namespace
+
+ReachableMethods::ReachableMethods(
+    const Options& options,
+    const Methods& methods,
+    const ClassProperties& class_properties,
+    const CallGraph& call_graph,
+    const std::vector<const Method*>& lifecycle_methods)
+    : reachable_(methods.size(), false), size_(0) {
+  std::vector<std::unique_ptr<re2::RE2>> patterns;
+  for (const auto& pattern : options.entry_point_patterns()) {
+    patterns.push_back(std::make_unique<re2::RE2>(pattern));
+    if (!patterns.back()->ok()) {
+      throw std::invalid_argument(fmt::format(
+          "Invalid entry point pattern `{}`: {}",
+          pattern,
+          patterns.back()->error()));
+    }
+  }
+  auto matches_pattern = [&](const Method* method) {
+    for (const auto& pattern : patterns) {
+      if (re2::RE2::FullMatch(method->show(), *pattern)) {
+        return true;
+      }
+    }
+    return false;
+  };
+
+  std::vector<const Method*> worklist(
+      lifecycle_methods.begin(), lifecycle_methods.end());
+  std::size_t number_entry_points = 0;
+  for (const auto* method : methods) {
+    if (method->get_code() == nullptr) {
+      continue;
+    }
+    if (is_manifest_class(class_properties, method) ||
+        method->get_name() == "<clinit>" ||
+        overrides_external_method(method) || matches_pattern(method)) {
+      worklist.push_back(method);
+      number_entry_points++;
+    }
+  }
+  number_entry_points += lifecycle_methods.size();
+
+  auto add = [&](const Method* MT_NULLABLE method) {
+    if (method != nullptr && !contains(method)) {
+      worklist.push_back(method);
+    }
+  };
+  while (!worklist.empty()) {
+    const auto* method = worklist.back();
+    worklist.pop_back();
+    if (contains(method)) {
+      continue;
+    }
+    reachable_[method->id()] = true;
+    size_++;
+
+    for (const auto& call_target : call_graph.callees(method)) {
+      if (!call_target.resolved()) {
+        continue;
+      }
+      add(call_target.resolved_base_callee());
+      if (call_target.is_virtual()) {
+        for (const auto* override : call_target.overrides()) {
+          add(override);
+        }
+      }
+    }
+    for (const auto& [_, artificial_callees] :
+         call_graph.artificial_callees(method)) {
+      for (const auto& artificial_callee : artificial_callees) {
+        add(artificial_callee.call_target.resolved_base_callee());
+      }
+    }
+  }
+
+  LOG(1,
+      "Found {} methods reachable from {} entry points, out of {} methods.",
+      size_,
+      number_entry_points,
+      methods.size());
+}
+
+} // namespace marianatrench
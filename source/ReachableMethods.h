@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include <mariana-trench/CallGraph.h>
+#include <mariana-trench/ClassProperties.h>
+#include <mariana-trench/Method.h>
+#include <mariana-trench/Methods.h>
+#include <mariana-trench/Options.h>
+
+namespace marianatrench {
+
+/**
+ * Methods reachable from the entry points of the application.
+ *
+ * Entry points are:
+ * - methods of the classes declared in the manifest (see `ClassProperties`),
+ * - life-cycle wrapper methods,
+ * - methods overriding a method of a class outside of the application, which
+ *   the framework may call back (e.g `Runnable.run`, `View.onClick`),
+ * - static initializers,
+ * - methods matching one of the `--entry-point-pattern` regular expressions.
+ *
+ * Reachability follows the call graph, including overrides and artificial
+ * callees. Methods only called through reflection must be added as patterns.
+ */
+class ReachableMethods final {
+ public:
+  explicit ReachableMethods(
+      const Options& options,
+      const Methods& methods,
+      const ClassProperties& class_properties,
+      const CallGraph& call_graph,
+      const std::vector<const Method*>& lifecycle_methods);
+
+  ReachableMethods(const ReachableMethods&) = delete;
+  ReachableMethods(ReachableMethods&&) = delete;
+  ReachableMethods& operator=(const ReachableMethods&) = delete;
+  ReachableMethods& operator=(ReachableMethods&&) = delete;
+  ~ReachableMethods() = default;
+
+  bool contains(const Method* method) const {
+    return method->id() < reachable_.size() && reachable_[method->id()];
+  }
+
+  std::size_t size() const {
+    return size_;
+  }
+
+ private:
+  // Indexed by method identifier (see `Method::id`).
+  std::vector<bool> reachable_;
+  std::size_t size_;
+};
+
+} // namespace marianatrench
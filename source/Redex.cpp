@@ -5,13 +5,26 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <algorithm>
+#include <fstream>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+#include <boost/functional/hash.hpp>
 #include <json/json.h>
 
+#include <ControlFlow.h>
 #include <Creators.h>
 #include <DexAccess.h>
 #include <DexClass.h>
 #include <DexUtil.h>
 #include <IRAssembler.h>
+#include <IRCode.h>
 #include <ProguardConfiguration.h>
 #include <ProguardMap.h>
 #include <ProguardMatcher.h>
@@ -19,6 +32,7 @@
 #include <Reachability.h>
 #include <RedexContext.h>
 #include <Resolver.h>
+#include <Show.h>
 
 #include <mariana-trench/Assert.h>
 #include <mariana-trench/JsonValidation.h>
@@ -52,6 +66,25 @@ DexType* redex::get_type(const std::string& type) {
   return DexType::get_type(type);
 }
 
+std::size_t redex::code_hash(const IRCode& code) {
+  std::size_t seed = 0;
+  if (!code.cfg_built()) {
+    return seed;
+  }
+
+  for (const auto* block : code.cfg().blocks()) {
+    boost::hash_combine(seed, block->id());
+    for (const auto& instruction : InstructionIterable(block)) {
+      boost::hash_combine(seed, show(instruction.insn));
+    }
+    for (const auto* edge : block->succs()) {
+      boost::hash_combine(seed, edge->target()->id());
+      boost::hash_combine(seed, static_cast<int>(edge->type()));
+    }
+  }
+  return seed;
+}
+
 void redex::process_proguard_configurations(
     const Options& options,
     const DexStoresVector& stores) {
@@ -84,6 +117,115 @@ void redex::process_proguard_configurations(
       false);
 }
 
+namespace {
+
+void hash_file(std::size_t& seed, const std::string& path) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file) {
+    boost::hash_combine(seed, path);
+    return;
+  }
+  std::vector<char> buffer(1 << 20);
+  while (file) {
+    file.read(buffer.data(), buffer.size());
+    boost::hash_combine(
+        seed,
+        std::hash<std::string_view>()(
+            std::string_view(buffer.data(), file.gcount())));
+  }
+}
+
+/**
+ * Key of the reachability cache: the set of removed symbols only depends on
+ * the apk, the proguard configurations and the system jars.
+ */
+std::string reachability_cache_key(const Options& options) {
+  std::size_t seed = 0;
+  hash_file(seed, options.apk_path());
+  for (const auto& path : options.proguard_configuration_paths()) {
+    hash_file(seed, path);
+  }
+  for (const auto& path : options.system_jar_paths()) {
+    hash_file(seed, path);
+  }
+  return std::to_string(seed);
+}
+
+std::optional<std::vector<std::string>> read_reachability_cache(
+    const boost::filesystem::path& path,
+    const std::string& key) {
+  if (!boost::filesystem::exists(path)) {
+    return std::nullopt;
+  }
+
+  auto value = JsonValidation::parse_json_file(path);
+  if (JsonValidation::string(value, /* field */ "key") != key) {
+    LOG(1, "Reachability cache `{}` is out of date.", path.native());
+    return std::nullopt;
+  }
+
+  std::vector<std::string> symbols;
+  for (const auto& symbol :
+       JsonValidation::null_or_array(value, /* field */ "removed_symbols")) {
+    symbols.push_back(JsonValidation::string(symbol));
+  }
+  return symbols;
+}
+
+void write_reachability_cache(
+    const boost::filesystem::path& path,
+    const std::string& key,
+    const ConcurrentSet<std::string>& removed_symbols) {
+  auto symbols = Json::Value(Json::arrayValue);
+  for (const auto& symbol : removed_symbols) {
+    symbols.append(symbol);
+  }
+  auto value = Json::Value(Json::objectValue);
+  value["key"] = key;
+  value["removed_symbols"] = symbols;
+  JsonValidation::write_json_file(path, value);
+}
+
+/* Remove the given classes, methods and fields from the stores. */
+void remove_symbols(
+    DexStoresVector& stores,
+    const std::vector<std::string>& symbols) {
+  std::unordered_set<const DexClass*> removed_classes;
+  for (const auto& symbol : symbols) {
+    if (symbol.find(":(") != std::string::npos) {
+      auto* method = redex::get_method(symbol);
+      if (method != nullptr) {
+        type_class(method->get_class())->remove_method(method);
+      }
+    } else if (symbol.find(':') != std::string::npos) {
+      auto* field = redex::get_field(symbol);
+      if (field != nullptr && field->is_def()) {
+        type_class(field->get_class())->remove_field(field->as_def());
+      }
+    } else {
+      auto* dex_class = redex::get_class(symbol);
+      if (dex_class != nullptr) {
+        removed_classes.insert(dex_class);
+      }
+    }
+  }
+
+  for (auto& store : stores) {
+    for (auto& dex : store.get_dexen()) {
+      dex.erase(
+          std::remove_if(
+              dex.begin(),
+              dex.end(),
+              [&](const DexClass* dex_class) {
+                return removed_classes.count(dex_class) > 0;
+              }),
+          dex.end());
+    }
+  }
+}
+
+} // namespace
+
 void redex::remove_unreachable(
     const Options& options,
     DexStoresVector& stores) {
@@ -91,12 +233,33 @@ void redex::remove_unreachable(
       options.proguard_configuration_paths();
   const std::optional<boost::filesystem::path>& removed_symbols_path =
       options.removed_symbols_output_path();
+  const auto& cache_path = options.reachability_cache_path();
   keep_rules::ProguardConfiguration proguard_configuration;
 
   if (proguard_configuration_paths.empty()) {
     return;
   }
 
+  std::string cache_key;
+  if (cache_path) {
+    cache_key = reachability_cache_key(options);
+    if (auto symbols = read_reachability_cache(*cache_path, cache_key)) {
+      LOG(1,
+          "Removing {} unreachable symbols from cache `{}`.",
+          symbols->size(),
+          *cache_path);
+      remove_symbols(stores, *symbols);
+      if (removed_symbols_path) {
+        auto value = Json::Value(Json::arrayValue);
+        for (const auto& symbol : *symbols) {
+          value.append(symbol);
+        }
+        JsonValidation::write_json_file(*removed_symbols_path, value);
+      }
+      return;
+    }
+  }
+
   auto reachables = reachability::compute_reachable_objects(
       stores,
       /* empty ignore sets */ reachability::IgnoreSets(),
@@ -112,7 +275,14 @@ void redex::remove_unreachable(
 
   ConcurrentSet<std::string> removed_symbols;
   reachability::sweep(
-      stores, *reachables, removed_symbols_path ? &removed_symbols : nullptr);
+      stores,
+      *reachables,
+      removed_symbols_path || cache_path ? &removed_symbols : nullptr);
+
+  if (cache_path) {
+    LOG(1, "Writing reachability cache to `{}`.", *cache_path);
+    write_reachability_cache(*cache_path, cache_key, removed_symbols);
+  }
 
   if (removed_symbols_path) {
     auto value = Json::Value(Json::arrayValue);
@@ -41,6 +41,13 @@ DexFieldRef* MT_NULLABLE get_field(const std::string& field);
 
 DexType* MT_NULLABLE get_type(const std::string& type);
 
+/**
+ * Return a hash of the instructions and control flow graph of the given code.
+ *
+ * This is stable across runs, as long as the code does not change.
+ */
+std::size_t code_hash(const IRCode& code);
+
 void process_proguard_configurations(
     const Options& options,
     const DexStoresVector& stores);
@@ -5,33 +5,88 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
 #include <cstdio>
+#include <functional>
+#include <numeric>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
 
 #include <boost/algorithm/string/predicate.hpp>
 #include <boost/filesystem/string_file.hpp>
+#include <boost/iostreams/categories.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
 #include <fmt/format.h>
 
-#include <SpartaWorkQueue.h>
-
 #include <json/value.h>
+#include <mariana-trench/BinaryJson.h>
+#include <mariana-trench/CallsiteModelCache.h>
+#include <mariana-trench/JsonArrayFile.h>
 #include <mariana-trench/JsonValidation.h>
+#include <mariana-trench/KindCosts.h>
 #include <mariana-trench/Log.h>
+#include <mariana-trench/MemoryBudget.h>
 #include <mariana-trench/Methods.h>
+#include <mariana-trench/ModelSlabs.h>
+#include <mariana-trench/NumaPlacement.h>
 #include <mariana-trench/Options.h>
+#include <mariana-trench/Partitions.h>
 #include <mariana-trench/Registry.h>
 #include <mariana-trench/Rules.h>
+#include <mariana-trench/ShardWriter.h>
 #include <mariana-trench/Statistics.h>
+#include <mariana-trench/Types.h>
+#include <mariana-trench/UnusedKinds.h>
+#include <mariana-trench/WorkerPool.h>
 
 namespace marianatrench {
 
-Registry::Registry(Context& context) : context_(context) {
-  auto queue = sparta::work_queue<const Method*>(
-      [&](const Method* method) { set(Model(method, context)); },
-      sparta::parallel::default_num_threads());
-  for (const auto* method : *context.methods) {
-    queue.add_item(method);
+namespace {
+
+// Number of json models converted at once when loading models.
+constexpr std::size_t k_load_chunk_size = 1000;
+
+// Marks an implicit model in `Registry::implicit_modes_`, since its modes can
+// be empty.
+constexpr std::uint16_t k_implicit_model = 0x100;
+
+std::uint16_t encode_implicit_modes(Model::Modes modes) {
+  std::uint16_t encoded = k_implicit_model;
+  for (auto mode : k_all_modes) {
+    if (modes.test(mode)) {
+      encoded |= static_cast<std::uint16_t>(mode);
+    }
   }
-  queue.run_all();
+  return encoded;
+}
+
+Model::Modes decode_implicit_modes(std::uint16_t encoded) {
+  Model::Modes modes;
+  for (auto mode : k_all_modes) {
+    if ((encoded & static_cast<std::uint16_t>(mode)) != 0) {
+      modes |= mode;
+    }
+  }
+  return modes;
+}
+
+/* Whether the model is entirely defined by its method and its modes. */
+bool is_implicit_model(const Model& model, Context& context) {
+  return model.generations().is_bottom() &&
+      model.parameter_sources().is_bottom() && model.sinks().is_bottom() &&
+      model.issues().empty() &&
+      model == Model(model.method(), context, model.modes());
+}
+
+} // namespace
+
+Registry::Registry(Context& context) : context_(context) {
+  add_default_models();
 }
 
 Registry::Registry(
@@ -68,23 +123,106 @@ Registry Registry::load(
     Context& context,
     const Options& options,
     const std::vector<Model>& generated_models,
-    const std::vector<FieldModel>& generated_field_models) {
+    const std::vector<FieldModel>& generated_field_models,
+    const UnusedKinds& unused_kinds) {
   // Create a registry with the generated models
-  Registry registry(context, generated_models, generated_field_models);
+  Registry registry(
+      context,
+      /* models */ std::vector<Model>{},
+      /* field_models */ generated_field_models);
+  for (auto model : generated_models) {
+    unused_kinds.remove_from(model);
+    registry.join_with(model);
+  }
+
+  // Map and delimit json input files in parallel. Elements are only parsed
+  // when they are converted, to avoid holding entire json trees in memory.
+  std::vector<std::string> paths;
+  paths.insert(
+      paths.end(),
+      options.models_paths().begin(),
+      options.models_paths().end());
+  auto number_of_models_paths = paths.size();
+  paths.insert(
+      paths.end(),
+      options.field_models_paths().begin(),
+      options.field_models_paths().end());
+
+  std::vector<std::unique_ptr<JsonArrayFile>> files(paths.size());
+  auto parse_queue = WorkQueue<std::size_t>(
+      context.worker_pool.get(),
+      [&](std::size_t index) {
+        files[index] = std::make_unique<JsonArrayFile>(paths[index]);
+      },
+      options.jobs(AnalysisPhase::Models));
+  for (std::size_t index = 0; index < paths.size(); index++) {
+    parse_queue.add_item(index);
+  }
+  parse_queue.run_all();
 
-  // Load models json input
-  for (const auto& models_path : options.models_paths()) {
-    registry.join_with(Registry(
-        context,
-        /* models_value */ JsonValidation::parse_json_file(models_path),
-        /* field_models_value */ Json::Value(Json::arrayValue)));
+  // Convert chunks of the json arrays into per-thread partial registries.
+  struct Chunk {
+    const JsonArrayFile* file;
+    bool field_models;
+    std::size_t begin;
+    std::size_t end;
+  };
+  std::vector<Chunk> chunks;
+  for (std::size_t index = 0; index < files.size(); index++) {
+    const auto* file = files[index].get();
+    for (std::size_t begin = 0; begin < file->size();
+         begin += k_load_chunk_size) {
+      chunks.push_back(Chunk{
+          file,
+          /* field_models */ index >= number_of_models_paths,
+          begin,
+          std::min(begin + k_load_chunk_size, file->size())});
+    }
+  }
+
+  // Converted models are buffered per thread rather than joined into partial
+  // registries, which would each allocate a model array.
+  struct PartialModels {
+    std::vector<Model> models;
+    std::vector<FieldModel> field_models;
+  };
+  auto threads = options.jobs(AnalysisPhase::Models);
+  std::vector<PartialModels> partial_models(threads);
+  auto load_queue = WorkQueue<const Chunk*>(
+      context.worker_pool.get(),
+      [&](WorkQueue<const Chunk*>::WorkerState* worker_state,
+          const Chunk* chunk) {
+        auto& partial = partial_models.at(worker_state->worker_id());
+        for (auto index = chunk->begin; index < chunk->end; index++) {
+          auto value = chunk->file->parse(index);
+          if (chunk->field_models) {
+            const auto* field = Field::from_json(value["field"], context);
+            mt_assert(field != nullptr);
+            partial.field_models.push_back(
+                FieldModel::from_json(field, value, context));
+          } else {
+            const auto* method = Method::from_json(value["method"], context);
+            mt_assert(method != nullptr);
+            auto model = Model::from_json(method, value, context);
+            unused_kinds.remove_from(model);
+            partial.models.push_back(std::move(model));
+          }
+        }
+      },
+      threads);
+  for (const auto& chunk : chunks) {
+    load_queue.add_item(&chunk);
   }
-  for (const auto& field_models_path : options.field_models_paths()) {
-    registry.join_with(Registry(
-        context,
-        /* models_value */ Json::Value(Json::arrayValue),
-        /* field_models_value */
-        JsonValidation::parse_json_file(field_models_path)));
+  load_queue.run_all();
+
+  for (auto& partial : partial_models) {
+    for (const auto& model : partial.models) {
+      registry.join_with(model);
+    }
+    for (const auto& field_model : partial.field_models) {
+      registry.join_with(field_model);
+    }
+    partial = {};
   }
 
   // Add a default model for methods that don't have one
@@ -94,28 +232,101 @@ Registry Registry::load(
 }
 
 void Registry::add_default_models() {
-  auto queue = sparta::work_queue<const Method*>(
-      [&](const Method* method) {
-        models_.insert(std::make_pair(method, Model(method, context_)));
-      },
-      sparta::parallel::default_num_threads());
+  implicit_modes_.resize(
+      std::max(implicit_modes_.size(), context_.methods->size()), 0);
   for (const auto* method : *context_.methods) {
-    queue.add_item(method);
+    auto id = method->id();
+    if (implicit_modes_[id] == 0 && models_.get(id) == nullptr &&
+        (spilled_models_ == nullptr || !spilled_models_->contains(method))) {
+      implicit_modes_[id] = encode_implicit_modes(Model::Modes());
+    }
+  }
+}
+
+template <typename... Arguments>
+std::shared_ptr<const Model> Registry::make_snapshot(
+    Arguments&&... arguments) const {
+  if (context_.options->slab_allocate_models()) {
+    return ModelSlabs::make_shared<Model>(
+        std::forward<Arguments>(arguments)...);
+  }
+  return std::make_shared<const Model>(std::forward<Arguments>(arguments)...);
+}
+
+std::shared_ptr<const Model> Registry::implicit_model(
+    const Method* method) const {
+  auto id = method->id();
+  if (id >= implicit_modes_.size() || implicit_modes_[id] == 0) {
+    return nullptr;
+  }
+  return make_snapshot(
+      method, context_, decode_implicit_modes(implicit_modes_[id]));
+}
+
+template <typename Visitor>
+void Registry::visit_implicit_modes(Visitor&& visitor) const {
+  for (std::size_t id = 0; id < implicit_modes_.size(); id++) {
+    if (implicit_modes_[id] == 0 || models_.get(id) != nullptr) {
+      continue;
+    }
+    const auto* method = context_.methods->get(id);
+    if (spilled_models_ != nullptr && spilled_models_->contains(method)) {
+      continue;
+    }
+    visitor(method, decode_implicit_modes(implicit_modes_[id]));
   }
-  queue.run_all();
+}
+
+template <typename Visitor>
+void Registry::visit_models(Visitor&& visitor) const {
+  std::size_t next_id = 0;
+  auto visit_implicit_models = [&](std::size_t end) {
+    for (; next_id < std::min(end, implicit_modes_.size()); next_id++) {
+      if (implicit_modes_[next_id] == 0) {
+        continue;
+      }
+      const auto* method = context_.methods->get(next_id);
+      if (spilled_models_ == nullptr || !spilled_models_->contains(method)) {
+        visitor(implicit_model(method));
+      }
+    }
+  };
+  models_.visit_with_index(
+      [&](std::size_t id, const std::shared_ptr<const Model>& model) {
+        visit_implicit_models(id);
+        // A stored model shadows the implicit model of its method.
+        next_id = std::max(next_id, id + 1);
+        visitor(model);
+      });
+  visit_implicit_models(implicit_modes_.size());
 }
 
 Model Registry::get(const Method* method) const {
+  return *get_snapshot(method);
+}
+
+std::shared_ptr<const Model> Registry::get_snapshot(
+    const Method* method) const {
   if (!method) {
     throw std::runtime_error("Trying to get model for the `null` method");
   }
 
-  try {
-    return models_.at(method);
-  } catch (const std::out_of_range&) {
+  auto model = models_.get(method->id());
+  if (model == nullptr && spilled_models_ != nullptr) {
+    model = spilled_models_->get(method, context_);
+  }
+  if (model == nullptr) {
+    model = implicit_model(method);
+    // Another thread might have materialized the model first.
+    if (model != nullptr && !models_.insert(method->id(), model)) {
+      model = models_.get(method->id());
+    }
+  }
+  if (model == nullptr) {
     throw std::runtime_error(fmt::format(
         "Trying to get model for untracked method `{}`.", method->show()));
   }
+  return model;
 }
 
 FieldModel Registry::get(const Field* field) const {
@@ -123,19 +334,109 @@ FieldModel Registry::get(const Field* field) const {
     throw std::runtime_error("Trying to get model for the `null` field");
   }
 
-  try {
-    return field_models_.at(field);
-  } catch (const std::out_of_range&) {
+  const auto* field_model = this->field_model(field);
+  if (field_model == nullptr) {
     return FieldModel(field);
   }
+  return *field_model;
+}
+
+const FieldModel* MT_NULLABLE Registry::field_model(const Field* field) const {
+  auto found = field_models_.find(field);
+  if (found == field_models_.end()) {
+    return nullptr;
+  }
+  return &found->second;
+}
+
+void Registry::set(Model model) {
+  const auto* method = model.method();
+  models_.set(method->id(), make_snapshot(std::move(model)));
+}
+
+void Registry::spill_models(
+    const std::vector<const Method*>& methods,
+    const boost::filesystem::path& directory) {
+  std::vector<std::shared_ptr<const Model>> models;
+  models.reserve(methods.size());
+  for (const auto* method : methods) {
+    auto model = models_.get(method->id());
+    // Issues cannot be parsed back from json, keep these models in memory.
+    if (model != nullptr && model->issues().empty()) {
+      models.push_back(std::move(model));
+    }
+  }
+  if (models.empty()) {
+    return;
+  }
+
+  if (spilled_models_ == nullptr) {
+    spilled_models_ = std::make_unique<SpilledModels>(directory);
+  }
+  spilled_models_->spill(models, context_);
+  for (const auto& model : models) {
+    models_.erase(model->method()->id());
+  }
+}
+
+void Registry::restore_spilled_models() {
+  if (spilled_models_ == nullptr) {
+    return;
+  }
+
+  std::vector<const Method*> methods;
+  methods.reserve(spilled_models_->size());
+  spilled_models_->visit(
+      [&](const Method* method) { methods.push_back(method); });
+  auto queue = WorkQueue<const Method*>(
+      context_.worker_pool.get(),
+      [&](const Method* method) {
+        // Models set after being spilled are more recent.
+        if (models_.get(method->id()) == nullptr) {
+          models_.insert(
+              method->id(), spilled_models_->get(method, context_));
+        }
+      },
+      context_.options->jobs(AnalysisPhase::Models));
+  for (const auto* method : methods) {
+    queue.add_item(method);
+  }
+  queue.run_all();
+  spilled_models_ = nullptr;
 }
 
-void Registry::set(const Model& model) {
-  models_.insert_or_assign(std::make_pair(model.method(), model));
+std::size_t Registry::compact_issues() {
+  std::vector<const Method*> methods;
+  models_.visit([&](const std::shared_ptr<const Model>& model) {
+    if (!model->issues().empty()) {
+      methods.push_back(model->method());
+    }
+  });
+
+  std::atomic<std::size_t> issues = 0;
+  auto queue = WorkQueue<const Method*>(
+      context_.worker_pool.get(),
+      [&](const Method* method) {
+        auto model = *models_.get(method->id());
+        model.compact_issues();
+        issues += model.issues().size();
+        set(std::move(model));
+      },
+      context_.options->jobs(AnalysisPhase::Models));
+  for (const auto* method : methods) {
+    queue.add_item(method);
+  }
+  queue.run_all();
+  return issues.load();
 }
 
 std::size_t Registry::models_size() const {
-  return models_.size();
+  std::size_t implicit_models = 0;
+  visit_implicit_modes(
+      [&](const Method* /* method */, Model::Modes /* modes */) {
+        implicit_models++;
+      });
+  return models_.size() + implicit_models;
 }
 
 std::size_t Registry::field_models_size() const {
@@ -144,20 +445,35 @@ std::size_t Registry::field_models_size() const {
 
 std::size_t Registry::issues_size() const {
   std::size_t result = 0;
-  for (const auto& entry : models_) {
-    result += entry.second.issues().size();
-  }
+  models_.visit([&](const std::shared_ptr<const Model>& model) {
+    result += model->issues().size();
+  });
   return result;
 }
 
 void Registry::join_with(const Model& model) {
   const auto* method = model.method();
   mt_assert(method);
-  auto iterator = models_.find(method);
-  if (iterator != models_.end()) {
-    iterator->second.join_with(model);
+  auto existing = models_.get(method->id());
+  if (existing == nullptr && spilled_models_ != nullptr) {
+    existing = spilled_models_->get(method, context_);
+  }
+  if (existing == nullptr) {
+    existing = implicit_model(method);
+  }
+  if (existing == nullptr && is_implicit_model(model, context_)) {
+    if (implicit_modes_.size() <= method->id()) {
+      implicit_modes_.resize(
+          std::max(method->id() + 1, context_.methods->size()), 0);
+    }
+    implicit_modes_[method->id()] = encode_implicit_modes(model.modes());
+  } else if (existing != nullptr) {
+    // Copy on write, since snapshots might be shared.
+    auto new_model = *existing;
+    new_model.join_with(model);
+    models_.set(method->id(), make_snapshot(std::move(new_model)));
   } else {
-    models_.insert(std::make_pair(method, model));
+    models_.set(method->id(), make_snapshot(model));
   }
 }
 
@@ -173,14 +489,26 @@ void Registry::join_with(const FieldModel& field_model) {
 }
 
 void Registry::join_with(const Registry& other) {
-  for (const auto& other_model : other.models_) {
-    join_with(other_model.second);
-  }
+  other.models_.visit([&](const std::shared_ptr<const Model>& other_model) {
+    join_with(*other_model);
+  });
+  other.visit_implicit_modes([&](const Method* method, Model::Modes modes) {
+    join_with(Model(method, context_, modes));
+  });
   for (const auto& other_field_model : other.field_models_) {
     join_with(other_field_model.second);
   }
 }
 
+MemoryAccounting Registry::memory_accounting() const {
+  // Implicit models do not use memory until they are materialized.
+  MemoryAccounting memory_accounting;
+  models_.visit([&](const std::shared_ptr<const Model>& model) {
+    memory_accounting.add(*model);
+  });
+  return memory_accounting;
+}
+
 void Registry::dump_metadata(const boost::filesystem::path& path) const {
   auto value = Json::Value(Json::objectValue);
 
@@ -196,21 +524,83 @@ void Registry::dump_metadata(const boost::filesystem::path& path) const {
   }
   value["rules"] = rules;
 
+  auto packs = context_.rules->packs();
+  if (!packs.empty()) {
+    auto packs_value = Json::Value(Json::objectValue);
+    for (const auto& [pack, pack_codes] : packs) {
+      auto sorted_codes =
+          std::vector<int>(pack_codes.begin(), pack_codes.end());
+      std::sort(sorted_codes.begin(), sorted_codes.end());
+      auto codes_value = Json::Value(Json::arrayValue);
+      for (auto code : sorted_codes) {
+        codes_value.append(Json::Value(code));
+      }
+      packs_value[pack] = codes_value;
+    }
+    value["rule_packs"] = packs_value;
+  }
+
   auto statistics = context_.statistics->to_json();
   statistics["issues"] = Json::Value(static_cast<Json::UInt64>(issues_size()));
+  std::size_t methods_without_code = 0;
+  std::size_t methods_skipped = 0;
+  models_.visit([&](const std::shared_ptr<const Model>& model) {
+    if (model->method()->get_code() == nullptr) {
+      methods_without_code++;
+    }
+    if (model->skip_analysis()) {
+      methods_skipped++;
+    }
+  });
+  std::size_t implicit_models = 0;
+  visit_implicit_modes([&](const Method* method, Model::Modes modes) {
+    implicit_models++;
+    if (method->get_code() == nullptr) {
+      methods_without_code++;
+    }
+    if (modes.test(Model::Mode::SkipAnalysis)) {
+      methods_skipped++;
+    }
+  });
+  statistics["implicit_models"] =
+      Json::Value(static_cast<Json::UInt64>(implicit_models));
   statistics["methods_analyzed"] =
-      Json::Value(static_cast<Json::UInt64>(models_.size()));
-  statistics["methods_without_code"] = Json::Value(static_cast<Json::UInt64>(
-      std::count_if(models_.begin(), models_.end(), [](const auto& model) {
-        return model.first->get_code() == nullptr;
-      })));
-  statistics["methods_skipped"] = Json::Value(static_cast<Json::UInt64>(
-      std::count_if(models_.begin(), models_.end(), [](const auto& model) {
-        return model.second.skip_analysis();
-      })));
+      Json::Value(static_cast<Json::UInt64>(models_.size() + implicit_models));
+  statistics["methods_without_code"] =
+      Json::Value(static_cast<Json::UInt64>(methods_without_code));
+  statistics["methods_skipped"] =
+      Json::Value(static_cast<Json::UInt64>(methods_skipped));
+  statistics["memory"] = memory_accounting().to_json();
+  if (context_.callsite_model_cache != nullptr) {
+    statistics["callsite_model_cache"] =
+        context_.callsite_model_cache->statistics_to_json();
+  }
+  if (context_.memory_budget != nullptr) {
+    statistics["memory_budget"] = context_.memory_budget->to_json();
+  }
+  if (context_.types != nullptr) {
+    statistics["types"] = context_.types->statistics_to_json();
+  }
+  if (context_.numa_placement != nullptr) {
+    statistics["numa"] = context_.numa_placement->to_json();
+  }
+  if (context_.kind_costs != nullptr) {
+    statistics["kinds"] = context_.kind_costs->to_json(models_to_dump());
+  }
+  if (context_.options->skip_default_models()) {
+    std::size_t default_models = 0;
+    visit_models([&](const std::shared_ptr<const Model>& model) {
+      if (is_default_model(*model)) {
+        default_models++;
+      }
+    });
+    statistics["default_models_skipped"] =
+        Json::Value(static_cast<Json::UInt64>(default_models));
+  }
   value["stats"] = statistics;
 
-  value["filename_spec"] = Json::Value("model@*.json");
+  value["filename_spec"] = Json::Value(
+      context_.options->compress_models() ? "model@*.json.gz" : "model@*.json");
   value["repo_root"] =
       Json::Value(context_.options->repository_root_directory());
   value["root"] = Json::Value(context_.options->source_root_directory());
@@ -226,12 +616,12 @@ std::string Registry::dump_models() const {
   std::stringstream string;
   string << "// @";
   string << "generated\n";
-  for (const auto& model : models_) {
-    writer->write(model.second.to_json(context_), &string);
+  visit_models([&](const std::shared_ptr<const Model>& model) {
+    writer->write(model->to_json(context_), &string);
     string << "\n";
-  }
-  for (const auto& field_model : field_models_) {
-    writer->write(field_model.second.to_json(context_), &string);
+  });
+  for (const auto* field_model : field_models_to_dump()) {
+    writer->write(field_model->to_json(context_), &string);
     string << "\n";
   }
   return string.str();
@@ -240,81 +630,446 @@ std::string Registry::dump_models() const {
 Json::Value Registry::models_to_json() const {
   auto models_value = Json::Value(Json::objectValue);
   models_value["models"] = Json::Value(Json::arrayValue);
-  for (auto model : models_) {
-    models_value["models"].append(model.second.to_json(context_));
-  }
+  visit_models([&](const std::shared_ptr<const Model>& model) {
+    models_value["models"].append(model->to_json(context_));
+  });
   models_value["field_models"] = Json::Value(Json::arrayValue);
-  for (auto field_model : field_models_) {
-    models_value["field_models"].append(field_model.second.to_json(context_));
+  for (const auto* field_model : field_models_to_dump()) {
+    models_value["field_models"].append(field_model->to_json(context_));
   }
   return models_value;
 }
 
-void Registry::dump_models(
+namespace {
+
+void remove_model_files(
     const boost::filesystem::path& path,
-    const std::size_t batch_size) const {
-  // Remove existing model files under this directory.
+    const std::string& extension) {
   for (auto& file : boost::filesystem::directory_iterator(path)) {
     const auto& file_path = file.path();
     if (boost::filesystem::is_regular_file(file_path) &&
-        boost::starts_with(file_path.filename().string(), "model@")) {
+        boost::starts_with(file_path.filename().string(), "model@") &&
+        boost::ends_with(file_path.filename().string(), extension)) {
       boost::filesystem::remove(file_path);
     }
   }
+}
+
+std::size_t taint_frames(const Taint& taint) {
+  std::size_t frames = 0;
+  for (const auto& frame_set : taint) {
+    frames += static_cast<std::size_t>(
+        std::distance(frame_set.begin(), frame_set.end()));
+  }
+  return frames;
+}
 
-  std::vector<Model> models;
-  for (const auto& model : models_) {
-    models.push_back(model.second);
+/* Estimate the size of the json representation of a model, in frames. */
+std::size_t estimated_json_size(const Model& model) {
+  std::size_t size = 1;
+  auto add_taint_tree = [&](const TaintAccessPathTree& tree) {
+    tree.visit([&](const AccessPath& /* access_path */, const Taint& taint) {
+      size += 1 + taint_frames(taint);
+    });
+  };
+  add_taint_tree(model.generations());
+  add_taint_tree(model.parameter_sources());
+  add_taint_tree(model.sinks());
+  model.propagations().visit([&](const AccessPath& /* access_path */,
+                                 const PropagationSet& propagations) {
+    size += 1 + propagations.size();
+  });
+  for (const auto& issue : model.issues()) {
+    size += issue.frames_size();
   }
+  return size;
+}
 
-  std::vector<FieldModel> field_models;
-  for (const auto& field_model : field_models_) {
-    field_models.push_back(field_model.second);
+/**
+ * Split models with the given estimated sizes into contiguous shards of at
+ * most `batch_size` models, balanced on the estimated sizes. There are as many
+ * shards as when splitting on the number of models, unless a shard reaches
+ * `batch_size` models.
+ */
+std::vector<std::pair<std::size_t, std::size_t>> balanced_shards(
+    const std::vector<std::size_t>& sizes,
+    std::size_t batch_size) {
+  const auto total_batch = sizes.size() / batch_size + 1;
+  auto remaining_size =
+      std::accumulate(sizes.begin(), sizes.end(), std::size_t(0));
+
+  std::vector<std::pair<std::size_t, std::size_t>> shards;
+  std::size_t begin = 0;
+  std::size_t shard_size = 0;
+  for (std::size_t i = 0; i < sizes.size(); i++) {
+    shard_size += sizes[i];
+    bool full = i + 1 - begin == batch_size;
+    bool has_fair_share = shards.size() + 1 < total_batch &&
+        shard_size * (total_batch - shards.size()) >= remaining_size;
+    if (full || has_fair_share) {
+      shards.emplace_back(begin, i + 1);
+      remaining_size -= shard_size;
+      shard_size = 0;
+      begin = i + 1;
+    }
   }
+  if (begin < sizes.size() || shards.empty()) {
+    shards.emplace_back(begin, sizes.size());
+  }
+  return shards;
+}
+
+/* A boost iostreams sink appending to a file of a `ShardWriter`. */
+class ShardWriterSink final {
+ public:
+  using char_type = char;
+  using category = boost::iostreams::sink_tag;
+
+  explicit ShardWriterSink(ShardWriter::File& file) : file_(&file) {}
+
+  std::streamsize write(const char* data, std::streamsize size) {
+    file_->write(data, static_cast<std::size_t>(size));
+    return size;
+  }
+
+ private:
+  ShardWriter::File* file_;
+};
 
-  const auto total_batch =
-      (models_.size() + field_models_.size()) / batch_size + 1;
-  const auto padded_total_batch = fmt::format("{:0>5}", total_batch);
+/* Construct a valid sharded file name for SAPP. */
+std::string shard_filename(
+    std::size_t batch,
+    std::size_t total_batch,
+    const std::string& extension) {
+  return fmt::format("model@{:0>5}-of-{:0>5}{}", batch, total_batch, extension);
+}
+
+/**
+ * Call `write_shard(shard_path, shard, begin, end)` for each shard, in
+ * parallel.
+ * Shards with the largest estimated size are written first, so that a large
+ * shard does not delay the end of the dump.
+ *
+ * Return the number of shards.
+ */
+std::size_t write_shards(
+    const boost::filesystem::path& path,
+    const std::string& extension,
+    const std::vector<std::size_t>& sizes,
+    std::size_t batch_size,
+    WorkerPool* MT_NULLABLE pool,
+    unsigned int threads,
+    const std::function<void(
+        const boost::filesystem::path&,
+        std::size_t,
+        std::size_t,
+        std::size_t)>& write_shard) {
+  const auto shards = balanced_shards(sizes, batch_size);
+
+  std::vector<std::pair<std::size_t, std::size_t>> batches;
+  for (std::size_t batch = 0; batch < shards.size(); batch++) {
+    const auto& [begin, end] = shards[batch];
+    auto size = std::accumulate(
+        sizes.begin() + begin, sizes.begin() + end, std::size_t(0));
+    batches.emplace_back(size, batch);
+  }
+  std::sort(batches.begin(), batches.end(), std::greater<>());
 
-  auto queue = sparta::work_queue<std::size_t>(
+  auto queue = WorkQueue<std::size_t>(
+      pool,
       [&](std::size_t batch) {
-        // Construct a valid sharded file name for SAPP.
-        const auto padded_batch = fmt::format("{:0>5}", batch);
-        const auto batch_path = path /
-            ("model@" + padded_batch + "-of-" + padded_total_batch + ".json");
+        const auto batch_path =
+            path / shard_filename(batch, shards.size(), extension);
+        write_shard(
+            batch_path, batch, shards[batch].first, shards[batch].second);
+      },
+      threads);
 
-        std::ofstream batch_stream(batch_path.native(), std::ios_base::out);
-        if (!batch_stream.is_open()) {
-          ERROR(1, "Unable to write models to `{}`.", batch_path.native());
+  for (const auto& [_, batch] : batches) {
+    queue.add_item(batch);
+  }
+  queue.run_all();
+
+  return shards.size();
+}
+
+/* Estimated json sizes of the given models and field models, in order. */
+std::vector<std::size_t> estimated_json_sizes(
+    const std::vector<std::shared_ptr<const Model>>& models,
+    const std::vector<const FieldModel*>& field_models,
+    WorkerPool* MT_NULLABLE pool,
+    unsigned int threads) {
+  std::vector<std::size_t> sizes(models.size(), 0);
+  auto queue = WorkQueue<std::size_t>(
+      pool,
+      [&](std::size_t index) {
+        sizes[index] = estimated_json_size(*models[index]);
+      },
+      threads);
+  for (std::size_t index = 0; index < models.size(); index++) {
+    queue.add_item(index);
+  }
+  queue.run_all();
+
+  // Field models are small, they are counted as a single frame.
+  sizes.resize(models.size() + field_models.size(), 1);
+  return sizes;
+}
+
+/* Position of a model in the json shards. */
+struct ModelPosition {
+  std::size_t shard;
+  std::uint64_t offset;
+  std::uint64_t length;
+};
+
+/**
+ * Write `models_index.json`, mapping method and field signatures to their
+ * position in the json shards, so that a model can be read with a single
+ * seek.
+ */
+void write_models_index(
+    const boost::filesystem::path& path,
+    std::size_t total_batch,
+    const std::vector<std::shared_ptr<const Model>>& models,
+    const std::vector<const FieldModel*>& field_models,
+    const std::vector<ModelPosition>& positions) {
+  auto to_json = [](const ModelPosition& position) {
+    auto value = Json::Value(Json::arrayValue);
+    value.append(Json::UInt64(position.shard));
+    value.append(Json::UInt64(position.offset));
+    value.append(Json::UInt64(position.length));
+    return value;
+  };
+
+  auto index = Json::Value(Json::objectValue);
+  auto shards = Json::Value(Json::arrayValue);
+  for (std::size_t batch = 0; batch < total_batch; batch++) {
+    shards.append(shard_filename(batch, total_batch, ".json"));
+  }
+  index["shards"] = shards;
+  auto methods = Json::Value(Json::objectValue);
+  for (std::size_t i = 0; i < models.size(); i++) {
+    methods[models[i]->method()->show()] = to_json(positions[i]);
+  }
+  index["methods"] = methods;
+  auto fields = Json::Value(Json::objectValue);
+  for (std::size_t i = 0; i < field_models.size(); i++) {
+    fields[field_models[i]->field()->show()] =
+        to_json(positions[models.size() + i]);
+  }
+  index["fields"] = fields;
+
+  JsonValidation::write_json_file(path / "models_index.json", index);
+}
+
+} // namespace
+
+bool Registry::is_default_model(const Model& model) const {
+  return model.method() != nullptr &&
+      model == Model(model.method(), context_);
+}
+
+std::vector<std::shared_ptr<const Model>> Registry::models_to_dump() const {
+  bool skip_default_models = context_.options != nullptr &&
+      context_.options->skip_default_models();
+  std::vector<std::shared_ptr<const Model>> models;
+  models.reserve(models_.size());
+  visit_models([&](const std::shared_ptr<const Model>& model) {
+    // Other partitions write their own models.
+    if (context_.partitions != nullptr &&
+        !context_.partitions->is_local(model->method())) {
+      return;
+    }
+    if (!skip_default_models || !is_default_model(*model)) {
+      models.push_back(model);
+    }
+  });
+  return models;
+}
+
+std::vector<const FieldModel*> Registry::field_models_to_dump() const {
+  std::vector<const FieldModel*> field_models;
+  field_models.reserve(field_models_.size());
+  for (const auto& field_model : field_models_) {
+    field_models.push_back(&field_model.second);
+  }
+  std::sort(
+      field_models.begin(),
+      field_models.end(),
+      [](const FieldModel* left, const FieldModel* right) {
+        return left->field()->show() < right->field()->show();
+      });
+  return field_models;
+}
+
+void Registry::dump_models(
+    const boost::filesystem::path& path,
+    const std::size_t batch_size) const {
+  dump_json_models(path, batch_size, /* compress */ false);
+}
+
+void Registry::dump_compressed_models(
+    const boost::filesystem::path& path,
+    const std::size_t batch_size) const {
+  dump_json_models(path, batch_size, /* compress */ true);
+}
+
+void Registry::dump_json_models(
+    const boost::filesystem::path& path,
+    const std::size_t batch_size,
+    bool compress) const {
+  // Remove existing model files under this directory, compressed or not.
+  remove_model_files(path, ".json");
+  remove_model_files(path, ".json.gz");
+
+  // Models are referenced rather than copied: this runs when memory usage
+  // peaks, at the end of the analysis. Each model is converted to json and
+  // written out one at a time. Only implicit models are materialized here.
+  auto models = models_to_dump();
+
+  auto field_models = field_models_to_dump();
+
+  // Position of each model in its shard, for the index. Each shard is written
+  // by a single thread, which only updates the entries of its models.
+  std::vector<ModelPosition> positions(models.size() + field_models.size());
+
+  auto* pool = context_.worker_pool.get();
+  auto threads = context_.options->jobs(AnalysisPhase::Models);
+
+  // Analysis threads serialize models into buffers, which are written by
+  // dedicated threads. Two buffers per analysis thread let serialization
+  // continue while the previous buffer is written.
+  auto shard_writer = ShardWriter(
+      context_.options->model_output_threads(),
+      ShardWriter::kDefaultBufferSize,
+      /* maximum_buffers */ 2 * threads,
+      context_.options->sync_models() ? ShardWriter::Sync::Files
+                                      : ShardWriter::Sync::None);
+
+  auto total_batch = write_shards(
+      path,
+      compress ? ".json.gz" : ".json",
+      estimated_json_sizes(models, field_models, pool, threads),
+      batch_size,
+      pool,
+      threads,
+      [&](const boost::filesystem::path& batch_path,
+          std::size_t batch,
+          std::size_t begin,
+          std::size_t end) {
+        std::optional<ShardWriter::File> file;
+        try {
+          file.emplace(shard_writer.open(batch_path));
+        } catch (const std::runtime_error& exception) {
+          ERROR(1, "Unable to write models: {}", exception.what());
           return;
         }
-        batch_stream << "// @"
-                     << "generated\n";
+        // Compression runs on the serializing thread.
+        boost::iostreams::filtering_ostream compressed_stream;
+        if (compress) {
+          compressed_stream.push(boost::iostreams::gzip_compressor());
+          compressed_stream.push(ShardWriterSink(*file));
+        }
+        auto write = [&](const std::string& string) {
+          if (compress) {
+            compressed_stream << string;
+          } else {
+            file->write(string);
+          }
+        };
+        const std::string header = "// @"
+                                   "generated\n";
+        write(header);
 
-        // Write the current batch of models to file.
+        // Write the current batch of models to file, one per line.
         auto writer = JsonValidation::compact_writer();
-        for (std::size_t i = batch_size * batch; i < batch_size * (batch + 1) &&
-             i < models.size() + field_models.size();
-             i++) {
+        std::uint64_t offset = header.size();
+        std::ostringstream line;
+        for (std::size_t i = begin; i < end; i++) {
+          line.str("");
           if (i < models.size()) {
-            writer->write(models[i].to_json(context_), &batch_stream);
+            writer->write(models[i]->to_json(context_), &line);
           } else {
             writer->write(
-                field_models[i - models.size()].to_json(context_),
-                &batch_stream);
+                field_models[i - models.size()]->to_json(context_), &line);
           }
-          batch_stream << "\n";
+          line << "\n";
+          auto model_line = line.str();
+          write(model_line);
+          positions[i] = ModelPosition{batch, offset, model_line.size()};
+          offset += model_line.size();
         }
-        batch_stream.close();
-      },
-      sparta::parallel::default_num_threads());
+        // Flush the compressor before closing the file.
+        compressed_stream.reset();
+        file->close();
+      });
 
-  for (std::size_t batch = 0; batch < total_batch; batch++) {
-    queue.add_item(batch);
+  try {
+    shard_writer.finish();
+  } catch (const std::runtime_error& exception) {
+    ERROR(1, "Unable to write models: {}", exception.what());
   }
-  queue.run_all();
+  if (context_.statistics != nullptr) {
+    context_.statistics->log_output(
+        compress ? "compressed_models" : "models", shard_writer.statistics());
+  }
+
+  LOG(1,
+      "Wrote {}models to {} shards.",
+      compress ? "compressed " : "",
+      total_batch);
+
+  // Offsets in compressed shards do not allow random access.
+  if (!compress) {
+    write_models_index(path, total_batch, models, field_models, positions);
+  }
+}
+
+void Registry::dump_binary_models(
+    const boost::filesystem::path& path,
+    const std::size_t batch_size) const {
+  // Remove existing binary model files under this directory.
+  remove_model_files(path, ".bin");
+
+  auto models = models_to_dump();
+
+  auto field_models = field_models_to_dump();
+
+  auto* pool = context_.worker_pool.get();
+  auto threads = context_.options->jobs(AnalysisPhase::Models);
+  auto total_batch = write_shards(
+      path,
+      ".bin",
+      estimated_json_sizes(models, field_models, pool, threads),
+      batch_size,
+      pool,
+      threads,
+      [&](const boost::filesystem::path& batch_path,
+          std::size_t /* batch */,
+          std::size_t begin,
+          std::size_t end) {
+        // Strings are interned per shard, so shards can be read independently.
+        BinaryJsonWriter writer;
+        for (std::size_t i = begin; i < end; i++) {
+          if (i < models.size()) {
+            writer.add(models[i]->to_json(context_));
+          } else {
+            writer.add(field_models[i - models.size()]->to_json(context_));
+          }
+        }
+
+        std::ofstream batch_stream(
+            batch_path.native(), std::ios_base::out | std::ios_base::binary);
+        if (!batch_stream.is_open()) {
+          ERROR(1, "Unable to write models to `{}`.", batch_path.native());
+          return;
+        }
+        writer.write(batch_stream);
+        batch_stream.close();
+      });
 
-  LOG(1, "Wrote models to {} shards.", total_batch);
+  LOG(1, "Wrote binary models to {} shards.", total_batch);
 }
 
 } // namespace marianatrench
@@ -7,6 +7,11 @@
 
 #pragma once
 
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
 #include <boost/filesystem/path.hpp>
 #include <json/json.h>
 
@@ -14,9 +19,13 @@
 #include <DexClass.h>
 #include <DexStore.h>
 
+#include <mariana-trench/Compiler.h>
 #include <mariana-trench/Context.h>
 #include <mariana-trench/FieldModel.h>
+#include <mariana-trench/MemoryAccounting.h>
 #include <mariana-trench/Model.h>
+#include <mariana-trench/SnapshotArray.h>
+#include <mariana-trench/SpilledModels.h>
 
 namespace {
 
@@ -26,6 +35,8 @@ constexpr std::size_t k_default_shard_limit = 10000;
 
 namespace marianatrench {
 
+class UnusedKinds;
+
 class Registry final {
  public:
   /* Create a registry with default models for all methods. */
@@ -52,44 +63,172 @@ class Registry final {
   /**
    * Load the global registry
    *
-   * This joins all generated models and json models.
+   * This joins all generated models and json models, after removing the
+   * taint with unused kinds from each model.
    * Afterwards, it creates a default model for methods that don't have one.
    */
   static Registry load(
       Context& context,
       const Options& options,
       const std::vector<Model>& generated_models,
-      const std::vector<FieldModel>& generated_field_models);
+      const std::vector<FieldModel>& generated_field_models,
+      const UnusedKinds& unused_kinds);
 
+  /**
+   * Add an implicit default model for methods that don't have one. Implicit
+   * models are not materialized until they are read (see `join_with`).
+   *
+   * This is not thread-safe.
+   */
   void add_default_models();
 
   /* These are thread-safe. */
   Model get(const Method* method) const;
   FieldModel get(const Field* field) const;
 
+  /**
+   * Return the model of the given field without copying it, or `nullptr` if
+   * the field has no model.
+   *
+   * Field models are only added while building the registry, they are
+   * read-only during the analysis. This is thread-safe and lock-free.
+   */
+  const FieldModel* MT_NULLABLE field_model(const Field* field) const;
+
+  /**
+   * Return the current model of the given method without copying it.
+   *
+   * Models are immutable once stored: `set` and `join_with` replace the
+   * snapshot, hence the returned model is unaffected by later updates.
+   * Implicit models are materialized and stored on their first read, so that
+   * later reads return the same snapshot. This is thread-safe.
+   */
+  std::shared_ptr<const Model> get_snapshot(const Method* method) const;
+
   /* This is thread-safe. */
-  void set(const Model& model);
+  void set(Model model);
+
+  /**
+   * Move the models of the given methods out of memory, into files under
+   * `directory` (see `SpilledModels`). They are still returned by `get`, but
+   * are not counted or dumped until `restore_spilled_models` is called.
+   * Models with issues are kept in memory.
+   *
+   * This is not thread-safe. It is meant to be called between iterations of
+   * the global fixpoint, on methods that will not be analyzed again.
+   */
+  void spill_models(
+      const std::vector<const Method*>& methods,
+      const boost::filesystem::path& directory);
+
+  /**
+   * Load all spilled models back in memory, so that other functions of the
+   * registry see them. This is not thread-safe.
+   */
+  void restore_spilled_models();
+
+  /**
+   * Compact the issues of all models (see `Issue::compact`) and return the
+   * number of issues. This is meant to be called once traces and positions
+   * are final, since compact issues cannot be joined or filtered.
+   */
+  std::size_t compact_issues();
 
   std::size_t models_size() const;
   std::size_t field_models_size() const;
   std::size_t issues_size() const;
 
+  /* Approximate memory used by models. This is not thread-safe. */
+  MemoryAccounting memory_accounting() const;
+
+  /**
+   * Join the given model with the model of its method.
+   *
+   * A model without taint that is entirely defined by its modes, such as a
+   * default or a taint-in-taint-out model, is recorded as an implicit model
+   * if its method has no model yet. This is not thread-safe.
+   */
   void join_with(const Model& model);
   void join_with(const FieldModel& field_model);
   void join_with(const Registry& other);
 
   void dump_metadata(const boost::filesystem::path& path) const;
+
+  /**
+   * Write models as json, as `model@*.json` shards with one model per line,
+   * and an index of their positions in `models_index.json`.
+   */
   void dump_models(
       const boost::filesystem::path& path,
       const std::size_t shard_limit = k_default_shard_limit) const;
   std::string dump_models() const;
+
+  /**
+   * Write models as gzip-compressed json, as `model@*.json.gz` shards. Each
+   * shard is compressed by the thread that writes it.
+   */
+  void dump_compressed_models(
+      const boost::filesystem::path& path,
+      const std::size_t shard_limit = k_default_shard_limit) const;
+
+  /**
+   * Write models in the compact binary format (see `BinaryJson`), as
+   * `model@*.bin` shards next to the json shards.
+   */
+  void dump_binary_models(
+      const boost::filesystem::path& path,
+      const std::size_t shard_limit = k_default_shard_limit) const;
   Json::Value models_to_json() const;
 
  private:
+  /* Whether the model is the one created for its method by default. */
+  bool is_default_model(const Model& model) const;
+
+  /* Return the implicit model of the given method, or `nullptr`. */
+  std::shared_ptr<const Model> implicit_model(const Method* method) const;
+
+  /* Create a snapshot, in the slabs of the thread if enabled. */
+  template <typename... Arguments>
+  std::shared_ptr<const Model> make_snapshot(Arguments&&... arguments) const;
+
+  /* Call `visitor` on implicit models that are not shadowed by a model. */
+  template <typename Visitor> // void(const Method*, Model::Modes)
+  void visit_implicit_modes(Visitor&& visitor) const;
+
+  /**
+   * Call `visitor` on all models, including implicit models, in the order of
+   * method identifiers. Spilled models are not visited.
+   */
+  template <typename Visitor> // void(const std::shared_ptr<const Model>&)
+  void visit_models(Visitor&& visitor) const;
+
+  /**
+   * Models to write, without default models if `--skip-default-models` and
+   * only models of the local partition with `--partition-count`.
+   */
+  std::vector<std::shared_ptr<const Model>> models_to_dump() const;
+
+  /* Field models to write, sorted by field, so that dumps are deterministic. */
+  std::vector<const FieldModel*> field_models_to_dump() const;
+
+  void dump_json_models(
+      const boost::filesystem::path& path,
+      const std::size_t shard_limit,
+      bool compress) const;
+
   Context& context_;
 
-  mutable ConcurrentMap<const Method*, Model> models_;
-  ConcurrentMap<const Field*, FieldModel> field_models_;
+  // Models indexed by method identifier (see `Method::id`). Mutable since
+  // implicit models are materialized when they are read.
+  mutable SnapshotArray<Model> models_;
+  // Modes of implicit models, indexed by method identifier. Zero means no
+  // implicit model. Only updated by the non thread-safe functions, a model
+  // stored in `models_` or spilled takes precedence.
+  std::vector<std::uint16_t> implicit_modes_;
+  // Only set once models have been spilled.
+  std::unique_ptr<SpilledModels> spilled_models_;
+  // Not thread-safe to update, see `field_model`.
+  std::unordered_map<const Field*, FieldModel> field_models_;
 };
 
 } // namespace marianatrench
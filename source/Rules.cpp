@@ -7,6 +7,7 @@
 
 #include <Show.h>
 
+#include <mariana-trench/JsonFileCache.h>
 #include <mariana-trench/JsonValidation.h>
 #include <mariana-trench/Kinds.h>
 #include <mariana-trench/Log.h>
@@ -35,15 +36,51 @@ Rules Rules::load(Context& context, const Options& options) {
   Rules rules;
 
   for (const auto& rules_path : options.rules_paths()) {
-    auto rules_value = JsonValidation::parse_json_file(rules_path);
+    auto rules_value = JsonFileCache::parse(rules_path);
     for (const auto& rule_value : JsonValidation::null_or_array(rules_value)) {
       rules.add(context, Rule::from_json(rule_value, context));
     }
   }
 
+  for (const auto& [pack, rules_paths] : options.rule_packs()) {
+    for (const auto& rules_path : rules_paths) {
+      auto rules_value = JsonFileCache::parse(rules_path);
+      for (const auto& rule_value :
+           JsonValidation::null_or_array(rules_value)) {
+        rules.add(context, Rule::from_json(rule_value, context), pack);
+      }
+    }
+  }
+
   return rules;
 }
 
+void Rules::add(
+    Context& context,
+    std::unique_ptr<Rule> rule,
+    const std::string& pack) {
+  auto code = rule->code();
+  // Duplicate codes are reported and ignored by `add`.
+  bool exists = rules_.count(code) > 0;
+  add(context, std::move(rule));
+  if (!exists) {
+    packs_.emplace(code, pack);
+  }
+}
+
+const std::string* MT_NULLABLE Rules::pack(const Rule* rule) const {
+  auto found = packs_.find(rule->code());
+  return found == packs_.end() ? nullptr : &found->second;
+}
+
+std::map<std::string, std::unordered_set<int>> Rules::packs() const {
+  std::map<std::string, std::unordered_set<int>> packs;
+  for (const auto& [code, pack] : packs_) {
+    packs[pack].insert(code);
+  }
+  return packs;
+}
+
 void Rules::add(Context& context, std::unique_ptr<Rule> rule) {
   auto existing = rules_.find(rule->code());
   if (existing != rules_.end()) {
@@ -63,8 +100,9 @@ void Rules::add(Context& context, std::unique_ptr<Rule> rule) {
   if (auto* source_sink_rule = rule_pointer->as<SourceSinkRule>()) {
     for (const auto* source_kind : source_sink_rule->source_kinds()) {
       for (const auto* sink_kind : source_sink_rule->sink_kinds()) {
-        source_to_sink_to_rules_[source_kind][sink_kind].push_back(
-            rule_pointer);
+        source_to_sink_to_rules_(source_kind, sink_kind)
+            .push_back(rule_pointer);
+        insert_kind(sink_kinds_, sink_kind);
       }
     }
   } else if (
@@ -103,10 +141,12 @@ void Rules::add(Context& context, std::unique_ptr<Rule> rule) {
              multi_source_rule->partial_sink_kinds(source_label)) {
           const auto* triggered =
               context.kinds->get_triggered(sink_kind, multi_source_rule);
-          source_to_partial_sink_to_rules_[source_kind][sink_kind].push_back(
-              multi_source_rule);
-          source_to_sink_to_rules_[source_kind][triggered].push_back(
-              multi_source_rule);
+          source_to_partial_sink_to_rules_(source_kind, sink_kind)
+              .push_back(multi_source_rule);
+          insert_kind(partial_sink_kinds_, sink_kind);
+          source_to_sink_to_rules_(source_kind, triggered)
+              .push_back(multi_source_rule);
+          insert_kind(sink_kinds_, triggered);
         }
       }
     }
@@ -119,33 +159,24 @@ void Rules::add(Context& context, std::unique_ptr<Rule> rule) {
 const std::vector<const Rule*>& Rules::rules(
     const Kind* source_kind,
     const Kind* sink_kind) const {
-  auto sink_to_rules = source_to_sink_to_rules_.find(source_kind);
-  if (sink_to_rules == source_to_sink_to_rules_.end()) {
+  const auto* rules = source_to_sink_to_rules_.get(source_kind, sink_kind);
+  if (rules == nullptr) {
     return empty_rule_set_;
   }
 
-  auto rules = sink_to_rules->second.find(sink_kind);
-  if (rules == sink_to_rules->second.end()) {
-    return empty_rule_set_;
-  }
-
-  return rules->second;
+  return *rules;
 }
 
 const std::vector<const MultiSourceMultiSinkRule*>& Rules::partial_rules(
     const Kind* source_kind,
     const PartialKind* sink_kind) const {
-  auto sink_to_rules = source_to_partial_sink_to_rules_.find(source_kind);
-  if (sink_to_rules == source_to_partial_sink_to_rules_.end()) {
-    return empty_multi_source_rule_set_;
-  }
-
-  auto rules = sink_to_rules->second.find(sink_kind);
-  if (rules == sink_to_rules->second.end()) {
+  const auto* rules =
+      source_to_partial_sink_to_rules_.get(source_kind, sink_kind);
+  if (rules == nullptr) {
     return empty_multi_source_rule_set_;
   }
 
-  return rules->second;
+  return *rules;
 }
 
 std::unordered_set<const Kind*> Rules::collect_unused_kinds(
@@ -7,13 +7,18 @@
 
 #pragma once
 
+#include <cstdint>
+#include <map>
 #include <memory>
+#include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include <boost/iterator/transform_iterator.hpp>
 #include <json/json.h>
 
+#include <mariana-trench/Compiler.h>
 #include <mariana-trench/Context.h>
 #include <mariana-trench/Kind.h>
 #include <mariana-trench/MultiSourceMultiSinkRule.h>
@@ -57,7 +62,10 @@ class Rules final {
 
   explicit Rules(Context& context, const Json::Value& rules_value);
 
-  /* Load the rules from the json file specified in the given options. */
+  /**
+   * Load the rules from the json files specified in the given options,
+   * including the rule packs (see `--rule-packs`).
+   */
   static Rules load(Context& context, const Options& options);
 
   Rules(const Rules&) = delete;
@@ -69,6 +77,21 @@ class Rules final {
   /* This is NOT thread-safe. */
   void add(Context& context, std::unique_ptr<Rule> rule);
 
+  /**
+   * Add a rule of the given rule pack. Rules of all packs are checked in the
+   * same analysis, packs only split the issues in the outputs.
+   */
+  void add(
+      Context& context,
+      std::unique_ptr<Rule> rule,
+      const std::string& pack);
+
+  /* Return the rule pack of the given rule, or null if it is in no pack. */
+  const std::string* MT_NULLABLE pack(const Rule* rule) const;
+
+  /* Return the codes of the rules of each rule pack. */
+  std::map<std::string, std::unordered_set<int>> packs() const;
+
   /**
    * Return the set of rules matching the given source kind and sink kind.
    * Satisfying these rules should result in the creation of an issue (this
@@ -88,6 +111,37 @@ class Rules final {
       const Kind* source_kind,
       const PartialKind* sink_kind) const;
 
+  /**
+   * Return true if the given source kind is used in any rule or partial rule.
+   * This is a single bounds check.
+   */
+  bool has_rules_for_source(const Kind* source_kind) const {
+    return source_to_sink_to_rules_.has_row(source_kind) ||
+        source_to_partial_sink_to_rules_.has_row(source_kind);
+  }
+
+  /**
+   * Return true if the given kind is a partial sink of a multi-source/sink
+   * rule. This is a single bit test, which lets callers skip partial rule
+   * lookups for all other kinds.
+   */
+  bool has_partial_rules_for_sink(const Kind* sink_kind) const {
+    return test_kind(partial_sink_kinds_, sink_kind);
+  }
+
+  /**
+   * Return true if the given kind is a sink of any rule, including triggered
+   * sinks of multi-source/sink rules. This is a single bit test.
+   */
+  bool has_rules_for_sink(const Kind* sink_kind) const {
+    return test_kind(sink_kinds_, sink_kind);
+  }
+
+  const std::vector<const MultiSourceMultiSinkRule*>& empty_partial_rules()
+      const {
+    return empty_multi_source_rule_set_;
+  }
+
   std::unordered_set<const Kind*> collect_unused_kinds(
       const Kinds& kinds) const;
 
@@ -103,20 +157,95 @@ class Rules final {
     return boost::make_transform_iterator(rules_.cend(), ExposeRulePointer());
   }
 
+ private:
+  static void insert_kind(std::vector<std::uint64_t>& kinds, const Kind* kind) {
+    auto word = kind->id() / 64;
+    if (word >= kinds.size()) {
+      kinds.resize(word + 1, 0);
+    }
+    kinds[word] |= std::uint64_t(1) << (kind->id() % 64);
+  }
+
+  static bool test_kind(
+      const std::vector<std::uint64_t>& kinds,
+      const Kind* kind) {
+    auto word = kind->id() / 64;
+    return word < kinds.size() &&
+        (kinds[word] & (std::uint64_t(1) << (kind->id() % 64))) != 0;
+  }
+
+  /**
+   * A map from pairs of (source kind, sink kind) to values, indexed by the
+   * source kind identifier. Each row has a bitset of the sink kind
+   * identifiers with a value, hence looking up a pair that no rule covers is
+   * a single bit test.
+   */
+  template <typename Value>
+  class KindPairMap final {
+   private:
+    struct Row {
+      std::vector<std::uint64_t> sinks;
+      std::unordered_map<const Kind*, Value> values;
+    };
+
+   public:
+    Value& operator()(const Kind* source_kind, const Kind* sink_kind) {
+      auto source_id = source_kind->id();
+      if (source_id >= rows_.size()) {
+        rows_.resize(source_id + 1);
+      }
+      auto& row = rows_[source_id];
+      if (row == nullptr) {
+        row = std::make_unique<Row>();
+      }
+
+      auto word = sink_kind->id() / 64;
+      if (word >= row->sinks.size()) {
+        row->sinks.resize(word + 1, 0);
+      }
+      row->sinks[word] |= std::uint64_t(1) << (sink_kind->id() % 64);
+      return row->values[sink_kind];
+    }
+
+    bool has_row(const Kind* source_kind) const {
+      auto source_id = source_kind->id();
+      return source_id < rows_.size() && rows_[source_id] != nullptr;
+    }
+
+    const Value* MT_NULLABLE
+    get(const Kind* source_kind, const Kind* sink_kind) const {
+      auto source_id = source_kind->id();
+      if (source_id >= rows_.size() || rows_[source_id] == nullptr) {
+        return nullptr;
+      }
+
+      const auto& row = *rows_[source_id];
+      auto word = sink_kind->id() / 64;
+      if (word >= row.sinks.size() ||
+          (row.sinks[word] & (std::uint64_t(1) << (sink_kind->id() % 64))) ==
+              0) {
+        return nullptr;
+      }
+      return &row.values.at(sink_kind);
+    }
+
+   private:
+    std::vector<std::unique_ptr<Row>> rows_;
+  };
+
  private:
   std::unordered_map<int, std::unique_ptr<Rule>> rules_;
-  std::unordered_map<
-      const Kind*,
-      std::unordered_map<const Kind*, std::vector<const Rule*>>>
-      source_to_sink_to_rules_;
-  std::unordered_map<
-      const Kind*,
-      std::unordered_map<
-          const PartialKind*,
-          std::vector<const MultiSourceMultiSinkRule*>>>
+  KindPairMap<std::vector<const Rule*>> source_to_sink_to_rules_;
+  KindPairMap<std::vector<const MultiSourceMultiSinkRule*>>
       source_to_partial_sink_to_rules_;
+  // Bitset of the identifiers of partial sink kinds used in any rule.
+  std::vector<std::uint64_t> partial_sink_kinds_;
+  // Bitset of the identifiers of sink kinds in `source_to_sink_to_rules_`.
+  std::vector<std::uint64_t> sink_kinds_;
   std::vector<const Rule*> empty_rule_set_;
   std::vector<const MultiSourceMultiSinkRule*> empty_multi_source_rule_set_;
+  // Rule pack of the rules added with a pack, by rule code.
+  std::unordered_map<int, std::string> packs_;
 };
 
 } // namespace marianatrench
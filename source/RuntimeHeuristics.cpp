@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <mariana-trench/JsonValidation.h>
+#include <mariana-trench/Methods.h>
+#include <mariana-trench/Redex.h>
+#include <mariana-trench/RuntimeHeuristics.h>
+
+namespace marianatrench {
+
+namespace {
+
+std::size_t size_or_default(
+    const Json::Value& value,
+    const std::string& field,
+    std::size_t default_value) {
+  if (!value.isMember(field)) {
+    return default_value;
+  }
+  auto result = JsonValidation::integer(value, field);
+  if (result < 0) {
+    throw JsonValidationError(
+        value, field, /* expected */ "non-negative integer");
+  }
+  return static_cast<std::size_t>(result);
+}
+
+} // namespace
+
+MethodHeuristics MethodHeuristics::from_json(
+    const Json::Value& value,
+    const MethodHeuristics& defaults) {
+  JsonValidation::validate_object(value);
+
+  MethodHeuristics heuristics;
+  heuristics.join_override_threshold = size_or_default(
+      value, "join_override_threshold", defaults.join_override_threshold);
+  heuristics.model_tree_max_leaves = size_or_default(
+      value, "model_tree_max_leaves", defaults.model_tree_max_leaves);
+  heuristics.max_number_iterations = size_or_default(
+      value, "max_number_iterations", defaults.max_number_iterations);
+  return heuristics;
+}
+
+RuntimeHeuristics::RuntimeHeuristics() = default;
+
+RuntimeHeuristics RuntimeHeuristics::from_json(const Json::Value& value) {
+  RuntimeHeuristics heuristics;
+  heuristics.defaults_ =
+      MethodHeuristics::from_json(value, heuristics.defaults_);
+
+  for (const auto& override_value :
+       JsonValidation::null_or_array(value, /* field */ "overrides")) {
+    auto method_heuristics = std::make_unique<MethodHeuristics>(
+        MethodHeuristics::from_json(override_value, heuristics.defaults_));
+
+    if (override_value.isMember("method")) {
+      auto signature = JsonValidation::string(override_value, "method");
+      const auto* dex_method = redex::get_method(signature);
+      if (dex_method == nullptr) {
+        throw JsonValidationError(
+            override_value,
+            /* field */ "method",
+            /* expected */ "existing method signature");
+      }
+      heuristics.method_overrides_[dex_method] = method_heuristics.get();
+    } else {
+      const auto* dex_type = JsonValidation::dex_type(override_value, "class");
+      heuristics.class_overrides_[dex_type] = method_heuristics.get();
+    }
+    heuristics.overrides_.push_back(std::move(method_heuristics));
+  }
+
+  return heuristics;
+}
+
+void RuntimeHeuristics::index(const Methods& methods) {
+  if (method_overrides_.empty() && class_overrides_.empty()) {
+    return;
+  }
+
+  indexed_overrides_.assign(methods.size(), nullptr);
+  for (const auto* method : methods) {
+    const auto& heuristics = find(method);
+    if (&heuristics != &defaults_) {
+      indexed_overrides_[method->id()] = &heuristics;
+    }
+  }
+}
+
+const MethodHeuristics& RuntimeHeuristics::find(const Method* method) const {
+  auto found_method = method_overrides_.find(method->dex_method());
+  if (found_method != method_overrides_.end()) {
+    return *found_method->second;
+  }
+
+  auto found_class = class_overrides_.find(method->get_class());
+  if (found_class != class_overrides_.end()) {
+    return *found_class->second;
+  }
+
+  return defaults_;
+}
+
+} // namespace marianatrench
@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include <json/json.h>
+
+#include <DexClass.h>
+
+#include <mariana-trench/Heuristics.h>
+#include <mariana-trench/Method.h>
+
+namespace marianatrench {
+
+class Methods;
+
+/**
+ * Analysis limits that apply to a given method.
+ *
+ * Defaults are the compile-time constants in `Heuristics`.
+ */
+struct MethodHeuristics {
+  std::size_t join_override_threshold = Heuristics::kJoinOverrideThreshold;
+  std::size_t model_tree_max_leaves = Heuristics::kModelTreeMaxLeaves;
+  std::size_t max_number_iterations = Heuristics::kMaxNumberIterations;
+
+  /* Parse the given json object, using `defaults` for missing fields. */
+  static MethodHeuristics from_json(
+      const Json::Value& value,
+      const MethodHeuristics& defaults);
+};
+
+/**
+ * Heuristics that can be changed at runtime (see `--heuristics-path`), with
+ * per-method or per-class overrides.
+ *
+ * The json format is:
+ * ```
+ * {
+ *   "join_override_threshold": 40,
+ *   "model_tree_max_leaves": 20,
+ *   "max_number_iterations": 150,
+ *   "overrides": [
+ *     {"method": "LClass;.method:()V", "model_tree_max_leaves": 5},
+ *     {"class": "LClass;", "join_override_threshold": 10}
+ *   ]
+ * }
+ * ```
+ * All fields are optional. Method overrides take precedence over class
+ * overrides, and fields missing from an override use the global values.
+ */
+class RuntimeHeuristics final {
+ public:
+  /* Use the compile-time defaults, without overrides. */
+  RuntimeHeuristics();
+
+  static RuntimeHeuristics from_json(const Json::Value& value);
+
+  RuntimeHeuristics(const RuntimeHeuristics&) = delete;
+  RuntimeHeuristics(RuntimeHeuristics&&) = default;
+  RuntimeHeuristics& operator=(const RuntimeHeuristics&) = delete;
+  RuntimeHeuristics& operator=(RuntimeHeuristics&&) = default;
+  ~RuntimeHeuristics() = default;
+
+  /* Heuristics for methods without overrides. */
+  const MethodHeuristics& defaults() const {
+    return defaults_;
+  }
+
+  /**
+   * Return the heuristics for the given method.
+   *
+   * This does not hash anything when there are no overrides, or for methods
+   * that existed when `index` was called. This is thread-safe.
+   */
+  const MethodHeuristics& get(const Method* method) const {
+    if (method_overrides_.empty() && class_overrides_.empty()) {
+      return defaults_;
+    }
+    if (method->id() < indexed_overrides_.size()) {
+      const auto* heuristics = indexed_overrides_[method->id()];
+      return heuristics != nullptr ? *heuristics : defaults_;
+    }
+    return find(method);
+  }
+
+  /**
+   * Resolve the overrides of all methods ahead of time, indexed by method
+   * identifier. This is NOT thread-safe.
+   */
+  void index(const Methods& methods);
+
+ private:
+  const MethodHeuristics& find(const Method* method) const;
+
+ private:
+  MethodHeuristics defaults_;
+  std::vector<std::unique_ptr<MethodHeuristics>> overrides_;
+  std::unordered_map<const DexMethod*, const MethodHeuristics*>
+      method_overrides_;
+  std::unordered_map<const DexType*, const MethodHeuristics*>
+      class_overrides_;
+  std::vector<const MethodHeuristics*> indexed_overrides_;
+};
+
+} // namespace marianatrench
@@ -20,6 +20,7 @@ Sanitizer::Sanitizer(
     : sanitizer_kind_(sanitizer_kind), kinds_(kinds) {
   mt_assert(
       sanitizer_kind_ != SanitizerKind::Propagations || !kinds_.is_value());
+  update_kind_mask();
 }
 
 bool Sanitizer::leq(const Sanitizer& other) const {
@@ -51,6 +52,7 @@ void Sanitizer::join_with(const Sanitizer& other) {
   } else {
     mt_assert(sanitizer_kind_ == other.sanitizer_kind_);
     kinds_.join_with(other.kinds_);
+    update_kind_mask();
   }
 
   mt_expensive_assert(previous.leq(*this) && other.leq(*this));
@@ -68,6 +70,20 @@ void Sanitizer::narrow_with(const Sanitizer& other) {
   meet_with(other);
 }
 
+void Sanitizer::update_kind_mask() {
+  kind_mask_.clear();
+  if (!kinds_.is_value()) {
+    return;
+  }
+  for (const auto* kind : kinds_.elements()) {
+    auto id = kind->id();
+    if (id / 64 >= kind_mask_.size()) {
+      kind_mask_.resize(id / 64 + 1, 0);
+    }
+    kind_mask_[id / 64] |= std::uint64_t(1) << (id % 64);
+  }
+}
+
 std::ostream& operator<<(std::ostream& out, const Sanitizer& sanitizer) {
   if (sanitizer.is_bottom()) {
     return out << "Sanitizer()";
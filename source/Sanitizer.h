@@ -7,6 +7,9 @@
 
 #pragma once
 
+#include <cstdint>
+#include <vector>
+
 #include <AbstractDomain.h>
 #include <PatriciaTreeSetAbstractDomain.h>
 
@@ -67,6 +70,7 @@ class Sanitizer final : public sparta::AbstractDomain<Sanitizer> {
 
   void set_to_bottom() override {
     kinds_.set_to_bottom();
+    kind_mask_.clear();
   }
 
   void set_to_top() override {
@@ -93,6 +97,20 @@ class Sanitizer final : public sparta::AbstractDomain<Sanitizer> {
     return kinds_;
   }
 
+  /**
+   * Return true if flows of the given kind are sanitized.
+   *
+   * This is a bitset lookup on the kind identifier, see `Kind::id`.
+   */
+  bool sanitizes(const Kind* kind) const {
+    if (kinds_.is_top()) {
+      return true;
+    }
+    auto id = kind->id();
+    return id / 64 < kind_mask_.size() &&
+        (kind_mask_[id / 64] & (std::uint64_t(1) << (id % 64))) != 0;
+  }
+
   friend std::ostream& operator<<(
       std::ostream& out,
       const Sanitizer& sanitizer);
@@ -108,9 +126,14 @@ class Sanitizer final : public sparta::AbstractDomain<Sanitizer> {
     std::size_t operator()(const Sanitizer& frame) const;
   };
 
+ private:
+  void update_kind_mask();
+
  private:
   SanitizerKind sanitizer_kind_;
   KindSetAbstractDomain kinds_;
+  // Bitset of the identifiers of `kinds_`, when it is a value.
+  std::vector<std::uint64_t> kind_mask_;
 };
 
 } // namespace marianatrench
@@ -5,41 +5,175 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include <ControlFlow.h>
+#include <IRCode.h>
+
+#include <mariana-trench/Methods.h>
+#include <mariana-trench/NumaPlacement.h>
 #include <mariana-trench/Scheduler.h>
 
 namespace marianatrench {
 
+namespace {
+
+// Rough estimate of the time spent per instruction in the intraprocedural
+// analysis, used for methods that were never analyzed.
+constexpr double kEstimatedSecondsPerInstruction = 1e-5;
+
+// Components with an estimated cost above this threshold, in seconds, are
+// scheduled first (about 10k instructions for methods never analyzed).
+constexpr double kLargeComponentCost = 0.1;
+
+} // namespace
+
 // We use the dependency graph as the source of truth since it is more precise
 // than the call graph (for instance, it takes into account
 // `no-join-virtual-overrides`).
-Scheduler::Scheduler(const Methods& methods, const Dependencies& dependencies)
-    : strongly_connected_components_(methods, dependencies) {}
+Scheduler::Scheduler(
+    const Methods& methods,
+    const Dependencies& dependencies,
+    const Statistics& statistics,
+    std::unordered_map<const Method*, double> cost_profile)
+    : strongly_connected_components_(methods, dependencies),
+      statistics_(statistics),
+      cost_profile_(std::move(cost_profile)),
+      numa_placement_(nullptr) {
+  for (const auto* method : methods) {
+    const auto* code = method->get_code();
+    if (code != nullptr && code->cfg_built()) {
+      number_of_instructions_.emplace(method, code->cfg().num_opcodes());
+    }
+  }
+}
 
 void Scheduler::schedule(
-    const ConcurrentSet<const Method*>& methods,
+    const MethodBitset& methods,
     std::function<void(const Method*, std::size_t)> enqueue,
     unsigned int threads) const {
-  // Schedule components by their reverse topological order (leaves to roots) in
-  // the set of strongly connected components.
-  std::size_t current_thread = 0;
-  for (const auto& component : strongly_connected_components_.components()) {
-    bool next_thread = false;
-    // Schedule all methods in this component on the same thread.
-    // Iterating on the reverse order here seems to give callees before callers
-    // more often, even though this is not guaranteed by Tarjan's algorithm.
-    for (auto iterator = component.rbegin(), end = component.rend();
-         iterator != end;
-         ++iterator) {
-      const auto* method = *iterator;
-      if (methods.count_unsafe(method) > 0) {
-        next_thread = true;
-        enqueue(method, current_thread);
+  std::vector<double> loads(threads, 0.0);
+  visit_components(
+      methods,
+      [&](const std::vector<const Method*>& component,
+          std::size_t index,
+          double cost) {
+        // Schedule all methods in this component on the same thread, in
+        // the weak topological order of the component, which gives callees
+        // before callers.
+        auto worker = assign(loads, index, cost);
+        for (const auto* method : component) {
+          if (methods.contains(method)) {
+            enqueue(method, worker);
+          }
+        }
+      });
+}
+
+void Scheduler::schedule_components(
+    const MethodBitset& methods,
+    std::function<void(const std::vector<const Method*>*, std::size_t)>
+        enqueue,
+    unsigned int threads) const {
+  std::vector<double> loads(threads, 0.0);
+  visit_components(
+      methods,
+      [&](const std::vector<const Method*>& component,
+          std::size_t index,
+          double cost) { enqueue(&component, assign(loads, index, cost)); });
+}
+
+void Scheduler::visit_components(
+    const MethodBitset& methods,
+    const std::function<
+        void(const std::vector<const Method*>&, std::size_t, double)>&
+        visitor) const {
+  const auto& components = strongly_connected_components_.components();
+  std::vector<double> costs;
+  costs.reserve(components.size());
+  for (const auto& component : components) {
+    double cost = 0.0;
+    for (const auto* method : component) {
+      if (methods.contains(method)) {
+        cost += estimated_cost(method);
       }
     }
-    if (next_thread) {
-      current_thread = (current_thread + 1) % threads;
+    costs.push_back(cost);
+  }
+
+  // Start the largest components first, on different workers, so that their
+  // analysis overlaps with the analysis of all other components instead of
+  // delaying the end of the iteration. Starting the most expensive first
+  // (longest processing time first) avoids picking a straggler last.
+  std::vector<std::size_t> large_components;
+  for (std::size_t index = 0; index < components.size(); index++) {
+    if (costs[index] >= kLargeComponentCost) {
+      large_components.push_back(index);
     }
   }
+  std::stable_sort(
+      large_components.begin(),
+      large_components.end(),
+      [&](std::size_t left, std::size_t right) {
+        return costs[left] > costs[right];
+      });
+  for (auto index : large_components) {
+    visitor(components[index], index, costs[index]);
+  }
+
+  // Schedule other components by their reverse topological order (leaves to
+  // roots) in the set of strongly connected components.
+  for (std::size_t index = 0; index < components.size(); index++) {
+    if (costs[index] > 0.0 && costs[index] < kLargeComponentCost) {
+      visitor(components[index], index, costs[index]);
+    }
+  }
+}
+
+// Components are still enqueued in reverse topological order; only the
+// worker they are assigned to depends on their estimated cost. Idle workers
+// steal work from others in the work queue, which takes care of the
+// remaining imbalance.
+std::size_t Scheduler::assign(
+    std::vector<double>& loads,
+    std::size_t component,
+    double cost) const {
+  std::size_t worker = 0;
+  bool found = false;
+  for (std::size_t candidate = 0; candidate < loads.size(); candidate++) {
+    // With a NUMA placement, only consider the workers of the node of the
+    // component.
+    if (numa_placement_ != nullptr &&
+        numa_placement_->worker_node(candidate) !=
+            numa_placement_->component_node(component)) {
+      continue;
+    }
+    if (!found || loads[candidate] < loads[worker]) {
+      worker = candidate;
+      found = true;
+    }
+  }
+  loads[worker] += cost;
+  return worker;
+}
+
+double Scheduler::estimated_cost(const Method* method) const {
+  if (auto time = statistics_.method_time(method)) {
+    // Avoid a null cost for methods that are analyzed instantly.
+    return std::max(*time, kEstimatedSecondsPerInstruction);
+  }
+
+  if (auto found = cost_profile_.find(method); found != cost_profile_.end()) {
+    return std::max(found->second, kEstimatedSecondsPerInstruction);
+  }
+
+  auto found = number_of_instructions_.find(method);
+  auto instructions =
+      found != number_of_instructions_.end() ? found->second : 0;
+  return static_cast<double>(instructions + 1) *
+      kEstimatedSecondsPerInstruction;
 }
 
 } // namespace marianatrench
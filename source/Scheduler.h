@@ -8,18 +8,32 @@
 #pragma once
 
 #include <functional>
+#include <unordered_map>
+#include <vector>
 
-#include <ConcurrentContainers.h>
-
+#include <mariana-trench/Compiler.h>
 #include <mariana-trench/Dependencies.h>
 #include <mariana-trench/Method.h>
+#include <mariana-trench/MethodBitset.h>
+#include <mariana-trench/Statistics.h>
 #include <mariana-trench/StronglyConnectedComponents.h>
 
 namespace marianatrench {
 
+class NumaPlacement;
+
 class Scheduler final {
  public:
-  explicit Scheduler(const Methods& methods, const Dependencies& dependencies);
+  /**
+   * The cost profile maps methods to the average duration of their analysis
+   * in a previous run, in seconds (see `AnalysisCosts`). It is used to
+   * estimate the cost of methods that were not analyzed yet in this run.
+   */
+  explicit Scheduler(
+      const Methods& methods,
+      const Dependencies& dependencies,
+      const Statistics& statistics,
+      std::unordered_map<const Method*, double> cost_profile = {});
 
   Scheduler(const Scheduler&) = delete;
   Scheduler(Scheduler&&) = delete;
@@ -29,12 +43,71 @@ class Scheduler final {
 
   /* Add methods to analyze in the work queue, in a specific order. */
   void schedule(
-      const ConcurrentSet<const Method*>& methods,
+      const MethodBitset& methods,
       std::function<void(const Method*, std::size_t)> enqueue,
       unsigned int threads) const;
 
+  /**
+   * Add strongly connected components that contain at least one method to
+   * analyze in the work queue, in the same order as `schedule`.
+   */
+  void schedule_components(
+      const MethodBitset& methods,
+      std::function<void(const std::vector<const Method*>*, std::size_t)>
+          enqueue,
+      unsigned int threads) const;
+
+  /**
+   * Return the estimated cost of analyzing the given method, in seconds.
+   *
+   * This is the duration of the last analysis of the method if it was already
+   * analyzed, its duration in the cost profile if any, or an estimate based on
+   * its number of instructions otherwise.
+   */
+  double estimated_cost(const Method* method) const;
+
+  /* Number of methods in the cost profile. */
+  std::size_t cost_profile_size() const {
+    return cost_profile_.size();
+  }
+
+  const StronglyConnectedComponents& strongly_connected_components() const {
+    return strongly_connected_components_;
+  }
+
+  /**
+   * Only assign components to workers on their node, when set (see
+   * `--numa-aware-scheduling`).
+   */
+  void set_numa_placement(const NumaPlacement* MT_NULLABLE numa_placement) {
+    numa_placement_ = numa_placement;
+  }
+
+ private:
+  /**
+   * Call `visitor` on each component that contains methods to analyze, with
+   * its index and its estimated cost. Large components are visited first, from the most
+   * expensive to the least expensive, then the others in reverse topological
+   * order.
+   */
+  void visit_components(
+      const MethodBitset& methods,
+      const std::function<
+          void(const std::vector<const Method*>&, std::size_t, double)>&
+          visitor) const;
+
+  /* Return the worker to assign the given component to. */
+  std::size_t assign(
+      std::vector<double>& loads,
+      std::size_t component,
+      double cost) const;
+
  private:
   StronglyConnectedComponents strongly_connected_components_;
+  const Statistics& statistics_;
+  std::unordered_map<const Method*, double> cost_profile_;
+  std::unordered_map<const Method*, std::size_t> number_of_instructions_;
+  const NumaPlacement* MT_NULLABLE numa_placement_;
 };
 
 } // namespace marianatrench
@@ -0,0 +1,301 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <fmt/format.h>
+
+#include <mariana-trench/Assert.h>
+#include <mariana-trench/ShardWriter.h>
+
+namespace marianatrench {
+
+namespace {
+
+double seconds_since(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+} // namespace
+
+struct ShardWriter::FileState {
+  std::string path;
+  int descriptor;
+  std::size_t queue;
+  // Set by the I/O thread once a write fails, later buffers are dropped.
+  bool failed;
+};
+
+ShardWriter::File::File(ShardWriter& writer, std::shared_ptr<FileState> state)
+    : writer_(&writer), state_(std::move(state)), buffer_(nullptr), size_(0) {}
+
+ShardWriter::File::File(File&& other) noexcept
+    : writer_(other.writer_),
+      state_(std::move(other.state_)),
+      buffer_(std::move(other.buffer_)),
+      size_(other.size_) {
+  other.size_ = 0;
+}
+
+ShardWriter::File::~File() {
+  if (state_ != nullptr) {
+    close();
+  }
+}
+
+void ShardWriter::File::write(const char* data, std::size_t size) {
+  mt_assert(state_ != nullptr);
+  while (size > 0) {
+    if (buffer_ == nullptr) {
+      buffer_ = writer_->acquire_buffer();
+    }
+    auto copied = std::min(size, writer_->buffer_size_ - size_);
+    std::memcpy(buffer_.get() + size_, data, copied);
+    size_ += copied;
+    data += copied;
+    size -= copied;
+    if (size_ == writer_->buffer_size_) {
+      flush();
+    }
+  }
+}
+
+void ShardWriter::File::flush() {
+  writer_->submit(Task{state_, std::move(buffer_), size_, /* close */ false});
+  buffer_ = nullptr;
+  size_ = 0;
+}
+
+void ShardWriter::File::close() {
+  mt_assert(state_ != nullptr);
+  writer_->submit(Task{std::move(state_), std::move(buffer_), size_, true});
+  state_ = nullptr;
+  buffer_ = nullptr;
+  size_ = 0;
+
+  std::lock_guard<std::mutex> lock(writer_->buffers_mutex_);
+  writer_->open_files_--;
+}
+
+ShardWriter::ShardWriter(
+    unsigned int io_threads,
+    std::size_t buffer_size,
+    std::size_t maximum_buffers,
+    Sync sync)
+    : buffer_size_(buffer_size),
+      maximum_buffers_(std::max(maximum_buffers, std::size_t(1))),
+      sync_(sync),
+      allocated_buffers_(0),
+      open_files_(0),
+      queues_(std::max(io_threads, 1u)),
+      next_queue_(0),
+      finishing_(false) {
+  mt_assert(buffer_size_ > 0);
+  for (std::size_t thread = 0; thread < queues_.size(); thread++) {
+    threads_.emplace_back([this, thread]() { run(thread); });
+  }
+}
+
+ShardWriter::~ShardWriter() {
+  try {
+    finish();
+  } catch (const std::runtime_error&) {
+    // Errors are reported by an explicit call to `finish`.
+  }
+}
+
+ShardWriter::File ShardWriter::open(const boost::filesystem::path& path) {
+  int descriptor =
+      ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (descriptor < 0) {
+    throw std::runtime_error(fmt::format(
+        "Unable to open `{}`: {}", path.native(), std::strerror(errno)));
+  }
+
+  std::size_t queue = 0;
+  {
+    std::lock_guard<std::mutex> lock(queues_mutex_);
+    mt_assert(!finishing_);
+    queue = next_queue_;
+    next_queue_ = (next_queue_ + 1) % queues_.size();
+  }
+  {
+    std::lock_guard<std::mutex> lock(buffers_mutex_);
+    open_files_++;
+  }
+  // Waiting files may allocate one more buffer.
+  buffer_released_.notify_all();
+  {
+    std::lock_guard<std::mutex> lock(statistics_mutex_);
+    statistics_.files++;
+  }
+  return File(
+      *this,
+      std::make_shared<FileState>(
+          FileState{path.native(), descriptor, queue, /* failed */ false}));
+}
+
+void ShardWriter::finish() {
+  {
+    std::lock_guard<std::mutex> lock(queues_mutex_);
+    finishing_ = true;
+  }
+  task_added_.notify_all();
+  for (auto& thread : threads_) {
+    thread.join();
+  }
+  threads_.clear();
+
+  std::lock_guard<std::mutex> lock(statistics_mutex_);
+  if (error_) {
+    throw std::runtime_error(*error_);
+  }
+}
+
+std::unique_ptr<char[]> ShardWriter::acquire_buffer() {
+  // Each open file holds at most one partial buffer, and the calling file
+  // holds none. Allowing one more buffer than open files guarantees that a
+  // buffer is eventually released.
+  auto can_allocate = [this]() {
+    return allocated_buffers_ < std::max(maximum_buffers_, open_files_ + 1);
+  };
+
+  std::unique_lock<std::mutex> lock(buffers_mutex_);
+  auto start = std::chrono::steady_clock::now();
+  bool waited = false;
+  if (free_buffers_.empty() && !can_allocate()) {
+    buffer_released_.wait(
+        lock, [&]() { return !free_buffers_.empty() || can_allocate(); });
+    waited = true;
+  }
+
+  std::unique_ptr<char[]> buffer;
+  if (!free_buffers_.empty()) {
+    buffer = std::move(free_buffers_.back());
+    free_buffers_.pop_back();
+  } else {
+    allocated_buffers_++;
+  }
+  lock.unlock();
+
+  if (buffer == nullptr) {
+    buffer = std::make_unique<char[]>(buffer_size_);
+  }
+  if (waited) {
+    auto wait_seconds = seconds_since(start);
+    std::lock_guard<std::mutex> statistics_lock(statistics_mutex_);
+    statistics_.wait_seconds += wait_seconds;
+  }
+  return buffer;
+}
+
+void ShardWriter::release_buffer(std::unique_ptr<char[]> buffer) {
+  {
+    std::lock_guard<std::mutex> lock(buffers_mutex_);
+    free_buffers_.push_back(std::move(buffer));
+  }
+  buffer_released_.notify_one();
+}
+
+void ShardWriter::submit(Task task) {
+  {
+    std::lock_guard<std::mutex> lock(queues_mutex_);
+    queues_[task.file->queue].push_back(std::move(task));
+  }
+  // Threads wait on their own queue, wake them all to reach the right one.
+  task_added_.notify_all();
+}
+
+void ShardWriter::run(std::size_t thread) {
+  auto& queue = queues_[thread];
+  std::unique_lock<std::mutex> lock(queues_mutex_);
+  while (true) {
+    task_added_.wait(lock, [&]() { return !queue.empty() || finishing_; });
+    if (queue.empty()) {
+      return;
+    }
+    auto task = std::move(queue.front());
+    queue.pop_front();
+    lock.unlock();
+    write(task);
+    lock.lock();
+  }
+}
+
+void ShardWriter::write(Task& task) {
+  auto& file = *task.file;
+  std::optional<std::string> error;
+  std::size_t bytes = 0;
+  std::size_t writes = 0;
+  double write_seconds = 0.0;
+  double maximum_write_seconds = 0.0;
+  double sync_seconds = 0.0;
+
+  if (task.buffer != nullptr && !file.failed) {
+    const char* data = task.buffer.get();
+    std::size_t remaining = task.size;
+    while (remaining > 0) {
+      auto start = std::chrono::steady_clock::now();
+      auto written = ::write(file.descriptor, data, remaining);
+      auto seconds = seconds_since(start);
+      if (written < 0 && errno == EINTR) {
+        continue;
+      }
+      if (written < 0) {
+        error = fmt::format(
+            "Unable to write `{}`: {}", file.path, std::strerror(errno));
+        file.failed = true;
+        break;
+      }
+      bytes += static_cast<std::size_t>(written);
+      writes++;
+      write_seconds += seconds;
+      maximum_write_seconds = std::max(maximum_write_seconds, seconds);
+      data += written;
+      remaining -= static_cast<std::size_t>(written);
+    }
+  }
+  if (task.buffer != nullptr) {
+    release_buffer(std::move(task.buffer));
+  }
+
+  if (task.close) {
+    if (sync_ == Sync::Files && !file.failed) {
+      auto start = std::chrono::steady_clock::now();
+      if (::fsync(file.descriptor) != 0) {
+        error = fmt::format(
+            "Unable to sync `{}`: {}", file.path, std::strerror(errno));
+      }
+      sync_seconds = seconds_since(start);
+    }
+    if (::close(file.descriptor) != 0 && !error) {
+      error = fmt::format(
+          "Unable to close `{}`: {}", file.path, std::strerror(errno));
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(statistics_mutex_);
+  statistics_.bytes += bytes;
+  statistics_.writes += writes;
+  statistics_.write_seconds += write_seconds;
+  statistics_.maximum_write_seconds =
+      std::max(statistics_.maximum_write_seconds, maximum_write_seconds);
+  statistics_.sync_seconds += sync_seconds;
+  if (error && !error_) {
+    error_ = std::move(error);
+  }
+}
+
+} // namespace marianatrench
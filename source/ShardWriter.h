@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/filesystem/path.hpp>
+
+#include <mariana-trench/Statistics.h>
+
+namespace marianatrench {
+
+/**
+ * Write output files through a bounded pipeline of buffers.
+ *
+ * Serializing threads append bytes to a `ShardWriter::File`, which fills
+ * buffers of `buffer_size` bytes taken from a pool, and hands full buffers to
+ * a small number of I/O threads. Each file is assigned to a single I/O
+ * thread, which writes its buffers in order, with one `write` per buffer.
+ * Serialization and writes overlap, and at most `maximum_buffers` buffers are
+ * in use at any time: serializing threads wait for a buffer to be written
+ * when the pool is exhausted.
+ */
+class ShardWriter final {
+ private:
+  struct FileState;
+
+  /* A buffer to write, followed by closing the file if `close` is set. */
+  struct Task {
+    std::shared_ptr<FileState> file;
+    std::unique_ptr<char[]> buffer;
+    std::size_t size;
+    bool close;
+  };
+
+ public:
+  enum class Sync {
+    // Leave files in the page cache.
+    None,
+    // Call `fsync` on each file before closing it.
+    Files,
+  };
+
+  /* A file open for writing. Not thread-safe. */
+  class File final {
+   public:
+    File(const File&) = delete;
+    File(File&& other) noexcept;
+    File& operator=(const File&) = delete;
+    File& operator=(File&&) = delete;
+    /* Close the file if `close` was not called. */
+    ~File();
+
+    void write(const char* data, std::size_t size);
+
+    void write(const std::string& string) {
+      write(string.data(), string.size());
+    }
+
+    /**
+     * Hand the last buffer to the I/O thread, which closes the file once it
+     * is written. Errors are reported by `ShardWriter::finish`.
+     */
+    void close();
+
+   private:
+    File(ShardWriter& writer, std::shared_ptr<FileState> state);
+
+    void flush();
+
+   private:
+    ShardWriter* writer_;
+    std::shared_ptr<FileState> state_;
+    std::unique_ptr<char[]> buffer_;
+    std::size_t size_;
+
+    friend class ShardWriter;
+  };
+
+ public:
+  ShardWriter(
+      unsigned int io_threads,
+      std::size_t buffer_size,
+      std::size_t maximum_buffers,
+      Sync sync);
+  ShardWriter(const ShardWriter&) = delete;
+  ShardWriter(ShardWriter&&) = delete;
+  ShardWriter& operator=(const ShardWriter&) = delete;
+  ShardWriter& operator=(ShardWriter&&) = delete;
+  /* Wait for pending writes, errors are ignored. */
+  ~ShardWriter();
+
+  /**
+   * Create or truncate the file at the given path. This is thread-safe.
+   *
+   * Throws `std::runtime_error` if the file cannot be created.
+   */
+  File open(const boost::filesystem::path& path);
+
+  /**
+   * Wait for all files to be written and closed, and stop the I/O threads.
+   * All files must be closed before.
+   *
+   * Throws `std::runtime_error` if a write failed.
+   */
+  void finish();
+
+  /* Counters of the writes. This is only valid after `finish`. */
+  const OutputStatistics& statistics() const {
+    return statistics_;
+  }
+
+  /* Default size of a buffer, in bytes. */
+  constexpr static std::size_t kDefaultBufferSize = 4 * 1024 * 1024;
+
+ private:
+  std::unique_ptr<char[]> acquire_buffer();
+  void release_buffer(std::unique_ptr<char[]> buffer);
+  void submit(Task task);
+  void run(std::size_t thread);
+  void write(Task& task);
+
+ private:
+  std::size_t buffer_size_;
+  std::size_t maximum_buffers_;
+  Sync sync_;
+
+  // Pool of buffers, shared by all files.
+  std::mutex buffers_mutex_;
+  std::condition_variable buffer_released_;
+  std::vector<std::unique_ptr<char[]>> free_buffers_;
+  std::size_t allocated_buffers_;
+  std::size_t open_files_;
+
+  // One queue of tasks per I/O thread.
+  std::mutex queues_mutex_;
+  std::condition_variable task_added_;
+  std::vector<std::deque<Task>> queues_;
+  std::size_t next_queue_;
+  bool finishing_;
+  std::vector<std::thread> threads_;
+
+  // Counters and first error, updated by the I/O threads.
+  std::mutex statistics_mutex_;
+  OutputStatistics statistics_;
+  std::optional<std::string> error_;
+};
+
+} // namespace marianatrench
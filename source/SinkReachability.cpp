@@ -0,0 +1,248 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <algorithm>
+#include <atomic>
+
+#include <mariana-trench/Dependencies.h>
+#include <mariana-trench/Fields.h>
+#include <mariana-trench/Kinds.h>
+#include <mariana-trench/Methods.h>
+#include <mariana-trench/NamedKind.h>
+#include <mariana-trench/Options.h>
+#include <mariana-trench/PartialKind.h>
+#include <mariana-trench/Rules.h>
+#include <mariana-trench/SinkReachability.h>
+#include <mariana-trench/TriggeredPartialKind.h>
+#include <mariana-trench/WorkerPool.h>
+
+namespace marianatrench {
+
+namespace {
+
+void set_bit(std::uint64_t* words, std::size_t index) {
+  words[index / 64] |= std::uint64_t(1) << (index % 64);
+}
+
+/* Union of `to[i]` with `from[i]` for all `i` in `[0, words)`. */
+bool union_words(
+    std::uint64_t* to,
+    const std::uint64_t* from,
+    std::size_t words) {
+  bool changed = false;
+  for (std::size_t word = 0; word < words; word++) {
+    auto joined = to[word] | from[word];
+    changed = changed || joined != to[word];
+    to[word] = joined;
+  }
+  return changed;
+}
+
+/**
+ * Propagate reachable sinks along the dependency graph for the given number
+ * of calls, from callees to callers if `to_callers` is true, from callers to
+ * callees otherwise.
+ */
+void propagate(
+    std::vector<std::uint64_t>& reachable,
+    std::size_t words,
+    const Methods& methods,
+    const Dependencies& dependencies,
+    bool to_callers,
+    int calls) {
+  for (int call = 0; call < calls; call++) {
+    auto next = reachable;
+    bool changed = false;
+    for (const auto* callee : methods) {
+      auto* callee_words = next.data() + callee->id() * words;
+      for (const auto* caller : dependencies.dependencies(callee)) {
+        auto* caller_words = next.data() + caller->id() * words;
+        if (to_callers) {
+          changed |= union_words(
+              caller_words, reachable.data() + callee->id() * words, words);
+        } else {
+          changed |= union_words(
+              callee_words, reachable.data() + caller->id() * words, words);
+        }
+      }
+    }
+    reachable = std::move(next);
+    if (!changed) {
+      return;
+    }
+  }
+}
+
+} // namespace
+
+SinkReachability::SinkReachability(
+    const Context& context,
+    const Registry& registry)
+    : context_(context) {
+  const auto& methods = *context.methods;
+  const auto& rules = *context.rules;
+
+  std::unordered_map<const Kind*, std::size_t> sink_indices;
+  auto sink_index = [&](const Kind* kind) {
+    auto [iterator, inserted] =
+        sink_indices.emplace(kind, sink_kinds_.size());
+    if (inserted) {
+      sink_kinds_.push_back(kind);
+    }
+    return iterator->second;
+  };
+  auto is_rule_sink = [&](const Kind* kind) {
+    return rules.has_rules_for_sink(kind) ||
+        rules.has_partial_rules_for_sink(kind);
+  };
+
+  // Sinks of each method and of field models.
+  std::vector<std::vector<std::size_t>> method_sinks(methods.size());
+  for (const auto* method : methods) {
+    auto model = registry.get_snapshot(method);
+    auto& sinks = method_sinks[method->id()];
+    model->sinks().visit([&](const AccessPath& /* port */, const Taint& taint) {
+      for (const auto& frames : taint) {
+        if (is_rule_sink(frames.kind())) {
+          sinks.push_back(sink_index(frames.kind()));
+        }
+      }
+    });
+  }
+  std::vector<std::size_t> field_sinks;
+  for (const auto* field : *context.fields) {
+    const auto* field_model = registry.field_model(field);
+    if (field_model == nullptr) {
+      continue;
+    }
+    for (const auto& frames : field_model->sinks()) {
+      if (is_rule_sink(frames.kind())) {
+        field_sinks.push_back(sink_index(frames.kind()));
+      }
+    }
+  }
+
+  words_ = std::max<std::size_t>(1, (sink_kinds_.size() + 63) / 64);
+  reachable_.assign(methods.size() * words_, 0);
+  for (const auto* method : methods) {
+    for (auto index : method_sinks[method->id()]) {
+      set_bit(reachable_.data() + method->id() * words_, index);
+    }
+  }
+  field_sinks_.assign(words_, 0);
+  for (auto index : field_sinks) {
+    set_bit(field_sinks_.data(), index);
+  }
+
+  // Sinks below each method, then below each of its ancestors.
+  auto distance = context.options->maximum_source_sink_distance();
+  propagate(
+      reachable_,
+      words_,
+      methods,
+      *context.dependencies,
+      /* to_callers */ true,
+      /* calls */ distance + 1);
+  propagate(
+      reachable_,
+      words_,
+      methods,
+      *context.dependencies,
+      /* to_callers */ false,
+      /* calls */ distance);
+}
+
+const std::vector<std::uint64_t>& SinkReachability::compatible_sinks(
+    const Kind* source_kind) const {
+  std::lock_guard<std::mutex> lock(compatible_sinks_mutex_);
+  auto found = compatible_sinks_.find(source_kind);
+  if (found != compatible_sinks_.end()) {
+    return found->second;
+  }
+
+  const auto& rules = *context_.rules;
+  std::vector<std::uint64_t> compatible(words_, 0);
+  for (std::size_t index = 0; index < sink_kinds_.size(); index++) {
+    const auto* sink_kind = sink_kinds_[index];
+    if (sink_kind->as<PartialKind>() != nullptr ||
+        sink_kind->as<TriggeredPartialKind>() != nullptr ||
+        !rules.rules(source_kind, sink_kind).empty()) {
+      set_bit(compatible.data(), index);
+    }
+  }
+  return compatible_sinks_.emplace(source_kind, std::move(compatible))
+      .first->second;
+}
+
+bool SinkReachability::may_reach_sink(
+    const Method* method,
+    const Kind* source_kind) const {
+  // Only prune sources of rules, other kinds are left as is.
+  if (source_kind == Kinds::artificial_source() ||
+      source_kind->as<NamedKind>() == nullptr ||
+      !context_.rules->has_rules_for_source(source_kind)) {
+    return true;
+  }
+
+  const auto& compatible = compatible_sinks(source_kind);
+  const auto* reachable = reachable_.data() + method->id() * words_;
+  for (std::size_t word = 0; word < words_; word++) {
+    if (((reachable[word] | field_sinks_[word]) & compatible[word]) != 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+std::size_t SinkReachability::prune(Registry& registry) const {
+  std::atomic<std::size_t> updated_models = 0;
+  auto queue = WorkQueue<const Method*>(
+      context_.worker_pool.get(),
+      [&](const Method* method) {
+        auto snapshot = registry.get_snapshot(method);
+        if (snapshot->generations().is_bottom() &&
+            snapshot->parameter_sources().is_bottom()) {
+          return;
+        }
+
+        bool pruned = false;
+        auto filter = [&](TaintAccessPathTree tree) {
+          tree.map([&](Taint& taint) {
+            taint.filter_invalid_frames(
+                [&](const Method* MT_NULLABLE /* callee */,
+                    const AccessPath& /* callee_port */,
+                    const Kind* kind) {
+                  if (may_reach_sink(method, kind)) {
+                    return true;
+                  }
+                  pruned = true;
+                  return false;
+                });
+          });
+          return tree;
+        };
+        auto generations = filter(snapshot->generations());
+        auto parameter_sources = filter(snapshot->parameter_sources());
+        if (!pruned) {
+          return;
+        }
+
+        auto model = *snapshot;
+        model.set_generations(std::move(generations));
+        model.set_parameter_sources(std::move(parameter_sources));
+        registry.set(std::move(model));
+        updated_models.fetch_add(1, std::memory_order_relaxed);
+      },
+      context_.options->jobs(AnalysisPhase::Models));
+  for (const auto* method : *context_.methods) {
+    queue.add_item(method);
+  }
+  queue.run_all();
+  return updated_models.load();
+}
+
+} // namespace marianatrench
@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include <mariana-trench/Context.h>
+#include <mariana-trench/Kind.h>
+#include <mariana-trench/Method.h>
+#include <mariana-trench/Registry.h>
+
+namespace marianatrench {
+
+/**
+ * Sink kinds that taint of each method might reach, used to drop sources that
+ * can never be part of an issue (see `--prune-unreachable-sources`).
+ *
+ * A source of a method flows at most `maximum_source_sink_distance` calls up
+ * to its callers, and a sink at most as many calls up from its method. An
+ * issue with a source of method `m` is hence found in an ancestor `c` of `m`
+ * within that distance, with a sink of a method below `c` within that
+ * distance (plus one call). This computes these sets of sink kinds over the
+ * dependency graph, starting from the sinks of the models before the
+ * analysis. Sinks of field models can be reached from anywhere.
+ *
+ * This is conservative for multi-source rules: partial and triggered sinks
+ * are compatible with any source kind used in a rule.
+ */
+class SinkReachability final {
+ public:
+  explicit SinkReachability(const Context& context, const Registry& registry);
+
+  SinkReachability(const SinkReachability&) = delete;
+  SinkReachability(SinkReachability&&) = delete;
+  SinkReachability& operator=(const SinkReachability&) = delete;
+  SinkReachability& operator=(SinkReachability&&) = delete;
+  ~SinkReachability() = default;
+
+  /**
+   * Returns false if taint of the given source kind in the given method can
+   * never meet a sink of a matching rule. This is thread-safe.
+   */
+  bool may_reach_sink(const Method* method, const Kind* source_kind) const;
+
+  /**
+   * Remove the generations and parameter sources that cannot reach a sink
+   * from the models of the registry. Returns the number of updated models.
+   */
+  std::size_t prune(Registry& registry) const;
+
+  /* Number of distinct sink kinds found in the models. */
+  std::size_t sink_kinds() const {
+    return sink_kinds_.size();
+  }
+
+ private:
+  const std::vector<std::uint64_t>& compatible_sinks(
+      const Kind* source_kind) const;
+
+ private:
+  const Context& context_;
+  std::vector<const Kind*> sink_kinds_;
+  std::size_t words_ = 0;
+  // Reachable sink kinds, `words_` words per method identifier.
+  std::vector<std::uint64_t> reachable_;
+  // Sink kinds of field models, reachable from all methods.
+  std::vector<std::uint64_t> field_sinks_;
+
+  mutable std::mutex compatible_sinks_mutex_;
+  mutable std::unordered_map<const Kind*, std::vector<std::uint64_t>>
+      compatible_sinks_;
+};
+
+} // namespace marianatrench
@@ -0,0 +1,360 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <AbstractDomain.h>
+
+#include <mariana-trench/Access.h>
+
+namespace marianatrench {
+
+/**
+ * An abstract partition from root to the given domain, for partitions that
+ * only have a few roots, e.g the return value and a few arguments.
+ *
+ * Bindings are stored in a single vector sorted by root encoding, instead of
+ * one node per binding in a patricia tree. The vector is shared between
+ * copies and copied on the first write, hence copies are as cheap as for
+ * `RootPatriciaTreeAbstractPartition`. Bottom partitions do not allocate.
+ *
+ * Writes copy all the bindings of a shared partition, hence this should not
+ * be used for partitions with many roots or that are written often, such as
+ * taint trees.
+ */
+template <typename Domain>
+class SmallRootAbstractPartition final
+    : public sparta::AbstractDomain<SmallRootAbstractPartition<Domain>> {
+ private:
+  using Bindings = std::vector<std::pair<Root, Domain>>;
+
+ public:
+  // C++ container concept member types
+  using key_type = Root;
+  using mapped_type = Domain;
+  using value_type = std::pair<Root, Domain>;
+  using iterator = typename Bindings::const_iterator;
+  using const_iterator = iterator;
+  using difference_type = std::ptrdiff_t;
+  using size_type = std::size_t;
+  using const_reference = const value_type&;
+  using const_pointer = const value_type*;
+
+ public:
+  /* Return the bottom value (i.e, the empty partition). */
+  SmallRootAbstractPartition() = default;
+
+  SmallRootAbstractPartition(
+      std::initializer_list<std::pair<Root, Domain>> bindings) {
+    for (const auto& [root, value] : bindings) {
+      set(root, value);
+    }
+  }
+
+  SmallRootAbstractPartition(
+      const std::vector<std::pair<Root, Domain>>& bindings) {
+    for (const auto& [root, value] : bindings) {
+      set(root, value);
+    }
+  }
+
+  SmallRootAbstractPartition(const SmallRootAbstractPartition&) = default;
+  SmallRootAbstractPartition(SmallRootAbstractPartition&&) = default;
+  SmallRootAbstractPartition& operator=(const SmallRootAbstractPartition&) =
+      default;
+  SmallRootAbstractPartition& operator=(SmallRootAbstractPartition&&) =
+      default;
+
+  static SmallRootAbstractPartition bottom() {
+    return SmallRootAbstractPartition();
+  }
+
+  static SmallRootAbstractPartition top() {
+    auto partition = SmallRootAbstractPartition();
+    partition.set_to_top();
+    return partition;
+  }
+
+  bool is_bottom() const override {
+    return !top_ && bindings_ == nullptr;
+  }
+
+  bool is_top() const override {
+    return top_;
+  }
+
+  void set_to_bottom() override {
+    top_ = false;
+    bindings_ = nullptr;
+  }
+
+  void set_to_top() override {
+    top_ = true;
+    bindings_ = nullptr;
+  }
+
+  /* Return the number of bindings not set to bottom. */
+  std::size_t size() const {
+    return bindings().size();
+  }
+
+  iterator begin() const {
+    return bindings().begin();
+  }
+
+  iterator end() const {
+    return bindings().end();
+  }
+
+  bool leq(const SmallRootAbstractPartition& other) const override {
+    if (other.top_) {
+      return true;
+    }
+    if (top_) {
+      return false;
+    }
+    if (bindings_ == other.bindings_) {
+      return true;
+    }
+    for (const auto& [root, value] : bindings()) {
+      if (!value.leq(other.get(root))) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  bool equals(const SmallRootAbstractPartition& other) const override {
+    if (top_ != other.top_) {
+      return false;
+    }
+    if (bindings_ == other.bindings_) {
+      return true;
+    }
+    const auto& bindings = this->bindings();
+    const auto& other_bindings = other.bindings();
+    return std::equal(
+        bindings.begin(),
+        bindings.end(),
+        other_bindings.begin(),
+        other_bindings.end(),
+        [](const value_type& left, const value_type& right) {
+          return left.first == right.first && left.second.equals(right.second);
+        });
+  }
+
+  void join_with(const SmallRootAbstractPartition& other) override {
+    union_with(other, [](Domain& left, const Domain& right) {
+      left.join_with(right);
+    });
+  }
+
+  void widen_with(const SmallRootAbstractPartition& other) override {
+    union_with(other, [](Domain& left, const Domain& right) {
+      left.widen_with(right);
+    });
+  }
+
+  void meet_with(const SmallRootAbstractPartition& other) override {
+    intersection_with(other, [](Domain& left, const Domain& right) {
+      left.meet_with(right);
+    });
+  }
+
+  void narrow_with(const SmallRootAbstractPartition& other) override {
+    intersection_with(other, [](Domain& left, const Domain& right) {
+      left.narrow_with(right);
+    });
+  }
+
+  const Domain& get(Root root) const {
+    if (top_) {
+      static const Domain top = Domain::top();
+      return top;
+    }
+    const auto& bindings = this->bindings();
+    auto found = lower_bound(bindings, root);
+    if (found == bindings.end() || found->first != root) {
+      static const Domain bottom = Domain::bottom();
+      return bottom;
+    }
+    return found->second;
+  }
+
+  void set(Root root, const Domain& value) {
+    if (top_) {
+      return;
+    }
+    if (value.is_bottom()) {
+      const auto& bindings = this->bindings();
+      auto found = lower_bound(bindings, root);
+      if (found == bindings.end() || found->first != root) {
+        return;
+      }
+      auto index = found - bindings.begin();
+      auto& mutable_bindings = this->mutable_bindings();
+      mutable_bindings.erase(mutable_bindings.begin() + index);
+      if (mutable_bindings.empty()) {
+        bindings_ = nullptr;
+      }
+      return;
+    }
+
+    auto& bindings = mutable_bindings();
+    auto found = lower_bound(bindings, root);
+    if (found != bindings.end() && found->first == root) {
+      found->second = value;
+    } else {
+      bindings.emplace(found, root, value);
+    }
+  }
+
+  void update(Root root, std::function<Domain(const Domain&)> operation) {
+    if (top_) {
+      return;
+    }
+    set(root, operation(get(root)));
+  }
+
+  /* Apply `f` on all bindings. Return whether a binding changed. */
+  bool map(std::function<Domain(const Domain&)> f) {
+    if (bindings_ == nullptr) {
+      return false;
+    }
+    bool changed = false;
+    auto result = Bindings();
+    result.reserve(bindings_->size());
+    for (const auto& [root, value] : *bindings_) {
+      auto new_value = f(value);
+      changed |= !new_value.equals(value);
+      if (!new_value.is_bottom()) {
+        result.emplace_back(root, std::move(new_value));
+      }
+    }
+    if (changed) {
+      assign(std::move(result));
+    }
+    return changed;
+  }
+
+ private:
+  static const Bindings& empty_bindings() {
+    static const Bindings empty;
+    return empty;
+  }
+
+  template <typename BindingsT>
+  static auto lower_bound(BindingsT& bindings, Root root) {
+    return std::lower_bound(
+        bindings.begin(),
+        bindings.end(),
+        root,
+        [](const value_type& binding, Root root) {
+          return binding.first.encode() < root.encode();
+        });
+  }
+
+  const Bindings& bindings() const {
+    return bindings_ == nullptr ? empty_bindings() : *bindings_;
+  }
+
+  /* Return the bindings, after copying them if they are shared. */
+  Bindings& mutable_bindings() {
+    if (bindings_ == nullptr) {
+      bindings_ = std::make_shared<Bindings>();
+    } else if (bindings_.use_count() > 1) {
+      bindings_ = std::make_shared<Bindings>(*bindings_);
+    }
+    return *bindings_;
+  }
+
+  bool shares_bindings(const SmallRootAbstractPartition& other) const {
+    return bindings_ != nullptr && bindings_ == other.bindings_;
+  }
+
+  void assign(Bindings bindings) {
+    if (bindings.empty()) {
+      bindings_ = nullptr;
+    } else {
+      bindings_ = std::make_shared<Bindings>(std::move(bindings));
+    }
+  }
+
+  template <typename Operation> // void(Domain&, const Domain&)
+  void union_with(
+      const SmallRootAbstractPartition& other,
+      const Operation& operation) {
+    if (top_ || other.is_bottom() || shares_bindings(other)) {
+      return;
+    }
+    if (other.top_ || is_bottom()) {
+      *this = other;
+      return;
+    }
+
+    auto result = Bindings();
+    result.reserve(bindings_->size() + other.bindings_->size());
+    auto left = bindings_->begin(), left_end = bindings_->end();
+    auto right = other.bindings_->begin(), right_end = other.bindings_->end();
+    while (left != left_end || right != right_end) {
+      if (right == right_end ||
+          (left != left_end &&
+           left->first.encode() < right->first.encode())) {
+        result.push_back(*left++);
+      } else if (
+          left == left_end || right->first.encode() < left->first.encode()) {
+        result.push_back(*right++);
+      } else {
+        result.push_back(*left++);
+        operation(result.back().second, right->second);
+        ++right;
+      }
+    }
+    assign(std::move(result));
+  }
+
+  template <typename Operation> // void(Domain&, const Domain&)
+  void intersection_with(
+      const SmallRootAbstractPartition& other,
+      const Operation& operation) {
+    if (other.top_ || is_bottom() || shares_bindings(other)) {
+      return;
+    }
+    if (top_ || other.is_bottom()) {
+      *this = other;
+      return;
+    }
+
+    auto result = Bindings();
+    for (const auto& [root, value] : *bindings_) {
+      const auto& other_value = other.get(root);
+      if (other_value.is_bottom()) {
+        continue;
+      }
+      auto new_value = value;
+      operation(new_value, other_value);
+      if (!new_value.is_bottom()) {
+        result.emplace_back(root, std::move(new_value));
+      }
+    }
+    assign(std::move(result));
+  }
+
+ private:
+  // Sorted by root encoding, never empty. Null for bottom and top.
+  std::shared_ptr<Bindings> bindings_;
+  bool top_ = false;
+};
+
+} // namespace marianatrench
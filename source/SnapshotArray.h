@@ -0,0 +1,178 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+#include <mariana-trench/Assert.h>
+
+namespace marianatrench {
+
+/**
+ * A concurrent array of immutable snapshots, indexed by a dense identifier
+ * (for instance `Method::id`).
+ *
+ * Each slot holds a `std::shared_ptr<const Value>` that is read and replaced
+ * atomically, hence readers never wait on a map bucket and a snapshot stays
+ * alive as long as a reader holds it. Slots are allocated in fixed-size
+ * chunks on demand, so the array can grow concurrently with reads and writes.
+ */
+template <typename Value>
+class SnapshotArray final {
+ private:
+  static constexpr std::size_t kChunkSize = 4096;
+  static constexpr std::size_t kMaxChunks = 65536;
+
+  using Chunk = std::array<std::shared_ptr<const Value>, kChunkSize>;
+
+ public:
+  SnapshotArray()
+      : chunks_(std::make_unique<std::atomic<Chunk*>[]>(kMaxChunks)),
+        size_(0) {}
+
+  SnapshotArray(const SnapshotArray&) = delete;
+
+  /* Moving is not thread-safe. */
+  SnapshotArray(SnapshotArray&& other) noexcept
+      : chunks_(std::move(other.chunks_)), size_(other.size_.load()) {
+    other.size_ = 0;
+  }
+
+  SnapshotArray& operator=(const SnapshotArray&) = delete;
+  SnapshotArray& operator=(SnapshotArray&&) = delete;
+
+  ~SnapshotArray() {
+    if (chunks_ == nullptr) {
+      return;
+    }
+    for (std::size_t index = 0; index < kMaxChunks; index++) {
+      delete chunks_[index].load();
+    }
+  }
+
+  /* Return the snapshot at the given index, or `nullptr`. */
+  std::shared_ptr<const Value> get(std::size_t index) const {
+    const auto* chunk = find_chunk(index);
+    if (chunk == nullptr) {
+      return nullptr;
+    }
+    return std::atomic_load(&(*chunk)[index % kChunkSize]);
+  }
+
+  /* Replace the snapshot at the given index. */
+  void set(std::size_t index, std::shared_ptr<const Value> value) {
+    mt_assert(value != nullptr);
+    auto& slot = (*get_or_create_chunk(index))[index % kChunkSize];
+    auto previous = std::atomic_exchange(&slot, std::move(value));
+    if (previous == nullptr) {
+      size_.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  /**
+   * Set the snapshot at the given index if there is none.
+   *
+   * Returns true if the snapshot was inserted.
+   */
+  bool insert(std::size_t index, std::shared_ptr<const Value> value) {
+    mt_assert(value != nullptr);
+    auto& slot = (*get_or_create_chunk(index))[index % kChunkSize];
+    std::shared_ptr<const Value> expected = nullptr;
+    if (!std::atomic_compare_exchange_strong(
+            &slot, &expected, std::move(value))) {
+      return false;
+    }
+    size_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+  }
+
+  /* Clear the slot at the given index and return its previous snapshot. */
+  std::shared_ptr<const Value> erase(std::size_t index) {
+    auto* chunk = find_chunk(index);
+    if (chunk == nullptr) {
+      return nullptr;
+    }
+    auto previous =
+        std::atomic_exchange(&(*chunk)[index % kChunkSize], nullptr);
+    if (previous != nullptr) {
+      size_.fetch_sub(1, std::memory_order_relaxed);
+    }
+    return previous;
+  }
+
+  /* Return the number of non-empty slots. */
+  std::size_t size() const {
+    return size_.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * Call `visitor` on all snapshots, in the order of their indices.
+   *
+   * Snapshots changed concurrently might or might not be visited.
+   */
+  template <typename Visitor> // void(const std::shared_ptr<const Value>&)
+  void visit(Visitor&& visitor) const {
+    visit_with_index([&](std::size_t /* index */,
+                         const std::shared_ptr<const Value>& value) {
+      visitor(value);
+    });
+  }
+
+  /**
+   * Call `visitor` on all snapshots and their index, in the order of their
+   * indices.
+   */
+  template <typename Visitor> // void(std::size_t,
+                              //      const std::shared_ptr<const Value>&)
+  void visit_with_index(Visitor&& visitor) const {
+    for (std::size_t index = 0; index < kMaxChunks; index++) {
+      const auto* chunk = chunks_[index].load(std::memory_order_acquire);
+      if (chunk == nullptr) {
+        continue;
+      }
+      for (std::size_t offset = 0; offset < kChunkSize; offset++) {
+        auto value = std::atomic_load(&(*chunk)[offset]);
+        if (value != nullptr) {
+          visitor(index * kChunkSize + offset, value);
+        }
+      }
+    }
+  }
+
+ private:
+  Chunk* find_chunk(std::size_t index) const {
+    auto chunk_index = index / kChunkSize;
+    mt_assert(chunk_index < kMaxChunks);
+    return chunks_[chunk_index].load(std::memory_order_acquire);
+  }
+
+  Chunk* get_or_create_chunk(std::size_t index) {
+    auto* chunk = find_chunk(index);
+    if (chunk != nullptr) {
+      return chunk;
+    }
+
+    auto new_chunk = std::make_unique<Chunk>();
+    auto& atomic_chunk = chunks_[index / kChunkSize];
+    if (atomic_chunk.compare_exchange_strong(
+            chunk, new_chunk.get(), std::memory_order_acq_rel)) {
+      return new_chunk.release();
+    }
+    // Another thread created the chunk first, `chunk` now points to it.
+    return chunk;
+  }
+
+ private:
+  std::unique_ptr<std::atomic<Chunk*>[]> chunks_;
+  std::atomic<std::size_t> size_;
+};
+
+} // namespace marianatrench
@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <cstring>
+
+#include <mariana-trench/SourceScanner.h>
+
+namespace marianatrench {
+namespace source_scanner {
+
+namespace {
+
+// Whitespace as matched by `\s` in RE2.
+bool is_whitespace(char character) {
+  switch (character) {
+    case ' ':
+    case '\t':
+    case '\n':
+    case '\f':
+    case '\r':
+      return true;
+    default:
+      return false;
+  }
+}
+
+bool starts_with(std::string_view line, std::string_view prefix) {
+  return line.substr(0, prefix.size()) == prefix;
+}
+
+} // namespace
+
+std::vector<std::size_t> line_offsets(std::string_view content) {
+  std::vector<std::size_t> offsets;
+  if (content.empty()) {
+    offsets.push_back(0);
+    return offsets;
+  }
+
+  const char* data = content.data();
+  std::size_t offset = 0;
+  while (offset < content.size()) {
+    offsets.push_back(offset);
+    const auto* newline = static_cast<const char*>(
+        std::memchr(data + offset, '\n', content.size() - offset));
+    if (newline == nullptr) {
+      offset = content.size() + 1;
+      break;
+    }
+    offset = static_cast<std::size_t>(newline - data) + 1;
+  }
+  offsets.push_back(offset);
+  return offsets;
+}
+
+bool may_declare_class(std::string_view line) {
+  std::size_t start = 0;
+  while (start < line.size() && is_whitespace(line[start])) {
+    start++;
+  }
+  line.remove_prefix(start);
+  if (line.empty()) {
+    return false;
+  }
+
+  // A declaration starts with a comment, a modifier or a keyword.
+  switch (line.front()) {
+    case '/':
+      return starts_with(line, "/*");
+    case 'p':
+      return starts_with(line, "public") || starts_with(line, "private");
+    case 'i':
+      return starts_with(line, "internal") || starts_with(line, "interface");
+    case 'a':
+      return starts_with(line, "abstract");
+    case 'f':
+      return starts_with(line, "final");
+    case 'o':
+      return starts_with(line, "open") || starts_with(line, "object");
+    case 'c':
+      return starts_with(line, "class");
+    case 'e':
+      return starts_with(line, "enum");
+    default:
+      return false;
+  }
+}
+
+bool may_declare_package(std::string_view line) {
+  return starts_with(line, "package");
+}
+
+} // namespace source_scanner
+} // namespace marianatrench
@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+namespace marianatrench {
+
+/**
+ * Byte scanning of source files, shared by the source index (`Positions`)
+ * and the highlights (`Highlights::FileLines`).
+ *
+ * Newlines are found with `memchr`, which the C library vectorizes. Lines
+ * are then filtered before running regular expressions on them, by checking
+ * what the expressions require at the start of the line, which only reads a
+ * few bytes of most lines.
+ */
+namespace source_scanner {
+
+/**
+ * Return the offset of the first byte of each line, followed by the offset
+ * one past the newline ending the last line (as if the content ended with a
+ * newline). The number of lines is the size of the result minus one, and an
+ * empty content has no lines.
+ */
+std::vector<std::size_t> line_offsets(std::string_view content);
+
+/* Return the given line, without its newline, from the result above. */
+inline std::string_view line(
+    std::string_view content,
+    const std::vector<std::size_t>& offsets,
+    std::size_t index) {
+  auto begin = offsets[index];
+  auto end = offsets[index + 1] - 1;
+  return content.substr(begin, end - begin);
+}
+
+/**
+ * Return false if the line cannot match the class regex of the source index,
+ * i.e it does not start with whitespace followed by a comment, a modifier
+ * (e.g `public`, `final`) or a keyword (`class`, `enum`, `interface` or
+ * `object`).
+ */
+bool may_declare_class(std::string_view line);
+
+/* Return true if the line starts with `package`. */
+bool may_declare_package(std::string_view line);
+
+} // namespace source_scanner
+
+} // namespace marianatrench
@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <cstddef>
+
+namespace marianatrench {
+
+/**
+ * A read-only view over a contiguous sequence of elements, similar to the
+ * C++20 `std::span`.
+ *
+ * The span does not own the elements, which must outlive it.
+ */
+template <typename T>
+class Span final {
+ public:
+  using ConstIterator = const T*;
+
+ public:
+  // C++ container concept member types
+  using iterator = ConstIterator;
+  using const_iterator = ConstIterator;
+  using value_type = T;
+  using difference_type = std::ptrdiff_t;
+  using size_type = std::size_t;
+  using const_reference = const T&;
+  using const_pointer = const T*;
+
+ public:
+  Span() : begin_(nullptr), end_(nullptr) {}
+
+  Span(const T* begin, const T* end) : begin_(begin), end_(end) {}
+
+  Span(const Span&) = default;
+  Span(Span&&) = default;
+  Span& operator=(const Span&) = default;
+  Span& operator=(Span&&) = default;
+  ~Span() = default;
+
+  ConstIterator begin() const {
+    return begin_;
+  }
+
+  ConstIterator end() const {
+    return end_;
+  }
+
+  std::size_t size() const {
+    return static_cast<std::size_t>(end_ - begin_);
+  }
+
+  bool empty() const {
+    return begin_ == end_;
+  }
+
+  const T& operator[](std::size_t index) const {
+    return begin_[index];
+  }
+
+ private:
+  const T* begin_;
+  const T* end_;
+};
+
+} // namespace marianatrench
@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
+#include <boost/filesystem/operations.hpp>
+#include <fmt/format.h>
+#include <json/json.h>
+
+#include <mariana-trench/JsonValidation.h>
+#include <mariana-trench/Log.h>
+#include <mariana-trench/SpilledModels.h>
+
+namespace marianatrench {
+
+SpilledModels::SpilledModels(boost::filesystem::path directory)
+    : directory_(std::move(directory)) {
+  boost::filesystem::remove_all(directory_);
+  boost::filesystem::create_directories(directory_);
+}
+
+SpilledModels::~SpilledModels() {
+  segments_.clear();
+  boost::system::error_code error;
+  boost::filesystem::remove_all(directory_, error);
+  if (error) {
+    WARNING(
+        1,
+        "Could not remove spilled models in `{}`: {}",
+        directory_.native(),
+        error.message());
+  }
+}
+
+void SpilledModels::spill(
+    const std::vector<std::shared_ptr<const Model>>& models,
+    Context& context) {
+  if (models.empty()) {
+    return;
+  }
+
+  auto segment = segments_.size();
+  auto path = directory_ / fmt::format("segment@{:05}.json", segment);
+  std::ofstream stream(
+      path.native(), std::ios_base::out | std::ios_base::binary);
+  if (!stream.is_open()) {
+    throw std::runtime_error(
+        fmt::format("Unable to write models to `{}`.", path.native()));
+  }
+
+  auto writer = JsonValidation::compact_writer();
+  std::size_t offset = 0;
+  std::vector<std::pair<const Method*, Location>> locations;
+  locations.reserve(models.size());
+  for (const auto& model : models) {
+    std::ostringstream line;
+    writer->write(model->to_json(context), &line);
+    line << "\n";
+    auto content = line.str();
+    stream << content;
+    locations.emplace_back(
+        model->method(), Location{segment, offset, content.size()});
+    offset += content.size();
+  }
+  stream.close();
+  if (!stream) {
+    throw std::runtime_error(
+        fmt::format("Unable to write models to `{}`.", path.native()));
+  }
+
+  segments_.push_back(
+      std::make_unique<boost::iostreams::mapped_file_source>(path));
+  for (const auto& [method, location] : locations) {
+    locations_.insert_or_assign(method, location);
+  }
+}
+
+std::shared_ptr<const Model> SpilledModels::get(
+    const Method* method,
+    Context& context) const {
+  auto found = locations_.find(method);
+  if (found == locations_.end()) {
+    return nullptr;
+  }
+
+  static const auto builder = Json::CharReaderBuilder();
+  thread_local std::unique_ptr<Json::CharReader> reader(
+      builder.newCharReader());
+
+  const auto& location = found->second;
+  const auto* data = segments_.at(location.segment)->data() + location.offset;
+  std::string errors;
+  Json::Value value;
+  if (!reader->parse(data, data + location.length, &value, &errors)) {
+    throw std::runtime_error(fmt::format(
+        "Spilled model of `{}` is not valid json: {}", method->show(), errors));
+  }
+  return std::make_shared<const Model>(
+      Model::from_json(method, value, context));
+}
+
+} // namespace marianatrench
@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include <boost/filesystem/path.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+
+#include <mariana-trench/Context.h>
+#include <mariana-trench/Method.h>
+#include <mariana-trench/Model.h>
+
+namespace marianatrench {
+
+/**
+ * Models of methods that converged during the global fixpoint, moved out of
+ * memory (see `--spill-cold-models`).
+ *
+ * Each call to `spill` writes the models as compact json lines to a new
+ * segment file in the given directory. Segments are memory-mapped and a model
+ * is only parsed when it is requested, hence the operating system pages them
+ * in and out as needed. The directory is removed on destruction.
+ */
+class SpilledModels final {
+ public:
+  explicit SpilledModels(boost::filesystem::path directory);
+
+  SpilledModels(const SpilledModels&) = delete;
+  SpilledModels(SpilledModels&&) = delete;
+  SpilledModels& operator=(const SpilledModels&) = delete;
+  SpilledModels& operator=(SpilledModels&&) = delete;
+  ~SpilledModels();
+
+  /**
+   * Write the given models to a new segment. This is not thread-safe: it
+   * must not be called concurrently with `spill` or `get`.
+   */
+  void spill(
+      const std::vector<std::shared_ptr<const Model>>& models,
+      Context& context);
+
+  /**
+   * Return the spilled model of the given method, or `nullptr`. This is
+   * thread-safe.
+   */
+  std::shared_ptr<const Model> get(const Method* method, Context& context)
+      const;
+
+  bool contains(const Method* method) const {
+    return locations_.count(method) != 0;
+  }
+
+  /* Call `visitor` on all spilled methods. */
+  template <typename Visitor> // void(const Method*)
+  void visit(Visitor&& visitor) const {
+    for (const auto& [method, _] : locations_) {
+      visitor(method);
+    }
+  }
+
+  std::size_t size() const {
+    return locations_.size();
+  }
+
+ private:
+  struct Location {
+    std::size_t segment;
+    std::size_t offset;
+    std::size_t length;
+  };
+
+  boost::filesystem::path directory_;
+  std::vector<std::unique_ptr<boost::iostreams::mapped_file_source>> segments_;
+  std::unordered_map<const Method*, Location> locations_;
+};
+
+} // namespace marianatrench
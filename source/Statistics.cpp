@@ -6,6 +6,7 @@
  */
 
 #include <algorithm>
+#include <utility>
 
 #include <Show.h>
 #include <SpartaWorkQueue.h>
@@ -14,6 +15,19 @@
 
 namespace marianatrench {
 
+namespace {
+
+constexpr std::uint64_t kNoIdentifier = 0;
+
+std::atomic<std::uint64_t> next_identifier{kNoIdentifier + 1};
+
+} // namespace
+
+Statistics::Statistics()
+    : id_(next_identifier.fetch_add(1)), pending_(false) {
+  time_histogram_.fill(0);
+}
+
 void Statistics::log_number_iterations(std::size_t number_iterations) {
   std::lock_guard<std::mutex> lock(mutex_);
   number_iterations_ = number_iterations;
@@ -31,8 +45,86 @@ void Statistics::log_time(const std::string& name, const Timer& timer) {
 
 void Statistics::log_time(const Method* method, const Timer& timer) {
   double duration_in_seconds = timer.duration_in_seconds();
+  auto& buffer = this->buffer();
+  {
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    buffer.times.emplace_back(method, duration_in_seconds);
+  }
+  // Only write the flag when needed, to avoid sharing its cache line.
+  if (!pending_.load(std::memory_order_relaxed)) {
+    pending_.store(true);
+  }
+}
 
-  std::lock_guard<std::mutex> lock(mutex_);
+void Statistics::log_fixpoint(
+    const Method* method,
+    const FixpointStatistics& fixpoint) {
+  auto& buffer = this->buffer();
+  {
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    buffer.fixpoints.emplace_back(method, fixpoint);
+  }
+  if (!pending_.load(std::memory_order_relaxed)) {
+    pending_.store(true);
+  }
+}
+
+Statistics::Buffer& Statistics::buffer() {
+  // Cache the buffer of the last instance used by this thread. Identifiers
+  // are never reused, hence a stale pointer is never dereferenced.
+  thread_local std::uint64_t cached_id = kNoIdentifier;
+  thread_local Buffer* cached_buffer = nullptr;
+  if (cached_id != id_) {
+    std::lock_guard<std::mutex> lock(buffers_mutex_);
+    buffers_.push_back(std::make_unique<Buffer>());
+    cached_buffer = buffers_.back().get();
+    cached_id = id_;
+  }
+  return *cached_buffer;
+}
+
+void Statistics::merge() const {
+  // Reset the flag before draining, so that records appended after a buffer
+  // was drained set it again.
+  if (!pending_.exchange(false)) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> buffers_lock(buffers_mutex_);
+  for (const auto& buffer : buffers_) {
+    std::vector<std::pair<const Method*, double>> times;
+    std::vector<std::pair<const Method*, FixpointStatistics>> fixpoints;
+    {
+      std::lock_guard<std::mutex> lock(buffer->mutex);
+      times.swap(buffer->times);
+      fixpoints.swap(buffer->fixpoints);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& [method, duration_in_seconds] : times) {
+      record_time(method, duration_in_seconds);
+    }
+    for (const auto& [method, fixpoint] : fixpoints) {
+      record_fixpoint(method, fixpoint);
+    }
+  }
+}
+
+void Statistics::record_time(
+    const Method* method,
+    double duration_in_seconds) const {
+  auto milliseconds = duration_in_seconds * 1000.0;
+  std::size_t bucket = 0;
+  while (bucket + 1 < kTimeHistogramBuckets &&
+         milliseconds >= static_cast<double>(std::uint64_t(1) << bucket)) {
+    bucket++;
+  }
+  time_histogram_[bucket]++;
+
+  auto& method_time = method_times_[method];
+  method_time.last = duration_in_seconds;
+  method_time.total += duration_in_seconds;
+  method_time.analyses++;
 
   if (slowest_methods_.size() >= Statistics::kRecordSlowestMethods &&
       slowest_methods_.back().second > duration_in_seconds) {
@@ -61,6 +153,115 @@ void Statistics::log_time(const Method* method, const Timer& timer) {
       record);
 }
 
+void Statistics::record_fixpoint(
+    const Method* method,
+    const FixpointStatistics& fixpoint) const {
+  total_fixpoint_.block_visits += fixpoint.block_visits;
+  total_fixpoint_.skipped_block_visits += fixpoint.skipped_block_visits;
+  total_fixpoint_.joins += fixpoint.joins;
+  total_fixpoint_.widenings += fixpoint.widenings;
+  total_fixpoint_.removed_exception_edges += fixpoint.removed_exception_edges;
+  total_fixpoint_.maximum_environment_size = std::max(
+      total_fixpoint_.maximum_environment_size,
+      fixpoint.maximum_environment_size);
+
+  if (most_visited_methods_.size() >= Statistics::kRecordSlowestMethods &&
+      most_visited_methods_.back().second.block_visits >
+          fixpoint.block_visits) {
+    return;
+  }
+
+  auto found = std::find_if(
+      most_visited_methods_.begin(),
+      most_visited_methods_.end(),
+      [=](const auto& record) { return record.first == method; });
+  if (found != most_visited_methods_.end()) {
+    most_visited_methods_.erase(found);
+  } else if (
+      most_visited_methods_.size() >= Statistics::kRecordSlowestMethods) {
+    most_visited_methods_.pop_back();
+  }
+
+  auto record = std::make_pair(method, fixpoint);
+  most_visited_methods_.insert(
+      std::upper_bound(
+          most_visited_methods_.begin(),
+          most_visited_methods_.end(),
+          record,
+          [](const auto& left, const auto& right) {
+            return left.second.block_visits > right.second.block_visits;
+          }),
+      record);
+}
+
+void Statistics::log_imprecise_methods(std::vector<const Method*> methods) {
+  std::sort(
+      methods.begin(),
+      methods.end(),
+      [](const Method* left, const Method* right) {
+        return left->show() < right->show();
+      });
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  imprecise_methods_ = std::move(methods);
+}
+
+void Statistics::log_truncated_origins(std::size_t number_truncated_origins) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  number_truncated_origins_ = number_truncated_origins;
+}
+
+void Statistics::log_model_widening(const Method* method) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  model_widenings_[method]++;
+}
+
+void Statistics::log_phase_resident_set_size(
+    const std::string& phase,
+    double before_in_gb,
+    double after_in_gb) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  phase_resident_set_sizes_[phase] = {before_in_gb, after_in_gb};
+}
+
+void Statistics::log_output(
+    const std::string& name,
+    const OutputStatistics& output) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  outputs_[name] = output;
+}
+
+void Statistics::log_performance_counters(
+    const std::string& phase,
+    const PerformanceCounters::Values& values) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  phase_counters_[phase] += values;
+}
+
+void Statistics::log_performance_counters(
+    const Method* method,
+    const PerformanceCounters::Values& values) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  method_counters_[method] += values;
+}
+
+std::optional<double> Statistics::method_time(const Method* method) const {
+  merge();
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto found = method_times_.find(method);
+  if (found == method_times_.end()) {
+    return std::nullopt;
+  }
+  return found->second.last;
+}
+
+std::unordered_map<const Method*, MethodTime> Statistics::method_times()
+    const {
+  merge();
+  std::lock_guard<std::mutex> lock(mutex_);
+  return method_times_;
+}
+
 namespace {
 
 double round(double x, int digits) {
@@ -68,9 +269,27 @@ double round(double x, int digits) {
   return std::round(x * y) / y;
 }
 
+Json::Value fixpoint_to_json(const FixpointStatistics& fixpoint) {
+  auto value = Json::Value(Json::objectValue);
+  value["block_visits"] =
+      Json::Value(static_cast<Json::UInt64>(fixpoint.block_visits));
+  value["skipped_block_visits"] =
+      Json::Value(static_cast<Json::UInt64>(fixpoint.skipped_block_visits));
+  value["joins"] = Json::Value(static_cast<Json::UInt64>(fixpoint.joins));
+  value["widenings"] =
+      Json::Value(static_cast<Json::UInt64>(fixpoint.widenings));
+  value["removed_exception_edges"] =
+      Json::Value(static_cast<Json::UInt64>(fixpoint.removed_exception_edges));
+  value["maximum_environment_size"] =
+      Json::Value(static_cast<Json::UInt64>(fixpoint.maximum_environment_size));
+  return value;
+}
+
 } // namespace
 
 Json::Value Statistics::to_json() const {
+  merge();
+
   auto value = Json::Value(Json::objectValue);
   value["iterations"] =
       Json::Value(static_cast<Json::UInt64>(number_iterations_));
@@ -86,12 +305,138 @@ Json::Value Statistics::to_json() const {
   auto slowest_methods_value = Json::Value(Json::arrayValue);
   for (const auto& record : slowest_methods_) {
     auto slow_method_value = Json::Value(Json::arrayValue);
-    slow_method_value.append(Json::Value(show(record.first)));
+    slow_method_value.append(Json::Value(record.first->show()));
     slow_method_value.append(Json::Value(round(record.second, 3)));
     slowest_methods_value.append(slow_method_value);
   }
   value["slowest_methods"] = slowest_methods_value;
 
+  auto time_histogram_value = Json::Value(Json::arrayValue);
+  for (std::size_t bucket = 0; bucket < kTimeHistogramBuckets; bucket++) {
+    if (time_histogram_[bucket] == 0) {
+      continue;
+    }
+    auto bucket_value = Json::Value(Json::objectValue);
+    bucket_value["min_seconds"] = Json::Value(
+        bucket == 0 ? 0.0
+                    : static_cast<double>(std::uint64_t(1) << (bucket - 1)) /
+                1000.0);
+    bucket_value["analyses"] =
+        Json::Value(static_cast<Json::UInt64>(time_histogram_[bucket]));
+    time_histogram_value.append(bucket_value);
+  }
+  value["method_time_histogram"] = time_histogram_value;
+
+  auto fixpoint_value = fixpoint_to_json(total_fixpoint_);
+  auto most_visited_methods_value = Json::Value(Json::arrayValue);
+  for (const auto& [method, fixpoint] : most_visited_methods_) {
+    auto method_value = fixpoint_to_json(fixpoint);
+    method_value["method"] = Json::Value(method->show());
+    most_visited_methods_value.append(method_value);
+  }
+  fixpoint_value["most_visited_methods"] = most_visited_methods_value;
+  value["fixpoint"] = fixpoint_value;
+
+  if (!imprecise_methods_.empty()) {
+    auto imprecise_methods_value = Json::Value(Json::arrayValue);
+    for (const auto* method : imprecise_methods_) {
+      imprecise_methods_value.append(Json::Value(method->show()));
+    }
+    value["imprecise_methods"] = imprecise_methods_value;
+  }
+
+  if (number_truncated_origins_ > 0) {
+    value["truncated_origins"] =
+        Json::Value(static_cast<Json::UInt64>(number_truncated_origins_));
+  }
+
+  if (!model_widenings_.empty()) {
+    // Members of json objects are sorted by name.
+    auto model_widenings_value = Json::Value(Json::objectValue);
+    for (const auto& [method, widenings_count] : model_widenings_) {
+      model_widenings_value[method->show()] =
+          Json::Value(static_cast<Json::UInt64>(widenings_count));
+    }
+    value["model_widenings"] = model_widenings_value;
+  }
+
+  if (!phase_resident_set_sizes_.empty()) {
+    auto phases_value = Json::Value(Json::objectValue);
+    for (const auto& [phase, sizes] : phase_resident_set_sizes_) {
+      auto phase_value = Json::Value(Json::objectValue);
+      phase_value["before"] = Json::Value(round(sizes.first, 3));
+      phase_value["after"] = Json::Value(round(sizes.second, 3));
+      phases_value[phase] = phase_value;
+    }
+    value["phase_rss"] = phases_value;
+  }
+
+  if (!outputs_.empty()) {
+    auto outputs_value = Json::Value(Json::objectValue);
+    for (const auto& [name, output] : outputs_) {
+      auto output_value = Json::Value(Json::objectValue);
+      output_value["files"] =
+          Json::Value(static_cast<Json::UInt64>(output.files));
+      output_value["bytes"] =
+          Json::Value(static_cast<Json::UInt64>(output.bytes));
+      output_value["writes"] =
+          Json::Value(static_cast<Json::UInt64>(output.writes));
+      output_value["write_seconds"] =
+          Json::Value(round(output.write_seconds, 3));
+      output_value["sync_seconds"] = Json::Value(round(output.sync_seconds, 3));
+      output_value["wait_seconds"] = Json::Value(round(output.wait_seconds, 3));
+      // Throughput of the I/O threads, and latency of a single write.
+      output_value["megabytes_per_second"] = Json::Value(
+          output.write_seconds > 0.0
+              ? round(output.bytes / output.write_seconds / 1e6, 1)
+              : 0.0);
+      output_value["average_write_milliseconds"] = Json::Value(
+          output.writes > 0
+              ? round(output.write_seconds * 1000.0 / output.writes, 3)
+              : 0.0);
+      output_value["maximum_write_milliseconds"] =
+          Json::Value(round(output.maximum_write_seconds * 1000.0, 3));
+      outputs_value[name] = output_value;
+    }
+    value["outputs"] = outputs_value;
+  }
+
+  if (!phase_counters_.empty() || !method_counters_.empty()) {
+    auto phases_value = Json::Value(Json::objectValue);
+    for (const auto& [phase, values] : phase_counters_) {
+      phases_value[phase] = values.to_json();
+    }
+
+    // Methods with the most cycles first.
+    std::vector<std::pair<const Method*, PerformanceCounters::Values>>
+        method_counters(method_counters_.begin(), method_counters_.end());
+    std::sort(
+        method_counters.begin(),
+        method_counters.end(),
+        [](const auto& left, const auto& right) {
+          auto left_cycles = left.second[PerformanceCounters::Event::Cycles];
+          auto right_cycles = right.second[PerformanceCounters::Event::Cycles];
+          if (left_cycles != right_cycles) {
+            return left_cycles > right_cycles;
+          }
+          return left.first->show() < right.first->show();
+        });
+    if (method_counters.size() > kRecordPerformanceCountersMethods) {
+      method_counters.resize(kRecordPerformanceCountersMethods);
+    }
+    auto methods_value = Json::Value(Json::arrayValue);
+    for (const auto& [method, values] : method_counters) {
+      auto method_value = values.to_json();
+      method_value["method"] = Json::Value(method->show());
+      methods_value.append(method_value);
+    }
+
+    auto performance_counters_value = Json::Value(Json::objectValue);
+    performance_counters_value["phases"] = phases_value;
+    performance_counters_value["methods"] = methods_value;
+    value["performance_counters"] = performance_counters_value;
+  }
+
   return value;
 }
 
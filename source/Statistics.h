@@ -7,23 +7,69 @@
 
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
 #include <mutex>
+#include <optional>
 #include <unordered_map>
 #include <vector>
 
 #include <json/json.h>
 
 #include <mariana-trench/Method.h>
+#include <mariana-trench/PerformanceCounters.h>
 #include <mariana-trench/Timer.h>
 
 namespace marianatrench {
 
+/* Counters of the intraprocedural fixpoint of a method. */
+struct FixpointStatistics {
+  std::size_t block_visits = 0;
+  // Visits of blocks whose entry state did not change since their last visit.
+  std::size_t skipped_block_visits = 0;
+  std::size_t joins = 0;
+  std::size_t widenings = 0;
+  // Exception edges removed by `--thin-exception-edges`.
+  std::size_t removed_exception_edges = 0;
+
+  // Maximum number of registers and memory locations in an environment.
+  std::size_t maximum_environment_size = 0;
+};
+
+/* Counters of the writes of output files, see `ShardWriter`. */
+struct OutputStatistics {
+  std::size_t files = 0;
+  std::size_t bytes = 0;
+  std::size_t writes = 0;
+  // Time spent in `write` calls, summed over the I/O threads.
+  double write_seconds = 0.0;
+  double maximum_write_seconds = 0.0;
+  // Time spent in `fsync` calls, summed over the I/O threads.
+  double sync_seconds = 0.0;
+  // Time serializing threads waited for a buffer to be written.
+  double wait_seconds = 0.0;
+};
+
+/* Durations of the analyses of a method, in seconds. */
+struct MethodTime {
+  double last = 0.0;
+  double total = 0.0;
+  std::size_t analyses = 0;
+};
+
 /**
  * Record various statistics during the analysis.
+ *
+ * Durations and fixpoint counters of methods are logged once per analysis by
+ * every worker. They are appended to a buffer owned by the logging thread,
+ * which is only locked by that thread and by `merge`, and merged into the
+ * statistics at the end of each global iteration or when they are read.
  */
 class Statistics final {
  public:
-  Statistics() = default;
+  Statistics();
 
   Statistics(const Statistics&) = delete;
   Statistics(Statistics&&) = delete;
@@ -34,15 +80,114 @@ class Statistics final {
   void log_number_iterations(std::size_t number_iterations);
   void log_resident_set_size(double resident_set_size);
   void log_time(const std::string& name, const Timer& timer);
+  /* Record the duration of an analysis of a method. */
   void log_time(const Method* method, const Timer& timer);
 
+  /* Record the counters of the last intraprocedural fixpoint of a method. */
+  void log_fixpoint(const Method* method, const FixpointStatistics& fixpoint);
+
+  /**
+   * Merge the records of all threads. This is thread-safe, and called by all
+   * accessors. Records are merged thread by thread, hence `MethodTime::last`
+   * is only exact for methods analyzed by a single thread since the last
+   * merge.
+   */
+  void merge() const;
+
+  /* Record the methods whose models did not reach the global fixpoint. */
+  void log_imprecise_methods(std::vector<const Method*> methods);
+
+  /* Record the number of origin sets summarized by `--maximum-origins`. */
+  void log_truncated_origins(std::size_t number_truncated_origins);
+
+  /* Record that the global fixpoint widened the model of a method. */
+  void log_model_widening(const Method* method);
+
+  /**
+   * Record the resident set size before and after a phase (see
+   * `PhaseCounters`), in GB. Phases that run several times keep their last
+   * record.
+   */
+  void log_phase_resident_set_size(
+      const std::string& phase,
+      double before_in_gb,
+      double after_in_gb);
+
+  /* Record the writes of the output files of the given name. */
+  void log_output(const std::string& name, const OutputStatistics& output);
+
+  /* Record the hardware counters of a phase, see `PhaseCounters`. */
+  void log_performance_counters(
+      const std::string& phase,
+      const PerformanceCounters::Values& values);
+
+  /**
+   * Record the hardware counters of an analysis of a method that took at
+   * least `kPerformanceCountersMinimumSeconds`. Counters of all analyses of a
+   * method are summed.
+   */
+  void log_performance_counters(
+      const Method* method,
+      const PerformanceCounters::Values& values);
+
+  /**
+   * Return the duration of the last analysis of the given method, in seconds,
+   * or `std::nullopt` if the method was never analyzed.
+   */
+  std::optional<double> method_time(const Method* method) const;
+
+  /* Return the durations of the analyses of all analyzed methods. */
+  std::unordered_map<const Method*, MethodTime> method_times() const;
+
   Json::Value to_json() const;
 
   /* Maximum number of slowest methods to record. */
   constexpr static std::size_t kRecordSlowestMethods = 20;
 
+  /**
+   * Number of buckets of the histogram of analysis durations. Bucket 0 holds
+   * durations below 1ms and bucket `i` durations in [2^(i-1)ms, 2^i ms), the
+   * last bucket is unbounded.
+   */
+  constexpr static std::size_t kTimeHistogramBuckets = 24;
+
+  /* Minimum duration of an analysis to record its hardware counters. */
+  constexpr static double kPerformanceCountersMinimumSeconds = 1.0;
+
+  /* Maximum number of methods with hardware counters to record. */
+  constexpr static std::size_t kRecordPerformanceCountersMethods = 100;
+
+ private:
+  /* Records of a thread that are not merged yet. */
+  struct Buffer {
+    std::mutex mutex;
+    std::vector<std::pair<const Method*, double>> times;
+    std::vector<std::pair<const Method*, FixpointStatistics>> fixpoints;
+  };
+
+  /* Return the buffer of the current thread. */
+  Buffer& buffer();
+
+  // These require `mutex_`.
+  void record_time(const Method* method, double duration_in_seconds) const;
+  void record_fixpoint(
+      const Method* method,
+      const FixpointStatistics& fixpoint) const;
+
  private:
-  std::mutex mutex_;
+  // Identifies this instance in the buffer cache of threads.
+  const std::uint64_t id_;
+
+  // Buffers of all threads that logged into this instance, protected by
+  // `buffers_mutex_`. Buffers are never removed, since threads keep a pointer
+  // to theirs.
+  mutable std::mutex buffers_mutex_;
+  std::vector<std::unique_ptr<Buffer>> buffers_;
+
+  // Whether some buffer may have records that are not merged yet.
+  mutable std::atomic<bool> pending_;
+
+  mutable std::mutex mutex_;
 
   // Final number of iterations.
   std::size_t number_iterations_ = 0;
@@ -53,8 +198,44 @@ class Statistics final {
   // Recorded times for each step of the analysis.
   std::unordered_map<std::string, double> times_;
 
+  // Durations of the analyses of each method, updated by `merge`, as well as
+  // the statistics of methods below.
+  mutable std::unordered_map<const Method*, MethodTime> method_times_;
+
+  // Number of analyses in each bucket of durations.
+  mutable std::array<std::size_t, kTimeHistogramBuckets> time_histogram_;
+
+  // Methods whose models did not reach the global fixpoint.
+  std::vector<const Method*> imprecise_methods_;
+
+  // Number of origin sets that exceeded the maximum size.
+  std::size_t number_truncated_origins_ = 0;
+
+  // Number of model widenings in the global fixpoint, for each method.
+  std::unordered_map<const Method*, std::size_t> model_widenings_;
+
+  // Resident set size before and after each phase, in GB.
+  std::unordered_map<std::string, std::pair<double, double>>
+      phase_resident_set_sizes_;
+
+  // Writes of output files, by name (e.g `models`).
+  std::unordered_map<std::string, OutputStatistics> outputs_;
+
+  // Hardware counters of phases and of slow analyses, when
+  // `--performance-counters` is used.
+  std::unordered_map<std::string, PerformanceCounters::Values> phase_counters_;
+  std::unordered_map<const Method*, PerformanceCounters::Values>
+      method_counters_;
+
   // Sorted list of slowest methods to analyze (from slowest to fastest).
-  std::vector<std::pair<const Method*, double>> slowest_methods_;
+  mutable std::vector<std::pair<const Method*, double>> slowest_methods_;
+
+  // Sum of the counters of all intraprocedural fixpoints.
+  mutable FixpointStatistics total_fixpoint_;
+
+  // Sorted list of methods with the most block visits (from most to least).
+  mutable std::vector<std::pair<const Method*, FixpointStatistics>>
+      most_visited_methods_;
 };
 
 } // namespace marianatrench
@@ -5,8 +5,9 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <algorithm>
+#include <limits>
 #include <unordered_map>
-#include <unordered_set>
 
 #include <mariana-trench/Methods.h>
 #include <mariana-trench/StronglyConnectedComponents.h>
@@ -15,11 +16,24 @@ namespace marianatrench {
 
 namespace {
 
+constexpr std::size_t k_unvisited = std::numeric_limits<std::size_t>::max();
+
 /*
  * Tarjan's algorithm to compute strongly connected components.
  * https://en.wikipedia.org/wiki/Tarjan%27s_strongly_connected_components_algorithm
+ *
+ * The depth-first search uses an explicit stack rather than recursion, since
+ * call chains can be deep enough to overflow the native stack. The state is
+ * kept in flat arrays indexed by method identifiers, which are dense.
  */
 class StronglyConnectedComponentsBuilder final {
+ private:
+  struct SearchFrame {
+    const Method* method;
+    Span<const Method*> callers;
+    std::size_t next_caller;
+  };
+
  public:
   explicit StronglyConnectedComponentsBuilder(
       const Methods& methods,
@@ -27,11 +41,19 @@ class StronglyConnectedComponentsBuilder final {
       std::vector<std::vector<const Method*>>& components)
       : methods_(methods),
         dependencies_(dependencies),
-        components_(components) {}
+        components_(components) {
+    std::size_t size = 0;
+    for (const auto* method : methods_) {
+      size = std::max(size, method->id() + 1);
+    }
+    index_.resize(size, k_unvisited);
+    lowlink_.resize(size, k_unvisited);
+    on_stack_.resize(size, false);
+  }
 
   void build() {
     for (const auto* method : methods_) {
-      if (index_.count(method) == 0) {
+      if (index_[method->id()] == k_unvisited) {
         process(method);
       }
     }
@@ -39,36 +61,61 @@ class StronglyConnectedComponentsBuilder final {
     std::reverse(components_.begin(), components_.end());
   }
 
+  std::size_t size() const {
+    return index_.size();
+  }
+
  private:
-  void process(const Method* method) {
-    index_[method] = current_index_;
-    lowlink_[method] = current_index_;
+  void visit(const Method* method) {
+    index_[method->id()] = current_index_;
+    lowlink_[method->id()] = current_index_;
     current_index_++;
     stack_.push_back(method);
-    on_stack_.insert(method);
-
-    for (const auto* caller : dependencies_.dependencies(method)) {
-      if (index_.count(caller) == 0) {
-        process(caller);
-        lowlink_[method] = std::min(lowlink_[method], lowlink_[caller]);
-      } else if (on_stack_.count(caller) > 0) {
-        lowlink_[method] = std::min(lowlink_[method], index_[caller]);
+    on_stack_[method->id()] = true;
+    search_.push_back(
+        SearchFrame{method, dependencies_.dependencies(method), 0});
+  }
+
+  void process(const Method* root) {
+    visit(root);
+
+    while (!search_.empty()) {
+      auto& frame = search_.back();
+      const auto* method = frame.method;
+
+      if (frame.next_caller < frame.callers.size()) {
+        const auto* caller = frame.callers[frame.next_caller++];
+        if (index_[caller->id()] == k_unvisited) {
+          // This invalidates `frame`.
+          visit(caller);
+        } else if (on_stack_[caller->id()]) {
+          lowlink_[method->id()] =
+              std::min(lowlink_[method->id()], index_[caller->id()]);
+        }
+        continue;
+      }
+
+      search_.pop_back();
+      if (!search_.empty()) {
+        const auto* parent = search_.back().method;
+        lowlink_[parent->id()] =
+            std::min(lowlink_[parent->id()], lowlink_[method->id()]);
       }
-    }
 
-    if (lowlink_[method] == index_[method]) {
-      // Found a strongly connected component.
-      std::vector<const Method*> component;
+      if (lowlink_[method->id()] == index_[method->id()]) {
+        // Found a strongly connected component.
+        std::vector<const Method*> component;
 
-      const Method* other_method;
-      do {
-        other_method = stack_.back();
-        stack_.pop_back();
-        on_stack_.erase(other_method);
-        component.push_back(other_method);
-      } while (method != other_method);
+        const Method* other_method;
+        do {
+          other_method = stack_.back();
+          stack_.pop_back();
+          on_stack_[other_method->id()] = false;
+          component.push_back(other_method);
+        } while (method != other_method);
 
-      components_.push_back(std::move(component));
+        components_.push_back(std::move(component));
+      }
     }
   }
 
@@ -80,9 +127,221 @@ class StronglyConnectedComponentsBuilder final {
   // State of the algorithm.
   std::size_t current_index_ = 0;
   std::vector<const Method*> stack_;
-  std::unordered_map<const Method*, std::size_t> index_;
-  std::unordered_map<const Method*, std::size_t> lowlink_;
-  std::unordered_set<const Method*> on_stack_;
+  std::vector<SearchFrame> search_;
+  std::vector<std::size_t> index_;
+  std::vector<std::size_t> lowlink_;
+  std::vector<bool> on_stack_;
+};
+
+/*
+ * Bourdoncle's weak topological order of the methods of a strongly connected
+ * component, following dependencies (from callees to callers).
+ *
+ * The order of a strongly connected set of methods is a head followed by the
+ * order of each strongly connected component of the remaining methods, in
+ * topological order. Callees then come before their callers, except for the
+ * dependencies to heads. The head is the method with the fewest callees in
+ * the set, which is the closest to a leaf.
+ *
+ * Nested sets are processed with an explicit stack, as in Tarjan's algorithm
+ * above. Decomposing deeply nested components visits their edges once per
+ * level, hence the remaining methods are kept in their current order once
+ * `k_maximum_edge_visits_per_edge` visits per edge are reached.
+ */
+class WeakTopologicalOrderBuilder final {
+ private:
+  using Nodes = std::vector<std::size_t>;
+
+  struct SearchFrame {
+    std::size_t node;
+    std::size_t next_successor;
+  };
+
+  static constexpr std::size_t k_maximum_edge_visits_per_edge = 64;
+
+ public:
+  WeakTopologicalOrderBuilder(
+      const std::vector<const Method*>& component,
+      const Dependencies& dependencies)
+      : component_(component),
+        successors_(component.size()),
+        index_(component.size(), k_unvisited),
+        lowlink_(component.size(), k_unvisited),
+        on_stack_(component.size(), false),
+        subset_(component.size(), 0) {
+    std::unordered_map<const Method*, std::size_t> local_index;
+    for (std::size_t node = 0; node < component.size(); node++) {
+      local_index.emplace(component[node], node);
+    }
+    std::size_t edges = 0;
+    for (std::size_t node = 0; node < component.size(); node++) {
+      for (const auto* caller : dependencies.dependencies(component[node])) {
+        auto found = local_index.find(caller);
+        if (found != local_index.end() && found->second != node) {
+          successors_[node].push_back(found->second);
+          edges++;
+        }
+      }
+    }
+    remaining_edge_visits_ = edges * k_maximum_edge_visits_per_edge;
+  }
+
+  std::vector<const Method*> build() {
+    std::vector<const Method*> order;
+    order.reserve(component_.size());
+
+    Nodes all_nodes(component_.size());
+    for (std::size_t node = 0; node < component_.size(); node++) {
+      all_nodes[node] = node;
+    }
+    std::vector<Nodes> stack = {std::move(all_nodes)};
+    while (!stack.empty()) {
+      auto nodes = std::move(stack.back());
+      stack.pop_back();
+      if (nodes.size() == 1 || remaining_edge_visits_ == 0) {
+        for (auto node : nodes) {
+          order.push_back(component_[node]);
+        }
+        continue;
+      }
+
+      auto head = choose_head(nodes);
+      order.push_back(component_[head]);
+      nodes.erase(std::find(nodes.begin(), nodes.end(), head));
+      auto components = this->components(nodes);
+      for (auto iterator = components.rbegin(), end = components.rend();
+           iterator != end;
+           ++iterator) {
+        stack.push_back(std::move(*iterator));
+      }
+    }
+    return order;
+  }
+
+ private:
+  /* Mark the given nodes as the current subset. */
+  void enter_subset(const Nodes& nodes) {
+    generation_++;
+    for (auto node : nodes) {
+      subset_[node] = generation_;
+    }
+  }
+
+  bool in_subset(std::size_t node) const {
+    return subset_[node] == generation_;
+  }
+
+  void visit_edges(std::size_t node) {
+    auto visits = successors_[node].size();
+    remaining_edge_visits_ -= std::min(remaining_edge_visits_, visits);
+  }
+
+  /* Return the node of the set with the fewest predecessors in the set. */
+  std::size_t choose_head(const Nodes& nodes) {
+    enter_subset(nodes);
+    std::unordered_map<std::size_t, std::size_t> predecessors;
+    for (auto node : nodes) {
+      visit_edges(node);
+      for (auto successor : successors_[node]) {
+        if (in_subset(successor)) {
+          predecessors[successor]++;
+        }
+      }
+    }
+    auto head = nodes.front();
+    for (auto node : nodes) {
+      if (predecessors[node] < predecessors[head]) {
+        head = node;
+      }
+    }
+    return head;
+  }
+
+  /**
+   * Tarjan's algorithm on the subgraph induced by the given nodes. Returns the
+   * strongly connected components in topological order, keeping the relative
+   * order of the nodes within each component.
+   */
+  std::vector<Nodes> components(const Nodes& nodes) {
+    enter_subset(nodes);
+    std::vector<Nodes> components;
+    std::size_t current_index = 0;
+    for (auto root : nodes) {
+      if (index_[root] != k_unvisited) {
+        continue;
+      }
+      visit(root, current_index);
+      while (!search_.empty()) {
+        auto& frame = search_.back();
+        auto node = frame.node;
+        if (frame.next_successor < successors_[node].size()) {
+          auto successor = successors_[node][frame.next_successor++];
+          if (!in_subset(successor)) {
+            continue;
+          }
+          if (index_[successor] == k_unvisited) {
+            // This invalidates `frame`.
+            visit(successor, current_index);
+          } else if (on_stack_[successor]) {
+            lowlink_[node] = std::min(lowlink_[node], index_[successor]);
+          }
+          continue;
+        }
+
+        search_.pop_back();
+        if (!search_.empty()) {
+          auto parent = search_.back().node;
+          lowlink_[parent] = std::min(lowlink_[parent], lowlink_[node]);
+        }
+        if (lowlink_[node] == index_[node]) {
+          Nodes component;
+          std::size_t other_node;
+          do {
+            other_node = stack_.back();
+            stack_.pop_back();
+            on_stack_[other_node] = false;
+            component.push_back(other_node);
+          } while (other_node != node);
+          std::sort(component.begin(), component.end());
+          components.push_back(std::move(component));
+        }
+      }
+    }
+
+    for (auto node : nodes) {
+      index_[node] = k_unvisited;
+      lowlink_[node] = k_unvisited;
+    }
+    std::reverse(components.begin(), components.end());
+    return components;
+  }
+
+  void visit(std::size_t node, std::size_t& current_index) {
+    visit_edges(node);
+    index_[node] = current_index;
+    lowlink_[node] = current_index;
+    current_index++;
+    stack_.push_back(node);
+    on_stack_[node] = true;
+    search_.push_back(SearchFrame{node, 0});
+  }
+
+ private:
+  const std::vector<const Method*>& component_;
+  // Local indices of the callers of each method within the component.
+  std::vector<Nodes> successors_;
+  std::size_t remaining_edge_visits_ = 0;
+
+  // State of Tarjan's algorithm, reset after each subset.
+  Nodes stack_;
+  std::vector<SearchFrame> search_;
+  std::vector<std::size_t> index_;
+  std::vector<std::size_t> lowlink_;
+  std::vector<bool> on_stack_;
+
+  // Nodes of the current subset have the current generation.
+  std::vector<std::size_t> subset_;
+  std::size_t generation_ = 0;
 };
 
 } // namespace
@@ -90,8 +349,42 @@ class StronglyConnectedComponentsBuilder final {
 StronglyConnectedComponents::StronglyConnectedComponents(
     const Methods& methods,
     const Dependencies& dependencies) {
-  StronglyConnectedComponentsBuilder(methods, dependencies, components_)
-      .build();
+  StronglyConnectedComponentsBuilder builder(
+      methods, dependencies, components_);
+  builder.build();
+
+  for (auto& component : components_) {
+    if (component.size() > 1) {
+      // Start from the order of Tarjan's algorithm, reversed, which tends to
+      // give callees before callers.
+      std::reverse(component.begin(), component.end());
+      component = WeakTopologicalOrderBuilder(component, dependencies).build();
+    }
+  }
+
+  component_index_.resize(builder.size(), k_unvisited);
+  for (std::size_t index = 0; index < components_.size(); index++) {
+    for (const auto* method : components_[index]) {
+      component_index_[method->id()] = index;
+    }
+  }
+
+  // Build the condensed graph of components.
+  dependent_components_.resize(components_.size());
+  for (std::size_t index = 0; index < components_.size(); index++) {
+    auto& dependents = dependent_components_[index];
+    for (const auto* method : components_[index]) {
+      for (const auto* caller : dependencies.dependencies(method)) {
+        auto caller_index = component_index_[caller->id()];
+        if (caller_index != index) {
+          dependents.push_back(caller_index);
+        }
+      }
+    }
+    std::sort(dependents.begin(), dependents.end());
+    dependents.erase(
+        std::unique(dependents.begin(), dependents.end()), dependents.end());
+  }
 }
 
 } // namespace marianatrench
@@ -18,7 +18,12 @@ namespace marianatrench {
  * Compute strongly connected components of a graph.
  *
  * The strongly connected components are in reverse topological order (from
- * leaves to roots).
+ * leaves to roots). The components and the dependencies between them form a
+ * directed acyclic graph, see `dependent_components`.
+ *
+ * The methods of each component are in a weak topological order (Bourdoncle)
+ * of their dependencies, hence callees come before their callers within a
+ * recursive component whenever possible.
  */
 class StronglyConnectedComponents final {
  public:
@@ -38,8 +43,29 @@ class StronglyConnectedComponents final {
     return components_;
   }
 
+  /* Index in `components()` of the component containing the given method. */
+  std::size_t component_index(const Method* method) const {
+    return component_index_.at(method->id());
+  }
+
+  /**
+   * Indices of the components that depend on the given component, i.e that
+   * contain a caller of one of its methods, in increasing order. These always
+   * come after the given component in `components()`.
+   */
+  const std::vector<std::size_t>& dependent_components(
+      std::size_t index) const {
+    return dependent_components_.at(index);
+  }
+
  private:
   std::vector<std::vector<const Method*>> components_;
+
+  // Indexed by method identifier (see `Method::id`).
+  std::vector<std::size_t> component_index_;
+
+  // Indexed by component index.
+  std::vector<std::vector<std::size_t>> dependent_components_;
 };
 
 } // namespace marianatrench
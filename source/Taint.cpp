@@ -6,6 +6,7 @@
  */
 
 #include <mariana-trench/JsonValidation.h>
+#include <mariana-trench/KindCosts.h>
 #include <mariana-trench/Taint.h>
 
 namespace marianatrench {
@@ -99,23 +100,34 @@ Taint Taint::propagate(
     const FeatureMayAlwaysSet& extra_features,
     Context& context,
     const std::vector<const DexType * MT_NULLABLE>& source_register_types,
-    const std::vector<std::optional<std::string>>& source_constant_arguments)
+    const std::vector<const DexString * MT_NULLABLE>& source_constant_arguments)
     const {
+  return propagate(
+      callee_port,
+      CallSiteContext(
+          caller,
+          callee,
+          call_position,
+          maximum_source_sink_distance,
+          extra_features,
+          context,
+          source_register_types,
+          source_constant_arguments));
+}
+
+Taint Taint::propagate(
+    const AccessPath& callee_port,
+    const CallSiteContext& call_site) const {
   Taint result;
+  auto* kind_costs = call_site.context().kind_costs.get();
   for (const auto& frames : set_) {
-    auto propagated = frames.propagate(
-        caller,
-        callee,
-        callee_port,
-        call_position,
-        maximum_source_sink_distance,
-        context,
-        source_register_types,
-        source_constant_arguments);
+    KindCostScope kind_cost_scope(
+        kind_costs, frames.kind(), KindCosts::Cost::Propagate);
+    auto propagated = frames.propagate(callee_port, call_site);
     if (propagated.is_bottom()) {
       continue;
     }
-    propagated.add_inferred_features(extra_features);
+    propagated.add_inferred_features(call_site.extra_features());
     result.add(propagated);
   }
   return result;
@@ -192,11 +204,13 @@ void Taint::update_non_leaf_positions(
         const Position*(const Method*, const AccessPath&, const Position*)>&
         new_call_position,
     const std::function<LocalPositionSet(const LocalPositionSet&)>&
-        new_local_positions) {
+        new_local_positions,
+    const std::function<bool(const Method*, const Position*)>& filter) {
   map([&](FrameSet& frames) {
     auto new_frames = FrameSet::bottom();
     for (const auto& frame : frames) {
-      if (frame.is_leaf()) {
+      if (frame.is_leaf() ||
+          (filter && !filter(frame.callee(), frame.call_position()))) {
         new_frames.add(frame);
       } else {
         auto new_frame = Frame(
@@ -233,6 +247,16 @@ void Taint::filter_invalid_frames(
   });
 }
 
+bool Taint::has_invalid_frames(
+    const std::function<bool(const Method*, const AccessPath&, const Kind*)>&
+        is_valid) const {
+  return std::any_of(begin(), end(), [&](const FrameSet& frames) {
+    return std::any_of(frames.begin(), frames.end(), [&](const Frame& frame) {
+      return !is_valid(frame.callee(), frame.callee_port(), frame.kind());
+    });
+  });
+}
+
 bool Taint::contains_kind(const Kind* kind) const {
   return std::any_of(begin(), end(), [&](const FrameSet& frames) {
     return frames.kind() == kind;
@@ -257,12 +281,4 @@ FeatureMayAlwaysSet Taint::features_joined() const {
   return features;
 }
 
-void Taint::map(const std::function<void(FrameSet&)>& f) {
-  set_.map(f);
-}
-
-void Taint::filter(const std::function<bool(const FrameSet&)>& predicate) {
-  set_.filter(predicate);
-}
-
 } // namespace marianatrench
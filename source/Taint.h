@@ -14,6 +14,7 @@
 
 #include <AbstractDomain.h>
 
+#include <mariana-trench/CallSiteContext.h>
 #include <mariana-trench/Frame.h>
 #include <mariana-trench/FrameSet.h>
 #include <mariana-trench/GroupHashedSetAbstractDomain.h>
@@ -156,9 +157,18 @@ class Taint final : public sparta::AbstractDomain<Taint> {
       const FeatureMayAlwaysSet& extra_features,
       Context& context,
       const std::vector<const DexType * MT_NULLABLE>& source_register_types,
-      const std::vector<std::optional<std::string>>& source_constant_arguments)
+      const std::vector<const DexString * MT_NULLABLE>&
+          source_constant_arguments)
       const;
 
+  /**
+   * Propagate the taint from the callee to the caller, sharing the per-call
+   * site information between all kinds and ports of the callee.
+   */
+  Taint propagate(
+      const AccessPath& callee_port,
+      const CallSiteContext& call_site) const;
+
   /* Return the set of leaf frames with the given position. */
   Taint attach_position(const Position* position) const;
 
@@ -192,13 +202,17 @@ class Taint final : public sparta::AbstractDomain<Taint> {
    * Update call and local positions of all non-leaf frames.
    * `new_call_position` is given callee, callee_port and (existing) position.
    * `new_local_positions` is given existing local positions.
+   * If `filter` is set, only frames for which it returns true, given callee
+   * and (existing) position, are updated.
    */
   void update_non_leaf_positions(
       const std::function<
           const Position*(const Method*, const AccessPath&, const Position*)>&
           new_call_position,
       const std::function<LocalPositionSet(const LocalPositionSet&)>&
-          new_local_positions);
+          new_local_positions,
+      const std::function<bool(const Method*, const Position*)>& filter =
+          nullptr);
 
   /**
    * Drops frames that are considered invalid.
@@ -209,6 +223,15 @@ class Taint final : public sparta::AbstractDomain<Taint> {
           bool(const Method* MT_NULLABLE, const AccessPath&, const Kind*)>&
           is_valid);
 
+  /**
+   * Returns true if any frame is considered invalid, i.e if
+   * `filter_invalid_frames` would drop a frame.
+   */
+  bool has_invalid_frames(
+      const std::function<
+          bool(const Method* MT_NULLABLE, const AccessPath&, const Kind*)>&
+          is_valid) const;
+
   /**
    * Returns true if any frame contains the given kind.
    */
@@ -226,9 +249,15 @@ class Taint final : public sparta::AbstractDomain<Taint> {
   FeatureMayAlwaysSet features_joined() const;
 
  private:
-  void map(const std::function<void(FrameSet&)>& f);
+  template <typename Function> // void(FrameSet&)
+  void map(Function&& f) {
+    set_.map(std::forward<Function>(f));
+  }
 
-  void filter(const std::function<bool(const FrameSet&)>& predicate);
+  template <typename Predicate> // bool(const FrameSet&)
+  void filter(Predicate&& predicate) {
+    set_.filter(std::forward<Predicate>(predicate));
+  }
 
  private:
   Set set_;
@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+#include <SpartaWorkQueue.h>
+
+#include <mariana-trench/Assert.h>
+#include <mariana-trench/Log.h>
+#include <mariana-trench/TaskGraph.h>
+#include <mariana-trench/Timer.h>
+
+namespace marianatrench {
+
+TaskGraph::TaskId TaskGraph::add(
+    std::string name,
+    std::function<void()> function,
+    const std::vector<TaskId>& dependencies) {
+  TaskId id = tasks_.size();
+  for (auto dependency : dependencies) {
+    mt_assert(dependency < id);
+    tasks_[dependency].dependents.push_back(id);
+  }
+  tasks_.push_back(Task{
+      std::move(name),
+      std::move(function),
+      /* dependencies */ dependencies.size(),
+      /* dependents */ {}});
+  return id;
+}
+
+void TaskGraph::run() {
+  if (tasks_.empty()) {
+    return;
+  }
+
+  auto remaining_dependencies =
+      std::make_unique<std::atomic<std::size_t>[]>(tasks_.size());
+  for (TaskId id = 0; id < tasks_.size(); id++) {
+    remaining_dependencies[id] = tasks_[id].dependencies;
+  }
+
+  // Tasks wait on their dependencies without holding a thread, so there is
+  // no point in having more threads than tasks.
+  auto threads = std::min<std::size_t>(
+      tasks_.size(), sparta::parallel::default_num_threads());
+  auto queue = sparta::work_queue<TaskId>(
+      [&](sparta::SpartaWorkerState<TaskId>* worker_state, TaskId id) {
+        const auto& task = tasks_[id];
+        Timer timer;
+        LOG(3, "Starting task `{}`.", task.name);
+        task.function();
+        LOG(3,
+            "Finished task `{}` in {:.2f}s.",
+            task.name,
+            timer.duration_in_seconds());
+
+        for (auto dependent : task.dependents) {
+          if (remaining_dependencies[dependent].fetch_sub(1) == 1) {
+            worker_state->push_task(dependent);
+          }
+        }
+      },
+      threads,
+      /* push_tasks_while_running */ true);
+  for (TaskId id = 0; id < tasks_.size(); id++) {
+    if (tasks_[id].dependencies == 0) {
+      queue.add_item(id);
+    }
+  }
+  queue.run_all();
+}
+
+} // namespace marianatrench
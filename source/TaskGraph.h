@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace marianatrench {
+
+/**
+ * A directed acyclic graph of coarse-grained tasks, where each task runs after
+ * all its dependencies. Tasks whose dependencies are done run concurrently.
+ *
+ * Dependencies must be added before their dependents, hence the graph is
+ * always acyclic. This is meant for the phases of the analysis setup, which
+ * are few and long-running, and possibly parallel themselves.
+ */
+class TaskGraph final {
+ public:
+  using TaskId = std::size_t;
+
+ public:
+  TaskGraph() = default;
+  TaskGraph(const TaskGraph&) = delete;
+  TaskGraph(TaskGraph&&) = delete;
+  TaskGraph& operator=(const TaskGraph&) = delete;
+  TaskGraph& operator=(TaskGraph&&) = delete;
+  ~TaskGraph() = default;
+
+  /* Add a task that runs after the given tasks. */
+  TaskId add(
+      std::string name,
+      std::function<void()> function,
+      const std::vector<TaskId>& dependencies = {});
+
+  /**
+   * Run all tasks and wait for their completion.
+   *
+   * If a task throws, its dependents are not run and the exceptions are
+   * rethrown as an `aggregate_exception` once all other tasks are done.
+   */
+  void run();
+
+  std::size_t size() const {
+    return tasks_.size();
+  }
+
+ private:
+  struct Task {
+    std::string name;
+    std::function<void()> function;
+    std::size_t dependencies;
+    std::vector<TaskId> dependents;
+  };
+
+  std::vector<Task> tasks_;
+};
+
+} // namespace marianatrench
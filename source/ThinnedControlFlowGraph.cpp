@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <algorithm>
+
+#include <IRInstruction.h>
+#include <IROpcode.h>
+
+#include <mariana-trench/ThinnedControlFlowGraph.h>
+
+namespace marianatrench {
+
+namespace {
+
+/**
+ * Whether the transfer functions of the block cannot remove taint that is
+ * read by a handler whose live registers are `live_registers`.
+ */
+bool preserves_taint(
+    const cfg::Block* block,
+    const LivenessDomain& live_registers) {
+  for (const auto& entry : *block) {
+    if (entry.type != MFLOW_OPCODE) {
+      continue;
+    }
+    const auto* instruction = entry.insn;
+    // Writes to a single field memory location are strong updates.
+    if (opcode::is_an_iput(instruction->opcode())) {
+      return false;
+    }
+    if (!instruction->has_dest()) {
+      continue;
+    }
+    auto dest = instruction->dest();
+    if (live_registers.contains(dest) ||
+        (instruction->dest_is_wide() && live_registers.contains(dest + 1))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+const cfg::Edge* MT_NULLABLE find_throw_edge(
+    const cfg::Block* block,
+    const cfg::Block* handler,
+    const DexType* MT_NULLABLE catch_type) {
+  for (const auto* edge : block->succs()) {
+    if (edge->type() == cfg::EDGE_THROW && edge->target() == handler &&
+        edge->throw_info()->catch_type == catch_type) {
+      return edge;
+    }
+  }
+  return nullptr;
+}
+
+} // namespace
+
+ThinnedControlFlowGraph::ThinnedControlFlowGraph(
+    const cfg::ControlFlowGraph& cfg,
+    const LivenessFixpointIterator* MT_NULLABLE liveness)
+    : cfg_(cfg) {
+  if (liveness == nullptr) {
+    return;
+  }
+
+  std::vector<cfg::Edge*> removed_edges;
+  for (auto* block : cfg.blocks()) {
+    const cfg::Edge* goto_edge = nullptr;
+    bool other_edges = false;
+    for (const auto* edge : block->succs()) {
+      if (edge->type() == cfg::EDGE_GOTO && goto_edge == nullptr) {
+        goto_edge = edge;
+      } else if (edge->type() != cfg::EDGE_THROW) {
+        other_edges = true;
+      }
+    }
+    if (goto_edge == nullptr || other_edges) {
+      continue;
+    }
+    const auto* next = goto_edge->target();
+    if (next == block || next->preds().size() != 1) {
+      continue;
+    }
+
+    for (auto* edge : block->succs()) {
+      if (edge->type() != cfg::EDGE_THROW) {
+        continue;
+      }
+      auto* handler = edge->target();
+      if (find_throw_edge(next, handler, edge->throw_info()->catch_type) ==
+              nullptr ||
+          !preserves_taint(next, liveness->get_live_in_vars_at(handler))) {
+        continue;
+      }
+      removed_edges.push_back(edge);
+    }
+  }
+
+  for (auto* edge : removed_edges) {
+    auto& successors =
+        successors_.emplace(edge->src(), edge->src()->succs()).first->second;
+    successors.erase(
+        std::remove(successors.begin(), successors.end(), edge),
+        successors.end());
+    auto& predecessors =
+        predecessors_.emplace(edge->target(), edge->target()->preds())
+            .first->second;
+    predecessors.erase(
+        std::remove(predecessors.begin(), predecessors.end(), edge),
+        predecessors.end());
+  }
+  removed_edges_ = removed_edges.size();
+}
+
+const std::vector<cfg::Edge*>& ThinnedControlFlowGraph::predecessors(
+    cfg::Block* block) const {
+  auto found = predecessors_.find(block);
+  return found != predecessors_.end() ? found->second : block->preds();
+}
+
+const std::vector<cfg::Edge*>& ThinnedControlFlowGraph::successors(
+    cfg::Block* block) const {
+  auto found = successors_.find(block);
+  return found != successors_.end() ? found->second : block->succs();
+}
+
+} // namespace marianatrench
@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+
+#include <ControlFlow.h>
+#include <Liveness.h>
+
+#include <mariana-trench/Compiler.h>
+
+namespace marianatrench {
+
+/**
+ * A view of a control flow graph without some of its exception edges, used
+ * by `--thin-exception-edges`. The control flow graph itself is not modified.
+ *
+ * In a try block, each throwing instruction ends a block with a throw edge to
+ * the handler, hence the handler joins the exit states of most blocks of the
+ * try block. The throw edge from block `A` to handler `H` is removed when:
+ * - the only other successor of `A` is a goto to block `B`;
+ * - `A` is the only predecessor of `B`;
+ * - `B` throws to `H` with the same catch type;
+ * - `B` does not write fields, which could remove taint, and only defines
+ *   registers that are dead at the entry of `H`.
+ * The entry state of `B` is then the exit state of `A`, and the transfer
+ * functions of `B` only add taint to the parts of the state that `H` reads,
+ * hence the states flowing to `H` from `B` cover the ones from `A`. Positions
+ * and features may differ, which is the precision change of this option.
+ */
+class ThinnedControlFlowGraph final {
+ public:
+  /* Keep all edges when `liveness` is `nullptr`. */
+  ThinnedControlFlowGraph(
+      const cfg::ControlFlowGraph& cfg,
+      const LivenessFixpointIterator* MT_NULLABLE liveness);
+
+  ThinnedControlFlowGraph(const ThinnedControlFlowGraph&) = delete;
+  ThinnedControlFlowGraph(ThinnedControlFlowGraph&&) = delete;
+  ThinnedControlFlowGraph& operator=(const ThinnedControlFlowGraph&) = delete;
+  ThinnedControlFlowGraph& operator=(ThinnedControlFlowGraph&&) = delete;
+  ~ThinnedControlFlowGraph() = default;
+
+  const cfg::ControlFlowGraph& cfg() const {
+    return cfg_;
+  }
+
+  const std::vector<cfg::Edge*>& predecessors(cfg::Block* block) const;
+  const std::vector<cfg::Edge*>& successors(cfg::Block* block) const;
+
+  /* Number of exception edges removed. */
+  std::size_t removed_edges() const {
+    return removed_edges_;
+  }
+
+ private:
+  using BlockEdges =
+      std::unordered_map<const cfg::Block*, std::vector<cfg::Edge*>>;
+
+  const cfg::ControlFlowGraph& cfg_;
+  // Edges of the blocks that lost an edge.
+  BlockEdges predecessors_;
+  BlockEdges successors_;
+  std::size_t removed_edges_ = 0;
+};
+
+/* Graph interface of `ThinnedControlFlowGraph`, as `cfg::GraphInterface`. */
+class ThinnedGraphInterface final {
+ public:
+  using Graph = ThinnedControlFlowGraph;
+  using NodeId = cfg::Block*;
+  using EdgeId = cfg::Edge*;
+
+  static NodeId entry(const Graph& graph) {
+    return const_cast<NodeId>(graph.cfg().entry_block());
+  }
+
+  static NodeId exit(const Graph& graph) {
+    return const_cast<NodeId>(graph.cfg().exit_block());
+  }
+
+  static const std::vector<EdgeId>& predecessors(
+      const Graph& graph,
+      const NodeId& block) {
+    return graph.predecessors(block);
+  }
+
+  static const std::vector<EdgeId>& successors(
+      const Graph& graph,
+      const NodeId& block) {
+    return graph.successors(block);
+  }
+
+  static NodeId source(const Graph& /* graph */, const EdgeId& edge) {
+    return edge->src();
+  }
+
+  static NodeId target(const Graph& /* graph */, const EdgeId& edge) {
+    return edge->target();
+  }
+};
+
+} // namespace marianatrench
@@ -0,0 +1,147 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include <mariana-trench/OperatingSystem.h>
+#include <mariana-trench/Tracer.h>
+
+namespace marianatrench {
+
+namespace {
+
+struct TracerState {
+  std::atomic<bool> enabled{false};
+  std::chrono::steady_clock::time_point origin;
+  std::atomic<std::uint64_t> next_thread{0};
+  std::mutex mutex;
+  std::vector<Tracer::Span> spans;
+};
+
+TracerState& state() {
+  static TracerState state;
+  return state;
+}
+
+std::uint64_t current_thread() {
+  thread_local std::uint64_t thread = state().next_thread.fetch_add(1);
+  return thread;
+}
+
+// Number of open spans of the current thread.
+thread_local std::size_t open_spans = 0;
+
+} // namespace
+
+void Tracer::enable() {
+  auto& state = marianatrench::state();
+  std::lock_guard<std::mutex> lock(state.mutex);
+  if (!state.enabled.load()) {
+    state.origin = std::chrono::steady_clock::now();
+    state.enabled.store(true);
+  }
+}
+
+bool Tracer::enabled() {
+  return state().enabled.load(std::memory_order_relaxed);
+}
+
+void Tracer::record(Span span) {
+  auto& state = marianatrench::state();
+  std::lock_guard<std::mutex> lock(state.mutex);
+  state.spans.push_back(std::move(span));
+}
+
+std::uint64_t Tracer::now() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now() - state().origin)
+      .count();
+}
+
+Json::Value Tracer::to_json() {
+  auto& state = marianatrench::state();
+  std::lock_guard<std::mutex> lock(state.mutex);
+
+  auto events = Json::Value(Json::arrayValue);
+  for (const auto& span : state.spans) {
+    auto event = Json::Value(Json::objectValue);
+    event["name"] = span.name;
+    event["cat"] = "phase";
+    event["ph"] = "X";
+    event["pid"] = 0;
+    event["tid"] = Json::Value(static_cast<Json::UInt64>(span.thread));
+    event["ts"] = Json::Value(static_cast<Json::UInt64>(span.start));
+    event["dur"] = Json::Value(static_cast<Json::UInt64>(span.wall_duration));
+
+    auto arguments = Json::Value(Json::objectValue);
+    arguments["depth"] = Json::Value(static_cast<Json::UInt64>(span.depth));
+    arguments["thread_cpu_seconds"] = span.thread_cpu_seconds;
+    arguments["process_cpu_seconds"] = span.process_cpu_seconds;
+    if (span.wall_duration > 0) {
+      // Average number of busy cores. A low value with a long wall time
+      // indicates that the phase is waiting (e.g on I/O or on a lock).
+      arguments["cpu_utilization"] = span.process_cpu_seconds /
+          (static_cast<double>(span.wall_duration) / 1e6);
+    }
+    arguments["rss_delta_gb"] = span.resident_set_size_delta_in_gb;
+    event["args"] = arguments;
+    events.append(event);
+  }
+
+  auto value = Json::Value(Json::objectValue);
+  value["traceEvents"] = events;
+  value["displayTimeUnit"] = "ms";
+  return value;
+}
+
+TraceSpan::TraceSpan(std::string name)
+    : open_(Tracer::enabled()),
+      depth_(0),
+      start_(0),
+      thread_cpu_start_(0.0),
+      process_cpu_start_(0.0),
+      resident_set_size_start_(0.0) {
+  if (!open_) {
+    return;
+  }
+  name_ = std::move(name);
+  depth_ = open_spans++;
+  resident_set_size_start_ = resident_set_size_in_gb();
+  thread_cpu_start_ = thread_cpu_time_in_seconds();
+  process_cpu_start_ = process_cpu_time_in_seconds();
+  start_ = Tracer::now();
+}
+
+TraceSpan::~TraceSpan() {
+  end();
+}
+
+void TraceSpan::end() {
+  if (!open_) {
+    return;
+  }
+  open_ = false;
+  open_spans--;
+
+  auto end = Tracer::now();
+  Tracer::record(Tracer::Span{
+      std::move(name_),
+      current_thread(),
+      depth_,
+      start_,
+      end - start_,
+      thread_cpu_time_in_seconds() - thread_cpu_start_,
+      process_cpu_time_in_seconds() - process_cpu_start_,
+      resident_set_size_in_gb() - resident_set_size_start_,
+  });
+}
+
+} // namespace marianatrench
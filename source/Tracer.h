@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include <json/json.h>
+
+namespace marianatrench {
+
+/**
+ * Record nested spans of the phases of the analysis, when `--trace-phases` is
+ * used, and export them in the Chrome trace event format (also read by
+ * Perfetto).
+ *
+ * Like the `Logger`, the tracer is global, hence spans can be opened anywhere
+ * without access to the context. Spans are meant for phases and sub-phases,
+ * not for the analysis of each method (see `WorkerSampler` and `Profiler`).
+ */
+class Tracer final {
+ public:
+  struct Span {
+    std::string name;
+    std::uint64_t thread;
+    std::size_t depth;
+    // Microseconds since the tracer was enabled.
+    std::uint64_t start;
+    std::uint64_t wall_duration;
+    // CPU time of the thread that opened the span, and of the process.
+    double thread_cpu_seconds;
+    double process_cpu_seconds;
+    double resident_set_size_delta_in_gb;
+  };
+
+ public:
+  /* Start recording spans. */
+  static void enable();
+
+  static bool enabled();
+
+  /* Record a closed span. Thread-safe. */
+  static void record(Span span);
+
+  /* Return the microseconds elapsed since the tracer was enabled. */
+  static std::uint64_t now();
+
+  /* Return the spans recorded so far, in the Chrome trace event format. */
+  static Json::Value to_json();
+};
+
+/**
+ * A span that is open from its construction until `end` or its destruction.
+ *
+ * Spans opened by a thread while another span of the same thread is open are
+ * nested in it. This does nothing when the tracer is not enabled.
+ */
+class TraceSpan final {
+ public:
+  explicit TraceSpan(std::string name);
+  TraceSpan(const TraceSpan&) = delete;
+  TraceSpan(TraceSpan&&) = delete;
+  TraceSpan& operator=(const TraceSpan&) = delete;
+  TraceSpan& operator=(TraceSpan&&) = delete;
+  ~TraceSpan();
+
+  /* Close the span before the end of its scope. */
+  void end();
+
+ private:
+  bool open_;
+  std::string name_;
+  std::size_t depth_;
+  std::uint64_t start_;
+  double thread_cpu_start_;
+  double process_cpu_start_;
+  double resident_set_size_start_;
+};
+
+} // namespace marianatrench
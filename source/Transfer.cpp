@@ -5,7 +5,7 @@
  * LICENSE file in the root directory of this source tree.
  */
 
-#include <limits>
+#include <optional>
 
 #include <fmt/format.h>
 
@@ -15,6 +15,7 @@
 #include <mariana-trench/Features.h>
 #include <mariana-trench/Fields.h>
 #include <mariana-trench/FulfilledPartialKindState.h>
+#include <mariana-trench/KindCosts.h>
 #include <mariana-trench/Log.h>
 #include <mariana-trench/Methods.h>
 #include <mariana-trench/MultiSourceMultiSinkRule.h>
@@ -28,14 +29,37 @@ namespace marianatrench {
 
 namespace {
 
-constexpr Register k_result_register = std::numeric_limits<Register>::max();
-
 inline void log_instruction(
     const MethodContext* context,
     const IRInstruction* instruction) {
   LOG_OR_DUMP(context, 4, "Instruction: \033[33m{}\033[0m", show(instruction));
 }
 
+std::size_t taint_size(const TaintTree& taint_tree) {
+  std::size_t size = 0;
+  taint_tree.visit(
+      [&size](const Path& /* path */, const Taint& taint) {
+        size += taint.size();
+      });
+  return size;
+}
+
+/* Profile a transfer function, with the size of the taint of its sources. */
+ProfileScope profile_transfer(
+    const MethodContext* context,
+    std::string_view name,
+    const IRInstruction* instruction,
+    const AnalysisEnvironment* environment) {
+  auto* profile = context->profile();
+  std::size_t size = 0;
+  if (profile != nullptr) {
+    for (auto register_id : instruction->srcs()) {
+      size += taint_size(*environment->read_borrowed(register_id));
+    }
+  }
+  return ProfileScope(profile, name, size);
+}
+
 } // namespace
 
 bool Transfer::analyze_default(
@@ -43,6 +67,8 @@ bool Transfer::analyze_default(
     const IRInstruction* instruction,
     AnalysisEnvironment* environment) {
   log_instruction(context, instruction);
+  auto profile_scope = profile_transfer(
+      context, "analyze_default", instruction, environment);
 
   // Assign the result register to a new memory location.
   auto* memory_location = context->memory_factory.make_location(instruction);
@@ -73,6 +99,8 @@ bool Transfer::analyze_check_cast(
     const IRInstruction* instruction,
     AnalysisEnvironment* environment) {
   log_instruction(context, instruction);
+  auto profile_scope = profile_transfer(
+      context, "analyze_check_cast", instruction, environment);
   mt_assert(instruction->srcs().size() == 1);
 
   // Add via-cast feature
@@ -102,11 +130,12 @@ bool Transfer::analyze_iget(
     const IRInstruction* instruction,
     AnalysisEnvironment* environment) {
   log_instruction(context, instruction);
+  auto profile_scope = profile_transfer(
+      context, "analyze_iget", instruction, environment);
   mt_assert(instruction->srcs().size() == 1);
   mt_assert(instruction->has_field());
 
-  const auto* field =
-      context->call_graph.resolved_field_access(context->method(), instruction);
+  const auto* field = context->instructions.get(instruction).field;
   if (!field) {
     WARNING_OR_DUMP(
         context,
@@ -114,7 +143,8 @@ bool Transfer::analyze_iget(
         "Unable to resolve access of instance field {}",
         show(instruction->get_field()));
   }
-  auto field_model = field ? context->registry.get(field) : FieldModel();
+  const auto* field_model =
+      field ? context->registry.field_model(field) : nullptr;
 
   // Create a memory location that represents the field.
   auto memory_locations = environment->memory_locations(
@@ -122,15 +152,18 @@ bool Transfer::analyze_iget(
       /* field */ instruction->get_field()->get_name());
   LOG_OR_DUMP(context, 4, "Setting result register to {}", memory_locations);
   environment->assign(k_result_register, memory_locations);
-  if (!field_model.empty()) {
+  if (field_model != nullptr && !field_model->empty()) {
     LOG_OR_DUMP(
         context,
         4,
         "Tainting register {} with {}",
         k_result_register,
-        field_model.sources());
+        field_model->sources());
     environment->write(
-        k_result_register, Path({}), field_model.sources(), UpdateKind::Strong);
+        k_result_register,
+        Path({}),
+        field_model->sources(),
+        UpdateKind::Strong);
   }
 
   return false;
@@ -141,11 +174,12 @@ bool Transfer::analyze_sget(
     const IRInstruction* instruction,
     AnalysisEnvironment* environment) {
   log_instruction(context, instruction);
+  auto profile_scope = profile_transfer(
+      context, "analyze_sget", instruction, environment);
   mt_assert(instruction->srcs().size() == 0);
   mt_assert(instruction->has_field());
 
-  const auto* field =
-      context->call_graph.resolved_field_access(context->method(), instruction);
+  const auto* field = context->instructions.get(instruction).field;
   if (!field) {
     WARNING_OR_DUMP(
         context,
@@ -153,20 +187,21 @@ bool Transfer::analyze_sget(
         "Unable to resolve access of static field {}",
         show(instruction->get_field()));
   }
-  auto field_model = field ? context->registry.get(field) : FieldModel();
+  const auto* field_model =
+      field ? context->registry.field_model(field) : nullptr;
   auto memory_location = context->memory_factory.make_location(instruction);
   LOG_OR_DUMP(context, 4, "Setting result register to {}", *memory_location);
   environment->assign(k_result_register, memory_location);
-  if (!field_model.empty()) {
+  if (field_model != nullptr && !field_model->empty()) {
     LOG_OR_DUMP(
         context,
         4,
         "Tainting register {} with {}",
         k_result_register,
-        field_model.sources());
+        field_model->sources());
     environment->write(
         k_result_register,
-        TaintTree(field_model.sources()),
+        TaintTree(field_model->sources()),
         UpdateKind::Strong);
   }
 
@@ -182,26 +217,15 @@ struct Callee {
   Model model;
 };
 
-const std::vector<const DexType * MT_NULLABLE> get_source_register_types(
-    const MethodContext* context,
-    const IRInstruction* instruction) {
-  std::vector<const DexType* MT_NULLABLE> register_types = {};
-  for (const auto& source_register : instruction->srcs_vec()) {
-    register_types.push_back(context->types.register_type(
-        context->method(), instruction, source_register));
-  }
-  return register_types;
-}
-
-const std::vector<std::optional<std::string>> get_source_constant_arguments(
+std::vector<const DexString * MT_NULLABLE> get_source_constant_arguments(
     AnalysisEnvironment* environment,
     const IRInstruction* instruction) {
-  std::vector<std::optional<std::string>> constant_arguments = {};
+  std::vector<const DexString * MT_NULLABLE> constant_arguments = {};
 
-  for (const auto& register_id : instruction->srcs_vec()) {
+  for (const auto& register_id : instruction->srcs()) {
     auto memory_locations = environment->memory_locations(register_id);
     for (auto* memory_location : memory_locations.elements()) {
-      std::optional<std::string> value;
+      const DexString* MT_NULLABLE value = nullptr;
       if (const auto* instruction_memory_location =
               memory_location->dyn_cast<InstructionMemoryLocation>();
           instruction_memory_location != nullptr) {
@@ -220,7 +244,9 @@ Callee get_callee(
     const IRInstruction* instruction) {
   mt_assert(opcode::is_an_invoke(instruction->opcode()));
 
-  auto call_target = context->call_graph.callee(context->method(), instruction);
+  const auto& decoded = context->instructions.get(instruction);
+  mt_assert(decoded.call_target && decoded.source_register_types != nullptr);
+  const auto& call_target = *decoded.call_target;
   if (!call_target.resolved()) {
     WARNING_OR_DUMP(
         context,
@@ -241,7 +267,7 @@ Callee get_callee(
   auto model = context->model_at_callsite(
       call_target,
       position,
-      get_source_register_types(context, instruction),
+      *decoded.source_register_types,
       get_source_constant_arguments(environment, instruction));
   LOG_OR_DUMP(context, 4, "Callee model: {}", model);
 
@@ -287,6 +313,7 @@ void apply_generations(
     const IRInstruction* instruction,
     const Callee& callee,
     TaintTree& result_taint) {
+  ProfileScope profile_scope(context->profile(), "apply_generations");
   const auto& instruction_sources = instruction->srcs_vec();
 
   LOG_OR_DUMP(
@@ -327,6 +354,7 @@ void apply_propagations(
     const IRInstruction* instruction,
     const Callee& callee,
     TaintTree& result_taint) {
+  ProfileScope profile_scope(context->profile(), "apply_propagations");
   const auto& instruction_sources = instruction->srcs_vec();
 
   LOG_OR_DUMP(
@@ -335,10 +363,52 @@ void apply_propagations(
       "Processing propagations for call to `{}`",
       show(callee.method_reference));
 
+  // Propagations are grouped by output, and outputs often share the same
+  // inputs. Each input is read and collapsed once, and the taint of each
+  // output is written once.
+  std::vector<std::pair<const AccessPath*, TaintTree>> input_taints;
+  auto read_input = [&](const AccessPath& input,
+                        Register input_register_id) -> const TaintTree& {
+    for (const auto& [cached_input, taint_tree] : input_taints) {
+      if (*cached_input == input) {
+        return taint_tree;
+      }
+    }
+
+    auto taint_tree =
+        previous_environment->read(input_register_id, input.path());
+    // Collapsing the tree here is required for correctness and performance.
+    // Propagations can be collapsed, which results in taking the common
+    // prefix of the input paths. Because of this, if we don't collapse here,
+    // we might build invalid trees. See the end-to-end test
+    // `propagation_collapse` for an example.
+    // However, collapsing leads to FP with the builder pattern.
+    // eg:
+    // class A {
+    //   private String s1;
+    //
+    //   public A setS1(String s) {
+    //     this.s1 = s;
+    //     return this;
+    //   }
+    // }
+    // In this case, collapsing propagations results in entire `this` being
+    // tainted. For chained calls, it can lead to FP.
+    // `no-collapse-on-propagation` mode is used to prevent such cases.
+    // See the end-to-end test `no_collapse_on_propagation` for example.
+    if (!callee.model.no_collapse_on_propagation()) {
+      LOG_OR_DUMP(context, 4, "Collapsing taint tree {}", taint_tree);
+      taint_tree.collapse_inplace();
+    }
+    input_taints.emplace_back(&input, std::move(taint_tree));
+    return input_taints.back().second;
+  };
+
   for (const auto& [output, propagations] :
        callee.model.propagations().elements()) {
     auto output_features = FeatureMayAlwaysSet::make_always(
         callee.model.add_features_to_arguments(output.root()));
+    auto output_taint = TaintTree::bottom();
 
     for (const auto& propagation : propagations) {
       LOG_OR_DUMP(
@@ -364,33 +434,9 @@ void apply_propagations(
       }
       auto input_register_id = instruction_sources.at(input_parameter_position);
 
-      auto taint_tree = previous_environment->read(
-          input_register_id, propagation.input().path());
-      // Collapsing the tree here is required for correctness and performance.
-      // Propagations can be collapsed, which results in taking the common
-      // prefix of the input paths. Because of this, if we don't collapse here,
-      // we might build invalid trees. See the end-to-end test
-      // `propagation_collapse` for an example.
-      // However, collapsing leads to FP with the builder pattern.
-      // eg:
-      // class A {
-      //   private String s1;
-      //
-      //   public A setS1(String s) {
-      //     this.s1 = s;
-      //     return this;
-      //   }
-      // }
-      // In this case, collapsing propagations results in entire `this` being
-      // tainted. For chained calls, it can lead to FP.
-      // `no-collapse-on-propagation` mode is used to prevent such cases.
-      // See the end-to-end test `no_collapse_on_propagation` for example.
-      if (!callee.model.no_collapse_on_propagation()) {
-        LOG_OR_DUMP(context, 4, "Collapsing taint tree {}", taint_tree);
-        taint_tree.collapse_inplace();
-      }
-
-      if (taint_tree.is_bottom()) {
+      const auto& input_taint =
+          read_input(propagation.input(), input_register_id);
+      if (input_taint.is_bottom()) {
         continue;
       }
 
@@ -401,43 +447,49 @@ void apply_propagations(
       auto position =
           context->positions.get(callee.position, input, instruction);
 
+      auto taint_tree = input_taint;
       taint_tree.map([&features, position](Taint& taints) {
         taints.add_inferred_features_and_local_position(features, position);
       });
+      output_taint.join_with(taint_tree);
+    }
 
-      switch (output.root().kind()) {
-        case Root::Kind::Return: {
-          LOG_OR_DUMP(
-              context,
-              4,
-              "Tainting invoke result path {} with {}",
-              output.path(),
-              taint_tree);
-          result_taint.write(
-              output.path(), std::move(taint_tree), UpdateKind::Weak);
-          break;
-        }
-        case Root::Kind::Argument: {
-          auto output_parameter_position = output.root().parameter_position();
-          auto output_register_id =
-              instruction_sources.at(output_parameter_position);
-          LOG_OR_DUMP(
-              context,
-              4,
-              "Tainting register {} path {} with {}",
-              output_register_id,
-              output.path(),
-              taint_tree);
-          new_environment->write(
-              output_register_id,
-              output.path(),
-              std::move(taint_tree),
-              UpdateKind::Weak);
-          break;
-        }
-        default:
-          mt_unreachable();
+    if (output_taint.is_bottom()) {
+      continue;
+    }
+
+    switch (output.root().kind()) {
+      case Root::Kind::Return: {
+        LOG_OR_DUMP(
+            context,
+            4,
+            "Tainting invoke result path {} with {}",
+            output.path(),
+            output_taint);
+        result_taint.write(
+            output.path(), std::move(output_taint), UpdateKind::Weak);
+        break;
+      }
+      case Root::Kind::Argument: {
+        auto output_parameter_position = output.root().parameter_position();
+        auto output_register_id =
+            instruction_sources.at(output_parameter_position);
+        LOG_OR_DUMP(
+            context,
+            4,
+            "Tainting register {} path {} with {}",
+            output_register_id,
+            output.path(),
+            output_taint);
+        new_environment->write(
+            output_register_id,
+            output.path(),
+            std::move(output_taint),
+            UpdateKind::Weak);
+        break;
       }
+      default:
+        mt_unreachable();
     }
   }
 
@@ -559,6 +611,37 @@ FeatureMayAlwaysSet get_fulfilled_sink_features(
   return fulfilled_partial_sinks.get_features(counterpart, rule);
 }
 
+// Replace partial sinks by the triggered counterparts of fulfilled partial
+// sinks. Partial sinks without a fulfilled counterpart are dropped.
+Taint transform_partial_sinks(
+    MethodContext* context,
+    const Taint& sinks,
+    const FulfilledPartialKindState& fulfilled_partial_sinks) {
+  if (fulfilled_partial_sinks.empty()) {
+    // Nothing can be triggered, only drop partial sinks.
+    auto new_sinks = sinks;
+    new_sinks.filter([](const FrameSet& frames) {
+      return frames.kind()->as<PartialKind>() == nullptr;
+    });
+    return new_sinks;
+  }
+
+  return sinks.transform_kind_with_features(
+      [context, &fulfilled_partial_sinks](
+          const Kind* sink_kind) -> std::vector<const Kind*> {
+        const auto* partial_sink = sink_kind->as<PartialKind>();
+        if (!partial_sink) {
+          // No transformation. Keep sink as it is.
+          return {sink_kind};
+        }
+        return fulfilled_partial_sinks.make_triggered_counterparts(
+            context, /* unfulfilled_kind */ partial_sink);
+      },
+      [&fulfilled_partial_sinks](const Kind* new_kind) {
+        return get_fulfilled_sink_features(fulfilled_partial_sinks, new_kind);
+      });
+}
+
 void create_sinks(
     MethodContext* context,
     const Taint& sources,
@@ -569,6 +652,8 @@ void create_sinks(
     return;
   }
 
+  // The transformed sinks do not depend on the artificial source.
+  std::optional<Taint> transformed_sinks;
   for (const auto& source : sources) {
     if (!source.is_artificial_sources()) {
       continue;
@@ -579,21 +664,11 @@ void create_sinks(
           artificial_source.callee_port().root()));
       features.add(artificial_source.features());
 
-      auto new_sinks = sinks.transform_kind_with_features(
-          [context, &fulfilled_partial_sinks](
-              const Kind* sink_kind) -> std::vector<const Kind*> {
-            const auto* partial_sink = sink_kind->as<PartialKind>();
-            if (!partial_sink) {
-              // No transformation. Keep sink as it is.
-              return {sink_kind};
-            }
-            return fulfilled_partial_sinks.make_triggered_counterparts(
-                context, /* unfulfilled_kind */ partial_sink);
-          },
-          [&fulfilled_partial_sinks](const Kind* new_kind) {
-            return get_fulfilled_sink_features(
-                fulfilled_partial_sinks, new_kind);
-          });
+      if (!transformed_sinks) {
+        transformed_sinks =
+            transform_partial_sinks(context, sinks, fulfilled_partial_sinks);
+      }
+      auto new_sinks = *transformed_sinks;
       new_sinks.add_inferred_features(features);
       new_sinks.set_local_positions(source.local_positions());
 
@@ -632,40 +707,78 @@ void check_flows(
     return;
   }
 
-  auto sources_by_kind = sources.partition_by_kind();
-  auto sinks_by_kind = sinks.partition_by_kind();
-  for (const auto& [source_kind, source_taint] : sources_by_kind) {
-    if (source_kind == Kinds::artificial_source()) {
+  // Frames are grouped by kind. Sink kinds that no rule covers are dropped
+  // once, then rule lookups are a bit test for each remaining pair of kinds.
+  // The per-kind taints are only built for pairs matching a rule, and at most
+  // once per kind.
+  struct SinkKind {
+    const FrameSet* frames;
+    const PartialKind* MT_NULLABLE partial_sink;
+    std::optional<Taint> taint;
+  };
+  std::vector<SinkKind> sink_kinds;
+  for (const auto& sink_frames : sinks) {
+    const auto* sink_kind = sink_frames.kind();
+    const auto* MT_NULLABLE partial_sink = fulfilled_partial_sinks &&
+            context->rules.has_partial_rules_for_sink(sink_kind)
+        ? sink_kind->as<PartialKind>()
+        : nullptr;
+    if (partial_sink != nullptr ||
+        context->rules.has_rules_for_sink(sink_kind)) {
+      sink_kinds.push_back(SinkKind{&sink_frames, partial_sink, std::nullopt});
+    }
+  }
+
+  auto* kind_costs = context->kind_costs();
+  for (const auto& source_frames : sources) {
+    const auto* source_kind = source_frames.kind();
+    if (source_kind == Kinds::artificial_source() ||
+        !context->rules.has_rules_for_source(source_kind)) {
       continue;
     }
 
-    for (const auto& [sink_kind, sink_taint] : sinks_by_kind) {
-      // Check if this satisfies any rule. If so, create the issue.
+    KindCostScope source_cost_scope(
+        kind_costs, source_kind, KindCosts::Cost::CheckFlows);
+    std::optional<Taint> source_taint;
+    for (auto& sink : sink_kinds) {
+      const auto* sink_kind = sink.frames->kind();
       const auto& rules = context->rules.rules(source_kind, sink_kind);
+      const auto& partial_rules = sink.partial_sink
+          ? context->rules.partial_rules(source_kind, sink.partial_sink)
+          : context->rules.empty_partial_rules();
+      if (rules.empty() && partial_rules.empty()) {
+        continue;
+      }
+
+      KindCostScope sink_cost_scope(
+          kind_costs, sink_kind, KindCosts::Cost::CheckFlows);
+
+      if (!source_taint) {
+        source_taint = Taint{source_frames};
+      }
+      if (!sink.taint) {
+        sink.taint = Taint{*sink.frames};
+      }
+      const auto& sink_taint = *sink.taint;
+
+      // Check if this satisfies any rule. If so, create the issue.
       for (const auto* rule : rules) {
         create_issue(
-            context, source_taint, sink_taint, rule, position, extra_features);
+            context, *source_taint, sink_taint, rule, position, extra_features);
       }
 
       // Check if this satisfies any partial (multi-source/sink) rule.
-      if (fulfilled_partial_sinks) {
-        const auto* MT_NULLABLE partial_sink = sink_kind->as<PartialKind>();
-        if (partial_sink) {
-          const auto& partial_rules =
-              context->rules.partial_rules(source_kind, partial_sink);
-          for (const auto* partial_rule : partial_rules) {
-            check_multi_source_multi_sink_rules(
-                context,
-                source_kind,
-                source_taint,
-                sink_kind,
-                sink_taint,
-                *fulfilled_partial_sinks,
-                partial_rule,
-                position,
-                extra_features);
-          }
-        }
+      for (const auto* partial_rule : partial_rules) {
+        check_multi_source_multi_sink_rules(
+            context,
+            source_kind,
+            *source_taint,
+            sink_kind,
+            sink_taint,
+            *fulfilled_partial_sinks,
+            partial_rule,
+            position,
+            extra_features);
       }
     }
   }
@@ -681,6 +794,7 @@ void check_flows(
     const std::vector<Register>& instruction_sources,
     const Callee& callee,
     const FeatureMayAlwaysSet& extra_features = {}) {
+  ProfileScope profile_scope(context->profile(), "check_flows");
   LOG_OR_DUMP(
       context,
       4,
@@ -701,7 +815,8 @@ void check_flows(
     }
 
     auto register_id = instruction_sources.at(parameter_position);
-    Taint sources = environment->read(register_id, port.path()).collapse();
+    Taint sources =
+        environment->read_borrowed(register_id, port.path())->collapse();
     check_flows(
         context,
         sources,
@@ -762,7 +877,7 @@ void check_flows_to_array_allocation(
        parameter_position < instruction_sources.size();
        parameter_position++) {
     auto register_id = instruction_sources.at(parameter_position);
-    Taint sources = environment->read(register_id).collapse();
+    Taint sources = environment->read_borrowed(register_id)->collapse();
     // Fulfilled partial sinks ignored. No partial sinks for array allocation.
     check_flows(
         context,
@@ -787,7 +902,7 @@ void analyze_artificial_calls(
     const IRInstruction* instruction,
     AnalysisEnvironment* environment) {
   const auto& artificial_callees =
-      context->call_graph.artificial_callees(context->method(), instruction);
+      context->instructions.artificial_callees(instruction);
 
   for (const auto& artificial_callee : artificial_callees) {
     check_flows(
@@ -876,23 +991,49 @@ bool Transfer::analyze_invoke(
     const IRInstruction* instruction,
     AnalysisEnvironment* environment) {
   log_instruction(context, instruction);
+  auto profile_scope = profile_transfer(
+      context, "analyze_invoke", instruction, environment);
+  context->check_timeout();
 
   auto callee = get_callee(context, environment, instruction);
+  auto shape = callee.model.shape();
+  bool returns_void = callee.resolved_base_method &&
+      callee.resolved_base_method->returns_void();
+
+  // Fast path for getters: when the call is inlined, the propagations only
+  // taint the result, which is replaced by the inlined memory location.
+  if (shape == Model::Shape::InlineAs && !returns_void) {
+    if (auto* memory_location =
+            try_inline_invoke(context, environment, instruction, callee)) {
+      LOG_OR_DUMP(
+          context, 4, "Setting result register to {}", show(memory_location));
+      environment->assign(k_result_register, memory_location);
+      analyze_artificial_calls(context, instruction, environment);
+      return false;
+    }
+  }
 
-  const AnalysisEnvironment previous_environment = *environment;
+  // Only models with sinks or generations need the general path, others
+  // avoid checking flows and copying the environment when possible.
   TaintTree result_taint;
-  check_flows(context, &previous_environment, instruction, callee);
-  apply_propagations(
-      context,
-      &previous_environment,
-      environment,
-      instruction,
-      callee,
-      result_taint);
-  apply_generations(context, environment, instruction, callee, result_taint);
-
-  if (callee.resolved_base_method &&
-      callee.resolved_base_method->returns_void()) {
+  if (shape != Model::Shape::Empty) {
+    const AnalysisEnvironment previous_environment = *environment;
+    if (shape == Model::Shape::General) {
+      check_flows(context, &previous_environment, instruction, callee);
+    }
+    apply_propagations(
+        context,
+        &previous_environment,
+        environment,
+        instruction,
+        callee,
+        result_taint);
+  }
+  if (shape == Model::Shape::General) {
+    apply_generations(context, environment, instruction, callee, result_taint);
+  }
+
+  if (returns_void) {
     LOG_OR_DUMP(context, 4, "Resetting the result register");
     environment->assign(k_result_register, MemoryLocationsDomain::bottom());
   } else if (
@@ -949,6 +1090,8 @@ bool Transfer::analyze_iput(
     const IRInstruction* instruction,
     AnalysisEnvironment* environment) {
   log_instruction(context, instruction);
+  auto profile_scope = profile_transfer(
+      context, "analyze_iput", instruction, environment);
   mt_assert(instruction->srcs().size() == 2);
   mt_assert(instruction->has_field());
 
@@ -994,6 +1137,8 @@ bool Transfer::analyze_load_param(
     const IRInstruction* instruction,
     AnalysisEnvironment* environment) {
   log_instruction(context, instruction);
+  auto profile_scope = profile_transfer(
+      context, "analyze_load_param", instruction, environment);
 
   auto abstract_parameter = environment->last_parameter_loaded();
   if (!abstract_parameter.is_value()) {
@@ -1042,6 +1187,8 @@ bool Transfer::analyze_move(
     const IRInstruction* instruction,
     AnalysisEnvironment* environment) {
   log_instruction(context, instruction);
+  auto profile_scope = profile_transfer(
+      context, "analyze_move", instruction, environment);
   mt_assert(instruction->srcs().size() == 1);
 
   auto memory_locations =
@@ -1062,6 +1209,8 @@ bool Transfer::analyze_move_result(
     const IRInstruction* instruction,
     AnalysisEnvironment* environment) {
   log_instruction(context, instruction);
+  auto profile_scope = profile_transfer(
+      context, "analyze_move_result", instruction, environment);
 
   auto memory_locations = environment->memory_locations(k_result_register);
   LOG_OR_DUMP(
@@ -1083,6 +1232,8 @@ bool Transfer::analyze_aget(
     const IRInstruction* instruction,
     AnalysisEnvironment* environment) {
   log_instruction(context, instruction);
+  auto profile_scope = profile_transfer(
+      context, "analyze_aget", instruction, environment);
   mt_assert(instruction->srcs().size() == 2);
 
   // We use a single memory location for the array and its elements.
@@ -1099,6 +1250,8 @@ bool Transfer::analyze_aput(
     const IRInstruction* instruction,
     AnalysisEnvironment* environment) {
   log_instruction(context, instruction);
+  auto profile_scope = profile_transfer(
+      context, "analyze_aput", instruction, environment);
   mt_assert(instruction->srcs().size() == 3);
 
   auto taint = environment->read(
@@ -1131,6 +1284,8 @@ bool Transfer::analyze_new_array(
     MethodContext* context,
     const IRInstruction* instruction,
     AnalysisEnvironment* environment) {
+  auto profile_scope = profile_transfer(
+      context, "analyze_new_array", instruction, environment);
   check_flows_to_array_allocation(context, environment, instruction);
   return analyze_default(context, instruction, environment);
 }
@@ -1139,6 +1294,8 @@ bool Transfer::analyze_filled_new_array(
     MethodContext* context,
     const IRInstruction* instruction,
     AnalysisEnvironment* environment) {
+  auto profile_scope = profile_transfer(
+      context, "analyze_filled_new_array", instruction, environment);
   check_flows_to_array_allocation(context, environment, instruction);
   return analyze_default(context, instruction, environment);
 }
@@ -1150,10 +1307,12 @@ static bool analyze_numerical_operator(
     const IRInstruction* instruction,
     AnalysisEnvironment* environment) {
   log_instruction(context, instruction);
+  auto profile_scope = profile_transfer(
+      context, "analyze_numerical_operator", instruction, environment);
 
   TaintTree taint;
   for (auto register_id : instruction->srcs()) {
-    taint.join_with(environment->read(register_id));
+    taint.join_with(*environment->read_borrowed(register_id));
   }
 
   auto features = FeatureMayAlwaysSet::make_always(
@@ -1363,6 +1522,8 @@ bool Transfer::analyze_return(
     const IRInstruction* instruction,
     AnalysisEnvironment* environment) {
   log_instruction(context, instruction);
+  auto profile_scope = profile_transfer(
+      context, "analyze_return", instruction, environment);
 
   auto return_sinks = context->model.sinks().read(Root(Root::Kind::Return));
 
@@ -1376,10 +1537,13 @@ bool Transfer::analyze_return(
     auto memory_locations = environment->memory_locations(register_id);
     context->model.set_inline_as(infer_inline_as(context, memory_locations));
     infer_output_taint(
-        context, Root(Root::Kind::Return), environment->read(memory_locations));
+        context,
+        Root(Root::Kind::Return),
+        *environment->read_borrowed(memory_locations));
 
     for (const auto& [path, sinks] : return_sinks.elements()) {
-      Taint sources = environment->read(register_id, path).collapse();
+      Taint sources =
+          environment->read_borrowed(register_id, path)->collapse();
       // Fulfilled partial sinks are not expected to be produced here. Return
       // sinks are never partial.
       check_flows(
@@ -1396,7 +1560,8 @@ bool Transfer::analyze_return(
     infer_output_taint(
         context,
         Root(Root::Kind::Argument, 0),
-        environment->read(context->memory_factory.make_parameter(0)));
+        *environment->read_borrowed(
+            context->memory_factory.make_parameter(0)));
   }
 
   return false;
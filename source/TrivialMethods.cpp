@@ -0,0 +1,204 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <unordered_map>
+#include <utility>
+
+#include <ControlFlow.h>
+#include <IRCode.h>
+#include <SpartaWorkQueue.h>
+
+#include <mariana-trench/Frame.h>
+#include <mariana-trench/Propagation.h>
+#include <mariana-trench/Registry.h>
+#include <mariana-trench/TrivialMethods.h>
+
+namespace marianatrench {
+
+namespace {
+
+/**
+ * Value of a register: an argument access path, or any other value (e.g a
+ * constant), represented by `std::nullopt`.
+ */
+using Value = std::optional<AccessPath>;
+
+/* Mirror `MemoryLocation::make_field`, which breaks chains of fields. */
+Value read_field(const Value& value, const DexString* field) {
+  if (!value) {
+    return std::nullopt;
+  }
+  const auto& path = value->path();
+  std::size_t size = 0;
+  for (const auto* element : path) {
+    size++;
+    if (element == field) {
+      auto result = *value;
+      result.truncate(size);
+      return result;
+    }
+  }
+  auto result = *value;
+  result.append(field);
+  return result;
+}
+
+} // namespace
+
+TrivialMethods::TrivialMethods(
+    const Methods& methods,
+    const CallGraph& call_graph) {
+  std::vector<std::optional<Summary>> summaries(methods.size());
+  auto queue = sparta::work_queue<const Method*>([&](const Method* method) {
+    summaries[method->id()] = TrivialMethods::summary(method, call_graph);
+  });
+  for (const auto* method : methods) {
+    queue.add_item(method);
+  }
+  queue.run_all();
+
+  for (const auto* method : methods) {
+    if (auto& summary = summaries[method->id()]) {
+      summaries_.emplace(method, std::move(*summary));
+    }
+  }
+}
+
+std::optional<TrivialMethods::Summary> TrivialMethods::summary(
+    const Method* method,
+    const CallGraph& call_graph) {
+  const auto* code = method->get_code();
+  if (code == nullptr || !code->cfg_built() ||
+      call_graph.has_callees(method) ||
+      !call_graph.artificial_callees(method).empty()) {
+    return std::nullopt;
+  }
+  const auto& cfg = code->cfg();
+  if (cfg.blocks().size() != 1) {
+    return std::nullopt;
+  }
+
+  Summary summary{/* returns_value */ false, std::nullopt, {}};
+  std::unordered_map<Register, Value> registers;
+  // Result of the last field read, read by `move-result-pseudo`.
+  Value result;
+  auto read = [&](Register register_id) -> Value {
+    auto found = registers.find(register_id);
+    return found != registers.end() ? found->second : std::nullopt;
+  };
+  ParameterPosition parameter_position = 0;
+  bool returned = false;
+  for (const auto& entry : InstructionIterable(cfg.entry_block())) {
+    const auto* instruction = entry.insn;
+    if (returned) {
+      return std::nullopt;
+    }
+    switch (instruction->opcode()) {
+      case IOPCODE_LOAD_PARAM:
+      case IOPCODE_LOAD_PARAM_OBJECT:
+      case IOPCODE_LOAD_PARAM_WIDE:
+        registers[instruction->dest()] =
+            AccessPath(Root(Root::Kind::Argument, parameter_position++));
+        break;
+      case OPCODE_NOP:
+        break;
+      case OPCODE_MOVE:
+      case OPCODE_MOVE_WIDE:
+      case OPCODE_MOVE_OBJECT:
+        registers[instruction->dest()] = read(instruction->src(0));
+        break;
+      case OPCODE_CONST:
+      case OPCODE_CONST_WIDE:
+        registers[instruction->dest()] = std::nullopt;
+        break;
+      case OPCODE_IGET:
+      case OPCODE_IGET_WIDE:
+      case OPCODE_IGET_OBJECT:
+      case OPCODE_IGET_BOOLEAN:
+      case OPCODE_IGET_BYTE:
+      case OPCODE_IGET_CHAR:
+      case OPCODE_IGET_SHORT:
+        summary.field_reads.push_back(instruction);
+        result = read_field(
+            read(instruction->src(0)), instruction->get_field()->get_name());
+        break;
+      case IOPCODE_MOVE_RESULT_PSEUDO:
+      case IOPCODE_MOVE_RESULT_PSEUDO_OBJECT:
+      case IOPCODE_MOVE_RESULT_PSEUDO_WIDE:
+        registers[instruction->dest()] = result;
+        break;
+      case OPCODE_RETURN_VOID:
+        returned = true;
+        break;
+      case OPCODE_RETURN:
+      case OPCODE_RETURN_WIDE:
+      case OPCODE_RETURN_OBJECT:
+        summary.returns_value = true;
+        summary.returned_access_path = read(instruction->src(0));
+        returned = true;
+        break;
+      default:
+        return std::nullopt;
+    }
+  }
+  if (!returned) {
+    return std::nullopt;
+  }
+  return summary;
+}
+
+const TrivialMethods::Summary* MT_NULLABLE
+TrivialMethods::get(const Method* method) const {
+  auto found = summaries_.find(method);
+  return found != summaries_.end() ? &found->second : nullptr;
+}
+
+std::optional<Model> TrivialMethods::model(
+    Context& context,
+    const Registry& registry,
+    const Model& previous_model) const {
+  const auto* method = previous_model.method();
+  const auto* summary = method != nullptr ? get(method) : nullptr;
+  // Sources, sinks, sanitizers or features of other models would interact
+  // with the taint of the method.
+  if (summary == nullptr ||
+      previous_model != Model(method, context, previous_model.modes())) {
+    return std::nullopt;
+  }
+  for (const auto* instruction : summary->field_reads) {
+    const auto* field =
+        context.call_graph->resolved_field_access(method, instruction);
+    const auto* field_model =
+        field != nullptr ? registry.field_model(field) : nullptr;
+    if (field_model != nullptr && !field_model->empty()) {
+      return std::nullopt;
+    }
+  }
+
+  // This builds the same model as the transfer function of `return`.
+  auto model = previous_model;
+  if (const auto& access_path = summary->returned_access_path) {
+    auto return_root = Root(Root::Kind::Return);
+    auto features = Frame::artificial_source(*access_path).features();
+    features.add_always(
+        model.attach_to_propagations(access_path->root()));
+    features.add_always(model.attach_to_propagations(return_root));
+    model.set_inline_as(AccessPathConstantDomain(*access_path));
+    model.add_inferred_propagation(
+        Propagation(
+            *access_path,
+            /* inferred_features */ features,
+            /* user_features */ FeatureSet::bottom()),
+        AccessPath(return_root));
+  } else if (summary->returns_value) {
+    model.set_inline_as(AccessPathConstantDomain::top());
+  }
+  models_built_.fetch_add(1, std::memory_order_relaxed);
+  return model;
+}
+
+} // namespace marianatrench
@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+#include <IRInstruction.h>
+
+#include <mariana-trench/Access.h>
+#include <mariana-trench/CallGraph.h>
+#include <mariana-trench/Compiler.h>
+#include <mariana-trench/Context.h>
+#include <mariana-trench/Method.h>
+#include <mariana-trench/Methods.h>
+#include <mariana-trench/Model.h>
+
+namespace marianatrench {
+
+class Registry;
+
+/**
+ * Methods whose model is built directly instead of running the fixpoint, when
+ * `--summarize-trivial-methods` is used.
+ *
+ * A method is trivial when its code is a single basic block of parameter
+ * loads, moves, constants and field reads, followed by a return. It has no
+ * invoke, array access or write, hence its model cannot depend on callees:
+ * it is either a propagation from the returned argument access path to the
+ * return value along with an inline-as (e.g a getter), or an inline-as of
+ * top when another value is returned (e.g a constant). Trivial methods have no
+ * callees, hence they are never scheduled again once summarized.
+ */
+class TrivialMethods final {
+ public:
+  struct Summary {
+    // Whether the method returns a value.
+    bool returns_value;
+    // The argument access path returned by the method, if any.
+    std::optional<AccessPath> returned_access_path;
+    // Field reads, which add the sources of field models.
+    std::vector<const IRInstruction*> field_reads;
+  };
+
+ public:
+  explicit TrivialMethods(const Methods& methods, const CallGraph& call_graph);
+
+  TrivialMethods(const TrivialMethods&) = delete;
+  TrivialMethods(TrivialMethods&&) = delete;
+  TrivialMethods& operator=(const TrivialMethods&) = delete;
+  TrivialMethods& operator=(TrivialMethods&&) = delete;
+  ~TrivialMethods() = default;
+
+  /**
+   * Return the summary of the code of the method, or `std::nullopt` if the
+   * method is not trivial.
+   */
+  static std::optional<Summary> summary(
+      const Method* method,
+      const CallGraph& call_graph);
+
+  /* Return the summary of the method, or `nullptr` if it is not trivial. */
+  const Summary* MT_NULLABLE get(const Method* method) const;
+
+  /* Return the number of trivial methods. */
+  std::size_t size() const {
+    return summaries_.size();
+  }
+
+  /**
+   * Return the model of a trivial method computed from its previous model,
+   * or `std::nullopt` if it must be analyzed: the method is not trivial, its
+   * previous model is not a default model or it reads a field with a model.
+   * This is thread-safe.
+   */
+  std::optional<Model> model(
+      Context& context,
+      const Registry& registry,
+      const Model& previous_model) const;
+
+  /* Return the number of models built without running the fixpoint. */
+  std::size_t models_built() const {
+    return models_built_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  std::unordered_map<const Method*, Summary> summaries_;
+  mutable std::atomic<std::size_t> models_built_{0};
+};
+
+} // namespace marianatrench
@@ -6,6 +6,9 @@
  */
 
 #include <algorithm>
+#include <iterator>
+#include <mutex>
+#include <unordered_set>
 
 #include <Show.h>
 #include <Walkers.h>
@@ -18,10 +21,145 @@
 #include <mariana-trench/Log.h>
 #include <mariana-trench/Options.h>
 #include <mariana-trench/Types.h>
+#include <mariana-trench/TypesCache.h>
 
 namespace marianatrench {
 
-Types::Types(const Options& options, const DexStoresVector& stores) {
+MethodTypes::MethodTypes(Entries entries) : entries_(std::move(entries)) {
+  std::sort(
+      entries_.begin(), entries_.end(), [](const auto& left, const auto& right) {
+        return left.first < right.first;
+      });
+}
+
+const MethodTypes::SourceTypes& MethodTypes::source_types(
+    const IRInstruction* instruction) const {
+  static const SourceTypes empty;
+
+  auto found = std::lower_bound(
+      entries_.begin(),
+      entries_.end(),
+      instruction,
+      [](const auto& entry, const IRInstruction* instruction) {
+        return entry.first < instruction;
+      });
+  if (found == entries_.end() || found->first != instruction) {
+    return empty;
+  }
+  return found->second;
+}
+
+std::size_t MethodTypes::memory_size() const {
+  std::size_t size = sizeof(MethodTypes) +
+      entries_.capacity() * sizeof(Entries::value_type);
+  for (const auto& [instruction, types] : entries_) {
+    size += types.capacity() * sizeof(SourceTypes::value_type);
+  }
+  return size;
+}
+
+namespace {
+
+/**
+ * Return the classes that the global type analysis needs to see to refine
+ * the types of methods that are not in the types cache, i.e the methods that
+ * changed since the previous run.
+ *
+ * These are the changed classes, and all classes referencing a field or a
+ * method that a changed class defines or references. This covers the code
+ * writing the fields read by the changed code and the callers of changed
+ * methods, but not values flowing through longer chains of unchanged code.
+ */
+Scope global_type_analysis_scope(const Scope& scope, const TypesCache& cache) {
+  std::unordered_set<const DexClass*> changed_classes;
+  std::mutex mutex;
+  walk::parallel::classes(scope, [&](DexClass* dex_class) {
+    for (const auto* method : dex_class->get_all_methods()) {
+      if (method->get_code() != nullptr && !cache.contains(method)) {
+        std::lock_guard<std::mutex> lock(mutex);
+        changed_classes.insert(dex_class);
+        return;
+      }
+    }
+  });
+  if (changed_classes.empty()) {
+    return {};
+  }
+
+  std::unordered_set<const DexFieldRef*> fields;
+  std::unordered_set<const DexMethodRef*> methods;
+  for (const auto* dex_class : changed_classes) {
+    for (const auto* field : dex_class->get_all_fields()) {
+      fields.insert(field);
+    }
+    for (const auto* method : dex_class->get_all_methods()) {
+      methods.insert(method);
+      const auto* code = method->get_code();
+      if (code == nullptr) {
+        continue;
+      }
+      for (const auto& entry : cfg::ConstInstructionIterable(code->cfg())) {
+        if (entry.insn->has_field()) {
+          fields.insert(entry.insn->get_field());
+        } else if (entry.insn->has_method()) {
+          methods.insert(entry.insn->get_method());
+        }
+      }
+    }
+  }
+
+  std::unordered_set<const DexClass*> referencing_classes;
+  walk::parallel::classes(scope, [&](DexClass* dex_class) {
+    bool referencing = changed_classes.count(dex_class) > 0;
+    for (const auto* method : dex_class->get_all_methods()) {
+      const auto* code = method->get_code();
+      if (referencing) {
+        break;
+      } else if (code == nullptr) {
+        continue;
+      }
+      for (const auto& entry : cfg::ConstInstructionIterable(code->cfg())) {
+        if ((entry.insn->has_field() &&
+             fields.count(entry.insn->get_field()) > 0) ||
+            (entry.insn->has_method() &&
+             methods.count(entry.insn->get_method()) > 0)) {
+          referencing = true;
+          break;
+        }
+      }
+    }
+    if (referencing) {
+      std::lock_guard<std::mutex> lock(mutex);
+      referencing_classes.insert(dex_class);
+    }
+  });
+
+  // Keep the order of the scope, for determinism.
+  Scope result;
+  std::copy_if(
+      scope.begin(),
+      scope.end(),
+      std::back_inserter(result),
+      [&](const DexClass* dex_class) {
+        return referencing_classes.count(dex_class) > 0;
+      });
+  return result;
+}
+
+} // namespace
+
+Types::Types() : hits_(0), misses_(0), evictions_(0), releases_(0) {}
+
+Types::Types(const Options& options, const DexStoresVector& stores)
+    : hits_(0), misses_(0), evictions_(0), releases_(0) {
+  if (auto maximum_memory = options.maximum_types_memory_in_mb()) {
+    maximum_shard_memory_size_ =
+        std::max<std::size_t>(1, (*maximum_memory << 20) / kShards);
+  }
+  if (const auto& types_cache_path = options.types_cache_path()) {
+    cache_ = std::make_unique<TypesCache>(*types_cache_path);
+  }
+
   Scope scope = build_class_scope(stores);
   scope.erase(
       std::remove_if(
@@ -31,60 +169,80 @@ Types::Types(const Options& options, const DexStoresVector& stores) {
       scope.end());
   const std::vector<std::string>& proguard_configuration_paths =
       options.proguard_configuration_paths();
-  if (proguard_configuration_paths.empty()) {
+  bool incremental =
+      cache_ != nullptr && options.previous_output_directory().has_value();
+  if (proguard_configuration_paths.empty() || incremental) {
     walk::parallel::code(scope, [](DexMethod*, IRCode& code) {
       if (!code.cfg_built()) {
         code.build_cfg();
       }
     });
+  }
+  if (proguard_configuration_paths.empty()) {
     global_type_analyzer_ = nullptr;
-  } else {
-    type_analyzer::global::GlobalTypeAnalysis analysis;
-    global_type_analyzer_ = analysis.analyze(scope);
+    return;
   }
-}
 
-namespace {
+  if (incremental) {
+    // Types of unchanged methods are read from the cache, the global analysis
+    // is only needed around the changed code.
+    auto number_of_classes = scope.size();
+    scope = global_type_analysis_scope(scope, *cache_);
+    LOG(1,
+        "Running the global type analysis on {} out of {} classes.",
+        scope.size(),
+        number_of_classes);
+    global_type_analysis_classes_.emplace();
+    for (const auto* dex_class : scope) {
+      global_type_analysis_classes_->insert(dex_class->get_type());
+    }
+    if (scope.empty()) {
+      return;
+    }
+  }
+
+  type_analyzer::global::GlobalTypeAnalysis analysis;
+  global_type_analyzer_ = analysis.analyze(scope);
+}
 
-static const TypeEnvironment empty_environment;
+Types::~Types() = default;
 
-static const TypeEnvironments empty_environments;
+namespace {
 
 bool is_interesting_opcode(IROpcode opcode) {
   return opcode::is_an_invoke(opcode) || opcode::is_an_iput(opcode);
 }
 
 /**
- * Create the environments for a method using the result from redex's type
- * inference. This extracts what the analysis requires and discards the rest.
+ * Create the types of a method using the result from redex's type inference.
+ * This extracts what the analysis requires and discards the rest.
  */
-TypeEnvironments make_environments(
+MethodTypes::Entries make_entries(
     const std::unordered_map<
         const IRInstruction*,
         type_inference::TypeEnvironment>& environments) {
-  TypeEnvironments result;
+  MethodTypes::Entries entries;
 
-  for (const auto& [instruction, types] : environments) {
+  for (const auto& [instruction, environment] : environments) {
     if (!is_interesting_opcode(instruction->opcode())) {
       continue;
     }
 
-    TypeEnvironment environment;
+    MethodTypes::SourceTypes types;
+    types.reserve(instruction->srcs_size());
     for (auto register_id : instruction->srcs()) {
-      auto type = types.get_dex_type(register_id);
-      if (type && *type != nullptr) {
-        environment.emplace(register_id, *type);
-      }
+      auto type = environment.get_dex_type(register_id);
+      types.push_back(type ? *type : nullptr);
     }
-    result.emplace(instruction, std::move(environment));
+    entries.emplace_back(instruction, std::move(types));
   }
 
-  return result;
+  return entries;
 }
 
 } // namespace
 
-std::unique_ptr<TypeEnvironments> Types::infer_local_types_for_method(
+MethodTypes::Entries Types::infer_local_types_for_method(
     const Method* method) const {
   auto* code = method->get_code();
   if (!code) {
@@ -92,7 +250,7 @@ std::unique_ptr<TypeEnvironments> Types::infer_local_types_for_method(
         4,
         "Trying to get local types for `{}` which does not have code.",
         method->show());
-    return std::make_unique<TypeEnvironments>();
+    return {};
   }
 
   auto* parameter_type_list = method->get_proto()->get_args();
@@ -118,33 +276,37 @@ std::unique_ptr<TypeEnvironments> Types::infer_local_types_for_method(
     type_inference::TypeInference inference(code->cfg());
     inference.run(
         method->is_static(), method->get_class(), parameter_type_list);
-    return std::make_unique<TypeEnvironments>(
-        make_environments(inference.get_type_environments()));
+    return make_entries(inference.get_type_environments());
   } catch (const RedexException& rethrown_exception) {
     ERROR(
         1,
         "Cannot infer types for method `{}`: {}.",
         method->show(),
         rethrown_exception.what());
-    return std::make_unique<TypeEnvironments>();
+    return {};
   }
 }
 
-std::unique_ptr<TypeEnvironments> Types::infer_types_for_method(
-    const Method* method) const {
+MethodTypes Types::infer_types_for_method(const Method* method) const {
   auto* code = method->get_code();
   if (!code) {
     WARNING(
         4,
         "Trying to get types for `{}` which does not have code.",
         method->show());
-    return std::make_unique<TypeEnvironments>();
+    return MethodTypes();
   }
 
   // Call TypeInference first, then use GlobalTypeAnalyzer to refine results.
-  auto environments = infer_local_types_for_method(method);
-  if (global_type_analyzer_ == nullptr) {
-    return environments;
+  auto entries = infer_local_types_for_method(method);
+  if (global_type_analyzer_ == nullptr ||
+      (global_type_analysis_classes_ &&
+       global_type_analysis_classes_->count(method->get_class()) == 0)) {
+    return MethodTypes(std::move(entries));
+  }
+  std::unordered_map<const IRInstruction*, std::size_t> indices;
+  for (std::size_t index = 0; index < entries.size(); index++) {
+    indices.emplace(entries[index].first, index);
   }
   auto local_type_analyzer =
       global_type_analyzer_->get_local_analysis(method->dex_method());
@@ -158,27 +320,33 @@ std::unique_ptr<TypeEnvironments> Types::infer_types_for_method(
       if (!is_interesting_opcode(instruction->opcode())) {
         continue;
       }
-      auto found = environments->find(instruction);
-      auto& environment_at_instruction = found->second;
+      auto found = indices.find(instruction);
+      if (found == indices.end()) {
+        continue;
+      }
+      auto& source_types = entries[found->second].second;
 
       auto register_type_environment = current_state.get_reg_environment();
       if (!register_type_environment.is_value()) {
         continue;
       }
-      for (auto& ir_register : instruction->srcs()) {
-        DexTypeDomain domain = register_type_environment.get(ir_register);
-        auto found = environment_at_instruction.find(ir_register);
-        if (found != environment_at_instruction.end()) {
-          auto dex_type = found->second;
+      for (std::size_t source_position = 0;
+           source_position < source_types.size();
+           source_position++) {
+        DexTypeDomain domain =
+            register_type_environment.get(instruction->src(source_position));
+        auto*& dex_type = source_types[source_position];
+        if (dex_type != nullptr) {
           auto new_dex_type_domain =
               domain.is_top() ? DexTypeDomain(dex_type) : domain;
           auto new_dex_type = new_dex_type_domain.get_dex_type();
-          environment_at_instruction[ir_register] =
-              new_dex_type ? *new_dex_type : dex_type;
+          if (new_dex_type) {
+            dex_type = *new_dex_type;
+          }
         } else {
           auto new_dex_type = domain.get_dex_type();
           if (new_dex_type) {
-            environment_at_instruction[ir_register] = *new_dex_type;
+            dex_type = *new_dex_type;
           }
         }
       }
@@ -187,59 +355,87 @@ std::unique_ptr<TypeEnvironments> Types::infer_types_for_method(
     }
   }
 
-  return environments;
+  return MethodTypes(std::move(entries));
 }
 
-const TypeEnvironments& Types::environments(const Method* method) const {
-  auto* environments = environments_.get(method, /* default */ nullptr);
-  if (environments != nullptr) {
-    return *environments;
-  }
-
-  auto* code = method->get_code();
+Types::Shard& Types::shard(const Method* method) const {
+  return shards_[method->id() % kShards];
+}
 
-  if (!code) {
-    WARNING(
-        4,
-        "Trying to get types for `{}` which does not have code.",
-        method->show());
-    return empty_environments;
+std::shared_ptr<const MethodTypes> Types::method_types(
+    const Method* method) const {
+  auto& shard = this->shard(method);
+  {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto found = shard.positions.find(method);
+    if (found != shard.positions.end()) {
+      hits_++;
+      shard.entries.splice(
+          shard.entries.begin(), shard.entries, found->second);
+      return found->second->second;
+    }
   }
 
-  environments_.emplace(method, this->infer_types_for_method(method));
-  return *environments_.at(method);
-}
+  // Infer outside of the lock. Concurrent misses on the same method both
+  // infer the same types, only one is kept.
+  misses_++;
+  std::shared_ptr<const MethodTypes> types;
+  if (cache_ != nullptr) {
+    if (auto cached_types = cache_->get(method)) {
+      types = std::make_shared<const MethodTypes>(std::move(*cached_types));
+    }
+  }
+  if (types == nullptr) {
+    types = std::make_shared<const MethodTypes>(infer_types_for_method(method));
+  }
 
-const TypeEnvironment& Types::environment(
-    const Method* method,
-    const IRInstruction* instruction) const {
-  const auto& environments = this->environments(method);
-  auto environment = environments.find(instruction);
-  if (environment == environments.end()) {
-    return empty_environment;
-  } else {
-    return environment->second;
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  auto found = shard.positions.find(method);
+  if (found != shard.positions.end()) {
+    return found->second->second;
+  }
+  shard.entries.emplace_front(method, types);
+  shard.positions.emplace(method, shard.entries.begin());
+  shard.memory_size += types->memory_size();
+
+  // Evict the least recently used methods, but always keep the new one.
+  // Evicted types stay alive as long as a caller holds them.
+  while (maximum_shard_memory_size_ &&
+         shard.memory_size > *maximum_shard_memory_size_ &&
+         shard.entries.size() > 1) {
+    const auto& [evicted_method, evicted_types] = shard.entries.back();
+    shard.memory_size -= evicted_types->memory_size();
+    shard.positions.erase(evicted_method);
+    shard.entries.pop_back();
+    evictions_++;
   }
+  return types;
 }
 
 const DexType* MT_NULLABLE Types::register_type(
     const Method* method,
     const IRInstruction* instruction,
     Register register_id) const {
-  const auto& environment = this->environment(method, instruction);
-  auto type = environment.find(register_id);
-  if (type == environment.end()) {
+  const auto& sources = instruction->srcs();
+  auto found = std::find(sources.begin(), sources.end(), register_id);
+  if (found == sources.end()) {
     return nullptr;
-  } else {
-    return type->second;
   }
+  return source_type(
+      method, instruction, std::distance(sources.begin(), found));
 }
 
 const DexType* MT_NULLABLE Types::source_type(
     const Method* method,
     const IRInstruction* instruction,
     std::size_t source_position) const {
-  return register_type(method, instruction, instruction->src(source_position));
+  // Types are not owned by `MethodTypes`, it is fine to release it here.
+  auto method_types = this->method_types(method);
+  const auto& types = method_types->source_types(instruction);
+  if (source_position >= types.size()) {
+    return nullptr;
+  }
+  return types[source_position];
 }
 
 const DexType* Types::receiver_type(
@@ -254,4 +450,56 @@ const DexType* Types::receiver_type(
   return source_type(method, instruction, /* source_position */ 0);
 }
 
+void Types::dump_cache(const boost::filesystem::path& path) const {
+  std::vector<std::pair<const Method*, std::shared_ptr<const MethodTypes>>>
+      types;
+  for (auto& shard : shards_) {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    types.insert(types.end(), shard.entries.begin(), shard.entries.end());
+  }
+  TypesCache::write(path, types);
+}
+
+bool Types::release_global_type_analysis() {
+  if (maximum_shard_memory_size_ || global_type_analyzer_ == nullptr) {
+    return false;
+  }
+  global_type_analyzer_ = nullptr;
+  global_type_analysis_classes_ = std::nullopt;
+  return true;
+}
+
+void Types::release(const Method* method) {
+  auto& shard = this->shard(method);
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  auto found = shard.positions.find(method);
+  if (found == shard.positions.end()) {
+    return;
+  }
+  shard.memory_size -= found->second->second->memory_size();
+  shard.entries.erase(found->second);
+  shard.positions.erase(found);
+  releases_++;
+}
+
+Json::Value Types::statistics_to_json() const {
+  std::size_t methods = 0;
+  std::size_t memory_size = 0;
+  for (auto& shard : shards_) {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    methods += shard.entries.size();
+    memory_size += shard.memory_size;
+  }
+
+  auto value = Json::Value(Json::objectValue);
+  value["methods"] = Json::Value(static_cast<Json::UInt64>(methods));
+  value["memory_size"] = Json::Value(static_cast<Json::UInt64>(memory_size));
+  value["hits"] = Json::Value(static_cast<Json::UInt64>(hits_.load()));
+  value["misses"] = Json::Value(static_cast<Json::UInt64>(misses_.load()));
+  value["evictions"] =
+      Json::Value(static_cast<Json::UInt64>(evictions_.load()));
+  value["releases"] = Json::Value(static_cast<Json::UInt64>(releases_.load()));
+  return value;
+}
+
 } // namespace marianatrench
@@ -7,7 +7,19 @@
 
 #pragma once
 
-#include <boost/container/flat_map.hpp>
+#include <array>
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include <boost/filesystem/path.hpp>
+#include <json/json.h>
 
 #include <DexClass.h>
 #include <GlobalTypeAnalyzer.h>
@@ -17,28 +29,71 @@
 #include <mariana-trench/Compiler.h>
 #include <mariana-trench/Method.h>
 #include <mariana-trench/Options.h>
-#include <mariana-trench/UniquePointerConcurrentMap.h>
 
 namespace marianatrench {
 
-using TypeEnvironment = boost::container::flat_map<Register, const DexType*>;
+/**
+ * Types inferred for a method.
+ *
+ * Only invoke and iput instructions are kept, the analysis does not need
+ * types elsewhere. Each instruction is mapped to the types of its sources, in
+ * order, instead of a map from registers to types. Instructions are sorted,
+ * hence lookups are a binary search.
+ */
+class MethodTypes final {
+ public:
+  using SourceTypes = std::vector<const DexType * MT_NULLABLE>;
+  using Entries = std::vector<std::pair<const IRInstruction*, SourceTypes>>;
+
+ public:
+  MethodTypes() = default;
+  explicit MethodTypes(Entries entries);
+  MethodTypes(const MethodTypes&) = delete;
+  MethodTypes(MethodTypes&&) = default;
+  MethodTypes& operator=(const MethodTypes&) = delete;
+  MethodTypes& operator=(MethodTypes&&) = default;
+  ~MethodTypes() = default;
+
+  /**
+   * Get the types of all sources of the given instruction, in order.
+   *
+   * Returns an empty vector if the instruction is neither an invoke nor an
+   * iput. Types that could not be inferred are `nullptr`.
+   */
+  const SourceTypes& source_types(const IRInstruction* instruction) const;
+
+  const Entries& entries() const {
+    return entries_;
+  }
 
-using TypeEnvironments =
-    std::unordered_map<const IRInstruction*, TypeEnvironment>;
+  /* Approximate number of bytes held by these types. */
+  std::size_t memory_size() const;
+
+ private:
+  Entries entries_;
+};
+
+class TypesCache;
 
 class Types final {
  public:
-  Types() = default;
+  Types();
   explicit Types(const Options& options, const DexStoresVector& stores);
   Types(const Types&) = delete;
   Types(Types&&) = delete;
   Types& operator=(const Types&) = delete;
   Types& operator=(Types&&) = delete;
-  ~Types() = default;
+  ~Types();
 
-  const TypeEnvironment& environment(
-      const Method* method,
-      const IRInstruction* instruction) const;
+  /**
+   * Get the types inferred for the given method, inferring them if needed.
+   *
+   * When `--maximum-types-memory-in-mb` is used, types of methods that were
+   * not queried recently are evicted and inferred again on the next query.
+   * The returned pointer keeps the types alive, references into them must
+   * not outlive it.
+   */
+  std::shared_ptr<const MethodTypes> method_types(const Method* method) const;
 
   /**
    * Get the type of a register at the given instruction.
@@ -68,19 +123,72 @@ class Types final {
   const DexType* MT_NULLABLE
   receiver_type(const Method* method, const IRInstruction* instruction) const;
 
+  /**
+   * Write the types inferred so far in the given cache file.
+   *
+   * Types that were evicted are not written.
+   */
+  void dump_cache(const boost::filesystem::path& path) const;
+
+  /**
+   * Free the types inferred for the given method, once it will not be
+   * analyzed again. Types are inferred again if they are queried afterwards,
+   * which requires the control flow graph. This is thread-safe.
+   */
+  void release(const Method* method);
+
+  /**
+   * Free the global type analysis once the types of all methods are inferred,
+   * i.e after building the call graph. Types that are inferred again
+   * afterwards (see `release`) only use the local type inference.
+   *
+   * The analysis is kept when types can be evicted under
+   * `--maximum-types-memory-in-mb`, since evicted types would lose precision.
+   * Returns true if the analysis was freed.
+   */
+  bool release_global_type_analysis();
+
+  Json::Value statistics_to_json() const;
+
+  constexpr static std::size_t kShards = 64;
+
  private:
-  const TypeEnvironments& environments(const Method* method) const;
-  std::unique_ptr<TypeEnvironments> infer_local_types_for_method(
+  MethodTypes::Entries infer_local_types_for_method(
       const Method* method) const;
 
-  std::unique_ptr<TypeEnvironments> infer_types_for_method(
-      const Method* method) const;
+  MethodTypes infer_types_for_method(const Method* method) const;
+
+  /**
+   * Resident types, split in shards each protected by its own lock. Each
+   * shard keeps its methods from the most to the least recently used, and
+   * evicts the least recently used ones when it exceeds its share of the
+   * memory limit.
+   */
+  struct Shard {
+    using Entry = std::pair<const Method*, std::shared_ptr<const MethodTypes>>;
+
+    std::mutex mutex;
+    std::list<Entry> entries;
+    std::unordered_map<const Method*, std::list<Entry>::iterator> positions;
+    std::size_t memory_size = 0;
+  };
+
+  Shard& shard(const Method* method) const;
 
  private:
-  mutable UniquePointerConcurrentMap<const Method*, TypeEnvironments>
-      environments_;
+  std::optional<std::size_t> maximum_shard_memory_size_;
+  mutable std::array<Shard, kShards> shards_;
+  mutable std::atomic<std::size_t> hits_;
+  mutable std::atomic<std::size_t> misses_;
+  mutable std::atomic<std::size_t> evictions_;
+  std::atomic<std::size_t> releases_;
   std::unique_ptr<type_analyzer::global::GlobalTypeAnalyzer>
       global_type_analyzer_;
+  // Only set in incremental mode, when the global type analysis does not run
+  // on all classes.
+  std::optional<std::unordered_set<const DexType*>>
+      global_type_analysis_classes_;
+  std::unique_ptr<TypesCache> cache_;
 };
 
 } // namespace marianatrench
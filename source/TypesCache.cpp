@@ -0,0 +1,299 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include <boost/filesystem.hpp>
+
+#include <ControlFlow.h>
+#include <IRCode.h>
+#include <Show.h>
+
+#include <mariana-trench/Log.h>
+#include <mariana-trench/Redex.h>
+#include <mariana-trench/TypesCache.h>
+
+namespace marianatrench {
+
+namespace {
+
+constexpr std::uint32_t k_magic = 0x4354544d; // "MTTC"
+constexpr std::uint32_t k_version = 2;
+
+class Reader final {
+ public:
+  Reader(const char* begin, const char* end) : current_(begin), end_(end) {}
+
+  template <typename T>
+  T read() {
+    if (current_ + sizeof(T) > end_) {
+      throw std::runtime_error("Unexpected end of types cache.");
+    }
+    T value;
+    std::memcpy(&value, current_, sizeof(T));
+    current_ += sizeof(T);
+    return value;
+  }
+
+  std::string_view read_bytes(std::size_t size) {
+    if (current_ + size > end_) {
+      throw std::runtime_error("Unexpected end of types cache.");
+    }
+    std::string_view bytes(current_, size);
+    current_ += size;
+    return bytes;
+  }
+
+  void skip(std::size_t size) {
+    read_bytes(size);
+  }
+
+  const char* current() const {
+    return current_;
+  }
+
+ private:
+  const char* current_;
+  const char* end_;
+};
+
+class Writer final {
+ public:
+  explicit Writer(std::ofstream& stream) : stream_(stream) {}
+
+  template <typename T>
+  void write(T value) {
+    stream_.write(reinterpret_cast<const char*>(&value), sizeof(T));
+  }
+
+  void write_string(const std::string& string) {
+    write<std::uint32_t>(string.size());
+    stream_.write(string.data(), string.size());
+  }
+
+ private:
+  std::ofstream& stream_;
+};
+
+class StringTable final {
+ public:
+  std::uint32_t index(const std::string& string) {
+    auto [iterator, inserted] = indices_.emplace(string, strings_.size());
+    if (inserted) {
+      strings_.push_back(&iterator->first);
+    }
+    return iterator->second;
+  }
+
+  const std::vector<const std::string*>& strings() const {
+    return strings_;
+  }
+
+ private:
+  std::unordered_map<std::string, std::uint32_t> indices_;
+  std::vector<const std::string*> strings_;
+};
+
+std::vector<const IRInstruction*> collect_instructions(const IRCode& code) {
+  std::vector<const IRInstruction*> result;
+  for (const auto* block : code.cfg().blocks()) {
+    for (const auto& entry : InstructionIterable(block)) {
+      result.push_back(entry.insn);
+    }
+  }
+  return result;
+}
+
+} // namespace
+
+TypesCache::TypesCache(const boost::filesystem::path& path) {
+  if (!boost::filesystem::exists(path)) {
+    LOG(1, "Types cache `{}` does not exist yet.", path.native());
+    return;
+  }
+
+  try {
+    file_.open(path.native());
+    Reader reader(file_.data(), file_.data() + file_.size());
+    if (reader.read<std::uint32_t>() != k_magic ||
+        reader.read<std::uint32_t>() != k_version) {
+      throw std::runtime_error("Invalid types cache header.");
+    }
+
+    auto number_of_strings = reader.read<std::uint32_t>();
+    strings_.reserve(number_of_strings);
+    for (std::uint32_t i = 0; i < number_of_strings; i++) {
+      auto size = reader.read<std::uint32_t>();
+      strings_.push_back(reader.read_bytes(size));
+    }
+
+    auto number_of_methods = reader.read<std::uint32_t>();
+    for (std::uint32_t i = 0; i < number_of_methods; i++) {
+      auto method = strings_.at(reader.read<std::uint32_t>());
+      auto code_hash = reader.read<std::uint64_t>();
+      auto offset = static_cast<std::size_t>(reader.current() - file_.data());
+      entries_.emplace(method, Entry{code_hash, offset});
+
+      // Skip the instructions, they are decoded lazily.
+      auto number_of_instructions = reader.read<std::uint32_t>();
+      for (std::uint32_t j = 0; j < number_of_instructions; j++) {
+        reader.skip(sizeof(std::uint32_t));
+        auto number_of_sources = reader.read<std::uint32_t>();
+        reader.skip(number_of_sources * sizeof(std::uint32_t));
+      }
+    }
+  } catch (const std::exception& exception) {
+    WARNING(
+        1,
+        "Ignoring invalid types cache `{}`: {}",
+        path.native(),
+        exception.what());
+    entries_.clear();
+    strings_.clear();
+    if (file_.is_open()) {
+      file_.close();
+    }
+    return;
+  }
+
+  LOG(1,
+      "Loaded types cache `{}` with {} methods.",
+      path.native(),
+      entries_.size());
+}
+
+std::optional<MethodTypes> TypesCache::get(const Method* method) const {
+  const auto* code = method->get_code();
+  if (code == nullptr) {
+    return std::nullopt;
+  }
+
+  auto found = entries_.find(method->show());
+  if (found == entries_.end() ||
+      found->second.code_hash != redex::code_hash(*code)) {
+    return std::nullopt;
+  }
+
+  auto instructions = collect_instructions(*code);
+  Reader reader(
+      file_.data() + found->second.offset, file_.data() + file_.size());
+  MethodTypes::Entries entries;
+  auto number_of_instructions = reader.read<std::uint32_t>();
+  entries.reserve(number_of_instructions);
+  for (std::uint32_t i = 0; i < number_of_instructions; i++) {
+    auto instruction_index = reader.read<std::uint32_t>();
+    auto number_of_sources = reader.read<std::uint32_t>();
+    if (instruction_index >= instructions.size() ||
+        number_of_sources != instructions[instruction_index]->srcs_size()) {
+      // This should not happen unless we have a hash collision.
+      return std::nullopt;
+    }
+
+    MethodTypes::SourceTypes types;
+    types.reserve(number_of_sources);
+    for (std::uint32_t j = 0; j < number_of_sources; j++) {
+      auto type_index = reader.read<std::uint32_t>();
+      types.push_back(
+          type_index == kUnknownType
+              ? nullptr
+              : redex::get_type(std::string(strings_.at(type_index))));
+    }
+    entries.emplace_back(instructions[instruction_index], std::move(types));
+  }
+  return MethodTypes(std::move(entries));
+}
+
+bool TypesCache::contains(const DexMethod* method) const {
+  const auto* code = method->get_code();
+  if (code == nullptr) {
+    return false;
+  }
+
+  auto found = entries_.find(show(method));
+  return found != entries_.end() &&
+      found->second.code_hash == redex::code_hash(*code);
+}
+
+void TypesCache::write(
+    const boost::filesystem::path& path,
+    const std::vector<
+        std::pair<const Method*, std::shared_ptr<const MethodTypes>>>& types) {
+  StringTable strings;
+
+  // Prepare all entries first, since strings are written before the methods.
+  struct MethodEntry {
+    std::uint32_t method;
+    std::uint64_t code_hash;
+    std::vector<std::pair<std::uint32_t, std::vector<std::uint32_t>>>
+        instructions;
+  };
+  std::vector<MethodEntry> entries;
+  for (const auto& [method, method_types] : types) {
+    const auto* code = method->get_code();
+    if (code == nullptr || !code->cfg_built()) {
+      continue;
+    }
+
+    std::unordered_map<const IRInstruction*, std::uint32_t> indices;
+    for (const auto* instruction : collect_instructions(*code)) {
+      indices.emplace(instruction, indices.size());
+    }
+
+    MethodEntry entry{
+        strings.index(method->show()), redex::code_hash(*code), {}};
+    for (const auto& [instruction, source_types] : method_types->entries()) {
+      auto found = indices.find(instruction);
+      if (found == indices.end()) {
+        continue;
+      }
+      std::vector<std::uint32_t> type_indices;
+      for (const auto* type : source_types) {
+        type_indices.push_back(
+            type == nullptr ? kUnknownType : strings.index(type->str()));
+      }
+      entry.instructions.emplace_back(found->second, std::move(type_indices));
+    }
+    entries.push_back(std::move(entry));
+  }
+
+  std::ofstream stream(path.native(), std::ios_base::out | std::ios::binary);
+  if (!stream.is_open()) {
+    ERROR(1, "Unable to write types cache to `{}`.", path.native());
+    return;
+  }
+
+  Writer writer(stream);
+  writer.write<std::uint32_t>(k_magic);
+  writer.write<std::uint32_t>(k_version);
+  writer.write<std::uint32_t>(strings.strings().size());
+  for (const auto* string : strings.strings()) {
+    writer.write_string(*string);
+  }
+  writer.write<std::uint32_t>(entries.size());
+  for (const auto& entry : entries) {
+    writer.write<std::uint32_t>(entry.method);
+    writer.write<std::uint64_t>(entry.code_hash);
+    writer.write<std::uint32_t>(entry.instructions.size());
+    for (const auto& [instruction_index, type_indices] : entry.instructions) {
+      writer.write<std::uint32_t>(instruction_index);
+      writer.write<std::uint32_t>(type_indices.size());
+      for (auto type_index : type_indices) {
+        writer.write<std::uint32_t>(type_index);
+      }
+    }
+  }
+
+  LOG(1,
+      "Wrote types cache `{}` with {} methods.",
+      path.native(),
+      entries.size());
+}
+
+} // namespace marianatrench
@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <memory>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <boost/filesystem/path.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+
+#include <mariana-trench/Method.h>
+#include <mariana-trench/Types.h>
+
+namespace marianatrench {
+
+/**
+ * A persistent cache of the inferred types, from a previous run.
+ *
+ * The cache file is memory-mapped and entries are only decoded on lookup.
+ * Each entry is keyed by the method and the hash of its code (see
+ * `redex::code_hash`), hence it is invalidated when the code changes.
+ *
+ * Instructions are identified by their index in the control flow graph, and
+ * types by their name. Sources whose type is unknown are stored as
+ * `kUnknownType`.
+ */
+class TypesCache final {
+ public:
+  /* Map the given cache file, if it exists. */
+  explicit TypesCache(const boost::filesystem::path& path);
+
+  TypesCache(const TypesCache&) = delete;
+  TypesCache(TypesCache&&) = delete;
+  TypesCache& operator=(const TypesCache&) = delete;
+  TypesCache& operator=(TypesCache&&) = delete;
+  ~TypesCache() = default;
+
+  /**
+   * Return the cached types for the given method, or `std::nullopt` if the
+   * method is not in the cache or its code changed.
+   *
+   * This is thread-safe.
+   */
+  std::optional<MethodTypes> get(const Method* method) const;
+
+  /**
+   * Return whether the given method is in the cache and its code did not
+   * change. This is thread-safe.
+   */
+  bool contains(const DexMethod* method) const;
+
+  /* Write the given types into a new cache file. */
+  static void write(
+      const boost::filesystem::path& path,
+      const std::vector<
+          std::pair<const Method*, std::shared_ptr<const MethodTypes>>>&
+          types);
+
+  constexpr static std::uint32_t kUnknownType = 0xffffffff;
+
+ private:
+  struct Entry {
+    std::size_t code_hash;
+    std::size_t offset;
+  };
+
+  boost::iostreams::mapped_file_source file_;
+  std::vector<std::string_view> strings_;
+  std::unordered_map<std::string_view, Entry> entries_;
+};
+
+} // namespace marianatrench
@@ -5,29 +5,32 @@
  * LICENSE file in the root directory of this source tree.
  */
 
-#include <SpartaWorkQueue.h>
-
-#include <mariana-trench/Methods.h>
-#include <mariana-trench/Rules.h>
+#include <mariana-trench/TriggeredPartialKind.h>
 #include <mariana-trench/UnusedKinds.h>
 
 namespace marianatrench {
 
-std::unordered_set<const Kind*> UnusedKinds::remove_unused_kinds(
-    Context& context,
-    Registry& registry) {
-  auto unused_kinds = context.rules->collect_unused_kinds(*context.kinds);
-  auto queue = sparta::work_queue<const Method*>(
-      [&](const Method* method) {
-        auto model = registry.get(method);
-        model.remove_kinds(unused_kinds);
-        registry.set(model);
-      },
-      sparta::parallel::default_num_threads());
-  for (const auto* method : *context.methods) {
-    queue.add_item(method);
+UnusedKinds::UnusedKinds(const Rules& rules, const Kinds& kinds)
+    : unused_kinds_(rules.collect_unused_kinds(kinds)) {
+  for (const auto* kind : kinds.kinds()) {
+    known_kinds_.insert(kind);
+  }
+}
+
+bool UnusedKinds::is_unused(const Kind* kind) const {
+  if (unused_kinds_.count(kind) > 0) {
+    return true;
   }
-  queue.run_all();
-  return unused_kinds;
+  if (known_kinds_.count(kind) > 0) {
+    return false;
+  }
+  // Kinds created after the rules are loaded cannot be used in a rule.
+  // Triggered kinds are created during the analysis and never removed.
+  return kind->as<TriggeredPartialKind>() == nullptr;
+}
+
+void UnusedKinds::remove_from(Model& model) const {
+  model.remove_kinds_if([this](const Kind* kind) { return is_unused(kind); });
 }
+
 } // namespace marianatrench
@@ -7,21 +7,48 @@
 
 #pragma once
 
-#include <mariana-trench/Context.h>
-#include <mariana-trench/Registry.h>
+#include <unordered_set>
+
+#include <mariana-trench/Kind.h>
+#include <mariana-trench/Kinds.h>
+#include <mariana-trench/Model.h>
+#include <mariana-trench/Rules.h>
 
 namespace marianatrench {
 
-class UnusedKinds {
+/**
+ * Before the analysis begins, a context might contain Kinds that are built
+ * into the binary, or specified in a model generator, but aren't actually
+ * used in any rule. These can be removed to save memory/time.
+ *
+ * Unused kinds are removed while models are loaded (see `Registry::load`).
+ * This must be built once rules are loaded: kinds created afterwards, for
+ * instance by json models, are not used in any rule either.
+ */
+class UnusedKinds final {
  public:
-  /*
-   * Before the analysis begins, a context might contain Kinds that are built
-   * into the binary, or specified in a model generator, but aren't actually
-   * used in any rule. These can be removed to save memory/time.
-   */
-  static std::unordered_set<const Kind*> remove_unused_kinds(
-      Context& context,
-      Registry& registry);
+  explicit UnusedKinds(const Rules& rules, const Kinds& kinds);
+
+  UnusedKinds(const UnusedKinds&) = delete;
+  UnusedKinds(UnusedKinds&&) = default;
+  UnusedKinds& operator=(const UnusedKinds&) = delete;
+  UnusedKinds& operator=(UnusedKinds&&) = delete;
+  ~UnusedKinds() = default;
+
+  /* Returns true if the kind is not used in any rule. This is thread-safe. */
+  bool is_unused(const Kind* kind) const;
+
+  /* Remove the taint with unused kinds from the given model. */
+  void remove_from(Model& model) const;
+
+  /* Return the unused kinds that existed when the rules were loaded. */
+  const std::unordered_set<const Kind*>& kinds() const {
+    return unused_kinds_;
+  }
+
+ private:
+  std::unordered_set<const Kind*> known_kinds_;
+  std::unordered_set<const Kind*> unused_kinds_;
 };
 
 } // namespace marianatrench
@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <mariana-trench/Assert.h>
+#include <mariana-trench/WorkerPool.h>
+
+namespace marianatrench {
+
+namespace {
+
+thread_local bool is_worker = false;
+
+} // namespace
+
+WorkerPool::~WorkerPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  start_.notify_all();
+  for (auto& thread : threads_) {
+    thread.join();
+  }
+}
+
+bool WorkerPool::try_run(
+    unsigned int workers,
+    const std::function<void(unsigned int)>& task) {
+  if (in_worker()) {
+    return false;
+  }
+  std::unique_lock<std::mutex> run_lock(run_mutex_, std::try_to_lock);
+  if (!run_lock.owns_lock()) {
+    return false;
+  }
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (threads_.size() < workers) {
+    auto worker_id = static_cast<unsigned int>(threads_.size());
+    threads_.emplace_back([this, worker_id]() { work(worker_id); });
+  }
+  task_ = &task;
+  workers_ = workers;
+  running_ = workers;
+  generation_++;
+  start_.notify_all();
+  done_.wait(lock, [this]() { return running_ == 0; });
+  task_ = nullptr;
+  return true;
+}
+
+std::size_t WorkerPool::threads() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return threads_.size();
+}
+
+bool WorkerPool::in_worker() {
+  return is_worker;
+}
+
+void WorkerPool::work(unsigned int worker_id) {
+  is_worker = true;
+  std::uint64_t generation = 0;
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    start_.wait(lock, [&]() { return stopping_ || generation_ != generation; });
+    if (stopping_) {
+      return;
+    }
+    generation = generation_;
+    if (worker_id >= workers_) {
+      continue;
+    }
+
+    const auto* task = task_;
+    mt_assert(task != nullptr);
+    lock.unlock();
+    (*task)(worker_id);
+    lock.lock();
+    if (--running_ == 0) {
+      done_.notify_one();
+    }
+  }
+}
+
+} // namespace marianatrench
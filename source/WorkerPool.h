@@ -0,0 +1,250 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <mariana-trench/Compiler.h>
+
+namespace marianatrench {
+
+/**
+ * Long-lived worker threads shared by the phases of the analysis and the
+ * iterations of the global fixpoint.
+ *
+ * Running a phase on the pool does not create threads, and per-thread state
+ * (e.g `thread_local` readers and statistic buffers, allocator caches) is
+ * kept between phases. Worker `i` of a run is always the same thread, hence
+ * state indexed by worker id also stays on the same thread.
+ *
+ * A single run happens at a time. `try_run` returns false when the pool is
+ * busy or when called from one of its workers, in which case callers use
+ * their own threads (see `WorkQueue`).
+ */
+class WorkerPool final {
+ public:
+  WorkerPool() = default;
+  WorkerPool(const WorkerPool&) = delete;
+  WorkerPool(WorkerPool&&) = delete;
+  WorkerPool& operator=(const WorkerPool&) = delete;
+  WorkerPool& operator=(WorkerPool&&) = delete;
+  ~WorkerPool();
+
+  /**
+   * Run `task(worker_id)` on `workers` threads of the pool, starting threads
+   * if the pool has less, and wait for all of them. `task` must not throw.
+   *
+   * Return false without running anything if the pool is already running or
+   * if this is called from a worker of a pool.
+   */
+  bool try_run(
+      unsigned int workers,
+      const std::function<void(unsigned int)>& task);
+
+  /* Return the number of threads of the pool. */
+  std::size_t threads() const;
+
+  /* Whether the current thread is a worker of a pool. */
+  static bool in_worker();
+
+ private:
+  void work(unsigned int worker_id);
+
+ private:
+  std::mutex run_mutex_;
+  mutable std::mutex mutex_;
+  std::condition_variable start_;
+  std::condition_variable done_;
+  std::vector<std::thread> threads_;
+  const std::function<void(unsigned int)>* MT_NULLABLE task_ = nullptr;
+  unsigned int workers_ = 0;
+  unsigned int running_ = 0;
+  std::uint64_t generation_ = 0;
+  bool stopping_ = false;
+};
+
+/**
+ * A work queue with the interface of `sparta::work_queue`, running on the
+ * given worker pool when it is available and on its own threads otherwise.
+ *
+ * Each worker has its own queue and steals items from the queues of other
+ * workers once its own is empty. Workers may push items while running.
+ * Exceptions thrown by the function are rethrown by `run_all` once all items
+ * are processed.
+ */
+template <typename Input>
+class WorkQueue final {
+ public:
+  class WorkerState final {
+   public:
+    WorkerState(WorkQueue& queue, unsigned int worker_id)
+        : queue_(queue), worker_id_(worker_id) {}
+
+    unsigned int worker_id() const {
+      return worker_id_;
+    }
+
+    void push_task(Input input) {
+      queue_.add_item(std::move(input), worker_id_);
+    }
+
+   private:
+    WorkQueue& queue_;
+    unsigned int worker_id_;
+  };
+
+  using Function = std::function<void(WorkerState*, Input)>;
+
+ public:
+  WorkQueue(
+      WorkerPool* MT_NULLABLE pool,
+      Function function,
+      unsigned int threads)
+      : pool_(pool), function_(std::move(function)) {
+    if (threads == 0) {
+      threads = 1;
+    }
+    for (unsigned int worker = 0; worker < threads; worker++) {
+      workers_.push_back(std::make_unique<Worker>());
+    }
+  }
+
+  WorkQueue(
+      WorkerPool* MT_NULLABLE pool,
+      std::function<void(Input)> function,
+      unsigned int threads)
+      : WorkQueue(
+            pool,
+            Function([function = std::move(function)](
+                         WorkerState* /* worker_state */, Input input) {
+              function(std::move(input));
+            }),
+            threads) {}
+
+  WorkQueue(const WorkQueue&) = delete;
+  WorkQueue(WorkQueue&&) = delete;
+  WorkQueue& operator=(const WorkQueue&) = delete;
+  WorkQueue& operator=(WorkQueue&&) = delete;
+  ~WorkQueue() = default;
+
+  /* Add an item to the queues of the workers in a round robin fashion. */
+  void add_item(Input input) {
+    auto worker = next_worker_.fetch_add(1, std::memory_order_relaxed);
+    add_item(std::move(input), worker);
+  }
+
+  void add_item(Input input, std::size_t worker_id) {
+    pending_.fetch_add(1, std::memory_order_release);
+    auto& worker = *workers_[worker_id % workers_.size()];
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    worker.items.push_back(std::move(input));
+  }
+
+  /* Process all items, including the ones pushed by workers. */
+  void run_all() {
+    auto threads = static_cast<unsigned int>(workers_.size());
+    std::function<void(unsigned int)> work = [this](unsigned int worker_id) {
+      this->work(worker_id);
+    };
+    if (threads == 1) {
+      work(0);
+    } else if (pool_ == nullptr || !pool_->try_run(threads, work)) {
+      std::vector<std::thread> own_threads;
+      for (unsigned int worker_id = 0; worker_id < threads; worker_id++) {
+        own_threads.emplace_back(work, worker_id);
+      }
+      for (auto& thread : own_threads) {
+        thread.join();
+      }
+    }
+
+    if (exception_ != nullptr) {
+      std::rethrow_exception(exception_);
+    }
+  }
+
+ private:
+  struct Worker {
+    std::mutex mutex;
+    std::deque<Input> items;
+  };
+
+  /* Take an item from the given worker, from the back if `steal` is true. */
+  bool take(std::size_t worker_id, bool steal, Input& input) {
+    auto& worker = *workers_[worker_id];
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    if (worker.items.empty()) {
+      return false;
+    }
+    if (steal) {
+      input = std::move(worker.items.back());
+      worker.items.pop_back();
+    } else {
+      input = std::move(worker.items.front());
+      worker.items.pop_front();
+    }
+    return true;
+  }
+
+  bool take_or_steal(unsigned int worker_id, Input& input) {
+    if (take(worker_id, /* steal */ false, input)) {
+      return true;
+    }
+    for (std::size_t offset = 1; offset < workers_.size(); offset++) {
+      auto victim = (worker_id + offset) % workers_.size();
+      if (take(victim, /* steal */ true, input)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void work(unsigned int worker_id) {
+    WorkerState state(*this, worker_id);
+    Input input;
+    // Items are only done once processed, since processing an item may push
+    // new ones.
+    while (pending_.load(std::memory_order_acquire) > 0) {
+      if (!take_or_steal(worker_id, input)) {
+        std::this_thread::yield();
+        continue;
+      }
+      try {
+        function_(&state, std::move(input));
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(exception_mutex_);
+        if (exception_ == nullptr) {
+          exception_ = std::current_exception();
+        }
+      }
+      pending_.fetch_sub(1, std::memory_order_acq_rel);
+    }
+  }
+
+ private:
+  WorkerPool* MT_NULLABLE pool_;
+  Function function_;
+  std::vector<std::unique_ptr<Worker>> workers_;
+  std::atomic<std::size_t> next_worker_ = 0;
+  std::atomic<std::size_t> pending_ = 0;
+  std::mutex exception_mutex_;
+  std::exception_ptr exception_;
+};
+
+} // namespace marianatrench
@@ -0,0 +1,158 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <set>
+
+#include <fmt/format.h>
+
+#include <Show.h>
+
+#include <mariana-trench/Assert.h>
+#include <mariana-trench/WorkerSampler.h>
+
+namespace marianatrench {
+
+WorkerSampler::WorkerSampler(
+    std::size_t workers,
+    std::chrono::milliseconds interval)
+    : workers_(workers),
+      interval_(interval),
+      creation_(std::chrono::steady_clock::now()),
+      methods_(std::make_unique<std::atomic<const Method*>[]>(workers)),
+      iteration_(0),
+      open_segments_(workers),
+      running_(false) {
+  for (std::size_t worker = 0; worker < workers_; worker++) {
+    methods_[worker].store(nullptr, std::memory_order_relaxed);
+  }
+}
+
+WorkerSampler::~WorkerSampler() {
+  stop();
+}
+
+void WorkerSampler::start() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (running_) {
+    return;
+  }
+  running_ = true;
+  thread_ = std::thread([this]() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!condition_.wait_for(
+        lock, interval_, [this]() { return !running_; })) {
+      sample();
+    }
+  });
+}
+
+void WorkerSampler::stop() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    running_ = false;
+  }
+  condition_.notify_all();
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+
+  auto end = now();
+  for (auto& segment : open_segments_) {
+    if (segment) {
+      segment->end = end;
+      segments_.push_back(*segment);
+      segment.reset();
+    }
+  }
+}
+
+void WorkerSampler::set_iteration(std::size_t iteration) {
+  iteration_.store(iteration, std::memory_order_relaxed);
+}
+
+void WorkerSampler::set_method(
+    std::size_t worker,
+    const Method* MT_NULLABLE method) {
+  mt_assert(worker < workers_);
+  methods_[worker].store(method, std::memory_order_relaxed);
+}
+
+void WorkerSampler::sample() {
+  auto time = now();
+  auto iteration = iteration_.load(std::memory_order_relaxed);
+  for (std::size_t worker = 0; worker < workers_; worker++) {
+    const auto* method = methods_[worker].load(std::memory_order_relaxed);
+    auto& segment = open_segments_[worker];
+    if (segment &&
+        (segment->method != method || segment->iteration != iteration)) {
+      segment->end = time;
+      segments_.push_back(*segment);
+      segment.reset();
+    }
+    if (segment) {
+      segment->end = time;
+    } else if (method != nullptr) {
+      segment = Segment{worker, method, iteration, time, time};
+    }
+  }
+}
+
+Json::Value WorkerSampler::to_json() const {
+  auto events = Json::Value(Json::arrayValue);
+
+  std::set<std::size_t> iterations;
+  for (const auto& segment : segments_) {
+    iterations.insert(segment.iteration);
+  }
+  for (auto iteration : iterations) {
+    auto process = Json::Value(Json::objectValue);
+    process["name"] = "process_name";
+    process["ph"] = "M";
+    process["pid"] = Json::Value(static_cast<Json::UInt64>(iteration));
+    process["args"]["name"] = iteration == 0
+        ? std::string("Global fixpoint")
+        : fmt::format("Global iteration {}", iteration);
+    events.append(process);
+
+    for (std::size_t worker = 0; worker < workers_; worker++) {
+      auto thread = Json::Value(Json::objectValue);
+      thread["name"] = "thread_name";
+      thread["ph"] = "M";
+      thread["pid"] = Json::Value(static_cast<Json::UInt64>(iteration));
+      thread["tid"] = Json::Value(static_cast<Json::UInt64>(worker));
+      thread["args"]["name"] = fmt::format("Worker {}", worker);
+      events.append(thread);
+    }
+  }
+
+  for (const auto& segment : segments_) {
+    auto event = Json::Value(Json::objectValue);
+    event["name"] = show(segment.method);
+    event["cat"] = "analysis";
+    event["ph"] = "X";
+    event["pid"] = Json::Value(static_cast<Json::UInt64>(segment.iteration));
+    event["tid"] = Json::Value(static_cast<Json::UInt64>(segment.worker));
+    event["ts"] = Json::Value(static_cast<Json::UInt64>(segment.start));
+    event["dur"] =
+        Json::Value(static_cast<Json::UInt64>(segment.end - segment.start));
+    events.append(event);
+  }
+
+  auto value = Json::Value(Json::objectValue);
+  value["traceEvents"] = events;
+  value["displayTimeUnit"] = "ms";
+  return value;
+}
+
+std::uint64_t WorkerSampler::now() const {
+  return static_cast<std::uint64_t>(
+      std::chrono::duration_cast<std::chrono::microseconds>(
+          std::chrono::steady_clock::now() - creation_)
+          .count());
+}
+
+} // namespace marianatrench
@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include <json/json.h>
+
+#include <mariana-trench/Compiler.h>
+#include <mariana-trench/Method.h>
+
+namespace marianatrench {
+
+/**
+ * Periodically sample the method analyzed by each worker of the global
+ * fixpoint, when `--worker-timeline-interval-in-milliseconds` is used.
+ *
+ * Workers only publish the method they are analyzing in an atomic slot, the
+ * sampling thread does all the bookkeeping. Consecutive samples of the same
+ * method on a worker are merged into a single segment, hence durations are
+ * precise up to the sampling interval.
+ */
+class WorkerSampler final {
+ public:
+  WorkerSampler(std::size_t workers, std::chrono::milliseconds interval);
+  WorkerSampler(const WorkerSampler&) = delete;
+  WorkerSampler(WorkerSampler&&) = delete;
+  WorkerSampler& operator=(const WorkerSampler&) = delete;
+  WorkerSampler& operator=(WorkerSampler&&) = delete;
+  ~WorkerSampler();
+
+  /* Start the sampling thread. */
+  void start();
+
+  /* Stop the sampling thread and close all segments. */
+  void stop();
+
+  /* Set the current global iteration. Thread-safe. */
+  void set_iteration(std::size_t iteration);
+
+  /* Set the method analyzed by the given worker, if any. Thread-safe. */
+  void set_method(std::size_t worker, const Method* MT_NULLABLE method);
+
+  /* Take a sample. This is called periodically by the sampling thread. */
+  void sample();
+
+  /**
+   * Return the timeline in the Chrome trace event format, with one process
+   * per global iteration and one thread per worker. This is only valid once
+   * the sampler is stopped.
+   */
+  Json::Value to_json() const;
+
+ private:
+  struct Segment {
+    std::size_t worker;
+    const Method* method;
+    std::size_t iteration;
+    // Microseconds since the creation of the sampler.
+    std::uint64_t start;
+    std::uint64_t end;
+  };
+
+  std::uint64_t now() const;
+
+ private:
+  std::size_t workers_;
+  std::chrono::milliseconds interval_;
+  std::chrono::time_point<std::chrono::steady_clock> creation_;
+  std::unique_ptr<std::atomic<const Method*>[]> methods_;
+  std::atomic<std::size_t> iteration_;
+
+  // Only accessed by the sampling thread while it is running.
+  std::vector<std::optional<Segment>> open_segments_;
+  std::vector<Segment> segments_;
+
+  std::mutex mutex_;
+  std::condition_variable condition_;
+  bool running_;
+  std::thread thread_;
+};
+
+/**
+ * Publish the method analyzed by a worker in the current scope, if the
+ * sampler is enabled.
+ */
+class WorkerSampleScope final {
+ public:
+  WorkerSampleScope(
+      WorkerSampler* MT_NULLABLE sampler,
+      std::size_t worker,
+      const Method* method)
+      : sampler_(sampler), worker_(worker) {
+    if (sampler_ != nullptr) {
+      sampler_->set_method(worker_, method);
+    }
+  }
+
+  WorkerSampleScope(const WorkerSampleScope&) = delete;
+  WorkerSampleScope(WorkerSampleScope&&) = delete;
+  WorkerSampleScope& operator=(const WorkerSampleScope&) = delete;
+  WorkerSampleScope& operator=(WorkerSampleScope&&) = delete;
+
+  ~WorkerSampleScope() {
+    if (sampler_ != nullptr) {
+      sampler_->set_method(worker_, nullptr);
+    }
+  }
+
+ private:
+  WorkerSampler* MT_NULLABLE sampler_;
+  std::size_t worker_;
+};
+
+} // namespace marianatrench
@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include <mariana-trench/TaintTree.h>
+#include <mariana-trench/benchmarks/Benchmark.h>
+
+namespace marianatrench {
+namespace benchmarks {
+
+namespace {
+
+constexpr std::size_t kMaximumPathSize = 4;
+constexpr std::size_t kMaximumTaintSize = 16;
+
+/* Return a tree with `writes` weak writes of small taint at random paths. */
+TaintTree make_tree(Environment& environment, std::size_t writes) {
+  TaintTree tree;
+  for (std::size_t i = 0; i < writes; i++) {
+    tree.write(
+        environment.random_path(kMaximumPathSize),
+        environment.random_taint(environment.random_size(kMaximumTaintSize)),
+        UpdateKind::Weak);
+  }
+  return tree;
+}
+
+} // namespace
+
+static void BM_AbstractTreeDomainWrite(::benchmark::State& state) {
+  auto& environment = Environment::get();
+  environment.reset_random();
+  std::vector<std::pair<Path, Taint>> writes;
+  for (std::int64_t i = 0; i < state.range(0); i++) {
+    writes.emplace_back(
+        environment.random_path(kMaximumPathSize),
+        environment.random_taint(environment.random_size(kMaximumTaintSize)));
+  }
+
+  for (auto _ : state) {
+    TaintTree tree;
+    for (const auto& [path, taint] : writes) {
+      tree.write(path, taint, UpdateKind::Weak);
+    }
+    ::benchmark::DoNotOptimize(tree);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_AbstractTreeDomainWrite)->RangeMultiplier(4)->Range(1, 256);
+
+static void BM_AbstractTreeDomainRead(::benchmark::State& state) {
+  auto& environment = Environment::get();
+  environment.reset_random();
+  auto tree = make_tree(environment, state.range(0));
+  std::vector<Path> paths;
+  for (int i = 0; i < 64; i++) {
+    paths.push_back(environment.random_path(kMaximumPathSize));
+  }
+
+  for (auto _ : state) {
+    for (const auto& path : paths) {
+      ::benchmark::DoNotOptimize(tree.read(path));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * paths.size());
+}
+BENCHMARK(BM_AbstractTreeDomainRead)->RangeMultiplier(4)->Range(1, 256);
+
+static void BM_AbstractTreeDomainJoin(::benchmark::State& state) {
+  auto& environment = Environment::get();
+  environment.reset_random();
+  auto left = make_tree(environment, state.range(0));
+  auto right = make_tree(environment, state.range(0));
+
+  for (auto _ : state) {
+    auto tree = left;
+    tree.join_with(right);
+    ::benchmark::DoNotOptimize(tree);
+  }
+}
+BENCHMARK(BM_AbstractTreeDomainJoin)->RangeMultiplier(4)->Range(1, 256);
+
+/* Join of a tree with a subset of itself, the common case at fixpoint. */
+static void BM_AbstractTreeDomainJoinStable(::benchmark::State& state) {
+  auto& environment = Environment::get();
+  environment.reset_random();
+  auto tree = make_tree(environment, state.range(0));
+  environment.reset_random();
+  auto subset = make_tree(environment, state.range(0) / 2);
+
+  for (auto _ : state) {
+    auto result = tree;
+    result.join_with(subset);
+    ::benchmark::DoNotOptimize(result);
+  }
+}
+BENCHMARK(BM_AbstractTreeDomainJoinStable)->RangeMultiplier(4)->Range(1, 256);
+
+} // namespace benchmarks
+} // namespace marianatrench
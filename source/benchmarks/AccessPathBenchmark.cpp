@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <functional>
+#include <unordered_set>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include <mariana-trench/Access.h>
+#include <mariana-trench/benchmarks/Benchmark.h>
+
+namespace marianatrench {
+namespace benchmarks {
+
+namespace {
+
+std::vector<AccessPath> make_access_paths(
+    Environment& environment,
+    std::size_t size,
+    std::size_t maximum_path_size) {
+  std::vector<AccessPath> access_paths;
+  for (std::size_t i = 0; i < size; i++) {
+    access_paths.push_back(environment.random_access_path(maximum_path_size));
+  }
+  return access_paths;
+}
+
+} // namespace
+
+static void BM_AccessPathHash(::benchmark::State& state) {
+  auto& environment = Environment::get();
+  environment.reset_random();
+  auto access_paths = make_access_paths(
+      environment, 1024, /* maximum_path_size */ state.range(0));
+
+  for (auto _ : state) {
+    for (const auto& access_path : access_paths) {
+      ::benchmark::DoNotOptimize(std::hash<AccessPath>()(access_path));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * access_paths.size());
+}
+BENCHMARK(BM_AccessPathHash)->DenseRange(0, 8, 2);
+
+static void BM_AccessPathHashSetInsert(::benchmark::State& state) {
+  auto& environment = Environment::get();
+  environment.reset_random();
+  auto access_paths = make_access_paths(
+      environment, state.range(0), /* maximum_path_size */ 4);
+
+  for (auto _ : state) {
+    std::unordered_set<AccessPath> set;
+    for (const auto& access_path : access_paths) {
+      set.insert(access_path);
+    }
+    ::benchmark::DoNotOptimize(set);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_AccessPathHashSetInsert)->RangeMultiplier(4)->Range(1, 1024);
+
+} // namespace benchmarks
+} // namespace marianatrench
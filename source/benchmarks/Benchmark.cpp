@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <algorithm>
+#include <string>
+
+#include <fmt/format.h>
+
+#include <mariana-trench/Redex.h>
+#include <mariana-trench/benchmarks/Benchmark.h>
+
+namespace marianatrench {
+namespace benchmarks {
+
+Environment::Environment()
+    : store_("stores"), context_(test::make_context(store_)) {
+  for (std::size_t i = 0; i < kMethods; i++) {
+    methods_.push_back(context_.methods->create(redex::create_void_method(
+        scope_,
+        /* class_name */ fmt::format("LClass{};", i % 16),
+        /* method_name */ fmt::format("method{}", i),
+        /* parameter_types */ "Ljava/lang/Object;Ljava/lang/Object;",
+        /* return_type */ "Ljava/lang/Object;")));
+  }
+  for (std::size_t i = 0; i < kKinds; i++) {
+    kinds_.push_back(context_.kinds->get(fmt::format("Kind{}", i)));
+  }
+  for (std::size_t i = 0; i < kPositions; i++) {
+    positions_.push_back(context_.positions->get(
+        fmt::format("Class{}.java", i % 16), static_cast<int>(i)));
+  }
+  for (std::size_t i = 0; i < kFeatures; i++) {
+    features_.push_back(context_.features->get(fmt::format("feature{}", i)));
+  }
+  for (std::size_t i = 0; i < kFields; i++) {
+    fields_.push_back(DexString::make_string(fmt::format("field{}", i)));
+  }
+}
+
+Environment& Environment::get() {
+  // Never destroyed: benchmarks may run until the process exits.
+  static auto* environment = new Environment();
+  return *environment;
+}
+
+void Environment::reset_random(unsigned seed) {
+  random_.seed(seed);
+}
+
+std::size_t Environment::random_size(std::size_t maximum) {
+  std::geometric_distribution<std::size_t> distribution(/* p */ 0.3);
+  return std::min(distribution(random_) + 1, std::max<std::size_t>(maximum, 1));
+}
+
+const Method* Environment::random_method() {
+  return methods_[random_() % methods_.size()];
+}
+
+const Kind* Environment::random_kind() {
+  return kinds_[random_() % kinds_.size()];
+}
+
+const Position* Environment::random_position() {
+  return positions_[random_() % positions_.size()];
+}
+
+const Feature* Environment::random_feature() {
+  return features_[random_() % features_.size()];
+}
+
+Path Environment::random_path(std::size_t maximum_size) {
+  Path path;
+  if (maximum_size == 0) {
+    return path;
+  }
+  // Most access paths are short, a third of them have no path at all.
+  auto size = random_size(maximum_size + 1) - 1;
+  for (std::size_t i = 0; i < size; i++) {
+    path.append(fields_[random_() % fields_.size()]);
+  }
+  return path;
+}
+
+AccessPath Environment::random_access_path(std::size_t maximum_path_size) {
+  auto root = random_() % 4 == 0
+      ? Root(Root::Kind::Return)
+      : Root(Root::Kind::Argument, random_() % 3);
+  return AccessPath(root, random_path(maximum_path_size));
+}
+
+Frame Environment::random_frame(bool leaf) {
+  auto inferred_features = FeatureMayAlwaysSet::make_may({random_feature()});
+  if (random_() % 2 == 0) {
+    inferred_features.add_always(random_feature());
+  }
+
+  if (leaf) {
+    return test::make_frame(
+        random_kind(),
+        test::FrameProperties{
+            .origins = MethodSet{random_method()},
+            .inferred_features = inferred_features});
+  }
+
+  auto origins = MethodSet{};
+  for (std::size_t i = 0, size = random_size(8); i < size; i++) {
+    origins.add(random_method());
+  }
+  return test::make_frame(
+      random_kind(),
+      test::FrameProperties{
+          .callee_port = AccessPath(Root(Root::Kind::Argument, random_() % 3)),
+          .callee = random_method(),
+          .call_position = random_position(),
+          .distance = static_cast<int>(random_size(5)),
+          .origins = origins,
+          .inferred_features = inferred_features});
+}
+
+Taint Environment::random_taint(std::size_t frames) {
+  Taint taint;
+  for (std::size_t i = 0; i < frames; i++) {
+    // A quarter of the frames are leaves, i.e have no callee.
+    taint.add(random_frame(/* leaf */ random_() % 4 == 0));
+  }
+  return taint;
+}
+
+} // namespace benchmarks
+} // namespace marianatrench
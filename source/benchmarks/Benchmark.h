@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <random>
+#include <vector>
+
+#include <DexClass.h>
+#include <DexStore.h>
+
+#include <mariana-trench/Access.h>
+#include <mariana-trench/Context.h>
+#include <mariana-trench/Frame.h>
+#include <mariana-trench/Taint.h>
+#include <mariana-trench/tests/Test.h>
+
+namespace marianatrench {
+namespace benchmarks {
+
+/**
+ * Shared state for the benchmarks, with a pool of methods, kinds, positions,
+ * features and field names used to generate synthetic abstract values.
+ *
+ * Random generators are seeded with a constant, hence inputs are identical
+ * across runs and results can be compared between builds.
+ *
+ * Sizes follow a geometric distribution: most generated values are small, a
+ * few are large, which matches what we observe on real applications.
+ */
+class Environment final {
+ private:
+  Environment();
+
+ public:
+  Environment(const Environment&) = delete;
+  Environment(Environment&&) = delete;
+  Environment& operator=(const Environment&) = delete;
+  Environment& operator=(Environment&&) = delete;
+  ~Environment() = delete;
+
+  static Environment& get();
+
+  Context& context() {
+    return context_;
+  }
+
+  /* Reset the random generator, to generate the same inputs again. */
+  void reset_random(unsigned seed = 0);
+
+  /* Return a size in [1, maximum], skewed towards small sizes. */
+  std::size_t random_size(std::size_t maximum);
+
+  const Method* random_method();
+  const Kind* random_kind();
+  const Position* random_position();
+  const Feature* random_feature();
+
+  /* Return a path of at most `maximum_size` fields. */
+  Path random_path(std::size_t maximum_size);
+
+  AccessPath random_access_path(std::size_t maximum_path_size);
+
+  /* Return a leaf frame if `leaf` is true, otherwise a frame with a callee. */
+  Frame random_frame(bool leaf);
+
+  /* Return a taint with `frames` frames, distributed over a few callees. */
+  Taint random_taint(std::size_t frames);
+
+  static constexpr std::size_t kMethods = 256;
+  static constexpr std::size_t kKinds = 32;
+  static constexpr std::size_t kPositions = 128;
+  static constexpr std::size_t kFeatures = 32;
+  static constexpr std::size_t kFields = 64;
+
+ private:
+  test::ContextGuard guard_;
+  Scope scope_;
+  DexStore store_;
+  Context context_;
+  std::vector<const Method*> methods_;
+  std::vector<const Kind*> kinds_;
+  std::vector<const Position*> positions_;
+  std::vector<const Feature*> features_;
+  std::vector<const DexString*> fields_;
+  std::mt19937 random_;
+};
+
+} // namespace benchmarks
+} // namespace marianatrench
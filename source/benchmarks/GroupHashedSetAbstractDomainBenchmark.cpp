@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include <mariana-trench/Frame.h>
+#include <mariana-trench/GroupHashedSetAbstractDomain.h>
+#include <mariana-trench/benchmarks/Benchmark.h>
+
+namespace marianatrench {
+namespace benchmarks {
+
+namespace {
+
+using FrameGroupSet =
+    GroupHashedSetAbstractDomain<Frame, Frame::GroupHash, Frame::GroupEqual>;
+
+std::vector<Frame> make_frames(Environment& environment, std::size_t size) {
+  std::vector<Frame> frames;
+  for (std::size_t i = 0; i < size; i++) {
+    frames.push_back(environment.random_frame(/* leaf */ false));
+  }
+  return frames;
+}
+
+FrameGroupSet make_set(const std::vector<Frame>& frames) {
+  FrameGroupSet set;
+  for (const auto& frame : frames) {
+    set.add(frame);
+  }
+  return set;
+}
+
+} // namespace
+
+static void BM_GroupHashedSetAdd(::benchmark::State& state) {
+  auto& environment = Environment::get();
+  environment.reset_random();
+  auto frames = make_frames(environment, state.range(0));
+
+  for (auto _ : state) {
+    ::benchmark::DoNotOptimize(make_set(frames));
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_GroupHashedSetAdd)->RangeMultiplier(4)->Range(1, 1024);
+
+static void BM_GroupHashedSetJoin(::benchmark::State& state) {
+  auto& environment = Environment::get();
+  environment.reset_random();
+  auto left = make_set(make_frames(environment, state.range(0)));
+  auto right = make_set(make_frames(environment, state.range(0)));
+
+  for (auto _ : state) {
+    auto set = left;
+    set.join_with(right);
+    ::benchmark::DoNotOptimize(set);
+  }
+}
+BENCHMARK(BM_GroupHashedSetJoin)->RangeMultiplier(4)->Range(1, 1024);
+
+static void BM_GroupHashedSetLeq(::benchmark::State& state) {
+  auto& environment = Environment::get();
+  environment.reset_random();
+  auto frames = make_frames(environment, state.range(0));
+  auto set = make_set(frames);
+  frames.resize(frames.size() / 2);
+  auto subset = make_set(frames);
+
+  for (auto _ : state) {
+    ::benchmark::DoNotOptimize(subset.leq(set));
+    ::benchmark::DoNotOptimize(set.leq(subset));
+  }
+}
+BENCHMARK(BM_GroupHashedSetLeq)->RangeMultiplier(4)->Range(1, 1024);
+
+static void BM_GroupHashedSetContains(::benchmark::State& state) {
+  auto& environment = Environment::get();
+  environment.reset_random();
+  auto frames = make_frames(environment, state.range(0));
+  auto set = make_set(frames);
+
+  for (auto _ : state) {
+    for (const auto& frame : frames) {
+      ::benchmark::DoNotOptimize(set.contains(frame));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_GroupHashedSetContains)->RangeMultiplier(4)->Range(1, 1024);
+
+} // namespace benchmarks
+} // namespace marianatrench
@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <mariana-trench/Model.h>
+#include <mariana-trench/benchmarks/Benchmark.h>
+
+namespace marianatrench {
+namespace benchmarks {
+
+namespace {
+
+constexpr std::size_t kMaximumPathSize = 2;
+constexpr std::size_t kMaximumTaintSize = 16;
+
+/* Return a model with `ports` generations and sinks. */
+Model make_model(Environment& environment, std::size_t ports) {
+  auto& context = environment.context();
+  const auto* method = environment.random_method();
+  Model model(method, context, Model::Mode::OverrideDefault);
+  for (std::size_t i = 0; i < ports; i++) {
+    model.add_generations(
+        AccessPath(
+            Root(Root::Kind::Return),
+            environment.random_path(kMaximumPathSize)),
+        environment.random_taint(environment.random_size(kMaximumTaintSize)));
+    model.add_sinks(
+        AccessPath(
+            Root(Root::Kind::Argument, i % 3),
+            environment.random_path(kMaximumPathSize)),
+        environment.random_taint(environment.random_size(kMaximumTaintSize)));
+  }
+  return model;
+}
+
+} // namespace
+
+static void BM_ModelAtCallsite(::benchmark::State& state) {
+  auto& environment = Environment::get();
+  environment.reset_random();
+  auto& context = environment.context();
+  auto model = make_model(environment, state.range(0));
+  const auto* caller = environment.random_method();
+  const auto* position = environment.random_position();
+
+  for (auto _ : state) {
+    ::benchmark::DoNotOptimize(model.at_callsite(
+        caller,
+        position,
+        context,
+        /* source_register_types */ {},
+        /* source_constant_arguments */ {}));
+  }
+}
+BENCHMARK(BM_ModelAtCallsite)->RangeMultiplier(2)->Range(1, 32);
+
+} // namespace benchmarks
+} // namespace marianatrench
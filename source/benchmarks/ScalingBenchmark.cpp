@@ -0,0 +1,236 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+#include <boost/filesystem.hpp>
+#include <fmt/format.h>
+
+#include <DexStore.h>
+#include <RedexContext.h>
+
+#include <mariana-trench/Context.h>
+#include <mariana-trench/JsonValidation.h>
+#include <mariana-trench/MarianaTrench.h>
+#include <mariana-trench/OperatingSystem.h>
+#include <mariana-trench/Options.h>
+#include <mariana-trench/Statistics.h>
+#include <mariana-trench/Timer.h>
+#include <mariana-trench/benchmarks/SyntheticProgram.h>
+
+namespace marianatrench {
+namespace benchmarks {
+
+/**
+ * Run the whole analysis on synthetic programs.
+ *
+ * Each iteration generates a fresh program, hence only the analysis itself is
+ * timed. The durations of the phases recorded in `Statistics` and the resident
+ * set size are reported as counters. Note that the resident set size is the
+ * maximum over the process, run a single benchmark (see `--benchmark_filter`)
+ * to get the peak memory usage of a given configuration.
+ */
+class ScalingBenchmark final {
+ public:
+  static void run(
+      ::benchmark::State& state,
+      const SyntheticProgramConfiguration& configuration,
+      unsigned int jobs) {
+    for (auto _ : state) {
+      state.SetIterationTime(analyze(state, configuration, jobs));
+    }
+    state.counters["methods"] = static_cast<double>(configuration.methods);
+    state.counters["jobs"] = jobs;
+  }
+
+ private:
+  class RedexContextScope final {
+   public:
+    RedexContextScope() : previous_(g_redex) {
+      g_redex = new RedexContext();
+    }
+    RedexContextScope(const RedexContextScope&) = delete;
+    RedexContextScope(RedexContextScope&&) = delete;
+    RedexContextScope& operator=(const RedexContextScope&) = delete;
+    RedexContextScope& operator=(RedexContextScope&&) = delete;
+    ~RedexContextScope() {
+      delete g_redex;
+      g_redex = previous_;
+    }
+
+   private:
+    RedexContext* previous_;
+  };
+
+  /* Return the duration of the analysis, in seconds. */
+  static double analyze(
+      ::benchmark::State& state,
+      const SyntheticProgramConfiguration& configuration,
+      unsigned int jobs) {
+    auto directory = boost::filesystem::temp_directory_path() /
+        boost::filesystem::unique_path("mariana-trench-benchmark-%%%%%%%%");
+    boost::filesystem::create_directories(directory);
+    auto models_path = directory / "models.json";
+    auto rules_path = directory / "rules.json";
+    JsonValidation::write_json_file(models_path, synthetic_program_models());
+    JsonValidation::write_json_file(rules_path, synthetic_program_rules());
+
+    double duration = 0.0;
+    {
+      // Use a fresh Redex context, but restore the one of other benchmarks.
+      RedexContextScope redex_context;
+
+      Scope scope;
+      generate_synthetic_program(scope, configuration);
+      DexMetadata metadata;
+      metadata.set_id("classes");
+      DexStore store(metadata);
+      store.add_classes(scope);
+
+      Context context;
+      context.options = std::make_unique<Options>(
+          /* models_paths */ std::vector<std::string>{models_path.native()},
+          /* field_models_path */ std::vector<std::string>{},
+          /* rules_paths */ std::vector<std::string>{rules_path.native()},
+          /* lifecycles_paths */ std::vector<std::string>{},
+          /* proguard_configuration_paths */ std::vector<std::string>{},
+          /* sequential */ false,
+          /* skip_source_indexing */ true,
+          /* skip_model_generation */ true,
+          /* model_generators_configuration */
+          std::vector<ModelGeneratorConfiguration>{},
+          /* model_generator_search_paths */ std::vector<std::string>{},
+          /* remove_unreachable_code */ false,
+          /* source_root_directory */ ".",
+          /* jobs */ jobs);
+      context.stores.push_back(store);
+
+      Timer timer;
+      auto registry = MarianaTrench().analyze(context);
+      duration = timer.duration_in_seconds();
+
+      auto statistics = context.statistics->to_json();
+      for (const auto& phase : statistics["times"].getMemberNames()) {
+        state.counters[phase] = ::benchmark::Counter(
+            statistics["times"][phase].asDouble(),
+            ::benchmark::Counter::kAvgIterations);
+      }
+      state.counters["iterations"] = ::benchmark::Counter(
+          statistics["iterations"].asDouble(),
+          ::benchmark::Counter::kAvgIterations);
+      state.counters["rss_gb"] = std::max(
+          statistics["rss"].asDouble(), resident_set_size_in_gb());
+    }
+
+    boost::filesystem::remove_all(directory);
+    return duration;
+  }
+};
+
+namespace {
+
+constexpr std::size_t kStrongScalingMethods = 20000;
+constexpr std::size_t kWeakScalingMethodsPerJob = 5000;
+
+/* Thread counts from 1 to the number of cores, in powers of 2. */
+std::vector<unsigned int> thread_counts() {
+  std::vector<unsigned int> counts;
+  auto cores = std::max(1u, std::thread::hardware_concurrency());
+  for (unsigned int jobs = 1; jobs < cores; jobs *= 2) {
+    counts.push_back(jobs);
+  }
+  counts.push_back(cores);
+  return counts;
+}
+
+void register_benchmark(
+    const std::string& name,
+    const SyntheticProgramConfiguration& configuration,
+    unsigned int jobs) {
+  ::benchmark::RegisterBenchmark(
+      name.c_str(),
+      [configuration, jobs](::benchmark::State& state) {
+        ScalingBenchmark::run(state, configuration, jobs);
+      })
+      ->Iterations(1)
+      ->UseManualTime()
+      ->Unit(::benchmark::kSecond);
+}
+
+/* Register the benchmarks before `main` parses the command line. */
+[[maybe_unused]] const bool registered = []() {
+  auto cores = std::max(1u, std::thread::hardware_concurrency());
+
+  // Strong scaling: same program, increasing number of threads.
+  for (auto jobs : thread_counts()) {
+    auto configuration = SyntheticProgramConfiguration{};
+    configuration.methods = kStrongScalingMethods;
+    configuration.scc_size = 4;
+    configuration.virtual_fan_out = 8;
+    register_benchmark(
+        fmt::format("BM_ScalingStrong/jobs:{}", jobs), configuration, jobs);
+  }
+
+  // Weak scaling: the size of the program grows with the number of threads.
+  for (auto jobs : thread_counts()) {
+    auto configuration = SyntheticProgramConfiguration{};
+    configuration.methods = kWeakScalingMethodsPerJob * jobs;
+    configuration.scc_size = 4;
+    configuration.virtual_fan_out = 8;
+    register_benchmark(
+        fmt::format("BM_ScalingWeak/jobs:{}", jobs), configuration, jobs);
+  }
+
+  // Shape of the call graph, on all cores.
+  for (std::size_t scc_size : {1, 16, 256}) {
+    auto configuration = SyntheticProgramConfiguration{};
+    configuration.methods = kStrongScalingMethods;
+    configuration.scc_size = scc_size;
+    register_benchmark(
+        fmt::format("BM_ScalingSccSize/scc_size:{}", scc_size),
+        configuration,
+        cores);
+  }
+  for (std::size_t virtual_fan_out : {1, 16, 128}) {
+    auto configuration = SyntheticProgramConfiguration{};
+    configuration.methods = kStrongScalingMethods;
+    configuration.virtual_fan_out = virtual_fan_out;
+    register_benchmark(
+        fmt::format("BM_ScalingVirtualFanOut/fan_out:{}", virtual_fan_out),
+        configuration,
+        cores);
+  }
+  for (std::size_t call_depth : {4, 16, 64}) {
+    auto configuration = SyntheticProgramConfiguration{};
+    configuration.methods = kStrongScalingMethods;
+    configuration.call_depth = call_depth;
+    register_benchmark(
+        fmt::format("BM_ScalingCallDepth/depth:{}", call_depth),
+        configuration,
+        cores);
+  }
+  for (double taint_density : {0.01, 0.1, 0.5}) {
+    auto configuration = SyntheticProgramConfiguration{};
+    configuration.methods = kStrongScalingMethods;
+    configuration.taint_density = taint_density;
+    register_benchmark(
+        fmt::format("BM_ScalingTaintDensity/density:{}", taint_density),
+        configuration,
+        cores);
+  }
+  return true;
+}();
+
+} // namespace
+
+} // namespace benchmarks
+} // namespace marianatrench
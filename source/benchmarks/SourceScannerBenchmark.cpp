@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <string_view>
+
+#include <benchmark/benchmark.h>
+#include <boost/algorithm/string.hpp>
+#include <boost/filesystem.hpp>
+
+#include <mariana-trench/SourceScanner.h>
+
+namespace marianatrench {
+namespace benchmarks {
+
+namespace {
+
+// Maximum number of bytes of sources to scan.
+constexpr std::size_t kMaximumBytes = 64 * 1024 * 1024;
+
+/**
+ * Return the Java and Kotlin files under `MT_BENCHMARK_SOURCE_ROOT` (e.g a
+ * checkout of an application), concatenated, or a synthetic Java source if
+ * the variable is not set.
+ */
+const std::string& sources() {
+  static const std::string sources = []() {
+    std::string content;
+    const char* root = std::getenv("MT_BENCHMARK_SOURCE_ROOT");
+    if (root != nullptr) {
+      for (const auto& entry :
+           boost::filesystem::recursive_directory_iterator(root)) {
+        auto path = entry.path().string();
+        if (!boost::filesystem::is_regular_file(entry.status()) ||
+            !(boost::ends_with(path, ".java") ||
+              boost::ends_with(path, ".kt"))) {
+          continue;
+        }
+        std::ifstream file(path);
+        content.append(
+            std::istreambuf_iterator<char>(file),
+            std::istreambuf_iterator<char>());
+        if (content.size() >= kMaximumBytes) {
+          break;
+        }
+      }
+      return content;
+    }
+
+    std::mt19937 random(0);
+    const std::string_view lines[] = {
+        "    private static final String TAG = \"Benchmark\";",
+        "    @Override",
+        "    public void onCreate(Bundle savedInstanceState) {",
+        "      super.onCreate(savedInstanceState);",
+        "      Intent intent = getIntent();",
+        "      String result = intent.getStringExtra(\"extra\");",
+        "      if (result == null) {",
+        "        return;",
+        "      }",
+        "    }",
+        "    // Returns the current state of the activity.",
+        "",
+    };
+    while (content.size() < kMaximumBytes / 4) {
+      content.append("package com.facebook.benchmark;\n\n");
+      content.append("import android.os.Bundle;\n");
+      content.append("public class Activity extends BaseActivity {\n");
+      for (int line = 0; line < 200; line++) {
+        content.append(lines[random() % std::size(lines)]);
+        content.push_back('\n');
+      }
+      content.append("}\n");
+    }
+    return content;
+  }();
+  return sources;
+}
+
+} // namespace
+
+static void BM_SourceScannerLineOffsets(::benchmark::State& state) {
+  const auto& content = sources();
+  for (auto _ : state) {
+    ::benchmark::DoNotOptimize(source_scanner::line_offsets(content));
+  }
+  state.SetBytesProcessed(state.iterations() * content.size());
+}
+BENCHMARK(BM_SourceScannerLineOffsets)->Unit(::benchmark::kMillisecond);
+
+static void BM_SourceScannerMayDeclareClass(::benchmark::State& state) {
+  const auto& content = sources();
+  auto offsets = source_scanner::line_offsets(content);
+  for (auto _ : state) {
+    std::size_t candidates = 0;
+    for (std::size_t index = 0; index + 1 < offsets.size(); index++) {
+      candidates += source_scanner::may_declare_class(
+          source_scanner::line(content, offsets, index));
+    }
+    ::benchmark::DoNotOptimize(candidates);
+  }
+  state.SetBytesProcessed(state.iterations() * content.size());
+}
+BENCHMARK(BM_SourceScannerMayDeclareClass)->Unit(::benchmark::kMillisecond);
+
+/* The prefilter previously used by the source index, for comparison. */
+static void BM_SourceScannerFindKeywords(::benchmark::State& state) {
+  const auto& content = sources();
+  auto offsets = source_scanner::line_offsets(content);
+  for (auto _ : state) {
+    std::size_t candidates = 0;
+    for (std::size_t index = 0; index + 1 < offsets.size(); index++) {
+      auto line = source_scanner::line(content, offsets, index);
+      candidates += line.find("class") != std::string_view::npos ||
+          line.find("interface") != std::string_view::npos ||
+          line.find("object") != std::string_view::npos ||
+          line.find("enum") != std::string_view::npos;
+    }
+    ::benchmark::DoNotOptimize(candidates);
+  }
+  state.SetBytesProcessed(state.iterations() * content.size());
+}
+BENCHMARK(BM_SourceScannerFindKeywords)->Unit(::benchmark::kMillisecond);
+
+} // namespace benchmarks
+} // namespace marianatrench
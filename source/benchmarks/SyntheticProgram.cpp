@@ -0,0 +1,247 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include <mariana-trench/Assert.h>
+#include <mariana-trench/Redex.h>
+#include <mariana-trench/benchmarks/SyntheticProgram.h>
+
+namespace marianatrench {
+namespace benchmarks {
+
+namespace {
+
+constexpr std::size_t kMethodsPerClass = 16;
+
+const std::string k_source =
+    "Lcom/synthetic/Origin;.source:()Ljava/lang/Object;";
+const std::string k_sink = "Lcom/synthetic/Origin;.sink:(Ljava/lang/Object;)V";
+const std::string k_base_instance =
+    "Lcom/synthetic/Base;.instance:()Lcom/synthetic/Base;";
+const std::string k_base_run =
+    "Lcom/synthetic/Base;.run:(Ljava/lang/Object;)Ljava/lang/Object;";
+
+std::string class_name(std::size_t method) {
+  return fmt::format("Lcom/synthetic/Class{};", method / kMethodsPerClass);
+}
+
+std::string method_signature(std::size_t method) {
+  return fmt::format(
+      "{}.method{}:(Ljava/lang/Object;)Ljava/lang/Object;",
+      class_name(method),
+      method);
+}
+
+void create_origin_class(Scope& scope) {
+  redex::create_methods(
+      scope,
+      "Lcom/synthetic/Origin;",
+      {
+          fmt::format(
+              R"(
+      (method (public static) "{}"
+       (
+        (const v0 0)
+        (return-object v0)
+       )
+      ))",
+              k_source),
+          fmt::format(
+              R"(
+      (method (public static) "{}"
+       (
+        (load-param-object v0)
+        (return-void)
+       )
+      ))",
+              k_sink),
+      });
+}
+
+void create_virtual_classes(
+    Scope& scope,
+    const SyntheticProgramConfiguration& configuration,
+    const std::vector<std::size_t>& targets,
+    std::mt19937& random) {
+  redex::create_methods(
+      scope,
+      "Lcom/synthetic/Base;",
+      {
+          fmt::format(
+              R"(
+      (method (public static) "{}"
+       (
+        (const v0 0)
+        (return-object v0)
+       )
+      ))",
+              k_base_instance),
+          fmt::format(
+              R"(
+      (method (public) "{}"
+       (
+        (load-param-object v0)
+        (load-param-object v1)
+        (return-object v1)
+       )
+      ))",
+              k_base_run),
+      });
+
+  const auto* base = DexType::get_type("Lcom/synthetic/Base;");
+  mt_assert(base != nullptr);
+  for (std::size_t i = 0; i < configuration.virtual_fan_out; i++) {
+    auto override_name = fmt::format("Lcom/synthetic/Override{};", i);
+    redex::create_method(
+        scope,
+        override_name,
+        fmt::format(
+            R"(
+      (method (public) "{}.run:(Ljava/lang/Object;)Ljava/lang/Object;"
+       (
+        (load-param-object v0)
+        (load-param-object v1)
+        (invoke-static (v1) "{}")
+        (move-result-object v1)
+        (return-object v1)
+       )
+      ))",
+            override_name,
+            method_signature(targets[random() % targets.size()])),
+        base);
+  }
+}
+
+} // namespace
+
+void generate_synthetic_program(
+    Scope& scope,
+    const SyntheticProgramConfiguration& configuration) {
+  mt_assert(configuration.methods > 0);
+  mt_assert(configuration.call_depth > 0);
+  mt_assert(configuration.scc_size > 0);
+
+  std::mt19937 random(configuration.seed);
+  std::bernoulli_distribution taint(configuration.taint_density);
+
+  auto layer = [&](std::size_t method) {
+    return (method / configuration.scc_size) % configuration.call_depth;
+  };
+  std::vector<std::vector<std::size_t>> layers(configuration.call_depth);
+  for (std::size_t method = 0; method < configuration.methods; method++) {
+    layers[layer(method)].push_back(method);
+  }
+
+  create_origin_class(scope);
+  bool has_virtual_calls = configuration.virtual_fan_out > 0;
+  if (has_virtual_calls) {
+    auto last_layer = std::find_if(
+        layers.rbegin(), layers.rend(), [](const auto& methods) {
+          return !methods.empty();
+        });
+    create_virtual_classes(scope, configuration, *last_layer, random);
+  }
+
+  std::vector<std::string> bodies;
+  for (std::size_t method = 0; method < configuration.methods; method++) {
+    std::string instructions = "(load-param-object v0)\n(move-object v1 v0)\n";
+    if (taint(random)) {
+      instructions += fmt::format(
+          "(invoke-static () \"{}\")\n(move-result-object v0)\n", k_source);
+    }
+
+    std::vector<std::size_t> callees;
+    auto next_layer = layer(method) + 1;
+    if (next_layer < configuration.call_depth &&
+        !layers[next_layer].empty()) {
+      const auto& candidates = layers[next_layer];
+      for (std::size_t i = 0; i < configuration.calls_per_method; i++) {
+        callees.push_back(candidates[random() % candidates.size()]);
+      }
+    }
+    // Close the cycle of the strongly connected component.
+    auto scc_begin = method - method % configuration.scc_size;
+    auto scc_end =
+        std::min(scc_begin + configuration.scc_size, configuration.methods);
+    auto next = method + 1 == scc_end ? scc_begin : method + 1;
+    if (next != method) {
+      callees.push_back(next);
+    }
+    for (auto callee : callees) {
+      instructions += fmt::format(
+          "(invoke-static (v0) \"{}\")\n(move-result-object v1)\n",
+          method_signature(callee));
+    }
+
+    if (has_virtual_calls && method % 4 == 0) {
+      instructions += fmt::format(
+          "(invoke-static () \"{}\")\n(move-result-object v2)\n"
+          "(invoke-virtual (v2 v0) \"{}\")\n(move-result-object v1)\n",
+          k_base_instance,
+          k_base_run);
+    }
+
+    if (taint(random)) {
+      instructions += fmt::format("(invoke-static (v1) \"{}\")\n", k_sink);
+    }
+    instructions += "(return-object v1)\n";
+
+    bodies.push_back(fmt::format(
+        "(method (public static) \"{}\"\n(\n{}))",
+        method_signature(method),
+        instructions));
+
+    if (bodies.size() == kMethodsPerClass ||
+        method + 1 == configuration.methods) {
+      redex::create_methods(scope, class_name(method), bodies);
+      bodies.clear();
+    }
+  }
+}
+
+Json::Value synthetic_program_models() {
+  auto source = Json::Value(Json::objectValue);
+  source["method"] = k_source;
+  auto generation = Json::Value(Json::objectValue);
+  generation["kind"] = "Source";
+  generation["port"] = "Return";
+  source["generations"].append(generation);
+
+  auto sink = Json::Value(Json::objectValue);
+  sink["method"] = k_sink;
+  auto sink_taint = Json::Value(Json::objectValue);
+  sink_taint["kind"] = "Sink";
+  sink_taint["port"] = "Argument(0)";
+  sink["sinks"].append(sink_taint);
+
+  auto models = Json::Value(Json::arrayValue);
+  models.append(source);
+  models.append(sink);
+  return models;
+}
+
+Json::Value synthetic_program_rules() {
+  auto rule = Json::Value(Json::objectValue);
+  rule["name"] = "SyntheticFlow";
+  rule["code"] = 1;
+  rule["description"] = "Flow from a synthetic source to a synthetic sink.";
+  rule["sources"].append("Source");
+  rule["sinks"].append("Sink");
+
+  auto rules = Json::Value(Json::arrayValue);
+  rules.append(rule);
+  return rules;
+}
+
+} // namespace benchmarks
+} // namespace marianatrench
@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <cstddef>
+
+#include <json/json.h>
+
+#include <DexClass.h>
+
+namespace marianatrench {
+namespace benchmarks {
+
+/**
+ * Shape of a synthetic program, used to measure how the analysis scales.
+ *
+ * Methods are static methods of type `(Object) -> Object`, split in
+ * `call_depth` layers. Each method calls a few methods of the next layer and
+ * returns the result of its last call, hence chains of calls are at most
+ * `call_depth` long. Consecutive methods of a layer are grouped in strongly
+ * connected components of `scc_size` methods, calling each other in a cycle.
+ */
+struct SyntheticProgramConfiguration {
+  std::size_t methods = 1000;
+  std::size_t call_depth = 8;
+  std::size_t scc_size = 1;
+
+  /* Number of calls of each method to methods of the next layer. */
+  std::size_t calls_per_method = 2;
+
+  /**
+   * Number of overrides of a virtual method, called by a quarter of the
+   * methods. Each override calls a method of the last layer.
+   */
+  std::size_t virtual_fan_out = 0;
+
+  /* Probability for a method to call a source, and to call a sink. */
+  double taint_density = 0.05;
+
+  unsigned int seed = 0;
+};
+
+/* Create the classes of a synthetic program in the given scope. */
+void generate_synthetic_program(
+    Scope& scope,
+    const SyntheticProgramConfiguration& configuration);
+
+/* Models of the sources and sinks called by synthetic programs. */
+Json::Value synthetic_program_models();
+
+/* Rules matching the sources and sinks called by synthetic programs. */
+Json::Value synthetic_program_rules();
+
+} // namespace benchmarks
+} // namespace marianatrench
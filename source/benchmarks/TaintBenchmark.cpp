@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include <mariana-trench/FrameSet.h>
+#include <mariana-trench/Taint.h>
+#include <mariana-trench/benchmarks/Benchmark.h>
+
+namespace marianatrench {
+namespace benchmarks {
+
+static void BM_TaintPropagate(::benchmark::State& state) {
+  auto& environment = Environment::get();
+  environment.reset_random();
+  auto& context = environment.context();
+  auto taint = environment.random_taint(state.range(0));
+  const auto* caller = environment.random_method();
+  const auto* callee = environment.random_method();
+  const auto* call_position = environment.random_position();
+  auto callee_port = AccessPath(Root(Root::Kind::Argument, 1));
+  auto extra_features =
+      FeatureMayAlwaysSet::make_always({environment.random_feature()});
+
+  for (auto _ : state) {
+    ::benchmark::DoNotOptimize(taint.propagate(
+        caller,
+        callee,
+        callee_port,
+        call_position,
+        /* maximum_source_sink_distance */ 10,
+        extra_features,
+        context,
+        /* source_register_types */ {},
+        /* source_constant_arguments */ {}));
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_TaintPropagate)->RangeMultiplier(4)->Range(1, 1024);
+
+static void BM_TaintJoin(::benchmark::State& state) {
+  auto& environment = Environment::get();
+  environment.reset_random();
+  auto left = environment.random_taint(state.range(0));
+  auto right = environment.random_taint(state.range(0));
+
+  for (auto _ : state) {
+    auto taint = left;
+    taint.join_with(right);
+    ::benchmark::DoNotOptimize(taint);
+  }
+}
+BENCHMARK(BM_TaintJoin)->RangeMultiplier(4)->Range(1, 1024);
+
+namespace {
+
+/* Return a frame set of `frames` frames of the same kind. */
+FrameSet make_frame_set(
+    Environment& environment,
+    const Kind* kind,
+    std::size_t frames) {
+  FrameSet frame_set;
+  for (std::size_t i = 0; i < frames; i++) {
+    auto frame = environment.random_frame(/* leaf */ i % 4 == 0);
+    frame_set.add(test::make_frame(
+        kind,
+        test::FrameProperties{
+            .callee_port = frame.callee_port(),
+            .callee = frame.callee(),
+            .call_position = frame.call_position(),
+            .distance = frame.distance(),
+            .origins = frame.origins(),
+            .inferred_features = frame.inferred_features()}));
+  }
+  return frame_set;
+}
+
+} // namespace
+
+static void BM_FrameSetJoin(::benchmark::State& state) {
+  auto& environment = Environment::get();
+  environment.reset_random();
+  const auto* kind = environment.random_kind();
+  auto left = make_frame_set(environment, kind, state.range(0));
+  auto right = make_frame_set(environment, kind, state.range(0));
+
+  for (auto _ : state) {
+    auto frame_set = left;
+    frame_set.join_with(right);
+    ::benchmark::DoNotOptimize(frame_set);
+  }
+}
+BENCHMARK(BM_FrameSetJoin)->RangeMultiplier(4)->Range(1, 1024);
+
+/* Join with a frame set that is already included, the common case. */
+static void BM_FrameSetJoinStable(::benchmark::State& state) {
+  auto& environment = Environment::get();
+  environment.reset_random();
+  const auto* kind = environment.random_kind();
+  auto frame_set = make_frame_set(environment, kind, state.range(0));
+  auto subset = frame_set;
+
+  for (auto _ : state) {
+    auto result = frame_set;
+    result.join_with(subset);
+    ::benchmark::DoNotOptimize(result);
+  }
+}
+BENCHMARK(BM_FrameSetJoinStable)->RangeMultiplier(4)->Range(1, 1024);
+
+} // namespace benchmarks
+} // namespace marianatrench
@@ -5,14 +5,40 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <mariana-trench/RE2.h>
 #include <mariana-trench/model-generator/FieldConstraints.h>
 #include <mariana-trench/model-generator/MethodConstraints.h>
 
 namespace marianatrench {
 
+namespace {
+
+/* Fields with a key fully matching the pattern, or top. */
+FieldHashedSet may_match(const re2::RE2& pattern, const FieldMapping& mapping) {
+  if (auto string_pattern = as_string_literal(pattern)) {
+    return mapping.get(*string_pattern);
+  }
+  if (auto prefix = as_string_literal_prefix(pattern)) {
+    return mapping.with_prefix(*prefix);
+  }
+  return FieldHashedSet::top();
+}
+
+} // namespace
+
+FieldHashedSet FieldConstraint::may_satisfy(
+    const FieldMappings& /* field_mappings */) const {
+  return FieldHashedSet::top();
+}
+
 FieldNameConstraint::FieldNameConstraint(const std::string& regex_string)
     : pattern_(regex_string) {}
 
+FieldHashedSet FieldNameConstraint::may_satisfy(
+    const FieldMappings& field_mappings) const {
+  return may_match(pattern_, field_mappings.name_to_fields);
+}
+
 bool FieldNameConstraint::satisfy(const Field* field) const {
   return re2::RE2::FullMatch(field->get_name(), pattern_);
 }
@@ -30,6 +56,11 @@ SignatureFieldConstraint::SignatureFieldConstraint(
     const std::string& regex_string)
     : pattern_(regex_string) {}
 
+FieldHashedSet SignatureFieldConstraint::may_satisfy(
+    const FieldMappings& field_mappings) const {
+  return may_match(pattern_, field_mappings.signature_to_fields);
+}
+
 bool SignatureFieldConstraint::satisfy(const Field* field) const {
   return re2::RE2::FullMatch(field->show(), pattern_);
 }
@@ -69,6 +100,16 @@ ParentFieldConstraint::ParentFieldConstraint(
     std::unique_ptr<TypeConstraint> inner_constraint)
     : inner_constraint_(std::move(inner_constraint)) {}
 
+FieldHashedSet ParentFieldConstraint::may_satisfy(
+    const FieldMappings& field_mappings) const {
+  if (const auto* type_name_constraint =
+          dynamic_cast<const TypeNameConstraint*>(inner_constraint_.get())) {
+    return may_match(
+        type_name_constraint->pattern(), field_mappings.class_to_fields);
+  }
+  return FieldHashedSet::top();
+}
+
 bool ParentFieldConstraint::satisfy(const Field* field) const {
   return inner_constraint_->satisfy(field->get_class());
 }
@@ -86,6 +127,15 @@ AllOfFieldConstraint::AllOfFieldConstraint(
     std::vector<std::unique_ptr<FieldConstraint>> constraints)
     : constraints_(std::move(constraints)) {}
 
+FieldHashedSet AllOfFieldConstraint::may_satisfy(
+    const FieldMappings& field_mappings) const {
+  auto intersection_set = FieldHashedSet::top();
+  for (const auto& constraint : constraints_) {
+    intersection_set.meet_with(constraint->may_satisfy(field_mappings));
+  }
+  return intersection_set;
+}
+
 bool AllOfFieldConstraint::satisfy(const Field* field) const {
   return std::all_of(
       constraints_.begin(),
@@ -111,6 +161,18 @@ AnyOfFieldConstraint::AnyOfFieldConstraint(
     std::vector<std::unique_ptr<FieldConstraint>> constraints)
     : constraints_(std::move(constraints)) {}
 
+FieldHashedSet AnyOfFieldConstraint::may_satisfy(
+    const FieldMappings& field_mappings) const {
+  if (constraints_.empty()) {
+    return FieldHashedSet::top();
+  }
+  auto union_set = FieldHashedSet::bottom();
+  for (const auto& constraint : constraints_) {
+    union_set.join_with(constraint->may_satisfy(field_mappings));
+  }
+  return union_set;
+}
+
 bool AnyOfFieldConstraint::satisfy(const Field* field) const {
   // If there is no constraint, the field vacuously satisfies the constraint
   // This is different from the semantic of std::any_of
@@ -25,6 +25,11 @@ class FieldConstraint {
 
   static std::unique_ptr<FieldConstraint> from_json(
       const Json::Value& constraint);
+  /**
+   * Return the fields that may satisfy the constraint, or top if they cannot
+   * be determined from the field mappings.
+   */
+  virtual FieldHashedSet may_satisfy(const FieldMappings& field_mappings) const;
   virtual bool satisfy(const Field* field) const = 0;
   virtual bool operator==(const FieldConstraint& other) const = 0;
 };
@@ -32,6 +37,8 @@ class FieldConstraint {
 class FieldNameConstraint final : public FieldConstraint {
  public:
   explicit FieldNameConstraint(const std::string& regex_string);
+  FieldHashedSet may_satisfy(
+      const FieldMappings& field_mappings) const override;
   bool satisfy(const Field* field) const override;
   bool operator==(const FieldConstraint& other) const override;
 
@@ -42,6 +49,8 @@ class FieldNameConstraint final : public FieldConstraint {
 class SignatureFieldConstraint final : public FieldConstraint {
  public:
   explicit SignatureFieldConstraint(const std::string& regex_string);
+  FieldHashedSet may_satisfy(
+      const FieldMappings& field_mappings) const override;
   bool satisfy(const Field* field) const override;
   bool operator==(const FieldConstraint& other) const override;
 
@@ -66,6 +75,8 @@ class ParentFieldConstraint final : public FieldConstraint {
  public:
   explicit ParentFieldConstraint(
       std::unique_ptr<TypeConstraint> inner_constraint);
+  FieldHashedSet may_satisfy(
+      const FieldMappings& field_mappings) const override;
   bool satisfy(const Field* field) const override;
   bool operator==(const FieldConstraint& other) const override;
 
@@ -77,6 +88,8 @@ class AllOfFieldConstraint final : public FieldConstraint {
  public:
   explicit AllOfFieldConstraint(
       std::vector<std::unique_ptr<FieldConstraint>> constraints);
+  FieldHashedSet may_satisfy(
+      const FieldMappings& field_mappings) const override;
   bool satisfy(const Field* field) const override;
   bool operator==(const FieldConstraint& other) const override;
 
@@ -88,6 +101,8 @@ class AnyOfFieldConstraint final : public FieldConstraint {
  public:
   explicit AnyOfFieldConstraint(
       std::vector<std::unique_ptr<FieldConstraint>> constraints);
+  FieldHashedSet may_satisfy(
+      const FieldMappings& field_mappings) const override;
   bool satisfy(const Field* field) const override;
   bool operator==(const FieldConstraint& other) const override;
 
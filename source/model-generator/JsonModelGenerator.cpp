@@ -5,6 +5,7 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <mariana-trench/JsonFileCache.h>
 #include <mariana-trench/JsonValidation.h>
 #include <mariana-trench/Log.h>
 #include <mariana-trench/model-generator/JsonModelGenerator.h>
@@ -39,7 +40,7 @@ std::vector<Model> JsonModelGeneratorItem::visit_method(
     auto model = model_template_.instantiate(context_, method);
     // If a method has an empty model, then don't add a model
     if (model) {
-      models.push_back(*model);
+      models.push_back(std::move(*model));
     }
   }
   return models;
@@ -70,6 +71,10 @@ MethodHashedSet JsonModelGeneratorItem::may_satisfy(
   return constraint_->may_satisfy(method_mappings);
 }
 
+void JsonModelGeneratorItem::add_patterns(MethodPatterns& patterns) const {
+  constraint_->add_patterns(patterns);
+}
+
 JsonFieldModelGeneratorItem::JsonFieldModelGeneratorItem(
     const std::string& name,
     Context& context,
@@ -81,6 +86,16 @@ JsonFieldModelGeneratorItem::JsonFieldModelGeneratorItem(
       field_model_template_(std::move(field_model_template)),
       verbosity_(verbosity) {}
 
+std::vector<FieldModel> JsonFieldModelGeneratorItem::emit_field_models_filtered(
+    const FieldHashedSet& fields) {
+  return this->run_impl(fields.elements().begin(), fields.elements().end());
+}
+
+FieldHashedSet JsonFieldModelGeneratorItem::may_satisfy(
+    const FieldMappings& field_mappings) const {
+  return constraint_->may_satisfy(field_mappings);
+}
+
 std::vector<FieldModel> JsonFieldModelGeneratorItem::visit_field(
     const Field* field) const {
   std::vector<FieldModel> field_models;
@@ -104,8 +119,7 @@ JsonModelGenerator::JsonModelGenerator(
     const boost::filesystem::path& json_configuration_file)
     : ModelGenerator(name, context),
       json_configuration_file_(json_configuration_file) {
-  const Json::Value& value =
-      JsonValidation::parse_json_file(json_configuration_file);
+  const Json::Value& value = JsonFileCache::parse(json_configuration_file);
   JsonValidation::validate_object(value);
 
   for (auto model_generator :
@@ -188,6 +202,12 @@ std::vector<Model> JsonModelGenerator::emit_method_models_optimized(
   return models;
 }
 
+void JsonModelGenerator::add_patterns(MethodPatterns& patterns) const {
+  for (const auto& item : items_) {
+    item.add_patterns(patterns);
+  }
+}
+
 std::vector<FieldModel> JsonModelGenerator::emit_field_models(
     const Fields& fields) {
   std::vector<FieldModel> models;
@@ -201,4 +221,27 @@ std::vector<FieldModel> JsonModelGenerator::emit_field_models(
   return models;
 }
 
+std::vector<FieldModel> JsonModelGenerator::emit_field_models_optimized(
+    const Fields& fields,
+    const FieldMappings& field_mappings) {
+  std::vector<FieldModel> models;
+  for (auto& item : field_items_) {
+    FieldHashedSet filtered_fields = item.may_satisfy(field_mappings);
+    if (filtered_fields.is_bottom()) {
+      continue;
+    }
+    std::vector<FieldModel> field_models;
+    if (filtered_fields.is_top()) {
+      field_models = item.emit_field_models(fields);
+    } else {
+      field_models = item.emit_field_models_filtered(filtered_fields);
+    }
+    models.insert(
+        models.end(),
+        std::make_move_iterator(field_models.begin()),
+        std::make_move_iterator(field_models.end()));
+  }
+  return models;
+}
+
 } // namespace marianatrench
@@ -32,6 +32,7 @@ class JsonModelGeneratorItem final : public MethodVisitorModelGenerator {
   /* Returns filtered method set to run full satisfy checks on. Returns Top if
    * filtered set cannot be determined. */
   MethodHashedSet may_satisfy(const MethodMappings& method_mappings) const;
+  void add_patterns(MethodPatterns& patterns) const override;
   std::vector<Model> visit_method(const Method* method) const override;
 
  private:
@@ -48,6 +49,11 @@ class JsonFieldModelGeneratorItem final : public FieldVisitorModelGenerator {
       std::unique_ptr<AllOfFieldConstraint> constraint,
       FieldModelTemplate field_model_template,
       int verbosity);
+  std::vector<FieldModel> emit_field_models_filtered(
+      const FieldHashedSet& fields);
+  /* Returns filtered field set to run full satisfy checks on. Returns Top if
+   * filtered set cannot be determined. */
+  FieldHashedSet may_satisfy(const FieldMappings& field_mappings) const;
   std::vector<FieldModel> visit_field(const Field* field) const override;
 
  private:
@@ -68,6 +74,10 @@ class JsonModelGenerator final : public ModelGenerator {
       const Methods&,
       const MethodMappings& method_mappings) override;
   std::vector<FieldModel> emit_field_models(const Fields&) override;
+  std::vector<FieldModel> emit_field_models_optimized(
+      const Fields&,
+      const FieldMappings& field_mappings) override;
+  void add_patterns(MethodPatterns& patterns) const override;
 
  private:
   boost::filesystem::path json_configuration_file_;
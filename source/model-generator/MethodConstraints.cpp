@@ -5,6 +5,8 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <algorithm>
+
 #include <mariana-trench/JsonValidation.h>
 #include <mariana-trench/Log.h>
 #include <mariana-trench/Overrides.h>
@@ -53,12 +55,23 @@ MethodNameConstraint::MethodNameConstraint(const std::string& regex_string)
 
 MethodHashedSet MethodNameConstraint::may_satisfy(
     const MethodMappings& method_mappings) const {
-  auto string_pattern = as_string_literal(pattern_);
-  if (!string_pattern) {
-    return MethodHashedSet::top();
+  if (auto string_pattern = as_string_literal(pattern_)) {
+    return method_mappings.name_to_methods.get(*string_pattern);
+  }
+  auto found = method_mappings.name_pattern_to_methods.find(pattern_.pattern());
+  if (found != method_mappings.name_pattern_to_methods.end()) {
+    return found->second;
+  }
+  if (auto prefix = as_string_literal_prefix(pattern_)) {
+    return method_mappings.name_to_methods.with_prefix(*prefix);
+  }
+  return MethodHashedSet::top();
+}
+
+void MethodNameConstraint::add_patterns(MethodPatterns& patterns) const {
+  if (!as_string_literal(pattern_)) {
+    patterns.names.insert(pattern_.pattern());
   }
-  return method_mappings.name_to_methods.get(
-      *string_pattern, MethodHashedSet::bottom());
 }
 
 bool MethodNameConstraint::satisfy(const Method* method) const {
@@ -74,6 +87,10 @@ bool MethodNameConstraint::operator==(const MethodConstraint& other) const {
   }
 }
 
+std::size_t MethodNameConstraint::cost() const {
+  return kMatchCost;
+}
+
 ParentConstraint::ParentConstraint(
     std::unique_ptr<TypeConstraint> inner_constraint)
     : inner_constraint_(std::move(inner_constraint)) {}
@@ -84,6 +101,15 @@ MethodHashedSet ParentConstraint::may_satisfy(
       method_mappings, MaySatisfyMethodConstraintKind::Parent);
 }
 
+void ParentConstraint::add_patterns(MethodPatterns& patterns) const {
+  if (const auto* type_name_constraint =
+          dynamic_cast<const TypeNameConstraint*>(inner_constraint_.get())) {
+    if (!as_string_literal(type_name_constraint->pattern())) {
+      patterns.classes.insert(type_name_constraint->pattern().pattern());
+    }
+  }
+}
+
 bool ParentConstraint::satisfy(const Method* method) const {
   return inner_constraint_->satisfy(method->get_class());
 }
@@ -96,9 +122,34 @@ bool ParentConstraint::operator==(const MethodConstraint& other) const {
   }
 }
 
+namespace {
+
+std::size_t total_cost(
+    const std::vector<std::unique_ptr<MethodConstraint>>& constraints) {
+  std::size_t cost = 0;
+  for (const auto& constraint : constraints) {
+    cost += constraint->cost();
+  }
+  return cost;
+}
+
+/* Order constraints by increasing cost, for short-circuit evaluation. */
+std::vector<std::unique_ptr<MethodConstraint>> sort_by_cost(
+    std::vector<std::unique_ptr<MethodConstraint>> constraints) {
+  std::stable_sort(
+      constraints.begin(),
+      constraints.end(),
+      [](const auto& left, const auto& right) {
+        return left->cost() < right->cost();
+      });
+  return constraints;
+}
+
+} // namespace
+
 AllOfMethodConstraint::AllOfMethodConstraint(
     std::vector<std::unique_ptr<MethodConstraint>> constraints)
-    : constraints_(std::move(constraints)) {}
+    : constraints_(sort_by_cost(std::move(constraints))) {}
 
 bool AllOfMethodConstraint::has_children() const {
   return true;
@@ -142,9 +193,13 @@ bool AllOfMethodConstraint::operator==(const MethodConstraint& other) const {
   }
 }
 
+std::size_t AllOfMethodConstraint::cost() const {
+  return total_cost(constraints_);
+}
+
 AnyOfMethodConstraint::AnyOfMethodConstraint(
     std::vector<std::unique_ptr<MethodConstraint>> constraints)
-    : constraints_(std::move(constraints)) {}
+    : constraints_(sort_by_cost(std::move(constraints))) {}
 
 bool AnyOfMethodConstraint::has_children() const {
   return true;
@@ -199,6 +254,10 @@ bool AnyOfMethodConstraint::operator==(const MethodConstraint& other) const {
   }
 }
 
+std::size_t AnyOfMethodConstraint::cost() const {
+  return total_cost(constraints_);
+}
+
 NotMethodConstraint::NotMethodConstraint(
     std::unique_ptr<MethodConstraint> constraint)
     : constraint_(std::move(constraint)) {}
@@ -235,6 +294,10 @@ bool NotMethodConstraint::operator==(const MethodConstraint& other) const {
   }
 }
 
+std::size_t NotMethodConstraint::cost() const {
+  return constraint_->cost();
+}
+
 NumberParametersConstraint::NumberParametersConstraint(
     IntegerConstraint constraint)
     : constraint_(constraint){};
@@ -253,6 +316,10 @@ bool NumberParametersConstraint::operator==(
   }
 }
 
+std::size_t NumberParametersConstraint::cost() const {
+  return kCheapCost;
+}
+
 NumberOverridesConstraint::NumberOverridesConstraint(
     IntegerConstraint constraint,
     Context& context)
@@ -272,6 +339,10 @@ bool NumberOverridesConstraint::operator==(
   }
 }
 
+std::size_t NumberOverridesConstraint::cost() const {
+  return kCheapCost;
+}
+
 IsStaticConstraint::IsStaticConstraint(bool expected) : expected_(expected) {}
 
 bool IsStaticConstraint::satisfy(const Method* method) const {
@@ -287,6 +358,10 @@ bool IsStaticConstraint::operator==(const MethodConstraint& other) const {
   }
 }
 
+std::size_t IsStaticConstraint::cost() const {
+  return kCheapCost;
+}
+
 IsConstructorConstraint::IsConstructorConstraint(bool expected)
     : expected_(expected) {}
 
@@ -303,6 +378,10 @@ bool IsConstructorConstraint::operator==(const MethodConstraint& other) const {
   }
 }
 
+std::size_t IsConstructorConstraint::cost() const {
+  return kCheapCost;
+}
+
 IsNativeConstraint::IsNativeConstraint(bool expected) : expected_(expected) {}
 
 bool IsNativeConstraint::satisfy(const Method* method) const {
@@ -318,6 +397,10 @@ bool IsNativeConstraint::operator==(const MethodConstraint& other) const {
   }
 }
 
+std::size_t IsNativeConstraint::cost() const {
+  return kCheapCost;
+}
+
 HasCodeConstraint::HasCodeConstraint(bool expected) : expected_(expected) {}
 
 bool HasCodeConstraint::satisfy(const Method* method) const {
@@ -332,6 +415,10 @@ bool HasCodeConstraint::operator==(const MethodConstraint& other) const {
   }
 }
 
+std::size_t HasCodeConstraint::cost() const {
+  return kCheapCost;
+}
+
 HasAnnotationMethodConstraint::HasAnnotationMethodConstraint(
     const std::string& type,
     const std::optional<std::string>& annotation)
@@ -355,6 +442,10 @@ bool HasAnnotationMethodConstraint::operator==(
   }
 }
 
+std::size_t HasAnnotationMethodConstraint::cost() const {
+  return kMatchCost;
+}
+
 ParameterConstraint::ParameterConstraint(
     ParameterPosition index,
     std::unique_ptr<TypeConstraint> inner_constraint)
@@ -380,12 +471,13 @@ SignatureConstraint::SignatureConstraint(const std::string& regex_string)
 
 MethodHashedSet SignatureConstraint::may_satisfy(
     const MethodMappings& method_mappings) const {
-  auto string_pattern = as_string_literal(pattern_);
-  if (!string_pattern) {
-    return MethodHashedSet::top();
+  if (auto string_pattern = as_string_literal(pattern_)) {
+    return method_mappings.signature_to_methods.get(*string_pattern);
   }
-  return method_mappings.signature_to_methods.get(
-      *string_pattern, MethodHashedSet::bottom());
+  if (auto prefix = as_string_literal_prefix(pattern_)) {
+    return method_mappings.signature_to_methods.with_prefix(*prefix);
+  }
+  return MethodHashedSet::top();
 }
 
 bool SignatureConstraint::satisfy(const Method* method) const {
@@ -401,6 +493,10 @@ bool SignatureConstraint::operator==(const MethodConstraint& other) const {
   }
 }
 
+std::size_t SignatureConstraint::cost() const {
+  return kMatchCost;
+}
+
 ReturnConstraint::ReturnConstraint(
     std::unique_ptr<TypeConstraint> inner_constraint)
     : inner_constraint_(std::move(inner_constraint)) {}
@@ -417,10 +513,11 @@ bool ReturnConstraint::operator==(const MethodConstraint& other) const {
   }
 }
 
-ReturnsThisConstraint::ReturnsThisConstraint() {}
+ReturnsThisConstraint::ReturnsThisConstraint(Context& context)
+    : context_(context) {}
 
 bool ReturnsThisConstraint::satisfy(const Method* method) const {
-  return returns_this_analyzer::method_returns_this(method);
+  return context_.returns_this_cache->method_returns_this(method);
 }
 
 bool ReturnsThisConstraint::operator==(const MethodConstraint& other) const {
@@ -445,6 +542,10 @@ bool VisibilityMethodConstraint::operator==(
   }
 }
 
+std::size_t VisibilityMethodConstraint::cost() const {
+  return kCheapCost;
+}
+
 bool MethodConstraint::has_children() const {
   return false;
 }
@@ -453,11 +554,21 @@ std::vector<const MethodConstraint*> MethodConstraint::children() const {
   return {};
 }
 
+std::size_t MethodConstraint::cost() const {
+  return kExpensiveCost;
+}
+
 MethodHashedSet MethodConstraint::may_satisfy(
     const MethodMappings& /* method_mappings */) const {
   return MethodHashedSet::top();
 }
 
+void MethodConstraint::add_patterns(MethodPatterns& patterns) const {
+  for (const auto* child : children()) {
+    child->add_patterns(patterns);
+  }
+}
+
 namespace {
 
 std::optional<DexAccessFlags> string_to_visibility(
@@ -536,7 +647,7 @@ std::unique_ptr<MethodConstraint> MethodConstraint::from_json(
     return std::make_unique<ReturnConstraint>(TypeConstraint::from_json(
         JsonValidation::object(constraint, /* field */ "inner")));
   } else if (constraint_name == "returns_this") {
-    return std::make_unique<ReturnsThisConstraint>();
+    return std::make_unique<ReturnsThisConstraint>(context);
   } else if (constraint_name == "visibility") {
     auto visibility_string =
         JsonValidation::string(constraint, /* field */ "is");
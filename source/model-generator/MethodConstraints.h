@@ -39,8 +39,24 @@ class MethodConstraint {
   virtual std::vector<const MethodConstraint*> children() const;
   virtual MethodHashedSet may_satisfy(
       const MethodMappings& method_mappings) const;
+  /* Add the regular expressions that `may_satisfy` can look up. */
+  virtual void add_patterns(MethodPatterns& patterns) const;
   virtual bool satisfy(const Method* method) const = 0;
   virtual bool operator==(const MethodConstraint& other) const = 0;
+
+  /**
+   * Estimated cost of `satisfy`. Children of `all_of` and `any_of` constraints
+   * are evaluated by increasing cost, so that cheap checks short-circuit
+   * regular expressions and walks of the type hierarchy.
+   */
+  virtual std::size_t cost() const;
+
+  /* Checks on the access flags or the prototype. */
+  static constexpr std::size_t kCheapCost = 1;
+  /* Regular expressions and annotations. */
+  static constexpr std::size_t kMatchCost = 10;
+  /* Type constraints, which may walk the type hierarchy, and code analyses. */
+  static constexpr std::size_t kExpensiveCost = 100;
 };
 
 class MethodNameConstraint final : public MethodConstraint {
@@ -48,8 +64,10 @@ class MethodNameConstraint final : public MethodConstraint {
   explicit MethodNameConstraint(const std::string& regex_string);
   MethodHashedSet may_satisfy(
       const MethodMappings& method_mappings) const override;
+  void add_patterns(MethodPatterns& patterns) const override;
   bool satisfy(const Method* method) const override;
   bool operator==(const MethodConstraint& other) const override;
+  std::size_t cost() const override;
 
  private:
   re2::RE2 pattern_;
@@ -60,6 +78,7 @@ class ParentConstraint final : public MethodConstraint {
   explicit ParentConstraint(std::unique_ptr<TypeConstraint> inner_constraint);
   MethodHashedSet may_satisfy(
       const MethodMappings& method_mappings) const override;
+  void add_patterns(MethodPatterns& patterns) const override;
   bool satisfy(const Method* method) const override;
   bool operator==(const MethodConstraint& other) const override;
 
@@ -77,6 +96,7 @@ class AllOfMethodConstraint final : public MethodConstraint {
       const MethodMappings& method_mappings) const override;
   bool satisfy(const Method* method) const override;
   bool operator==(const MethodConstraint& other) const override;
+  std::size_t cost() const override;
 
  private:
   std::vector<std::unique_ptr<MethodConstraint>> constraints_;
@@ -92,6 +112,7 @@ class AnyOfMethodConstraint final : public MethodConstraint {
       const MethodMappings& method_mappings) const override;
   bool satisfy(const Method* method) const override;
   bool operator==(const MethodConstraint& other) const override;
+  std::size_t cost() const override;
 
  private:
   std::vector<std::unique_ptr<MethodConstraint>> constraints_;
@@ -106,6 +127,7 @@ class NotMethodConstraint final : public MethodConstraint {
       const MethodMappings& method_mappings) const override;
   bool satisfy(const Method* method) const override;
   bool operator==(const MethodConstraint& other) const override;
+  std::size_t cost() const override;
 
  private:
   std::unique_ptr<MethodConstraint> constraint_;
@@ -116,6 +138,7 @@ class NumberParametersConstraint final : public MethodConstraint {
   explicit NumberParametersConstraint(IntegerConstraint constraint);
   bool satisfy(const Method* method) const override;
   bool operator==(const MethodConstraint& other) const override;
+  std::size_t cost() const override;
 
  private:
   IntegerConstraint constraint_;
@@ -128,6 +151,7 @@ class NumberOverridesConstraint final : public MethodConstraint {
       Context& context);
   bool satisfy(const Method* method) const override;
   bool operator==(const MethodConstraint& other) const override;
+  std::size_t cost() const override;
 
  private:
   IntegerConstraint constraint_;
@@ -139,6 +163,7 @@ class IsStaticConstraint final : public MethodConstraint {
   explicit IsStaticConstraint(bool expected);
   bool satisfy(const Method* method) const override;
   bool operator==(const MethodConstraint& other) const override;
+  std::size_t cost() const override;
 
  private:
   bool expected_;
@@ -149,6 +174,7 @@ class IsConstructorConstraint final : public MethodConstraint {
   explicit IsConstructorConstraint(bool expected);
   bool satisfy(const Method* method) const override;
   bool operator==(const MethodConstraint& other) const override;
+  std::size_t cost() const override;
 
  private:
   bool expected_;
@@ -159,6 +185,7 @@ class IsNativeConstraint final : public MethodConstraint {
   explicit IsNativeConstraint(bool expected);
   bool satisfy(const Method* method) const override;
   bool operator==(const MethodConstraint& other) const override;
+  std::size_t cost() const override;
 
  private:
   bool expected_;
@@ -169,6 +196,7 @@ class HasCodeConstraint final : public MethodConstraint {
   explicit HasCodeConstraint(bool expected);
   bool satisfy(const Method* method) const override;
   bool operator==(const MethodConstraint& other) const override;
+  std::size_t cost() const override;
 
  private:
   bool expected_;
@@ -181,6 +209,7 @@ class HasAnnotationMethodConstraint final : public MethodConstraint {
       const std::optional<std::string>& annotation);
   bool satisfy(const Method* method) const override;
   bool operator==(const MethodConstraint& other) const override;
+  std::size_t cost() const override;
 
  private:
   std::string type_;
@@ -207,6 +236,7 @@ class SignatureConstraint final : public MethodConstraint {
       const MethodMappings& method_mappings) const override;
   bool satisfy(const Method* method) const override;
   bool operator==(const MethodConstraint& other) const override;
+  std::size_t cost() const override;
 
  private:
   re2::RE2 pattern_;
@@ -224,9 +254,12 @@ class ReturnConstraint final : public MethodConstraint {
 
 class ReturnsThisConstraint final : public MethodConstraint {
  public:
-  explicit ReturnsThisConstraint();
+  explicit ReturnsThisConstraint(Context& context);
   bool satisfy(const Method* method) const override;
   bool operator==(const MethodConstraint& other) const override;
+
+ private:
+  Context& context_;
 };
 
 class VisibilityMethodConstraint final : public MethodConstraint {
@@ -234,6 +267,7 @@ class VisibilityMethodConstraint final : public MethodConstraint {
   explicit VisibilityMethodConstraint(DexAccessFlags visibility);
   bool satisfy(const Method* method) const override;
   bool operator==(const MethodConstraint& other) const override;
+  std::size_t cost() const override;
 
  private:
   DexAccessFlags visibility_;
@@ -5,11 +5,14 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <algorithm>
 #include <iterator>
+#include <atomic>
 #include <mutex>
 
 #include <boost/algorithm/string/predicate.hpp>
 #include <fmt/format.h>
+#include <re2/set.h>
 
 #include <RedexResources.h>
 #include <Resolver.h>
@@ -48,11 +51,29 @@ ModelGeneratorResult ModelGenerator::run(
 ModelGeneratorResult ModelGenerator::run_optimized(
     const Methods& methods,
     const MethodMappings& method_mappings,
-    const Fields& fields) {
+    const Fields& fields,
+    const FieldMappings& field_mappings) {
   return {
       /* method_models */ emit_method_models_optimized(
           methods, method_mappings),
-      /* field_models */ emit_field_models(fields)};
+      /* field_models */ emit_field_models_optimized(fields, field_mappings)};
+}
+
+namespace {
+
+// Zero means the default number of threads.
+thread_local unsigned int current_visitor_threads = 0;
+
+} // namespace
+
+unsigned int ModelGenerator::visitor_threads() {
+  return current_visitor_threads != 0
+      ? current_visitor_threads
+      : sparta::parallel::default_num_threads();
+}
+
+void ModelGenerator::set_visitor_threads(unsigned int threads) {
+  current_visitor_threads = threads;
 }
 
 std::vector<Model> ModelGenerator::emit_method_models_optimized(
@@ -61,6 +82,12 @@ std::vector<Model> ModelGenerator::emit_method_models_optimized(
   return this->emit_method_models(methods);
 }
 
+std::vector<FieldModel> ModelGenerator::emit_field_models_optimized(
+    const Fields& fields,
+    const FieldMappings& /* field_mappings */) {
+  return this->emit_field_models(fields);
+}
+
 std::vector<Model> MethodVisitorModelGenerator::emit_method_models(
     const Methods& methods) {
   return this->run_impl(methods.begin(), methods.end());
@@ -73,73 +100,270 @@ std::vector<FieldModel> FieldVisitorModelGenerator::emit_field_models(
 
 namespace {
 
-void create_name_to_method(
-    const Method* method,
-    ConcurrentMap<std::string, MethodHashedSet>& method_mapping) {
-  const auto& method_name = method->get_name();
-  method_mapping.update(
-      method_name,
-      [&](const std::string& /* name */,
-          MethodHashedSet& methods,
-          bool /* exists */) { methods.add(method); });
+template <typename Key>
+using PartialMapping = std::unordered_map<Key, std::vector<const Method*>>;
+
+/* Mappings built by a single thread, keyed on interned values. */
+struct PartialMappings {
+  PartialMapping<const DexString*> names;
+  PartialMapping<const DexType*> classes;
+  PartialMapping<const DexType*> override_classes;
+  PartialMapping<const DexMethod*> signatures;
+};
+
+/**
+ * Merge the given per-thread mappings into a mapping keyed on the string of
+ * each key, given by `key_string(key, methods)`.
+ */
+template <typename Key, typename KeyString>
+MethodMapping merge_partial_mappings(
+    std::vector<PartialMappings>& partial_mappings,
+    PartialMapping<Key> PartialMappings::*member,
+    const KeyString& key_string) {
+  PartialMapping<Key> merged;
+  for (auto& partial_mappings_of_thread : partial_mappings) {
+    for (auto& [key, methods] : partial_mappings_of_thread.*member) {
+      auto& merged_methods = merged[key];
+      if (merged_methods.empty()) {
+        merged_methods = std::move(methods);
+      } else {
+        merged_methods.insert(
+            merged_methods.end(), methods.begin(), methods.end());
+      }
+    }
+    (partial_mappings_of_thread.*member).clear();
+  }
+
+  std::vector<MethodMapping::Entry> entries;
+  entries.reserve(merged.size());
+  for (auto& [key, methods] : merged) {
+    auto string = key_string(key, methods);
+    entries.emplace_back(string, std::move(methods));
+  }
+  return MethodMapping(std::move(entries));
 }
 
-void create_class_to_method(
-    const Method* method,
-    ConcurrentMap<std::string, MethodHashedSet>& method_mapping) {
-  std::string parent_class = method->get_class()->get_name()->str();
-  method_mapping.update(
-      parent_class,
-      [&](const std::string& /* parent_name */,
-          MethodHashedSet& methods,
-          bool /* exists */) { methods.add(method); });
+/**
+ * Parents of the given class, including interfaces, as in
+ * `generator::get_parents_from_class` with `include_interfaces`.
+ */
+std::unordered_set<const DexType*> get_parent_types(const DexClass* dex_class) {
+  std::unordered_set<const DexType*> parents;
+  while (dex_class != nullptr) {
+    const DexType* super_type = dex_class->get_super_class();
+    if (!super_type) {
+      break;
+    }
+    parents.insert(super_type);
+    std::vector<const DexType*> interfaces(
+        dex_class->get_interfaces()->begin(),
+        dex_class->get_interfaces()->end());
+    while (!interfaces.empty()) {
+      const auto* interface = interfaces.back();
+      interfaces.pop_back();
+      parents.insert(interface);
+      if (const auto* interface_class = type_class(interface)) {
+        const auto& super_interfaces = *interface_class->get_interfaces();
+        interfaces.insert(
+            interfaces.end(), super_interfaces.begin(), super_interfaces.end());
+      }
+    }
+    dex_class = type_class(super_type);
+  }
+  return parents;
 }
 
-void create_class_to_override_method(
-    const Method* method,
-    ConcurrentMap<std::string, MethodHashedSet>& method_mapping) {
-  std::string class_name = method->get_class()->get_name()->str();
-  auto* dex_class = redex::get_class(class_name);
-  if (!dex_class) {
-    return;
+// Memory budget of the automata matching all patterns at once.
+constexpr std::int64_t k_pattern_set_max_memory = 512 << 20;
+
+/**
+ * Return the union of the methods mapped from the keys fully matching each
+ * pattern, matching each key only once.
+ *
+ * Returns an empty map if the patterns could not be matched together.
+ */
+std::unordered_map<std::string, MethodHashedSet> match_patterns(
+    const std::unordered_set<std::string>& patterns,
+    const MethodMapping& mapping) {
+  re2::RE2::Options options;
+  options.set_max_mem(k_pattern_set_max_memory);
+  options.set_log_errors(false);
+  re2::RE2::Set set(options, re2::RE2::ANCHOR_BOTH);
+
+  std::vector<const std::string*> indexed_patterns;
+  for (const auto& pattern : patterns) {
+    std::string error;
+    if (set.Add(pattern, &error) < 0) {
+      WARNING(3, "Unable to index pattern `{}`: {}", pattern, error);
+      continue;
+    }
+    indexed_patterns.push_back(&pattern);
   }
-  std::unordered_set<std::string> parent_classes =
-      generator::get_parents_from_class(
-          dex_class, /* include_interfaces */ true);
-  parent_classes.insert(class_name);
-  for (const auto& parent_class : parent_classes) {
-    method_mapping.update(
-        parent_class,
-        [&](const std::string& /* parent_name */,
-            MethodHashedSet& methods,
-            bool /* exists */) { methods.add(method); });
+  if (indexed_patterns.empty()) {
+    return {};
+  }
+  if (!set.Compile()) {
+    WARNING(1, "Unable to compile {} patterns.", indexed_patterns.size());
+    return {};
   }
-}
 
-void create_signature_to_method(
-    const Method* method,
-    ConcurrentMap<std::string, MethodHashedSet>& method_mapping) {
-  std::string signature = method->signature();
-  method_mapping.update(
-      signature,
-      [&](const std::string& /* parent_name */,
-          MethodHashedSet& methods,
-          bool /* exists */) { methods.add(method); });
+  std::vector<const MethodMapping::Entry*> entries;
+  entries.reserve(mapping.size());
+  for (const auto& entry : mapping) {
+    entries.push_back(&entry);
+  }
+
+  std::vector<std::vector<int>> matches(entries.size());
+  std::atomic<bool> failed(false);
+  auto queue = sparta::work_queue<std::size_t>(
+      [&](std::size_t index) {
+        const auto& key = entries[index]->first;
+        re2::RE2::Set::ErrorInfo error_info;
+        if (!set.Match(
+                re2::StringPiece(key.data(), key.size()),
+                &matches[index],
+                &error_info) &&
+            error_info.kind != re2::RE2::Set::kNoError) {
+          failed = true;
+        }
+      },
+      ModelGenerator::visitor_threads());
+  for (std::size_t index = 0; index < entries.size(); index++) {
+    queue.add_item(index);
+  }
+  queue.run_all();
+  if (failed) {
+    WARNING(1, "Unable to match {} patterns.", indexed_patterns.size());
+    return {};
+  }
+
+  std::vector<MethodHashedSet> methods(
+      indexed_patterns.size(), MethodHashedSet::bottom());
+  for (std::size_t index = 0; index < entries.size(); index++) {
+    for (auto pattern_index : matches[index]) {
+      for (const auto* method : entries[index]->second) {
+        methods[pattern_index].add(method);
+      }
+    }
+  }
+
+  std::unordered_map<std::string, MethodHashedSet> result;
+  for (std::size_t index = 0; index < indexed_patterns.size(); index++) {
+    result.emplace(*indexed_patterns[index], std::move(methods[index]));
+  }
+  return result;
 }
+
 } // namespace
 
 MethodMappings::MethodMappings(const Methods& methods) {
-  auto queue = sparta::work_queue<const Method*>([&](const Method* method) {
-    create_name_to_method(method, name_to_methods);
-    create_class_to_method(method, class_to_methods);
-    create_class_to_override_method(method, class_to_override_methods);
-    create_signature_to_method(method, signature_to_methods);
-  });
+  auto threads = sparta::parallel::default_num_threads();
+  std::vector<PartialMappings> partial_mappings(threads);
+
+  auto queue = sparta::work_queue<const Method*>(
+      [&](sparta::SpartaWorkerState<const Method*>* worker_state,
+          const Method* method) {
+        auto& partial = partial_mappings.at(worker_state->worker_id());
+        const auto* dex_method = method->dex_method();
+        partial.names[dex_method->get_name()].push_back(method);
+        partial.classes[method->get_class()].push_back(method);
+        partial.signatures[dex_method].push_back(method);
+      },
+      threads);
   for (const auto* method : methods) {
     all_methods.add(method);
     queue.add_item(method);
   }
   queue.run_all();
+
+  // Classes are mapped to the methods they define before merging, hence a
+  // class whose methods were visited by several threads is in several maps.
+  PartialMapping<const DexType*> classes;
+  for (const auto& partial : partial_mappings) {
+    for (const auto& [type, type_methods] : partial.classes) {
+      auto& class_methods = classes[type];
+      class_methods.insert(
+          class_methods.end(), type_methods.begin(), type_methods.end());
+    }
+  }
+
+  // The parents of each class are computed once for all its methods.
+  auto parents_queue = sparta::work_queue<const DexType*>(
+      [&](sparta::SpartaWorkerState<const DexType*>* worker_state,
+          const DexType* type) {
+        const auto* dex_class = type_class(type);
+        if (dex_class == nullptr) {
+          return;
+        }
+        auto& partial = partial_mappings.at(worker_state->worker_id());
+        const auto& class_methods = classes.at(type);
+        auto parents = get_parent_types(dex_class);
+        parents.insert(type);
+        for (const auto* parent : parents) {
+          auto& parent_methods = partial.override_classes[parent];
+          parent_methods.insert(
+              parent_methods.end(), class_methods.begin(), class_methods.end());
+        }
+      },
+      threads);
+  for (const auto& [type, _] : classes) {
+    parents_queue.add_item(type);
+  }
+  parents_queue.run_all();
+
+  name_to_methods = merge_partial_mappings(
+      partial_mappings,
+      &PartialMappings::names,
+      [](const DexString* name, const std::vector<const Method*>& /* methods */)
+          -> std::string_view { return name->str(); });
+  auto type_name = [](const DexType* type,
+                      const std::vector<const Method*>& /* methods */)
+      -> std::string_view { return type->get_name()->str(); };
+  class_to_methods = merge_partial_mappings(
+      partial_mappings, &PartialMappings::classes, type_name);
+  class_to_override_methods = merge_partial_mappings(
+      partial_mappings, &PartialMappings::override_classes, type_name);
+  signature_to_methods = merge_partial_mappings(
+      partial_mappings,
+      &PartialMappings::signatures,
+      [](const DexMethod* /* dex_method */,
+         const std::vector<const Method*>& methods) -> std::string_view {
+        return methods.front()->signature();
+      });
+}
+
+FieldMappings::FieldMappings(const Fields& fields) {
+  // There are far less fields than methods, hence this is not parallelized.
+  std::unordered_map<const DexString*, std::vector<const Field*>> names;
+  std::unordered_map<const DexType*, std::vector<const Field*>> classes;
+  std::vector<FieldMapping::Entry> signatures;
+  for (const auto* field : fields) {
+    all_fields.add(field);
+    names[field->dex_field()->get_name()].push_back(field);
+    classes[field->get_class()].push_back(field);
+    // Each field has a distinct signature.
+    signatures.emplace_back(field->show(), std::vector<const Field*>{field});
+  }
+
+  std::vector<FieldMapping::Entry> entries;
+  entries.reserve(names.size());
+  for (auto& [name, name_fields] : names) {
+    entries.emplace_back(name->str(), std::move(name_fields));
+  }
+  name_to_fields = FieldMapping(std::move(entries));
+
+  entries.clear();
+  entries.reserve(classes.size());
+  for (auto& [type, class_fields] : classes) {
+    entries.emplace_back(type->get_name()->str(), std::move(class_fields));
+  }
+  class_to_fields = FieldMapping(std::move(entries));
+  signature_to_fields = FieldMapping(std::move(signatures));
+}
+
+void MethodMappings::index_patterns(const MethodPatterns& patterns) {
+  name_pattern_to_methods = match_patterns(patterns.names, name_to_methods);
+  class_pattern_to_methods = match_patterns(patterns.classes, class_to_methods);
 }
 
 const std::string& generator::get_class_name(const Method* method) {
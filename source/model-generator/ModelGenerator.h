@@ -7,16 +7,25 @@
 
 #pragma once
 
+#include <algorithm>
+#include <functional>
 #include <optional>
 #include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <unordered_set>
+#include <vector>
 
 #include <DexClass.h>
 #include <DexUtil.h>
 #include <RedexResources.h>
 #include <Walkers.h>
 
+#include <mariana-trench/Compiler.h>
 #include <mariana-trench/Context.h>
 #include <mariana-trench/FieldModel.h>
+#include <mariana-trench/Fields.h>
 #include <mariana-trench/Frame.h>
 #include <mariana-trench/MethodSet.h>
 #include <mariana-trench/Methods.h>
@@ -27,14 +36,157 @@
 namespace marianatrench {
 
 using MethodHashedSet = sparta::HashedSetAbstractDomain<const Method*>;
+using FieldHashedSet = sparta::HashedSetAbstractDomain<const Field*>;
 
+/* Regular expressions used by the constraints of all model generators. */
+struct MethodPatterns {
+  std::unordered_set<std::string> names;
+  std::unordered_set<std::string> classes;
+};
+
+/**
+ * Elements (i.e methods or fields) indexed by a string key (e.g a name or a
+ * class name), as arrays of elements sorted with `Compare`.
+ *
+ * Keys are views of strings owned by Redex (i.e `DexString`s) or by the
+ * elements (i.e signatures), hence the mapping does not copy any string. Keys
+ * are sorted, which allows looking up prefixes.
+ */
+template <typename Element, typename Compare = std::less<const Element*>>
+class StringMapping final {
+ public:
+  using Entry = std::pair<std::string_view, std::vector<const Element*>>;
+  using HashedSet = sparta::HashedSetAbstractDomain<const Element*>;
+  using const_iterator = typename std::vector<Entry>::const_iterator;
+
+ public:
+  StringMapping() = default;
+
+  /* Build a mapping from entries with distinct keys. */
+  explicit StringMapping(std::vector<Entry> entries)
+      : entries_(std::move(entries)) {
+    std::sort(
+        entries_.begin(),
+        entries_.end(),
+        [](const Entry& left, const Entry& right) {
+          return left.first < right.first;
+        });
+    for (auto& [_, elements] : entries_) {
+      std::sort(elements.begin(), elements.end(), Compare());
+      elements.erase(
+          std::unique(elements.begin(), elements.end()), elements.end());
+      elements.shrink_to_fit();
+    }
+  }
+
+  /* Return the elements of the given key, or `nullptr`. */
+  const std::vector<const Element*>* MT_NULLABLE
+  find(std::string_view key) const {
+    auto found = lower_bound(key);
+    if (found == entries_.end() || found->first != key) {
+      return nullptr;
+    }
+    return &found->second;
+  }
+
+  /* Return the elements of the given key, or bottom. */
+  HashedSet get(std::string_view key) const {
+    auto result = HashedSet::bottom();
+    if (const auto* elements = find(key)) {
+      for (const auto* element : *elements) {
+        result.add(element);
+      }
+    }
+    return result;
+  }
+
+  /* Return the union of the elements of all keys with the given prefix. */
+  HashedSet with_prefix(std::string_view prefix) const {
+    auto result = HashedSet::bottom();
+    for (auto iterator = lower_bound(prefix);
+         iterator != entries_.end() &&
+         iterator->first.substr(0, prefix.size()) == prefix;
+         ++iterator) {
+      for (const auto* element : iterator->second) {
+        result.add(element);
+      }
+    }
+    return result;
+  }
+
+  std::size_t size() const {
+    return entries_.size();
+  }
+
+  const_iterator begin() const {
+    return entries_.cbegin();
+  }
+
+  const_iterator end() const {
+    return entries_.cend();
+  }
+
+ private:
+  const_iterator lower_bound(std::string_view key) const {
+    return std::lower_bound(
+        entries_.begin(),
+        entries_.end(),
+        key,
+        [](const Entry& entry, std::string_view key) {
+          return entry.first < key;
+        });
+  }
+
+ private:
+  // Sorted by key.
+  std::vector<Entry> entries_;
+};
+
+struct CompareMethodIds {
+  bool operator()(const Method* left, const Method* right) const {
+    return left->id() < right->id();
+  }
+};
+
+using MethodMapping = StringMapping<Method, CompareMethodIds>;
+using FieldMapping = StringMapping<Field>;
+
+/**
+ * Indices of methods by name, class, parent class and signature, used to find
+ * the methods that may satisfy constraints without visiting all methods.
+ *
+ * These are built in parallel from per-thread maps keyed on the interned
+ * `DexString`, `DexType` and `DexMethod` of each method, hence no string is
+ * built, and the parents of each class are only computed once.
+ */
 struct MethodMappings {
   explicit MethodMappings(const Methods& methods);
-  ConcurrentMap<std::string, MethodHashedSet> name_to_methods;
-  ConcurrentMap<std::string, MethodHashedSet> class_to_methods;
-  ConcurrentMap<std::string, MethodHashedSet> class_to_override_methods;
-  ConcurrentMap<std::string, MethodHashedSet> signature_to_methods;
+  MethodMapping name_to_methods;
+  MethodMapping class_to_methods;
+  MethodMapping class_to_override_methods;
+  MethodMapping signature_to_methods;
   MethodHashedSet all_methods;
+
+  /**
+   * Match all method names and class names against the given patterns at
+   * once, using `re2::RE2::Set`, and store the methods matching each pattern.
+   *
+   * Patterns that could not be indexed are simply missing from the maps
+   * below.
+   */
+  void index_patterns(const MethodPatterns& patterns);
+
+  std::unordered_map<std::string, MethodHashedSet> name_pattern_to_methods;
+  std::unordered_map<std::string, MethodHashedSet> class_pattern_to_methods;
+};
+
+/* Indices of fields by name, class and signature, as `MethodMappings`. */
+struct FieldMappings {
+  explicit FieldMappings(const Fields& fields);
+  FieldMapping name_to_fields;
+  FieldMapping class_to_fields;
+  FieldMapping signature_to_fields;
+  FieldHashedSet all_fields;
 };
 
 struct ModelGeneratorResult {
@@ -69,11 +221,27 @@ class ModelGenerator {
     return {};
   }
 
+  virtual std::vector<FieldModel> emit_field_models_optimized(
+      const Fields& fields,
+      const FieldMappings& field_mappings);
+
+  /* Add the regular expressions that `MethodMappings` should index. */
+  virtual void add_patterns(MethodPatterns& /* patterns */) const {}
+
   ModelGeneratorResult run(const Methods& methods, const Fields& fields);
   ModelGeneratorResult run_optimized(
       const Methods& methods,
       const MethodMappings& method_mappings,
-      const Fields& fields);
+      const Fields& fields,
+      const FieldMappings& field_mappings);
+
+  /**
+   * Number of threads used to visit methods or fields from the current
+   * thread. This is lowered while several generators run concurrently, to
+   * avoid oversubscribing the machine.
+   */
+  static unsigned int visitor_threads();
+  static void set_visitor_threads(unsigned int threads);
 
  protected:
   std::string name_;
@@ -99,17 +267,19 @@ class MethodVisitorModelGenerator : public ModelGenerator {
     std::vector<Model> models;
     std::mutex mutex;
 
-    auto queue = sparta::work_queue<const Method*>([&](const Method* method) {
-      std::vector<Model> method_models = this->visit_method(method);
-
-      if (!method_models.empty()) {
-        std::lock_guard<std::mutex> lock(mutex);
-        models.insert(
-            models.end(),
-            std::make_move_iterator(method_models.begin()),
-            std::make_move_iterator(method_models.end()));
-      }
-    });
+    auto queue = sparta::work_queue<const Method*>(
+        [&](const Method* method) {
+          std::vector<Model> method_models = this->visit_method(method);
+
+          if (!method_models.empty()) {
+            std::lock_guard<std::mutex> lock(mutex);
+            models.insert(
+                models.end(),
+                std::make_move_iterator(method_models.begin()),
+                std::make_move_iterator(method_models.end()));
+          }
+        },
+        ModelGenerator::visitor_threads());
     for (auto iterator = begin; iterator != end; ++iterator) {
       queue.add_item(*iterator);
     }
@@ -134,17 +304,19 @@ class FieldVisitorModelGenerator : public ModelGenerator {
     std::vector<FieldModel> models;
     std::mutex mutex;
 
-    auto queue = sparta::work_queue<const Field*>([&](const Field* field) {
-      auto field_models = this->visit_field(field);
-
-      if (!field_models.empty()) {
-        std::lock_guard<std::mutex> lock(mutex);
-        models.insert(
-            models.end(),
-            std::make_move_iterator(field_models.begin()),
-            std::make_move_iterator(field_models.end()));
-      }
-    });
+    auto queue = sparta::work_queue<const Field*>(
+        [&](const Field* field) {
+          auto field_models = this->visit_field(field);
+
+          if (!field_models.empty()) {
+            std::lock_guard<std::mutex> lock(mutex);
+            models.insert(
+                models.end(),
+                std::make_move_iterator(field_models.begin()),
+                std::make_move_iterator(field_models.end()));
+          }
+        },
+        ModelGenerator::visitor_threads());
     for (auto iterator = begin; iterator != end; ++iterator) {
       queue.add_item(*iterator);
     }
@@ -23,11 +23,11 @@ void TemplateVariableMapping::insert(
 
 std::optional<ParameterPosition> TemplateVariableMapping::at(
     const std::string& name) const {
-  try {
-    return map_.at(name);
-  } catch (const std::out_of_range& exception) {
+  auto found = map_.find(name);
+  if (found == map_.end()) {
     return std::nullopt;
   }
+  return found->second;
 }
 
 ParameterPositionTemplate::ParameterPositionTemplate(
@@ -547,10 +547,11 @@ ForAllParameters ForAllParameters::from_json(
 bool ForAllParameters::instantiate(Model& model, const Method* method) const {
   bool updated = false;
   ParameterPosition index = method->first_parameter_index();
+  // The mapping only holds `variable_`, hence it is reused across parameters.
+  TemplateVariableMapping variable_mapping;
   for (auto type : *method->get_proto()->get_args()) {
     if (constraints_->satisfy(type)) {
       LOG(3, "Type {} satifies constraints in for_all_parameters", show(type));
-      TemplateVariableMapping variable_mapping;
       variable_mapping.insert(variable_, index);
 
       for (const auto& sink_template : sink_templates_) {
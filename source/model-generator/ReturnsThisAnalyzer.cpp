@@ -211,4 +211,16 @@ bool method_returns_this(const Method* method) {
 }
 
 } // namespace returns_this_analyzer
+
+bool ReturnsThisCache::method_returns_this(const Method* method) const {
+  if (auto cached = results_.get(method, std::nullopt)) {
+    return *cached;
+  }
+
+  // Concurrent callers might both run the analysis, which is deterministic.
+  bool result = returns_this_analyzer::method_returns_this(method);
+  results_.emplace(method, result);
+  return result;
+}
+
 } // namespace marianatrench
@@ -7,6 +7,10 @@
 
 #pragma once
 
+#include <optional>
+
+#include <ConcurrentContainers.h>
+
 #include <mariana-trench/Method.h>
 
 namespace marianatrench {
@@ -15,4 +19,29 @@ namespace returns_this_analyzer {
 bool method_returns_this(const Method* method);
 
 } // namespace returns_this_analyzer
+
+/**
+ * Memoized results of `returns_this_analyzer::method_returns_this`.
+ *
+ * This is shared by all model generators, so that the analysis runs at most
+ * once per method. This is thread-safe.
+ */
+class ReturnsThisCache final {
+ public:
+  ReturnsThisCache() = default;
+  ReturnsThisCache(const ReturnsThisCache&) = delete;
+  ReturnsThisCache(ReturnsThisCache&&) = delete;
+  ReturnsThisCache& operator=(const ReturnsThisCache&) = delete;
+  ReturnsThisCache& operator=(ReturnsThisCache&&) = delete;
+  ~ReturnsThisCache() = default;
+
+  bool method_returns_this(const Method* method) const;
+
+  std::size_t size() const {
+    return results_.size();
+  }
+
+ private:
+  mutable ConcurrentMap<const Method*, std::optional<bool>> results_;
+};
 } // namespace marianatrench
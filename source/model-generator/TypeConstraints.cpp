@@ -25,20 +25,32 @@ TypeNameConstraint::TypeNameConstraint(const std::string& regex_string)
 MethodHashedSet TypeNameConstraint::may_satisfy(
     const MethodMappings& method_mappings,
     MaySatisfyMethodConstraintKind constraint_kind) const {
-  auto string_pattern = as_string_literal(pattern_);
-  if (!string_pattern) {
-    return MethodHashedSet::top();
-  }
+  const MethodMapping* mapping = nullptr;
   switch (constraint_kind) {
     case MaySatisfyMethodConstraintKind::Parent:
-      return method_mappings.class_to_methods.get(
-          *string_pattern, MethodHashedSet::bottom());
+      mapping = &method_mappings.class_to_methods;
+      break;
     case MaySatisfyMethodConstraintKind::Extends:
-      return method_mappings.class_to_override_methods.get(
-          *string_pattern, MethodHashedSet::bottom());
+      mapping = &method_mappings.class_to_override_methods;
+      break;
     default:
       mt_unreachable();
   }
+
+  if (auto string_pattern = as_string_literal(pattern_)) {
+    return mapping->get(*string_pattern);
+  }
+  if (constraint_kind == MaySatisfyMethodConstraintKind::Parent) {
+    auto found =
+        method_mappings.class_pattern_to_methods.find(pattern_.pattern());
+    if (found != method_mappings.class_pattern_to_methods.end()) {
+      return found->second;
+    }
+  }
+  if (auto prefix = as_string_literal_prefix(pattern_)) {
+    return mapping->with_prefix(*prefix);
+  }
+  return MethodHashedSet::top();
 }
 
 bool TypeNameConstraint::satisfy(const DexType* type) const {
@@ -91,25 +103,34 @@ MethodHashedSet ExtendsConstraint::may_satisfy(
 };
 
 bool ExtendsConstraint::satisfy(const DexType* type) const {
-  auto* current_type = type;
-  do {
-    if ((include_self_ || current_type != type) &&
-        inner_constraint_->satisfy(current_type)) {
+  return include_self_ ? satisfy_including_self(type)
+                       : satisfy_excluding_self(type);
+}
+
+bool ExtendsConstraint::satisfy_including_self(const DexType* type) const {
+  if (auto cached = cache_.get(type, std::nullopt)) {
+    return *cached;
+  }
+
+  bool result =
+      inner_constraint_->satisfy(type) || satisfy_excluding_self(type);
+  cache_.emplace(type, result);
+  return result;
+}
+
+bool ExtendsConstraint::satisfy_excluding_self(const DexType* type) const {
+  DexClass* klass = type_class(type);
+  if (!klass) {
+    return false;
+  }
+  for (auto* interface : *klass->get_interfaces()) {
+    if (inner_constraint_->satisfy(interface)) {
       return true;
     }
-    DexClass* klass = type_class(current_type);
-    if (!klass) {
-      break;
-    }
-    for (auto* interface : *klass->get_interfaces()) {
-      if (inner_constraint_->satisfy(interface)) {
-        return true;
-      }
-    }
+  }
 
-    current_type = klass->get_super_class();
-  } while (current_type);
-  return false;
+  const auto* super_class = klass->get_super_class();
+  return super_class && satisfy_including_self(super_class);
 }
 
 bool ExtendsConstraint::operator==(const TypeConstraint& other) const {
@@ -131,7 +152,16 @@ bool SuperConstraint::satisfy(const DexType* type) const {
     return false;
   }
   type = klass->get_super_class();
-  return type && inner_constraint_->satisfy(type);
+  if (!type) {
+    return false;
+  }
+
+  if (auto cached = cache_.get(type, std::nullopt)) {
+    return *cached;
+  }
+  bool result = inner_constraint_->satisfy(type);
+  cache_.emplace(type, result);
+  return result;
 }
 
 bool SuperConstraint::operator==(const TypeConstraint& other) const {
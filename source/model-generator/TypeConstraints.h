@@ -7,8 +7,12 @@
 
 #pragma once
 
+#include <optional>
+
 #include <re2/re2.h>
 
+#include <ConcurrentContainers.h>
+
 #include <mariana-trench/Access.h>
 #include <mariana-trench/Context.h>
 #include <mariana-trench/Model.h>
@@ -49,6 +53,10 @@ class TypeNameConstraint final : public TypeConstraint {
   bool satisfy(const DexType* type) const override;
   bool operator==(const TypeConstraint& other) const override;
 
+  const re2::RE2& pattern() const {
+    return pattern_;
+  }
+
  private:
   re2::RE2 pattern_;
 };
@@ -79,21 +87,34 @@ class ExtendsConstraint final : public TypeConstraint {
   bool satisfy(const DexType* type) const override;
   bool operator==(const TypeConstraint& other) const override;
 
+ private:
+  /**
+   * Check the type itself, its interfaces and its superclasses. Results are
+   * memoized, hence each superclass chain is only walked once for all the
+   * types that share it.
+   */
+  bool satisfy_including_self(const DexType* type) const;
+
+  /* Check the interfaces and superclasses of the type, but not the type. */
+  bool satisfy_excluding_self(const DexType* type) const;
+
  private:
   std::unique_ptr<TypeConstraint> inner_constraint_;
   bool include_self_;
+  mutable ConcurrentMap<const DexType*, std::optional<bool>> cache_;
 };
 
 class SuperConstraint final : public TypeConstraint {
  public:
   explicit SuperConstraint(std::unique_ptr<TypeConstraint> inner_constraint);
   /* Check if the direct superclass of the given type satisfies the given type
-   * constraint. */
+   * constraint. Results are memoized per superclass. */
   bool satisfy(const DexType* type) const override;
   bool operator==(const TypeConstraint& other) const override;
 
  private:
   std::unique_ptr<TypeConstraint> inner_constraint_;
+  mutable ConcurrentMap<const DexType*, std::optional<bool>> cache_;
 };
 
 class IsClassTypeConstraint final : public TypeConstraint {
@@ -417,3 +417,63 @@ TEST_F(FieldConstraintTest, AnyOfFieldConstraintFromJson) {
           })")),
       JsonValidationError);
 }
+
+TEST_F(FieldConstraintTest, FieldConstraintMaySatisfy) {
+  Scope scope;
+  auto* dex_field = redex::create_field(
+      scope, "LClass;", /* field */ {"field_name", type::java_lang_String()});
+  auto* dex_other_field = redex::create_field(
+      scope,
+      "LOther;",
+      /* field */ {"other_field", type::java_lang_String()});
+  DexStore store("stores");
+  store.add_classes(scope);
+  auto context = test::make_context(store);
+  const auto* field = context.fields->get(dex_field);
+  const auto* other_field = context.fields->get(dex_other_field);
+  auto field_mappings = FieldMappings(*context.fields);
+
+  EXPECT_EQ(
+      FieldNameConstraint("field_name").may_satisfy(field_mappings),
+      FieldHashedSet{field});
+  EXPECT_EQ(
+      FieldNameConstraint("other.*").may_satisfy(field_mappings),
+      FieldHashedSet{other_field});
+  EXPECT_TRUE(
+      FieldNameConstraint(".*_field").may_satisfy(field_mappings).is_top());
+  EXPECT_TRUE(
+      FieldNameConstraint("unknown").may_satisfy(field_mappings).is_bottom());
+  EXPECT_EQ(
+      SignatureFieldConstraint("LClass;\\.field_name:Ljava/lang/String;")
+          .may_satisfy(field_mappings),
+      FieldHashedSet{field});
+  EXPECT_EQ(
+      ParentFieldConstraint(std::make_unique<TypeNameConstraint>("LOther;"))
+          .may_satisfy(field_mappings),
+      FieldHashedSet{other_field});
+  EXPECT_TRUE(HasAnnotationFieldConstraint("LAnnotation;", std::nullopt)
+                  .may_satisfy(field_mappings)
+                  .is_top());
+
+  {
+    std::vector<std::unique_ptr<FieldConstraint>> constraints;
+    constraints.push_back(std::make_unique<FieldNameConstraint>(".*"));
+    constraints.push_back(std::make_unique<ParentFieldConstraint>(
+        std::make_unique<TypeNameConstraint>("LClass;")));
+    EXPECT_EQ(
+        AllOfFieldConstraint(std::move(constraints))
+            .may_satisfy(field_mappings),
+        FieldHashedSet{field});
+  }
+
+  {
+    std::vector<std::unique_ptr<FieldConstraint>> constraints;
+    constraints.push_back(std::make_unique<FieldNameConstraint>("field_name"));
+    constraints.push_back(std::make_unique<FieldNameConstraint>("other_field"));
+    EXPECT_EQ(
+        AnyOfFieldConstraint(std::move(constraints))
+            .may_satisfy(field_mappings),
+        (FieldHashedSet{field, other_field}));
+  }
+  EXPECT_TRUE(AnyOfFieldConstraint({}).may_satisfy(field_mappings).is_top());
+}
@@ -11,6 +11,7 @@
 #include <mariana-trench/JsonValidation.h>
 #include <mariana-trench/Redex.h>
 #include <mariana-trench/model-generator/JsonModelGenerator.h>
+#include <mariana-trench/model-generator/ReturnsThisAnalyzer.h>
 #include <mariana-trench/tests/Test.h>
 
 using namespace marianatrench;
@@ -102,6 +103,29 @@ TEST_F(MethodConstraintTest, AllOfMethodConstraintSatisfy) {
   }
 }
 
+TEST_F(MethodConstraintTest, AllOfMethodConstraintCost) {
+  std::vector<std::unique_ptr<MethodConstraint>> constraints;
+  constraints.push_back(std::make_unique<ParentConstraint>(
+      std::make_unique<TypeNameConstraint>("Landroid/util/Log;")));
+  constraints.push_back(std::make_unique<MethodNameConstraint>("println"));
+  constraints.push_back(std::make_unique<IsStaticConstraint>(true));
+  auto constraint = AllOfMethodConstraint(std::move(constraints));
+
+  // Cheap constraints are evaluated first.
+  auto children = constraint.children();
+  ASSERT_EQ(children.size(), 3);
+  EXPECT_TRUE(*children[0] == IsStaticConstraint(true));
+  EXPECT_TRUE(*children[1] == MethodNameConstraint("println"));
+  EXPECT_TRUE(
+      *children[2] ==
+      ParentConstraint(
+          std::make_unique<TypeNameConstraint>("Landroid/util/Log;")));
+  EXPECT_EQ(
+      constraint.cost(),
+      MethodConstraint::kCheapCost + MethodConstraint::kMatchCost +
+          MethodConstraint::kExpensiveCost);
+}
+
 TEST_F(MethodConstraintTest, AnyOfMethodConstraintSatisfy) {
   Scope scope;
   auto context = test::make_empty_context();
@@ -411,6 +435,50 @@ TEST_F(MethodConstraintTest, ExtendsConstraintSatisfy) {
                    .satisfy(type::java_lang_Object()));
 }
 
+TEST_F(MethodConstraintTest, ExtendsConstraintSatisfyMemoized) {
+  auto* interface_type =
+      DexType::make_type(DexString::make_string("Landroid/os/Parcelable;"));
+  ClassCreator interface_creator(interface_type);
+  interface_creator.set_access(DexAccessFlags::ACC_INTERFACE);
+  interface_creator.set_super(type::java_lang_Object());
+  interface_creator.create();
+
+  ClassCreator base_creator(
+      DexType::make_type(DexString::make_string("Landroid/app/Activity;")));
+  base_creator.set_super(type::java_lang_Object());
+  base_creator.add_interface(interface_type);
+  auto* base_class = base_creator.create();
+
+  ClassCreator first_creator(
+      DexType::make_type(DexString::make_string("LFirstActivity;")));
+  first_creator.set_super(base_class->get_type());
+  auto* first_class = first_creator.create();
+
+  ClassCreator second_creator(
+      DexType::make_type(DexString::make_string("LSecondActivity;")));
+  second_creator.set_super(first_class->get_type());
+  auto* second_class = second_creator.create();
+
+  auto extends_activity = ExtendsConstraint(
+      std::make_unique<TypeNameConstraint>("Landroid/app/Activity;"),
+      /* include_self */ false);
+  auto extends_parcelable = ExtendsConstraint(
+      std::make_unique<TypeNameConstraint>("Landroid/os/Parcelable;"));
+
+  // Queries are answered consistently once the superclass chain is memoized.
+  for (int i = 0; i < 2; i++) {
+    EXPECT_TRUE(extends_activity.satisfy(second_class->get_type()));
+    EXPECT_TRUE(extends_activity.satisfy(first_class->get_type()));
+    EXPECT_FALSE(extends_activity.satisfy(base_class->get_type()));
+    EXPECT_FALSE(extends_activity.satisfy(type::java_lang_Object()));
+
+    EXPECT_TRUE(extends_parcelable.satisfy(second_class->get_type()));
+    EXPECT_TRUE(extends_parcelable.satisfy(base_class->get_type()));
+    EXPECT_TRUE(extends_parcelable.satisfy(interface_type));
+    EXPECT_FALSE(extends_parcelable.satisfy(type::java_lang_Object()));
+  }
+}
+
 TEST_F(MethodConstraintTest, SuperConstraintSatisfy) {
   std::string class_name = "Landroid/util/Log;";
   std::string super_class_name = "Landroid/util/LogBase;";
@@ -514,14 +582,20 @@ TEST_F(MethodConstraintTest, ReturnsThisConstraint) {
     method->get_code()->build_cfg();
   }
 
-  EXPECT_TRUE(
-      ReturnsThisConstraint().satisfy(context.methods->create(methods[0])));
+  EXPECT_TRUE(ReturnsThisConstraint(context).satisfy(
+      context.methods->create(methods[0])));
 
-  EXPECT_FALSE(
-      ReturnsThisConstraint().satisfy(context.methods->create(methods[1])));
+  EXPECT_FALSE(ReturnsThisConstraint(context).satisfy(
+      context.methods->create(methods[1])));
 
-  EXPECT_FALSE(
-      ReturnsThisConstraint().satisfy(context.methods->create(methods[2])));
+  EXPECT_FALSE(ReturnsThisConstraint(context).satisfy(
+      context.methods->create(methods[2])));
+
+  // Results are shared by all constraints.
+  EXPECT_EQ(context.returns_this_cache->size(), 3);
+  EXPECT_TRUE(ReturnsThisConstraint(context).satisfy(
+      context.methods->create(methods[0])));
+  EXPECT_EQ(context.returns_this_cache->size(), 3);
 }
 
 TEST_F(MethodConstraintTest, VisibilityMethodConstraint) {
@@ -1619,11 +1693,64 @@ TEST_F(MethodConstraintTest, MethodNameConstraintMaySatisfy) {
   EXPECT_TRUE(MethodNameConstraint("method_name_nonexistent")
                   .may_satisfy(method_mappings)
                   .is_bottom());
-  EXPECT_TRUE(MethodNameConstraint("method_name_*")
+  EXPECT_EQ(
+      MethodNameConstraint("method_name_.*").may_satisfy(method_mappings),
+      marianatrench::MethodHashedSet(
+          {context.methods->get(method_a), context.methods->get(method_b)}));
+  EXPECT_EQ(
+      MethodNameConstraint("method_name_a.*").may_satisfy(method_mappings),
+      marianatrench::MethodHashedSet({context.methods->get(method_a)}));
+  EXPECT_TRUE(MethodNameConstraint("method_nonexistent.*")
+                  .may_satisfy(method_mappings)
+                  .is_bottom());
+  EXPECT_TRUE(MethodNameConstraint(".*_name_a")
+                  .may_satisfy(method_mappings)
+                  .is_top());
+  EXPECT_TRUE(MethodNameConstraint("method_name_a|method_name_b")
                   .may_satisfy(method_mappings)
                   .is_top());
 }
 
+TEST_F(MethodConstraintTest, IndexedPatternsMaySatisfy) {
+  Scope scope;
+  auto* method_a =
+      redex::create_void_method(scope, "LClass;", "method_name_a", "", "V");
+  auto* method_b =
+      redex::create_void_method(scope, "LOther;", "other_name_b", "", "V");
+  DexStore store("test-stores");
+  store.add_classes(scope);
+  auto context = test::make_context(store);
+  auto method_mappings = MethodMappings(*context.methods);
+
+  std::vector<std::unique_ptr<MethodConstraint>> constraints;
+  constraints.push_back(std::make_unique<MethodNameConstraint>(".*_name_a"));
+  constraints.push_back(std::make_unique<MethodNameConstraint>("literal"));
+  constraints.push_back(std::make_unique<ParentConstraint>(
+      std::make_unique<TypeNameConstraint>(".*Other;")));
+  auto constraint = AnyOfMethodConstraint(std::move(constraints));
+
+  MethodPatterns patterns;
+  constraint.add_patterns(patterns);
+  EXPECT_EQ(patterns.names, std::unordered_set<std::string>{".*_name_a"});
+  EXPECT_EQ(patterns.classes, std::unordered_set<std::string>{".*Other;"});
+
+  EXPECT_TRUE(MethodNameConstraint(".*_name_a")
+                  .may_satisfy(method_mappings)
+                  .is_top());
+  method_mappings.index_patterns(patterns);
+  EXPECT_EQ(
+      MethodNameConstraint(".*_name_a").may_satisfy(method_mappings),
+      marianatrench::MethodHashedSet({context.methods->get(method_a)}));
+  EXPECT_EQ(
+      ParentConstraint(std::make_unique<TypeNameConstraint>(".*Other;"))
+          .may_satisfy(method_mappings),
+      marianatrench::MethodHashedSet({context.methods->get(method_b)}));
+  EXPECT_EQ(
+      constraint.may_satisfy(method_mappings),
+      marianatrench::MethodHashedSet(
+          {context.methods->get(method_a), context.methods->get(method_b)}));
+}
+
 TEST_F(MethodConstraintTest, ParentConstraintMaySatisfy) {
   Scope scope;
   auto* method_a =
@@ -1660,8 +1787,13 @@ TEST_F(MethodConstraintTest, ParentConstraintMaySatisfy) {
                   .may_satisfy(method_mappings)
                   .is_bottom());
 
+  EXPECT_EQ(
+      ParentConstraint(std::make_unique<TypeNameConstraint>("LSub.*"))
+          .may_satisfy(method_mappings),
+      marianatrench::MethodHashedSet({context.methods->get(method_b)}));
+
   EXPECT_TRUE(
-      ParentConstraint(std::make_unique<TypeNameConstraint>("L(Sub)?Class;"))
+      ParentConstraint(std::make_unique<TypeNameConstraint>(".*Class;"))
           .may_satisfy(method_mappings)
           .is_top());
 
@@ -1816,6 +1948,19 @@ TEST_F(MethodConstraintTest, AnyOfMethodConstraintMaySatisfy) {
     constraints.push_back(
         std::make_unique<MethodNameConstraint>("method_name_*"));
 
+    EXPECT_EQ(
+        AnyOfMethodConstraint(std::move(constraints))
+            .may_satisfy(method_mappings),
+        marianatrench::MethodHashedSet(
+            {context.methods->get(method_a), context.methods->get(method_b)}));
+  }
+
+  {
+    std::vector<std::unique_ptr<MethodConstraint>> constraints;
+    constraints.push_back(
+        std::make_unique<MethodNameConstraint>("method_name_a"));
+    constraints.push_back(std::make_unique<MethodNameConstraint>(".*_b"));
+
     EXPECT_TRUE(AnyOfMethodConstraint(std::move(constraints))
                     .may_satisfy(method_mappings)
                     .is_top());
@@ -1824,7 +1969,8 @@ TEST_F(MethodConstraintTest, AnyOfMethodConstraintMaySatisfy) {
 
 TEST_F(MethodConstraintTest, NotMethodConstraintMaySatisfy) {
   Scope scope;
-  redex::create_void_method(scope, "class_name", "method_name_a");
+  auto* method_a =
+      redex::create_void_method(scope, "class_name", "method_name_a");
   auto* method_b =
       redex::create_void_method(scope, "class_name_b", "method_name_b");
   DexStore store("test-stores");
@@ -1847,8 +1993,16 @@ TEST_F(MethodConstraintTest, NotMethodConstraintMaySatisfy) {
                   .may_satisfy(method_mappings)
                   .is_top());
 
+  EXPECT_EQ(
+      NotMethodConstraint(
+          std::make_unique<MethodNameConstraint>("method_name_b.*"))
+          .may_satisfy(method_mappings),
+      marianatrench::MethodHashedSet(
+          {context.methods->get(array_allocation_method),
+           context.methods->get(method_a)}));
+
   EXPECT_TRUE(NotMethodConstraint(
-                  std::make_unique<MethodNameConstraint>("method_name*"))
+                  std::make_unique<MethodNameConstraint>(".*name.*"))
                   .may_satisfy(method_mappings)
                   .is_top());
 }
@@ -31,16 +31,11 @@ bool compare_methods(const Method* left, const Method* right) {
 };
 
 std::unordered_map<std::string, std::vector<const Method*>> sort_mapping(
-    const ConcurrentMap<std::string, marianatrench::MethodHashedSet>& mapping) {
-  auto unordered_mapping =
-      std::unordered_map<std::string, marianatrench::MethodHashedSet>(
-          mapping.begin(), mapping.end());
+    const marianatrench::MethodMapping& mapping) {
   std::unordered_map<std::string, std::vector<const Method*>> result;
 
-  for (const auto& [key, methods] : unordered_mapping) {
-    std::vector<const Method*> new_methods(
-        methods.elements().begin(), methods.elements().end());
-    result.insert({key, new_methods});
+  for (const auto& [key, methods] : mapping) {
+    result.insert({std::string(key), methods});
   }
 
   for (auto& [_key, methods] : result) {
@@ -199,5 +194,10 @@ TEST_F(ModelGeneratorTest, MappingGenerator) {
       std::sort(pair.second.begin(), pair.second.end(), compare_methods);
     }
     EXPECT_EQ(signature_to_methods_map, expected_signature_to_methods);
+
+    EXPECT_EQ(method_mappings.name_to_methods.with_prefix("onRe").size(), 4);
+    EXPECT_EQ(method_mappings.name_to_methods.with_prefix("").size(), 5);
+    EXPECT_TRUE(method_mappings.name_to_methods.get("onRe").is_bottom());
+    EXPECT_EQ(method_mappings.class_to_methods.find("LUnknown;"), nullptr);
   }
 }
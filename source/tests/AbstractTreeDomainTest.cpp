@@ -724,6 +724,45 @@ TEST_F(AbstractTreeDomainTest, DepthExceedingMaxLeaves) {
   EXPECT_EQ(tree.depth_exceeding_max_leaves(3), 2);
 }
 
+TEST_F(AbstractTreeDomainTest, LeavesAndHeight) {
+  const auto* x = DexString::make_string("x");
+  const auto* y = DexString::make_string("y");
+  const auto* z = DexString::make_string("z");
+
+  auto tree = IntSetTree{IntSet{1}};
+  EXPECT_EQ(tree.leaves(), 0);
+  EXPECT_EQ(tree.height(), 0);
+
+  tree.write(Path{x, y}, IntSet{2}, UpdateKind::Weak);
+  EXPECT_EQ(tree.leaves(), 1);
+  EXPECT_EQ(tree.height(), 2);
+
+  // The cache of the copy is invalidated when it changes.
+  auto copy = tree;
+  copy.write(Path{x, z}, IntSet{3}, UpdateKind::Weak);
+  copy.write(Path{y}, IntSet{4}, UpdateKind::Weak);
+  EXPECT_EQ(copy.leaves(), 3);
+  EXPECT_EQ(copy.height(), 2);
+  EXPECT_EQ(tree.leaves(), 1);
+  EXPECT_EQ(tree.height(), 2);
+
+  tree.join_with(IntSetTree{{Path{z, x, y}, IntSet{5}}});
+  EXPECT_EQ(tree.leaves(), 2);
+  EXPECT_EQ(tree.height(), 3);
+
+  tree.write(Path{x}, IntSet{6}, UpdateKind::Strong);
+  EXPECT_EQ(tree.leaves(), 2);
+  EXPECT_EQ(tree.height(), 3);
+
+  tree.collapse_deeper_than(1);
+  EXPECT_EQ(tree.leaves(), 2);
+  EXPECT_EQ(tree.height(), 1);
+
+  tree.limit_leaves(1);
+  EXPECT_EQ(tree.leaves(), 0);
+  EXPECT_EQ(tree.height(), 0);
+}
+
 TEST_F(AbstractTreeDomainTest, LimitLeaves) {
   const auto* x = DexString::make_string("x");
   const auto* y = DexString::make_string("y");
@@ -1061,6 +1100,49 @@ TEST_F(AbstractTreeDomainTest, RawRead) {
   EXPECT_EQ(tree.raw_read(Path{x, y}), IntSetTree::bottom());
 }
 
+TEST_F(AbstractTreeDomainTest, ReadBorrowed) {
+  const auto* x = DexString::make_string("x");
+  const auto* y = DexString::make_string("y");
+  const auto* z = DexString::make_string("z");
+
+  auto propagate = [](IntSet elements, Path::Element /* path_element */) {
+    return elements;
+  };
+
+  auto tree = IntSetTree{
+      {Path{x}, IntSet{1}},
+      {Path{x, z}, IntSet{2}},
+      {Path{y, z}, IntSet{3}},
+  };
+
+  // Nothing to propagate, the subtree is borrowed.
+  auto root = tree.read_borrowed(Path{}, propagate);
+  EXPECT_FALSE(root.owned());
+  EXPECT_EQ(&*root, &tree);
+
+  auto x_subtree = tree.read_borrowed(Path{x}, propagate);
+  EXPECT_FALSE(x_subtree.owned());
+  EXPECT_EQ(*x_subtree, tree.read(Path{x}));
+
+  auto y_z_subtree = tree.read_borrowed(Path{y, z}, propagate);
+  EXPECT_FALSE(y_z_subtree.owned());
+  EXPECT_EQ(*y_z_subtree, (IntSetTree{IntSet{3}}));
+
+  auto missing = tree.read_borrowed(Path{z}, propagate);
+  EXPECT_FALSE(missing.owned());
+  EXPECT_EQ(*missing, IntSetTree::bottom());
+
+  // Elements of `x` are propagated down, the subtree is built.
+  auto x_z_subtree = tree.read_borrowed(Path{x, z}, propagate);
+  EXPECT_TRUE(x_z_subtree.owned());
+  EXPECT_EQ(*x_z_subtree, (IntSetTree{IntSet{1, 2}}));
+
+  auto moved = std::move(x_z_subtree);
+  EXPECT_EQ(*moved, (IntSetTree{IntSet{1, 2}}));
+  EXPECT_EQ(
+      *tree.read_borrowed(Path{x, y}, propagate), (IntSetTree{IntSet{1}}));
+}
+
 TEST_F(AbstractTreeDomainTest, Elements) {
   using Pair = std::pair<Path, IntSet>;
 
@@ -60,6 +60,30 @@ TEST_F(AccessTest, PathTruncate) {
   EXPECT_EQ(path, (Path{x, y}));
 }
 
+TEST_F(AccessTest, PathInlineCapacity) {
+  const auto* x = DexString::make_string("x");
+  const auto* y = DexString::make_string("y");
+
+  auto path = Path{};
+  for (std::size_t i = 0; i < Path::kInlineCapacity + 2; i++) {
+    path.append(i % 2 == 0 ? x : y);
+  }
+  EXPECT_EQ(path, (Path{x, y, x, y, x, y}));
+  EXPECT_EQ(
+      std::hash<Path>()(path), std::hash<Path>()(Path{x, y, x, y, x, y}));
+
+  path.pop_back();
+  EXPECT_EQ(path, (Path{x, y, x, y, x}));
+
+  path.truncate(Path::kInlineCapacity - 1);
+  EXPECT_EQ(path, (Path{x, y, x}));
+  EXPECT_EQ(std::hash<Path>()(path), std::hash<Path>()(Path{x, y, x}));
+
+  path.extend(Path{y, x, y});
+  EXPECT_EQ(path, (Path{x, y, x, y, x, y}));
+  EXPECT_NE(path, (Path{x, y, x, y, x, x}));
+}
+
 TEST_F(AccessTest, PathIsPrefixOf) {
   const auto* x = DexString::make_string("x");
   const auto* y = DexString::make_string("y");
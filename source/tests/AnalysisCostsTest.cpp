@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include <gmock/gmock.h>
+
+#include <mariana-trench/AnalysisCosts.h>
+#include <mariana-trench/Redex.h>
+#include <mariana-trench/tests/Test.h>
+
+namespace marianatrench {
+
+class AnalysisCostsTest : public test::Test {};
+
+TEST_F(AnalysisCostsTest, WriteAndRead) {
+  Scope scope;
+  auto* dex_method_a = redex::create_void_method(scope, "LClass;", "method_a");
+  auto* dex_method_b = redex::create_void_method(scope, "LClass;", "method_b");
+
+  DexStore store("store");
+  store.add_classes(scope);
+  auto context = test::make_context(store);
+  const auto* method_a = context.methods->get(dex_method_a);
+  const auto* method_b = context.methods->get(dex_method_b);
+  auto registry = Registry(context);
+
+  // Only analyzed methods are written.
+  Statistics statistics;
+  statistics.log_time(method_a, Timer());
+  statistics.log_time(method_a, Timer());
+
+  std::stringstream stream;
+  AnalysisCosts::write(stream, *context.methods, statistics, registry);
+
+  std::string header;
+  std::string line;
+  std::getline(stream, header);
+  EXPECT_EQ(
+      header, "method,analysis_seconds,analyses,model_bytes,instructions");
+  std::getline(stream, line);
+  EXPECT_THAT(line, testing::StartsWith("LClass;.method_a:()V,"));
+  EXPECT_THAT(line, testing::HasSubstr(",2,"));
+  EXPECT_FALSE(std::getline(stream, line));
+
+  std::stringstream input(
+      "method,analysis_seconds,analyses,model_bytes,instructions\n"
+      "LClass;.method_a:()V,4.000000,2,100,10\n"
+      "LClass;.method_b:()V,1.000000,1,100,10\n"
+      "LUnknown;.method:()V,100.000000,1,100,10\n");
+  auto cost_profile = AnalysisCosts::read_cost_profile(input, *context.methods);
+  EXPECT_EQ(cost_profile.size(), 2);
+  EXPECT_DOUBLE_EQ(cost_profile.at(method_a), 2.0);
+  EXPECT_DOUBLE_EQ(cost_profile.at(method_b), 1.0);
+
+  std::stringstream invalid_header("method,seconds\n");
+  EXPECT_THROW(
+      AnalysisCosts::read_cost_profile(invalid_header, *context.methods),
+      std::invalid_argument);
+
+  std::stringstream invalid_line(
+      "method,analysis_seconds,analyses,model_bytes,instructions\n"
+      "LClass;.method_a:()V,fast,2,100,10\n");
+  EXPECT_THROW(
+      AnalysisCosts::read_cost_profile(invalid_line, *context.methods),
+      std::invalid_argument);
+}
+
+} // namespace marianatrench
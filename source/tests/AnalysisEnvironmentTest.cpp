@@ -196,4 +196,49 @@ TEST_F(EnvironmentTest, JoinTwoEnvironmentWithDifferentSources) {
                   .origins = MethodSet{method}})}}));
 }
 
+TEST_F(EnvironmentTest, PruneDeadRegisters) {
+  auto context = test::make_empty_context();
+  const auto* source_kind = context.kinds->get("TestSource");
+  auto taint = TaintTree{Taint{Frame::leaf(source_kind)}};
+
+  auto parameter_1 = std::make_unique<ParameterMemoryLocation>(1);
+  auto instruction_1 = IRInstruction(OPCODE_NEW_INSTANCE);
+  auto instruction_2 = IRInstruction(OPCODE_NEW_INSTANCE);
+  auto location_1 = std::make_unique<InstructionMemoryLocation>(&instruction_1);
+  auto location_2 = std::make_unique<InstructionMemoryLocation>(&instruction_2);
+  auto* location_2_field =
+      location_2->make_field(DexString::make_string("field"));
+
+  auto environment = AnalysisEnvironment::initial();
+  environment.assign(1, parameter_1.get());
+  environment.assign(2, location_1.get());
+  environment.assign(3, location_2_field);
+  environment.assign(k_result_register, location_1.get());
+  environment.write(parameter_1.get(), taint, UpdateKind::Weak);
+  environment.write(location_1.get(), taint, UpdateKind::Weak);
+  environment.write(location_2_field, taint, UpdateKind::Weak);
+
+  // Register 3 is live, hence the root of its field is kept.
+  environment.prune_dead_registers(
+      [](Register register_id) { return register_id == 3; });
+  EXPECT_EQ(environment.memory_locations(1), MemoryLocationsDomain{});
+  EXPECT_EQ(environment.memory_locations(2), MemoryLocationsDomain{});
+  EXPECT_EQ(
+      environment.memory_locations(3),
+      MemoryLocationsDomain{location_2_field});
+  EXPECT_EQ(
+      environment.memory_locations(k_result_register),
+      MemoryLocationsDomain{location_1.get()});
+  EXPECT_EQ(environment.read(parameter_1.get()), taint);
+  EXPECT_EQ(environment.read(location_1.get()), taint);
+  EXPECT_EQ(environment.read(location_2_field), taint);
+
+  // Parameters are always kept.
+  environment.assign(k_result_register, MemoryLocationsDomain::bottom());
+  environment.prune_dead_registers([](Register) { return false; });
+  EXPECT_EQ(environment.read(parameter_1.get()), taint);
+  EXPECT_EQ(environment.read(location_1.get()), TaintTree::bottom());
+  EXPECT_EQ(environment.read(location_2_field), TaintTree::bottom());
+}
+
 } // namespace marianatrench
@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+
+#include <mariana-trench/Arena.h>
+#include <mariana-trench/tests/Test.h>
+
+namespace marianatrench {
+
+class ArenaTest : public test::Test {};
+
+namespace {
+
+class Tracked {
+ public:
+  Tracked(std::vector<int>& destroyed, int value)
+      : destroyed_(destroyed), value_(value) {}
+
+  ~Tracked() {
+    destroyed_.push_back(value_);
+  }
+
+  int value() const {
+    return value_;
+  }
+
+ private:
+  std::vector<int>& destroyed_;
+  int value_;
+};
+
+} // namespace
+
+TEST_F(ArenaTest, Create) {
+  std::vector<int> destroyed;
+  {
+    Arena arena(/* block_size */ 64);
+    std::vector<Tracked*> objects;
+    for (int value = 0; value < 100; value++) {
+      objects.push_back(arena.create<Tracked>(destroyed, value));
+    }
+    for (int value = 0; value < 100; value++) {
+      EXPECT_EQ(objects[value]->value(), value);
+    }
+
+    auto* string = arena.create<std::string>(1000, 'x');
+    EXPECT_EQ(string->size(), 1000);
+    EXPECT_TRUE(destroyed.empty());
+  }
+
+  // Objects are destroyed in reverse order of creation.
+  EXPECT_EQ(destroyed.size(), 100);
+  for (int value = 0; value < 100; value++) {
+    EXPECT_EQ(destroyed[value], 99 - value);
+  }
+}
+
+TEST_F(ArenaTest, Alignment) {
+  Arena arena(/* block_size */ 128);
+  for (int i = 0; i < 100; i++) {
+    auto* character = arena.create<char>('a');
+    EXPECT_EQ(*character, 'a');
+    auto* number = arena.create<std::uint64_t>(i);
+    EXPECT_EQ(
+        reinterpret_cast<std::uintptr_t>(number) % alignof(std::uint64_t), 0);
+    EXPECT_EQ(*number, i);
+  }
+
+  // Objects larger than a block get their own block.
+  struct Large {
+    char bytes[1024];
+  };
+  EXPECT_NE(arena.create<Large>(), nullptr);
+  EXPECT_GE(arena.reserved_bytes(), 1024);
+}
+
+TEST_F(ArenaTest, Reset) {
+  std::vector<int> destroyed;
+  Arena arena(/* block_size */ 64);
+  for (int value = 0; value < 10; value++) {
+    arena.create<Tracked>(destroyed, value);
+  }
+  struct Large {
+    char bytes[1024];
+  };
+  arena.create<Large>();
+  auto reserved_bytes = arena.reserved_bytes();
+
+  arena.reset();
+  EXPECT_EQ(destroyed.size(), 10);
+  EXPECT_EQ(destroyed.front(), 9);
+  // Blocks of the default size are kept, the large block is released.
+  EXPECT_EQ(arena.reserved_bytes(), reserved_bytes - 1024);
+
+  // The kept blocks are reused for the same objects.
+  destroyed.clear();
+  for (int value = 0; value < 10; value++) {
+    EXPECT_EQ(arena.create<Tracked>(destroyed, value)->value(), value);
+  }
+  EXPECT_EQ(arena.reserved_bytes(), reserved_bytes - 1024);
+  arena.reset();
+  EXPECT_EQ(destroyed.size(), 10);
+}
+
+} // namespace marianatrench
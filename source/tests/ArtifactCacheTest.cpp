@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <boost/filesystem.hpp>
+#include <gmock/gmock.h>
+
+#include <mariana-trench/ArtifactCache.h>
+#include <mariana-trench/tests/Test.h>
+
+namespace marianatrench {
+
+class ArtifactCacheTest : public test::Test {};
+
+namespace {
+
+boost::filesystem::path temporary_directory() {
+  auto directory = boost::filesystem::temp_directory_path() /
+      boost::filesystem::unique_path("mariana-trench-%%%%-%%%%");
+  boost::filesystem::create_directories(directory);
+  return directory;
+}
+
+std::string read_file(const boost::filesystem::path& path) {
+  std::string content;
+  boost::filesystem::load_string_file(path, content);
+  return content;
+}
+
+std::size_t count_files(const boost::filesystem::path& directory) {
+  return static_cast<std::size_t>(std::distance(
+      boost::filesystem::directory_iterator(directory),
+      boost::filesystem::directory_iterator()));
+}
+
+void test_round_trip(
+    const ArtifactCache& cache,
+    const boost::filesystem::path& directory) {
+  auto run = directory / "run";
+  boost::filesystem::create_directories(run);
+  boost::filesystem::save_string_file(run / "fingerprints.json", "{}");
+  boost::filesystem::save_string_file(run / "model@00000-of-00001.json", "a");
+  boost::filesystem::save_string_file(run / "types", "b");
+
+  EXPECT_FALSE(cache.fetch("base", directory / "missing"));
+
+  cache.store(
+      "base",
+      {{"fingerprints.json", run / "fingerprints.json"},
+       {"model@00000-of-00001.json", run / "model@00000-of-00001.json"},
+       {"types_cache.json", run / "types"},
+       {"library_summary.bin", run / "does-not-exist"}});
+
+  auto fetched = directory / "fetched";
+  EXPECT_TRUE(cache.fetch("base", fetched));
+  EXPECT_EQ(read_file(fetched / "fingerprints.json"), "{}");
+  EXPECT_EQ(read_file(fetched / "model@00000-of-00001.json"), "a");
+  EXPECT_EQ(read_file(fetched / "types_cache.json"), "b");
+  EXPECT_FALSE(boost::filesystem::exists(fetched / "library_summary.bin"));
+
+  // Keys are replaced.
+  boost::filesystem::save_string_file(run / "types", "c");
+  cache.store("base", {{"types_cache.json", run / "types"}});
+  boost::filesystem::remove_all(fetched);
+  EXPECT_TRUE(cache.fetch("base", fetched));
+  EXPECT_EQ(read_file(fetched / "types_cache.json"), "c");
+  EXPECT_FALSE(boost::filesystem::exists(fetched / "fingerprints.json"));
+
+  EXPECT_THROW(cache.fetch("../base", fetched), std::invalid_argument);
+}
+
+} // namespace
+
+TEST_F(ArtifactCacheTest, ObjectName) {
+  auto directory = temporary_directory();
+  boost::filesystem::save_string_file(directory / "a", "content");
+  boost::filesystem::save_string_file(directory / "b", "content");
+  boost::filesystem::save_string_file(directory / "c", "other content");
+  boost::filesystem::save_string_file(directory / "empty", "");
+
+  EXPECT_EQ(
+      ArtifactCache::object_name(directory / "a"),
+      ArtifactCache::object_name(directory / "b"));
+  EXPECT_NE(
+      ArtifactCache::object_name(directory / "a"),
+      ArtifactCache::object_name(directory / "c"));
+  EXPECT_EQ(
+      ArtifactCache::object_name(directory / "empty"), "cbf29ce484222325-0");
+
+  boost::filesystem::remove_all(directory);
+}
+
+TEST_F(ArtifactCacheTest, DirectoryBackend) {
+  auto directory = temporary_directory();
+  auto cache = ArtifactCache::from_location((directory / "cache").native());
+  test_round_trip(*cache, directory);
+
+  // Identical files are stored once, and unused objects are kept.
+  EXPECT_EQ(count_files(directory / "cache" / "objects"), 4);
+  EXPECT_EQ(count_files(directory / "cache" / "keys"), 1);
+
+  boost::filesystem::remove_all(directory);
+}
+
+TEST_F(ArtifactCacheTest, CommandBackend) {
+  auto directory = temporary_directory();
+  auto script = directory / "cache.sh";
+  boost::filesystem::save_string_file(
+      script,
+      "#!/bin/sh\n"
+      "root=\"$(dirname \"$0\")/remote\"\n"
+      "case \"$1\" in\n"
+      "  fetch) cp \"$root/$2\" \"$3\" 2>/dev/null ;;\n"
+      "  store) mkdir -p \"$(dirname \"$root/$2\")\" && cp \"$3\" \"$root/$2\" ;;\n"
+      "  contains) test -f \"$root/$2\" ;;\n"
+      "esac\n");
+  boost::filesystem::permissions(script, boost::filesystem::owner_all);
+
+  auto cache = ArtifactCache::from_location("command:" + script.native());
+  test_round_trip(*cache, directory);
+  EXPECT_EQ(count_files(directory / "remote" / "objects"), 4);
+
+  boost::filesystem::remove_all(directory);
+}
+
+} // namespace marianatrench
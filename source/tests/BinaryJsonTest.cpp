@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <sstream>
+
+#include <gmock/gmock.h>
+
+#include <mariana-trench/BinaryJson.h>
+#include <mariana-trench/tests/Test.h>
+
+namespace marianatrench {
+
+class BinaryJsonTest : public test::Test {};
+
+namespace {
+
+std::vector<Json::Value> round_trip(const std::vector<Json::Value>& values) {
+  BinaryJsonWriter writer;
+  for (const auto& value : values) {
+    writer.add(value);
+  }
+  std::stringstream stream;
+  writer.write(stream);
+  auto data = stream.str();
+
+  std::vector<Json::Value> result;
+  BinaryJsonReader reader(data);
+  while (auto value = reader.next()) {
+    result.push_back(*value);
+  }
+  return result;
+}
+
+} // namespace
+
+TEST_F(BinaryJsonTest, RoundTrip) {
+  EXPECT_EQ(round_trip({}), std::vector<Json::Value>{});
+
+  std::vector<Json::Value> values = {
+      test::parse_json("null"),
+      test::parse_json("true"),
+      test::parse_json("false"),
+      test::parse_json("-42"),
+      test::parse_json("18446744073709551615"),
+      test::parse_json("3.25"),
+      test::parse_json(R"("LClass;.method:()V")"),
+      test::parse_json(R"([1, "a", [], {}])"),
+      test::parse_json(R"({
+        "method": "LClass;.method:()V",
+        "generations": [
+          {"kind": "Source", "caller_port": "Return", "distance": 1}
+        ],
+        "sinks": [
+          {"kind": "Sink", "caller_port": "Argument(1)", "distance": 0}
+        ]
+      })"),
+  };
+  EXPECT_EQ(round_trip(values), values);
+}
+
+TEST_F(BinaryJsonTest, InternStrings) {
+  auto value = test::parse_json(R"({
+    "kind": "ThisIsAVeryLongKindNameThatIsRepeated",
+    "other": "ThisIsAVeryLongKindNameThatIsRepeated"
+  })");
+
+  BinaryJsonWriter once;
+  once.add(value);
+  std::stringstream once_stream;
+  once.write(once_stream);
+
+  BinaryJsonWriter twice;
+  twice.add(value);
+  twice.add(value);
+  std::stringstream twice_stream;
+  twice.write(twice_stream);
+
+  // The second record only refers to the string table.
+  EXPECT_LT(twice_stream.str().size() - once_stream.str().size(), 16);
+}
+
+TEST_F(BinaryJsonTest, Malformed) {
+  EXPECT_THROW(BinaryJsonReader("{}"), std::runtime_error);
+
+  std::string data(BinaryJson::kMagic);
+  data.push_back(static_cast<char>(BinaryJson::kVersion));
+  data.push_back(0); // No strings.
+  data.push_back(2); // Record of 2 bytes.
+  data.push_back(static_cast<char>(BinaryJson::Tag::String));
+  data.push_back(0); // Invalid string index.
+  BinaryJsonReader reader(data);
+  EXPECT_THROW(reader.next(), std::runtime_error);
+}
+
+} // namespace marianatrench
@@ -73,4 +73,34 @@ TEST_F(CanonicalNameTest, Instantiate) {
       CanonicalName(CanonicalName::InstantiatedValue{"LClass;.one:()V"}));
 }
 
+TEST_F(CanonicalNameTest, InstantiateMemoized) {
+  Scope scope;
+  auto context = test::make_empty_context();
+  const auto* method_one = context.methods->create(
+      redex::create_void_method(scope, "LClass;", "one"));
+  const auto* method_two = context.methods->create(
+      redex::create_void_method(scope, "LClass;", "two"));
+  const auto* feature1 = context.features->get("feature1");
+  const auto* feature2 = context.features->get("feature2");
+
+  auto name = CanonicalName(CanonicalName::TemplateValue{
+      "%programmatic_leaf_name%__%via_type_of%"});
+  for (int i = 0; i < 2; i++) {
+    EXPECT_EQ(
+        name.instantiate(method_one, /* via_type_ofs */ {feature1}).value(),
+        CanonicalName(
+            CanonicalName::InstantiatedValue{"LClass;.one:()V__feature1"}));
+    EXPECT_EQ(
+        name.instantiate(method_two, /* via_type_ofs */ {feature1}).value(),
+        CanonicalName(
+            CanonicalName::InstantiatedValue{"LClass;.two:()V__feature1"}));
+    EXPECT_EQ(
+        name.instantiate(method_one, /* via_type_ofs */ {feature2}).value(),
+        CanonicalName(
+            CanonicalName::InstantiatedValue{"LClass;.one:()V__feature2"}));
+    EXPECT_EQ(
+        name.instantiate(method_one, /* via_type_ofs */ {}), std::nullopt);
+  }
+}
+
 } // namespace marianatrench
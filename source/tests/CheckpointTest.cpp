@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <boost/filesystem.hpp>
+#include <gtest/gtest.h>
+
+#include <mariana-trench/Checkpoint.h>
+#include <mariana-trench/MethodBitset.h>
+#include <mariana-trench/Redex.h>
+#include <mariana-trench/Registry.h>
+#include <mariana-trench/tests/Test.h>
+
+using namespace marianatrench;
+
+namespace {
+
+class CheckpointTest : public test::Test {};
+
+} // anonymous namespace
+
+TEST_F(CheckpointTest, WriteAndLoad) {
+  Scope scope;
+  auto* dex_method = redex::create_void_method(scope, "LClass;", "method");
+  auto* dex_other = redex::create_void_method(scope, "LOther;", "other");
+
+  DexStore store("store");
+  store.add_classes(scope);
+  auto context = test::make_context(store);
+  const auto* method = context.methods->get(dex_method);
+  const auto* other = context.methods->get(dex_other);
+  const auto* sink_kind = context.kinds->get("TestSink");
+
+  auto path = boost::filesystem::temp_directory_path() /
+      boost::filesystem::unique_path("mariana-trench-checkpoint-%%%%%%%%.bin");
+  auto registry = Registry(context);
+  auto model = Model(method, context);
+  model.add_sink(
+      AccessPath(Root(Root::Kind::Argument, 0)), Frame::leaf(sink_kind));
+  registry.set(model);
+
+  MethodBitset methods_to_analyze(*context.methods);
+  methods_to_analyze.insert(other);
+  {
+    auto checkpoint = Checkpoint(path);
+    checkpoint.write(context, registry, /* iteration */ 3, methods_to_analyze);
+
+    // Later updates are not part of the checkpoint.
+    registry.set(Model(method, context));
+    checkpoint.wait();
+  }
+
+  auto resumed_registry = Registry(context);
+  auto state = Checkpoint::load(context, resumed_registry, path);
+  EXPECT_EQ(state.iteration, 3);
+  EXPECT_EQ(
+      state.methods_to_analyze,
+      (std::unordered_set<const Method*>{other}));
+  EXPECT_EQ(resumed_registry.get(method).sinks(), model.sinks());
+  EXPECT_TRUE(resumed_registry.get(other).sinks().is_bottom());
+
+  boost::filesystem::remove(path);
+}
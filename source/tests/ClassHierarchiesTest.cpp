@@ -87,4 +87,12 @@ TEST_F(ClassHierarchiesTest, ClassHierarchies) {
   EXPECT_TRUE(class_hierarchies.extends(dex_child_two->get_class()).empty());
   EXPECT_TRUE(
       class_hierarchies.extends(dex_child_one_child->get_class()).empty());
+
+  const auto& parent_extends =
+      class_hierarchies.extends(dex_parent->get_class());
+  EXPECT_EQ(parent_extends.size(), 3);
+  EXPECT_TRUE(parent_extends.contains(dex_child_one_child->get_class()));
+  EXPECT_FALSE(parent_extends.contains(dex_parent->get_class()));
+  EXPECT_FALSE(class_hierarchies.extends(dex_child_one->get_class())
+                   .contains(dex_child_two->get_class()));
 }
@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <boost/filesystem.hpp>
+#include <gmock/gmock.h>
+
+#include <mariana-trench/ConfigurationBundle.h>
+#include <mariana-trench/JsonFileCache.h>
+#include <mariana-trench/tests/Test.h>
+
+namespace marianatrench {
+
+class ConfigurationBundleTest : public test::Test {};
+
+TEST_F(ConfigurationBundleTest, WriteAndLoad) {
+  auto directory = boost::filesystem::temp_directory_path() /
+      boost::filesystem::unique_path("mariana-trench-%%%%-%%%%");
+  auto generators_directory = directory / "generators";
+  boost::filesystem::create_directories(generators_directory);
+  auto generator_path = generators_directory / "generator.json";
+  boost::filesystem::save_string_file(
+      generator_path, R"({"model_generators": []})");
+  auto rules_path = directory / "rules.json";
+  boost::filesystem::save_string_file(rules_path, R"([{"code": 1}])");
+
+  auto options = Options(
+      /* models_paths */ {},
+      /* field_models_paths */ {},
+      /* rules_paths */ {rules_path.native()},
+      /* lifecycles_paths */ {},
+      /* proguard_configuration_paths */ {},
+      /* sequential */ true,
+      /* skip_source_indexing */ true,
+      /* skip_model_generation */ false,
+      /* model_generators_configuration */ {},
+      /* model_generator_search_paths */ {generators_directory.native()});
+  auto bundle_path = directory / "configuration_bundle.bin";
+  ConfigurationBundle::write(options, bundle_path);
+
+  // Files that did not change are not parsed again.
+  auto last_write_time = boost::filesystem::last_write_time(rules_path);
+  boost::filesystem::save_string_file(rules_path, R"([{"code": 2}])");
+  boost::filesystem::last_write_time(rules_path, last_write_time);
+  boost::filesystem::save_string_file(
+      generators_directory / "other.json", R"({"model_generators": []})");
+
+  ConfigurationBundle::load(bundle_path);
+  EXPECT_TRUE(JsonFileCache::enabled());
+  EXPECT_EQ(JsonFileCache::parse(rules_path)[0]["code"].asInt(), 1);
+  EXPECT_EQ(
+      JsonFileCache::find_json_files(generators_directory.native()),
+      std::vector<boost::filesystem::path>{generator_path});
+
+  // Files that changed are parsed again.
+  boost::filesystem::last_write_time(rules_path, last_write_time + 10);
+  EXPECT_EQ(JsonFileCache::parse(rules_path)[0]["code"].asInt(), 2);
+
+  boost::filesystem::save_string_file(bundle_path, "invalid");
+  EXPECT_THROW(ConfigurationBundle::load(bundle_path), std::runtime_error);
+
+  boost::filesystem::remove_all(directory);
+}
+
+} // namespace marianatrench
@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <gmock/gmock.h>
+
+#include <mariana-trench/ConvergenceReport.h>
+#include <mariana-trench/Redex.h>
+#include <mariana-trench/tests/Test.h>
+
+namespace marianatrench {
+
+class ConvergenceReportTest : public test::Test {};
+
+TEST_F(ConvergenceReportTest, Report) {
+  Scope scope;
+  auto context = test::make_empty_context();
+  const auto* method_a = context.methods->create(
+      redex::create_void_method(scope, "LClass;", "method_a"));
+  const auto* method_b = context.methods->create(
+      redex::create_void_method(scope, "LClass;", "method_b"));
+  const auto* source_kind = context.kinds->get("TestSource");
+  const auto* other_source_kind = context.kinds->get("OtherSource");
+  const auto* sink_kind = context.kinds->get("TestSink");
+
+  auto generation = Model(
+      /* method */ nullptr,
+      context,
+      /* modes */ Model::Mode::Normal,
+      /* generations */
+      {{AccessPath(Root(Root::Kind::Return)), Frame::leaf(source_kind)}});
+  auto generations_and_sink = Model(
+      /* method */ nullptr,
+      context,
+      /* modes */ Model::Mode::Normal,
+      /* generations */
+      {{AccessPath(Root(Root::Kind::Return)), Frame::leaf(source_kind)},
+       {AccessPath(Root(Root::Kind::Return)), Frame::leaf(other_source_kind)}},
+      /* parameter_sources */ {},
+      /* sinks */
+      {{AccessPath(Root(Root::Kind::Argument, 0)), Frame::leaf(sink_kind)}});
+
+  ConvergenceReport report;
+  report.set_iteration(1);
+  report.record(method_a, Model(), generation);
+  report.record(method_b, Model(), Model());
+  report.set_iteration(2);
+  report.record(method_a, generation, generations_and_sink);
+
+  auto value = report.to_json();
+  ASSERT_EQ(value["iterations"].size(), 2);
+
+  const auto& first_iteration = value["iterations"][0];
+  EXPECT_EQ(first_iteration["iteration"].asUInt64(), 1);
+  EXPECT_EQ(first_iteration["changed_methods"].asUInt64(), 2);
+  EXPECT_EQ(
+      first_iteration["growth"],
+      test::parse_json(R"({
+        "generation_ports": 1,
+        "generation_kinds": 1,
+        "other": 1
+      })"));
+  ASSERT_EQ(first_iteration["methods"].size(), 2);
+  EXPECT_EQ(
+      first_iteration["methods"][0]["method"].asString(), method_a->show());
+  EXPECT_EQ(
+      first_iteration["methods"][1],
+      test::parse_json(R"({"method": "LClass;.method_b:()V", "other": 1})"));
+
+  const auto& second_iteration = value["iterations"][1];
+  EXPECT_EQ(second_iteration["iteration"].asUInt64(), 2);
+  EXPECT_EQ(second_iteration["changed_methods"].asUInt64(), 1);
+  EXPECT_EQ(
+      second_iteration["growth"],
+      test::parse_json(R"({
+        "generation_kinds": 1,
+        "sink_ports": 1,
+        "sink_kinds": 1
+      })"));
+}
+
+} // namespace marianatrench
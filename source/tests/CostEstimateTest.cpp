@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <gmock/gmock.h>
+
+#include <DexStore.h>
+
+#include <mariana-trench/CostEstimate.h>
+#include <mariana-trench/Dependencies.h>
+#include <mariana-trench/Redex.h>
+#include <mariana-trench/Rules.h>
+#include <mariana-trench/Scheduler.h>
+#include <mariana-trench/tests/Test.h>
+
+namespace marianatrench {
+
+class CostEstimateTest : public test::Test {};
+
+TEST_F(CostEstimateTest, Estimate) {
+  Scope scope;
+  redex::create_methods(
+      scope,
+      "LClass;",
+      {
+          R"(
+            (method (public static) "LClass;.root:()V"
+             (
+              (invoke-static () "LClass;.even:()V")
+              (return-void)
+             )
+            )
+          )",
+          R"(
+            (method (public static) "LClass;.even:()V"
+             (
+              (invoke-static () "LClass;.odd:()V")
+              (return-void)
+             )
+            )
+          )",
+          R"(
+            (method (public static) "LClass;.odd:()V"
+             (
+              (invoke-static () "LClass;.even:()V")
+              (return-void)
+             )
+            )
+          )",
+      });
+
+  DexStore store("test_store");
+  store.add_classes(scope);
+  auto context = test::make_context(store);
+  context.rules = std::make_unique<Rules>();
+  auto registry = Registry(context);
+  context.dependencies = std::make_unique<Dependencies>(
+      *context.options,
+      *context.methods,
+      *context.overrides,
+      *context.call_graph,
+      registry);
+  context.scheduler = std::make_unique<Scheduler>(
+      *context.methods, *context.dependencies, *context.statistics);
+
+  auto estimate =
+      CostEstimate(context, registry, /* resident_set_size_in_gb */ 1.0);
+  auto value = estimate.to_json();
+  EXPECT_EQ(value["methods"].asUInt64(), context.methods->size());
+  EXPECT_GE(value["methods_with_code"].asUInt64(), 3);
+  EXPECT_EQ(value["profiled_methods"].asUInt64(), 0);
+  EXPECT_GE(value["call_graph"]["edges"].asUInt64(), 3);
+  EXPECT_EQ(value["components"]["recursive"].asUInt64(), 1);
+  EXPECT_EQ(value["components"]["largest"].asUInt64(), 2);
+  EXPECT_EQ(value["components"]["size_histogram"][1].asUInt64(), 1);
+
+  // `root` is analyzed after the component of `even` and `odd`.
+  EXPECT_GT(estimate.fixpoint_seconds(), 0.0);
+  EXPECT_GE(
+      value["total_seconds"].asDouble(),
+      value["critical_path_seconds"].asDouble());
+  EXPECT_GE(
+      estimate.fixpoint_seconds(), value["critical_path_seconds"].asDouble());
+  EXPECT_GT(estimate.peak_resident_set_size_in_gb(), 1.0);
+}
+
+} // namespace marianatrench
@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <gtest/gtest.h>
+
+#include <DexStore.h>
+#include <IRCode.h>
+#include <RedexContext.h>
+
+#include <mariana-trench/DecodedInstructions.h>
+#include <mariana-trench/Redex.h>
+#include <mariana-trench/tests/Test.h>
+
+using namespace marianatrench;
+
+namespace {
+
+class DecodedInstructionsTest : public test::Test {};
+
+} // anonymous namespace
+
+TEST_F(DecodedInstructionsTest, Decode) {
+  Scope scope;
+
+  auto* dex_callee = redex::create_void_method(
+      scope,
+      /* class_name */ "LCallee;",
+      /* method_name */ "callee",
+      /* parameter_types */ "I",
+      /* return_type */ "V",
+      /* super */ nullptr,
+      /* is_static */ true);
+  auto* dex_caller = redex::create_method(scope, "LCaller;", R"(
+    (method (public static) "LCaller;.caller:(LCaller;)V"
+     (
+      (load-param-object v0)
+      (iget v0 "LCaller;.field:I")
+      (move-result-pseudo v1)
+      (invoke-static (v1) "LCallee;.callee:(I)V")
+      (return-void)
+     )
+    )
+  )");
+
+  DexStore store("test_store");
+  store.add_classes(scope);
+  auto context = test::make_context(store);
+  const auto* caller = context.methods->get(dex_caller);
+  const auto* callee = context.methods->get(dex_callee);
+
+  auto instructions =
+      DecodedInstructions(caller, *context.call_graph, *context.types);
+  const auto& cfg = caller->get_code()->cfg();
+  ASSERT_EQ(cfg.blocks().size(), 1);
+  const auto& entries = instructions.block(cfg.entry_block());
+  ASSERT_EQ(entries.size(), 5);
+
+  const auto* load_param = entries[0].instruction;
+  ASSERT_NE(load_param, nullptr);
+  EXPECT_EQ(instructions.get(load_param).call_target, std::nullopt);
+  EXPECT_EQ(instructions.get(load_param).field, nullptr);
+
+  const auto* invoke = entries[3].instruction;
+  ASSERT_NE(invoke, nullptr);
+  const auto& decoded_invoke = instructions.get(invoke);
+  ASSERT_TRUE(decoded_invoke.call_target);
+  EXPECT_EQ(decoded_invoke.call_target->resolved_base_callee(), callee);
+  ASSERT_NE(decoded_invoke.source_register_types, nullptr);
+  EXPECT_EQ(decoded_invoke.source_register_types->size(), 1);
+  EXPECT_TRUE(instructions.artificial_callees(invoke).empty());
+
+  auto empty =
+      DecodedInstructions(nullptr, *context.call_graph, *context.types);
+  EXPECT_TRUE(empty.block(cfg.entry_block()).empty());
+  EXPECT_EQ(empty.get(invoke).call_target, std::nullopt);
+}
@@ -104,6 +104,10 @@ TEST_F(DependenciesTest, InvokeVirtual) {
       resolved_base_callees(call_graph.callees(caller)),
       testing::UnorderedElementsAre(callee));
   EXPECT_TRUE(call_graph.callees(callee).empty());
+  EXPECT_TRUE(call_graph.has_callees(caller));
+  EXPECT_EQ(call_graph.callee_count(caller), 1);
+  EXPECT_FALSE(call_graph.has_callees(callee));
+  EXPECT_EQ(call_graph.callee_count(callee), 0);
 
   EXPECT_TRUE(dependencies.dependencies(caller).empty());
   EXPECT_THAT(
@@ -170,8 +174,8 @@ TEST_F(DependenciesTest, Recursion) {
 
   EXPECT_TRUE(call_graph.artificial_callees(recursive).empty());
 
-  EXPECT_EQ(dependencies.dependencies(recursive).size(), 1);
-  EXPECT_EQ(dependencies.dependencies(recursive).count(recursive), 1);
+  EXPECT_THAT(
+      dependencies.dependencies(recursive), testing::ElementsAre(recursive));
 }
 
 TEST_F(DependenciesTest, MultipleCallees) {
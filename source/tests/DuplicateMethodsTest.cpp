@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <gtest/gtest.h>
+
+#include <DexStore.h>
+#include <RedexContext.h>
+
+#include <mariana-trench/DuplicateMethods.h>
+#include <mariana-trench/Redex.h>
+#include <mariana-trench/tests/Test.h>
+
+using namespace marianatrench;
+
+namespace {
+
+class DuplicateMethodsTest : public test::Test {};
+
+} // anonymous namespace
+
+TEST_F(DuplicateMethodsTest, Groups) {
+  Scope scope;
+
+  auto* dex_callee = redex::create_method(scope, "LCallee;", R"(
+    (method (public static) "LCallee;.callee:(I)I"
+     (
+      (load-param v0)
+      (return v0)
+     )
+    )
+  )");
+  auto* dex_first = redex::create_method(scope, "LFirst;", R"(
+    (method (public static) "LFirst;.access:(I)I"
+     (
+      (load-param v0)
+      (invoke-static (v0) "LCallee;.callee:(I)I")
+      (move-result v1)
+      (return v1)
+     )
+    )
+  )");
+  auto* dex_second = redex::create_method(scope, "LSecond;", R"(
+    (method (public static) "LSecond;.access:(I)I"
+     (
+      (load-param v0)
+      (invoke-static (v0) "LCallee;.callee:(I)I")
+      (move-result v1)
+      (return v1)
+     )
+    )
+  )");
+  auto* dex_different = redex::create_method(scope, "LDifferent;", R"(
+    (method (public static) "LDifferent;.access:(I)I"
+     (
+      (load-param v0)
+      (invoke-static (v0) "LCallee;.callee:(I)I")
+      (move-result v0)
+      (return v0)
+     )
+    )
+  )");
+
+  DexStore store("test_store");
+  store.add_classes(scope);
+  auto context = test::make_context(store);
+  const auto* callee = context.methods->get(dex_callee);
+  const auto* first = context.methods->get(dex_first);
+  const auto* second = context.methods->get(dex_second);
+  const auto* different = context.methods->get(dex_different);
+
+  auto duplicate_methods = DuplicateMethods(
+      *context.methods, *context.call_graph, *context.heuristics);
+  EXPECT_TRUE(duplicate_methods.has_duplicates(first));
+  EXPECT_TRUE(duplicate_methods.has_duplicates(second));
+  EXPECT_FALSE(duplicate_methods.has_duplicates(different));
+  EXPECT_FALSE(duplicate_methods.has_duplicates(callee));
+  EXPECT_EQ(duplicate_methods.size(), 2);
+
+  // Models are shared within the group.
+  EXPECT_EQ(duplicate_methods.find(second), std::nullopt);
+  auto model = Model(first, context);
+  model.add_propagation(
+      Propagation(
+          /* input */ AccessPath(Root(Root::Kind::Argument, 0)),
+          /* inferred_features */ FeatureMayAlwaysSet::bottom(),
+          /* user_features */ FeatureSet::bottom()),
+      /* output */ AccessPath(Root(Root::Kind::Return)));
+  EXPECT_TRUE(DuplicateMethods::shareable(model));
+  duplicate_methods.record(first, Model(first, context), model, {});
+  auto entry = duplicate_methods.find(second);
+  ASSERT_NE(entry, std::nullopt);
+  EXPECT_EQ(entry->method, first);
+  EXPECT_EQ(entry->model, model);
+  EXPECT_EQ(duplicate_methods.find(different), std::nullopt);
+
+  // Models with sources depend on the positions of the method.
+  auto source_model = Model(
+      first,
+      context,
+      /* modes */ Model::Mode::Normal,
+      /* generations */
+      {{AccessPath(Root(Root::Kind::Return)),
+        Frame::leaf(context.kinds->get("TestSource"))}});
+  EXPECT_FALSE(DuplicateMethods::shareable(source_model));
+  duplicate_methods.record(second, Model(second, context), source_model, {});
+  EXPECT_EQ(duplicate_methods.find(first), std::nullopt);
+}
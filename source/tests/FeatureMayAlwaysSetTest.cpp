@@ -135,6 +135,38 @@ TEST_F(FeatureMayAlwaysSetTest, Join) {
           /* may */ FeatureSet{one, two, three}, /* always */ FeatureSet{one}));
 }
 
+TEST_F(FeatureMayAlwaysSetTest, Interning) {
+  auto context = test::make_empty_context();
+  const auto* one = context.features->get("FeatureOne");
+  const auto* two = context.features->get("FeatureTwo");
+
+  auto left =
+      FeatureMayAlwaysSet(/* may */ FeatureSet{one}, /* always */ FeatureSet{});
+  auto right = FeatureMayAlwaysSet::make_always({two});
+  auto expected = FeatureMayAlwaysSet(
+      /* may */ FeatureSet{one, two}, /* always */ FeatureSet{});
+
+  // Memoized joins give the same result, in both orders.
+  for (int i = 0; i < 3; i++) {
+    EXPECT_EQ(left.join(right), expected);
+    EXPECT_EQ(right.join(left), expected);
+  }
+
+  auto features = FeatureMayAlwaysSet::make_may({one});
+  features.add_may(two);
+  features.add_always(one);
+  EXPECT_EQ(
+      features,
+      FeatureMayAlwaysSet(
+          /* may */ FeatureSet{two}, /* always */ FeatureSet{one}));
+  EXPECT_EQ(left, FeatureMayAlwaysSet::make_may({one}));
+
+  features.set_to_bottom();
+  EXPECT_TRUE(features.is_bottom());
+  features.set_to_top();
+  EXPECT_TRUE(features.is_top());
+}
+
 TEST_F(FeatureMayAlwaysSetTest, Meet) {
   auto context = test::make_empty_context();
   const auto* one = context.features->get("FeatureOne");
@@ -92,3 +92,55 @@ TEST_F(FieldCacheTest, FieldCache) {
                       DexString::make_string("mSomething"))
                   .empty());
 }
+
+TEST_F(FieldCacheTest, PathFieldTypes) {
+  Scope scope;
+
+  redex::create_fields(
+      scope,
+      /* class_name */ "LBase;",
+      /* fields */
+      {{"mBase", type::java_lang_String()}});
+  redex::create_fields(
+      scope,
+      /* class_name */ "LDerived;",
+      /* fields */
+      {{"mDerived", type::java_lang_String()},
+       {"mBase", redex::get_type("LBase;")}},
+      /* super */ redex::get_type("LBase;"));
+
+  auto context = test_fields(scope);
+  const auto& field_cache = *context.field_cache;
+
+  const auto& base = field_cache.singleton_types(redex::get_type("LBase;"));
+  EXPECT_THAT(base, testing::UnorderedElementsAre(redex::get_type("LBase;")));
+  EXPECT_EQ(&field_cache.singleton_types(redex::get_type("LBase;")), &base);
+
+  // `Base.mBase` is either a `String` or a `Base`.
+  const auto& base_field =
+      field_cache.field_types(base, DexString::make_string("mBase"));
+  EXPECT_THAT(
+      base_field,
+      testing::UnorderedElementsAre(
+          type::java_lang_String(), redex::get_type("LBase;")));
+  EXPECT_EQ(
+      &field_cache.field_types(base, DexString::make_string("mBase")),
+      &base_field);
+
+  // `Base.mBase.mBase`, through the `Base` type of the first field.
+  EXPECT_THAT(
+      field_cache.field_types(base_field, DexString::make_string("mBase")),
+      testing::UnorderedElementsAre(
+          type::java_lang_String(), redex::get_type("LBase;")));
+  EXPECT_TRUE(
+      field_cache
+          .field_types(base_field, DexString::make_string("mFieldDoesNotExist"))
+          .empty());
+
+  // Fields of `Object` are unknown.
+  EXPECT_TRUE(field_cache
+                  .field_types(
+                      field_cache.singleton_types(type::java_lang_Object()),
+                      DexString::make_string("mBase"))
+                  .empty());
+}
@@ -5,6 +5,8 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <memory>
+
 #include <gtest/gtest.h>
 
 #include <DexStore.h>
@@ -18,6 +20,9 @@ namespace marianatrench {
 
 class FieldSetTest : public test::Test {
  public:
+  // Sets read the identifiers of their fields, hence these must outlive the
+  // tests.
+  std::unique_ptr<Context> context;
   const Field* field_a;
   const Field* field_b;
   const Field* field_c;
@@ -32,10 +37,10 @@ class FieldSetTest : public test::Test {
         scope, "LClassC", {"field_c", type::java_lang_String()});
     DexStore store("stores");
     store.add_classes(scope);
-    auto context = test::make_context(store);
-    field_a = context.fields->get(dex_field_a);
-    field_b = context.fields->get(dex_field_b);
-    field_c = context.fields->get(dex_field_c);
+    context = std::make_unique<Context>(test::make_context(store));
+    field_a = context->fields->get(dex_field_a);
+    field_b = context->fields->get(dex_field_b);
+    field_c = context->fields->get(dex_field_c);
   }
 };
 
@@ -67,6 +67,20 @@ using AbstractDomainT = GroupHashedSetAbstractDomain<
     Element::GroupHash,
     Element::GroupEqual>;
 
+std::size_t hash_calls = 0;
+
+struct CountingGroupHash {
+  std::size_t operator()(const Element& element) const {
+    hash_calls++;
+    return element.group;
+  }
+};
+
+using CountingAbstractDomainT = GroupHashedSetAbstractDomain<
+    Element,
+    CountingGroupHash,
+    Element::GroupEqual>;
+
 } // namespace
 
 TEST_F(GroupHashedSetAbstractDomainTest, DefaultConstructor) {
@@ -691,4 +705,55 @@ TEST_F(GroupHashedSetAbstractDomainTest, Filter) {
   EXPECT_EQ(domain, AbstractDomainT{});
 }
 
+TEST_F(GroupHashedSetAbstractDomainTest, ManyGroups) {
+  // Exceed the inline capacity so that elements move to the hash table.
+  auto domain = AbstractDomainT{};
+  for (int group = 0; group < 10; group++) {
+    domain.add(Element{group, IntSet{static_cast<unsigned>(group)}});
+  }
+  EXPECT_EQ(domain.size(), 10);
+  for (int group = 0; group < 10; group++) {
+    EXPECT_TRUE(
+        domain.contains(Element{group, IntSet{static_cast<unsigned>(group)}}));
+  }
+
+  auto copy = domain;
+  copy.add(Element{/* group */ 0, /* values */ IntSet{100}});
+  EXPECT_TRUE(domain.leq(copy));
+  EXPECT_FALSE(copy.leq(domain));
+  EXPECT_FALSE(domain.contains(Element{/* group */ 0, IntSet{100}}));
+
+  auto small = AbstractDomainT{
+      Element{/* group */ 1, /* values */ IntSet{1}},
+      Element{/* group */ 2, /* values */ IntSet{2}}};
+  EXPECT_TRUE(small.leq(domain));
+  small.join_with(domain);
+  EXPECT_EQ(small, domain);
+
+  domain.filter([](const Element& element) { return element.group < 3; });
+  EXPECT_EQ(
+      domain,
+      (AbstractDomainT{
+          Element{/* group */ 0, /* values */ IntSet{0}},
+          Element{/* group */ 1, /* values */ IntSet{1}},
+          Element{/* group */ 2, /* values */ IntSet{2}}}));
+}
+
+TEST_F(GroupHashedSetAbstractDomainTest, CachedGroupHash) {
+  auto domain = CountingAbstractDomainT{};
+  auto other = CountingAbstractDomainT{};
+  for (int group = 0; group < 10; group++) {
+    domain.add(Element{group, IntSet{static_cast<unsigned>(group)}});
+    other.add(Element{group, IntSet{static_cast<unsigned>(group + 1)}});
+  }
+  EXPECT_EQ(hash_calls, 20);
+
+  // Joins, comparisons and copies use the hashes of the stored elements.
+  auto copy = domain;
+  copy.join_with(other);
+  EXPECT_TRUE(domain.leq(copy));
+  EXPECT_FALSE(copy.equals(domain));
+  EXPECT_EQ(hash_calls, 20);
+}
+
 } // namespace marianatrench
@@ -5,6 +5,7 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <boost/filesystem.hpp>
 #include <gmock/gmock.h>
 
 #include <IROpcode.h>
@@ -275,4 +276,25 @@ TEST_F(HighlightsTest, TestLocalPositionHighlights) {
           FileLines({"object.field = a + b"})));
 }
 
+TEST_F(HighlightsTest, FileLinesFromFile) {
+  using FileLines = Highlights::FileLines;
+
+  auto path = boost::filesystem::temp_directory_path() /
+      boost::filesystem::unique_path("mariana-trench-%%%%-%%%%.java");
+  boost::filesystem::save_string_file(path, "class A {\n\n  void f();\n}\n");
+  auto missing_path = path.string() + ".missing";
+
+  FileLines lines(path);
+  EXPECT_EQ(lines.size(), 4);
+  EXPECT_FALSE(lines.has_line_number(0));
+  EXPECT_EQ(lines.line(1), "class A {");
+  EXPECT_EQ(lines.line(2), "");
+  EXPECT_EQ(lines.line(3), "  void f();");
+  EXPECT_EQ(lines.line(4), "}");
+  EXPECT_FALSE(lines.has_line_number(5));
+  EXPECT_ANY_THROW(FileLines{boost::filesystem::path(missing_path)});
+
+  boost::filesystem::remove(path);
+}
+
 } // namespace marianatrench
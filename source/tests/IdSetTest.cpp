@@ -0,0 +1,197 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <set>
+#include <vector>
+
+#include <gmock/gmock.h>
+
+#include <mariana-trench/IdSet.h>
+#include <mariana-trench/tests/Test.h>
+
+namespace marianatrench {
+
+class IdSetTest : public test::Test {};
+
+namespace {
+
+struct Element {
+  std::size_t id;
+};
+
+struct ElementId {
+  std::size_t operator()(const Element* element) const {
+    return element->id;
+  }
+};
+
+using Set = IdSet<Element, ElementId>;
+
+std::vector<Element> make_elements(std::size_t size) {
+  std::vector<Element> elements(size);
+  for (std::size_t id = 0; id < size; id++) {
+    elements[id].id = id;
+  }
+  return elements;
+}
+
+Set make_set(
+    const std::vector<Element>& elements,
+    std::size_t begin,
+    std::size_t end,
+    std::size_t step = 1) {
+  std::vector<const Element*> pointers;
+  for (auto id = begin; id < end; id += step) {
+    pointers.push_back(&elements[id]);
+  }
+  return Set(pointers.begin(), pointers.end());
+}
+
+std::vector<std::size_t> ids(const Set& set) {
+  std::vector<std::size_t> result;
+  for (const auto* element : set) {
+    result.push_back(element->id);
+  }
+  return result;
+}
+
+} // namespace
+
+TEST_F(IdSetTest, Inline) {
+  auto elements = make_elements(10);
+
+  auto set = Set{&elements[3], &elements[1], &elements[3]};
+  EXPECT_EQ(set.size(), 2);
+  EXPECT_THAT(ids(set), testing::ElementsAre(1, 3));
+
+  set.insert(&elements[2]);
+  set.insert(&elements[0]);
+  EXPECT_THAT(ids(set), testing::ElementsAre(0, 1, 2, 3));
+  EXPECT_TRUE(set.contains(&elements[2]));
+  EXPECT_FALSE(set.contains(&elements[4]));
+
+  // Going past the inline size.
+  set.insert(&elements[9]);
+  EXPECT_THAT(ids(set), testing::ElementsAre(0, 1, 2, 3, 9));
+  set.remove(&elements[1]);
+  EXPECT_THAT(ids(set), testing::ElementsAre(0, 2, 3, 9));
+
+  EXPECT_TRUE((Set{&elements[2], &elements[9]}).is_subset_of(set));
+  EXPECT_FALSE((Set{&elements[1], &elements[9]}).is_subset_of(set));
+  EXPECT_TRUE(set.equals(
+      Set{&elements[9], &elements[3], &elements[2], &elements[0]}));
+
+  set.clear();
+  EXPECT_TRUE(set.empty());
+}
+
+TEST_F(IdSetTest, Large) {
+  // Enough elements for chunks stored as arrays and as bitmaps.
+  auto elements = make_elements(3 * 65536);
+  auto all = make_set(elements, 0, elements.size());
+  auto even = make_set(elements, 0, elements.size(), /* step */ 2);
+  auto sparse = make_set(elements, 0, elements.size(), /* step */ 1000);
+  auto tail = make_set(elements, 65536, 70000);
+  EXPECT_EQ(all.size(), elements.size());
+  EXPECT_EQ(sparse.size(), 197);
+
+  EXPECT_TRUE(even.is_subset_of(all));
+  EXPECT_FALSE(all.is_subset_of(even));
+  EXPECT_TRUE(sparse.is_subset_of(even));
+  EXPECT_FALSE(tail.is_subset_of(even));
+  EXPECT_TRUE(tail.is_subset_of(all));
+  EXPECT_FALSE(tail.is_subset_of(sparse));
+
+  auto copy = even;
+  copy.union_with(sparse);
+  EXPECT_TRUE(copy.equals(even));
+  copy.union_with(tail);
+  EXPECT_EQ(copy.size(), even.size() + (70000 - 65536) / 2);
+  EXPECT_TRUE(tail.is_subset_of(copy));
+  EXPECT_FALSE(copy.equals(even));
+  // Copies are not modified.
+  EXPECT_EQ(even.size(), elements.size() / 2);
+
+  copy.intersection_with(tail);
+  EXPECT_TRUE(copy.equals(tail));
+
+  copy = sparse;
+  copy.difference_with(even);
+  EXPECT_TRUE(copy.empty());
+  copy = tail;
+  copy.difference_with(even);
+  EXPECT_EQ(copy.size(), (70000 - 65536) / 2);
+  EXPECT_FALSE(copy.contains(&elements[65536]));
+  EXPECT_TRUE(copy.contains(&elements[65537]));
+
+  // Elements are iterated in the order of their identifiers.
+  auto tail_ids = ids(tail);
+  EXPECT_TRUE(std::is_sorted(tail_ids.begin(), tail_ids.end()));
+  EXPECT_EQ(tail_ids.front(), 65536);
+  EXPECT_EQ(tail_ids.back(), 69999);
+}
+
+TEST_F(IdSetTest, Random) {
+  auto elements = make_elements(200000);
+  std::size_t seed = 1;
+  auto next = [&](std::size_t range) {
+    seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+    return (seed >> 33) % range;
+  };
+
+  for (std::size_t round = 0; round < 50; round++) {
+    auto range = round % 2 == 0 ? 20 : elements.size();
+    std::set<std::size_t> left_ids;
+    std::set<std::size_t> right_ids;
+    std::vector<const Element*> left_elements;
+    std::vector<const Element*> right_elements;
+    for (std::size_t i = 0, size = next(10000); i < size; i++) {
+      auto id = next(range);
+      left_ids.insert(id);
+      left_elements.push_back(&elements[id]);
+    }
+    for (std::size_t i = 0, size = next(10); i < size; i++) {
+      auto id = next(range);
+      right_ids.insert(id);
+      right_elements.push_back(&elements[id]);
+    }
+    auto left = Set(left_elements.begin(), left_elements.end());
+    auto right = Set(right_elements.begin(), right_elements.end());
+
+    EXPECT_EQ(
+        right.is_subset_of(left),
+        std::includes(
+            left_ids.begin(),
+            left_ids.end(),
+            right_ids.begin(),
+            right_ids.end()));
+
+    auto join = left;
+    join.union_with(right);
+    auto expected_join = left_ids;
+    expected_join.insert(right_ids.begin(), right_ids.end());
+    EXPECT_EQ(
+        ids(join),
+        std::vector<std::size_t>(expected_join.begin(), expected_join.end()));
+
+    auto meet = right;
+    meet.intersection_with(left);
+    std::vector<std::size_t> expected_meet;
+    std::set_intersection(
+        left_ids.begin(),
+        left_ids.end(),
+        right_ids.begin(),
+        right_ids.end(),
+        std::back_inserter(expected_meet));
+    EXPECT_EQ(ids(meet), expected_meet);
+  }
+}
+
+} // namespace marianatrench
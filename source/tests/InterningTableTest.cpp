@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <fmt/format.h>
+#include <gmock/gmock.h>
+
+#include <mariana-trench/InterningTable.h>
+#include <mariana-trench/tests/Test.h>
+
+namespace marianatrench {
+
+namespace {
+
+constexpr std::size_t kThreads = 8;
+constexpr std::size_t kSize = 10000;
+
+class InterningTableTest : public test::Test {};
+
+} // namespace
+
+TEST_F(InterningTableTest, CreateGet) {
+  InterningTable<std::string> table;
+  EXPECT_EQ(table.get("a"), nullptr);
+
+  const auto* a = table.create("a");
+  EXPECT_EQ(*a, "a");
+  EXPECT_EQ(table.create(std::string("a")), a);
+  EXPECT_EQ(table.get(std::string_view("abc").substr(0, 1)), a);
+
+  // Growing tables keeps existing pointers.
+  for (std::size_t index = 0; index < kSize; index++) {
+    table.create(fmt::format("key{}", index));
+  }
+  EXPECT_EQ(table.get("a"), a);
+  EXPECT_EQ(*table.get("key42"), "key42");
+
+  std::size_t size = 0;
+  table.visit([&](const std::string* /* value */) { size++; });
+  EXPECT_EQ(size, kSize + 1);
+}
+
+TEST_F(InterningTableTest, ConcurrentCreate) {
+  InterningTable<std::string> table;
+  std::vector<std::vector<const std::string*>> values(kThreads);
+  std::vector<std::thread> threads;
+  for (std::size_t thread = 0; thread < kThreads; thread++) {
+    threads.emplace_back([&table, &values, thread]() {
+      for (std::size_t index = 0; index < kSize; index++) {
+        values[thread].push_back(table.create(fmt::format("key{}", index)));
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  for (std::size_t thread = 1; thread < kThreads; thread++) {
+    EXPECT_EQ(values[thread], values[0]);
+  }
+  EXPECT_EQ(*values[0][42], "key42");
+}
+
+} // namespace marianatrench
@@ -378,4 +378,106 @@ TEST_F(IssueSetTest, Insertion) {
       }));
 }
 
+TEST_F(IssueSetTest, Join) {
+  auto context = test::make_empty_context();
+
+  const auto* source_kind = context.kinds->get("TestSource");
+  const auto* other_source_kind = context.kinds->get("OtherSource");
+  const auto* sink_kind = context.kinds->get("TestSink");
+
+  SourceSinkRule rule_1("rule 1", 1, "description", {source_kind}, {sink_kind});
+  SourceSinkRule rule_2(
+      "rule 2", 2, "description", {other_source_kind}, {sink_kind});
+
+  const auto* position_1 = context.positions->get(std::nullopt, 1);
+  const auto* position_2 = context.positions->get(std::nullopt, 2);
+
+  auto issue_1 = Issue(
+      /* source */ Taint{Frame::leaf(source_kind)},
+      /* sink */ Taint{Frame::leaf(sink_kind)},
+      &rule_1,
+      position_1);
+  auto issue_2 = Issue(
+      /* source */ Taint{Frame::leaf(other_source_kind)},
+      /* sink */ Taint{Frame::leaf(sink_kind)},
+      &rule_2,
+      position_1);
+  auto issue_3 = Issue(
+      /* source */ Taint{Frame::leaf(source_kind)},
+      /* sink */ Taint{Frame::leaf(sink_kind)},
+      &rule_1,
+      position_2);
+  auto issue_1_other_source = Issue(
+      /* source */ Taint{Frame::leaf(other_source_kind)},
+      /* sink */ Taint{Frame::leaf(sink_kind)},
+      &rule_1,
+      position_1);
+
+  EXPECT_EQ(IssueSet{}.join(IssueSet{issue_1}), IssueSet{issue_1});
+  EXPECT_EQ(IssueSet{issue_1}.join(IssueSet{}), IssueSet{issue_1});
+  EXPECT_EQ(
+      (IssueSet{issue_1, issue_3}).join(IssueSet{issue_2}),
+      (IssueSet{issue_1, issue_2, issue_3}));
+  EXPECT_EQ(
+      (IssueSet{issue_3, issue_2}).join(IssueSet{issue_1}),
+      (IssueSet{issue_1, issue_2, issue_3}));
+
+  // Issues in the same group are joined.
+  auto joined = IssueSet{issue_1, issue_2}.join(
+      IssueSet{issue_1_other_source, issue_3});
+  EXPECT_EQ(joined.size(), 3);
+  EXPECT_EQ(
+      joined,
+      (IssueSet{issue_1, issue_1_other_source, issue_2, issue_3}));
+
+  EXPECT_TRUE(IssueSet{issue_1}.leq(joined));
+  EXPECT_TRUE((IssueSet{issue_1_other_source, issue_3}).leq(joined));
+  EXPECT_FALSE(joined.leq(IssueSet{issue_1, issue_2, issue_3}));
+  EXPECT_TRUE((IssueSet{issue_1, issue_2, issue_3}).leq(joined));
+}
+
+TEST_F(IssueSetTest, Compact) {
+  auto context = test::make_empty_context();
+
+  const auto* source_kind = context.kinds->get("TestSource");
+  const auto* other_source_kind = context.kinds->get("OtherSource");
+  const auto* sink_kind = context.kinds->get("TestSink");
+  const auto* feature = context.features->get("Feature");
+  SourceSinkRule rule("rule", 1, "description", {source_kind}, {sink_kind});
+  const auto* position = context.positions->get(std::nullopt, 1);
+
+  auto issue = Issue(
+      /* source */
+      Taint{
+          Frame::leaf(source_kind),
+          Frame::leaf(
+              other_source_kind,
+              /* inferred_features */ FeatureMayAlwaysSet{feature},
+              /* locally_inferred_features */ FeatureMayAlwaysSet::bottom(),
+              /* user_features */ FeatureSet::bottom(),
+              /* origins */ {})},
+      /* sink */ Taint{Frame::leaf(sink_kind)},
+      &rule,
+      position);
+  auto compact = issue;
+  compact.compact();
+  EXPECT_TRUE(compact.is_compact());
+  EXPECT_FALSE(compact.is_bottom());
+  EXPECT_TRUE(compact.sources().is_bottom());
+  EXPECT_EQ(compact.frames_size(), 3);
+  EXPECT_EQ(compact.frames_size(), issue.frames_size());
+  EXPECT_EQ(compact.features(), issue.features());
+  EXPECT_EQ(compact.to_json(), issue.to_json());
+
+  // Copies share the compact frames.
+  auto copy = compact;
+  EXPECT_EQ(copy, compact);
+  EXPECT_NE(compact, issue);
+
+  auto set = IssueSet{issue};
+  set.map([](Issue& issue) { issue.compact(); });
+  EXPECT_EQ(set.size(), 1);
+  EXPECT_EQ(set, IssueSet{compact});
+}
+
 } // namespace marianatrench
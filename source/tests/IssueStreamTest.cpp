@@ -0,0 +1,166 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <fstream>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+#include <gtest/gtest.h>
+
+#include <mariana-trench/IssueStream.h>
+#include <mariana-trench/JsonValidation.h>
+#include <mariana-trench/MethodBitset.h>
+#include <mariana-trench/Redex.h>
+#include <mariana-trench/Registry.h>
+#include <mariana-trench/SourceSinkRule.h>
+#include <mariana-trench/tests/Test.h>
+
+using namespace marianatrench;
+
+namespace {
+
+class IssueStreamTest : public test::Test {};
+
+std::vector<std::string> read_lines(const boost::filesystem::path& path) {
+  std::ifstream stream(path.native());
+  std::vector<std::string> lines;
+  std::string line;
+  while (std::getline(stream, line)) {
+    lines.push_back(line);
+  }
+  return lines;
+}
+
+} // anonymous namespace
+
+TEST_F(IssueStreamTest, OnlyChangedIssuesAreWritten) {
+  Scope scope;
+  auto* dex_method = redex::create_void_method(scope, "LClass;", "method");
+  auto* dex_other = redex::create_void_method(scope, "LOther;", "other");
+
+  DexStore store("store");
+  store.add_classes(scope);
+  auto context = test::make_context(store);
+  const auto* method = context.methods->get(dex_method);
+  const auto* other = context.methods->get(dex_other);
+
+  const auto* source_kind = context.kinds->get("TestSource");
+  const auto* sink_kind = context.kinds->get("TestSink");
+  const auto* other_sink_kind = context.kinds->get("OtherSink");
+  SourceSinkRule rule(
+      "rule", 1, "description", {source_kind}, {sink_kind, other_sink_kind});
+
+  auto path = boost::filesystem::temp_directory_path() /
+      boost::filesystem::unique_path("mariana-trench-issues-%%%%%%%%.json");
+  auto registry = Registry(context);
+  auto stream = IssueStream(path, *context.methods);
+  MethodBitset methods(*context.methods);
+  methods.insert(method);
+  methods.insert(other);
+
+  // Methods without issues are not written.
+  EXPECT_EQ(stream.write(registry, methods), 0);
+
+  auto model = Model(method, context);
+  model.set_issues(IssueSet{Issue(
+      /* source */ Taint{Frame::leaf(source_kind)},
+      /* sink */ Taint{Frame::leaf(sink_kind)},
+      &rule,
+      context.positions->get(std::nullopt, 1))});
+  registry.set(model);
+  EXPECT_EQ(stream.write(registry, methods), 1);
+
+  // Unchanged issues are not written again.
+  EXPECT_EQ(stream.write(registry), 0);
+
+  model.set_issues(IssueSet{
+      Issue(
+          /* source */ Taint{Frame::leaf(source_kind)},
+          /* sink */ Taint{Frame::leaf(sink_kind)},
+          &rule,
+          context.positions->get(std::nullopt, 1)),
+      Issue(
+          /* source */ Taint{Frame::leaf(source_kind)},
+          /* sink */ Taint{Frame::leaf(other_sink_kind)},
+          &rule,
+          context.positions->get(std::nullopt, 2))});
+  registry.set(model);
+  EXPECT_EQ(stream.write(registry), 1);
+  EXPECT_EQ(stream.size(), 2);
+
+  auto lines = read_lines(path);
+  ASSERT_EQ(lines.size(), 2);
+  auto first = JsonValidation::parse_json(lines[0]);
+  auto last = JsonValidation::parse_json(lines[1]);
+  EXPECT_EQ(first["method"], method->to_json());
+  EXPECT_EQ(first["issues"].size(), 1);
+  EXPECT_EQ(last["method"], method->to_json());
+  EXPECT_EQ(last["issues"].size(), 2);
+
+  boost::filesystem::remove(path);
+}
+
+TEST_F(IssueStreamTest, RuleCodes) {
+  Scope scope;
+  auto* dex_method = redex::create_void_method(scope, "LClass;", "method");
+  auto* dex_other = redex::create_void_method(scope, "LOther;", "other");
+
+  DexStore store("store");
+  store.add_classes(scope);
+  auto context = test::make_context(store);
+  const auto* method = context.methods->get(dex_method);
+  const auto* other = context.methods->get(dex_other);
+
+  const auto* source_kind = context.kinds->get("TestSource");
+  const auto* sink_kind = context.kinds->get("TestSink");
+  SourceSinkRule privacy_rule(
+      "privacy", 1, "description", {source_kind}, {sink_kind});
+  SourceSinkRule security_rule(
+      "security", 2, "description", {source_kind}, {sink_kind});
+
+  auto registry = Registry(context);
+  auto model = Model(method, context);
+  model.set_issues(IssueSet{
+      Issue(
+          /* source */ Taint{Frame::leaf(source_kind)},
+          /* sink */ Taint{Frame::leaf(sink_kind)},
+          &privacy_rule,
+          context.positions->get(std::nullopt, 1)),
+      Issue(
+          /* source */ Taint{Frame::leaf(source_kind)},
+          /* sink */ Taint{Frame::leaf(sink_kind)},
+          &security_rule,
+          context.positions->get(std::nullopt, 1))});
+  registry.set(model);
+  auto other_model = Model(other, context);
+  other_model.set_issues(IssueSet{Issue(
+      /* source */ Taint{Frame::leaf(source_kind)},
+      /* sink */ Taint{Frame::leaf(sink_kind)},
+      &security_rule,
+      context.positions->get(std::nullopt, 2))});
+  registry.set(other_model);
+
+  auto path = boost::filesystem::temp_directory_path() /
+      boost::filesystem::unique_path("mariana-trench-issues-%%%%%%%%.json");
+  {
+    // Methods without issues of the given rules are not written.
+    auto stream = IssueStream(
+        path, *context.methods, std::unordered_set<int>{1});
+    EXPECT_EQ(stream.write(registry), 1);
+  }
+
+  auto lines = read_lines(path);
+  ASSERT_EQ(lines.size(), 1);
+  auto value = JsonValidation::parse_json(lines[0]);
+  EXPECT_EQ(value["method"], method->to_json());
+  ASSERT_EQ(value["issues"].size(), 1);
+  EXPECT_EQ(value["issues"][0]["rule"].asInt(), 1);
+
+  boost::filesystem::remove(path);
+}
@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <boost/filesystem.hpp>
+#include <gmock/gmock.h>
+
+#include <mariana-trench/JsonArrayFile.h>
+#include <mariana-trench/tests/Test.h>
+
+namespace marianatrench {
+
+class JsonArrayFileTest : public test::Test {};
+
+TEST_F(JsonArrayFileTest, Split) {
+  using Elements = std::vector<std::string_view>;
+
+  EXPECT_EQ(JsonArrayFile::split("[]"), Elements{});
+  EXPECT_EQ(JsonArrayFile::split(" [ ] \n"), Elements{});
+  EXPECT_EQ(JsonArrayFile::split("null"), Elements{});
+  EXPECT_EQ(JsonArrayFile::split("[1]"), (Elements{"1"}));
+  EXPECT_EQ(
+      JsonArrayFile::split("[1, \"a\" ,\n{}]"), (Elements{"1", "\"a\"", "{}"}));
+  EXPECT_EQ(
+      JsonArrayFile::split(R"([{"a": [1, 2]}, ["]", "\"", "{"]])"),
+      (Elements{R"({"a": [1, 2]})", R"(["]", "\"", "{"])"}));
+  EXPECT_EQ(
+      JsonArrayFile::split(R"(["a\\", "b\\\"]", "\\\\"])"),
+      (Elements{R"("a\\")", R"("b\\\"]")", R"("\\\\")"}));
+
+  EXPECT_THROW(JsonArrayFile::split(""), std::invalid_argument);
+  EXPECT_THROW(JsonArrayFile::split("{}"), std::invalid_argument);
+  EXPECT_THROW(JsonArrayFile::split("[1"), std::invalid_argument);
+  EXPECT_THROW(JsonArrayFile::split("[1,]"), std::invalid_argument);
+  EXPECT_THROW(JsonArrayFile::split("[1}]"), std::invalid_argument);
+  EXPECT_THROW(JsonArrayFile::split("[1] 2"), std::invalid_argument);
+  EXPECT_THROW(JsonArrayFile::split("[\"a]"), std::invalid_argument);
+  EXPECT_THROW(JsonArrayFile::split(R"(["a\"])"), std::invalid_argument);
+}
+
+TEST_F(JsonArrayFileTest, Parse) {
+  auto path = boost::filesystem::temp_directory_path() /
+      boost::filesystem::unique_path("mariana-trench-%%%%-%%%%.json");
+  boost::filesystem::save_string_file(
+      path, R"([{"method": "LClass;.f:()V"}, [1, 2], "string"])");
+
+  JsonArrayFile file(path);
+  EXPECT_EQ(file.size(), 3);
+  EXPECT_EQ(file.parse(0)["method"].asString(), "LClass;.f:()V");
+  EXPECT_EQ(file.parse(1).size(), 2);
+  EXPECT_EQ(file.parse(2).asString(), "string");
+
+  std::vector<Json::Value> values;
+  JsonArrayFile::for_each(
+      path, [&](const Json::Value& value) { values.push_back(value); });
+  EXPECT_EQ(values.size(), 3);
+  EXPECT_EQ(values[2].asString(), "string");
+
+  boost::filesystem::save_string_file(path, "[1, {\"a\": }]");
+  EXPECT_THROW(JsonArrayFile(path).parse(1), std::invalid_argument);
+
+  boost::filesystem::remove(path);
+}
+
+} // namespace marianatrench
@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <gmock/gmock.h>
+
+#include <mariana-trench/KindCosts.h>
+#include <mariana-trench/SourceSinkRule.h>
+#include <mariana-trench/tests/Test.h>
+
+namespace marianatrench {
+
+class KindCostsTest : public test::Test {};
+
+TEST_F(KindCostsTest, Costs) {
+  auto context = test::make_empty_context();
+  const auto* source_kind = context.kinds->get("TestSource");
+  const auto* other_source_kind = context.kinds->get("OtherSource");
+  const auto* sink_kind = context.kinds->get("TestSink");
+  const auto* position = context.positions->get(std::nullopt, 1);
+  SourceSinkRule rule("rule", 1, "description", {source_kind}, {sink_kind});
+
+  auto model = Model(
+      /* method */ nullptr,
+      context,
+      /* modes */ Model::Mode::Normal,
+      /* generations */
+      {{AccessPath(Root(Root::Kind::Return)), Frame::leaf(source_kind)},
+       {AccessPath(Root(Root::Kind::Argument, 1)), Frame::leaf(source_kind)},
+       {AccessPath(Root(Root::Kind::Return)),
+        Frame::leaf(other_source_kind)}},
+      /* parameter_sources */ {},
+      /* sinks */
+      {{AccessPath(Root(Root::Kind::Argument, 0)), Frame::leaf(sink_kind)}});
+  model.add_issue(Issue(
+      /* sources */ Taint{Frame::leaf(source_kind)},
+      /* sinks */ Taint{Frame::leaf(sink_kind)},
+      &rule,
+      position));
+  std::vector<std::shared_ptr<const Model>> models = {
+      std::make_shared<const Model>(model)};
+
+  KindCosts costs;
+  costs.log(sink_kind, KindCosts::Cost::CheckFlows, 1.0);
+  std::vector<std::thread> threads;
+  for (int thread = 0; thread < 4; thread++) {
+    threads.emplace_back([&]() {
+      costs.log(source_kind, KindCosts::Cost::CheckFlows, 0.5);
+      costs.log(source_kind, KindCosts::Cost::Propagate, 0.25);
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  auto value = costs.to_json(models);
+  ASSERT_EQ(value.size(), 3);
+
+  // Kinds are sorted by number of frames.
+  EXPECT_EQ(value[0]["kind"].asString(), "TestSource");
+  EXPECT_EQ(value[0]["frames"].asUInt64(), 2);
+  EXPECT_EQ(value[0]["issues"].asUInt64(), 1);
+  EXPECT_DOUBLE_EQ(value[0]["check_flows_seconds"].asDouble(), 2.0);
+  EXPECT_DOUBLE_EQ(value[0]["propagate_seconds"].asDouble(), 1.0);
+  EXPECT_EQ(value[0]["propagations"].asUInt64(), 4);
+
+  EXPECT_EQ(value[1]["kind"].asString(), "OtherSource");
+  EXPECT_EQ(value[1]["frames"].asUInt64(), 1);
+  EXPECT_EQ(value[1]["issues"].asUInt64(), 0);
+  EXPECT_DOUBLE_EQ(value[1]["check_flows_seconds"].asDouble(), 0.0);
+  EXPECT_LT(
+      value[1]["frame_bytes"].asUInt64(), value[0]["frame_bytes"].asUInt64());
+
+  EXPECT_EQ(value[2]["kind"].asString(), "TestSink");
+  EXPECT_EQ(value[2]["frames"].asUInt64(), 1);
+  EXPECT_EQ(value[2]["issues"].asUInt64(), 1);
+  EXPECT_DOUBLE_EQ(value[2]["check_flows_seconds"].asDouble(), 1.0);
+  EXPECT_EQ(value[2]["propagations"].asUInt64(), 0);
+}
+
+} // namespace marianatrench
@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <fstream>
+
+#include <boost/filesystem.hpp>
+#include <gtest/gtest.h>
+
+#include <mariana-trench/BinaryJson.h>
+#include <mariana-trench/LibrarySummary.h>
+#include <mariana-trench/Redex.h>
+#include <mariana-trench/Registry.h>
+#include <mariana-trench/tests/Test.h>
+
+using namespace marianatrench;
+
+namespace {
+
+class LibrarySummaryTest : public test::Test {};
+
+} // anonymous namespace
+
+TEST_F(LibrarySummaryTest, WriteAndLoad) {
+  Scope scope;
+  auto* dex_method = redex::create_void_method(scope, "LLibrary;", "method");
+
+  DexStore store("store");
+  store.add_classes(scope);
+  auto context = test::make_context(store);
+  const auto* method = context.methods->get(dex_method);
+  const auto* sink_kind = context.kinds->get("TestSink");
+
+  auto path = boost::filesystem::temp_directory_path() /
+      boost::filesystem::unique_path("mariana-trench-summary-%%%%%%%%.bin");
+  auto registry = Registry(context);
+  auto model = Model(method, context);
+  model.add_sink(
+      AccessPath(Root(Root::Kind::Argument, 0)), Frame::leaf(sink_kind));
+  registry.set(model);
+  LibrarySummary::write(context, registry, path);
+
+  auto loaded_registry = Registry(context);
+  auto methods = LibrarySummary::load(context, loaded_registry, path);
+  EXPECT_EQ(methods, (std::unordered_set<const Method*>{method}));
+  const auto& loaded_model = loaded_registry.get(method);
+  EXPECT_EQ(loaded_model.sinks(), model.sinks());
+  EXPECT_TRUE(loaded_model.skip_analysis());
+
+  boost::filesystem::remove(path);
+}
+
+TEST_F(LibrarySummaryTest, InvalidVersion) {
+  auto context = test::make_empty_context();
+  auto path = boost::filesystem::temp_directory_path() /
+      boost::filesystem::unique_path("mariana-trench-summary-%%%%%%%%.bin");
+  {
+    BinaryJsonWriter writer;
+    auto header = Json::Value(Json::objectValue);
+    header["version"] = Json::UInt64(LibrarySummary::kVersion + 1);
+    writer.add(header);
+    std::ofstream stream(path.native(), std::ios_base::binary);
+    writer.write(stream);
+  }
+
+  auto registry = Registry(context);
+  EXPECT_THROW(
+      LibrarySummary::load(context, registry, path), std::runtime_error);
+
+  boost::filesystem::remove(path);
+}
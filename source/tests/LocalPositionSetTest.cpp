@@ -114,7 +114,7 @@ TEST_F(LocalPositionSetTest, Join) {
     set.join_with(LocalPositionSet{context.positions->get(std::nullopt, i)});
   }
   EXPECT_TRUE(set.is_value());
-  EXPECT_EQ(set.elements().size(), Heuristics::kMaxNumberLocalPositions);
+  EXPECT_EQ(set.size(), Heuristics::kMaxNumberLocalPositions);
 
   set.join_with(LocalPositionSet{context.positions->get(
       std::nullopt, Heuristics::kMaxNumberLocalPositions)});
@@ -145,11 +145,40 @@ TEST_F(LocalPositionSetTest, Add) {
     set.add(context.positions->get(std::nullopt, i));
   }
   EXPECT_TRUE(set.is_value());
-  EXPECT_EQ(set.elements().size(), Heuristics::kMaxNumberLocalPositions);
+  EXPECT_EQ(set.size(), Heuristics::kMaxNumberLocalPositions);
 
   set.add(context.positions->get(
       std::nullopt, Heuristics::kMaxNumberLocalPositions));
   EXPECT_TRUE(set.is_top());
 }
 
+TEST_F(LocalPositionSetTest, Meet) {
+  auto context = test::make_empty_context();
+  const auto* one = context.positions->get(std::nullopt, 1);
+  const auto* two = context.positions->get(std::nullopt, 2);
+  const auto* three = context.positions->get(std::nullopt, 3);
+  const auto* four = context.positions->get(std::nullopt, 4);
+
+  EXPECT_EQ(
+      LocalPositionSet::bottom().meet(LocalPositionSet{one}),
+      LocalPositionSet::bottom());
+  EXPECT_EQ(
+      LocalPositionSet::top().meet(LocalPositionSet{one}),
+      LocalPositionSet{one});
+  EXPECT_EQ(
+      (LocalPositionSet{one, two}).meet(LocalPositionSet{two, three}),
+      LocalPositionSet{two});
+
+  // Sets larger than the inline capacity shrink back to inline sets.
+  auto set = LocalPositionSet{one, two, three, four};
+  EXPECT_EQ(set.size(), 4);
+  auto copy = set;
+  set.meet_with(LocalPositionSet{four, one});
+  EXPECT_EQ(set, (LocalPositionSet{one, four}));
+  EXPECT_EQ(copy, (LocalPositionSet{one, two, three, four}));
+
+  auto moved = std::move(copy);
+  EXPECT_EQ(moved, (LocalPositionSet{four, three, two, one}));
+}
+
 } // namespace marianatrench
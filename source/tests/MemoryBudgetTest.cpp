@@ -0,0 +1,45 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <gmock/gmock.h>
+
+#include <mariana-trench/MemoryBudget.h>
+#include <mariana-trench/tests/Test.h>
+
+namespace marianatrench {
+
+class MemoryBudgetTest : public test::Test {};
+
+TEST_F(MemoryBudgetTest, Update) {
+  MemoryBudget budget(/* limit_in_gb */ 10.0);
+  EXPECT_EQ(budget.level(), 0);
+  EXPECT_EQ(budget.model_tree_max_leaves(/* default */ 20), 20);
+
+  // Below the pressure threshold.
+  budget.update(5.0);
+  EXPECT_EQ(budget.level(), 0);
+
+  budget.update(8.5);
+  EXPECT_EQ(budget.level(), 1);
+  EXPECT_EQ(budget.model_tree_max_leaves(/* default */ 20), 10);
+
+  // Memory usage did not grow since the last step.
+  budget.update(8.5);
+  EXPECT_EQ(budget.level(), 1);
+
+  for (double size = 9.0; size < 10.0; size += 0.1) {
+    budget.update(size);
+  }
+  EXPECT_EQ(budget.level(), MemoryBudget::kMaxLevel);
+  EXPECT_EQ(budget.model_tree_max_leaves(/* default */ 20), 1);
+
+  auto value = budget.to_json();
+  EXPECT_EQ(value["level"].asUInt64(), MemoryBudget::kMaxLevel);
+  EXPECT_EQ(value["degradations"].size(), MemoryBudget::kMaxLevel);
+}
+
+} // namespace marianatrench
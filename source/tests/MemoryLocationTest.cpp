@@ -8,6 +8,7 @@
 #include <gtest/gtest.h>
 
 #include <mariana-trench/MemoryLocation.h>
+#include <mariana-trench/Redex.h>
 #include <mariana-trench/tests/Test.h>
 
 namespace marianatrench {
@@ -51,6 +52,40 @@ TEST_F(TraceTest, MemoryLocationMakeField) {
   EXPECT_EQ(parameter_left_right_left->parent(), parameter.get());
 }
 
+TEST_F(TraceTest, MemoryFactoryReset) {
+  Scope scope;
+  auto context = test::make_empty_context();
+  const auto* virtual_method = context.methods->create(
+      redex::create_void_method(scope, "LClass;", "one", "I"));
+  const auto* static_method = context.methods->create(redex::create_void_method(
+      scope,
+      "LClass;",
+      "two",
+      "II",
+      "V",
+      /* super */ nullptr,
+      /* is_static */ true));
+
+  auto memory_factory = MemoryFactory(virtual_method);
+  EXPECT_NE(
+      dynamic_cast<ThisParameterMemoryLocation*>(
+          memory_factory.make_parameter(0)),
+      nullptr);
+  EXPECT_THROW(memory_factory.make_parameter(2), std::out_of_range);
+  auto* field = memory_factory.make_parameter(1)->make_field(
+      DexString::make_string("field"));
+  EXPECT_EQ(field->parent(), memory_factory.make_parameter(1));
+
+  // Parameters of the new method replace the previous ones.
+  memory_factory.reset(static_method);
+  EXPECT_EQ(
+      dynamic_cast<ThisParameterMemoryLocation*>(
+          memory_factory.make_parameter(0)),
+      nullptr);
+  EXPECT_EQ(memory_factory.make_parameter(1)->position(), 1);
+  EXPECT_THROW(memory_factory.make_parameter(2), std::out_of_range);
+}
+
 TEST_F(TraceTest, MemoryLocationPath) {
   const auto* x = DexString::make_string("x");
   const auto* y = DexString::make_string("y");
@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <vector>
+
+#include <gmock/gmock.h>
+
+#include <mariana-trench/MethodBitset.h>
+#include <mariana-trench/Redex.h>
+#include <mariana-trench/tests/Test.h>
+
+namespace marianatrench {
+
+class MethodBitsetTest : public test::Test {};
+
+TEST_F(MethodBitsetTest, Identifiers) {
+  Scope scope;
+  auto context = test::make_empty_context();
+  auto* dex_method_a = redex::create_void_method(scope, "LA;", "method_a");
+  auto* dex_method_b = redex::create_void_method(scope, "LB;", "method_b");
+
+  const auto* method_a = context.methods->create(dex_method_a);
+  const auto* method_b = context.methods->create(dex_method_b);
+  const auto* method_a_with_overrides = context.methods->create(
+      dex_method_a, {{0, redex::get_type("Ljava/lang/Object;")}});
+
+  EXPECT_EQ(context.methods->create(dex_method_a), method_a);
+  EXPECT_EQ(context.methods->size(), 3);
+  EXPECT_EQ(method_a->id(), 0);
+  EXPECT_EQ(method_b->id(), 1);
+  EXPECT_EQ(method_a_with_overrides->id(), 2);
+  EXPECT_EQ(context.methods->get(std::size_t(1)), method_b);
+  EXPECT_THAT(
+      std::vector<const Method*>(
+          context.methods->begin(), context.methods->end()),
+      testing::ElementsAre(method_a, method_b, method_a_with_overrides));
+}
+
+TEST_F(MethodBitsetTest, InsertContains) {
+  Scope scope;
+  auto context = test::make_empty_context();
+  const auto* method_a = context.methods->create(
+      redex::create_void_method(scope, "LA;", "method_a"));
+  const auto* method_b = context.methods->create(
+      redex::create_void_method(scope, "LB;", "method_b"));
+  const auto* method_c = context.methods->create(
+      redex::create_void_method(scope, "LC;", "method_c"));
+
+  MethodBitset methods(*context.methods);
+  EXPECT_TRUE(methods.empty());
+  EXPECT_FALSE(methods.contains(method_a));
+
+  EXPECT_TRUE(methods.insert(method_c));
+  EXPECT_TRUE(methods.insert(method_a));
+  EXPECT_FALSE(methods.insert(method_a));
+  EXPECT_EQ(methods.size(), 2);
+  EXPECT_TRUE(methods.contains(method_a));
+  EXPECT_FALSE(methods.contains(method_b));
+  EXPECT_TRUE(methods.contains(method_c));
+
+  std::vector<const Method*> visited;
+  methods.visit([&](const Method* method) { visited.push_back(method); });
+  EXPECT_THAT(visited, testing::ElementsAre(method_a, method_c));
+}
+
+TEST_F(MethodBitsetTest, SwapClear) {
+  Scope scope;
+  auto context = test::make_empty_context();
+  const auto* method_a = context.methods->create(
+      redex::create_void_method(scope, "LA;", "method_a"));
+  const auto* method_b = context.methods->create(
+      redex::create_void_method(scope, "LB;", "method_b"));
+
+  MethodBitset methods(*context.methods);
+  MethodBitset new_methods(*context.methods);
+  methods.insert(method_a);
+  new_methods.insert(method_b);
+
+  methods.swap(new_methods);
+  EXPECT_EQ(methods.size(), 1);
+  EXPECT_TRUE(methods.contains(method_b));
+  EXPECT_FALSE(methods.contains(method_a));
+  EXPECT_TRUE(new_methods.contains(method_a));
+
+  new_methods.clear();
+  EXPECT_TRUE(new_methods.empty());
+  EXPECT_FALSE(new_methods.contains(method_a));
+  EXPECT_TRUE(new_methods.insert(method_a));
+}
+
+} // namespace marianatrench
@@ -19,13 +19,15 @@ namespace marianatrench {
 
 class MethodSetTest : public test::Test {
  public:
+  // Sets read the identifiers of their methods, hence these must outlive the
+  // tests.
+  Context context;
   const Method* method_a;
   const Method* method_b;
   const Method* method_c;
 
-  MethodSetTest() {
+  MethodSetTest() : context(test::make_empty_context()) {
     Scope scope;
-    auto context = test::make_empty_context();
     method_a = context.methods->create(
         redex::create_void_method(scope, "class_a", "method_a"));
     method_b = context.methods->create(
@@ -169,4 +171,30 @@ TEST_F(MethodSetTest, Difference) {
   EXPECT_EQ(methods_top, MethodSet());
 }
 
+TEST_F(MethodSetTest, MaximumSize) {
+  MethodSet::set_maximum_size(2);
+  auto number_truncations = MethodSet::number_truncations();
+
+  auto methods = MethodSet({method_a});
+  methods.join_with(MethodSet{method_b});
+  EXPECT_EQ(methods, MethodSet({method_a, method_b}));
+  EXPECT_EQ(methods.truncated_size(), 0);
+
+  methods.join_with(MethodSet{method_c});
+  EXPECT_TRUE(methods.is_top());
+  EXPECT_EQ(methods.truncated_size(), 3);
+  EXPECT_EQ(MethodSet::number_truncations(), number_truncations + 1);
+
+  auto other = MethodSet({method_a});
+  other.join_with(methods);
+  EXPECT_TRUE(other.is_top());
+  EXPECT_EQ(other.truncated_size(), 3);
+  EXPECT_EQ(MethodSet::truncated(3), methods);
+
+  MethodSet::set_maximum_size(std::nullopt);
+  methods = MethodSet({method_a, method_b});
+  methods.join_with(MethodSet{method_c});
+  EXPECT_EQ(methods, MethodSet({method_a, method_b, method_c}));
+}
+
 } // namespace marianatrench
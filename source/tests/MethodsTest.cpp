@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <vector>
+
+#include <gmock/gmock.h>
+
+#include <Walkers.h>
+
+#include <mariana-trench/Methods.h>
+#include <mariana-trench/Redex.h>
+#include <mariana-trench/tests/Test.h>
+
+using namespace marianatrench;
+
+namespace {
+
+class MethodsTest : public test::Test {};
+
+} // anonymous namespace
+
+TEST_F(MethodsTest, IdentifiersFollowDexOrder) {
+  Scope scope;
+  for (const auto* class_name : {"LFirst;", "LSecond;", "LThird;"}) {
+    for (const auto* method_name : {"a", "b", "c"}) {
+      redex::create_void_method(scope, class_name, method_name);
+    }
+  }
+  DexStore store("store");
+  store.add_classes(scope);
+  DexStoresVector stores({store});
+
+  std::vector<const DexMethod*> dex_methods;
+  walk::methods(
+      scope, [&](DexMethod* method) { dex_methods.push_back(method); });
+
+  auto methods = Methods(stores);
+  ASSERT_EQ(methods.size(), dex_methods.size());
+  std::size_t id = 0;
+  for (const auto* method : methods) {
+    EXPECT_EQ(method->id(), id);
+    EXPECT_EQ(method->dex_method(), dex_methods[id]);
+    EXPECT_EQ(methods.get(dex_methods[id]), method);
+    id++;
+  }
+}
+
+TEST_F(MethodsTest, LoggedMethods) {
+  Scope scope;
+  redex::create_void_method(scope, "LLogged;", "first");
+  redex::create_void_method(scope, "LOther;", "second");
+  DexStore store("store");
+  store.add_classes(scope);
+  DexStoresVector stores({store});
+
+  auto methods = Methods(stores, /* log_methods */ {"LLogged;", "none"});
+  EXPECT_TRUE(methods.get("LLogged;.first:()V")->logged());
+  EXPECT_FALSE(methods.get("LOther;.second:()V")->logged());
+
+  // Methods created after the construction are matched too.
+  Scope other_scope;
+  const auto* created = methods.create(
+      redex::create_void_method(other_scope, "LLogged;", "third"));
+  EXPECT_TRUE(created->logged());
+}
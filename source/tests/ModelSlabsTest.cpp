@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <gmock/gmock.h>
+
+#include <mariana-trench/ModelSlabs.h>
+#include <mariana-trench/tests/Test.h>
+
+namespace marianatrench {
+
+class ModelSlabsTest : public test::Test {};
+
+namespace {
+
+struct Value {
+  std::uint64_t first;
+  std::uint64_t second;
+};
+
+} // namespace
+
+TEST_F(ModelSlabsTest, Contiguous) {
+  std::vector<std::shared_ptr<const Value>> values;
+  std::thread([&]() {
+    for (std::uint64_t i = 0; i < 3; i++) {
+      values.push_back(ModelSlabs::make_shared<Value>(Value{i, i + 1}));
+    }
+  }).join();
+
+  // Allocations of a thread follow each other in its slab.
+  auto first = reinterpret_cast<std::uintptr_t>(values[0].get());
+  auto second = reinterpret_cast<std::uintptr_t>(values[1].get());
+  auto third = reinterpret_cast<std::uintptr_t>(values[2].get());
+  EXPECT_LT(first, second);
+  EXPECT_EQ(second - first, third - second);
+  EXPECT_LT(second - first, 128);
+  EXPECT_EQ(values[2]->first, 2);
+  EXPECT_EQ(values[2]->second, 3);
+}
+
+TEST_F(ModelSlabsTest, Reclaim) {
+  auto live_slabs = ModelSlabs::live_slabs();
+  std::vector<std::shared_ptr<const Value>> values;
+  std::thread([&]() {
+    // Enough allocations to fill a few slabs.
+    for (std::uint64_t i = 0; i < 3 * ModelSlabs::k_slab_size / 64; i++) {
+      values.push_back(ModelSlabs::make_shared<Value>(Value{i, i}));
+    }
+  }).join();
+  EXPECT_GE(ModelSlabs::live_slabs(), live_slabs + 3);
+
+  // Slabs are freed by the last of their allocations, on another thread.
+  values.clear();
+  EXPECT_EQ(ModelSlabs::live_slabs(), live_slabs);
+
+  // Large allocations use the heap.
+  using Large = std::array<char, ModelSlabs::k_slab_size / 2>;
+  auto large = ModelSlabs::make_shared<Large>();
+  EXPECT_EQ(ModelSlabs::live_slabs(), live_slabs);
+  EXPECT_EQ(large->size(), ModelSlabs::k_slab_size / 2);
+}
+
+} // namespace marianatrench
@@ -427,6 +427,132 @@ TEST_F(ModelTest, LessOrEqual) {
                     SanitizerKind::Sources, KindSetAbstractDomain::top()))}})));
 }
 
+TEST_F(ModelTest, CallerVisibleLessOrEqual) {
+  auto context = test::make_empty_context();
+  const auto* source_kind = context.kinds->get("TestSource");
+  const auto* sink_kind = context.kinds->get("TestSink");
+  SourceSinkRule rule("rule", 1, "description", {source_kind}, {sink_kind});
+
+  auto model = Model(
+      /* method */ nullptr,
+      context,
+      /* modes */ Model::Mode::Normal,
+      /* generations */
+      {{AccessPath(Root(Root::Kind::Return)), Frame::leaf(source_kind)}});
+
+  auto model_with_issue = model;
+  model_with_issue.set_issues(IssueSet{Issue(
+      /* source */ Taint{Frame::leaf(source_kind)},
+      /* sink */ Taint{Frame::leaf(sink_kind)},
+      &rule,
+      context.positions->get(std::nullopt, 1))});
+  EXPECT_FALSE(model_with_issue.leq(model));
+  EXPECT_TRUE(model_with_issue.caller_visible_leq(model));
+
+  auto model_with_sink = model;
+  model_with_sink.join_with(Model(
+      /* method */ nullptr,
+      context,
+      /* modes */ Model::Mode::Normal,
+      /* generations */ {},
+      /* parameter_sources */ {},
+      /* sinks */
+      {{AccessPath(Root(Root::Kind::Argument, 0)), Frame::leaf(sink_kind)}}));
+  EXPECT_FALSE(model_with_sink.leq(model));
+  EXPECT_FALSE(model_with_sink.caller_visible_leq(model));
+  EXPECT_TRUE(model.caller_visible_leq(model_with_sink));
+}
+
+TEST_F(ModelTest, Shape) {
+  auto context = test::make_empty_context();
+  const auto* source_kind = context.kinds->get("TestSource");
+  const auto* sink_kind = context.kinds->get("TestSink");
+
+  EXPECT_EQ(Model().shape(), Model::Shape::Empty);
+
+  auto propagation = Propagation(
+      /* input */ AccessPath(
+          Root(Root::Kind::Argument, 0), Path{DexString::make_string("x")}),
+      /* inferred_features */ FeatureMayAlwaysSet::bottom(),
+      /* user_features */ FeatureSet::bottom());
+  auto model = Model(
+      /* method */ nullptr,
+      context,
+      /* modes */ Model::Mode::Normal,
+      /* generations */ {},
+      /* parameter_sources */ {},
+      /* sinks */ {},
+      /* propagations */
+      {{propagation, AccessPath(Root(Root::Kind::Return))}});
+  EXPECT_EQ(model.shape(), Model::Shape::Propagations);
+
+  model.set_inline_as(AccessPathConstantDomain(propagation.input()));
+  EXPECT_EQ(model.shape(), Model::Shape::InlineAs);
+
+  // Parameter sources are not applied at call sites.
+  model.add_parameter_source(
+      AccessPath(Root(Root::Kind::Argument, 0)), Frame::leaf(source_kind));
+  EXPECT_EQ(model.shape(), Model::Shape::InlineAs);
+
+  model.add_sink(
+      AccessPath(Root(Root::Kind::Argument, 0)), Frame::leaf(sink_kind));
+  EXPECT_EQ(model.shape(), Model::Shape::General);
+
+  auto model_with_generation = Model(
+      /* method */ nullptr,
+      context,
+      /* modes */ Model::Mode::Normal,
+      /* generations */
+      {{AccessPath(Root(Root::Kind::Return)), Frame::leaf(source_kind)}});
+  EXPECT_EQ(model_with_generation.shape(), Model::Shape::General);
+
+  auto obscure_model = Model(
+      /* method */ nullptr, context, Model::Mode::AddViaObscureFeature);
+  EXPECT_EQ(obscure_model.shape(), Model::Shape::Propagations);
+}
+
+TEST_F(ModelTest, SetCallPosition) {
+  Scope scope;
+  auto* dex_callee = redex::create_void_method(
+      scope,
+      "LClass;",
+      "callee",
+      /* parameter_types */ "",
+      /* return_type */ "Ljava/lang/Object;");
+  auto* dex_caller = redex::create_void_method(scope, "LClass;", "caller");
+  DexStore store("stores");
+  store.add_classes(scope);
+  auto context = test::make_context(store);
+  const auto* callee = context.methods->get(dex_callee);
+  const auto* caller = context.methods->get(dex_caller);
+  const auto* source_kind = context.kinds->get("TestSource");
+
+  auto model = Model(
+      callee,
+      context,
+      /* modes */ Model::Mode::Normal,
+      /* generations */
+      {{AccessPath(Root(Root::Kind::Return)), Frame::leaf(source_kind)}});
+  const auto* position_1 = context.positions->get(std::nullopt, 1);
+  const auto* position_2 = context.positions->get(std::nullopt, 2);
+
+  auto model_at_position = model.at_callsite(
+      caller,
+      position_1,
+      context,
+      /* source_register_types */ {},
+      /* source_constant_arguments */ {});
+  model_at_position.set_call_position(position_2);
+  EXPECT_EQ(
+      model_at_position,
+      model.at_callsite(
+          caller,
+          position_2,
+          context,
+          /* source_register_types */ {},
+          /* source_constant_arguments */ {}));
+}
+
 TEST_F(ModelTest, Join) {
   using PortTaint = std::pair<AccessPath, Taint>;
 
@@ -848,3 +974,78 @@ TEST_F(ModelTest, Join) {
 }
 
 } // namespace marianatrench
+
+TEST_F(ModelTest, JoinWithChange) {
+  auto context = test::make_empty_context();
+  const auto* source_kind = context.kinds->get("TestSource");
+  const auto* sink_kind = context.kinds->get("TestSink");
+
+  auto generation = Model(
+      /* method */ nullptr,
+      context,
+      /* modes */ Model::Mode::Normal,
+      /* generations */
+      {{AccessPath(Root(Root::Kind::Return)), Frame::leaf(source_kind)}});
+  auto sink = Model(
+      /* method */ nullptr,
+      context,
+      /* modes */ Model::Mode::Normal,
+      /* generations */ {},
+      /* parameter_sources */ {},
+      /* sinks */
+      {{AccessPath(Root(Root::Kind::Argument, 0)), Frame::leaf(sink_kind)}});
+
+  auto model = generation;
+  EXPECT_EQ(model.join_with_change(generation), Model::Change::None);
+  EXPECT_EQ(model.join_with_change(Model()), Model::Change::None);
+  EXPECT_EQ(model, generation);
+
+  EXPECT_EQ(model.join_with_change(sink), Model::Change::CallerVisible);
+  auto expected = generation;
+  expected.join_with(sink);
+  EXPECT_EQ(model, expected);
+  EXPECT_EQ(model.join_with_change(sink), Model::Change::None);
+
+  SourceSinkRule rule("rule", 1, "description", {source_kind}, {sink_kind});
+  auto issue = Model(/* method */ nullptr, context);
+  issue.set_issues(IssueSet{Issue(
+      /* source */ Taint{Frame::leaf(source_kind)},
+      /* sink */ Taint{Frame::leaf(sink_kind)},
+      &rule,
+      context.positions->get(std::nullopt, 1))});
+  EXPECT_EQ(model.join_with_change(issue), Model::Change::Issues);
+  EXPECT_EQ(model.join_with_change(issue), Model::Change::None);
+
+  EXPECT_EQ(
+      model.join_with_change(
+          Model(/* method */ nullptr, context, Model::Mode::SkipAnalysis)),
+      Model::Change::CallerVisible);
+}
+
+TEST_F(ModelTest, WidenWithChange) {
+  auto context = test::make_empty_context();
+  const auto* source_kind = context.kinds->get("TestSource");
+  const auto* x = DexString::make_string("x");
+  const auto* y = DexString::make_string("y");
+
+  auto generation = Model(
+      /* method */ nullptr,
+      context,
+      /* modes */ Model::Mode::Normal,
+      /* generations */
+      {{AccessPath(Root(Root::Kind::Return), Path{x, y}),
+        Frame::leaf(source_kind)}});
+
+  auto model = Model();
+  EXPECT_EQ(model.widen_with_change(generation), Model::Change::CallerVisible);
+  EXPECT_THAT(
+      model.generations().elements(),
+      testing::UnorderedElementsAre(PortTaint{
+          AccessPath(Root(Root::Kind::Return), Path{x}),
+          Taint{Frame::leaf(source_kind)}}));
+  EXPECT_TRUE(generation.leq(model));
+
+  // The widened model already includes the deeper port.
+  EXPECT_EQ(model.widen_with_change(generation), Model::Change::None);
+  EXPECT_EQ(model.join_with_change(generation), Model::Change::None);
+}
@@ -0,0 +1,158 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <gtest/gtest.h>
+
+#include <mariana-trench/Dependencies.h>
+#include <mariana-trench/MethodBitset.h>
+#include <mariana-trench/NumaPlacement.h>
+#include <mariana-trench/Redex.h>
+#include <mariana-trench/Scheduler.h>
+#include <mariana-trench/tests/Test.h>
+
+using namespace marianatrench;
+
+namespace {
+
+class NumaPlacementTest : public test::Test {};
+
+} // anonymous namespace
+
+TEST_F(NumaPlacementTest, ComponentsAreScheduledOnTheirNode) {
+  Scope scope;
+  auto* dex_leaf = redex::create_method(scope, "LLeaf;", R"(
+    (method (public static) "LLeaf;.leaf:()V"
+     (
+      (return-void)
+     )
+    )
+  )");
+  auto* dex_first = redex::create_method(scope, "LCycle;", R"(
+    (method (public static) "LCycle;.first:()V"
+     (
+      (invoke-static () "LCycle;.second:()V")
+      (invoke-static () "LLeaf;.leaf:()V")
+      (return-void)
+     )
+    )
+  )");
+  auto* dex_second = redex::create_method(scope, "LCycle;", R"(
+    (method (public static) "LCycle;.second:()V"
+     (
+      (invoke-static () "LCycle;.first:()V")
+      (return-void)
+     )
+    )
+  )");
+  auto* dex_other = redex::create_method(scope, "LOther;", R"(
+    (method (public static) "LOther;.other:()V"
+     (
+      (return-void)
+     )
+    )
+  )");
+
+  DexStore store("test_store");
+  store.add_classes(scope);
+  auto context = test::make_context(store);
+  context.rules = std::make_unique<Rules>();
+  auto registry = Registry(context);
+  context.dependencies = std::make_unique<Dependencies>(
+      *context.options,
+      *context.methods,
+      *context.overrides,
+      *context.call_graph,
+      registry);
+  auto scheduler = Scheduler(
+      *context.methods, *context.dependencies, *context.statistics);
+
+  const auto* leaf = context.methods->get(dex_leaf);
+  const auto* first = context.methods->get(dex_first);
+  const auto* second = context.methods->get(dex_second);
+  const auto* other = context.methods->get(dex_other);
+
+  // Use a topology without processors, so that workers are not pinned.
+  auto placement = NumaPlacement(
+      scheduler,
+      /* threads */ 4,
+      /* node_processors */ std::vector<std::vector<int>>(2));
+  EXPECT_EQ(placement.nodes(), 2);
+  EXPECT_EQ(placement.worker_node(0), 0);
+  EXPECT_EQ(placement.worker_node(1), 0);
+  EXPECT_EQ(placement.worker_node(2), 1);
+  EXPECT_EQ(placement.worker_node(3), 1);
+  EXPECT_EQ(placement.method_node(first), placement.method_node(second));
+
+  scheduler.set_numa_placement(&placement);
+  MethodBitset methods(*context.methods);
+  for (const auto* method : {leaf, first, second, other}) {
+    methods.insert(method);
+  }
+  scheduler.schedule(
+      methods,
+      [&](const Method* method, std::size_t worker) {
+        EXPECT_LT(worker, 4);
+        EXPECT_EQ(placement.worker_node(worker), placement.method_node(method));
+        placement.enter(worker, method);
+      },
+      /* threads */ 4);
+  placement.enter(
+      placement.method_node(other) == 0 ? 3 : 0, /* method */ other);
+
+  auto statistics = placement.to_json();
+  EXPECT_EQ(statistics["nodes"].asUInt64(), 2);
+  EXPECT_EQ(statistics["pinned_threads"].asUInt64(), 0);
+  EXPECT_EQ(
+      statistics["per_node"][0]["analyses"].asUInt64() +
+          statistics["per_node"][1]["analyses"].asUInt64(),
+      5);
+  EXPECT_EQ(
+      statistics["per_node"][0]["remote_analyses"].asUInt64() +
+          statistics["per_node"][1]["remote_analyses"].asUInt64(),
+      1);
+  EXPECT_LE(
+      statistics["remote_dependencies"].asUInt64(),
+      statistics["dependencies"].asUInt64());
+}
+
+TEST_F(NumaPlacementTest, NodesAreLimitedByThreads) {
+  Scope scope;
+  redex::create_method(scope, "LLeaf;", R"(
+    (method (public static) "LLeaf;.leaf:()V"
+     (
+      (return-void)
+     )
+    )
+  )");
+
+  DexStore store("test_store");
+  store.add_classes(scope);
+  auto context = test::make_context(store);
+  context.rules = std::make_unique<Rules>();
+  auto registry = Registry(context);
+  context.dependencies = std::make_unique<Dependencies>(
+      *context.options,
+      *context.methods,
+      *context.overrides,
+      *context.call_graph,
+      registry);
+  auto scheduler = Scheduler(
+      *context.methods, *context.dependencies, *context.statistics);
+
+  auto placement = NumaPlacement(
+      scheduler,
+      /* threads */ 1,
+      /* node_processors */ std::vector<std::vector<int>>(4));
+  EXPECT_EQ(placement.nodes(), 1);
+
+  auto single_node = NumaPlacement(
+      scheduler,
+      /* threads */ 8,
+      /* node_processors */ std::vector<std::vector<int>>{});
+  EXPECT_EQ(single_node.nodes(), 1);
+  EXPECT_EQ(single_node.worker_node(7), 0);
+}
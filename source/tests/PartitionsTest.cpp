@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <stdexcept>
+
+#include <gtest/gtest.h>
+
+#include <mariana-trench/Dependencies.h>
+#include <mariana-trench/Partitions.h>
+#include <mariana-trench/Redex.h>
+#include <mariana-trench/Scheduler.h>
+#include <mariana-trench/tests/Test.h>
+
+using namespace marianatrench;
+
+namespace {
+
+class PartitionsTest : public test::Test {};
+
+} // anonymous namespace
+
+TEST_F(PartitionsTest, ComponentsAreNotSplit) {
+  Scope scope;
+  auto* dex_leaf = redex::create_method(scope, "LLeaf;", R"(
+    (method (public static) "LLeaf;.leaf:()V"
+     (
+      (return-void)
+     )
+    )
+  )");
+  auto* dex_first = redex::create_method(scope, "LCycle;", R"(
+    (method (public static) "LCycle;.first:()V"
+     (
+      (invoke-static () "LCycle;.second:()V")
+      (invoke-static () "LLeaf;.leaf:()V")
+      (return-void)
+     )
+    )
+  )");
+  auto* dex_second = redex::create_method(scope, "LCycle;", R"(
+    (method (public static) "LCycle;.second:()V"
+     (
+      (invoke-static () "LCycle;.first:()V")
+      (return-void)
+     )
+    )
+  )");
+  auto* dex_other = redex::create_method(scope, "LOther;", R"(
+    (method (public static) "LOther;.other:()V"
+     (
+      (return-void)
+     )
+    )
+  )");
+
+  DexStore store("test_store");
+  store.add_classes(scope);
+  auto context = test::make_context(store);
+  context.rules = std::make_unique<Rules>();
+  auto registry = Registry(context);
+  context.dependencies = std::make_unique<Dependencies>(
+      *context.options,
+      *context.methods,
+      *context.overrides,
+      *context.call_graph,
+      registry);
+  auto scheduler = Scheduler(
+      *context.methods, *context.dependencies, *context.statistics);
+
+  const auto* leaf = context.methods->get(dex_leaf);
+  const auto* first = context.methods->get(dex_first);
+  const auto* second = context.methods->get(dex_second);
+  const auto* other = context.methods->get(dex_other);
+
+  auto partitions = Partitions(
+      *context.methods, scheduler, /* count */ 2, /* index */ 1);
+  EXPECT_EQ(partitions.count(), 2);
+  EXPECT_EQ(partitions.partition(first), partitions.partition(second));
+  for (const auto* method : {leaf, first, second, other}) {
+    EXPECT_LT(partitions.partition(method), 2);
+    EXPECT_EQ(partitions.is_local(method), partitions.partition(method) == 1);
+  }
+
+  EXPECT_THROW(
+      Partitions(*context.methods, scheduler, /* count */ 2, /* index */ 2),
+      std::invalid_argument);
+}
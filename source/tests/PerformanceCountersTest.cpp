@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <gmock/gmock.h>
+
+#include <mariana-trench/PerformanceCounters.h>
+#include <mariana-trench/Redex.h>
+#include <mariana-trench/Statistics.h>
+#include <mariana-trench/tests/Test.h>
+
+namespace marianatrench {
+
+class PerformanceCountersTest : public test::Test {};
+
+namespace {
+
+PerformanceCounters::Values values(
+    std::uint64_t cycles,
+    std::uint64_t instructions) {
+  PerformanceCounters::Values values;
+  values.counts[static_cast<std::size_t>(PerformanceCounters::Event::Cycles)] =
+      cycles;
+  values.counts[static_cast<std::size_t>(
+      PerformanceCounters::Event::Instructions)] = instructions;
+  return values;
+}
+
+} // namespace
+
+TEST_F(PerformanceCountersTest, Values) {
+  auto sum = values(100, 200);
+  sum += values(100, 100);
+  EXPECT_EQ(sum[PerformanceCounters::Event::Cycles], 200);
+  EXPECT_EQ(sum[PerformanceCounters::Event::Instructions], 300);
+
+  auto difference = sum - values(50, 400);
+  EXPECT_EQ(difference[PerformanceCounters::Event::Cycles], 150);
+  // Counters are monotonic, differences never wrap around.
+  EXPECT_EQ(difference[PerformanceCounters::Event::Instructions], 0);
+
+  EXPECT_EQ(
+      values(200, 300).to_json(),
+      test::parse_json(R"({
+        "cycles": 200,
+        "instructions": 300,
+        "llc_misses": 0,
+        "dtlb_misses": 0,
+        "instructions_per_cycle": 1.5
+      })"));
+
+  // Counters that cannot be opened read 0.
+  const auto& counters = PerformanceCounters::thread();
+  auto first = counters.read();
+  auto second = counters.read();
+  for (std::size_t index = 0; index < PerformanceCounters::kEvents; index++) {
+    EXPECT_GE(second.counts[index], first.counts[index]);
+  }
+}
+
+TEST_F(PerformanceCountersTest, Statistics) {
+  Scope scope;
+  auto context = test::make_empty_context();
+  const auto* method_a = context.methods->create(
+      redex::create_void_method(scope, "LClass;", "method_a"));
+  const auto* method_b = context.methods->create(
+      redex::create_void_method(scope, "LClass;", "method_b"));
+
+  Statistics statistics;
+  EXPECT_FALSE(statistics.to_json().isMember("performance_counters"));
+
+  PerformanceCounters counters(PerformanceCounters::Scope::Thread);
+  {
+    PhaseCounters phase(&counters, statistics, "phase");
+  }
+  {
+    PhaseCounters ignored(/* counters */ nullptr, statistics, "ignored");
+  }
+  statistics.log_performance_counters(method_a, values(10, 10));
+  statistics.log_performance_counters(method_b, values(20, 10));
+  statistics.log_performance_counters(method_a, values(20, 10));
+
+  auto value = statistics.to_json()["performance_counters"];
+  EXPECT_TRUE(value["phases"].isMember("phase"));
+  EXPECT_FALSE(value["phases"].isMember("ignored"));
+  ASSERT_EQ(value["methods"].size(), 2);
+  EXPECT_EQ(value["methods"][0]["method"].asString(), method_a->show());
+  EXPECT_EQ(value["methods"][0]["cycles"].asUInt64(), 30);
+  EXPECT_EQ(value["methods"][1]["method"].asString(), method_b->show());
+
+  // The resident set size is recorded without hardware counters.
+  auto phase_rss = statistics.to_json()["phase_rss"];
+  EXPECT_TRUE(phase_rss.isMember("phase"));
+  EXPECT_TRUE(phase_rss.isMember("ignored"));
+  EXPECT_TRUE(phase_rss["ignored"].isMember("before"));
+  EXPECT_TRUE(phase_rss["ignored"].isMember("after"));
+}
+
+} // namespace marianatrench
@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <gmock/gmock.h>
+
+#include <mariana-trench/JsonValidation.h>
+#include <mariana-trench/PerformanceProfile.h>
+#include <mariana-trench/Redex.h>
+#include <mariana-trench/tests/Test.h>
+
+namespace marianatrench {
+
+class PerformanceProfileTest : public test::Test {};
+
+TEST_F(PerformanceProfileTest, FromStatistics) {
+  Scope scope;
+  auto context = test::make_empty_context();
+  const auto* method_a = context.methods->create(
+      redex::create_void_method(scope, "LClass;", "method_a"));
+  const auto* method_b = context.methods->create(
+      redex::create_void_method(scope, "LClass;", "method_b"));
+
+  Statistics statistics;
+  statistics.log_number_iterations(3);
+  statistics.log_resident_set_size(1.5);
+  statistics.log_phase_resident_set_size("fixpoint", 1.0, 2.0);
+  for (int analysis = 0; analysis < 3; analysis++) {
+    statistics.log_time(method_a, Timer());
+  }
+  statistics.log_time(method_b, Timer());
+  statistics.log_time("fixpoint", Timer());
+
+  auto profile = PerformanceProfile::from_statistics(statistics);
+  EXPECT_EQ(profile["iterations"].asUInt64(), 3);
+  EXPECT_EQ(profile["analyses"].asUInt64(), 4);
+  EXPECT_EQ(profile["maximum_method_analyses"].asUInt64(), 3);
+  EXPECT_DOUBLE_EQ(profile["analyses_per_method"].asDouble(), 2.0);
+  EXPECT_DOUBLE_EQ(profile["rss"].asDouble(), 2.0);
+  EXPECT_TRUE(profile["times"].isMember("fixpoint"));
+
+  // A profile never regresses against itself.
+  EXPECT_TRUE(PerformanceProfile::regressions(profile, profile).empty());
+}
+
+TEST_F(PerformanceProfileTest, Regressions) {
+  auto baseline = test::parse_json(R"({
+    "iterations": 3,
+    "analyses": 100,
+    "rss": 1.0,
+    "times": {"fixpoint": 10.0, "call_graph": 1.0}
+  })");
+
+  // Slower phases and memory within their bands are not regressions.
+  EXPECT_TRUE(PerformanceProfile::regressions(
+                  baseline,
+                  test::parse_json(R"({
+                    "iterations": 3,
+                    "analyses": 104,
+                    "rss": 1.2,
+                    "times": {"fixpoint": 18.0, "other": 100.0}
+                  })"))
+                  .empty());
+
+  // An extra global iteration is a regression.
+  EXPECT_THAT(
+      PerformanceProfile::regressions(
+          baseline,
+          test::parse_json(R"({
+            "iterations": 4,
+            "analyses": 120,
+            "rss": 1.0,
+            "times": {"fixpoint": 25.0, "call_graph": 1.0}
+          })")),
+      testing::ElementsAre(
+          "`iterations` regressed from 3 to 4 (limit: 3)",
+          "`analyses` regressed from 100 to 120 (limit: 105)",
+          "`times.fixpoint` regressed from 10 to 25 (limit: 20.5)"));
+
+  // Tolerances of the baseline override the defaults.
+  baseline["tolerances"] = test::parse_json(R"({
+    "iterations": {"absolute": 1},
+    "times": {"relative": 0.1}
+  })");
+  EXPECT_EQ(
+      PerformanceProfile::tolerance(baseline, "iterations").absolute, 1.0);
+  EXPECT_EQ(PerformanceProfile::tolerance(baseline, "times").relative, 0.1);
+  EXPECT_EQ(PerformanceProfile::tolerance(baseline, "times").absolute, 0.5);
+  EXPECT_THAT(
+      PerformanceProfile::regressions(
+          baseline,
+          test::parse_json(R"({
+            "iterations": 4,
+            "analyses": 100,
+            "rss": 1.0,
+            "times": {"fixpoint": 11.0, "call_graph": 2.0}
+          })")),
+      testing::ElementsAre(
+          "`times.call_graph` regressed from 1 to 2 (limit: 1.6)"));
+
+  EXPECT_THROW(
+      PerformanceProfile::regressions(
+          test::parse_json(R"({"iterations": "3"})"),
+          test::parse_json(R"({"iterations": 3})")),
+      JsonValidationError);
+}
+
+} // namespace marianatrench
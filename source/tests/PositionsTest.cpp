@@ -0,0 +1,46 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <gmock/gmock.h>
+
+#include <mariana-trench/Positions.h>
+#include <mariana-trench/Redex.h>
+#include <mariana-trench/tests/Test.h>
+
+namespace marianatrench {
+
+class PositionsTest : public test::Test {};
+
+TEST_F(PositionsTest, IndexMethods) {
+  Scope scope;
+  auto context = test::make_empty_context();
+  const auto* method_a = context.methods->create(
+      redex::create_void_method(scope, "LClass;", "method_a"));
+  const auto* method_b = context.methods->create(
+      redex::create_void_method(scope, "LClass;", "method_b"));
+  auto& positions = *context.positions;
+
+  const auto* position_a = positions.get(method_a);
+  const auto* position_b = positions.get(method_b);
+  DexPosition dex_position(/* line */ 42);
+  const auto* position_line = positions.get(method_a, &dex_position);
+  EXPECT_EQ(position_line->line(), 42);
+
+  positions.index_methods(*context.methods);
+
+  // Indexed positions are the same as positions from the global set.
+  EXPECT_EQ(positions.get(method_a), position_a);
+  EXPECT_EQ(positions.get(method_b), position_b);
+  EXPECT_EQ(positions.get(method_a, &dex_position), position_line);
+
+  // Methods created after indexing are still supported.
+  const auto* method_c = context.methods->create(
+      redex::create_void_method(scope, "LClass;", "method_c"));
+  EXPECT_EQ(positions.get(method_c), positions.get(method_c->dex_method()));
+}
+
+} // namespace marianatrench
@@ -49,4 +49,44 @@ TEST_F(RE2Test, AsStringLiteral) {
   }
 }
 
+TEST_F(RE2Test, AsStringLiteralPrefix) {
+  EXPECT_EQ(
+      as_string_literal_prefix(re2::RE2("Foo")),
+      std::optional<std::string>("Foo"));
+  EXPECT_EQ(
+      as_string_literal_prefix(re2::RE2("Foo.*")),
+      std::optional<std::string>("Foo"));
+  EXPECT_EQ(
+      as_string_literal_prefix(re2::RE2("Foo\\..*")),
+      std::optional<std::string>("Foo."));
+  EXPECT_EQ(
+      as_string_literal_prefix(re2::RE2("Landroid/.*;\\.bar:.*")),
+      std::optional<std::string>("Landroid/"));
+  EXPECT_EQ(
+      as_string_literal_prefix(re2::RE2("Foo+")),
+      std::optional<std::string>("Foo"));
+  EXPECT_EQ(
+      as_string_literal_prefix(re2::RE2("Foo*")),
+      std::optional<std::string>("Fo"));
+  EXPECT_EQ(
+      as_string_literal_prefix(re2::RE2("Foo?")),
+      std::optional<std::string>("Fo"));
+  EXPECT_EQ(
+      as_string_literal_prefix(re2::RE2("Foo{0,2}")),
+      std::optional<std::string>("Fo"));
+  EXPECT_EQ(
+      as_string_literal_prefix(re2::RE2("Foo\\.*")),
+      std::optional<std::string>("Foo"));
+  EXPECT_EQ(
+      as_string_literal_prefix(re2::RE2("Foo(Bar)?")),
+      std::optional<std::string>("Foo"));
+
+  EXPECT_EQ(as_string_literal_prefix(re2::RE2("F*")), std::nullopt);
+  EXPECT_EQ(as_string_literal_prefix(re2::RE2(".*Foo")), std::nullopt);
+  EXPECT_EQ(as_string_literal_prefix(re2::RE2("(?i)Foo")), std::nullopt);
+  EXPECT_EQ(as_string_literal_prefix(re2::RE2("Foo|Bar")), std::nullopt);
+  EXPECT_EQ(as_string_literal_prefix(re2::RE2("Foo.*|Bar")), std::nullopt);
+  EXPECT_EQ(as_string_literal_prefix(re2::RE2("Foo(a|b)")), std::nullopt);
+}
+
 } // namespace marianatrench
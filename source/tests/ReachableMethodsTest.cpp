@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <gtest/gtest.h>
+
+#include <DexStore.h>
+#include <RedexContext.h>
+
+#include <mariana-trench/Dependencies.h>
+#include <mariana-trench/ReachableMethods.h>
+#include <mariana-trench/Redex.h>
+#include <mariana-trench/tests/Test.h>
+
+using namespace marianatrench;
+
+namespace {
+
+class ReachableMethodsTest : public test::Test {};
+
+} // anonymous namespace
+
+TEST_F(ReachableMethodsTest, EntryPoints) {
+  Scope scope;
+
+  auto* dex_callee = redex::create_method(scope, "LCallee;", R"(
+    (method (public static) "LCallee;.callee:()V"
+     (
+      (return-void)
+     )
+    )
+  )");
+  auto* dex_entry = redex::create_method(scope, "LEntry;", R"(
+    (method (public static) "LEntry;.entry:()V"
+     (
+      (invoke-static () "LCallee;.callee:()V")
+      (return-void)
+     )
+    )
+  )");
+  auto* dex_unreachable = redex::create_method(scope, "LUnreachable;", R"(
+    (method (public static) "LUnreachable;.unreachable:()V"
+     (
+      (invoke-static () "LCallee;.callee:()V")
+      (return-void)
+     )
+    )
+  )");
+  auto* dex_initialized = redex::create_method(scope, "LInitialized;", R"(
+    (method (public static) "LInitialized;.initialized:()V"
+     (
+      (return-void)
+     )
+    )
+  )");
+  auto* dex_initializer = redex::create_method(scope, "LInitializer;", R"(
+    (method (static constructor) "LInitializer;.<clinit>:()V"
+     (
+      (invoke-static () "LInitialized;.initialized:()V")
+      (return-void)
+     )
+    )
+  )");
+
+  DexStore store("test_store");
+  store.add_classes(scope);
+  auto context = test::make_context(store);
+  const auto* callee = context.methods->get(dex_callee);
+  const auto* entry = context.methods->get(dex_entry);
+  const auto* unreachable = context.methods->get(dex_unreachable);
+  const auto* initialized = context.methods->get(dex_initialized);
+  const auto* initializer = context.methods->get(dex_initializer);
+
+  auto reachable_methods = ReachableMethods(
+      *context.options,
+      *context.methods,
+      *context.class_properties,
+      *context.call_graph,
+      /* lifecycle_methods */ {entry});
+  EXPECT_TRUE(reachable_methods.contains(entry));
+  EXPECT_TRUE(reachable_methods.contains(callee));
+  EXPECT_TRUE(reachable_methods.contains(initializer));
+  EXPECT_TRUE(reachable_methods.contains(initialized));
+  EXPECT_FALSE(reachable_methods.contains(unreachable));
+  EXPECT_EQ(reachable_methods.size(), 4);
+
+  // Unreachable methods are not dependencies of their callees.
+  context.rules = std::make_unique<Rules>();
+  auto registry = Registry(context);
+  auto dependencies = Dependencies(
+      *context.options,
+      *context.methods,
+      *context.overrides,
+      *context.call_graph,
+      registry,
+      &reachable_methods);
+  EXPECT_THAT(
+      dependencies.dependencies(callee), testing::UnorderedElementsAre(entry));
+}
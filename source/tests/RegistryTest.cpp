@@ -5,14 +5,22 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <fstream>
+#include <string>
+
 #include <gmock/gmock.h>
 
+#include <boost/filesystem/operations.hpp>
+
+#include <Show.h>
+
 #include <json/value.h>
 #include <mariana-trench/ClassProperties.h>
 #include <mariana-trench/Context.h>
 #include <mariana-trench/Dependencies.h>
 #include <mariana-trench/FieldSet.h>
 #include <mariana-trench/Fields.h>
+#include <mariana-trench/JsonValidation.h>
 #include <mariana-trench/Model.h>
 #include <mariana-trench/Redex.h>
 #include <mariana-trench/Registry.h>
@@ -34,29 +42,37 @@ TEST_F(RegistryTest, remove_kinds) {
   store.add_classes(scope);
   auto context = test::make_context(store);
 
-  auto registry = Registry::load(
-      context,
-      *context.options,
-      /* generated_models */
-      context.artificial_methods->models(
-          context), // used to make sure we get ArrayAllocation
-      /* generated_field_models */ {});
+  // Used to make sure we get ArrayAllocation
+  auto generated_models = context.artificial_methods->models(context);
   context.rules =
       std::make_unique<Rules>(Rules::load(context, *context.options));
-  auto old_model_json = JsonValidation::null_or_array(
-      registry.models_to_json(), /* field */ "models");
-  auto unused_kinds = context.rules->collect_unused_kinds(*context.kinds);
+  auto unused_kinds = UnusedKinds(*context.rules, *context.kinds);
   auto is_array_allocation = [](const Kind* kind) -> bool {
     const auto* named_kind = kind->as<NamedKind>();
     return named_kind != nullptr && named_kind->name() == "ArrayAllocation";
   };
   EXPECT_NE(
       std::find_if(
-          unused_kinds.begin(), unused_kinds.end(), is_array_allocation),
-      unused_kinds.end());
+          unused_kinds.kinds().begin(),
+          unused_kinds.kinds().end(),
+          is_array_allocation),
+      unused_kinds.kinds().end());
+  // Kinds created after the rules are loaded are never used.
+  EXPECT_TRUE(unused_kinds.is_unused(context.kinds->get("CreatedLater")));
+
+  auto old_model_json = JsonValidation::null_or_array(
+      Registry(context, generated_models, /* field_models */ {})
+          .models_to_json(),
+      /* field */ "models");
   EXPECT_TRUE(old_model_json[0].isMember("sinks"));
   EXPECT_EQ(old_model_json[0]["sinks"][0]["kind"], "ArrayAllocation");
-  UnusedKinds::remove_unused_kinds(context, registry);
+
+  auto registry = Registry::load(
+      context,
+      *context.options,
+      generated_models,
+      /* generated_field_models */ {},
+      unused_kinds);
   auto new_model_json = JsonValidation::null_or_array(
       registry.models_to_json(), /* field */ "models");
   EXPECT_NE(new_model_json, old_model_json);
@@ -245,3 +261,168 @@ TEST_F(RegistryTest, ConstructorUseJoin) {
 }
 
 } // namespace marianatrench
+
+TEST_F(RegistryTest, MemoryAccounting) {
+  Scope scope;
+  auto* dex_method = redex::create_void_method(
+      scope,
+      /* class_name */ "LClass;",
+      /* method_name */ "method",
+      /* parameter_types */ "Ljava/lang/Object;",
+      /* return_type */ "Ljava/lang/Object;");
+
+  DexStore store("store");
+  store.add_classes(scope);
+  auto context = test::make_context(store);
+  auto* method = context.methods->get(dex_method);
+  const auto* source_kind = context.kinds->get("TestSource");
+  const auto* sink_kind = context.kinds->get("TestSink");
+
+  auto registry = Registry(context);
+  auto empty = registry.memory_accounting().to_json();
+  EXPECT_EQ(empty["generations"].asUInt64(), 0);
+  EXPECT_EQ(empty["sinks"].asUInt64(), 0);
+
+  registry.set(Model(
+      /* method */ method,
+      context,
+      /* modes */ Model::Mode::Normal,
+      /* generations */
+      {{AccessPath(Root(Root::Kind::Return)), Frame::leaf(source_kind)}},
+      /* parameter_sources */ {},
+      /* sinks */
+      {{AccessPath(Root(Root::Kind::Argument, 1)), Frame::leaf(sink_kind)},
+       {AccessPath(Root(Root::Kind::Argument, 1)),
+        Frame::leaf(source_kind)}}));
+  auto memory = registry.memory_accounting().to_json();
+  EXPECT_GT(memory["generations"].asUInt64(), 0);
+  EXPECT_GT(memory["sinks"].asUInt64(), 0);
+  EXPECT_EQ(memory["propagations"].asUInt64(), 0);
+  EXPECT_EQ(memory["issues"].asUInt64(), 0);
+  EXPECT_EQ(
+      memory["total"].asUInt64(),
+      memory["generations"].asUInt64() + memory["sinks"].asUInt64());
+  EXPECT_EQ(memory["largest_methods"][0][0].asString(), show(method));
+  EXPECT_EQ(memory["frames_per_frame_set"]["1"].asUInt64(), 3);
+}
+
+TEST_F(RegistryTest, SpillModels) {
+  Scope scope;
+  auto* dex_method = redex::create_void_method(
+      scope,
+      /* class_name */ "LClass;",
+      /* method_name */ "method",
+      /* parameter_types */ "Ljava/lang/Object;",
+      /* return_type */ "Ljava/lang/Object;");
+
+  DexStore store("store");
+  store.add_classes(scope);
+  auto context = test::make_context(store);
+  auto* method = context.methods->get(dex_method);
+  const auto* source_kind = context.kinds->get("TestSource");
+
+  auto model = Model(
+      /* method */ method,
+      context,
+      /* modes */ Model::Mode::Normal,
+      /* generations */
+      {{AccessPath(Root(Root::Kind::Return)), Frame::leaf(source_kind)}});
+  auto registry = Registry(context);
+  registry.set(model);
+
+  auto directory = boost::filesystem::temp_directory_path() /
+      boost::filesystem::unique_path("mariana-trench-spill-%%%%%%%%");
+  registry.spill_models({method}, directory);
+  EXPECT_EQ(registry.models_size(), 0);
+  EXPECT_TRUE(boost::filesystem::exists(directory));
+  EXPECT_EQ(registry.get(method), model);
+
+  registry.restore_spilled_models();
+  EXPECT_EQ(registry.models_size(), 1);
+  EXPECT_EQ(registry.get(method), model);
+  EXPECT_FALSE(boost::filesystem::exists(directory));
+}
+
+TEST_F(RegistryTest, ImplicitModels) {
+  Scope scope;
+  auto* dex_method = redex::create_void_method(
+      scope,
+      /* class_name */ "LClass;",
+      /* method_name */ "method",
+      /* parameter_types */ "Ljava/lang/Object;",
+      /* return_type */ "Ljava/lang/Object;");
+
+  DexStore store("store");
+  store.add_classes(scope);
+  auto context = test::make_context(store);
+  auto* method = context.methods->get(dex_method);
+  const auto* source_kind = context.kinds->get("TestSource");
+
+  auto tito_model = Model(method, context, Model::Mode::TaintInTaintOut);
+  auto registry = Registry(
+      context, /* models */ {tito_model}, /* field_models */ {});
+  EXPECT_EQ(registry.models_size(), 1);
+  EXPECT_EQ(registry.memory_accounting().to_json()["total"].asUInt64(), 0);
+  EXPECT_EQ(registry.get(method), tito_model);
+  EXPECT_EQ(registry.get_snapshot(method), registry.get_snapshot(method));
+  EXPECT_EQ(registry.models_size(), 1);
+
+  auto generation = Model(
+      /* method */ method,
+      context,
+      /* modes */ Model::Mode::TaintInTaintOut,
+      /* generations */
+      {{AccessPath(Root(Root::Kind::Return)), Frame::leaf(source_kind)}});
+  auto joined_registry = Registry(
+      context, /* models */ {tito_model, generation}, /* field_models */ {});
+  EXPECT_EQ(joined_registry.models_size(), 1);
+  EXPECT_EQ(joined_registry.get(method), generation);
+
+  auto default_registry = Registry(context);
+  EXPECT_EQ(default_registry.models_size(), context.methods->size());
+  EXPECT_EQ(default_registry.get(method), Model(method, context));
+}
+
+TEST_F(RegistryTest, ModelsIndex) {
+  Scope scope;
+  auto* dex_first = redex::create_void_method(scope, "LFirst;", "method");
+  auto* dex_second = redex::create_void_method(scope, "LSecond;", "method");
+
+  DexStore store("store");
+  store.add_classes(scope);
+  auto context = test::make_context(store);
+  const auto* first = context.methods->get(dex_first);
+  const auto* second = context.methods->get(dex_second);
+  const auto* source_kind = context.kinds->get("TestSource");
+
+  auto registry = Registry(context);
+  registry.set(Model(
+      /* method */ first,
+      context,
+      /* modes */ Model::Mode::Normal,
+      /* generations */
+      {{AccessPath(Root(Root::Kind::Return)), Frame::leaf(source_kind)}}));
+
+  auto directory = boost::filesystem::temp_directory_path() /
+      boost::filesystem::unique_path("mariana-trench-models-%%%%%%%%");
+  boost::filesystem::create_directories(directory);
+  registry.dump_models(directory, /* shard_limit */ 1);
+
+  auto index =
+      JsonValidation::parse_json_file(directory / "models_index.json");
+  for (const auto* method : {first, second}) {
+    const auto& position = index["methods"][method->show()];
+    ASSERT_TRUE(position.isArray());
+    auto shard = index["shards"][position[0].asUInt()].asString();
+    std::ifstream file((directory / shard).native(), std::ios_base::binary);
+    file.seekg(position[1].asUInt64());
+    std::string line(position[2].asUInt64(), '\0');
+    file.read(line.data(), line.size());
+    EXPECT_EQ(line.back(), '\n');
+    EXPECT_EQ(
+        Model::from_json(method, JsonValidation::parse_json(line), context),
+        registry.get(method));
+  }
+
+  boost::filesystem::remove_all(directory);
+}
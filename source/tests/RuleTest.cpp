@@ -145,6 +145,19 @@ TEST_F(RuleTest, Rules) {
       to_codes(rules.partial_rules(source_a, partial_sink_lbl_b)),
       testing::UnorderedElementsAre(5));
   EXPECT_TRUE(rules.partial_rules(source_b, partial_sink_lbl_b).empty());
+
+  EXPECT_TRUE(rules.has_partial_rules_for_sink(partial_sink_lbl_a));
+  EXPECT_TRUE(rules.has_partial_rules_for_sink(partial_sink_lbl_b));
+  EXPECT_FALSE(rules.has_partial_rules_for_sink(sink_x));
+  EXPECT_FALSE(rules.has_partial_rules_for_sink(
+      context.kinds->get_partial("other_kind", "labelA")));
+
+  EXPECT_TRUE(rules.has_rules_for_sink(sink_x));
+  EXPECT_TRUE(rules.has_rules_for_sink(sink_y));
+  EXPECT_FALSE(rules.has_rules_for_sink(sink_z));
+  EXPECT_TRUE(rules.has_rules_for_sink(triggered_sink_lbl_a));
+  EXPECT_FALSE(rules.has_rules_for_sink(partial_sink_lbl_a));
+  EXPECT_FALSE(rules.has_rules_for_sink(source_a));
 }
 
 TEST_F(RuleTest, Uses) {
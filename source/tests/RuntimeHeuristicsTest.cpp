@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <gtest/gtest.h>
+
+#include <mariana-trench/Heuristics.h>
+#include <mariana-trench/JsonValidation.h>
+#include <mariana-trench/Redex.h>
+#include <mariana-trench/RuntimeHeuristics.h>
+#include <mariana-trench/tests/Test.h>
+
+namespace marianatrench {
+
+class RuntimeHeuristicsTest : public test::Test {};
+
+TEST_F(RuntimeHeuristicsTest, Defaults) {
+  Scope scope;
+  auto context = test::make_empty_context();
+  const auto* method = context.methods->create(
+      redex::create_void_method(scope, "LClass;", "method"));
+
+  auto heuristics = RuntimeHeuristics();
+  EXPECT_EQ(
+      heuristics.get(method).join_override_threshold,
+      Heuristics::kJoinOverrideThreshold);
+  EXPECT_EQ(
+      heuristics.get(method).model_tree_max_leaves,
+      Heuristics::kModelTreeMaxLeaves);
+  EXPECT_EQ(
+      heuristics.get(method).max_number_iterations,
+      Heuristics::kMaxNumberIterations);
+
+  heuristics = RuntimeHeuristics::from_json(
+      test::parse_json(R"({"model_tree_max_leaves": 5})"));
+  EXPECT_EQ(heuristics.get(method).model_tree_max_leaves, 5);
+  EXPECT_EQ(
+      heuristics.get(method).max_number_iterations,
+      Heuristics::kMaxNumberIterations);
+
+  EXPECT_THROW(
+      RuntimeHeuristics::from_json(
+          test::parse_json(R"({"model_tree_max_leaves": -1})")),
+      JsonValidationError);
+}
+
+TEST_F(RuntimeHeuristicsTest, Overrides) {
+  Scope scope;
+  auto context = test::make_empty_context();
+  const auto* method_a = context.methods->create(
+      redex::create_void_method(scope, "LClassA;", "method_a"));
+  const auto* method_b = context.methods->create(
+      redex::create_void_method(scope, "LClassA;", "method_b"));
+  const auto* method_c = context.methods->create(
+      redex::create_void_method(scope, "LClassB;", "method_c"));
+
+  auto heuristics = RuntimeHeuristics::from_json(test::parse_json(R"({
+    "max_number_iterations": 50,
+    "overrides": [
+      {"method": "LClassA;.method_a:()V", "model_tree_max_leaves": 3},
+      {"class": "LClassA;", "model_tree_max_leaves": 7}
+    ]
+  })"));
+
+  EXPECT_EQ(heuristics.get(method_a).model_tree_max_leaves, 3);
+  EXPECT_EQ(heuristics.get(method_a).max_number_iterations, 50);
+  EXPECT_EQ(heuristics.get(method_b).model_tree_max_leaves, 7);
+  EXPECT_EQ(
+      heuristics.get(method_c).model_tree_max_leaves,
+      Heuristics::kModelTreeMaxLeaves);
+  EXPECT_EQ(heuristics.get(method_c).max_number_iterations, 50);
+
+  // Indexing does not change the result.
+  heuristics.index(*context.methods);
+  EXPECT_EQ(heuristics.get(method_a).model_tree_max_leaves, 3);
+  EXPECT_EQ(heuristics.get(method_b).model_tree_max_leaves, 7);
+  EXPECT_EQ(
+      heuristics.get(method_c).model_tree_max_leaves,
+      Heuristics::kModelTreeMaxLeaves);
+
+  EXPECT_THROW(
+      RuntimeHeuristics::from_json(test::parse_json(R"({
+        "overrides": [{"method": "LUnknown;.unknown:()V"}]
+      })")),
+      JsonValidationError);
+}
+
+} // namespace marianatrench
@@ -157,4 +157,31 @@ TEST_F(SanitizerTest, SanitizerJoin) {
       std::exception);
 }
 
+TEST_F(SanitizerTest, Sanitizes) {
+  auto context = test::make_empty_context();
+  const auto* kind1 = context.kinds->get("Kind1");
+  const auto* kind2 = context.kinds->get("Kind2");
+  const auto* kind3 = context.kinds->get("Kind3");
+
+  EXPECT_FALSE(Sanitizer::bottom().sanitizes(kind1));
+  EXPECT_TRUE(Sanitizer(
+                  SanitizerKind::Sources,
+                  /* kinds */ KindSetAbstractDomain::top())
+                  .sanitizes(kind1));
+
+  auto sanitizer = Sanitizer(
+      SanitizerKind::Sinks,
+      /* kinds */ KindSetAbstractDomain({kind1}));
+  EXPECT_TRUE(sanitizer.sanitizes(kind1));
+  EXPECT_FALSE(sanitizer.sanitizes(kind2));
+  EXPECT_FALSE(sanitizer.sanitizes(kind3));
+
+  sanitizer.join_with(Sanitizer(
+      SanitizerKind::Sinks,
+      /* kinds */ KindSetAbstractDomain({kind3})));
+  EXPECT_TRUE(sanitizer.sanitizes(kind1));
+  EXPECT_FALSE(sanitizer.sanitizes(kind2));
+  EXPECT_TRUE(sanitizer.sanitizes(kind3));
+}
+
 } // namespace marianatrench
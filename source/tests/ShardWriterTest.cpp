@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+#include <gmock/gmock.h>
+
+#include <mariana-trench/ShardWriter.h>
+#include <mariana-trench/tests/Test.h>
+
+namespace marianatrench {
+
+class ShardWriterTest : public test::Test {};
+
+namespace {
+
+std::string read_file(const boost::filesystem::path& path) {
+  std::string content;
+  boost::filesystem::load_string_file(path, content);
+  return content;
+}
+
+} // namespace
+
+TEST_F(ShardWriterTest, WriteFiles) {
+  auto directory = boost::filesystem::temp_directory_path() /
+      boost::filesystem::unique_path("mariana-trench-%%%%-%%%%");
+  boost::filesystem::create_directory(directory);
+
+  // Small buffers and fewer buffers than files, to exercise the pool.
+  auto writer = ShardWriter(
+      /* io_threads */ 2,
+      /* buffer_size */ 7,
+      /* maximum_buffers */ 2,
+      ShardWriter::Sync::Files);
+
+  constexpr std::size_t kFiles = 8;
+  std::vector<std::string> expected(kFiles);
+  std::vector<std::thread> threads;
+  for (std::size_t index = 0; index < kFiles; index++) {
+    for (std::size_t line = 0; line < 100 * index; line++) {
+      expected[index] += "line " + std::to_string(line) + "\n";
+    }
+    threads.emplace_back([&, index]() {
+      auto file =
+          writer.open(directory / ("file" + std::to_string(index) + ".txt"));
+      // Writes of all sizes, smaller and larger than a buffer.
+      const auto& content = expected[index];
+      std::size_t offset = 0;
+      for (std::size_t size = 1; offset < content.size(); size++) {
+        auto chunk = content.substr(offset, size % 23);
+        file.write(chunk);
+        offset += chunk.size();
+      }
+      file.close();
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  writer.finish();
+
+  std::size_t bytes = 0;
+  for (std::size_t index = 0; index < kFiles; index++) {
+    EXPECT_EQ(
+        read_file(directory / ("file" + std::to_string(index) + ".txt")),
+        expected[index]);
+    bytes += expected[index].size();
+  }
+  EXPECT_EQ(writer.statistics().files, kFiles);
+  EXPECT_EQ(writer.statistics().bytes, bytes);
+  EXPECT_GE(writer.statistics().writes, bytes / 7);
+
+  boost::filesystem::remove_all(directory);
+}
+
+TEST_F(ShardWriterTest, Errors) {
+  auto writer = ShardWriter(
+      /* io_threads */ 1,
+      ShardWriter::kDefaultBufferSize,
+      /* maximum_buffers */ 1,
+      ShardWriter::Sync::None);
+  EXPECT_THROW(
+      writer.open("/mariana-trench-does-not-exist/file.json"),
+      std::runtime_error);
+
+  // Writes to a full device fail once the buffer is written.
+  if (boost::filesystem::exists("/dev/full")) {
+    auto file = writer.open("/dev/full");
+    file.write("model\n");
+    file.close();
+    EXPECT_THROW(writer.finish(), std::runtime_error);
+  }
+}
+
+} // namespace marianatrench
@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <memory>
+#include <vector>
+
+#include <gmock/gmock.h>
+
+#include <DexStore.h>
+
+#include <mariana-trench/Dependencies.h>
+#include <mariana-trench/Redex.h>
+#include <mariana-trench/Registry.h>
+#include <mariana-trench/Rules.h>
+#include <mariana-trench/SinkReachability.h>
+#include <mariana-trench/SourceSinkRule.h>
+#include <mariana-trench/tests/Test.h>
+
+namespace marianatrench {
+
+class SinkReachabilityTest : public test::Test {};
+
+TEST_F(SinkReachabilityTest, Prune) {
+  Scope scope;
+  auto* dex_source = redex::create_method(scope, "LSource;", R"(
+    (method (public static) "LSource;.source:()Ljava/lang/Object;"
+     (
+      (const v0 0)
+      (return-object v0)
+     )
+    )
+  )");
+  auto* dex_data = redex::create_method(scope, "LData;", R"(
+    (method (public static) "LData;.data:()Ljava/lang/Object;"
+     (
+      (const v0 0)
+      (return-object v0)
+     )
+    )
+  )");
+  auto* dex_sink = redex::create_method(scope, "LSink;", R"(
+    (method (public static) "LSink;.sink:(Ljava/lang/Object;)V"
+     (
+      (load-param-object v0)
+      (return-void)
+     )
+    )
+  )");
+  auto* dex_caller = redex::create_method(scope, "LCaller;", R"(
+    (method (public static) "LCaller;.caller:()V"
+     (
+      (invoke-static () "LSource;.source:()Ljava/lang/Object;")
+      (move-result-object v0)
+      (invoke-static (v0) "LSink;.sink:(Ljava/lang/Object;)V")
+      (invoke-static () "LData;.data:()Ljava/lang/Object;")
+      (return-void)
+     )
+    )
+  )");
+
+  DexStore store("test_store");
+  store.add_classes(scope);
+  auto context = test::make_context(store);
+  const auto* source = context.methods->get(dex_source);
+  const auto* data = context.methods->get(dex_data);
+  const auto* sink = context.methods->get(dex_sink);
+
+  // `OtherSource` flows into `OtherSink`, which no model has.
+  const auto* test_source = context.kinds->get("TestSource");
+  const auto* test_sink = context.kinds->get("TestSink");
+  const auto* other_source = context.kinds->get("OtherSource");
+  const auto* other_sink = context.kinds->get("OtherSink");
+  std::vector<std::unique_ptr<Rule>> rules;
+  rules.push_back(std::make_unique<SourceSinkRule>(
+      "rule", 1, "", Rule::KindSet{test_source}, Rule::KindSet{test_sink}));
+  rules.push_back(std::make_unique<SourceSinkRule>(
+      "other rule",
+      2,
+      "",
+      Rule::KindSet{other_source},
+      Rule::KindSet{other_sink}));
+  context.rules = std::make_unique<Rules>(context, std::move(rules));
+
+  auto registry = Registry(
+      context,
+      /* models */
+      {Model(
+           source,
+           context,
+           /* modes */ Model::Mode::Normal,
+           /* generations */
+           {{AccessPath(Root(Root::Kind::Return)),
+             Frame::leaf(test_source)}}),
+       Model(
+           data,
+           context,
+           /* modes */ Model::Mode::Normal,
+           /* generations */
+           {{AccessPath(Root(Root::Kind::Return)),
+             Frame::leaf(other_source)}}),
+       Model(
+           sink,
+           context,
+           /* modes */ Model::Mode::Normal,
+           /* generations */ {},
+           /* parameter_sources */ {},
+           /* sinks */
+           {{AccessPath(Root(Root::Kind::Argument, 0)),
+             Frame::leaf(test_sink)}})},
+      /* field_models */ {});
+  context.dependencies = std::make_unique<Dependencies>(
+      *context.options,
+      *context.methods,
+      *context.overrides,
+      *context.call_graph,
+      registry);
+
+  auto sink_reachability = SinkReachability(context, registry);
+  EXPECT_EQ(sink_reachability.sink_kinds(), 1);
+  EXPECT_TRUE(sink_reachability.may_reach_sink(source, test_source));
+  EXPECT_FALSE(sink_reachability.may_reach_sink(data, other_source));
+  // Kinds that are not sources of any rule are kept.
+  EXPECT_TRUE(sink_reachability.may_reach_sink(
+      data, context.kinds->get("UnknownSource")));
+
+  EXPECT_EQ(sink_reachability.prune(registry), 1);
+  EXPECT_FALSE(registry.get(source).generations().is_bottom());
+  EXPECT_TRUE(registry.get(data).generations().is_bottom());
+  EXPECT_FALSE(registry.get(sink).sinks().is_bottom());
+  static_cast<void>(dex_caller);
+}
+
+} // namespace marianatrench
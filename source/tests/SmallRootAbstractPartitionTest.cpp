@@ -0,0 +1,155 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <gmock/gmock.h>
+
+#include <PatriciaTreeSetAbstractDomain.h>
+
+#include <mariana-trench/SmallRootAbstractPartition.h>
+#include <mariana-trench/tests/Test.h>
+
+namespace marianatrench {
+
+class SmallRootAbstractPartitionTest : public test::Test {};
+
+using IntSet = sparta::PatriciaTreeSetAbstractDomain<unsigned>;
+using RootToIntSetPartition = SmallRootAbstractPartition<IntSet>;
+
+TEST_F(SmallRootAbstractPartitionTest, Set) {
+  auto map = RootToIntSetPartition();
+  EXPECT_TRUE(map.is_bottom());
+  EXPECT_TRUE(map.begin() == map.end());
+
+  map.set(Root(Root::Kind::Return), IntSet{1});
+  map.set(Root(Root::Kind::Argument, 1), IntSet{2});
+  map.set(Root(Root::Kind::Argument, 0), IntSet{3});
+  EXPECT_EQ(map.size(), 3);
+  EXPECT_EQ(map.get(Root(Root::Kind::Return)), IntSet{1});
+  EXPECT_EQ(map.get(Root(Root::Kind::Argument, 1)), IntSet{2});
+  EXPECT_EQ(map.get(Root(Root::Kind::Argument, 0)), IntSet{3});
+  EXPECT_TRUE(map.get(Root(Root::Kind::Argument, 2)).is_bottom());
+
+  // Bindings are sorted by root encoding.
+  using Pair = std::pair<Root, IntSet>;
+  EXPECT_THAT(
+      std::vector<Pair>(map.begin(), map.end()),
+      testing::ElementsAre(
+          Pair{Root(Root::Kind::Argument, 0), IntSet{3}},
+          Pair{Root(Root::Kind::Argument, 1), IntSet{2}},
+          Pair{Root(Root::Kind::Return), IntSet{1}}));
+
+  map.set(Root(Root::Kind::Argument, 1), IntSet{});
+  EXPECT_EQ(map.size(), 2);
+  map.set(Root(Root::Kind::Argument, 0), IntSet{});
+  map.set(Root(Root::Kind::Return), IntSet{});
+  EXPECT_TRUE(map.is_bottom());
+}
+
+TEST_F(SmallRootAbstractPartitionTest, CopyOnWrite) {
+  auto map = RootToIntSetPartition{
+      {Root(Root::Kind::Return), IntSet{1}},
+  };
+  auto copy = map;
+  EXPECT_EQ(&*copy.begin(), &*map.begin());
+
+  copy.set(Root(Root::Kind::Return), IntSet{2});
+  EXPECT_EQ(map.get(Root(Root::Kind::Return)), IntSet{1});
+  EXPECT_EQ(copy.get(Root(Root::Kind::Return)), IntSet{2});
+
+  auto joined = RootToIntSetPartition();
+  joined.join_with(map);
+  EXPECT_EQ(&*joined.begin(), &*map.begin());
+}
+
+TEST_F(SmallRootAbstractPartitionTest, LessOrEqual) {
+  EXPECT_TRUE(
+      RootToIntSetPartition::bottom().leq(RootToIntSetPartition::bottom()));
+  EXPECT_TRUE(
+      RootToIntSetPartition::bottom().leq(RootToIntSetPartition::top()));
+  EXPECT_FALSE(
+      RootToIntSetPartition::top().leq(RootToIntSetPartition::bottom()));
+
+  auto map1 = RootToIntSetPartition{
+      {Root(Root::Kind::Return), IntSet{1}},
+  };
+  auto map2 = RootToIntSetPartition{
+      {Root(Root::Kind::Return), IntSet{1, 2}},
+      {Root(Root::Kind::Argument, 0), IntSet{0}},
+  };
+  auto map3 = RootToIntSetPartition{
+      {Root(Root::Kind::Argument, 1), IntSet{0}},
+  };
+  EXPECT_TRUE(RootToIntSetPartition::bottom().leq(map1));
+  EXPECT_FALSE(map1.leq(RootToIntSetPartition::bottom()));
+  EXPECT_TRUE(map1.leq(map1));
+  EXPECT_TRUE(map1.leq(map2));
+  EXPECT_FALSE(map2.leq(map1));
+  EXPECT_FALSE(map2.leq(map3));
+  EXPECT_FALSE(map3.leq(map2));
+  EXPECT_TRUE(map3.leq(RootToIntSetPartition::top()));
+}
+
+TEST_F(SmallRootAbstractPartitionTest, JoinMeet) {
+  auto map = RootToIntSetPartition{
+      {Root(Root::Kind::Return), IntSet{1}},
+      {Root(Root::Kind::Argument, 0), IntSet{2}},
+  };
+  map.join_with(RootToIntSetPartition{
+      {Root(Root::Kind::Return), IntSet{2}},
+      {Root(Root::Kind::Argument, 1), IntSet{3}},
+  });
+  EXPECT_EQ(
+      map,
+      (RootToIntSetPartition{
+          {Root(Root::Kind::Return), IntSet{1, 2}},
+          {Root(Root::Kind::Argument, 0), IntSet{2}},
+          {Root(Root::Kind::Argument, 1), IntSet{3}},
+      }));
+
+  map.meet_with(RootToIntSetPartition{
+      {Root(Root::Kind::Return), IntSet{2, 3}},
+      {Root(Root::Kind::Argument, 1), IntSet{4}},
+  });
+  EXPECT_EQ(
+      map,
+      (RootToIntSetPartition{
+          {Root(Root::Kind::Return), IntSet{2}},
+      }));
+
+  auto top = RootToIntSetPartition::bottom();
+  top.join_with(RootToIntSetPartition::top());
+  EXPECT_TRUE(top.is_top());
+  top.meet_with(map);
+  EXPECT_EQ(top, map);
+}
+
+TEST_F(SmallRootAbstractPartitionTest, UpdateAndMap) {
+  auto map = RootToIntSetPartition{
+      {Root(Root::Kind::Return), IntSet{1}},
+      {Root(Root::Kind::Argument, 0), IntSet{2}},
+  };
+  map.update(Root(Root::Kind::Argument, 1), [](const IntSet& /* set */) {
+    return IntSet{10};
+  });
+  EXPECT_EQ(map.get(Root(Root::Kind::Argument, 1)), IntSet{10});
+
+  EXPECT_TRUE(map.map([](const IntSet& set) {
+    auto copy = set;
+    copy.add(10);
+    return copy;
+  }));
+  EXPECT_EQ(
+      map,
+      (RootToIntSetPartition{
+          {Root(Root::Kind::Return), IntSet{1, 10}},
+          {Root(Root::Kind::Argument, 0), IntSet{2, 10}},
+          {Root(Root::Kind::Argument, 1), IntSet{10}},
+      }));
+  EXPECT_FALSE(map.map([](const IntSet& set) { return set; }));
+}
+
+} // namespace marianatrench
@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gmock/gmock.h>
+
+#include <mariana-trench/SnapshotArray.h>
+#include <mariana-trench/tests/Test.h>
+
+namespace marianatrench {
+
+namespace {
+
+constexpr std::size_t kThreads = 8;
+constexpr std::size_t kSize = 10000;
+
+class SnapshotArrayTest : public test::Test {};
+
+} // namespace
+
+TEST_F(SnapshotArrayTest, GetSetInsert) {
+  SnapshotArray<std::string> array;
+  EXPECT_EQ(array.size(), 0);
+  EXPECT_EQ(array.get(1), nullptr);
+
+  EXPECT_TRUE(array.insert(1, std::make_shared<const std::string>("a")));
+  EXPECT_FALSE(array.insert(1, std::make_shared<const std::string>("b")));
+  EXPECT_EQ(*array.get(1), "a");
+
+  auto snapshot = array.get(1);
+  array.set(1, std::make_shared<const std::string>("c"));
+  EXPECT_EQ(*snapshot, "a");
+  EXPECT_EQ(*array.get(1), "c");
+
+  array.set(100000, std::make_shared<const std::string>("d"));
+  EXPECT_EQ(array.size(), 2);
+
+  std::vector<std::string> values;
+  array.visit([&](const std::shared_ptr<const std::string>& value) {
+    values.push_back(*value);
+  });
+  EXPECT_THAT(values, testing::ElementsAre("c", "d"));
+
+  EXPECT_EQ(*array.erase(1), "c");
+  EXPECT_EQ(array.erase(1), nullptr);
+  EXPECT_EQ(array.get(1), nullptr);
+  EXPECT_EQ(array.size(), 1);
+}
+
+TEST_F(SnapshotArrayTest, ConcurrentReadsAndWrites) {
+  SnapshotArray<std::size_t> array;
+  std::vector<std::thread> threads;
+  for (std::size_t thread = 0; thread < kThreads; thread++) {
+    threads.emplace_back([&array, thread]() {
+      for (std::size_t index = 0; index < kSize; index++) {
+        array.set(index, std::make_shared<const std::size_t>(thread));
+        auto value = array.get(index);
+        EXPECT_NE(value, nullptr);
+        EXPECT_LT(*value, kThreads);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(array.size(), kSize);
+}
+
+} // namespace marianatrench
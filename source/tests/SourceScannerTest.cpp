@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <gmock/gmock.h>
+
+#include <mariana-trench/SourceScanner.h>
+#include <mariana-trench/tests/Test.h>
+
+namespace marianatrench {
+
+class SourceScannerTest : public test::Test {};
+
+namespace {
+
+std::vector<std::string_view> lines(std::string_view content) {
+  auto offsets = source_scanner::line_offsets(content);
+  std::vector<std::string_view> result;
+  for (std::size_t index = 0; index + 1 < offsets.size(); index++) {
+    result.push_back(source_scanner::line(content, offsets, index));
+  }
+  return result;
+}
+
+} // namespace
+
+TEST_F(SourceScannerTest, LineOffsets) {
+  EXPECT_THAT(lines(""), testing::IsEmpty());
+  EXPECT_THAT(lines("\n"), testing::ElementsAre(""));
+  EXPECT_THAT(lines("a"), testing::ElementsAre("a"));
+  EXPECT_THAT(lines("a\n"), testing::ElementsAre("a"));
+  EXPECT_THAT(lines("a\nbc"), testing::ElementsAre("a", "bc"));
+  EXPECT_THAT(
+      lines("package a;\n\n\nclass B {}\n"),
+      testing::ElementsAre("package a;", "", "", "class B {}"));
+  EXPECT_THAT(
+      source_scanner::line_offsets("a\nbc"), testing::ElementsAre(0, 2, 5));
+}
+
+TEST_F(SourceScannerTest, MayDeclareClass) {
+  EXPECT_FALSE(source_scanner::may_declare_class(""));
+  EXPECT_FALSE(source_scanner::may_declare_class("cla"));
+  EXPECT_FALSE(source_scanner::may_declare_class("  return x + y;"));
+  EXPECT_FALSE(source_scanner::may_declare_class("import com.facebook.Clas;"));
+  EXPECT_FALSE(source_scanner::may_declare_class("  String className;"));
+  EXPECT_FALSE(source_scanner::may_declare_class("data class A"));
+  EXPECT_TRUE(source_scanner::may_declare_class("enum"));
+  EXPECT_TRUE(source_scanner::may_declare_class("public class A {"));
+  EXPECT_TRUE(source_scanner::may_declare_class("interface B"));
+  EXPECT_TRUE(source_scanner::may_declare_class("internal object C {"));
+  EXPECT_TRUE(source_scanner::may_declare_class("enum class D"));
+  EXPECT_TRUE(source_scanner::may_declare_class("\t/* a */ final class E"));
+  EXPECT_TRUE(source_scanner::may_declare_class("abstractclass F"));
+
+  // Keywords after any indentation.
+  for (std::size_t padding = 0; padding < 20; padding++) {
+    for (std::string keyword : {"class", "interface", "object", "enum"}) {
+      auto line = std::string(padding, ' ') + keyword;
+      EXPECT_TRUE(source_scanner::may_declare_class(line)) << line;
+      line.pop_back();
+      EXPECT_FALSE(source_scanner::may_declare_class(line)) << line;
+    }
+  }
+}
+
+TEST_F(SourceScannerTest, MayDeclarePackage) {
+  EXPECT_TRUE(source_scanner::may_declare_package("package com.facebook;"));
+  EXPECT_FALSE(source_scanner::may_declare_package(" package com.facebook;"));
+  EXPECT_FALSE(source_scanner::may_declare_package("packag"));
+  EXPECT_FALSE(source_scanner::may_declare_package("import a;"));
+}
+
+} // namespace marianatrench
@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <thread>
+#include <vector>
+
+#include <gmock/gmock.h>
+
+#include <mariana-trench/Redex.h>
+#include <mariana-trench/Statistics.h>
+#include <mariana-trench/tests/Test.h>
+
+namespace marianatrench {
+
+class StatisticsTest : public test::Test {};
+
+TEST_F(StatisticsTest, MergeThreads) {
+  Scope scope;
+  auto context = test::make_empty_context();
+  const auto* method_a = context.methods->create(
+      redex::create_void_method(scope, "LClass;", "method_a"));
+  const auto* method_b = context.methods->create(
+      redex::create_void_method(scope, "LClass;", "method_b"));
+
+  Statistics statistics;
+  EXPECT_EQ(statistics.method_time(method_a), std::nullopt);
+
+  std::vector<std::thread> threads;
+  for (const auto* method : {method_a, method_b}) {
+    threads.emplace_back([&statistics, method]() {
+      for (int analysis = 0; analysis < 100; analysis++) {
+        statistics.log_time(method, Timer());
+        auto fixpoint = FixpointStatistics{};
+        fixpoint.block_visits = 1;
+        fixpoint.skipped_block_visits = 2;
+        statistics.log_fixpoint(method, fixpoint);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_NE(statistics.method_time(method_a), std::nullopt);
+  auto method_times = statistics.method_times();
+  EXPECT_EQ(method_times.size(), 2);
+  EXPECT_EQ(method_times.at(method_a).analyses, 100);
+  EXPECT_EQ(method_times.at(method_b).analyses, 100);
+
+  // Records logged after a merge are merged again.
+  statistics.log_time(method_a, Timer());
+  EXPECT_EQ(statistics.method_times().at(method_a).analyses, 101);
+
+  auto value = statistics.to_json();
+  EXPECT_EQ(value["fixpoint"]["block_visits"].asUInt64(), 200);
+  EXPECT_EQ(value["fixpoint"]["skipped_block_visits"].asUInt64(), 400);
+  EXPECT_EQ(value["slowest_methods"].size(), 2);
+  std::size_t analyses = 0;
+  for (const auto& bucket : value["method_time_histogram"]) {
+    analyses += bucket["analyses"].asUInt64();
+  }
+  EXPECT_EQ(analyses, 201);
+}
+
+} // namespace marianatrench
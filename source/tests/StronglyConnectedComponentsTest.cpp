@@ -205,3 +205,126 @@ TEST_F(StronglyConnectedComponentsTest, Recursive) {
   EXPECT_THAT(components[0], testing::ElementsAre(bottom));
   EXPECT_THAT(components[1], testing::UnorderedElementsAre(top, left, right));
 }
+
+TEST_F(StronglyConnectedComponentsTest, ComponentGraph) {
+  Scope scope;
+
+  /*
+   *    Top
+   *  /     \
+   * Left - Right
+   *   \
+   *   Bottom
+   */
+  auto* dex_bottom = redex::create_void_method(scope, "LBottom;", "bottom");
+  auto* dex_left = redex::create_method(scope, "LLeft;", R"(
+    (method (public) "LLeft;.left:()V"
+     (
+      (load-param-object v0)
+      (invoke-direct (v0) "LBottom;.bottom:()V")
+      (invoke-direct (v0) "LRight;.right:()V")
+      (return-void)
+     )
+    )
+  )");
+  auto* dex_right = redex::create_method(scope, "LRight;", R"(
+    (method (public) "LRight;.right:()V"
+     (
+      (load-param-object v0)
+      (invoke-direct (v0) "LLeft;.left:()V")
+      (return-void)
+     )
+    )
+  )");
+  auto* dex_top = redex::create_method(scope, "LTop;", R"(
+    (method (public) "LTop;.top:()V"
+     (
+      (load-param-object v0)
+      (invoke-direct (v0) "LLeft;.left:()V")
+      (invoke-direct (v0) "LRight;.right:()V")
+      (return-void)
+     )
+    )
+  )");
+
+  auto context = test_components(scope);
+  auto* bottom = context.methods->get(dex_bottom);
+  auto* top = context.methods->get(dex_top);
+  auto* left = context.methods->get(dex_left);
+  auto* right = context.methods->get(dex_right);
+
+  auto components =
+      StronglyConnectedComponents(*context.methods, *context.dependencies);
+  auto bottom_index = components.component_index(bottom);
+  auto cycle_index = components.component_index(left);
+  auto top_index = components.component_index(top);
+  EXPECT_EQ(components.component_index(right), cycle_index);
+  EXPECT_LT(bottom_index, cycle_index);
+  EXPECT_LT(cycle_index, top_index);
+
+  EXPECT_THAT(
+      components.dependent_components(bottom_index),
+      testing::ElementsAre(cycle_index));
+  EXPECT_THAT(
+      components.dependent_components(cycle_index),
+      testing::ElementsAre(top_index));
+  EXPECT_TRUE(components.dependent_components(top_index).empty());
+}
+
+TEST_F(StronglyConnectedComponentsTest, WeakTopologicalOrder) {
+  Scope scope;
+
+  /*
+   * Top <-> Middle
+   *   ^ \   /
+   *   |  v v
+   *   Bottom
+   *
+   * Bottom only calls Top, which also calls Bottom, hence Bottom has the
+   * fewest callees in the component.
+   */
+  auto* dex_bottom = redex::create_method(scope, "LBottom;", R"(
+    (method (public) "LBottom;.bottom:()V"
+     (
+      (load-param-object v0)
+      (invoke-direct (v0) "LTop;.top:()V")
+      (return-void)
+     )
+    )
+  )");
+  auto* dex_middle = redex::create_method(scope, "LMiddle;", R"(
+    (method (public) "LMiddle;.middle:()V"
+     (
+      (load-param-object v0)
+      (invoke-direct (v0) "LBottom;.bottom:()V")
+      (invoke-direct (v0) "LTop;.top:()V")
+      (return-void)
+     )
+    )
+  )");
+  auto* dex_top = redex::create_method(scope, "LTop;", R"(
+    (method (public) "LTop;.top:()V"
+     (
+      (load-param-object v0)
+      (invoke-direct (v0) "LMiddle;.middle:()V")
+      (invoke-direct (v0) "LBottom;.bottom:()V")
+      (return-void)
+     )
+    )
+  )");
+
+  auto context = test_components(scope);
+  auto* bottom = context.methods->get(dex_bottom);
+  auto* middle = context.methods->get(dex_middle);
+  auto* top = context.methods->get(dex_top);
+
+  std::vector<std::vector<const Method*>> components =
+      StronglyConnectedComponents(*context.methods, *context.dependencies)
+          .components();
+  filter_components(components, /* keep */ {top, middle, bottom});
+
+  ASSERT_EQ(components.size(), 1);
+  EXPECT_THAT(
+      components[0], testing::UnorderedElementsAre(top, middle, bottom));
+  EXPECT_EQ(components[0].front(), bottom);
+}
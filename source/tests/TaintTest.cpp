@@ -860,6 +860,53 @@ TEST_F(TaintTest, UpdateNonLeafPositions) {
                   .callee_port = AccessPath(Root(Root::Kind::Argument, 1)),
                   .call_position = position3,
                   .local_positions = expected_local_positions})}));
+
+  // Only update the frames accepted by the filter.
+  auto filtered_taint = Taint{
+      test::make_frame(
+          /* kind */ context.kinds->get("NonLeafFrame1"),
+          test::FrameProperties{
+              .callee = method1,
+              .callee_port = AccessPath(Root(Root::Kind::Return)),
+              .call_position = position1}),
+      test::make_frame(
+          /* kind */ context.kinds->get("NonLeafFrame2"),
+          test::FrameProperties{
+              .callee = method2,
+              .callee_port = AccessPath(Root(Root::Kind::Argument)),
+              .call_position = position2})};
+  filtered_taint.update_non_leaf_positions(
+      [&](const Method* /* callee */,
+          const AccessPath& /* callee_port */,
+          const Position* position) {
+        return context.positions->get(
+            position, /* line */ 10, /* start */ 11, /* end */ 12);
+      },
+      [&](const LocalPositionSet& local_positions) {
+        LocalPositionSet new_local_positions = local_positions;
+        new_local_positions.add(position1);
+        return new_local_positions;
+      },
+      [&](const Method* callee, const Position* position) {
+        return callee == method2 && position == position2;
+      });
+  EXPECT_EQ(
+      filtered_taint,
+      (Taint{
+          test::make_frame(
+              /* kind */ context.kinds->get("NonLeafFrame1"),
+              test::FrameProperties{
+                  .callee = method1,
+                  .callee_port = AccessPath(Root(Root::Kind::Return)),
+                  .call_position = position1}),
+          test::make_frame(
+              /* kind */ context.kinds->get("NonLeafFrame2"),
+              test::FrameProperties{
+                  .callee = method2,
+                  .callee_port = AccessPath(Root(Root::Kind::Argument)),
+                  .call_position = context.positions->get(
+                      position2, /* line */ 10, /* start */ 11, /* end */ 12),
+                  .local_positions = expected_local_positions})}));
 }
 
 TEST_F(TaintTest, FilterInvalidFrames) {
@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <algorithm>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+
+#include <AggregateException.h>
+
+#include <mariana-trench/TaskGraph.h>
+#include <mariana-trench/tests/Test.h>
+
+namespace marianatrench {
+
+class TaskGraphTest : public test::Test {};
+
+TEST_F(TaskGraphTest, Dependencies) {
+  std::mutex mutex;
+  std::vector<std::string> order;
+  auto record = [&](std::string name) {
+    return [&, name]() {
+      std::lock_guard<std::mutex> lock(mutex);
+      order.push_back(name);
+    };
+  };
+
+  TaskGraph graph;
+  auto a = graph.add("a", record("a"));
+  auto b = graph.add("b", record("b"), /* dependencies */ {a});
+  auto c = graph.add("c", record("c"), /* dependencies */ {a});
+  graph.add("d", record("d"), /* dependencies */ {b, c});
+  graph.add("e", record("e"));
+  EXPECT_EQ(graph.size(), 5);
+  graph.run();
+
+  EXPECT_THAT(order, testing::UnorderedElementsAre("a", "b", "c", "d", "e"));
+  auto position = [&](const std::string& name) {
+    return std::find(order.begin(), order.end(), name) - order.begin();
+  };
+  EXPECT_LT(position("a"), position("b"));
+  EXPECT_LT(position("a"), position("c"));
+  EXPECT_LT(position("b"), position("d"));
+  EXPECT_LT(position("c"), position("d"));
+}
+
+TEST_F(TaskGraphTest, Exception) {
+  bool dependent_ran = false;
+  bool independent_ran = false;
+
+  TaskGraph graph;
+  auto failing =
+      graph.add("failing", []() { throw std::runtime_error("failure"); });
+  graph.add(
+      "dependent",
+      [&]() { dependent_ran = true; },
+      /* dependencies */ {failing});
+  graph.add("independent", [&]() { independent_ran = true; });
+
+  EXPECT_THROW(graph.run(), aggregate_exception);
+  EXPECT_FALSE(dependent_ran);
+  EXPECT_TRUE(independent_ran);
+}
+
+} // namespace marianatrench
@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <algorithm>
+
+#include <gtest/gtest.h>
+
+#include <DexStore.h>
+#include <IRCode.h>
+#include <Liveness.h>
+#include <RedexContext.h>
+
+#include <mariana-trench/Redex.h>
+#include <mariana-trench/ThinnedControlFlowGraph.h>
+#include <mariana-trench/tests/Test.h>
+
+using namespace marianatrench;
+
+namespace {
+
+class ThinnedControlFlowGraphTest : public test::Test {};
+
+std::size_t throw_edges(const std::vector<cfg::Edge*>& edges) {
+  return std::count_if(edges.begin(), edges.end(), [](const auto* edge) {
+    return edge->type() == cfg::EDGE_THROW;
+  });
+}
+
+} // anonymous namespace
+
+TEST_F(ThinnedControlFlowGraphTest, RemovedEdges) {
+  Scope scope;
+  auto* dex_method = redex::create_method(scope, "LClass;", R"(
+    (method (public static) "LClass;.method:(LClass;)V"
+     (
+      (load-param-object v0)
+      (.try_start a)
+      (invoke-static (v0) "LClass;.call:(LClass;)V")
+      (new-instance "LClass;")
+      (move-result-pseudo-object v0)
+      (invoke-static (v0) "LClass;.call:(LClass;)V")
+      (.try_end a)
+      (return-void)
+
+      (.catch (a))
+      (move-exception v1)
+      (invoke-static (v0) "LClass;.call:(LClass;)V")
+      (return-void)
+     )
+    )
+  )");
+
+  DexStore store("test_store");
+  store.add_classes(scope);
+  auto context = test::make_context(store);
+  const auto& cfg = context.methods->get(dex_method)->get_code()->cfg();
+
+  cfg::Block* handler = nullptr;
+  for (auto* block : cfg.blocks()) {
+    if (throw_edges(block->preds()) > 0) {
+      handler = block;
+    }
+  }
+  ASSERT_NE(handler, nullptr);
+  EXPECT_EQ(throw_edges(handler->preds()), 3);
+
+  auto full_graph = ThinnedControlFlowGraph(cfg, /* liveness */ nullptr);
+  EXPECT_EQ(full_graph.removed_edges(), 0);
+  EXPECT_EQ(throw_edges(full_graph.predecessors(handler)), 3);
+
+  LivenessFixpointIterator liveness(cfg);
+  liveness.run(LivenessDomain());
+  // The throw edge of the first call is covered by the one of
+  // `new-instance`, which does not define any register. The throw edge of
+  // `new-instance` is kept, since the next block defines `v0`, which is live
+  // in the handler.
+  auto graph = ThinnedControlFlowGraph(cfg, &liveness);
+  EXPECT_EQ(graph.removed_edges(), 1);
+  EXPECT_EQ(throw_edges(graph.predecessors(handler)), 2);
+
+  std::size_t successor_throw_edges = 0;
+  for (auto* block : cfg.blocks()) {
+    successor_throw_edges += throw_edges(graph.successors(block));
+  }
+  EXPECT_EQ(successor_throw_edges, 2);
+}
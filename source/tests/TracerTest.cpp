@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <chrono>
+#include <thread>
+
+#include <gmock/gmock.h>
+
+#include <mariana-trench/Tracer.h>
+#include <mariana-trench/tests/Test.h>
+
+namespace marianatrench {
+
+class TracerTest : public test::Test {};
+
+namespace {
+
+Json::Value find_event(const Json::Value& trace, const std::string& name) {
+  for (const auto& event : trace["traceEvents"]) {
+    if (event["name"].asString() == name) {
+      return event;
+    }
+  }
+  return Json::Value(Json::nullValue);
+}
+
+} // namespace
+
+TEST_F(TracerTest, NestedSpans) {
+  {
+    TraceSpan span("tracer_test:disabled");
+  }
+  EXPECT_TRUE(find_event(Tracer::to_json(), "tracer_test:disabled").isNull());
+
+  Tracer::enable();
+  EXPECT_TRUE(Tracer::enabled());
+  {
+    TraceSpan outer("tracer_test:outer");
+    {
+      TraceSpan inner("tracer_test:inner");
+      std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    TraceSpan closed("tracer_test:closed");
+    closed.end();
+    closed.end();
+
+    std::thread([]() { TraceSpan span("tracer_test:thread"); }).join();
+  }
+
+  auto trace = Tracer::to_json();
+  auto outer = find_event(trace, "tracer_test:outer");
+  auto inner = find_event(trace, "tracer_test:inner");
+  auto closed = find_event(trace, "tracer_test:closed");
+  auto thread = find_event(trace, "tracer_test:thread");
+  ASSERT_FALSE(outer.isNull());
+  ASSERT_FALSE(inner.isNull());
+  ASSERT_FALSE(closed.isNull());
+  ASSERT_FALSE(thread.isNull());
+
+  EXPECT_EQ(outer["ph"].asString(), "X");
+  EXPECT_EQ(outer["args"]["depth"].asUInt64(), 0);
+  EXPECT_EQ(inner["args"]["depth"].asUInt64(), 1);
+  EXPECT_EQ(closed["args"]["depth"].asUInt64(), 1);
+  EXPECT_EQ(thread["args"]["depth"].asUInt64(), 0);
+  EXPECT_EQ(outer["tid"], inner["tid"]);
+  EXPECT_NE(outer["tid"], thread["tid"]);
+
+  EXPECT_GE(inner["ts"].asUInt64(), outer["ts"].asUInt64());
+  EXPECT_GE(inner["dur"].asUInt64(), 2000);
+  EXPECT_GE(outer["dur"].asUInt64(), inner["dur"].asUInt64());
+
+  std::size_t closed_spans = 0;
+  for (const auto& event : trace["traceEvents"]) {
+    closed_spans += event["name"].asString() == "tracer_test:closed";
+  }
+  EXPECT_EQ(closed_spans, 1);
+}
+
+} // namespace marianatrench
@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <gtest/gtest.h>
+
+#include <DexStore.h>
+#include <RedexContext.h>
+
+#include <mariana-trench/Redex.h>
+#include <mariana-trench/Registry.h>
+#include <mariana-trench/TrivialMethods.h>
+#include <mariana-trench/tests/Test.h>
+
+using namespace marianatrench;
+
+namespace {
+
+class TrivialMethodsTest : public test::Test {};
+
+} // anonymous namespace
+
+TEST_F(TrivialMethodsTest, Summaries) {
+  Scope scope;
+
+  auto* dex_getter = redex::create_method(scope, "LClass;", R"(
+    (method (public) "LClass;.getter:()Ljava/lang/Object;"
+     (
+      (load-param-object v0)
+      (iget-object v0 "LClass;.field:Ljava/lang/Object;")
+      (move-result-pseudo-object v1)
+      (return-object v1)
+     )
+    )
+  )");
+  auto* dex_constant = redex::create_method(scope, "LClass;", R"(
+    (method (public static) "LClass;.constant:()I"
+     (
+      (const v0 1)
+      (return v0)
+     )
+    )
+  )");
+  auto* dex_caller = redex::create_method(scope, "LClass;", R"(
+    (method (public static) "LClass;.caller:()I"
+     (
+      (invoke-static () "LClass;.constant:()I")
+      (move-result v0)
+      (return v0)
+     )
+    )
+  )");
+
+  DexStore store("test_store");
+  store.add_classes(scope);
+  auto context = test::make_context(store);
+  const auto* getter = context.methods->get(dex_getter);
+  const auto* constant = context.methods->get(dex_constant);
+  const auto* caller = context.methods->get(dex_caller);
+
+  auto trivial_methods = TrivialMethods(*context.methods, *context.call_graph);
+  EXPECT_EQ(trivial_methods.get(caller), nullptr);
+
+  const auto* getter_summary = trivial_methods.get(getter);
+  ASSERT_NE(getter_summary, nullptr);
+  EXPECT_TRUE(getter_summary->returns_value);
+  EXPECT_EQ(
+      getter_summary->returned_access_path,
+      AccessPath(
+          Root(Root::Kind::Argument, 0),
+          Path{DexString::make_string("field")}));
+  EXPECT_EQ(getter_summary->field_reads.size(), 1);
+
+  const auto* constant_summary = trivial_methods.get(constant);
+  ASSERT_NE(constant_summary, nullptr);
+  EXPECT_TRUE(constant_summary->returns_value);
+  EXPECT_EQ(constant_summary->returned_access_path, std::nullopt);
+
+  auto registry = Registry(context);
+  auto getter_model =
+      trivial_methods.model(context, registry, Model(getter, context));
+  ASSERT_NE(getter_model, std::nullopt);
+  EXPECT_EQ(
+      getter_model->inline_as(),
+      AccessPathConstantDomain(*getter_summary->returned_access_path));
+  auto constant_model =
+      trivial_methods.model(context, registry, Model(constant, context));
+  ASSERT_NE(constant_model, std::nullopt);
+  EXPECT_TRUE(constant_model->inline_as().is_top());
+  EXPECT_EQ(trivial_methods.models_built(), 2);
+
+  // Methods with user models are analyzed.
+  auto source_model = Model(
+      constant,
+      context,
+      /* modes */ Model::Mode::Normal,
+      /* generations */
+      {{AccessPath(Root(Root::Kind::Return)),
+        Frame::leaf(context.kinds->get("TestSource"))}});
+  EXPECT_EQ(
+      trivial_methods.model(context, registry, source_model), std::nullopt);
+}
@@ -161,6 +161,59 @@ TEST_F(TypesTest, LocalInvokeDirectTypes) {
   EXPECT_TRUE(register_types[1] == nullptr);
 }
 
+TEST_F(TypesTest, MethodTypes) {
+  Scope scope;
+
+  redex::create_void_method(
+      scope,
+      "LCallee;",
+      "callee",
+      /* parameter_types */ "Ljava/lang/Object;");
+  auto* dex_caller = redex::create_method(
+      scope,
+      "LCaller;",
+      R"(
+          (method (public) "LCaller;.caller:(Ljava/lang/String;)V"
+            (
+              (load-param-object v0)
+              (load-param-object v1)
+              (new-instance "LCallee;")
+              (move-result-object v2)
+              (invoke-direct (v2 v1) "LCallee;.callee:(Ljava/lang/Object;)V")
+              (return-void)
+            )
+          )
+      )");
+
+  auto context = test_types(scope);
+  auto* method = context.methods->get(dex_caller);
+  auto method_types = context.types->method_types(method);
+  EXPECT_EQ(context.types->method_types(method), method_types);
+
+  for (const auto* block : method->get_code()->cfg().blocks()) {
+    for (const auto& entry : InstructionIterable(block)) {
+      const auto& source_types = method_types->source_types(entry.insn);
+      if (!opcode::is_an_invoke(entry.insn->opcode())) {
+        EXPECT_TRUE(source_types.empty());
+        continue;
+      }
+      EXPECT_EQ(
+          source_types,
+          (MethodTypes::SourceTypes{
+              DexType::make_type(DexString::make_string("LCallee;")),
+              DexType::make_type(
+                  DexString::make_string("Ljava/lang/String;"))}));
+    }
+  }
+
+  // Released types are inferred again on the next query.
+  context.types->release(method);
+  EXPECT_EQ(context.types->statistics_to_json()["releases"].asUInt64(), 1);
+  auto inferred_again = context.types->method_types(method);
+  EXPECT_NE(inferred_again, method_types);
+  EXPECT_EQ(inferred_again->entries().size(), method_types->entries().size());
+}
+
 TEST_F(TypesTest, LocalInvokeVirtualTypes) {
   Scope scope;
 
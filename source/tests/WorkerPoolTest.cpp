@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <atomic>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <thread>
+
+#include <gmock/gmock.h>
+
+#include <mariana-trench/WorkerPool.h>
+#include <mariana-trench/tests/Test.h>
+
+namespace marianatrench {
+
+class WorkerPoolTest : public test::Test {};
+
+TEST_F(WorkerPoolTest, ReusesThreads) {
+  WorkerPool pool;
+  std::mutex mutex;
+  std::set<std::thread::id> threads;
+  std::atomic<std::size_t> sum = 0;
+
+  for (int run = 0; run < 3; run++) {
+    auto queue = WorkQueue<std::size_t>(
+        &pool,
+        [&](WorkQueue<std::size_t>::WorkerState* worker_state,
+            std::size_t item) {
+          EXPECT_TRUE(WorkerPool::in_worker());
+          EXPECT_LT(worker_state->worker_id(), 4);
+          {
+            std::lock_guard<std::mutex> lock(mutex);
+            threads.insert(std::this_thread::get_id());
+          }
+          sum += item;
+          // Pushed items are processed by the same run.
+          if (item < 10) {
+            worker_state->push_task(item + 10);
+          }
+        },
+        /* threads */ 4);
+    for (std::size_t item = 0; item < 10; item++) {
+      queue.add_item(item, /* worker_id */ item);
+    }
+    queue.run_all();
+  }
+
+  EXPECT_EQ(sum.load(), 3 * (45 + 145));
+  EXPECT_EQ(pool.threads(), 4);
+  EXPECT_LE(threads.size(), 4);
+  EXPECT_FALSE(WorkerPool::in_worker());
+}
+
+TEST_F(WorkerPoolTest, Exceptions) {
+  WorkerPool pool;
+  std::atomic<std::size_t> processed = 0;
+  auto queue = WorkQueue<int>(
+      &pool,
+      [&](int item) {
+        processed++;
+        if (item == 3) {
+          throw std::runtime_error("error");
+        }
+      },
+      /* threads */ 2);
+  for (int item = 0; item < 8; item++) {
+    queue.add_item(item);
+  }
+  EXPECT_THROW(queue.run_all(), std::runtime_error);
+  EXPECT_EQ(processed.load(), 8);
+
+  // Queues without a pool start their own threads.
+  std::atomic<int> sum = 0;
+  auto own_queue = WorkQueue<int>(
+      /* pool */ nullptr, [&](int item) { sum += item; }, /* threads */ 2);
+  for (int item = 0; item < 8; item++) {
+    own_queue.add_item(item);
+  }
+  own_queue.run_all();
+  EXPECT_EQ(sum.load(), 28);
+}
+
+} // namespace marianatrench
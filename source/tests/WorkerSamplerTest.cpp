@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include <gmock/gmock.h>
+
+#include <mariana-trench/Redex.h>
+#include <mariana-trench/WorkerSampler.h>
+#include <mariana-trench/tests/Test.h>
+
+namespace marianatrench {
+
+class WorkerSamplerTest : public test::Test {};
+
+TEST_F(WorkerSamplerTest, Timeline) {
+  Scope scope;
+  auto context = test::make_empty_context();
+  const auto* method_a = context.methods->create(
+      redex::create_void_method(scope, "LClass;", "method_a"));
+  const auto* method_b = context.methods->create(
+      redex::create_void_method(scope, "LClass;", "method_b"));
+
+  // The sampling thread is not started, samples are taken explicitly.
+  WorkerSampler sampler(/* workers */ 2, std::chrono::milliseconds(10));
+  sampler.set_iteration(1);
+  {
+    WorkerSampleScope scope_a(&sampler, /* worker */ 0, method_a);
+    sampler.sample();
+    sampler.sample();
+  }
+  {
+    WorkerSampleScope scope_b(&sampler, /* worker */ 1, method_b);
+    sampler.sample();
+    sampler.set_iteration(2);
+    sampler.sample();
+  }
+  sampler.sample();
+  sampler.stop();
+
+  auto value = sampler.to_json();
+  std::vector<Json::Value> segments;
+  std::size_t metadata = 0;
+  for (const auto& event : value["traceEvents"]) {
+    if (event["ph"].asString() == "M") {
+      metadata++;
+    } else {
+      segments.push_back(event);
+    }
+  }
+
+  // One process and two threads per iteration.
+  EXPECT_EQ(metadata, 6);
+
+  // Samples of the same method are merged, but not across iterations.
+  ASSERT_EQ(segments.size(), 3);
+  EXPECT_EQ(segments[0]["name"].asString(), "LClass;.method_a:()V");
+  EXPECT_EQ(segments[0]["tid"].asUInt64(), 0);
+  EXPECT_EQ(segments[0]["pid"].asUInt64(), 1);
+  EXPECT_EQ(segments[1]["name"].asString(), "LClass;.method_b:()V");
+  EXPECT_EQ(segments[1]["tid"].asUInt64(), 1);
+  EXPECT_EQ(segments[1]["pid"].asUInt64(), 1);
+  EXPECT_EQ(segments[2]["name"].asString(), "LClass;.method_b:()V");
+  EXPECT_EQ(segments[2]["pid"].asUInt64(), 2);
+}
+
+TEST_F(WorkerSamplerTest, Thread) {
+  Scope scope;
+  auto context = test::make_empty_context();
+  const auto* method = context.methods->create(
+      redex::create_void_method(scope, "LClass;", "method"));
+
+  WorkerSampler sampler(/* workers */ 1, std::chrono::milliseconds(1));
+  sampler.start();
+  {
+    WorkerSampleScope sample_scope(&sampler, /* worker */ 0, method);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  }
+  sampler.stop();
+
+  auto value = sampler.to_json();
+  EXPECT_FALSE(value["traceEvents"].empty());
+}
+
+} // namespace marianatrench
@@ -5,6 +5,8 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <cstdlib>
+
 #include <boost/algorithm/string.hpp>
 #include <boost/filesystem/operations.hpp>
 #include <boost/filesystem/string_file.hpp>
@@ -23,6 +25,7 @@
 #include <mariana-trench/JsonValidation.h>
 #include <mariana-trench/Log.h>
 #include <mariana-trench/MarianaTrench.h>
+#include <mariana-trench/PerformanceProfile.h>
 #include <mariana-trench/tests/Test.h>
 
 using namespace marianatrench;
@@ -77,6 +80,49 @@ void compare_expected(
   compare_expected(directory, filename, expected, actual_string.str());
 }
 
+/**
+ * Performance checks are noisy on shared machines, hence they only run when
+ * `MARIANA_TRENCH_PERFORMANCE_TESTS` is set, e.g before a release.
+ */
+bool performance_tests_enabled() {
+  return std::getenv("MARIANA_TRENCH_PERFORMANCE_TESTS") != nullptr;
+}
+
+/**
+ * Compare the performance of the analysis against the baseline
+ * `expected_performance.json`. The profile is saved next to it on failure, to
+ * record or update the baseline.
+ */
+void compare_performance(
+    const boost::filesystem::path& directory,
+    const Statistics& statistics) {
+  auto profile = PerformanceProfile::from_statistics(statistics);
+  auto baseline_path = directory / "expected_performance.json";
+  auto actual_path = directory / "expected_performance.json.actual";
+
+  auto save_profile = [&]() {
+    boost::filesystem::save_string_file(
+        actual_path, JsonValidation::to_styled_string(profile));
+  };
+
+  if (!boost::filesystem::exists(baseline_path)) {
+    save_profile();
+    ADD_FAILURE() << "Missing performance baseline `" << baseline_path.native()
+                  << "`, the profile of this run is in `"
+                  << actual_path.native() << "`.";
+    return;
+  }
+
+  auto regressions = PerformanceProfile::regressions(
+      JsonValidation::parse_json_file(baseline_path), profile);
+  if (!regressions.empty()) {
+    save_profile();
+  }
+  for (const auto& regression : regressions) {
+    ADD_FAILURE() << "Performance regression: " << regression;
+  }
+}
+
 } // namespace
 
 namespace marianatrench {
@@ -177,6 +223,10 @@ TEST_P(IntegrationTest, CompareFlows) {
       "expected_dependencies.json",
       expected_dependencies,
       context.dependencies->to_json());
+
+  if (performance_tests_enabled()) {
+    compare_performance(directory, *context.statistics);
+  }
 }
 
 MT_INSTANTIATE_TEST_SUITE_P(
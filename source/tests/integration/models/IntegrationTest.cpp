@@ -526,8 +526,8 @@ TEST_P(IntegrationTest, ReturnsExpectedModel) {
       *context.overrides,
       *context.call_graph,
       registry);
-  context.scheduler =
-      std::make_unique<Scheduler>(*context.methods, *context.dependencies);
+  context.scheduler = std::make_unique<Scheduler>(
+      *context.methods, *context.dependencies, *context.statistics);
 
   Interprocedural::run_analysis(context, registry);
 